@@ -23,8 +23,11 @@
 #include "itkImageSamplerBase.h"
 #include "itkGradientImageFilter.h"
 #include "itkBSplineInterpolateImageFunction.h"
+#include "itkRecursiveBSplineInterpolateImageFunction.h"
 #include "itkReducedDimensionBSplineInterpolateImageFunction.h"
 #include "itkAdvancedLinearInterpolateImageFunction.h"
+#include "itkNearestNeighborInterpolateImageFunction.h"
+#include "itkInterleavedValueAndGradientImageFunction.h"
 #include "itkLimiterFunctionBase.h"
 #include "itkFixedArray.h"
 #include "itkAdvancedTransform.h"
@@ -36,7 +39,7 @@
 #include "itkAdvancedBSplineDeformableTransform.h"
 #include "itkAdvancedCombinationTransform.h"
 
-#include "itkPlatformMultiThreader.h"
+#include "itkCreateMultiThreader.h"
 
 #include <memory> // For unique_ptr.
 
@@ -170,8 +173,9 @@ public:
   typedef vnl_sparse_matrix<HessianValueType> HessianType;
 
   /** Typedefs for multi-threading. */
-  typedef itk::PlatformMultiThreader          ThreaderType;
+  typedef itk::MultiThreaderBase              ThreaderType;
   typedef typename ThreaderType::WorkUnitInfo ThreadInfoType;
+  typedef typename ThreaderType::ThreaderEnum ThreaderEnum;
 
   /** Public methods ********************/
 
@@ -254,6 +258,14 @@ public:
   itkSetMacro(MovingImageDerivativeScales, MovingImageDerivativeScalesType);
   itkGetConstReferenceMacro(MovingImageDerivativeScales, MovingImageDerivativeScalesType);
 
+  /** Select whether the moving image values and central difference gradients are
+   * stored interleaved in a single float image, built once in Initialize(). This
+   * is only used with a nearest neighbor interpolator, where both are otherwise
+   * read from two separate images. Default: false.
+   */
+  itkSetMacro(UseInterleavedMovingImageCache, bool);
+  itkGetConstMacro(UseInterleavedMovingImageCache, bool);
+
   /** Initialize the Metric by making sure that all the components
    *  are present and plugged together correctly.
    * \li Call the superclass' implementation
@@ -275,6 +287,18 @@ public:
   virtual void
   SetNumberOfWorkUnits(ThreadIdType numberOfThreads);
 
+  /** Select the multi-threader that runs the threaded computations of the metric.
+   * The Platform threader creates and joins its threads at every launch. The Pool
+   * threader keeps its threads parked between launches, which saves much of the
+   * overhead per iteration when few samples are used. The TBB threader runs the
+   * work units on a work-stealing scheduler, when ITK is built with TBB.
+   * The default is Platform.
+   */
+  virtual void
+  SetMultiThreaderType(const ThreaderEnum threaderType);
+
+  itkGetConstMacro(MultiThreaderType, ThreaderEnum);
+
   /** Switch the function BeforeThreadedGetValueAndDerivative on or off. */
   itkSetMacro(UseMetricSingleThreaded, bool);
   itkGetConstReferenceMacro(UseMetricSingleThreaded, bool);
@@ -322,6 +346,12 @@ protected:
   typedef BSplineInterpolateImageFunction<MovingImageType, CoordinateRepresentationType, float>
                                                          BSplineInterpolatorFloatType;
   typedef typename BSplineInterpolatorFloatType::Pointer BSplineInterpolatorFloatPointer;
+  typedef RecursiveBSplineInterpolateImageFunction<MovingImageType, CoordinateRepresentationType, double>
+                                                             RecursiveBSplineInterpolatorType;
+  typedef typename RecursiveBSplineInterpolatorType::Pointer RecursiveBSplineInterpolatorPointer;
+  typedef RecursiveBSplineInterpolateImageFunction<MovingImageType, CoordinateRepresentationType, float>
+                                                                  RecursiveBSplineInterpolatorFloatType;
+  typedef typename RecursiveBSplineInterpolatorFloatType::Pointer RecursiveBSplineInterpolatorFloatPointer;
   typedef ReducedDimensionBSplineInterpolateImageFunction<MovingImageType, CoordinateRepresentationType, double>
                                                            ReducedBSplineInterpolatorType;
   typedef typename ReducedBSplineInterpolatorType::Pointer ReducedBSplineInterpolatorPointer;
@@ -330,6 +360,11 @@ protected:
   typedef typename BSplineInterpolatorType::CovariantVectorType    MovingImageDerivativeType;
   typedef GradientImageFilter<MovingImageType, RealType, RealType> CentralDifferenceGradientFilterType;
   typedef typename CentralDifferenceGradientFilterType::Pointer    CentralDifferenceGradientFilterPointer;
+  typedef NearestNeighborInterpolateImageFunction<MovingImageType, CoordinateRepresentationType>
+    NearestNeighborInterpolatorType;
+  typedef InterleavedValueAndGradientImageFunction<MovingImageType, CoordinateRepresentationType>
+                                                                    InterleavedValueAndGradientFunctionType;
+  typedef typename InterleavedValueAndGradientFunctionType::Pointer InterleavedValueAndGradientFunctionPointer;
 
   /** Typedefs for support of sparse Jacobians and compact support of transformations. */
   typedef typename AdvancedTransformType::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
@@ -342,17 +377,24 @@ protected:
   mutable ImageSamplerPointer m_ImageSampler{ nullptr };
 
   /** Variables for image derivative computation. */
-  bool                              m_InterpolatorIsLinear{ false };
-  bool                              m_InterpolatorIsBSpline{ false };
-  bool                              m_InterpolatorIsBSplineFloat{ false };
-  bool                              m_InterpolatorIsReducedBSpline{ false };
-  LinearInterpolatorPointer         m_LinearInterpolator{ nullptr };
-  BSplineInterpolatorPointer        m_BSplineInterpolator{ nullptr };
-  BSplineInterpolatorFloatPointer   m_BSplineInterpolatorFloat{ nullptr };
-  ReducedBSplineInterpolatorPointer m_ReducedBSplineInterpolator{ nullptr };
+  bool                                     m_InterpolatorIsLinear{ false };
+  bool                                     m_InterpolatorIsBSpline{ false };
+  bool                                     m_InterpolatorIsBSplineFloat{ false };
+  bool                                     m_InterpolatorIsRecursiveBSpline{ false };
+  bool                                     m_InterpolatorIsRecursiveBSplineFloat{ false };
+  bool                                     m_InterpolatorIsReducedBSpline{ false };
+  LinearInterpolatorPointer                m_LinearInterpolator{ nullptr };
+  BSplineInterpolatorPointer               m_BSplineInterpolator{ nullptr };
+  BSplineInterpolatorFloatPointer          m_BSplineInterpolatorFloat{ nullptr };
+  RecursiveBSplineInterpolatorPointer      m_RecursiveBSplineInterpolator{ nullptr };
+  RecursiveBSplineInterpolatorFloatPointer m_RecursiveBSplineInterpolatorFloat{ nullptr };
+  ReducedBSplineInterpolatorPointer        m_ReducedBSplineInterpolator{ nullptr };
 
   CentralDifferenceGradientFilterPointer m_CentralDifferenceGradientFilter{ nullptr };
 
+  bool                                       m_InterpolatorIsNearestNeighbor{ false };
+  InterleavedValueAndGradientFunctionPointer m_InterleavedValueAndGradientFunction{ nullptr };
+
   /** Variables to store the AdvancedTransform. */
   bool                                    m_TransformIsAdvanced{ false };
   typename AdvancedTransformType::Pointer m_AdvancedTransform{ nullptr };
@@ -417,6 +459,10 @@ protected:
   bool m_UseMultiThread{ false };
   bool m_UseOpenMP;
 
+  /** The threader that runs the threaded computations, see SetMultiThreaderType(). */
+  ThreaderEnum                   m_MultiThreaderType{ ThreaderEnum::Platform };
+  typename ThreaderType::Pointer m_MetricThreader;
+
   /** Helper structs that multi-threads the computation of
    * the metric derivative using ITK threads.
    */
@@ -599,6 +645,7 @@ private:
   double m_RequiredRatioOfValidSamples{ 0.25 };
   bool   m_UseMovingImageDerivativeScales{ false };
   bool   m_ScaleGradientWithRespectToMovingImageOrientation{ false };
+  bool   m_UseInterleavedMovingImageCache{ false };
 
   MovingImageDerivativeScalesType m_MovingImageDerivativeScales{ MovingImageDerivativeScalesType::Filled(1.0) };
 };
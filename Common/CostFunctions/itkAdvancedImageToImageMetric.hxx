@@ -60,6 +60,10 @@ AdvancedImageToImageMetric<TFixedImage, TMovingImage>::AdvancedImageToImageMetri
   /** Initialize the m_ThreaderMetricParameters. */
   this->m_ThreaderMetricParameters.st_Metric = this;
 
+  /** Create the threader that runs the threaded metric computations. */
+  this->m_MetricThreader = CreateMultiThreader(this->m_MultiThreaderType);
+  this->m_MetricThreader->SetNumberOfWorkUnits(Superclass::GetNumberOfWorkUnits());
+
 } // end Constructor
 
 
@@ -74,6 +78,7 @@ AdvancedImageToImageMetric<TFixedImage, TMovingImage>::SetNumberOfWorkUnits(Thre
   // Note: This is a workaround for ITK5, which renamed NumberOfThreads
   // to NumberOfWorkUnits
   Superclass::SetNumberOfWorkUnits(numberOfThreads);
+  this->m_MetricThreader->SetNumberOfWorkUnits(Superclass::GetNumberOfWorkUnits());
 
 #ifdef ELASTIX_USE_OPENMP
   const int nthreads = static_cast<int>(Self::GetNumberOfWorkUnits());
@@ -82,6 +87,25 @@ AdvancedImageToImageMetric<TFixedImage, TMovingImage>::SetNumberOfWorkUnits(Thre
 } // end SetNumberOfWorkUnits()
 
 
+/**
+ * ********************* SetMultiThreaderType ****************************
+ */
+
+template <class TFixedImage, class TMovingImage>
+void
+AdvancedImageToImageMetric<TFixedImage, TMovingImage>::SetMultiThreaderType(const ThreaderEnum threaderType)
+{
+  if (this->m_MultiThreaderType != threaderType)
+  {
+    this->m_MultiThreaderType = threaderType;
+    this->m_MetricThreader = CreateMultiThreader(threaderType);
+    this->m_MetricThreader->SetNumberOfWorkUnits(Superclass::GetNumberOfWorkUnits());
+    this->Modified();
+  }
+
+} // end SetMultiThreaderType()
+
+
 /**
  * ********************* Initialize ****************************
  */
@@ -136,6 +160,9 @@ AdvancedImageToImageMetric<TFixedImage, TMovingImage>::InitializeThreadingParame
 {
   const ThreadIdType numberOfThreads = Self::GetNumberOfWorkUnits();
 
+  /** Let the threader launch exactly one work unit per set of per-thread variables. */
+  this->m_MetricThreader->SetNumberOfWorkUnits(numberOfThreads);
+
   /** Resize and initialize the threading related parameters.
    * The SetSize() functions do not resize the data when this is not
    * needed, which saves valuable re-allocation time.
@@ -365,6 +392,39 @@ AdvancedImageToImageMetric<TFixedImage, TMovingImage>::CheckForBSplineInterpolat
     itkDebugMacro("Interpolator is not BSplineFloat");
   }
 
+  /** Check for the B-spline interpolator with the recursive implementation,
+   * which is a special case of the B-spline interpolator.
+   */
+  this->m_InterpolatorIsRecursiveBSpline = false;
+  RecursiveBSplineInterpolatorType * testPtr4 =
+    dynamic_cast<RecursiveBSplineInterpolatorType *>(this->m_Interpolator.GetPointer());
+  if (testPtr4)
+  {
+    this->m_InterpolatorIsRecursiveBSpline = true;
+    this->m_RecursiveBSplineInterpolator = testPtr4;
+    itkDebugMacro("Interpolator is recursive B-spline");
+  }
+  else
+  {
+    this->m_RecursiveBSplineInterpolator = nullptr;
+    itkDebugMacro("Interpolator is not recursive B-spline");
+  }
+
+  this->m_InterpolatorIsRecursiveBSplineFloat = false;
+  RecursiveBSplineInterpolatorFloatType * testPtr5 =
+    dynamic_cast<RecursiveBSplineInterpolatorFloatType *>(this->m_Interpolator.GetPointer());
+  if (testPtr5)
+  {
+    this->m_InterpolatorIsRecursiveBSplineFloat = true;
+    this->m_RecursiveBSplineInterpolatorFloat = testPtr5;
+    itkDebugMacro("Interpolator is recursive BSplineFloat");
+  }
+  else
+  {
+    this->m_RecursiveBSplineInterpolatorFloat = nullptr;
+    itkDebugMacro("Interpolator is not recursive BSplineFloat");
+  }
+
   this->m_InterpolatorIsReducedBSpline = false;
   ReducedBSplineInterpolatorType * testPtr3 =
     dynamic_cast<ReducedBSplineInterpolatorType *>(this->m_Interpolator.GetPointer());
@@ -392,6 +452,10 @@ AdvancedImageToImageMetric<TFixedImage, TMovingImage>::CheckForBSplineInterpolat
     this->m_LinearInterpolator = nullptr;
   }
 
+  this->m_InterpolatorIsNearestNeighbor =
+    dynamic_cast<NearestNeighborInterpolatorType *>(this->m_Interpolator.GetPointer()) != nullptr;
+  this->m_InterleavedValueAndGradientFunction = nullptr;
+
   /** Don't overwrite the gradient image if GetComputeGradient() == true.
    * Otherwise we can use a forward difference derivative, or the derivative
    * provided by the B-spline interpolator.
@@ -417,8 +481,21 @@ AdvancedImageToImageMetric<TFixedImage, TMovingImage>::CheckForBSplineInterpolat
     const bool interpolatorIsRayCast =
       dynamic_cast<RayCastInterpolatorType *>(this->m_Interpolator.GetPointer()) != nullptr;
 
-    if (!this->m_InterpolatorIsBSpline && !this->m_InterpolatorIsBSplineFloat &&
-        !this->m_InterpolatorIsReducedBSpline && !this->m_InterpolatorIsLinear && !interpolatorIsRayCast)
+    const bool needsGradientImage = !this->m_InterpolatorIsBSpline && !this->m_InterpolatorIsBSplineFloat &&
+                                    !this->m_InterpolatorIsReducedBSpline && !this->m_InterpolatorIsLinear &&
+                                    !interpolatorIsRayCast;
+
+    /** With a nearest neighbor interpolator the value and the gradient are both
+     * taken from the nearest voxel, so they can be read from a single interleaved cache.
+     */
+    if (needsGradientImage && this->m_UseInterleavedMovingImageCache && this->m_InterpolatorIsNearestNeighbor)
+    {
+      this->m_InterleavedValueAndGradientFunction = InterleavedValueAndGradientFunctionType::New();
+      this->m_InterleavedValueAndGradientFunction->SetInputImage(this->m_MovingImage);
+      this->m_CentralDifferenceGradientFilter = nullptr;
+      this->m_GradientImage = nullptr;
+    }
+    else if (needsGradientImage)
     {
       this->m_CentralDifferenceGradientFilter = CentralDifferenceGradientFilterType::New();
       this->m_CentralDifferenceGradientFilter->SetUseImageSpacing(true);
@@ -531,7 +608,19 @@ AdvancedImageToImageMetric<TFixedImage, TMovingImage>::EvaluateMovingImageValueA
     /** Compute value and possibly derivative. */
     if (gradient)
     {
-      if (this->m_InterpolatorIsBSpline && !this->GetComputeGradient())
+      if (this->m_InterpolatorIsRecursiveBSpline && !this->GetComputeGradient())
+      {
+        /** Compute moving image value and gradient using the recursive B-spline implementation. */
+        this->m_RecursiveBSplineInterpolator->EvaluateValueAndDerivativeAtContinuousIndex(
+          cindex, movingImageValue, *gradient, optionalThreadId...);
+      }
+      else if (this->m_InterpolatorIsRecursiveBSplineFloat && !this->GetComputeGradient())
+      {
+        /** Compute moving image value and gradient using the recursive B-spline implementation. */
+        this->m_RecursiveBSplineInterpolatorFloat->EvaluateValueAndDerivativeAtContinuousIndex(
+          cindex, movingImageValue, *gradient, optionalThreadId...);
+      }
+      else if (this->m_InterpolatorIsBSpline && !this->GetComputeGradient())
       {
         /** Compute moving image value and gradient using the B-spline kernel. */
         this->m_BSplineInterpolator->EvaluateValueAndDerivativeAtContinuousIndex(
@@ -556,6 +645,12 @@ AdvancedImageToImageMetric<TFixedImage, TMovingImage>::EvaluateMovingImageValueA
         /** Compute moving image value and gradient using the linear interpolator. */
         this->m_LinearInterpolator->EvaluateValueAndDerivativeAtContinuousIndex(cindex, movingImageValue, *gradient);
       }
+      else if (this->m_InterleavedValueAndGradientFunction)
+      {
+        /** Read the value and gradient of the nearest voxel from the interleaved cache. */
+        this->m_InterleavedValueAndGradientFunction->EvaluateValueAndDerivativeAtContinuousIndex(
+          cindex, movingImageValue, *gradient);
+      }
       else
       {
         /** Get the gradient by NearestNeighboorInterpolation of the gradient image.
@@ -816,11 +911,11 @@ void
 AdvancedImageToImageMetric<TFixedImage, TMovingImage>::LaunchGetValueThreaderCallback(void) const
 {
   /** Setup threader. */
-  this->m_Threader->SetSingleMethod(this->GetValueThreaderCallback,
-                                    const_cast<void *>(static_cast<const void *>(&this->m_ThreaderMetricParameters)));
+  this->m_MetricThreader->SetSingleMethod(
+    this->GetValueThreaderCallback, const_cast<void *>(static_cast<const void *>(&this->m_ThreaderMetricParameters)));
 
   /** Launch. */
-  this->m_Threader->SingleMethodExecute();
+  this->m_MetricThreader->SingleMethodExecute();
 
 } // end LaunchGetValueThreaderCallback()
 
@@ -854,11 +949,12 @@ void
 AdvancedImageToImageMetric<TFixedImage, TMovingImage>::LaunchGetValueAndDerivativeThreaderCallback(void) const
 {
   /** Setup threader. */
-  this->m_Threader->SetSingleMethod(this->GetValueAndDerivativeThreaderCallback,
-                                    const_cast<void *>(static_cast<const void *>(&this->m_ThreaderMetricParameters)));
+  this->m_MetricThreader->SetSingleMethod(
+    this->GetValueAndDerivativeThreaderCallback,
+    const_cast<void *>(static_cast<const void *>(&this->m_ThreaderMetricParameters)));
 
   /** Launch. */
-  this->m_Threader->SingleMethodExecute();
+  this->m_MetricThreader->SingleMethodExecute();
 
 } // end LaunchGetValueAndDerivativeThreaderCallback()
 
@@ -964,8 +1060,20 @@ AdvancedImageToImageMetric<TFixedImage, TMovingImage>::PrintSelf(std::ostream &
   os << indent.GetNextIndent() << "InterpolatorIsBSplineFloat: " << this->m_InterpolatorIsBSplineFloat << std::endl;
   os << indent.GetNextIndent() << "BSplineInterpolatorFloat: " << this->m_BSplineInterpolatorFloat.GetPointer()
      << std::endl;
+  os << indent.GetNextIndent() << "InterpolatorIsRecursiveBSpline: " << this->m_InterpolatorIsRecursiveBSpline
+     << std::endl;
+  os << indent.GetNextIndent() << "RecursiveBSplineInterpolator: " << this->m_RecursiveBSplineInterpolator.GetPointer()
+     << std::endl;
+  os << indent.GetNextIndent() << "InterpolatorIsRecursiveBSplineFloat: "
+     << this->m_InterpolatorIsRecursiveBSplineFloat << std::endl;
+  os << indent.GetNextIndent()
+     << "RecursiveBSplineInterpolatorFloat: " << this->m_RecursiveBSplineInterpolatorFloat.GetPointer() << std::endl;
   os << indent.GetNextIndent()
      << "CentralDifferenceGradientFilter: " << this->m_CentralDifferenceGradientFilter.GetPointer() << std::endl;
+  os << indent.GetNextIndent() << "UseInterleavedMovingImageCache: " << this->m_UseInterleavedMovingImageCache
+     << std::endl;
+  os << indent.GetNextIndent() << "InterleavedValueAndGradientFunction: "
+     << this->m_InterleavedValueAndGradientFunction.GetPointer() << std::endl;
 
   /** Variables used when the transform is a B-spline transform. */
   os << indent << "Variables store the transform as an AdvancedTransform: " << std::endl;
@@ -979,6 +1087,13 @@ AdvancedImageToImageMetric<TFixedImage, TMovingImage>::PrintSelf(std::ostream &
      << std::endl;
   os << indent.GetNextIndent() << "MovingImageDerivativeScales: " << this->m_MovingImageDerivativeScales << std::endl;
 
+  /** Variables related to multi-threading. */
+  os << indent << "Variables related to multi-threading: " << std::endl;
+  os << indent.GetNextIndent() << "UseMultiThread: " << this->m_UseMultiThread << std::endl;
+  os << indent.GetNextIndent()
+     << "MultiThreaderType: " << ThreaderType::ThreaderTypeToString(this->m_MultiThreaderType) << std::endl;
+  os << indent.GetNextIndent() << "MetricThreader: " << this->m_MetricThreader.GetPointer() << std::endl;
+
 } // end PrintSelf()
 
 
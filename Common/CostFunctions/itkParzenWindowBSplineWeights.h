@@ -0,0 +1,149 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParzenWindowBSplineWeights_h
+#define itkParzenWindowBSplineWeights_h
+
+#include "itkMacro.h"
+#include <cmath>
+
+namespace itk
+{
+
+/** \class ParzenWindowBSplineWeights
+ * \brief Evaluates all B-spline Parzen window weights of a sample at once.
+ *
+ * Computes the same weights as BSplineKernelFunction2<VSplineOrder>::Evaluate( u, weights ),
+ * but with static functions, so without a virtual function call, and specialized at
+ * compile-time for the spline order. For order 1 to 3 each weight is a polynomial
+ * in |u|. All SplineOrder + 1 polynomials are evaluated together with Horner's scheme,
+ * where each step is a multiply-add on the vector of weights, which the compiler maps
+ * onto SIMD instructions.
+ *
+ * \warning Only implemented for spline order 0 to 3.
+ *
+ * \sa BSplineKernelFunction2, ParzenWindowHistogramImageToImageMetric
+ */
+
+template <unsigned int VSplineOrder>
+class ITK_TEMPLATE_EXPORT ParzenWindowBSplineWeights
+{
+public:
+  /** The spline order and the number of weights. */
+  itkStaticConstMacro(SplineOrder, unsigned int, VSplineOrder);
+  itkStaticConstMacro(NumberOfWeights, unsigned int, VSplineOrder + 1);
+
+  /** Evaluate the weights at the entire support, starting at u. */
+  static inline void
+  Evaluate(const double u, double * weights)
+  {
+    Evaluate(Dispatch<VSplineOrder>(), std::abs(u), weights);
+  }
+
+
+private:
+  /** Structures to control overloaded versions of Evaluate. */
+  struct DispatchBase
+  {};
+  template <unsigned int>
+  struct Dispatch : DispatchBase
+  {};
+
+  /** Evaluates the polynomials with the given coefficients at x. The
+   * coefficients are stored per power of x, so that the inner loops
+   * run over contiguous memory.
+   */
+  template <unsigned int VSize>
+  static inline void
+  EvaluatePolynomials(const double (&coefficients)[VSize][VSize], const double x, double * weights)
+  {
+    for (unsigned int k = 0; k < VSize; ++k)
+    {
+      weights[k] = coefficients[VSize - 1][k];
+    }
+    for (unsigned int j = VSize - 1; j > 0; --j)
+    {
+      for (unsigned int k = 0; k < VSize; ++k)
+      {
+        weights[k] = weights[k] * x + coefficients[j - 1][k];
+      }
+    }
+  }
+
+
+  /** Zeroth order spline. */
+  static inline void
+  Evaluate(const Dispatch<0> &, const double absValue, double * weights)
+  {
+    if (absValue < 0.5)
+    {
+      weights[0] = 1.0;
+    }
+    else if (absValue == 0.5)
+    {
+      weights[0] = 0.5;
+    }
+    else
+    {
+      weights[0] = 0.0;
+    }
+  }
+
+
+  /** First order spline. */
+  static inline void
+  Evaluate(const Dispatch<1> &, const double absValue, double * weights)
+  {
+    static constexpr double coefficients[2][2] = { { 1.0, 0.0 }, { -1.0, 1.0 } };
+    EvaluatePolynomials(coefficients, absValue, weights);
+  }
+
+
+  /** Second order spline. */
+  static inline void
+  Evaluate(const Dispatch<2> &, const double absValue, double * weights)
+  {
+    static constexpr double coefficients[3][3] = { { 1.125, -0.25, 0.125 },
+                                                   { -1.5, 2.0, -0.5 },
+                                                   { 0.5, -1.0, 0.5 } };
+    EvaluatePolynomials(coefficients, absValue, weights);
+  }
+
+
+  /** Third order spline. */
+  static inline void
+  Evaluate(const Dispatch<3> &, const double absValue, double * weights)
+  {
+    static constexpr double coefficients[4][4] = { { 8.0 / 6.0, -5.0 / 6.0, 4.0 / 6.0, -1.0 / 6.0 },
+                                                   { -2.0, 3.5, -2.0, 0.5 },
+                                                   { 1.0, -2.5, 2.0, -0.5 },
+                                                   { -1.0 / 6.0, 0.5, -0.5, 1.0 / 6.0 } };
+    EvaluatePolynomials(coefficients, absValue, weights);
+  }
+
+
+  /** Unimplemented spline order. */
+  static inline void
+  Evaluate(const DispatchBase &, const double, double *)
+  {
+    itkGenericExceptionMacro(<< "ParzenWindowBSplineWeights not implemented for spline order " << VSplineOrder);
+  }
+};
+
+} // end namespace itk
+
+#endif // end #ifndef itkParzenWindowBSplineWeights_h
@@ -193,6 +193,16 @@ public:
   itkGetConstReferenceMacro(UseExplicitPDFDerivatives, bool);
   itkBooleanMacro(UseExplicitPDFDerivatives);
 
+  /** The maximum amount of memory in megabytes for the explicit PDF derivatives.
+   * When the derivatives of the joint PDF to all parameters do not fit, they are
+   * computed per block of parameters instead, in parallel when multi-threading.
+   * As each block requires a loop over all samples, a small maximum makes the
+   * derivative computation slower.
+   * This option should be set before calling Initialize(); Default: 1024.
+   */
+  itkSetMacro(MaximumJointPDFDerivativesMemorySize, double);
+  itkGetConstMacro(MaximumJointPDFDerivativesMemorySize, double);
+
   /** Whether you plan to call the GetDerivative/GetValueAndDerivative method or not.
    * This option should be set before calling Initialize(); Default: false.
    */
@@ -237,6 +247,7 @@ protected:
   using typename Superclass::MovingImageDerivativeType;
   using typename Superclass::CentralDifferenceGradientFilterType;
   using typename Superclass::NonZeroJacobianIndicesType;
+  using typename Superclass::NumberOfParametersType;
 
   /** Typedefs for the PDFs and PDF derivatives. */
   typedef double                                       PDFValueType;
@@ -289,6 +300,11 @@ protected:
   double                        m_FixedParzenTermToIndexOffset;
   double                        m_MovingParzenTermToIndexOffset;
 
+  /** Whether the explicit PDF derivatives are computed per block of parameters,
+   * because m_JointPDFDerivatives would exceed the maximum memory size.
+   */
+  bool m_ComputeJointPDFDerivativesPerBlock;
+
   /** Kernels for computing Parzen histograms and derivatives. */
   KernelFunctionPointer m_FixedKernel;
   KernelFunctionPointer m_MovingKernel;
@@ -302,7 +318,10 @@ protected:
    */
   struct ParzenWindowHistogramMultiThreaderParameterType // can't we use the one from AdvancedImageToImageMetric ?
   {
-    Self * m_Metric;
+    Self *                 m_Metric;
+    const JointPDFType *   m_BinWeights;
+    DerivativeType *       m_Derivative;
+    NumberOfParametersType m_NumberOfParametersPerBlock;
   };
   ParzenWindowHistogramMultiThreaderParameterType m_ParzenWindowHistogramThreaderParameters;
 
@@ -329,14 +348,30 @@ protected:
   inline void
   ThreadedComputePDFs(ThreadIdType threadId);
 
-  /** Single-threadedly accumulate results. */
+  /** Accumulate results: the joint histograms are summed by AccumulateJointPDFs(). */
   inline void
   AfterThreadedComputePDFs(void) const;
 
+  /** Sum the per-thread joint PDFs into m_JointPDF. The histogram is divided into
+   * ranges of bins, which are summed in parallel, unless the total amount of work
+   * is too small to be worth launching the threads: the number of bins times the
+   * number of threads is less than 65536.
+   */
+  void
+  AccumulateJointPDFs(void) const;
+
+  /** Sum the per-thread joint PDFs into m_JointPDF, for the bins [ begin, end [ of the buffer. */
+  void
+  AccumulateJointPDFs(SizeValueType begin, SizeValueType end) const;
+
   /** Helper function to launch the threads. */
   static ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION
   ComputePDFsThreaderCallback(void * arg);
 
+  /** Helper function to sum the per-thread joint PDFs, each thread taking a range of bins. */
+  static ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION
+  AccumulateJointPDFsThreaderCallback(void * arg);
+
   /** Helper function to launch the threads. */
   void
   LaunchComputePDFsThreaderCallback(void) const;
@@ -363,6 +398,20 @@ protected:
                                const NonZeroJacobianIndicesType * nzji,
                                JointPDFType *                     jointPDF) const;
 
+  /** Update the joint PDF with a pixel pair, given its Parzen window terms and
+   * the lowest affected histogram bins. This is the path without derivatives of
+   * UpdateJointPDFAndDerivatives. It is specialized at compile-time for the kernel
+   * orders: the Parzen window weights are computed with ParzenWindowBSplineWeights,
+   * and added directly into the contiguous buffer of the joint PDF.
+   */
+  template <unsigned int VFixedKernelBSplineOrder, unsigned int VMovingKernelBSplineOrder>
+  void
+  UpdateJointPDF(double          fixedImageParzenWindowTerm,
+                 double          movingImageParzenWindowTerm,
+                 OffsetValueType fixedImageParzenWindowIndex,
+                 OffsetValueType movingImageParzenWindowIndex,
+                 JointPDFType *  jointPDF) const;
+
   /** Update the joint PDF and the incremental pdfs.
    * The input is a pixel pair (fixed, moving, moving mask) and
    * a set of moving image/mask values when using mu+delta*e_k, for
@@ -431,6 +480,45 @@ protected:
   virtual void
   ComputePDFsAndPDFDerivatives(const ParametersType & parameters) const;
 
+  /** Compute the derivative from the pdf derivatives, after ComputePDFsAndPDFDerivatives():
+   * derivative[ mu ] -= sum_{i,k} dhdmu(i,k) * binWeights(i,k)
+   * When the pdf derivatives fit in m_JointPDFDerivatives, they have been computed
+   * by ComputePDFsAndPDFDerivatives(). Otherwise, ComputePDFsAndPDFDerivatives() only
+   * computed the PDFs, and here the pdf derivatives are computed per block of
+   * parameters, and contracted block by block. Bins with a zero weight are skipped.
+   * Note that each block requires another loop over all samples, evaluating the
+   * transform, the moving image value and derivative, and the transform Jacobian
+   * again. So the block path is about (number of blocks / number of threads) times
+   * slower than computing all pdf derivatives at once, which is the price of
+   * its bounded memory use.
+   */
+  virtual void
+  ComputeDerivativeFromJointPDFDerivatives(const JointPDFType & binWeights, DerivativeType & derivative) const;
+
+  /** Compute the pdf derivatives dhdmu for the parameters [ blockBegin, blockEnd [,
+   * by looping over all samples, into a zero-initialized buffer with the layout of
+   * m_JointPDFDerivatives, but only blockEnd - blockBegin parameters.
+   */
+  void
+  ComputeJointPDFDerivativesBlock(NumberOfParametersType   blockBegin,
+                                  NumberOfParametersType   blockEnd,
+                                  ThreadIdType             threadId,
+                                  PDFDerivativeValueType * jointPDFDerivativesBlock) const;
+
+  /** Contract a block of pdf derivatives, for the parameters [ blockBegin, blockEnd [,
+   * with the bin weights into the derivative.
+   */
+  void
+  ContractJointPDFDerivatives(const PDFDerivativeValueType * jointPDFDerivativesBlock,
+                              NumberOfParametersType         blockBegin,
+                              NumberOfParametersType         blockEnd,
+                              const JointPDFType &           binWeights,
+                              DerivativeType &               derivative) const;
+
+  /** Helper function to compute and contract the blocks of pdf derivatives in parallel. */
+  static ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION
+  ComputeDerivativeFromJointPDFDerivativesThreaderCallback(void * arg);
+
   /** Compute PDFs and incremental pdfs (which you can use to compute finite
    * difference estimate of the derivative).
    * Loops over the fixed image samples and constructs the m_JointPDF,
@@ -505,6 +593,16 @@ private:
   void
   operator=(const Self &) = delete;
 
+  /** The UpdateJointPDF() specialization for the current kernel orders, selected by InitializeKernels(). */
+  typedef void (Self::*UpdateJointPDFFunctionType)(
+    double, double, OffsetValueType, OffsetValueType, JointPDFType *) const;
+  UpdateJointPDFFunctionType m_UpdateJointPDFFunction;
+
+  /** Returns the UpdateJointPDF() specialization for the given moving kernel order. */
+  template <unsigned int VFixedKernelBSplineOrder>
+  static UpdateJointPDFFunctionType
+  SelectUpdateJointPDFFunction(unsigned int movingKernelBSplineOrder);
+
   /** Variables that can/should be accessed by their Set/Get functions. */
   unsigned long m_NumberOfFixedHistogramBins;
   unsigned long m_NumberOfMovingHistogramBins;
@@ -514,6 +612,7 @@ private:
   bool          m_UseExplicitPDFDerivatives;
   bool          m_UseFiniteDifferenceDerivative;
   double        m_FiniteDifferencePerturbation;
+  double        m_MaximumJointPDFDerivativesMemorySize;
 };
 
 } // end namespace itk
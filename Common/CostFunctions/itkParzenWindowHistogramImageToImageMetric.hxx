@@ -24,7 +24,10 @@
 #include "itkBSplineDerivativeKernelFunction2.h"
 #include "itkImageLinearIteratorWithIndex.h"
 #include "itkImageScanlineIterator.h"
+#include "itkParzenWindowBSplineWeights.h"
 #include <vnl/vnl_math.h>
+#include <algorithm>
+#include <vector>
 
 namespace itk
 {
@@ -53,6 +56,7 @@ ParzenWindowHistogramImageToImageMetric<TFixedImage, TMovingImage>::ParzenWindow
   this->m_FixedKernel = nullptr;
   this->m_MovingKernel = nullptr;
   this->m_DerivativeMovingKernel = nullptr;
+  this->m_UpdateJointPDFFunction = nullptr;
   this->m_FixedKernelBSplineOrder = 0;
   this->m_MovingKernelBSplineOrder = 3;
   this->m_FixedParzenTermToIndexOffset = 0.5;
@@ -67,9 +71,14 @@ ParzenWindowHistogramImageToImageMetric<TFixedImage, TMovingImage>::ParzenWindow
   this->SetUseMovingImageLimiter(true);
 
   this->m_UseExplicitPDFDerivatives = true;
+  this->m_ComputeJointPDFDerivativesPerBlock = false;
+  this->m_MaximumJointPDFDerivativesMemorySize = 1024.0;
 
   /** Initialize the m_ParzenWindowHistogramThreaderParameters */
   this->m_ParzenWindowHistogramThreaderParameters.m_Metric = this;
+  this->m_ParzenWindowHistogramThreaderParameters.m_BinWeights = nullptr;
+  this->m_ParzenWindowHistogramThreaderParameters.m_Derivative = nullptr;
+  this->m_ParzenWindowHistogramThreaderParameters.m_NumberOfParametersPerBlock = 0;
 
   // Multi-threading structs
   this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables = nullptr;
@@ -105,6 +114,7 @@ ParzenWindowHistogramImageToImageMetric<TFixedImage, TMovingImage>::PrintSelf(st
   os << indent << "NumberOfMovingHistogramBins: " << this->m_NumberOfMovingHistogramBins << std::endl;
   os << indent << "FixedKernelBSplineOrder: " << this->m_FixedKernelBSplineOrder << std::endl;
   os << indent << "MovingKernelBSplineOrder: " << this->m_MovingKernelBSplineOrder << std::endl;
+  os << indent << "MaximumJointPDFDerivativesMemorySize: " << this->m_MaximumJointPDFDerivativesMemorySize << std::endl;
 
   /*double m_MovingImageNormalizedMin;
   double m_FixedImageNormalizedMin;
@@ -319,9 +329,22 @@ ParzenWindowHistogramImageToImageMetric<TFixedImage, TMovingImage>::InitializeHi
         this->m_IncrementalJointPDFRight = nullptr;
         this->m_IncrementalJointPDFLeft = nullptr;
 
-        this->m_JointPDFDerivatives = JointPDFDerivativesType::New();
-        this->m_JointPDFDerivatives->SetRegions(jointPDFDerivativesRegion);
-        this->m_JointPDFDerivatives->Allocate();
+        /** Only allocate the derivatives to all parameters when they fit in the
+         * maximum memory size. Otherwise they are computed per block of parameters.
+         */
+        const double memorySize = static_cast<double>(jointPDFDerivativesRegion.GetNumberOfPixels()) *
+                                  sizeof(PDFDerivativeValueType) / 1048576.0;
+        this->m_ComputeJointPDFDerivativesPerBlock = memorySize > this->m_MaximumJointPDFDerivativesMemorySize;
+        if (this->m_ComputeJointPDFDerivativesPerBlock)
+        {
+          this->m_JointPDFDerivatives = nullptr;
+        }
+        else
+        {
+          this->m_JointPDFDerivatives = JointPDFDerivativesType::New();
+          this->m_JointPDFDerivatives->SetRegions(jointPDFDerivativesRegion);
+          this->m_JointPDFDerivatives->Allocate();
+        }
       }
       else
       {
@@ -424,9 +447,50 @@ ParzenWindowHistogramImageToImageMetric<TFixedImage, TMovingImage>::InitializeKe
   this->m_FixedParzenTermToIndexOffset = 0.5 - static_cast<double>(this->m_FixedKernelBSplineOrder) / 2.0;
   this->m_MovingParzenTermToIndexOffset = 0.5 - static_cast<double>(this->m_MovingKernelBSplineOrder) / 2.0;
 
+  /** Select the joint PDF update that is specialized for these kernel orders. */
+  switch (this->m_FixedKernelBSplineOrder)
+  {
+    case 0:
+      this->m_UpdateJointPDFFunction = Self::SelectUpdateJointPDFFunction<0>(this->m_MovingKernelBSplineOrder);
+      break;
+    case 1:
+      this->m_UpdateJointPDFFunction = Self::SelectUpdateJointPDFFunction<1>(this->m_MovingKernelBSplineOrder);
+      break;
+    case 2:
+      this->m_UpdateJointPDFFunction = Self::SelectUpdateJointPDFFunction<2>(this->m_MovingKernelBSplineOrder);
+      break;
+    default:
+      this->m_UpdateJointPDFFunction = Self::SelectUpdateJointPDFFunction<3>(this->m_MovingKernelBSplineOrder);
+  } // end switch FixedKernelBSplineOrder
+
 } // end InitializeKernels()
 
 
+/**
+ * ****************** SelectUpdateJointPDFFunction *****************************
+ */
+
+template <class TFixedImage, class TMovingImage>
+template <unsigned int VFixedKernelBSplineOrder>
+typename ParzenWindowHistogramImageToImageMetric<TFixedImage, TMovingImage>::UpdateJointPDFFunctionType
+ParzenWindowHistogramImageToImageMetric<TFixedImage, TMovingImage>::SelectUpdateJointPDFFunction(
+  const unsigned int movingKernelBSplineOrder)
+{
+  switch (movingKernelBSplineOrder)
+  {
+    case 0:
+      return &Self::template UpdateJointPDF<VFixedKernelBSplineOrder, 0>;
+    case 1:
+      return &Self::template UpdateJointPDF<VFixedKernelBSplineOrder, 1>;
+    case 2:
+      return &Self::template UpdateJointPDF<VFixedKernelBSplineOrder, 2>;
+    default:
+      return &Self::template UpdateJointPDF<VFixedKernelBSplineOrder, 3>;
+  } // end switch movingKernelBSplineOrder
+
+} // end SelectUpdateJointPDFFunction()
+
+
 /**
  * ********************* InitializeThreadingParameters ****************************
  */
@@ -571,6 +635,17 @@ ParzenWindowHistogramImageToImageMetric<TFixedImage, TMovingImage>::UpdateJointP
   const OffsetValueType movingImageParzenWindowIndex =
     static_cast<OffsetValueType>(std::floor(movingImageParzenWindowTerm + this->m_MovingParzenTermToIndexOffset));
 
+  if (!imageJacobian)
+  {
+    /** Take the fast path, specialized for the kernel orders. */
+    (this->*m_UpdateJointPDFFunction)(fixedImageParzenWindowTerm,
+                                      movingImageParzenWindowTerm,
+                                      fixedImageParzenWindowIndex,
+                                      movingImageParzenWindowIndex,
+                                      jointPDF);
+    return;
+  }
+
   /** The Parzen values. */
   ParzenValueContainerType fixedParzenValues(this->m_JointPDFWindow.GetSize()[1]);
   ParzenValueContainerType movingParzenValues(this->m_JointPDFWindow.GetSize()[0]);
@@ -591,49 +666,80 @@ ParzenWindowHistogramImageToImageMetric<TFixedImage, TMovingImage>::UpdateJointP
   jointPDFWindow.SetIndex(pdfWindowIndex);
   PDFIteratorType it(jointPDF, jointPDFWindow);
 
-  if (!imageJacobian)
+  /** Compute the derivatives of the moving Parzen window. */
+  ParzenValueContainerType derivativeMovingParzenValues(this->m_JointPDFWindow.GetSize()[0]);
+  this->EvaluateParzenValues(movingImageParzenWindowTerm,
+                             movingImageParzenWindowIndex,
+                             this->m_DerivativeMovingKernel,
+                             derivativeMovingParzenValues);
+
+  const double et = static_cast<double>(this->m_MovingImageBinSize);
+
+  /** Loop over the Parzen window region and increment the values
+   * Also update the pdf derivatives.
+   */
+  for (unsigned int f = 0; f < fixedParzenValues.GetSize(); ++f)
   {
-    /** Loop over the Parzen window region and increment the values. */
-    for (unsigned int f = 0; f < fixedParzenValues.GetSize(); ++f)
+    const double fv = fixedParzenValues[f];
+    const double fv_et = fv / et;
+    for (unsigned int m = 0; m < movingParzenValues.GetSize(); ++m)
     {
-      const double fv = fixedParzenValues[f];
-      for (unsigned int m = 0; m < movingParzenValues.GetSize(); ++m)
-      {
-        it.Value() += static_cast<PDFValueType>(fv * movingParzenValues[m]);
-        ++it;
-      }
-      it.NextLine();
+      it.Value() += static_cast<PDFValueType>(fv * movingParzenValues[m]);
+      this->UpdateJointPDFDerivatives(it.GetIndex(), fv_et * derivativeMovingParzenValues[m], *imageJacobian, *nzji);
+      ++it;
     }
+    it.NextLine();
   }
-  else
-  {
-    /** Compute the derivatives of the moving Parzen window. */
-    ParzenValueContainerType derivativeMovingParzenValues(this->m_JointPDFWindow.GetSize()[0]);
-    this->EvaluateParzenValues(movingImageParzenWindowTerm,
-                               movingImageParzenWindowIndex,
-                               this->m_DerivativeMovingKernel,
-                               derivativeMovingParzenValues);
 
-    const double et = static_cast<double>(this->m_MovingImageBinSize);
+} // end UpdateJointPDFAndDerivatives()
 
-    /** Loop over the Parzen window region and increment the values
-     * Also update the pdf derivatives.
-     */
-    for (unsigned int f = 0; f < fixedParzenValues.GetSize(); ++f)
+
+/**
+ * ********************** UpdateJointPDF ***************
+ */
+
+template <class TFixedImage, class TMovingImage>
+template <unsigned int VFixedKernelBSplineOrder, unsigned int VMovingKernelBSplineOrder>
+void
+ParzenWindowHistogramImageToImageMetric<TFixedImage, TMovingImage>::UpdateJointPDF(
+  const double          fixedImageParzenWindowTerm,
+  const double          movingImageParzenWindowTerm,
+  const OffsetValueType fixedImageParzenWindowIndex,
+  const OffsetValueType movingImageParzenWindowIndex,
+  JointPDFType *        jointPDF) const
+{
+  typedef ParzenWindowBSplineWeights<VFixedKernelBSplineOrder>  FixedWeightsType;
+  typedef ParzenWindowBSplineWeights<VMovingKernelBSplineOrder> MovingWeightsType;
+  constexpr unsigned int fixedWindowSize = FixedWeightsType::NumberOfWeights;
+  constexpr unsigned int movingWindowSize = MovingWeightsType::NumberOfWeights;
+
+  /** The Parzen values, on the stack. */
+  double fixedParzenValues[fixedWindowSize];
+  double movingParzenValues[movingWindowSize];
+  FixedWeightsType::Evaluate(static_cast<double>(fixedImageParzenWindowIndex) - fixedImageParzenWindowTerm,
+                             fixedParzenValues);
+  MovingWeightsType::Evaluate(static_cast<double>(movingImageParzenWindowIndex) - movingImageParzenWindowTerm,
+                              movingParzenValues);
+
+  /** The joint PDF is stored with the moving bins along the lines, so the
+   * Parzen window is a block of fixedWindowSize lines of movingWindowSize bins.
+   */
+  const OffsetValueType lineOffset = jointPDF->GetOffsetTable()[1];
+  PDFValueType *        pdfPtr =
+    jointPDF->GetBufferPointer() + fixedImageParzenWindowIndex * lineOffset + movingImageParzenWindowIndex;
+
+  /** Loop over the Parzen window region and increment the values. */
+  for (unsigned int f = 0; f < fixedWindowSize; ++f)
+  {
+    const double fv = fixedParzenValues[f];
+    for (unsigned int m = 0; m < movingWindowSize; ++m)
     {
-      const double fv = fixedParzenValues[f];
-      const double fv_et = fv / et;
-      for (unsigned int m = 0; m < movingParzenValues.GetSize(); ++m)
-      {
-        it.Value() += static_cast<PDFValueType>(fv * movingParzenValues[m]);
-        this->UpdateJointPDFDerivatives(it.GetIndex(), fv_et * derivativeMovingParzenValues[m], *imageJacobian, *nzji);
-        ++it;
-      }
-      it.NextLine();
+      pdfPtr[m] += static_cast<PDFValueType>(fv * movingParzenValues[m]);
     }
+    pdfPtr += lineOffset;
   }
 
-} // end UpdateJointPDFAndDerivatives()
+} // end UpdateJointPDF()
 
 
 /**
@@ -1233,38 +1339,101 @@ ParzenWindowHistogramImageToImageMetric<TFixedImage, TMovingImage>::AfterThreade
   this->m_Alpha = 1.0 / static_cast<double>(this->m_NumberOfPixelsCounted);
 
   /** Accumulate joint histogram. */
-  // could be multi-threaded too, by each thread updating only a part of the JointPDF.
-  typedef ImageScanlineIterator<JointPDFType> JointPDFIteratorType;
-  JointPDFIteratorType                        it(this->m_JointPDF, this->m_JointPDF->GetBufferedRegion());
-  std::vector<JointPDFIteratorType>           itT(numberOfThreads);
-  for (ThreadIdType i = 0; i < numberOfThreads; ++i)
+  this->AccumulateJointPDFs();
+
+} // end AfterThreadedComputePDFs()
+
+
+/**
+ * ******************* AccumulateJointPDFs *******************
+ */
+
+template <class TFixedImage, class TMovingImage>
+void
+ParzenWindowHistogramImageToImageMetric<TFixedImage, TMovingImage>::AccumulateJointPDFs(void) const
+{
+  const ThreadIdType  numberOfThreads = Self::GetNumberOfWorkUnits();
+  const SizeValueType numberOfBins = this->m_JointPDF->GetBufferedRegion().GetNumberOfPixels();
+
+  /** Summing a few small histograms is faster than launching the threads. */
+  const SizeValueType minimumNumberOfAdditionsForMultiThreading = 65536;
+  if (numberOfThreads == 1 || numberOfBins * numberOfThreads < minimumNumberOfAdditionsForMultiThreading)
   {
-    itT[i] = JointPDFIteratorType(this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables[i].st_JointPDF,
-                                  this->m_JointPDF->GetBufferedRegion());
+    this->AccumulateJointPDFs(0, numberOfBins);
+    return;
   }
 
-  PDFValueType sum;
-  while (!it.IsAtEnd())
+  /** Sum the ranges of bins in parallel. */
+  this->m_MetricThreader->SetSingleMethod(
+    this->AccumulateJointPDFsThreaderCallback,
+    const_cast<void *>(static_cast<const void *>(&this->m_ParzenWindowHistogramThreaderParameters)));
+  this->m_MetricThreader->SingleMethodExecute();
+
+} // end AccumulateJointPDFs()
+
+
+/**
+ * ******************* AccumulateJointPDFs *******************
+ */
+
+template <class TFixedImage, class TMovingImage>
+void
+ParzenWindowHistogramImageToImageMetric<TFixedImage, TMovingImage>::AccumulateJointPDFs(const SizeValueType begin,
+                                                                                        const SizeValueType end) const
+{
+  const ThreadIdType numberOfThreads = Self::GetNumberOfWorkUnits();
+  PDFValueType *     sumPtr = this->m_JointPDF->GetBufferPointer();
+
+  /** Copy the first histogram, and add the others one by one. Running through
+   * each histogram contiguously keeps the inner loop simple and vectorizable.
+   */
+  const PDFValueType * threadPtr =
+    this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables[0].st_JointPDF->GetBufferPointer();
+  std::copy(threadPtr + begin, threadPtr + end, sumPtr + begin);
+  for (ThreadIdType i = 1; i < numberOfThreads; ++i)
   {
-    while (!it.IsAtEndOfLine())
+    threadPtr =
+      this->m_ParzenWindowHistogramGetValueAndDerivativePerThreadVariables[i].st_JointPDF->GetBufferPointer();
+    for (SizeValueType j = begin; j < end; ++j)
     {
-      sum = NumericTraits<PDFValueType>::Zero;
-      for (ThreadIdType i = 0; i < numberOfThreads; ++i)
-      {
-        sum += itT[i].Value();
-        ++itT[i];
-      }
-      it.Set(sum);
-      ++it;
-    }
-    it.NextLine();
-    for (ThreadIdType i = 0; i < numberOfThreads; ++i)
-    {
-      itT[i].NextLine();
+      sumPtr[j] += threadPtr[j];
     }
   }
 
-} // end AfterThreadedComputePDFs()
+} // end AccumulateJointPDFs()
+
+
+/**
+ * **************** AccumulateJointPDFsThreaderCallback *******
+ */
+
+template <class TFixedImage, class TMovingImage>
+ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION
+ParzenWindowHistogramImageToImageMetric<TFixedImage, TMovingImage>::AccumulateJointPDFsThreaderCallback(void * arg)
+{
+  ThreadInfoType * infoStruct = static_cast<ThreadInfoType *>(arg);
+  ThreadIdType     threadId = infoStruct->WorkUnitID;
+  ThreadIdType     nrOfThreads = infoStruct->NumberOfWorkUnits;
+
+  ParzenWindowHistogramMultiThreaderParameterType * temp =
+    static_cast<ParzenWindowHistogramMultiThreaderParameterType *>(infoStruct->UserData);
+
+  /** Divide the bins in ranges of whole cache lines, to prevent false sharing. */
+  const SizeValueType numberOfBins = temp->m_Metric->m_JointPDF->GetBufferedRegion().GetNumberOfPixels();
+  const SizeValueType binsPerCacheLine = std::max<SizeValueType>(ITK_CACHE_LINE_ALIGNMENT / sizeof(PDFValueType), 1);
+  const SizeValueType numberOfCacheLines = (numberOfBins + binsPerCacheLine - 1) / binsPerCacheLine;
+  const SizeValueType cacheLinesPerThread = (numberOfCacheLines + nrOfThreads - 1) / nrOfThreads;
+
+  const SizeValueType begin = std::min(numberOfBins, threadId * cacheLinesPerThread * binsPerCacheLine);
+  const SizeValueType end = std::min(numberOfBins, (threadId + 1) * cacheLinesPerThread * binsPerCacheLine);
+  if (begin < end)
+  {
+    temp->m_Metric->AccumulateJointPDFs(begin, end);
+  }
+
+  return itk::ITK_THREAD_RETURN_DEFAULT_VALUE;
+
+} // end AccumulateJointPDFsThreaderCallback()
 
 
 /**
@@ -1297,12 +1466,12 @@ void
 ParzenWindowHistogramImageToImageMetric<TFixedImage, TMovingImage>::LaunchComputePDFsThreaderCallback(void) const
 {
   /** Setup threader. */
-  this->m_Threader->SetSingleMethod(
+  this->m_MetricThreader->SetSingleMethod(
     this->ComputePDFsThreaderCallback,
     const_cast<void *>(static_cast<const void *>(&this->m_ParzenWindowHistogramThreaderParameters)));
 
   /** Launch. */
-  this->m_Threader->SingleMethodExecute();
+  this->m_MetricThreader->SingleMethodExecute();
 
 } // end LaunchComputePDFsThreaderCallback()
 
@@ -1316,6 +1485,16 @@ void
 ParzenWindowHistogramImageToImageMetric<TFixedImage, TMovingImage>::ComputePDFsAndPDFDerivatives(
   const ParametersType & parameters) const
 {
+  /** When the pdf derivatives do not fit in memory, only compute the PDFs here.
+   * The pdf derivatives are then computed per block of parameters, in
+   * ComputeDerivativeFromJointPDFDerivatives().
+   */
+  if (this->m_ComputeJointPDFDerivativesPerBlock)
+  {
+    this->ComputePDFs(parameters);
+    return;
+  }
+
   /** Initialize some variables. */
   this->m_JointPDF->FillBuffer(0.0);
   this->m_JointPDFDerivatives->FillBuffer(0.0);
@@ -1414,6 +1593,271 @@ ParzenWindowHistogramImageToImageMetric<TFixedImage, TMovingImage>::ComputePDFsA
 } // end ComputePDFsAndPDFDerivatives()
 
 
+/**
+ * ************************ ComputeDerivativeFromJointPDFDerivatives *******************
+ */
+
+template <class TFixedImage, class TMovingImage>
+void
+ParzenWindowHistogramImageToImageMetric<TFixedImage, TMovingImage>::ComputeDerivativeFromJointPDFDerivatives(
+  const JointPDFType & binWeights,
+  DerivativeType &     derivative) const
+{
+  const NumberOfParametersType numberOfParameters = this->GetNumberOfParameters();
+
+  /** The pdf derivatives to all parameters have been computed at once. */
+  if (!this->m_ComputeJointPDFDerivativesPerBlock)
+  {
+    this->ContractJointPDFDerivatives(
+      this->m_JointPDFDerivatives->GetBufferPointer(), 0, numberOfParameters, binWeights, derivative);
+    return;
+  }
+
+  /** Otherwise, each thread computes and contracts one block at a time, so the
+   * size of the blocks is limited by the maximum memory size over all threads.
+   */
+  const ThreadIdType  numberOfThreads = this->m_UseMultiThread ? Self::GetNumberOfWorkUnits() : 1;
+  const SizeValueType numberOfBins = this->m_JointPDF->GetBufferedRegion().GetNumberOfPixels();
+  const double memorySizePerParameter = static_cast<double>(numberOfBins) * sizeof(PDFDerivativeValueType) / 1048576.0;
+  NumberOfParametersType numberOfParametersPerBlock = static_cast<NumberOfParametersType>(
+    this->m_MaximumJointPDFDerivativesMemorySize / (memorySizePerParameter * numberOfThreads));
+  numberOfParametersPerBlock = std::max<NumberOfParametersType>(numberOfParametersPerBlock, 1);
+  numberOfParametersPerBlock = std::min<NumberOfParametersType>(
+    numberOfParametersPerBlock, (numberOfParameters + numberOfThreads - 1) / numberOfThreads);
+
+  if (!this->m_UseMultiThread)
+  {
+    std::vector<PDFDerivativeValueType> jointPDFDerivativesBlock;
+    for (NumberOfParametersType blockBegin = 0; blockBegin < numberOfParameters;
+         blockBegin += numberOfParametersPerBlock)
+    {
+      const NumberOfParametersType blockEnd = std::min(blockBegin + numberOfParametersPerBlock, numberOfParameters);
+      jointPDFDerivativesBlock.assign((blockEnd - blockBegin) * numberOfBins, 0.0f);
+      this->ComputeJointPDFDerivativesBlock(blockBegin, blockEnd, 0, jointPDFDerivativesBlock.data());
+      this->ContractJointPDFDerivatives(jointPDFDerivativesBlock.data(), blockBegin, blockEnd, binWeights, derivative);
+    }
+    return;
+  }
+
+  /** Compute the blocks in parallel. Each thread writes a disjoint range of the derivative. */
+  this->m_ParzenWindowHistogramThreaderParameters.m_BinWeights = &binWeights;
+  this->m_ParzenWindowHistogramThreaderParameters.m_Derivative = &derivative;
+  this->m_ParzenWindowHistogramThreaderParameters.m_NumberOfParametersPerBlock = numberOfParametersPerBlock;
+
+  this->m_MetricThreader->SetSingleMethod(
+    this->ComputeDerivativeFromJointPDFDerivativesThreaderCallback,
+    const_cast<void *>(static_cast<const void *>(&this->m_ParzenWindowHistogramThreaderParameters)));
+  this->m_MetricThreader->SingleMethodExecute();
+
+} // end ComputeDerivativeFromJointPDFDerivatives()
+
+
+/**
+ * **************** ComputeDerivativeFromJointPDFDerivativesThreaderCallback *******
+ */
+
+template <class TFixedImage, class TMovingImage>
+ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION
+ParzenWindowHistogramImageToImageMetric<TFixedImage, TMovingImage>::
+  ComputeDerivativeFromJointPDFDerivativesThreaderCallback(void * arg)
+{
+  ThreadInfoType * infoStruct = static_cast<ThreadInfoType *>(arg);
+  ThreadIdType     threadId = infoStruct->WorkUnitID;
+  ThreadIdType     nrOfThreads = infoStruct->NumberOfWorkUnits;
+
+  ParzenWindowHistogramMultiThreaderParameterType * temp =
+    static_cast<ParzenWindowHistogramMultiThreaderParameterType *>(infoStruct->UserData);
+
+  const NumberOfParametersType numberOfParameters = temp->m_Metric->GetNumberOfParameters();
+  const NumberOfParametersType numberOfParametersPerBlock = temp->m_NumberOfParametersPerBlock;
+  const SizeValueType          numberOfBins = temp->m_Metric->m_JointPDF->GetBufferedRegion().GetNumberOfPixels();
+
+  /** Take the blocks threadId, threadId + nrOfThreads, etc. */
+  std::vector<PDFDerivativeValueType> jointPDFDerivativesBlock;
+  for (NumberOfParametersType blockBegin = threadId * numberOfParametersPerBlock; blockBegin < numberOfParameters;
+       blockBegin += nrOfThreads * numberOfParametersPerBlock)
+  {
+    const NumberOfParametersType blockEnd = std::min(blockBegin + numberOfParametersPerBlock, numberOfParameters);
+    jointPDFDerivativesBlock.assign((blockEnd - blockBegin) * numberOfBins, 0.0f);
+    temp->m_Metric->ComputeJointPDFDerivativesBlock(blockBegin, blockEnd, threadId, jointPDFDerivativesBlock.data());
+    temp->m_Metric->ContractJointPDFDerivatives(
+      jointPDFDerivativesBlock.data(), blockBegin, blockEnd, *temp->m_BinWeights, *temp->m_Derivative);
+  }
+
+  return itk::ITK_THREAD_RETURN_DEFAULT_VALUE;
+
+} // end ComputeDerivativeFromJointPDFDerivativesThreaderCallback()
+
+
+/**
+ * ************************ ComputeJointPDFDerivativesBlock *******************
+ */
+
+template <class TFixedImage, class TMovingImage>
+void
+ParzenWindowHistogramImageToImageMetric<TFixedImage, TMovingImage>::ComputeJointPDFDerivativesBlock(
+  const NumberOfParametersType blockBegin,
+  const NumberOfParametersType blockEnd,
+  const ThreadIdType           threadId,
+  PDFDerivativeValueType *     jointPDFDerivativesBlock) const
+{
+  /** Array that stores dM(x)/dmu, and the sparse jacobian+indices. */
+  NonZeroJacobianIndicesType nzji(this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices());
+  DerivativeType             imageJacobian(nzji.size());
+  TransformJacobianType      jacobian;
+
+  /** The positions in nzji of the parameters within this block. */
+  std::vector<unsigned int> blockEntries;
+  blockEntries.reserve(nzji.size());
+
+  /** The Parzen values. */
+  ParzenValueContainerType fixedParzenValues(this->m_JointPDFWindow.GetSize()[1]);
+  ParzenValueContainerType derivativeMovingParzenValues(this->m_JointPDFWindow.GetSize()[0]);
+
+  const NumberOfParametersType blockSize = blockEnd - blockBegin;
+  const OffsetValueType        numberOfMovingBins = this->m_JointPDF->GetOffsetTable()[1];
+  const double                 et = static_cast<double>(this->m_MovingImageBinSize);
+
+  /** Get a handle to the sample container. */
+  ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
+
+  /** Create iterator over the sample container. */
+  typename ImageSampleContainerType::ConstIterator fiter;
+  typename ImageSampleContainerType::ConstIterator fbegin = sampleContainer->Begin();
+  typename ImageSampleContainerType::ConstIterator fend = sampleContainer->End();
+
+  /** Loop over all samples and compute their contribution to this block of pdf derivatives. */
+  for (fiter = fbegin; fiter != fend; ++fiter)
+  {
+    /** Read fixed coordinates and initialize some variables. */
+    const FixedImagePointType & fixedPoint = (*fiter).Value().m_ImageCoordinates;
+    RealType                    movingImageValue;
+    MovingImagePointType        mappedPoint;
+    MovingImageDerivativeType   movingImageDerivative;
+
+    /** Transform point and check if it is inside the B-spline support region. */
+    bool sampleOk = this->TransformPoint(fixedPoint, mappedPoint);
+
+    /** Check if point is inside mask. */
+    if (sampleOk)
+    {
+      sampleOk = this->IsInsideMovingMask(mappedPoint);
+    }
+
+    /** Compute the moving image value M(T(x)) and derivative dM/dx and check if
+     * the point is inside the moving image buffer.
+     */
+    if (sampleOk)
+    {
+      sampleOk = this->m_UseMultiThread
+                   ? this->FastEvaluateMovingImageValueAndDerivative(
+                       mappedPoint, movingImageValue, &movingImageDerivative, threadId)
+                   : this->Superclass::EvaluateMovingImageValueAndDerivative(
+                       mappedPoint, movingImageValue, &movingImageDerivative);
+    }
+
+    if (!sampleOk)
+    {
+      continue;
+    }
+
+    /** Get the TransformJacobian dT/dmu, and skip samples that do not affect this block. */
+    this->EvaluateTransformJacobian(fixedPoint, jacobian, nzji);
+    blockEntries.clear();
+    for (unsigned int i = 0; i < nzji.size(); ++i)
+    {
+      if (nzji[i] >= blockBegin && nzji[i] < blockEnd)
+      {
+        blockEntries.push_back(i);
+      }
+    }
+    if (blockEntries.empty())
+    {
+      continue;
+    }
+
+    /** Get the fixed image value. */
+    RealType fixedImageValue = static_cast<RealType>((*fiter).Value().m_ImageValue);
+
+    /** Make sure the values fall within the histogram range. */
+    fixedImageValue = this->GetFixedImageLimiter()->Evaluate(fixedImageValue);
+    movingImageValue = this->GetMovingImageLimiter()->Evaluate(movingImageValue, movingImageDerivative);
+
+    /** Compute the inner product (dM/dx)^T (dT/dmu). */
+    this->EvaluateTransformJacobianInnerProduct(jacobian, movingImageDerivative, imageJacobian);
+
+    /** Determine the Parzen windows, as in UpdateJointPDFAndDerivatives(). */
+    const double fixedImageParzenWindowTerm =
+      fixedImageValue / this->m_FixedImageBinSize - this->m_FixedImageNormalizedMin;
+    const double movingImageParzenWindowTerm =
+      movingImageValue / this->m_MovingImageBinSize - this->m_MovingImageNormalizedMin;
+    const OffsetValueType fixedImageParzenWindowIndex =
+      static_cast<OffsetValueType>(std::floor(fixedImageParzenWindowTerm + this->m_FixedParzenTermToIndexOffset));
+    const OffsetValueType movingImageParzenWindowIndex =
+      static_cast<OffsetValueType>(std::floor(movingImageParzenWindowTerm + this->m_MovingParzenTermToIndexOffset));
+    this->EvaluateParzenValues(
+      fixedImageParzenWindowTerm, fixedImageParzenWindowIndex, this->m_FixedKernel, fixedParzenValues);
+    this->EvaluateParzenValues(movingImageParzenWindowTerm,
+                               movingImageParzenWindowIndex,
+                               this->m_DerivativeMovingKernel,
+                               derivativeMovingParzenValues);
+
+    /** Update the pdf derivatives of this block, as in UpdateJointPDFDerivatives(). */
+    for (unsigned int f = 0; f < fixedParzenValues.GetSize(); ++f)
+    {
+      const double fv_et = fixedParzenValues[f] / et;
+      for (unsigned int m = 0; m < derivativeMovingParzenValues.GetSize(); ++m)
+      {
+        const double             factor = fv_et * derivativeMovingParzenValues[m];
+        const OffsetValueType    bin =
+          (fixedImageParzenWindowIndex + f) * numberOfMovingBins + movingImageParzenWindowIndex + m;
+        PDFDerivativeValueType * derivPtr = jointPDFDerivativesBlock + bin * blockSize - blockBegin;
+        for (const unsigned int i : blockEntries)
+        {
+          derivPtr[nzji[i]] -= static_cast<PDFDerivativeValueType>(imageJacobian[i] * factor);
+        }
+      }
+    }
+  } // end iterating over fixed image spatial sample container for loop
+
+} // end ComputeJointPDFDerivativesBlock()
+
+
+/**
+ * ************************ ContractJointPDFDerivatives *******************
+ */
+
+template <class TFixedImage, class TMovingImage>
+void
+ParzenWindowHistogramImageToImageMetric<TFixedImage, TMovingImage>::ContractJointPDFDerivatives(
+  const PDFDerivativeValueType * jointPDFDerivativesBlock,
+  const NumberOfParametersType   blockBegin,
+  const NumberOfParametersType   blockEnd,
+  const JointPDFType &           binWeights,
+  DerivativeType &               derivative) const
+{
+  const NumberOfParametersType blockSize = blockEnd - blockBegin;
+  const SizeValueType          numberOfBins = binWeights.GetBufferedRegion().GetNumberOfPixels();
+  const PDFValueType *         weightPtr = binWeights.GetBufferPointer();
+  DerivativeValueType *        derivPtr = derivative.begin() + blockBegin;
+
+  /** Loop over the joint histogram, and skip the bins without contribution. */
+  for (SizeValueType bin = 0; bin < numberOfBins; ++bin)
+  {
+    const double weight = weightPtr[bin];
+    if (weight != 0.0)
+    {
+      const PDFDerivativeValueType * jointPDFDerivativesPtr = jointPDFDerivativesBlock + bin * blockSize;
+      for (NumberOfParametersType j = 0; j < blockSize; ++j)
+      {
+        derivPtr[j] -= jointPDFDerivativesPtr[j] * weight;
+      }
+    }
+  }
+
+} // end ContractJointPDFDerivatives()
+
+
 /**
  * ************************ ComputePDFsAndIncrementalPDFs *******************
  */
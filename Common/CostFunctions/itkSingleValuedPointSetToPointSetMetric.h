@@ -40,6 +40,9 @@
 #include "itkMacro.h"
 #include "itkSpatialObject.h"
 #include "itkPointSet.h"
+#include "itkPlatformMultiThreader.h"
+
+#include <memory> // For unique_ptr.
 
 namespace itk
 {
@@ -113,6 +116,10 @@ public:
   /** Typedefs for support of sparse Jacobians and compact support of transformations. */
   typedef typename TransformType::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
 
+  /** Typedefs for multi-threading. */
+  typedef PlatformMultiThreader               ThreaderType;
+  typedef typename ThreaderType::WorkUnitInfo ThreadInfoType;
+
   /** Connect the fixed pointset.  */
   itkSetConstObjectMacro(FixedPointSet, FixedPointSetType);
 
@@ -170,6 +177,23 @@ public:
   itkGetConstReferenceMacro(UseMetricSingleThreaded, bool);
   itkBooleanMacro(UseMetricSingleThreaded);
 
+  /** Select the use of multi-threading in the loop over the points. */
+  itkSetMacro(UseMultiThread, bool);
+  itkGetConstReferenceMacro(UseMultiThread, bool);
+  itkBooleanMacro(UseMultiThread);
+
+  /** Set/Get the number of threads used for the loop over the points. */
+  virtual void
+  SetNumberOfWorkUnits(ThreadIdType numberOfThreads)
+  {
+    this->m_Threader->SetNumberOfWorkUnits(numberOfThreads);
+  }
+  virtual ThreadIdType
+  GetNumberOfWorkUnits(void) const
+  {
+    return this->m_Threader->GetNumberOfWorkUnits();
+  }
+
 protected:
   SingleValuedPointSetToPointSetMetric();
   ~SingleValuedPointSetToPointSetMetric() override = default;
@@ -188,7 +212,82 @@ protected:
   mutable unsigned int m_NumberOfPointsCounted;
 
   /** Variables for multi-threading. */
-  bool m_UseMetricSingleThreaded;
+  bool                           m_UseMetricSingleThreaded;
+  bool                           m_UseMultiThread{ false };
+  typename ThreaderType::Pointer m_Threader;
+
+  /** Multi-threaded metric computation. Each thread handles the contiguous
+   * range of points given by GetPointRangeForThread(), and accumulates its
+   * contribution in m_GetValueAndDerivativePerThreadVariables[ threadID ].
+   */
+  virtual void
+  ThreadedGetValueAndDerivative(ThreadIdType itkNotUsed(threadID)) const
+  {}
+
+  /** Gather the values and derivatives from all threads. The default
+   * implementation sums the values and point counts of all threads, and
+   * normalizes the summed value and derivative by the number of points counted.
+   */
+  virtual void
+  AfterThreadedGetValueAndDerivative(MeasureType & value, DerivativeType & derivative) const;
+
+  /** Initialize the per-thread variables; called by Initialize. */
+  virtual void
+  InitializeThreadingParameters(void) const;
+
+  /** Get the range [ begin, end [ of point indices handled by a thread. */
+  void
+  GetPointRangeForThread(ThreadIdType threadID, SizeValueType & begin, SizeValueType & end) const;
+
+  /** Get the range [ begin, end [ of the elements [ 0, size [ handled by a thread. */
+  void
+  GetRangeForThread(ThreadIdType threadID, SizeValueType size, SizeValueType & begin, SizeValueType & end) const;
+
+  /** Launch a multi-threaded GetValueAndDerivative. */
+  void
+  LaunchGetValueAndDerivativeThreaderCallback(void) const;
+
+  /** Sum the per-thread derivatives into derivative, multi-threaded, and
+   * reset the per-thread derivatives for the next call.
+   */
+  void
+  AccumulateDerivatives(DerivativeType & derivative, const DerivativeValueType normalization) const;
+
+  /** GetValueAndDerivative threader callback function. */
+  static ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION
+  GetValueAndDerivativeThreaderCallback(void * arg);
+
+  /** AccumulateDerivatives threader callback function. */
+  static ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION
+  AccumulateDerivativesThreaderCallback(void * arg);
+
+  /** Helper struct that gives the threads access to all members. */
+  struct MultiThreaderParameterType
+  {
+    const SingleValuedPointSetToPointSetMetric * st_Metric;
+    // Used for accumulating derivatives
+    DerivativeValueType * st_DerivativePointer;
+    DerivativeValueType   st_NormalizationFactor;
+  };
+  mutable MultiThreaderParameterType m_ThreaderMetricParameters;
+
+  /** Per-thread struct with padding and alignment, to prevent false sharing. */
+  struct GetValueAndDerivativePerThreadStruct
+  {
+    SizeValueType  st_NumberOfPointsCounted;
+    MeasureType    st_Value;
+    DerivativeType st_Derivative;
+  };
+  itkPadStruct(ITK_CACHE_LINE_ALIGNMENT,
+               GetValueAndDerivativePerThreadStruct,
+               PaddedGetValueAndDerivativePerThreadStruct);
+  itkAlignedTypedef(ITK_CACHE_LINE_ALIGNMENT,
+                    PaddedGetValueAndDerivativePerThreadStruct,
+                    AlignedGetValueAndDerivativePerThreadStruct);
+  mutable std::unique_ptr<AlignedGetValueAndDerivativePerThreadStruct[]> m_GetValueAndDerivativePerThreadVariables{
+    nullptr
+  };
+  mutable ThreadIdType m_GetValueAndDerivativePerThreadVariablesSize{ 0 };
 
 private:
   SingleValuedPointSetToPointSetMetric(const Self &) = delete;
@@ -35,6 +35,8 @@
 #define itkSingleValuedPointSetToPointSetMetric_hxx
 
 #include "itkSingleValuedPointSetToPointSetMetric.h"
+#include <algorithm> // For min.
+#include <cmath>     // For ceil.
 
 namespace itk
 {
@@ -56,6 +58,9 @@ SingleValuedPointSetToPointSetMetric<TFixedPointSet, TMovingPointSet>::SingleVal
 
   this->m_UseMetricSingleThreaded = true;
 
+  this->m_Threader = ThreaderType::New();
+  this->m_ThreaderMetricParameters.st_Metric = this;
+
 } // end Constructor
 
 
@@ -112,9 +117,83 @@ SingleValuedPointSetToPointSetMetric<TFixedPointSet, TMovingPointSet>::Initializ
     this->m_FixedPointSet->GetSource()->Update();
   }
 
+  /** Initialize some threading related parameters. */
+  if (this->m_UseMultiThread)
+  {
+    this->InitializeThreadingParameters();
+  }
+
 } // end Initialize()
 
 
+/**
+ * ********************* InitializeThreadingParameters ****************************
+ */
+
+template <class TFixedPointSet, class TMovingPointSet>
+void
+SingleValuedPointSetToPointSetMetric<TFixedPointSet, TMovingPointSet>::InitializeThreadingParameters(void) const
+{
+  const ThreadIdType numberOfThreads = this->GetNumberOfWorkUnits();
+
+  /** Only resize the array of structs when needed. */
+  if (this->m_GetValueAndDerivativePerThreadVariablesSize != numberOfThreads)
+  {
+    this->m_GetValueAndDerivativePerThreadVariables.reset(
+      new AlignedGetValueAndDerivativePerThreadStruct[numberOfThreads]);
+    this->m_GetValueAndDerivativePerThreadVariablesSize = numberOfThreads;
+  }
+
+  /** Some initialization. The derivatives are reset after each call
+   * in AccumulateDerivativesThreaderCallback().
+   */
+  for (ThreadIdType i = 0; i < numberOfThreads; ++i)
+  {
+    this->m_GetValueAndDerivativePerThreadVariables[i].st_NumberOfPointsCounted = NumericTraits<SizeValueType>::Zero;
+    this->m_GetValueAndDerivativePerThreadVariables[i].st_Value = NumericTraits<MeasureType>::Zero;
+    this->m_GetValueAndDerivativePerThreadVariables[i].st_Derivative.SetSize(this->GetNumberOfParameters());
+    this->m_GetValueAndDerivativePerThreadVariables[i].st_Derivative.Fill(
+      NumericTraits<DerivativeValueType>::ZeroValue());
+  }
+
+} // end InitializeThreadingParameters()
+
+
+/**
+ * ********************* GetPointRangeForThread ****************************
+ */
+
+template <class TFixedPointSet, class TMovingPointSet>
+void
+SingleValuedPointSetToPointSetMetric<TFixedPointSet, TMovingPointSet>::GetPointRangeForThread(ThreadIdType    threadID,
+                                                                                              SizeValueType & begin,
+                                                                                              SizeValueType & end) const
+{
+  this->GetRangeForThread(threadID, this->m_FixedPointSet->GetNumberOfPoints(), begin, end);
+
+} // end GetPointRangeForThread()
+
+
+/**
+ * ********************* GetRangeForThread ****************************
+ */
+
+template <class TFixedPointSet, class TMovingPointSet>
+void
+SingleValuedPointSetToPointSetMetric<TFixedPointSet, TMovingPointSet>::GetRangeForThread(ThreadIdType    threadID,
+                                                                                         SizeValueType   size,
+                                                                                         SizeValueType & begin,
+                                                                                         SizeValueType & end) const
+{
+  const SizeValueType numberOfThreads = this->GetNumberOfWorkUnits();
+  const SizeValueType chunkSize = (size + numberOfThreads - 1) / numberOfThreads;
+
+  begin = std::min(threadID * chunkSize, size);
+  end = std::min(begin + chunkSize, size);
+
+} // end GetRangeForThread()
+
+
 /**
  * *********************** BeforeThreadedGetValueAndDerivative ***********************
  */
@@ -133,6 +212,153 @@ SingleValuedPointSetToPointSetMetric<TFixedPointSet, TMovingPointSet>::BeforeThr
 } // end BeforeThreadedGetValueAndDerivative()
 
 
+/**
+ * *********************** AfterThreadedGetValueAndDerivative ***********************
+ */
+
+template <class TFixedPointSet, class TMovingPointSet>
+void
+SingleValuedPointSetToPointSetMetric<TFixedPointSet, TMovingPointSet>::AfterThreadedGetValueAndDerivative(
+  MeasureType &    value,
+  DerivativeType & derivative) const
+{
+  const ThreadIdType numberOfThreads = this->GetNumberOfWorkUnits();
+
+  /** Accumulate the number of points counted and the value. */
+  this->m_NumberOfPointsCounted = 0;
+  value = NumericTraits<MeasureType>::Zero;
+  for (ThreadIdType i = 0; i < numberOfThreads; ++i)
+  {
+    this->m_NumberOfPointsCounted += this->m_GetValueAndDerivativePerThreadVariables[i].st_NumberOfPointsCounted;
+    value += this->m_GetValueAndDerivativePerThreadVariables[i].st_Value;
+
+    /** Reset these variables for the next iteration. */
+    this->m_GetValueAndDerivativePerThreadVariables[i].st_NumberOfPointsCounted = 0;
+    this->m_GetValueAndDerivativePerThreadVariables[i].st_Value = NumericTraits<MeasureType>::Zero;
+  }
+
+  /** Accumulate the derivatives, normalized by the number of points counted. */
+  const DerivativeValueType normalization =
+    this->m_NumberOfPointsCounted > 0 ? static_cast<DerivativeValueType>(this->m_NumberOfPointsCounted) : 1.0;
+  this->AccumulateDerivatives(derivative, normalization);
+  value /= normalization;
+
+} // end AfterThreadedGetValueAndDerivative()
+
+
+/**
+ * **************** GetValueAndDerivativeThreaderCallback *******
+ */
+
+template <class TFixedPointSet, class TMovingPointSet>
+ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION
+SingleValuedPointSetToPointSetMetric<TFixedPointSet, TMovingPointSet>::GetValueAndDerivativeThreaderCallback(void * arg)
+{
+  ThreadInfoType * infoStruct = static_cast<ThreadInfoType *>(arg);
+  ThreadIdType     threadID = infoStruct->WorkUnitID;
+
+  MultiThreaderParameterType * temp = static_cast<MultiThreaderParameterType *>(infoStruct->UserData);
+
+  temp->st_Metric->ThreadedGetValueAndDerivative(threadID);
+
+  return itk::ITK_THREAD_RETURN_DEFAULT_VALUE;
+
+} // end GetValueAndDerivativeThreaderCallback()
+
+
+/**
+ * *********************** LaunchGetValueAndDerivativeThreaderCallback***************
+ */
+
+template <class TFixedPointSet, class TMovingPointSet>
+void
+SingleValuedPointSetToPointSetMetric<TFixedPointSet, TMovingPointSet>::LaunchGetValueAndDerivativeThreaderCallback(
+  void) const
+{
+  /** The number of threads or parameters may have changed since Initialize(). */
+  if (this->m_GetValueAndDerivativePerThreadVariablesSize != this->GetNumberOfWorkUnits() ||
+      this->m_GetValueAndDerivativePerThreadVariables[0].st_Derivative.GetSize() != this->GetNumberOfParameters())
+  {
+    this->InitializeThreadingParameters();
+  }
+
+  /** Setup threader. */
+  this->m_Threader->SetSingleMethod(this->GetValueAndDerivativeThreaderCallback,
+                                    const_cast<void *>(static_cast<const void *>(&this->m_ThreaderMetricParameters)));
+
+  /** Launch. */
+  this->m_Threader->SingleMethodExecute();
+
+} // end LaunchGetValueAndDerivativeThreaderCallback()
+
+
+/**
+ * *********************** AccumulateDerivatives ***************
+ */
+
+template <class TFixedPointSet, class TMovingPointSet>
+void
+SingleValuedPointSetToPointSetMetric<TFixedPointSet, TMovingPointSet>::AccumulateDerivatives(
+  DerivativeType &          derivative,
+  const DerivativeValueType normalization) const
+{
+  this->m_ThreaderMetricParameters.st_DerivativePointer = derivative.begin();
+  this->m_ThreaderMetricParameters.st_NormalizationFactor = normalization;
+
+  /** Setup threader. */
+  this->m_Threader->SetSingleMethod(this->AccumulateDerivativesThreaderCallback,
+                                    const_cast<void *>(static_cast<const void *>(&this->m_ThreaderMetricParameters)));
+
+  /** Launch. */
+  this->m_Threader->SingleMethodExecute();
+
+} // end AccumulateDerivatives()
+
+
+/**
+ *********** AccumulateDerivativesThreaderCallback *************
+ */
+
+template <class TFixedPointSet, class TMovingPointSet>
+ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION
+SingleValuedPointSetToPointSetMetric<TFixedPointSet, TMovingPointSet>::AccumulateDerivativesThreaderCallback(void * arg)
+{
+  ThreadInfoType * infoStruct = static_cast<ThreadInfoType *>(arg);
+  ThreadIdType     threadID = infoStruct->WorkUnitID;
+  ThreadIdType     nrOfThreads = infoStruct->NumberOfWorkUnits;
+
+  MultiThreaderParameterType * temp = static_cast<MultiThreaderParameterType *>(infoStruct->UserData);
+
+  const unsigned int numPar = temp->st_Metric->GetNumberOfParameters();
+  const unsigned int subSize =
+    static_cast<unsigned int>(std::ceil(static_cast<double>(numPar) / static_cast<double>(nrOfThreads)));
+  const unsigned int jmin = threadID * subSize;
+  unsigned int       jmax = (threadID + 1) * subSize;
+  jmax = (jmax > numPar) ? numPar : jmax;
+
+  /** This thread accumulates all sub-derivatives into a single one, for the
+   * range [ jmin, jmax [. Additionally, the sub-derivatives are reset.
+   */
+  const DerivativeValueType zero = NumericTraits<DerivativeValueType>::Zero;
+  const DerivativeValueType normalization = 1.0 / temp->st_NormalizationFactor;
+  for (unsigned int j = jmin; j < jmax; ++j)
+  {
+    DerivativeValueType tmp = zero;
+    for (ThreadIdType i = 0; i < nrOfThreads; ++i)
+    {
+      tmp += temp->st_Metric->m_GetValueAndDerivativePerThreadVariables[i].st_Derivative[j];
+
+      /** Reset this variable for the next iteration. */
+      temp->st_Metric->m_GetValueAndDerivativePerThreadVariables[i].st_Derivative[j] = zero;
+    }
+    temp->st_DerivativePointer[j] = tmp * normalization;
+  }
+
+  return itk::ITK_THREAD_RETURN_DEFAULT_VALUE;
+
+} // end AccumulateDerivativesThreaderCallback()
+
+
 /**
  * ******************* PrintSelf ***********************
  */
@@ -148,6 +374,7 @@ SingleValuedPointSetToPointSetMetric<TFixedPointSet, TMovingPointSet>::PrintSelf
   os << "Fixed mask: " << this->m_FixedImageMask.GetPointer() << std::endl;
   os << "Moving mask: " << this->m_MovingImageMask.GetPointer() << std::endl;
   os << "Transform: " << this->m_Transform.GetPointer() << std::endl;
+  os << "UseMultiThread: " << this->m_UseMultiThread << std::endl;
 
 } // end PrintSelf()
 
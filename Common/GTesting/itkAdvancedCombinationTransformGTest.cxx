@@ -0,0 +1,161 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// First include the header file to be tested:
+#include "itkAdvancedCombinationTransform.h"
+#include "itkAdvancedMatrixOffsetTransformBase.h"
+#include "itkRecursiveBSplineTransform.h"
+#include "../Core/Main/GTesting/elxCoreMainGTestUtilities.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+// Using-declaration:
+using elx::CoreMainGTestUtilities::CheckNew;
+
+namespace
+{
+constexpr unsigned int Dimension = 3;
+using CombinationType = itk::AdvancedCombinationTransform<double, Dimension>;
+using AffineType = itk::AdvancedMatrixOffsetTransformBase<double, Dimension, Dimension>;
+using BSplineType = itk::RecursiveBSplineTransform<double, Dimension, 3>;
+
+
+// Creates an affine transform with a rotation, scaling and translation.
+itk::SmartPointer<AffineType>
+CreateAffineTransform()
+{
+  const auto             affine = CheckNew<AffineType>();
+  AffineType::MatrixType matrix;
+  matrix(0, 0) = 0.98;
+  matrix(0, 1) = -0.17;
+  matrix(0, 2) = 0.02;
+  matrix(1, 0) = 0.17;
+  matrix(1, 1) = 1.03;
+  matrix(1, 2) = -0.05;
+  matrix(2, 0) = -0.01;
+  matrix(2, 1) = 0.06;
+  matrix(2, 2) = 0.95;
+  AffineType::OutputVectorType translation;
+  translation[0] = 2.5;
+  translation[1] = -1.5;
+  translation[2] = 3.0;
+  AffineType::InputPointType center;
+  center.Fill(10.0);
+  affine->SetCenter(center);
+  affine->SetMatrix(matrix);
+  affine->SetTranslation(translation);
+  return affine;
+}
+
+
+// Creates a B-spline transform with a grid spacing of 5 and smoothly varying coefficients.
+itk::SmartPointer<BSplineType>
+CreateBSplineTransform()
+{
+  const auto                 bspline = CheckNew<BSplineType>();
+  BSplineType::RegionType    gridRegion;
+  BSplineType::SpacingType   gridSpacing;
+  BSplineType::OriginType    gridOrigin;
+  BSplineType::DirectionType gridDirection;
+  gridRegion.SetSize(BSplineType::SizeType::Filled(12));
+  gridSpacing.Fill(5.0);
+  gridOrigin.Fill(-12.5);
+  gridDirection.SetIdentity();
+  bspline->SetGridRegion(gridRegion);
+  bspline->SetGridSpacing(gridSpacing);
+  bspline->SetGridOrigin(gridOrigin);
+  bspline->SetGridDirection(gridDirection);
+  return bspline;
+}
+
+
+// Expects that the combination gives the same results as the initial transform and the B-spline transform evaluated
+// one after the other, for the calls made by the metrics.
+void
+ExpectSameAsSeparateTransforms(const CombinationType & transform,
+                               const CombinationType & initialTransform,
+                               const BSplineType &     bspline)
+{
+  const unsigned int                          nnzji = transform.GetNumberOfNonZeroJacobianIndices();
+  CombinationType::DerivativeType             imageJacobian(nnzji);
+  CombinationType::DerivativeType             expectedImageJacobian(nnzji);
+  CombinationType::NonZeroJacobianIndicesType nzji(nnzji);
+  CombinationType::NonZeroJacobianIndicesType expectedNzji(nnzji);
+  CombinationType::SpatialJacobianType        sj, sj0, sj1;
+
+  for (unsigned int i = 0; i < 200; ++i)
+  {
+    CombinationType::InputPointType         point;
+    CombinationType::MovingImageGradientType gradient;
+    for (unsigned int d = 0; d < Dimension; ++d)
+    {
+      point[d] = 10.0 + 10.0 * std::sin(0.7 * i + 1.3 * d);
+      gradient[d] = std::cos(0.9 * i + d);
+    }
+
+    const auto initialPoint = initialTransform.TransformPoint(point);
+    EXPECT_LT(transform.TransformPoint(point).EuclideanDistanceTo(bspline.TransformPoint(initialPoint)), 1e-10);
+
+    transform.EvaluateJacobianWithImageGradientProduct(point, gradient, imageJacobian, nzji);
+    bspline.EvaluateJacobianWithImageGradientProduct(initialPoint, gradient, expectedImageJacobian, expectedNzji);
+    EXPECT_EQ(nzji, expectedNzji);
+    EXPECT_LT((imageJacobian - expectedImageJacobian).inf_norm(), 1e-10);
+
+    transform.GetSpatialJacobian(point, sj);
+    initialTransform.GetSpatialJacobian(point, sj0);
+    bspline.GetSpatialJacobian(initialPoint, sj1);
+    EXPECT_LT((sj.GetVnlMatrix() - (sj1 * sj0).GetVnlMatrix()).absolute_value_max(), 1e-10);
+  }
+}
+
+} // namespace
+
+
+// Tests the composition with a linear initial transform, which is stored as a matrix and an offset, and which is
+// refreshed when the parameters are set.
+GTEST_TEST(AdvancedCombinationTransform, LinearCompositionEqualsSeparateTransforms)
+{
+  // As in elastix, the affine transform is the current transform of the initial combination.
+  const auto affine = CreateAffineTransform();
+  const auto initialTransform = CheckNew<CombinationType>();
+  initialTransform->SetCurrentTransform(affine);
+
+  const auto                  bspline = CreateBSplineTransform();
+  BSplineType::ParametersType parameters(bspline->GetNumberOfParameters());
+  for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+  {
+    parameters[i] = 2.0 * std::sin(0.37 * i);
+  }
+
+  const auto transform = CheckNew<CombinationType>();
+  transform->SetInitialTransform(initialTransform);
+  transform->SetCurrentTransform(bspline);
+  transform->SetUseComposition(true);
+  transform->SetParameters(parameters);
+  ExpectSameAsSeparateTransforms(*transform, *initialTransform, *bspline);
+
+  // Change the affine transform, and set the parameters again, as is done at the start of each resolution.
+  auto translation = affine->GetTranslation();
+  translation[1] += 1.75;
+  affine->SetTranslation(translation);
+  transform->SetParameters(parameters);
+  ExpectSameAsSeparateTransforms(*transform, *initialTransform, *bspline);
+}
@@ -0,0 +1,147 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// First include the header file to be tested:
+#include "itkAdvancedImageToImageMetric.h"
+#include "AdvancedMeanSquares/itkAdvancedMeanSquaresImageToImageMetric.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkImageFullSampler.h"
+#include "../Core/Main/GTesting/elxCoreMainGTestUtilities.h"
+
+#include <itkBSplineInterpolateImageFunction.h>
+#include <itkImage.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Using-declaration:
+using elx::CoreMainGTestUtilities::CheckNew;
+
+namespace
+{
+constexpr unsigned int Dimension = 3;
+using ImageType = itk::Image<float, Dimension>;
+using MetricType = itk::AdvancedMeanSquaresImageToImageMetric<ImageType, ImageType>;
+using ThreaderEnum = MetricType::ThreaderEnum;
+using TransformType = itk::AdvancedBSplineDeformableTransform<double, Dimension, 3>;
+using InterpolatorType = itk::BSplineInterpolateImageFunction<ImageType, double, double>;
+using SamplerType = itk::ImageFullSampler<ImageType>;
+
+
+// Creates a smooth image of 16^3 voxels, shifted by the specified number of voxels.
+itk::SmartPointer<ImageType>
+CreateImage(const double shift)
+{
+  const auto image = ImageType::New();
+  image->SetRegions(ImageType::SizeType::Filled(16));
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, image->GetBufferedRegion());
+  for (; !it.IsAtEnd(); ++it)
+  {
+    const auto & index = it.GetIndex();
+    double       value = 100.0;
+    for (unsigned int d = 0; d < Dimension; ++d)
+    {
+      value *= std::cos((index[d] - shift) / 5.0);
+    }
+    it.Set(static_cast<float>(value));
+  }
+  return image;
+}
+
+} // namespace
+
+
+// Tests that the value and derivative of a multi-threaded metric do not depend on the threader, nor on the number of
+// work units.
+GTEST_TEST(AdvancedImageToImageMetric, ResultIndependentOfThreader)
+{
+  const auto fixedImage = CreateImage(0.0);
+  const auto movingImage = CreateImage(1.5);
+
+  const auto                   transform = CheckNew<TransformType>();
+  TransformType::RegionType    gridRegion;
+  TransformType::SpacingType   gridSpacing;
+  TransformType::OriginType    gridOrigin;
+  TransformType::DirectionType gridDirection;
+  gridRegion.SetSize(TransformType::SizeType::Filled(7));
+  gridSpacing.Fill(4.0);
+  gridOrigin.Fill(-4.0);
+  gridDirection.SetIdentity();
+  transform->SetGridRegion(gridRegion);
+  transform->SetGridSpacing(gridSpacing);
+  transform->SetGridOrigin(gridOrigin);
+  transform->SetGridDirection(gridDirection);
+
+  TransformType::ParametersType parameters(transform->GetNumberOfParameters());
+  for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+  {
+    parameters[i] = std::sin(0.37 * i);
+  }
+  transform->SetParameters(parameters);
+
+  const auto interpolator = CheckNew<InterpolatorType>();
+  interpolator->SetSplineOrder(1);
+
+  const auto metric = CheckNew<MetricType>();
+  metric->SetFixedImage(fixedImage);
+  metric->SetMovingImage(movingImage);
+  metric->SetFixedImageRegion(fixedImage->GetBufferedRegion());
+  metric->SetTransform(transform);
+  metric->SetInterpolator(interpolator);
+  metric->SetImageSampler(CheckNew<SamplerType>());
+  metric->SetUseMultiThread(true);
+
+  std::vector<ThreaderEnum> threaderTypes{ ThreaderEnum::Platform, ThreaderEnum::Pool };
+#ifdef ITK_USE_TBB
+  threaderTypes.push_back(ThreaderEnum::TBB);
+#endif
+
+  MetricType::MeasureType    referenceValue = 0.0;
+  MetricType::DerivativeType referenceDerivative;
+
+  for (const auto threaderType : threaderTypes)
+  {
+    for (const itk::ThreadIdType numberOfWorkUnits : { 1U, 2U, 3U, 8U })
+    {
+      metric->SetMultiThreaderType(threaderType);
+      metric->SetNumberOfWorkUnits(numberOfWorkUnits);
+      metric->Initialize();
+
+      MetricType::MeasureType    value = 0.0;
+      MetricType::DerivativeType derivative;
+      metric->GetValueAndDerivative(parameters, value, derivative);
+
+      if (referenceDerivative.GetSize() == 0)
+      {
+        referenceValue = value;
+        referenceDerivative = derivative;
+        continue;
+      }
+      EXPECT_NEAR(value, referenceValue, 1e-8 * std::max(std::abs(referenceValue), 1.0));
+      ASSERT_EQ(derivative.GetSize(), referenceDerivative.GetSize());
+      EXPECT_LE((derivative - referenceDerivative).magnitude(), 1e-8 * std::max(referenceDerivative.magnitude(), 1.0));
+    }
+  }
+}
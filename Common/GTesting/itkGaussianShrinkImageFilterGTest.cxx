@@ -0,0 +1,176 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// First include the header file to be tested:
+#include "itkGaussianShrinkImageFilter.h"
+#include "../Core/Main/GTesting/elxCoreMainGTestUtilities.h"
+
+#include <itkImage.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIteratorWithIndex.h>
+#include <itkResampleImageFilter.h>
+#include <itkSmoothingRecursiveGaussianImageFilter.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+
+// Using-declaration:
+using elx::CoreMainGTestUtilities::CheckNew;
+
+namespace
+{
+constexpr unsigned int Dimension = 2;
+constexpr unsigned int Factor = 4;
+using ImageType = itk::Image<float, Dimension>;
+using GaussianShrinkerType = itk::GaussianShrinkImageFilter<ImageType, ImageType>;
+using ResamplerType = itk::ResampleImageFilter<ImageType, ImageType>;
+using SmootherType = itk::SmoothingRecursiveGaussianImageFilter<ImageType, ImageType>;
+
+
+// Creates a smooth image with a high frequency pattern on top, with intensities from about 250 to 750.
+itk::SmartPointer<ImageType>
+CreateImage()
+{
+  const auto image = ImageType::New();
+  image->SetRegions(ImageType::SizeType{ { 64, 48 } });
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, image->GetBufferedRegion());
+  for (; !it.IsAtEnd(); ++it)
+  {
+    const auto & index = it.GetIndex();
+    const double wave = std::sin(index[0] / 7.0) * std::cos(index[1] / 11.0);
+    it.Set(static_cast<float>(500.0 + 200.0 * wave + 50.0 * std::sin(2.3 * index[0] + 1.1 * index[1])));
+  }
+  return image;
+}
+
+
+// Sets the output grid of a pyramid level rescaled by Factor, as the generic pyramid does, on the filter.
+template <class TFilter>
+void
+SetOutputGrid(TFilter & filter, const ImageType & image)
+{
+  ImageType::SizeType    outputSize;
+  ImageType::SpacingType outputSpacing;
+  ImageType::PointType   outputOrigin;
+  for (unsigned int d = 0; d < Dimension; ++d)
+  {
+    outputSize[d] = image.GetBufferedRegion().GetSize()[d] / Factor;
+    outputSpacing[d] = Factor;
+    outputOrigin[d] = 0.5 * (Factor - 1.0);
+  }
+  filter.SetSize(outputSize);
+  filter.SetOutputSpacing(outputSpacing);
+  filter.SetOutputOrigin(outputOrigin);
+}
+
+
+// Returns the maximum absolute difference of the images within the region.
+double
+GetMaximumDifference(const ImageType & image1, const ImageType & image2, const ImageType::RegionType & region)
+{
+  double                                   maximumDifference = 0.0;
+  itk::ImageRegionConstIterator<ImageType> it1(&image1, region);
+  itk::ImageRegionConstIterator<ImageType> it2(&image2, region);
+  for (; !it1.IsAtEnd(); ++it1, ++it2)
+  {
+    maximumDifference = std::max(maximumDifference, static_cast<double>(std::abs(it1.Get() - it2.Get())));
+  }
+  return maximumDifference;
+}
+
+} // namespace
+
+
+// Tests that the kernel is normalized over the part that lies inside the image, also at the border.
+GTEST_TEST(GaussianShrinkImageFilter, ConstantImageStaysConstant)
+{
+  const auto image = ImageType::New();
+  image->SetRegions(ImageType::SizeType{ { 64, 48 } });
+  image->Allocate();
+  image->FillBuffer(123.0f);
+
+  const auto gaussianShrinker = CheckNew<GaussianShrinkerType>();
+  gaussianShrinker->SetInput(image);
+  gaussianShrinker->SetSigmaArray(GaussianShrinkerType::SigmaArrayType::Filled(0.5 * Factor));
+  SetOutputGrid(*gaussianShrinker, *image);
+  gaussianShrinker->Update();
+
+  const ImageType &                        output = *gaussianShrinker->GetOutput();
+  itk::ImageRegionConstIterator<ImageType> it(&output, output.GetBufferedRegion());
+  for (; !it.IsAtEnd(); ++it)
+  {
+    EXPECT_NEAR(it.Get(), 123.0f, 1e-3);
+  }
+}
+
+
+// Tests that, away from the border, the output is close to smoothing at full resolution followed by resampling. The
+// recursive filter approximates the Gaussian, and handles the border differently.
+GTEST_TEST(GaussianShrinkImageFilter, CloseToSmoothingAndResampling)
+{
+  const auto image = CreateImage();
+  const auto sigmaArray = GaussianShrinkerType::SigmaArrayType::Filled(0.5 * Factor);
+
+  const auto smoother = CheckNew<SmootherType>();
+  smoother->SetInput(image);
+  smoother->SetSigmaArray(sigmaArray);
+  const auto resampler = CheckNew<ResamplerType>();
+  resampler->SetInput(smoother->GetOutput());
+  SetOutputGrid(*resampler, *image);
+  resampler->Update();
+
+  const auto gaussianShrinker = CheckNew<GaussianShrinkerType>();
+  gaussianShrinker->SetInput(image);
+  gaussianShrinker->SetSigmaArray(sigmaArray);
+  SetOutputGrid(*gaussianShrinker, *image);
+  gaussianShrinker->Update();
+
+  ImageType::RegionType region = resampler->GetOutput()->GetBufferedRegion();
+  ASSERT_EQ(gaussianShrinker->GetOutput()->GetBufferedRegion(), region);
+  region.ShrinkByRadius(3);
+
+  // The intensities range over about 500, so allow for a 1% difference.
+  EXPECT_LE(GetMaximumDifference(*gaussianShrinker->GetOutput(), *resampler->GetOutput(), region), 5.0);
+}
+
+
+// Tests that the input is linearly interpolated when the sigmas are zero.
+GTEST_TEST(GaussianShrinkImageFilter, ZeroSigmaInterpolatesLinearly)
+{
+  const auto image = CreateImage();
+
+  const auto resampler = CheckNew<ResamplerType>();
+  resampler->SetInput(image);
+  SetOutputGrid(*resampler, *image);
+  resampler->Update();
+
+  const auto gaussianShrinker = CheckNew<GaussianShrinkerType>();
+  gaussianShrinker->SetInput(image);
+  gaussianShrinker->SetSigmaArray(GaussianShrinkerType::SigmaArrayType::Filled(0.0));
+  SetOutputGrid(*gaussianShrinker, *image);
+  gaussianShrinker->Update();
+
+  const ImageType::RegionType region = resampler->GetOutput()->GetBufferedRegion();
+  ASSERT_EQ(gaussianShrinker->GetOutput()->GetBufferedRegion(), region);
+  EXPECT_LE(GetMaximumDifference(*gaussianShrinker->GetOutput(), *resampler->GetOutput(), region), 1e-3);
+}
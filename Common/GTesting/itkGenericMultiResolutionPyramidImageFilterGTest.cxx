@@ -0,0 +1,157 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// First include the header file to be tested:
+#include "itkGenericMultiResolutionPyramidImageFilter.h"
+#include "../Core/Main/GTesting/elxCoreMainGTestUtilities.h"
+
+#include <itkImage.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+#include <gtest/gtest.h>
+
+// Using-declaration:
+using elx::CoreMainGTestUtilities::CheckNew;
+
+namespace
+{
+constexpr unsigned int NumberOfLevels = 3;
+using InputImageType = itk::Image<short, 2>;
+using OutputImageType = itk::Image<float, 2>;
+using PyramidType = itk::GenericMultiResolutionPyramidImageFilter<InputImageType, OutputImageType>;
+
+
+// Creates an image with a pattern that does not repeat at the scales of the pyramid.
+itk::SmartPointer<InputImageType>
+CreateImage()
+{
+  const auto image = InputImageType::New();
+  image->SetRegions(InputImageType::SizeType{ { 64, 48 } });
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<InputImageType> it(image, image->GetBufferedRegion());
+  for (; !it.IsAtEnd(); ++it)
+  {
+    const auto & index = it.GetIndex();
+    it.Set(static_cast<short>((7 * index[0] * index[0] + 13 * index[1]) % 1000));
+  }
+  return image;
+}
+
+
+// Creates a pyramid that computes one level per update.
+itk::SmartPointer<PyramidType>
+CreatePyramid(const InputImageType & image, const bool prefetchNextLevel)
+{
+  const auto pyramid = CheckNew<PyramidType>();
+  pyramid->SetInput(&image);
+  pyramid->SetNumberOfLevels(NumberOfLevels);
+  pyramid->SetComputeOnlyForCurrentLevel(true);
+  pyramid->SetPrefetchNextLevel(prefetchNextLevel);
+  return pyramid;
+}
+
+
+// Updates the pyramid for the level, and expects that its output equals the expected image.
+void
+ExpectLevelEqual(PyramidType & pyramid, const unsigned int level, const OutputImageType & expectedImage)
+{
+  pyramid.SetCurrentLevel(level);
+  pyramid.Update();
+
+  const OutputImageType & image = *pyramid.GetOutput(level);
+  ASSERT_EQ(image.GetBufferedRegion(), expectedImage.GetBufferedRegion());
+  EXPECT_EQ(image.GetSpacing(), expectedImage.GetSpacing());
+  EXPECT_EQ(image.GetOrigin(), expectedImage.GetOrigin());
+
+  itk::ImageRegionConstIterator<OutputImageType> it(&image, image.GetBufferedRegion());
+  itk::ImageRegionConstIterator<OutputImageType> expectedIt(&expectedImage, image.GetBufferedRegion());
+  for (; !it.IsAtEnd(); ++it, ++expectedIt)
+  {
+    ASSERT_EQ(it.Get(), expectedIt.Get());
+  }
+}
+
+
+// Returns the image of the level, computed by a pyramid without prefetching.
+itk::SmartPointer<OutputImageType>
+ComputeLevel(const InputImageType & image, const unsigned int level, const bool useGaussianShrinkImageFilter)
+{
+  const auto pyramid = CreatePyramid(image, false);
+  pyramid->SetUseGaussianShrinkImageFilter(useGaussianShrinkImageFilter);
+  pyramid->SetCurrentLevel(level);
+  pyramid->Update();
+  return pyramid->GetOutput(level);
+}
+
+} // namespace
+
+
+// Tests that the prefetched levels are grafted onto the output, and equal the levels computed per resolution.
+GTEST_TEST(GenericMultiResolutionPyramidImageFilter, PrefetchedLevelsAreUsed)
+{
+  const auto image = CreateImage();
+
+  for (const bool useGaussianShrinkImageFilter : { false, true })
+  {
+    const auto pyramid = CreatePyramid(*image, true);
+    pyramid->SetUseGaussianShrinkImageFilter(useGaussianShrinkImageFilter);
+
+    for (unsigned int level = 0; level < NumberOfLevels; ++level)
+    {
+      ExpectLevelEqual(*pyramid, level, *ComputeLevel(*image, level, useGaussianShrinkImageFilter));
+    }
+
+    // All levels but the first were prefetched.
+    EXPECT_EQ(pyramid->GetNumberOfPrefetchedLevelsUsed(), NumberOfLevels - 1);
+  }
+}
+
+
+// Tests that a prefetched level is computed again when a setting changes while it is prefetched.
+GTEST_TEST(GenericMultiResolutionPyramidImageFilter, PrefetchedLevelIsNotUsedAfterSettingChange)
+{
+  const auto image = CreateImage();
+  const auto pyramid = CreatePyramid(*image, true);
+
+  // Computing level 0 starts prefetching level 1.
+  pyramid->SetCurrentLevel(0);
+  pyramid->Update();
+
+  pyramid->SetUseGaussianShrinkImageFilter(true);
+  ExpectLevelEqual(*pyramid, 1, *ComputeLevel(*image, 1, true));
+  EXPECT_EQ(pyramid->GetNumberOfPrefetchedLevelsUsed(), 0U);
+
+  // The next level is prefetched with the new setting, and used.
+  ExpectLevelEqual(*pyramid, 2, *ComputeLevel(*image, 2, true));
+  EXPECT_EQ(pyramid->GetNumberOfPrefetchedLevelsUsed(), 1U);
+}
+
+
+// Tests that levels are not prefetched without ComputeOnlyForCurrentLevel.
+GTEST_TEST(GenericMultiResolutionPyramidImageFilter, NoPrefetchWhenComputingAllLevels)
+{
+  const auto image = CreateImage();
+  const auto pyramid = CreatePyramid(*image, true);
+  pyramid->SetComputeOnlyForCurrentLevel(false);
+  pyramid->Update();
+
+  EXPECT_EQ(pyramid->GetNumberOfPrefetchedLevelsUsed(), 0U);
+}
@@ -0,0 +1,158 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// First include the header file to be tested:
+#include "itkImageFileCastWriter.h"
+#include "../Core/Main/GTesting/elxCoreMainGTestUtilities.h"
+
+#include <itkChangeInformationImageFilter.h>
+#include <itkImage.h>
+#include <itkImageFileReader.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <string>
+
+// Using-declaration:
+using elx::CoreMainGTestUtilities::CheckNew;
+
+namespace
+{
+constexpr unsigned int Dimension = 3;
+using ImageType = itk::Image<float, Dimension>;
+using WriterType = itk::ImageFileCastWriter<ImageType>;
+
+
+// Creates an image of 11 x 12 x 13 voxels, with integer values that fit in a short, so that casting is lossless.
+itk::SmartPointer<ImageType>
+CreateImage()
+{
+  const auto           image = ImageType::New();
+  ImageType::SizeType  size;
+  ImageType::IndexType index;
+  size[0] = 11;
+  size[1] = 12;
+  size[2] = 13;
+  index[0] = -2;
+  index[1] = 3;
+  index[2] = 5;
+  image->SetRegions(ImageType::RegionType(index, size));
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, image->GetBufferedRegion());
+  for (; !it.IsAtEnd(); ++it)
+  {
+    const auto & voxelIndex = it.GetIndex();
+    it.Set(std::round(1000.0f * std::sin(0.37f * voxelIndex[0] + 0.59f * voxelIndex[1] + 0.83f * voxelIndex[2])));
+  }
+  return image;
+}
+
+
+// Writes the image with the specified output component type and number of slabs, and reads it back.
+template <typename TPixel>
+itk::SmartPointer<itk::Image<TPixel, Dimension>>
+WriteAndRead(const ImageType &   image,
+             const std::string & outputComponentType,
+             const unsigned int  numberOfSlabs,
+             const std::string & fileName)
+{
+  const auto writer = CheckNew<WriterType>();
+  writer->SetInput(&image);
+  writer->SetFileName(fileName);
+  writer->SetOutputComponentType(outputComponentType.c_str());
+  writer->SetNumberOfStreamDivisions(numberOfSlabs);
+  writer->Update();
+
+  const auto reader = CheckNew<itk::ImageFileReader<itk::Image<TPixel, Dimension>>>();
+  reader->SetFileName(fileName);
+  reader->Update();
+  return reader->GetOutput();
+}
+
+
+// Expects that the image read back has the pixel values of the original image, cast to TPixel.
+template <typename TPixel>
+void
+ExpectSameImage(const itk::Image<TPixel, Dimension> & actual, const ImageType & expected)
+{
+  ASSERT_EQ(actual.GetLargestPossibleRegion().GetSize(), expected.GetLargestPossibleRegion().GetSize());
+
+  itk::ImageRegionConstIterator<itk::Image<TPixel, Dimension>> actualIt(&actual, actual.GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<ImageType> expectedIt(&expected, expected.GetLargestPossibleRegion());
+  for (; !expectedIt.IsAtEnd(); ++actualIt, ++expectedIt)
+  {
+    EXPECT_EQ(actualIt.Get(), static_cast<TPixel>(expectedIt.Get()));
+  }
+}
+
+} // namespace
+
+
+// Tests writing without casting, and with casting to another component type, both in a single slab and streamed in
+// several slabs.
+GTEST_TEST(ImageFileCastWriter, WriteWithAndWithoutCasting)
+{
+  const auto image = CreateImage();
+
+  for (const unsigned int numberOfSlabs : { 1U, 4U })
+  {
+    const std::string slabs = std::to_string(numberOfSlabs);
+
+    const auto floatImage =
+      WriteAndRead<float>(*image, "float", numberOfSlabs, "itkImageFileCastWriterGTest_float_" + slabs + ".mha");
+    ExpectSameImage(*floatImage, *image);
+
+    const auto shortImage =
+      WriteAndRead<short>(*image, "short", numberOfSlabs, "itkImageFileCastWriterGTest_short_" + slabs + ".mha");
+    ExpectSameImage(*shortImage, *image);
+  }
+}
+
+
+// Tests writing a pre-computed filter output in several slabs, like the resampler of multiple images does: the buffered
+// region of the input is then the whole image, which is larger than each slab that is written.
+GTEST_TEST(ImageFileCastWriter, WritePrecomputedInputInSlabs)
+{
+  const auto image = CreateImage();
+
+  const auto infoChanger = CheckNew<itk::ChangeInformationImageFilter<ImageType>>();
+  infoChanger->SetInput(image);
+  infoChanger->Update();
+  ASSERT_EQ(infoChanger->GetOutput()->GetBufferedRegion(), image->GetLargestPossibleRegion());
+
+  for (const std::string outputComponentType : { "float", "short" })
+  {
+    const std::string fileName = "itkImageFileCastWriterGTest_precomputed_" + outputComponentType + ".mha";
+    const auto        writer = CheckNew<WriterType>();
+    writer->SetInput(infoChanger->GetOutput());
+    writer->SetFileName(fileName);
+    writer->SetOutputComponentType(outputComponentType.c_str());
+    writer->SetNumberOfStreamDivisions(4);
+    writer->Update();
+
+    const auto reader = CheckNew<itk::ImageFileReader<ImageType>>();
+    reader->SetFileName(fileName);
+    reader->Update();
+    ExpectSameImage(*reader->GetOutput(), *image);
+  }
+}
@@ -0,0 +1,146 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// First include the header file to be tested:
+#include "itkImageRandomSamplerSparseMask.h"
+#include "../Core/Main/GTesting/elxCoreMainGTestUtilities.h"
+
+#include <itkImage.h>
+#include <itkImageMaskSpatialObject.h>
+#include <itkImageRegionIterator.h>
+
+#include <gtest/gtest.h>
+
+// Using-declaration:
+using elx::CoreMainGTestUtilities::CheckNew;
+
+namespace
+{
+constexpr unsigned int Dimension = 2;
+using ImageType = itk::Image<float, Dimension>;
+using MaskImageType = itk::Image<unsigned char, Dimension>;
+using MaskSpatialObjectType = itk::ImageMaskSpatialObject<Dimension>;
+using SamplerType = itk::ImageRandomSamplerSparseMask<ImageType>;
+using RandomGeneratorType = itk::Statistics::MersenneTwisterRandomVariateGenerator;
+
+
+// Creates an image whose pixel values equal their buffer offset, so that each sample identifies its voxel.
+itk::SmartPointer<ImageType>
+CreateImage(const ImageType::SizeType & imageSize)
+{
+  const auto image = ImageType::New();
+  image->SetRegions(imageSize);
+  image->Allocate();
+
+  float                               pixelValue = 0.0f;
+  itk::ImageRegionIterator<ImageType> it(image, image->GetBufferedRegion());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it, ++pixelValue)
+  {
+    it.Set(pixelValue);
+  }
+  return image;
+}
+
+
+// Creates a mask of the specified size that is nonzero only within the specified sub-region.
+itk::SmartPointer<MaskSpatialObjectType>
+CreateMask(const MaskImageType::SizeType & imageSize, const MaskImageType::RegionType & inMaskRegion)
+{
+  const auto maskImage = MaskImageType::New();
+  maskImage->SetRegions(imageSize);
+  maskImage->Allocate(true);
+
+  itk::ImageRegionIterator<MaskImageType> it(maskImage, inMaskRegion);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    it.Set(1);
+  }
+
+  const auto maskSpatialObject = MaskSpatialObjectType::New();
+  maskSpatialObject->SetImage(maskImage);
+  maskSpatialObject->Update();
+  return maskSpatialObject;
+}
+
+} // namespace
+
+
+GTEST_TEST(ImageRandomSamplerSparseMask, SamplesAreInsideMask)
+{
+  const ImageType::SizeType imageSize{ { 16, 12 } };
+  const auto                image = CreateImage(imageSize);
+  const auto                mask = CreateMask(imageSize, MaskImageType::RegionType({ { 3, 4 } }, { { 5, 2 } }));
+
+  const auto sampler = CheckNew<SamplerType>();
+  sampler->SetInput(image);
+  sampler->SetMask(mask);
+  sampler->SetNumberOfSamples(100);
+  sampler->Update();
+
+  EXPECT_EQ(sampler->GetNumberOfValidVoxels(), 10U);
+
+  const auto & samples = *(sampler->GetOutput());
+  ASSERT_EQ(samples.size(), 100U);
+
+  for (const auto & sample : samples)
+  {
+    EXPECT_TRUE(mask->IsInsideInWorldSpace(sample.m_ImageCoordinates));
+
+    ImageType::IndexType index;
+    ASSERT_TRUE(image->TransformPhysicalPointToIndex(sample.m_ImageCoordinates, index));
+    EXPECT_EQ(sample.m_ImageValue, image->GetPixel(index));
+  }
+}
+
+
+GTEST_TEST(ImageRandomSamplerSparseMask, MultiThreadedSamplesEqualSingleThreadedSamples)
+{
+  const ImageType::SizeType imageSize{ { 32, 40 } };
+  const auto                image = CreateImage(imageSize);
+  const auto                mask = CreateMask(imageSize, MaskImageType::RegionType({ { 2, 5 } }, { { 20, 30 } }));
+
+  const auto generateSamples = [&image, &mask](const bool useMultiThread) {
+    RandomGeneratorType::GetInstance()->SetSeed(1);
+
+    const auto sampler = CheckNew<SamplerType>();
+    sampler->SetInput(image);
+    sampler->SetMask(mask);
+    sampler->SetNumberOfSamples(1000);
+    sampler->SetUseMultiThread(useMultiThread);
+    sampler->SetNumberOfWorkUnits(4);
+    sampler->Update();
+
+    // Selecting new samples should reuse the cached voxel list.
+    sampler->SelectNewSamplesOnUpdate();
+    sampler->Update();
+
+    EXPECT_EQ(sampler->GetNumberOfValidVoxels(), 600U);
+    return std::vector<SamplerType::ImageSampleType>(sampler->GetOutput()->begin(), sampler->GetOutput()->end());
+  };
+
+  const auto singleThreadedSamples = generateSamples(false);
+  const auto multiThreadedSamples = generateSamples(true);
+
+  ASSERT_EQ(singleThreadedSamples.size(), multiThreadedSamples.size());
+  for (std::size_t i = 0; i < singleThreadedSamples.size(); ++i)
+  {
+    EXPECT_EQ(singleThreadedSamples[i].m_ImageCoordinates, multiThreadedSamples[i].m_ImageCoordinates);
+    EXPECT_EQ(singleThreadedSamples[i].m_ImageValue, multiThreadedSamples[i].m_ImageValue);
+  }
+}
@@ -0,0 +1,211 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// First include the header file to be tested:
+#include "itkImageSamplerBase.h"
+#include "itkImageFullSampler.h"
+#include "itkImageRandomSampler.h"
+#include "AdvancedMeanSquares/itkAdvancedMeanSquaresImageToImageMetric.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "../Core/Main/GTesting/elxCoreMainGTestUtilities.h"
+
+#include <itkBSplineInterpolateImageFunction.h>
+#include <itkImage.h>
+#include <itkImageRegionIterator.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Using-declaration:
+using elx::CoreMainGTestUtilities::CheckNew;
+
+namespace
+{
+constexpr unsigned int Dimension = 2;
+using ImageType = itk::Image<float, Dimension>;
+using RandomSamplerType = itk::ImageRandomSampler<ImageType>;
+using ImageSampleType = RandomSamplerType::ImageSampleType;
+
+
+// Creates an image whose pixel values equal their buffer offset, so that each sample identifies its voxel.
+itk::SmartPointer<ImageType>
+CreateImage(const ImageType::SizeType & imageSize)
+{
+  const auto image = ImageType::New();
+  image->SetRegions(imageSize);
+  image->Allocate();
+
+  float                               pixelValue = 0.0f;
+  itk::ImageRegionIterator<ImageType> it(image, image->GetBufferedRegion());
+  for (; !it.IsAtEnd(); ++it, ++pixelValue)
+  {
+    it.Set(pixelValue);
+  }
+  return image;
+}
+
+
+// Returns the Morton code of the voxel of the sample, by interleaving the bits of its index.
+std::uint64_t
+GetMortonCode(const ImageType & image, const ImageSampleType & sample)
+{
+  ImageType::IndexType index;
+  EXPECT_TRUE(image.TransformPhysicalPointToIndex(sample.m_ImageCoordinates, index));
+
+  std::uint64_t code = 0;
+  for (unsigned int bit = 0; bit < 32; ++bit)
+  {
+    for (unsigned int d = 0; d < Dimension; ++d)
+    {
+      code |= ((static_cast<std::uint64_t>(index[d]) >> bit) & 1) << (bit * Dimension + d);
+    }
+  }
+  return code;
+}
+
+
+// Returns the sorted pixel values of the samples, which identify their voxels.
+std::vector<float>
+GetSortedValues(const std::vector<ImageSampleType> & samples)
+{
+  std::vector<float> values;
+  for (const auto & sample : samples)
+  {
+    values.push_back(sample.m_ImageValue);
+  }
+  std::sort(values.begin(), values.end());
+  return values;
+}
+
+} // namespace
+
+
+// Tests that sorting keeps the same samples, in non-decreasing Morton order.
+GTEST_TEST(ImageSamplerBase, SortSamplesInMortonOrder)
+{
+  const auto image = CreateImage(ImageType::SizeType{ { 37, 29 } });
+
+  const auto sampler = CheckNew<RandomSamplerType>();
+  sampler->SetInput(image);
+  sampler->SetNumberOfSamples(500);
+  sampler->Update();
+  const std::vector<ImageSampleType> unsortedSamples(sampler->GetOutput()->begin(), sampler->GetOutput()->end());
+
+  sampler->SortSamplesInMortonOrder();
+  const std::vector<ImageSampleType> sortedSamples(sampler->GetOutput()->begin(), sampler->GetOutput()->end());
+
+  ASSERT_EQ(sortedSamples.size(), unsortedSamples.size());
+  EXPECT_EQ(GetSortedValues(sortedSamples), GetSortedValues(unsortedSamples));
+  for (std::size_t i = 1; i < sortedSamples.size(); ++i)
+  {
+    EXPECT_LE(GetMortonCode(*image, sortedSamples[i - 1]), GetMortonCode(*image, sortedSamples[i]));
+  }
+}
+
+
+// Tests that UseMortonOrder sorts the samples after each update, also when new samples are selected.
+GTEST_TEST(ImageSamplerBase, UseMortonOrderSortsAfterUpdate)
+{
+  const auto image = CreateImage(ImageType::SizeType{ { 37, 29 } });
+
+  const auto sampler = CheckNew<RandomSamplerType>();
+  EXPECT_FALSE(sampler->GetUseMortonOrder());
+  sampler->SetInput(image);
+  sampler->SetNumberOfSamples(500);
+  sampler->UseMortonOrderOn();
+
+  for (unsigned int update = 0; update < 2; ++update)
+  {
+    sampler->SelectNewSamplesOnUpdate();
+    sampler->Update();
+    const auto & samples = *sampler->GetOutput();
+    ASSERT_EQ(samples.size(), 500U);
+    for (std::size_t i = 1; i < samples.size(); ++i)
+    {
+      EXPECT_LE(GetMortonCode(*image, samples[i - 1]), GetMortonCode(*image, samples[i]));
+    }
+  }
+}
+
+
+// Tests that sorting the samples only changes the metric by the order of the summation.
+GTEST_TEST(ImageSamplerBase, MortonOrderKeepsMetricValueAndDerivative)
+{
+  using MetricType = itk::AdvancedMeanSquaresImageToImageMetric<ImageType, ImageType>;
+  using TransformType = itk::AdvancedBSplineDeformableTransform<double, Dimension, 3>;
+  using InterpolatorType = itk::BSplineInterpolateImageFunction<ImageType, double, double>;
+  using FullSamplerType = itk::ImageFullSampler<ImageType>;
+
+  const auto fixedImage = CreateImage(ImageType::SizeType{ { 37, 29 } });
+  const auto movingImage = CreateImage(ImageType::SizeType{ { 37, 29 } });
+
+  const auto                   transform = CheckNew<TransformType>();
+  TransformType::RegionType    gridRegion;
+  TransformType::SpacingType   gridSpacing;
+  TransformType::OriginType    gridOrigin;
+  TransformType::DirectionType gridDirection;
+  gridRegion.SetSize(TransformType::SizeType::Filled(8));
+  gridSpacing.Fill(8.0);
+  gridOrigin.Fill(-8.0);
+  gridDirection.SetIdentity();
+  transform->SetGridRegion(gridRegion);
+  transform->SetGridSpacing(gridSpacing);
+  transform->SetGridOrigin(gridOrigin);
+  transform->SetGridDirection(gridDirection);
+
+  TransformType::ParametersType parameters(transform->GetNumberOfParameters());
+  for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+  {
+    parameters[i] = std::sin(0.37 * i);
+  }
+  transform->SetParameters(parameters);
+
+  const auto computeValueAndDerivative = [&](const bool useMortonOrder, MetricType::DerivativeType & derivative) {
+    const auto sampler = CheckNew<FullSamplerType>();
+    sampler->SetUseMortonOrder(useMortonOrder);
+    const auto interpolator = CheckNew<InterpolatorType>();
+    interpolator->SetSplineOrder(1);
+
+    const auto metric = CheckNew<MetricType>();
+    metric->SetFixedImage(fixedImage);
+    metric->SetMovingImage(movingImage);
+    metric->SetFixedImageRegion(fixedImage->GetBufferedRegion());
+    metric->SetTransform(transform);
+    metric->SetInterpolator(interpolator);
+    metric->SetImageSampler(sampler);
+    metric->Initialize();
+
+    MetricType::MeasureType value = 0.0;
+    metric->GetValueAndDerivative(parameters, value, derivative);
+    return value;
+  };
+
+  MetricType::DerivativeType unsortedDerivative;
+  MetricType::DerivativeType sortedDerivative;
+  const auto                 unsortedValue = computeValueAndDerivative(false, unsortedDerivative);
+  const auto                 sortedValue = computeValueAndDerivative(true, sortedDerivative);
+
+  EXPECT_NEAR(sortedValue, unsortedValue, 1e-10 * std::max(std::abs(unsortedValue), 1.0));
+  ASSERT_EQ(sortedDerivative.GetSize(), unsortedDerivative.GetSize());
+  EXPECT_LE((sortedDerivative - unsortedDerivative).magnitude(), 1e-10 * std::max(unsortedDerivative.magnitude(), 1.0));
+}
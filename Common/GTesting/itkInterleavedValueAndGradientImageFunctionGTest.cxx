@@ -0,0 +1,104 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// First include the header file to be tested:
+#include "itkInterleavedValueAndGradientImageFunction.h"
+#include "../Core/Main/GTesting/elxCoreMainGTestUtilities.h"
+
+#include <itkGradientImageFilter.h>
+#include <itkImage.h>
+#include <itkImageRegionIteratorWithIndex.h>
+#include <itkNearestNeighborInterpolateImageFunction.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+// Using-declaration:
+using elx::CoreMainGTestUtilities::CheckNew;
+
+
+// Tests that the interleaved cache gives the same values and gradients as a nearest neighbor interpolator and a
+// separate gradient image, which is what the AdvancedImageToImageMetric uses otherwise.
+GTEST_TEST(InterleavedValueAndGradientImageFunction, SameAsNearestNeighborAndGradientImage)
+{
+  constexpr unsigned int Dimension = 3;
+  using ImageType = itk::Image<float, Dimension>;
+  using FunctionType = itk::InterleavedValueAndGradientImageFunction<ImageType>;
+  using NearestType = itk::NearestNeighborInterpolateImageFunction<ImageType, double>;
+  using GradientFilterType = itk::GradientImageFilter<ImageType, double, double>;
+
+  ImageType::SpacingType spacing;
+  spacing[0] = 0.8;
+  spacing[1] = 0.9;
+  spacing[2] = 1.5;
+  const auto image = ImageType::New();
+  image->SetRegions(ImageType::SizeType{ { 12, 10, 8 } });
+  image->SetSpacing(spacing);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, image->GetBufferedRegion());
+  for (; !it.IsAtEnd(); ++it)
+  {
+    const auto & index = it.GetIndex();
+    it.Set(static_cast<float>(100.0 * std::cos(index[0] / 3.0) * std::sin(index[1] / 4.0 + 0.5) + index[2]));
+  }
+
+  const auto nearest = CheckNew<NearestType>();
+  nearest->SetInputImage(image);
+  const auto gradientFilter = CheckNew<GradientFilterType>();
+  gradientFilter->SetUseImageSpacing(true);
+  gradientFilter->SetInput(image);
+  gradientFilter->Update();
+  const auto & gradientImage = *gradientFilter->GetOutput();
+
+  const auto function = CheckNew<FunctionType>();
+  function->SetInputImage(image);
+
+  for (double x = 0.0; x < 11.0; x += 0.35)
+  {
+    for (double y = 0.0; y < 9.0; y += 0.45)
+    {
+      for (double z = 0.0; z < 7.0; z += 0.55)
+      {
+        FunctionType::ContinuousIndexType point;
+        point[0] = x;
+        point[1] = y;
+        point[2] = z;
+
+        FunctionType::OutputType          value = 0.0;
+        FunctionType::CovariantVectorType gradient;
+        function->EvaluateValueAndDerivativeAtContinuousIndex(point, value, gradient);
+
+        ImageType::IndexType index;
+        for (unsigned int d = 0; d < Dimension; ++d)
+        {
+          index[d] = static_cast<itk::IndexValueType>(itk::Math::Round<double>(point[d]));
+        }
+        const auto & expectedGradient = gradientImage.GetPixel(index);
+
+        EXPECT_NEAR(value, nearest->EvaluateAtContinuousIndex(point), 1e-4);
+        for (unsigned int d = 0; d < Dimension; ++d)
+        {
+          EXPECT_NEAR(gradient[d], expectedGradient[d], 1e-4);
+        }
+      }
+    }
+  }
+}
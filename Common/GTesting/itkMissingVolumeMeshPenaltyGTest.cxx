@@ -0,0 +1,159 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// First include the header file to be tested:
+#include "MissingStructurePenalty/itkMissingStructurePenalty.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "../Core/Main/GTesting/elxCoreMainGTestUtilities.h"
+
+#include <itkTriangleCell.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+
+// Using-declaration:
+using elx::CoreMainGTestUtilities::CheckNew;
+
+namespace
+{
+constexpr unsigned int Dimension = 3;
+using PointSetType =
+  itk::PointSet<double, Dimension, itk::DefaultStaticMeshTraits<double, Dimension, Dimension, double, double, double>>;
+using MetricType = itk::MissingVolumeMeshPenalty<PointSetType, PointSetType>;
+using MeshType = MetricType::FixedMeshType;
+using CellInterfaceType = MetricType::CellInterfaceType;
+using TriangleCellType = itk::TriangleCell<CellInterfaceType>;
+using TransformType = itk::AdvancedBSplineDeformableTransform<double, Dimension, 3>;
+
+
+// Creates a closed triangulated sphere with radius 100, with nLat - 1 rings of nLon points between the two poles.
+itk::SmartPointer<MeshType>
+CreateSphere(const unsigned int nLat, const unsigned int nLon)
+{
+  const double radius = 100.0;
+  const double pi = 3.14159265358979323846;
+  const auto   mesh = MeshType::New();
+
+  MeshType::PointIdentifier pointId = 0;
+  MeshType::PointType       point;
+  point[0] = 0.0;
+  point[1] = 0.0;
+  point[2] = radius;
+  mesh->SetPoint(pointId++, point);
+  for (unsigned int i = 1; i < nLat; ++i)
+  {
+    const double theta = pi * i / nLat;
+    for (unsigned int j = 0; j < nLon; ++j)
+    {
+      const double phi = 2.0 * pi * j / nLon;
+      point[0] = radius * std::sin(theta) * std::cos(phi);
+      point[1] = radius * std::sin(theta) * std::sin(phi);
+      point[2] = radius * std::cos(theta);
+      mesh->SetPoint(pointId++, point);
+    }
+  }
+  point[0] = 0.0;
+  point[1] = 0.0;
+  point[2] = -radius;
+  const MeshType::PointIdentifier southPole = pointId;
+  mesh->SetPoint(pointId++, point);
+
+  const auto ringPoint = [nLon](const unsigned int ring, const unsigned int j) {
+    return static_cast<MeshType::PointIdentifier>(1 + (ring - 1) * nLon + (j % nLon));
+  };
+
+  MeshType::CellIdentifier cellId = 0;
+  const auto addTriangle = [&mesh, &cellId](const MeshType::PointIdentifier p1,
+                                            const MeshType::PointIdentifier p2,
+                                            const MeshType::PointIdentifier p3) {
+    CellInterfaceType::CellAutoPointer cell;
+    cell.TakeOwnership(new TriangleCellType);
+    cell->SetPointId(0, p1);
+    cell->SetPointId(1, p2);
+    cell->SetPointId(2, p3);
+    mesh->SetCell(cellId++, cell);
+  };
+
+  for (unsigned int j = 0; j < nLon; ++j)
+  {
+    addTriangle(0, ringPoint(1, j), ringPoint(1, j + 1));
+    for (unsigned int i = 1; i < nLat - 1; ++i)
+    {
+      addTriangle(ringPoint(i, j), ringPoint(i + 1, j), ringPoint(i + 1, j + 1));
+      addTriangle(ringPoint(i, j), ringPoint(i + 1, j + 1), ringPoint(i, j + 1));
+    }
+    addTriangle(southPole, ringPoint(nLat - 1, j + 1), ringPoint(nLat - 1, j));
+  }
+  return mesh;
+}
+
+} // namespace
+
+
+// Tests that the multi-threaded evaluation gives the same value and derivative as the single-threaded one, on a
+// sphere that is deformed by a B-spline transform.
+GTEST_TEST(MissingVolumeMeshPenalty, MultiThreadedEqualsSingleThreaded)
+{
+  const auto mesh = CreateSphere(24, 20);
+  const auto meshContainer = MetricType::FixedMeshContainerType::New();
+  meshContainer->Reserve(1);
+  meshContainer->SetElement(0, MeshType::ConstPointer(mesh.GetPointer()));
+
+  const auto                   transform = CheckNew<TransformType>();
+  TransformType::RegionType    gridRegion;
+  TransformType::SpacingType   gridSpacing;
+  TransformType::OriginType    gridOrigin;
+  TransformType::DirectionType gridDirection;
+  gridRegion.SetSize(TransformType::SizeType::Filled(14));
+  gridSpacing.Fill(25.0);
+  gridOrigin.Fill(-175.0);
+  gridDirection.SetIdentity();
+  transform->SetGridRegion(gridRegion);
+  transform->SetGridSpacing(gridSpacing);
+  transform->SetGridOrigin(gridOrigin);
+  transform->SetGridDirection(gridDirection);
+
+  TransformType::ParametersType parameters(transform->GetNumberOfParameters());
+  for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+  {
+    parameters[i] = 2.0 * std::sin(0.37 * i);
+  }
+  transform->SetParameters(parameters);
+
+  const auto metric = CheckNew<MetricType>();
+  metric->SetTransform(transform);
+  metric->SetFixedMeshContainer(meshContainer);
+  metric->Initialize();
+
+  MetricType::MeasureType    valueST = 0.0;
+  MetricType::MeasureType    valueMT = 0.0;
+  MetricType::DerivativeType derivativeST;
+  MetricType::DerivativeType derivativeMT;
+
+  metric->SetUseMultiThread(false);
+  metric->GetValueAndDerivative(parameters, valueST, derivativeST);
+  metric->SetUseMultiThread(true);
+  metric->GetValueAndDerivative(parameters, valueMT, derivativeMT);
+
+  EXPECT_NEAR(valueMT, valueST, 1e-10 * std::max(std::abs(valueST), 1.0));
+  ASSERT_EQ(derivativeMT.GetSize(), derivativeST.GetSize());
+  EXPECT_LE((derivativeST - derivativeMT).magnitude(), 1e-10 * std::max(derivativeST.magnitude(), 1.0));
+}
@@ -0,0 +1,136 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// First include the header file to be tested:
+#include "itkMultiImageResampleImageFilter.h"
+#include "itkRecursiveBSplineTransform.h"
+#include "../Core/Main/GTesting/elxCoreMainGTestUtilities.h"
+
+#include <itkBSplineInterpolateImageFunction.h>
+#include <itkImage.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIteratorWithIndex.h>
+#include <itkNearestNeighborInterpolateImageFunction.h>
+#include <itkResampleImageFilter.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+// Using-declaration:
+using elx::CoreMainGTestUtilities::CheckNew;
+
+
+// Tests that resampling several images in a single pass gives the same outputs as a ResampleImageFilter per image,
+// for B-spline and nearest neighbor interpolation, also where the transform maps outside the input images.
+GTEST_TEST(MultiImageResampleImageFilter, SameAsResampleImageFilterPerImage)
+{
+  constexpr unsigned int Dimension = 2;
+  constexpr unsigned int NumberOfImages = 3;
+  using ImageType = itk::Image<float, Dimension>;
+  using TransformType = itk::RecursiveBSplineTransform<double, Dimension, 3>;
+  using MultiResamplerType = itk::MultiImageResampleImageFilter<ImageType, ImageType, double>;
+  using ResamplerType = itk::ResampleImageFilter<ImageType, ImageType, double>;
+  using InterpolatorType = itk::InterpolateImageFunction<ImageType, double>;
+  using BSplineInterpolatorType = itk::BSplineInterpolateImageFunction<ImageType, double, double>;
+  using NearestNeighborInterpolatorType = itk::NearestNeighborInterpolateImageFunction<ImageType, double>;
+
+  // A B-spline transform with a grid spacing of 8 voxels, which moves some voxels outside the images.
+  const auto                   transform = CheckNew<TransformType>();
+  TransformType::RegionType    gridRegion;
+  TransformType::SpacingType   gridSpacing;
+  TransformType::OriginType    gridOrigin;
+  TransformType::DirectionType gridDirection;
+  gridRegion.SetSize(TransformType::SizeType::Filled(7));
+  gridSpacing.Fill(8.0);
+  gridOrigin.Fill(-8.0);
+  gridDirection.SetIdentity();
+  transform->SetGridRegion(gridRegion);
+  transform->SetGridSpacing(gridSpacing);
+  transform->SetGridOrigin(gridOrigin);
+  transform->SetGridDirection(gridDirection);
+
+  TransformType::ParametersType parameters(transform->GetNumberOfParameters());
+  for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+  {
+    parameters[i] = 3.0 * std::sin(0.37 * i);
+  }
+  transform->SetParameters(parameters);
+
+  // Two images with varying intensities, and a label image, each with its own interpolator.
+  const ImageType::SizeType                 size{ { 20, 16 } };
+  std::vector<itk::SmartPointer<ImageType>> images(NumberOfImages);
+  for (unsigned int i = 0; i < NumberOfImages; ++i)
+  {
+    images[i] = ImageType::New();
+    images[i]->SetRegions(size);
+    images[i]->Allocate();
+
+    itk::ImageRegionIteratorWithIndex<ImageType> it(images[i], images[i]->GetBufferedRegion());
+    for (; !it.IsAtEnd(); ++it)
+    {
+      const auto & index = it.GetIndex();
+      const double value = 50.0 + 50.0 * std::sin(0.9 * index[0] + 1.7 * index[1] + i);
+      it.Set(static_cast<float>(i == NumberOfImages - 1 ? std::floor(value / 20.0) : value));
+    }
+  }
+
+  const auto createInterpolator = [](const unsigned int i) -> itk::SmartPointer<InterpolatorType> {
+    if (i == NumberOfImages - 1)
+    {
+      return CheckNew<NearestNeighborInterpolatorType>().GetPointer();
+    }
+    return CheckNew<BSplineInterpolatorType>().GetPointer();
+  };
+
+  const auto multiResampler = CheckNew<MultiResamplerType>();
+  multiResampler->SetNumberOfImages(NumberOfImages);
+  for (unsigned int i = 0; i < NumberOfImages; ++i)
+  {
+    multiResampler->SetInput(i, images[i]);
+    multiResampler->SetInterpolator(i, createInterpolator(i));
+  }
+  multiResampler->SetTransform(transform);
+  multiResampler->SetSize(size);
+  multiResampler->SetDefaultPixelValue(-1.0f);
+  multiResampler->Update();
+
+  for (unsigned int i = 0; i < NumberOfImages; ++i)
+  {
+    const auto resampler = CheckNew<ResamplerType>();
+    resampler->SetInput(images[i]);
+    resampler->SetTransform(transform);
+    resampler->SetInterpolator(createInterpolator(i));
+    resampler->SetSize(size);
+    resampler->SetDefaultPixelValue(-1.0f);
+    resampler->Update();
+
+    const ImageType & expectedImage = *resampler->GetOutput();
+    const ImageType & image = *multiResampler->GetOutput(i);
+    ASSERT_EQ(image.GetBufferedRegion(), expectedImage.GetBufferedRegion());
+
+    itk::ImageRegionConstIterator<ImageType> it(&image, image.GetBufferedRegion());
+    itk::ImageRegionConstIterator<ImageType> expectedIt(&expectedImage, image.GetBufferedRegion());
+    for (; !it.IsAtEnd(); ++it, ++expectedIt)
+    {
+      EXPECT_NEAR(it.Get(), expectedIt.Get(), 1e-4);
+    }
+  }
+}
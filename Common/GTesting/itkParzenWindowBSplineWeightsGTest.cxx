@@ -0,0 +1,65 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// First include the header file to be tested:
+#include "itkParzenWindowBSplineWeights.h"
+#include "itkBSplineKernelFunction2.h"
+#include "../Core/Main/GTesting/elxCoreMainGTestUtilities.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+// Using-declaration:
+using elx::CoreMainGTestUtilities::CheckNew;
+
+namespace
+{
+// Expects that the weights equal those of BSplineKernelFunction2, for the Parzen window terms of the histogram bins,
+// computed as in ParzenWindowHistogramImageToImageMetric.
+template <unsigned int VSplineOrder>
+void
+ExpectSameWeightsAsBSplineKernelFunction2()
+{
+  const auto kernel = CheckNew<itk::BSplineKernelFunction2<VSplineOrder>>();
+
+  for (double term = 2.0; term < 29.0; term += 0.0137)
+  {
+    const double u = std::floor(term + 0.5 - static_cast<double>(VSplineOrder) / 2.0) - term;
+    double       expected[VSplineOrder + 1];
+    double       actual[VSplineOrder + 1];
+    kernel->Evaluate(u, expected);
+    itk::ParzenWindowBSplineWeights<VSplineOrder>::Evaluate(u, actual);
+    for (unsigned int k = 0; k < VSplineOrder + 1; ++k)
+    {
+      EXPECT_NEAR(actual[k], expected[k], 1e-14);
+    }
+  }
+}
+
+} // namespace
+
+
+GTEST_TEST(ParzenWindowBSplineWeights, SameWeightsAsBSplineKernelFunction2)
+{
+  ExpectSameWeightsAsBSplineKernelFunction2<0>();
+  ExpectSameWeightsAsBSplineKernelFunction2<1>();
+  ExpectSameWeightsAsBSplineKernelFunction2<2>();
+  ExpectSameWeightsAsBSplineKernelFunction2<3>();
+}
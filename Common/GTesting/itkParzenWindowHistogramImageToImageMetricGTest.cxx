@@ -0,0 +1,218 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// First include the header file to be tested:
+#include "itkParzenWindowHistogramImageToImageMetric.h"
+#include "AdvancedMattesMutualInformation/itkParzenWindowMutualInformationImageToImageMetric.h"
+#include "NormalizedMutualInformation/itkParzenWindowNormalizedMutualInformationImageToImageMetric.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkExponentialLimiterFunction.h"
+#include "itkHardLimiterFunction.h"
+#include "itkImageFullSampler.h"
+#include "../Core/Main/GTesting/elxCoreMainGTestUtilities.h"
+
+#include <itkBSplineInterpolateImageFunction.h>
+#include <itkImage.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+
+// Using-declaration:
+using elx::CoreMainGTestUtilities::CheckNew;
+
+namespace
+{
+constexpr unsigned int Dimension = 3;
+using ImageType = itk::Image<float, Dimension>;
+using MattesMetricType = itk::ParzenWindowMutualInformationImageToImageMetric<ImageType, ImageType>;
+using NMIMetricType = itk::ParzenWindowNormalizedMutualInformationImageToImageMetric<ImageType, ImageType>;
+using TransformType = itk::AdvancedBSplineDeformableTransform<double, Dimension, 3>;
+using InterpolatorType = itk::BSplineInterpolateImageFunction<ImageType, double, double>;
+using SamplerType = itk::ImageFullSampler<ImageType>;
+
+
+// Creates a smooth image of 16^3 voxels, shifted by the specified number of voxels.
+itk::SmartPointer<ImageType>
+CreateImage(const double shift)
+{
+  const auto image = ImageType::New();
+  image->SetRegions(ImageType::SizeType::Filled(16));
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, image->GetBufferedRegion());
+  for (; !it.IsAtEnd(); ++it)
+  {
+    const auto & index = it.GetIndex();
+    double       value = 100.0;
+    for (unsigned int d = 0; d < Dimension; ++d)
+    {
+      value *= std::cos((index[d] - shift) / 5.0);
+    }
+    it.Set(static_cast<float>(value));
+  }
+  return image;
+}
+
+
+// Creates a B-spline transform with a 7^3 control point grid over the images, and some arbitrary parameters.
+itk::SmartPointer<TransformType>
+CreateTransform()
+{
+  const auto                   transform = CheckNew<TransformType>();
+  TransformType::RegionType    gridRegion;
+  TransformType::SpacingType   gridSpacing;
+  TransformType::OriginType    gridOrigin;
+  TransformType::DirectionType gridDirection;
+  gridRegion.SetSize(TransformType::SizeType::Filled(7));
+  gridSpacing.Fill(4.0);
+  gridOrigin.Fill(-4.0);
+  gridDirection.SetIdentity();
+  transform->SetGridRegion(gridRegion);
+  transform->SetGridSpacing(gridSpacing);
+  transform->SetGridOrigin(gridOrigin);
+  transform->SetGridDirection(gridDirection);
+
+  TransformType::ParametersType parameters(transform->GetNumberOfParameters());
+  for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+  {
+    parameters[i] = std::sin(0.37 * i);
+  }
+  transform->SetParameters(parameters);
+  return transform;
+}
+
+
+// Computes the value and derivative of the metric, with or without explicit joint PDF derivatives within the specified
+// maximum memory size (in megabytes), with the specified number of work units (zero meaning single-threaded), and the
+// specified number of histogram bins.
+template <typename TMetric>
+void
+ComputeValueAndDerivative(const bool                         useExplicitPDFDerivatives,
+                          const double                       maximumJointPDFDerivativesMemorySize,
+                          const itk::ThreadIdType            numberOfWorkUnits,
+                          const unsigned long                numberOfHistogramBins,
+                          typename TMetric::MeasureType &    value,
+                          typename TMetric::DerivativeType & derivative)
+{
+  using FixedLimiterType = itk::HardLimiterFunction<typename TMetric::RealType, Dimension>;
+  using MovingLimiterType = itk::ExponentialLimiterFunction<typename TMetric::RealType, Dimension>;
+
+  const auto fixedImage = CreateImage(0.0);
+  const auto transform = CreateTransform();
+
+  const auto interpolator = CheckNew<InterpolatorType>();
+  interpolator->SetSplineOrder(1);
+
+  const auto metric = CheckNew<TMetric>();
+  metric->SetFixedImage(fixedImage);
+  metric->SetMovingImage(CreateImage(1.5));
+  metric->SetFixedImageRegion(fixedImage->GetBufferedRegion());
+  metric->SetTransform(transform);
+  metric->SetInterpolator(interpolator);
+  metric->SetImageSampler(CheckNew<SamplerType>());
+  metric->SetFixedImageLimiter(CheckNew<FixedLimiterType>());
+  metric->SetMovingImageLimiter(CheckNew<MovingLimiterType>());
+  metric->SetNumberOfFixedHistogramBins(numberOfHistogramBins);
+  metric->SetNumberOfMovingHistogramBins(numberOfHistogramBins);
+  metric->SetUseDerivative(true);
+  metric->SetUseExplicitPDFDerivatives(useExplicitPDFDerivatives);
+  metric->SetMaximumJointPDFDerivativesMemorySize(maximumJointPDFDerivativesMemorySize);
+  metric->SetUseMultiThread(numberOfWorkUnits > 0);
+  if (numberOfWorkUnits > 0)
+  {
+    metric->SetNumberOfWorkUnits(numberOfWorkUnits);
+  }
+  metric->Initialize();
+  metric->GetValueAndDerivative(transform->GetParameters(), value, derivative);
+}
+
+
+// Expects that the derivative computed per block of parameters (by a tiny maximum memory size) is equal to the one
+// computed from the pdf derivatives to all parameters at once, both single-threaded and multi-threaded.
+template <typename TMetric>
+void
+ExpectBlockPathEqualsDensePath()
+{
+  // The pdf derivatives to all 3 * 7^3 parameters take 32 * 32 * 1029 floats, about 4 MB. At most 0.05 MB per block
+  // makes about twelve parameters per block, for a single thread.
+  constexpr double denseMemorySize = 1024.0;
+  constexpr double blockMemorySize = 0.05;
+
+  typename TMetric::MeasureType    referenceValue = 0.0;
+  typename TMetric::DerivativeType referenceDerivative;
+  ComputeValueAndDerivative<TMetric>(true, denseMemorySize, 0, 32, referenceValue, referenceDerivative);
+  ASSERT_GT(referenceDerivative.magnitude(), 0.0);
+
+  for (const itk::ThreadIdType numberOfWorkUnits : { 0U, 1U, 2U, 3U, 8U })
+  {
+    for (const double memorySize : { denseMemorySize, blockMemorySize })
+    {
+      typename TMetric::MeasureType    value = 0.0;
+      typename TMetric::DerivativeType derivative;
+      ComputeValueAndDerivative<TMetric>(true, memorySize, numberOfWorkUnits, 32, value, derivative);
+
+      EXPECT_NEAR(value, referenceValue, 1e-8 * std::max(std::abs(referenceValue), 1.0));
+      ASSERT_EQ(derivative.GetSize(), referenceDerivative.GetSize());
+
+      // The pdf derivatives are stored in single precision, and summed in another order by multiple threads.
+      EXPECT_LE((derivative - referenceDerivative).magnitude(), 1e-5 * referenceDerivative.magnitude());
+    }
+  }
+}
+
+} // namespace
+
+
+// Tests the Mattes mutual information derivative computed per block of parameters.
+GTEST_TEST(ParzenWindowHistogramImageToImageMetric, MattesBlockPathEqualsDensePath)
+{
+  ExpectBlockPathEqualsDensePath<MattesMetricType>();
+}
+
+
+// Tests the normalized mutual information derivative computed per block of parameters.
+GTEST_TEST(ParzenWindowHistogramImageToImageMetric, NormalizedMutualInformationBlockPathEqualsDensePath)
+{
+  ExpectBlockPathEqualsDensePath<NMIMetricType>();
+}
+
+
+// Tests that summing the per-thread joint histograms in parallel, which happens for 64 x 64 bins and 16 work units,
+// gives the same value and derivative as summing them serially, which happens for 15 work units or a single thread.
+GTEST_TEST(ParzenWindowHistogramImageToImageMetric, ParallelJointPDFsAccumulationEqualsSerial)
+{
+  MattesMetricType::MeasureType    referenceValue = 0.0;
+  MattesMetricType::DerivativeType referenceDerivative;
+  ComputeValueAndDerivative<MattesMetricType>(false, 0.0, 0, 64, referenceValue, referenceDerivative);
+  ASSERT_GT(referenceDerivative.magnitude(), 0.0);
+
+  for (const itk::ThreadIdType numberOfWorkUnits : { 1U, 15U, 16U })
+  {
+    MattesMetricType::MeasureType    value = 0.0;
+    MattesMetricType::DerivativeType derivative;
+    ComputeValueAndDerivative<MattesMetricType>(false, 0.0, numberOfWorkUnits, 64, value, derivative);
+
+    EXPECT_NEAR(value, referenceValue, 1e-10 * std::max(std::abs(referenceValue), 1.0));
+    ASSERT_EQ(derivative.GetSize(), referenceDerivative.GetSize());
+    EXPECT_LE((derivative - referenceDerivative).magnitude(), 1e-8 * referenceDerivative.magnitude());
+  }
+}
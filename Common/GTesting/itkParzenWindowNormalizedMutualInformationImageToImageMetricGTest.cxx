@@ -0,0 +1,166 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// First include the header file to be tested:
+#include "NormalizedMutualInformation/itkParzenWindowNormalizedMutualInformationImageToImageMetric.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkExponentialLimiterFunction.h"
+#include "itkHardLimiterFunction.h"
+#include "itkImageFullSampler.h"
+#include "../Core/Main/GTesting/elxCoreMainGTestUtilities.h"
+
+#include <itkBSplineInterpolateImageFunction.h>
+#include <itkImage.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+
+// Using-declaration:
+using elx::CoreMainGTestUtilities::CheckNew;
+
+namespace
+{
+constexpr unsigned int Dimension = 3;
+using ImageType = itk::Image<float, Dimension>;
+using MetricType = itk::ParzenWindowNormalizedMutualInformationImageToImageMetric<ImageType, ImageType>;
+using TransformType = itk::AdvancedBSplineDeformableTransform<double, Dimension, 3>;
+using InterpolatorType = itk::BSplineInterpolateImageFunction<ImageType, double, double>;
+using SamplerType = itk::ImageFullSampler<ImageType>;
+using FixedLimiterType = itk::HardLimiterFunction<MetricType::RealType, Dimension>;
+using MovingLimiterType = itk::ExponentialLimiterFunction<MetricType::RealType, Dimension>;
+
+
+// Creates a smooth image of 16^3 voxels, shifted by the specified number of voxels.
+itk::SmartPointer<ImageType>
+CreateImage(const double shift)
+{
+  const auto image = ImageType::New();
+  image->SetRegions(ImageType::SizeType::Filled(16));
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, image->GetBufferedRegion());
+  for (; !it.IsAtEnd(); ++it)
+  {
+    const auto & index = it.GetIndex();
+    double       value = 100.0;
+    for (unsigned int d = 0; d < Dimension; ++d)
+    {
+      value *= std::cos((index[d] - shift) / 5.0);
+    }
+    it.Set(static_cast<float>(value));
+  }
+  return image;
+}
+
+
+// Creates a B-spline transform with a 7^3 control point grid over the images, and some arbitrary parameters.
+itk::SmartPointer<TransformType>
+CreateTransform()
+{
+  const auto                   transform = CheckNew<TransformType>();
+  TransformType::RegionType    gridRegion;
+  TransformType::SpacingType   gridSpacing;
+  TransformType::OriginType    gridOrigin;
+  TransformType::DirectionType gridDirection;
+  gridRegion.SetSize(TransformType::SizeType::Filled(7));
+  gridSpacing.Fill(4.0);
+  gridOrigin.Fill(-4.0);
+  gridDirection.SetIdentity();
+  transform->SetGridRegion(gridRegion);
+  transform->SetGridSpacing(gridSpacing);
+  transform->SetGridOrigin(gridOrigin);
+  transform->SetGridDirection(gridDirection);
+
+  TransformType::ParametersType parameters(transform->GetNumberOfParameters());
+  for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+  {
+    parameters[i] = std::sin(0.37 * i);
+  }
+  transform->SetParameters(parameters);
+  return transform;
+}
+
+
+// Computes the value and derivative of the metric, with or without explicit joint PDF derivatives, and with the
+// specified number of work units (zero meaning single-threaded).
+void
+ComputeValueAndDerivative(const bool                   useExplicitPDFDerivatives,
+                          const itk::ThreadIdType      numberOfWorkUnits,
+                          MetricType::MeasureType &    value,
+                          MetricType::DerivativeType & derivative)
+{
+  const auto fixedImage = CreateImage(0.0);
+  const auto transform = CreateTransform();
+
+  const auto interpolator = CheckNew<InterpolatorType>();
+  interpolator->SetSplineOrder(1);
+
+  const auto metric = CheckNew<MetricType>();
+  metric->SetFixedImage(fixedImage);
+  metric->SetMovingImage(CreateImage(1.5));
+  metric->SetFixedImageRegion(fixedImage->GetBufferedRegion());
+  metric->SetTransform(transform);
+  metric->SetInterpolator(interpolator);
+  metric->SetImageSampler(CheckNew<SamplerType>());
+  metric->SetFixedImageLimiter(CheckNew<FixedLimiterType>());
+  metric->SetMovingImageLimiter(CheckNew<MovingLimiterType>());
+  metric->SetNumberOfFixedHistogramBins(32);
+  metric->SetNumberOfMovingHistogramBins(32);
+  metric->SetUseDerivative(true);
+  metric->SetUseExplicitPDFDerivatives(useExplicitPDFDerivatives);
+  metric->SetUseMultiThread(numberOfWorkUnits > 0);
+  if (numberOfWorkUnits > 0)
+  {
+    metric->SetNumberOfWorkUnits(numberOfWorkUnits);
+  }
+  metric->Initialize();
+  metric->GetValueAndDerivative(transform->GetParameters(), value, derivative);
+}
+
+} // namespace
+
+
+// Tests that the low memory value and derivative (UseFastAndLowMemoryVersion "true") are equal to those computed with
+// the explicit joint PDF derivatives, both single-threaded and multi-threaded.
+GTEST_TEST(ParzenWindowNormalizedMutualInformationImageToImageMetric, LowMemoryEqualsExplicitPDFDerivatives)
+{
+  MetricType::MeasureType    referenceValue = 0.0;
+  MetricType::DerivativeType referenceDerivative;
+  ComputeValueAndDerivative(true, 0, referenceValue, referenceDerivative);
+  ASSERT_GT(referenceDerivative.magnitude(), 0.0);
+
+  for (const bool useExplicitPDFDerivatives : { true, false })
+  {
+    for (const itk::ThreadIdType numberOfWorkUnits : { 0U, 1U, 2U, 3U, 8U })
+    {
+      MetricType::MeasureType    value = 0.0;
+      MetricType::DerivativeType derivative;
+      ComputeValueAndDerivative(useExplicitPDFDerivatives, numberOfWorkUnits, value, derivative);
+
+      EXPECT_NEAR(value, referenceValue, 1e-8 * std::max(std::abs(referenceValue), 1.0));
+      ASSERT_EQ(derivative.GetSize(), referenceDerivative.GetSize());
+
+      // The explicit joint PDF derivatives are stored in single precision.
+      EXPECT_LE((derivative - referenceDerivative).magnitude(), 1e-5 * referenceDerivative.magnitude());
+    }
+  }
+}
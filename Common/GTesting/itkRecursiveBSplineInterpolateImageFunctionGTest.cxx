@@ -0,0 +1,177 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// First include the header file to be tested:
+#include "itkRecursiveBSplineInterpolateImageFunction.h"
+#include "../Core/Main/GTesting/elxCoreMainGTestUtilities.h"
+
+#include <itkBSplineInterpolateImageFunction.h>
+#include <itkImage.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+// Using-declaration:
+using elx::CoreMainGTestUtilities::CheckNew;
+
+namespace
+{
+// Expects that the recursive interpolator gives the same values and gradients as the ITK B-spline interpolator, for
+// the spline orders 1 to 3, at points in between the voxels and near the border of a smooth image.
+template <unsigned int VDimension>
+void
+ExpectSameAsBSplineInterpolateImageFunction()
+{
+  using ImageType = itk::Image<float, VDimension>;
+  using ITKInterpolatorType = itk::BSplineInterpolateImageFunction<ImageType, double, double>;
+  using RecursiveInterpolatorType = itk::RecursiveBSplineInterpolateImageFunction<ImageType, double, double>;
+  using ContinuousIndexType = typename ITKInterpolatorType::ContinuousIndexType;
+
+  typename ImageType::SizeType    size;
+  typename ImageType::SpacingType spacing;
+  for (unsigned int d = 0; d < VDimension; ++d)
+  {
+    size[d] = 9 - d;
+    spacing[d] = 0.8 + 0.2 * d;
+  }
+  const auto image = ImageType::New();
+  image->SetRegions(size);
+  image->SetSpacing(spacing);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, image->GetBufferedRegion());
+  for (; !it.IsAtEnd(); ++it)
+  {
+    double value = 100.0;
+    for (unsigned int d = 0; d < VDimension; ++d)
+    {
+      value *= std::cos(it.GetIndex()[d] / 2.5 + 0.3 * d);
+    }
+    it.Set(static_cast<float>(value));
+  }
+
+  for (unsigned int splineOrder = 1; splineOrder <= 3; ++splineOrder)
+  {
+    const auto itkInterpolator = CheckNew<ITKInterpolatorType>();
+    itkInterpolator->SetSplineOrder(splineOrder);
+    itkInterpolator->SetInputImage(image);
+    const auto recursiveInterpolator = CheckNew<RecursiveInterpolatorType>();
+    recursiveInterpolator->SetSplineOrder(splineOrder);
+    recursiveInterpolator->SetInputImage(image);
+
+    // Evaluate at each voxel, shifted towards the next voxel by a fraction that differs per dimension. The last voxel
+    // is shifted back, so that all points are inside the image.
+    itk::ImageRegionConstIteratorWithIndex<ImageType> pointIt(image, image->GetBufferedRegion());
+    for (; !pointIt.IsAtEnd(); ++pointIt)
+    {
+      ContinuousIndexType point;
+      for (unsigned int d = 0; d < VDimension; ++d)
+      {
+        const auto index = pointIt.GetIndex()[d];
+        point[d] = index + ((index + 1 < static_cast<itk::IndexValueType>(size[d])) ? 0.3 : -0.4) + 0.1 * d;
+      }
+
+      double                                           itkValue = 0.0;
+      double                                           recursiveValue = 0.0;
+      typename ITKInterpolatorType::CovariantVectorType itkGradient;
+      typename ITKInterpolatorType::CovariantVectorType recursiveGradient;
+      itkInterpolator->EvaluateValueAndDerivativeAtContinuousIndex(point, itkValue, itkGradient);
+      recursiveInterpolator->EvaluateValueAndDerivativeAtContinuousIndex(point, recursiveValue, recursiveGradient);
+
+      EXPECT_NEAR(recursiveValue, itkValue, 1e-8);
+      EXPECT_NEAR(recursiveInterpolator->EvaluateAtContinuousIndex(point),
+                  itkInterpolator->EvaluateAtContinuousIndex(point),
+                  1e-8);
+      for (unsigned int d = 0; d < VDimension; ++d)
+      {
+        EXPECT_NEAR(recursiveGradient[d], itkGradient[d], 1e-8);
+      }
+    }
+  }
+}
+
+} // namespace
+
+
+GTEST_TEST(RecursiveBSplineInterpolateImageFunction, SameAsBSplineInterpolateImageFunction)
+{
+  ExpectSameAsBSplineInterpolateImageFunction<2>();
+  ExpectSameAsBSplineInterpolateImageFunction<3>();
+  ExpectSameAsBSplineInterpolateImageFunction<4>();
+}
+
+
+// Tests that storing the B-spline coefficients in single precision, as the BSplineInterpolatorFloat component does,
+// only changes the values and gradients by the rounding of the coefficients.
+GTEST_TEST(RecursiveBSplineInterpolateImageFunction, FloatCoefficientsCloseToDouble)
+{
+  constexpr unsigned int Dimension = 3;
+  using ImageType = itk::Image<float, Dimension>;
+  using DoubleInterpolatorType = itk::RecursiveBSplineInterpolateImageFunction<ImageType, double, double>;
+  using FloatInterpolatorType = itk::RecursiveBSplineInterpolateImageFunction<ImageType, double, float>;
+
+  const auto image = ImageType::New();
+  image->SetRegions(ImageType::SizeType{ { 10, 9, 8 } });
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, image->GetBufferedRegion());
+  for (; !it.IsAtEnd(); ++it)
+  {
+    const auto & index = it.GetIndex();
+    it.Set(static_cast<float>(100.0 * std::cos(index[0] / 2.5) * std::cos(index[1] / 3.0 + 0.3) + 10.0 * index[2]));
+  }
+
+  const auto doubleInterpolator = CheckNew<DoubleInterpolatorType>();
+  doubleInterpolator->SetSplineOrder(3);
+  doubleInterpolator->SetInputImage(image);
+  const auto floatInterpolator = CheckNew<FloatInterpolatorType>();
+  floatInterpolator->SetSplineOrder(3);
+  floatInterpolator->SetInputImage(image);
+
+  for (double x = 0.0; x < 9.0; x += 0.65)
+  {
+    for (double y = 0.0; y < 8.0; y += 0.55)
+    {
+      for (double z = 0.0; z < 7.0; z += 0.45)
+      {
+        DoubleInterpolatorType::ContinuousIndexType point;
+        point[0] = x;
+        point[1] = y;
+        point[2] = z;
+
+        double                                      doubleValue = 0.0;
+        double                                      floatValue = 0.0;
+        DoubleInterpolatorType::CovariantVectorType doubleGradient;
+        FloatInterpolatorType::CovariantVectorType  floatGradient;
+        doubleInterpolator->EvaluateValueAndDerivativeAtContinuousIndex(point, doubleValue, doubleGradient);
+        floatInterpolator->EvaluateValueAndDerivativeAtContinuousIndex(point, floatValue, floatGradient);
+
+        // The image values are at most about 170, and the float epsilon is about 1.2e-7.
+        EXPECT_NEAR(floatValue, doubleValue, 1e-3);
+        for (unsigned int d = 0; d < Dimension; ++d)
+        {
+          EXPECT_NEAR(floatGradient[d], doubleGradient[d], 1e-3);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,204 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// First include the header file to be tested:
+#include "itkRecursiveBSplineTransform.h"
+#include "../Core/Main/GTesting/elxCoreMainGTestUtilities.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+// Using-declaration:
+using elx::CoreMainGTestUtilities::CheckNew;
+
+namespace
+{
+constexpr unsigned int Dimension = 2;
+using TransformType = itk::RecursiveBSplineTransform<double, Dimension, 3>;
+
+
+// Sets a grid of the specified size, with a grid spacing of 8 and the origin at -8.
+void
+SetGrid(TransformType & transform, const TransformType::SizeType & gridSize)
+{
+  TransformType::RegionType    gridRegion;
+  TransformType::SpacingType   gridSpacing;
+  TransformType::OriginType    gridOrigin;
+  TransformType::DirectionType gridDirection;
+  gridRegion.SetSize(gridSize);
+  gridSpacing.Fill(8.0);
+  gridOrigin.Fill(-8.0);
+  gridDirection.SetIdentity();
+  transform.SetGridRegion(gridRegion);
+  transform.SetGridSpacing(gridSpacing);
+  transform.SetGridOrigin(gridOrigin);
+  transform.SetGridDirection(gridDirection);
+}
+
+
+// Returns smoothly varying parameters for the specified transform.
+TransformType::ParametersType
+CreateParameters(const TransformType & transform, const double frequency)
+{
+  TransformType::ParametersType parameters(transform.GetNumberOfParameters());
+  for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+  {
+    parameters[i] = 3.0 * std::sin(frequency * i);
+  }
+  return parameters;
+}
+
+
+// Expects that both transforms map the points of a grid to the same points, and have the same spatial Jacobian and
+// Hessian there.
+void
+ExpectSameTransform(const TransformType & transform1, const TransformType & transform2)
+{
+  TransformType::SpatialJacobianType sj1, sj2;
+  TransformType::SpatialHessianType  sh1, sh2;
+
+  for (double x = 0.5; x < 16.0; x += 1.25)
+  {
+    for (double y = 0.5; y < 16.0; y += 1.75)
+    {
+      TransformType::InputPointType point;
+      point[0] = x;
+      point[1] = y;
+      const auto outputPoint1 = transform1.TransformPoint(point);
+      const auto outputPoint2 = transform2.TransformPoint(point);
+      EXPECT_LT(outputPoint1.EuclideanDistanceTo(outputPoint2), 1e-12);
+
+      transform1.GetSpatialJacobian(point, sj1);
+      transform2.GetSpatialJacobian(point, sj2);
+      transform1.GetSpatialHessian(point, sh1);
+      transform2.GetSpatialHessian(point, sh2);
+      for (unsigned int i = 0; i < Dimension; ++i)
+      {
+        for (unsigned int j = 0; j < Dimension; ++j)
+        {
+          EXPECT_NEAR(sj1(i, j), sj2(i, j), 1e-12);
+          for (unsigned int k = 0; k < Dimension; ++k)
+          {
+            EXPECT_NEAR(sh1[i](j, k), sh2[i](j, k), 1e-12);
+          }
+        }
+      }
+    }
+  }
+}
+
+} // namespace
+
+
+GTEST_TEST(RecursiveBSplineTransform, InterleavedCoefficientsAreOffByDefault)
+{
+  const auto transform = CheckNew<TransformType>();
+  EXPECT_FALSE(transform->GetUseInterleavedCoefficients());
+}
+
+
+GTEST_TEST(RecursiveBSplineTransform, InterleavedCoefficientsGiveSameResult)
+{
+  const auto transform = CheckNew<TransformType>();
+  const auto interleavedTransform = CheckNew<TransformType>();
+  SetGrid(*transform, TransformType::SizeType{ { 6, 6 } });
+  SetGrid(*interleavedTransform, TransformType::SizeType{ { 6, 6 } });
+
+  const auto parameters = CreateParameters(*transform, 0.7);
+  transform->SetParameters(parameters);
+  interleavedTransform->SetParameters(parameters);
+  interleavedTransform->UseInterleavedCoefficientsOn();
+
+  ExpectSameTransform(*transform, *interleavedTransform);
+}
+
+
+GTEST_TEST(RecursiveBSplineTransform, InterleavedCoefficientsFollowSetParameters)
+{
+  const auto transform = CheckNew<TransformType>();
+  const auto interleavedTransform = CheckNew<TransformType>();
+  SetGrid(*transform, TransformType::SizeType{ { 6, 6 } });
+  SetGrid(*interleavedTransform, TransformType::SizeType{ { 6, 6 } });
+  interleavedTransform->UseInterleavedCoefficientsOn();
+
+  auto parameters = CreateParameters(*transform, 0.7);
+  transform->SetParameters(parameters);
+  interleavedTransform->SetParameters(parameters);
+
+  // Change the parameters in place, as an optimizer does, and pass them again.
+  for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+  {
+    parameters[i] += 0.5 * std::cos(1.3 * i);
+  }
+  transform->SetParameters(parameters);
+  interleavedTransform->SetParameters(parameters);
+
+  ExpectSameTransform(*transform, *interleavedTransform);
+}
+
+
+GTEST_TEST(RecursiveBSplineTransform, InterleavedCoefficientsFollowModifiedCoefficientImages)
+{
+  const auto transform = CheckNew<TransformType>();
+  const auto interleavedTransform = CheckNew<TransformType>();
+  SetGrid(*transform, TransformType::SizeType{ { 6, 6 } });
+  transform->SetParametersByValue(CreateParameters(*transform, 0.7));
+
+  // Let both transforms share the same coefficient images.
+  TransformType::ImagePointer coefficientImages[Dimension];
+  for (unsigned int j = 0; j < Dimension; ++j)
+  {
+    coefficientImages[j] = transform->GetCoefficientImages()[j];
+  }
+  interleavedTransform->UseInterleavedCoefficientsOn();
+  interleavedTransform->SetCoefficientImages(coefficientImages);
+  ExpectSameTransform(*transform, *interleavedTransform);
+
+  // Change the coefficients in place, and mark the images as modified.
+  for (unsigned int j = 0; j < Dimension; ++j)
+  {
+    TransformType::ImageType & image = *coefficientImages[j];
+    const auto                 numberOfPixels = image.GetBufferedRegion().GetNumberOfPixels();
+    for (itk::SizeValueType i = 0; i < numberOfPixels; ++i)
+    {
+      image.GetBufferPointer()[i] += 0.5 * std::cos(0.3 * i + j);
+    }
+    image.Modified();
+  }
+  ExpectSameTransform(*transform, *interleavedTransform);
+}
+
+
+GTEST_TEST(RecursiveBSplineTransform, InterleavedCoefficientsFollowGridWithSameNumberOfPoints)
+{
+  const auto transform = CheckNew<TransformType>();
+  const auto interleavedTransform = CheckNew<TransformType>();
+  SetGrid(*interleavedTransform, TransformType::SizeType{ { 6, 6 } });
+  interleavedTransform->UseInterleavedCoefficientsOn();
+  const auto parameters = CreateParameters(*interleavedTransform, 0.7);
+  interleavedTransform->SetParameters(parameters);
+
+  // A grid of a different shape, but with the same number of control points.
+  SetGrid(*interleavedTransform, TransformType::SizeType{ { 4, 9 } });
+  SetGrid(*transform, TransformType::SizeType{ { 4, 9 } });
+  transform->SetParameters(parameters);
+
+  ExpectSameTransform(*transform, *interleavedTransform);
+}
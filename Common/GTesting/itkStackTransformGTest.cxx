@@ -0,0 +1,206 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// First include the header file to be tested:
+#include "itkStackTransform.h"
+#include "itkRecursiveBSplineTransform.h"
+#include "itkImageFullSampler.h"
+#include "VarianceOverLastDimension/itkVarianceOverLastDimensionImageMetric.h"
+#include "../Core/Main/GTesting/elxCoreMainGTestUtilities.h"
+
+#include <itkBSplineInterpolateImageFunction.h>
+#include <itkImage.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+
+// Using-declaration:
+using elx::CoreMainGTestUtilities::CheckNew;
+
+namespace
+{
+constexpr unsigned int Dimension = 3;
+using TransformType = itk::StackTransform<double, Dimension, Dimension>;
+using SubTransformType = itk::RecursiveBSplineTransform<double, Dimension - 1, 3>;
+using ParametersType = TransformType::ParametersType;
+
+
+// Creates a stack of B-spline transforms, with a grid spacing of 4 and the origin at -4.
+itk::SmartPointer<TransformType>
+CreateStackTransform(const unsigned int numberOfSubTransforms, const unsigned int gridSize)
+{
+  const auto                      subTransform = CheckNew<SubTransformType>();
+  SubTransformType::RegionType    gridRegion;
+  SubTransformType::SpacingType   gridSpacing;
+  SubTransformType::OriginType    gridOrigin;
+  SubTransformType::DirectionType gridDirection;
+  gridRegion.SetSize(SubTransformType::SizeType::Filled(gridSize));
+  gridSpacing.Fill(4.0);
+  gridOrigin.Fill(-4.0);
+  gridDirection.SetIdentity();
+  subTransform->SetGridRegion(gridRegion);
+  subTransform->SetGridSpacing(gridSpacing);
+  subTransform->SetGridOrigin(gridOrigin);
+  subTransform->SetGridDirection(gridDirection);
+  ParametersType subParameters(subTransform->GetNumberOfParameters());
+  subParameters.Fill(0.0);
+  subTransform->SetParametersByValue(subParameters);
+
+  const auto transform = CheckNew<TransformType>();
+  transform->SetNumberOfSubTransforms(numberOfSubTransforms);
+  transform->SetStackOrigin(0.0);
+  transform->SetStackSpacing(1.0);
+  transform->SetAllSubTransforms(subTransform);
+  return transform;
+}
+
+
+// Returns smoothly varying parameters for the specified transform.
+ParametersType
+CreateParameters(const TransformType & transform)
+{
+  ParametersType parameters(transform.GetNumberOfParameters());
+  for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+  {
+    parameters[i] = std::sin(0.37 * i);
+  }
+  return parameters;
+}
+
+} // namespace
+
+
+// Tests that each sub transform gets its own slice of the parameters.
+GTEST_TEST(StackTransform, SubTransformsGetTheirSliceOfTheParameters)
+{
+  const auto           transform = CreateStackTransform(4, 7);
+  const ParametersType parameters = CreateParameters(*transform);
+  transform->SetParameters(parameters);
+
+  EXPECT_EQ(transform->GetParameters(), parameters);
+
+  const unsigned int numberOfSubParameters = transform->GetSubTransform(0)->GetNumberOfParameters();
+  for (unsigned int t = 0; t < transform->GetNumberOfSubTransforms(); ++t)
+  {
+    const auto & subParameters = transform->GetSubTransform(t)->GetParameters();
+    ASSERT_EQ(subParameters.GetSize(), numberOfSubParameters);
+    for (unsigned int i = 0; i < numberOfSubParameters; ++i)
+    {
+      EXPECT_EQ(subParameters[i], parameters[t * numberOfSubParameters + i]);
+    }
+  }
+}
+
+
+// Tests that SetParametersByValue() keeps a copy, so that the transform does not depend on the lifetime of the
+// parameters that are passed.
+GTEST_TEST(StackTransform, SetParametersByValueKeepsACopy)
+{
+  const auto           transform = CreateStackTransform(4, 7);
+  const auto           transformByValue = CreateStackTransform(4, 7);
+  const ParametersType parameters = CreateParameters(*transform);
+  transform->SetParameters(parameters);
+  {
+    ParametersType temporaryParameters = parameters;
+    transformByValue->SetParametersByValue(temporaryParameters);
+    temporaryParameters.Fill(0.0);
+  }
+
+  EXPECT_EQ(transformByValue->GetParameters(), parameters);
+  for (double x = 0.5; x < 12.0; x += 1.5)
+  {
+    for (double t = 0.0; t < 4.0; t += 1.0)
+    {
+      TransformType::InputPointType point;
+      point[0] = x;
+      point[1] = 11.0 - x;
+      point[2] = t;
+      EXPECT_EQ(transformByValue->TransformPoint(point), transform->TransformPoint(point));
+    }
+  }
+}
+
+
+// Tests that the multi-threaded VarianceOverLastDimension metric, which evaluates all time points of a sample in the
+// same thread, gives the same value and derivative as the single-threaded one.
+GTEST_TEST(StackTransform, VarianceOverLastDimensionMultiThreadedEqualsSingleThreaded)
+{
+  using ImageType = itk::Image<float, Dimension>;
+  using MetricType = itk::VarianceOverLastDimensionImageMetric<ImageType, ImageType>;
+  using InterpolatorType = itk::BSplineInterpolateImageFunction<ImageType, double, double>;
+  using SamplerType = itk::ImageFullSampler<ImageType>;
+
+  // A smooth image of 16^2 pixels and 6 frames, with a moving structure.
+  ImageType::SizeType imageSize;
+  imageSize.Fill(16);
+  imageSize[Dimension - 1] = 6;
+  const auto image = ImageType::New();
+  image->SetRegions(imageSize);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, image->GetBufferedRegion());
+  for (; !it.IsAtEnd(); ++it)
+  {
+    const auto & index = it.GetIndex();
+    const double shift = 2.0 * std::sin(index[Dimension - 1] / 2.0);
+    it.Set(static_cast<float>(100.0 * std::cos((index[0] - shift) / 4.0) * std::cos((index[1] + shift) / 5.0)));
+  }
+
+  const auto           transform = CreateStackTransform(imageSize[Dimension - 1], 7);
+  const ParametersType parameters = CreateParameters(*transform);
+  transform->SetParameters(parameters);
+
+  // The samples are taken in the first frame, the metric evaluates them at all frames.
+  ImageType::RegionType sampleRegion = image->GetBufferedRegion();
+  ImageType::SizeType   sampleSize = sampleRegion.GetSize();
+  sampleSize[Dimension - 1] = 1;
+  sampleRegion.SetSize(sampleSize);
+
+  const auto interpolator = CheckNew<InterpolatorType>();
+  interpolator->SetSplineOrder(1);
+
+  const auto metric = CheckNew<MetricType>();
+  metric->SetFixedImage(image);
+  metric->SetMovingImage(image);
+  metric->SetFixedImageRegion(sampleRegion);
+  metric->SetTransform(transform);
+  metric->SetInterpolator(interpolator);
+  metric->SetImageSampler(CheckNew<SamplerType>());
+  metric->SetTransformIsStackTransform(true);
+  metric->SetSubtractMean(true);
+  metric->Initialize();
+
+  MetricType::MeasureType    valueST = 0.0;
+  MetricType::MeasureType    valueMT = 0.0;
+  MetricType::DerivativeType derivativeST;
+  MetricType::DerivativeType derivativeMT;
+
+  metric->SetUseMultiThread(false);
+  metric->GetValueAndDerivative(parameters, valueST, derivativeST);
+  metric->SetUseMultiThread(true);
+  metric->GetValueAndDerivative(parameters, valueMT, derivativeMT);
+
+  // The sums are accumulated in a different order, partly in float.
+  EXPECT_NEAR(valueMT, valueST, 1e-5 * std::max(std::abs(valueST), 1.0));
+  ASSERT_EQ(derivativeMT.GetSize(), derivativeST.GetSize());
+  EXPECT_LE((derivativeST - derivativeMT).magnitude(), 1e-5 * std::max(derivativeST.magnitude(), 1.0));
+}
@@ -0,0 +1,308 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// First include the header file to be tested:
+#include "StatisticalShapePenalty/itkStatisticalShapePointPenalty.h"
+#include "CorrespondingPointsEuclideanDistanceMetric/itkCorrespondingPointsEuclideanDistancePointMetric.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "../Core/Main/GTesting/elxCoreMainGTestUtilities.h"
+
+#include <itkPointSet.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+
+// Using-declaration:
+using elx::CoreMainGTestUtilities::CheckNew;
+
+namespace
+{
+constexpr unsigned int Dimension = 3;
+constexpr unsigned int NumberOfPoints = 10;
+constexpr unsigned int ShapeLength = Dimension * NumberOfPoints;
+using MeshTraitsType = itk::DefaultStaticMeshTraits<double, Dimension, Dimension, double, double, double>;
+using PointSetType = itk::PointSet<double, Dimension, MeshTraitsType>;
+using PenaltyType = itk::StatisticalShapePointPenalty<PointSetType, PointSetType>;
+using DistanceMetricType = itk::CorrespondingPointsEuclideanDistancePointMetric<PointSetType, PointSetType>;
+using TransformType = itk::AdvancedBSplineDeformableTransform<double, Dimension, 3>;
+
+
+// Creates a point set of 10 scattered points around (5, 5, 5), shifted by the specified offset.
+itk::SmartPointer<PointSetType>
+CreatePointSet(const double offset)
+{
+  const auto pointSet = PointSetType::New();
+  for (unsigned int i = 0; i < NumberOfPoints; ++i)
+  {
+    PointSetType::PointType point;
+    for (unsigned int d = 0; d < Dimension; ++d)
+    {
+      point[d] = 5.0 + 3.0 * std::sin(0.37 * i + 1.3 * d) + offset;
+    }
+    pointSet->SetPoint(i, point);
+  }
+  return pointSet;
+}
+
+
+// Creates a B-spline transform with a 6^3 control point grid around the points.
+itk::SmartPointer<TransformType>
+CreateTransform()
+{
+  const auto                   transform = CheckNew<TransformType>();
+  TransformType::RegionType    gridRegion;
+  TransformType::SpacingType   gridSpacing;
+  TransformType::OriginType    gridOrigin;
+  TransformType::DirectionType gridDirection;
+  gridRegion.SetSize(TransformType::SizeType::Filled(6));
+  gridSpacing.Fill(4.0);
+  gridOrigin.Fill(-4.0);
+  gridDirection.SetIdentity();
+  transform->SetGridRegion(gridRegion);
+  transform->SetGridSpacing(gridSpacing);
+  transform->SetGridOrigin(gridOrigin);
+  transform->SetGridDirection(gridDirection);
+  return transform;
+}
+
+
+// Creates some arbitrary transform parameters, for a non-trivial deformation of the points.
+TransformType::ParametersType
+CreateParameters(const TransformType & transform)
+{
+  TransformType::ParametersType parameters(transform.GetNumberOfParameters());
+  for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+  {
+    parameters[i] = 0.3 * std::sin(0.37 * i);
+  }
+  return parameters;
+}
+
+
+// Creates a symmetric positive definite covariance matrix of the specified size. The penalty takes ownership.
+const vnl_matrix<double> *
+CreateCovarianceMatrix(const unsigned int size)
+{
+  vnl_matrix<double> factor(size, size);
+  for (unsigned int i = 0; i < size; ++i)
+  {
+    for (unsigned int j = 0; j < size; ++j)
+    {
+      factor(i, j) = std::sin(0.37 * (i * size + j) + 0.1);
+    }
+  }
+  auto * const covariance = new vnl_matrix<double>(factor * factor.transpose() / static_cast<double>(size));
+  for (unsigned int i = 0; i < size; ++i)
+  {
+    (*covariance)(i, i) += 0.1;
+  }
+  return covariance;
+}
+
+
+// Creates a mean shape vector. For a normalized shape model, it is followed by the centroid and the size of the shape.
+// The penalty takes ownership.
+const vnl_vector<double> *
+CreateMeanVector(const bool normalizedShapeModel)
+{
+  const auto pointSet = CreatePointSet(0.2);
+
+  auto * const meanVector = new vnl_vector<double>(normalizedShapeModel ? ShapeLength + Dimension + 1 : ShapeLength);
+  for (unsigned int i = 0; i < NumberOfPoints; ++i)
+  {
+    const auto point = pointSet->GetPoint(i);
+    for (unsigned int d = 0; d < Dimension; ++d)
+    {
+      // The normalized shape is centered, and scaled to a unit l2-norm.
+      (*meanVector)[i * Dimension + d] = normalizedShapeModel ? (point[d] - 5.0) / 12.0 : point[d];
+    }
+  }
+  if (normalizedShapeModel)
+  {
+    for (unsigned int d = 0; d < Dimension; ++d)
+    {
+      (*meanVector)[ShapeLength + d] = 5.1;
+    }
+    (*meanVector)[ShapeLength + Dimension] = 12.0;
+  }
+  return meanVector;
+}
+
+
+// Creates and initializes a statistical shape penalty, with the specified shape model, and the specified number of
+// work units (zero meaning single-threaded).
+itk::SmartPointer<PenaltyType>
+CreatePenalty(const int               shapeModelCalculation,
+              const bool              normalizedShapeModel,
+              const itk::ThreadIdType numberOfWorkUnits,
+              TransformType &         transform)
+{
+  const auto pointSet = CreatePointSet(0.0);
+  const auto proposalLength = normalizedShapeModel ? ShapeLength + Dimension + 1 : ShapeLength;
+
+  const auto penalty = CheckNew<PenaltyType>();
+  penalty->SetFixedPointSet(pointSet);
+  penalty->SetMovingPointSet(pointSet);
+  penalty->SetTransform(&transform);
+  penalty->SetShapeModelCalculation(shapeModelCalculation);
+  penalty->SetNormalizedShapeModel(normalizedShapeModel);
+  penalty->SetMeanVector(CreateMeanVector(normalizedShapeModel));
+  penalty->SetCovarianceMatrix(CreateCovarianceMatrix(proposalLength));
+  penalty->SetShrinkageIntensity(0.5);
+  penalty->SetBaseVariance(1.0);
+  penalty->SetCentroidXVariance(1.0);
+  penalty->SetCentroidYVariance(1.0);
+  penalty->SetCentroidZVariance(1.0);
+  penalty->SetSizeVariance(1.0);
+  penalty->SetCutOffValue(0.0);
+  penalty->SetCutOffSharpness(2.0);
+  penalty->SetUseMultiThread(numberOfWorkUnits > 0);
+  if (numberOfWorkUnits > 0)
+  {
+    penalty->SetNumberOfWorkUnits(numberOfWorkUnits);
+  }
+  penalty->Initialize();
+  return penalty;
+}
+
+
+// The shape models: the full covariance (0) and the decomposed covariances (1 and 2), with and without normalization.
+struct ShapeModel
+{
+  int  shapeModelCalculation;
+  bool normalizedShapeModel;
+};
+constexpr ShapeModel shapeModels[] = { { 0, false }, { 0, true }, { 1, false }, { 2, true } };
+
+} // namespace
+
+
+// Tests that the derivative of the statistical shape penalty equals its central finite differences, for each shape
+// model.
+GTEST_TEST(StatisticalShapePointPenalty, DerivativeEqualsFiniteDifferences)
+{
+  for (const auto shapeModel : shapeModels)
+  {
+    SCOPED_TRACE(shapeModel.shapeModelCalculation);
+    SCOPED_TRACE(shapeModel.normalizedShapeModel);
+
+    const auto transform = CreateTransform();
+    const auto parameters = CreateParameters(*transform);
+    const auto penalty =
+      CreatePenalty(shapeModel.shapeModelCalculation, shapeModel.normalizedShapeModel, 0, *transform);
+
+    PenaltyType::MeasureType    value = 0.0;
+    PenaltyType::DerivativeType derivative;
+    penalty->GetValueAndDerivative(parameters, value, derivative);
+    ASSERT_GT(value, 0.0);
+    ASSERT_EQ(derivative.GetSize(), parameters.GetSize());
+    ASSERT_GT(derivative.magnitude(), 0.0);
+
+    // The transform keeps a pointer to the parameters, so the perturbed parameters are evaluated immediately.
+    constexpr double            delta = 1e-5;
+    PenaltyType::DerivativeType finiteDifferences(parameters.GetSize());
+    for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+    {
+      auto perturbedParameters = parameters;
+      perturbedParameters[i] = parameters[i] + delta;
+      const double valueRight = penalty->GetValue(perturbedParameters);
+      perturbedParameters[i] = parameters[i] - delta;
+      const double valueLeft = penalty->GetValue(perturbedParameters);
+      finiteDifferences[i] = (valueRight - valueLeft) / (2.0 * delta);
+    }
+    penalty->GetValue(parameters);
+
+    EXPECT_LE((derivative - finiteDifferences).magnitude(), 1e-6 * std::max(derivative.magnitude(), 1.0));
+  }
+}
+
+
+// Tests that the multi-threaded value and derivative of the statistical shape penalty are equal to the single-threaded
+// ones, for each shape model.
+GTEST_TEST(StatisticalShapePointPenalty, MultiThreadedEqualsSingleThreaded)
+{
+  for (const auto shapeModel : shapeModels)
+  {
+    SCOPED_TRACE(shapeModel.shapeModelCalculation);
+    SCOPED_TRACE(shapeModel.normalizedShapeModel);
+
+    const auto transform = CreateTransform();
+    const auto parameters = CreateParameters(*transform);
+
+    PenaltyType::MeasureType    referenceValue = 0.0;
+    PenaltyType::DerivativeType referenceDerivative;
+    CreatePenalty(shapeModel.shapeModelCalculation, shapeModel.normalizedShapeModel, 0, *transform)
+      ->GetValueAndDerivative(parameters, referenceValue, referenceDerivative);
+
+    for (const itk::ThreadIdType numberOfWorkUnits : { 1U, 2U, 3U, 8U })
+    {
+      PenaltyType::MeasureType    value = 0.0;
+      PenaltyType::DerivativeType derivative;
+      CreatePenalty(shapeModel.shapeModelCalculation, shapeModel.normalizedShapeModel, numberOfWorkUnits, *transform)
+        ->GetValueAndDerivative(parameters, value, derivative);
+
+      EXPECT_NEAR(value, referenceValue, 1e-10 * std::max(std::abs(referenceValue), 1.0));
+      ASSERT_EQ(derivative.GetSize(), referenceDerivative.GetSize());
+      EXPECT_LE((derivative - referenceDerivative).magnitude(), 1e-10 * std::max(referenceDerivative.magnitude(), 1.0));
+    }
+  }
+}
+
+
+// Tests that the multi-threaded value and derivative of the corresponding points metric are equal to the
+// single-threaded ones.
+GTEST_TEST(CorrespondingPointsEuclideanDistancePointMetric, MultiThreadedEqualsSingleThreaded)
+{
+  const auto transform = CreateTransform();
+  const auto parameters = CreateParameters(*transform);
+
+  DistanceMetricType::MeasureType    referenceValue = 0.0;
+  DistanceMetricType::DerivativeType referenceDerivative;
+
+  for (const itk::ThreadIdType numberOfWorkUnits : { 0U, 1U, 2U, 3U, 8U })
+  {
+    const auto metric = CheckNew<DistanceMetricType>();
+    metric->SetFixedPointSet(CreatePointSet(0.0));
+    metric->SetMovingPointSet(CreatePointSet(0.5));
+    metric->SetTransform(transform);
+    metric->SetUseMultiThread(numberOfWorkUnits > 0);
+    if (numberOfWorkUnits > 0)
+    {
+      metric->SetNumberOfWorkUnits(numberOfWorkUnits);
+    }
+    metric->Initialize();
+
+    DistanceMetricType::MeasureType    value = 0.0;
+    DistanceMetricType::DerivativeType derivative;
+    metric->GetValueAndDerivative(parameters, value, derivative);
+
+    if (numberOfWorkUnits == 0)
+    {
+      ASSERT_GT(derivative.magnitude(), 0.0);
+      referenceValue = value;
+      referenceDerivative = derivative;
+      continue;
+    }
+    EXPECT_NEAR(value, referenceValue, 1e-10 * std::max(std::abs(referenceValue), 1.0));
+    ASSERT_EQ(derivative.GetSize(), referenceDerivative.GetSize());
+    EXPECT_LE((derivative - referenceDerivative).magnitude(), 1e-10 * std::max(referenceDerivative.magnitude(), 1.0));
+  }
+}
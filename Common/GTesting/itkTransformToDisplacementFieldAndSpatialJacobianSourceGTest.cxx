@@ -0,0 +1,184 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// First include the header file to be tested:
+#include "itkTransformToDisplacementFieldAndSpatialJacobianSource.h"
+#include "itkRecursiveBSplineTransform.h"
+#include "itkTransformToDeterminantOfSpatialJacobianSource.h"
+#include "itkTransformToDisplacementFieldFilter.h"
+#include "itkTransformToSpatialJacobianSource.h"
+#include "../Core/Main/GTesting/elxCoreMainGTestUtilities.h"
+
+#include <itkImage.h>
+#include <itkImageRegionConstIterator.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+
+// Using-declaration:
+using elx::CoreMainGTestUtilities::CheckNew;
+
+namespace
+{
+constexpr unsigned int Dimension = 2;
+using TransformType = itk::RecursiveBSplineTransform<double, Dimension, 3>;
+using FieldImageType = itk::Image<itk::Vector<float, Dimension>, Dimension>;
+using DeterminantImageType = itk::Image<float, Dimension>;
+using SpatialJacobianImageType = itk::Image<itk::Matrix<float, Dimension, Dimension>, Dimension>;
+using SinglePassType = itk::
+  TransformToDisplacementFieldAndSpatialJacobianSource<FieldImageType, DeterminantImageType, SpatialJacobianImageType>;
+
+const FieldImageType::SizeType outputSize{ { 21, 17 } };
+
+
+// Creates a B-spline transform with a grid spacing of 8 voxels, covering the output grid, with smoothly varying
+// coefficients.
+itk::SmartPointer<TransformType>
+CreateBSplineTransform()
+{
+  const auto                   transform = TransformType::New();
+  TransformType::RegionType    gridRegion;
+  TransformType::SpacingType   gridSpacing;
+  TransformType::OriginType    gridOrigin;
+  TransformType::DirectionType gridDirection;
+  gridRegion.SetSize(TransformType::SizeType{ { 6, 6 } });
+  gridSpacing.Fill(8.0);
+  gridOrigin.Fill(-8.0);
+  gridDirection.SetIdentity();
+  transform->SetGridRegion(gridRegion);
+  transform->SetGridSpacing(gridSpacing);
+  transform->SetGridOrigin(gridOrigin);
+  transform->SetGridDirection(gridDirection);
+
+  TransformType::ParametersType parameters(transform->GetNumberOfParameters());
+  for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+  {
+    parameters[i] = 3.0 * std::sin(0.7 * i);
+  }
+  transform->SetParametersByValue(parameters);
+  return transform;
+}
+
+
+// Returns the maximum absolute difference between two images of the same size.
+template <class TImage, class TDifferenceFunction>
+double
+GetMaximumDifference(const TImage & image1, const TImage & image2, TDifferenceFunction differenceFunction)
+{
+  EXPECT_EQ(image1.GetBufferedRegion(), image2.GetBufferedRegion());
+
+  itk::ImageRegionConstIterator<TImage> it1(&image1, image1.GetBufferedRegion());
+  itk::ImageRegionConstIterator<TImage> it2(&image2, image1.GetBufferedRegion());
+  double                                maximumDifference = 0.0;
+  for (; !it1.IsAtEnd(); ++it1, ++it2)
+  {
+    maximumDifference = std::max(maximumDifference, differenceFunction(it1.Get(), it2.Get()));
+  }
+  return maximumDifference;
+}
+
+
+// Generates the specified outputs in a single pass, and compares each of them with the output of its separate source.
+void
+ExpectSinglePassEqualsSeparateSources(const bool generateDisplacementField,
+                                      const bool generateDeterminant,
+                                      const bool generateSpatialJacobian)
+{
+  const auto transform = CreateBSplineTransform();
+
+  const auto singlePass = CheckNew<SinglePassType>();
+  singlePass->SetTransform(transform);
+  singlePass->SetOutputSize(outputSize);
+  singlePass->SetGenerateDisplacementField(generateDisplacementField);
+  singlePass->SetGenerateDeterminantOfSpatialJacobian(generateDeterminant);
+  singlePass->SetGenerateSpatialJacobian(generateSpatialJacobian);
+  singlePass->Update();
+
+  // The outputs are computed in float, by the same calls of the transform.
+  constexpr double tolerance = 1e-5;
+
+  if (generateDisplacementField)
+  {
+    const auto fieldSource = CheckNew<itk::TransformToDisplacementFieldFilter<FieldImageType, double>>();
+    fieldSource->SetTransform(transform);
+    fieldSource->SetSize(outputSize);
+    fieldSource->Update();
+    EXPECT_LE(GetMaximumDifference(
+                *fieldSource->GetOutput(),
+                *singlePass->GetDisplacementFieldOutput(),
+                [](const FieldImageType::PixelType & value1, const FieldImageType::PixelType & value2) {
+                  return (value1 - value2).GetNorm();
+                }),
+              tolerance);
+  }
+  if (generateDeterminant)
+  {
+    const auto determinantSource =
+      CheckNew<itk::TransformToDeterminantOfSpatialJacobianSource<DeterminantImageType, double>>();
+    determinantSource->SetTransform(transform);
+    determinantSource->SetOutputSize(outputSize);
+    determinantSource->Update();
+    EXPECT_LE(GetMaximumDifference(*determinantSource->GetOutput(),
+                                   *singlePass->GetDeterminantOfSpatialJacobianOutput(),
+                                   [](const float value1, const float value2) { return std::abs(value1 - value2); }),
+              tolerance);
+  }
+  if (generateSpatialJacobian)
+  {
+    const auto spatialJacobianSource =
+      CheckNew<itk::TransformToSpatialJacobianSource<SpatialJacobianImageType, double>>();
+    spatialJacobianSource->SetTransform(transform);
+    spatialJacobianSource->SetOutputSize(outputSize);
+    spatialJacobianSource->Update();
+    EXPECT_LE(GetMaximumDifference(*spatialJacobianSource->GetOutput(),
+                                   *singlePass->GetSpatialJacobianOutput(),
+                                   [](const SpatialJacobianImageType::PixelType & value1,
+                                      const SpatialJacobianImageType::PixelType & value2) {
+                                     return (value1.GetVnlMatrix() - value2.GetVnlMatrix()).absolute_value_max();
+                                   }),
+              tolerance);
+  }
+}
+
+} // namespace
+
+
+// Tests all three outputs, as transformix computes them for "-def all -jac all -jacmat all".
+GTEST_TEST(TransformToDisplacementFieldAndSpatialJacobianSource, AllOutputs)
+{
+  ExpectSinglePassEqualsSeparateSources(true, true, true);
+}
+
+
+// Tests "-jac all -jacmat all" without "-def", for which the displacement field is not buffered.
+GTEST_TEST(TransformToDisplacementFieldAndSpatialJacobianSource, SpatialJacobianOutputsWithoutDisplacementField)
+{
+  ExpectSinglePassEqualsSeparateSources(false, true, true);
+}
+
+
+// Tests each output on its own.
+GTEST_TEST(TransformToDisplacementFieldAndSpatialJacobianSource, SingleOutput)
+{
+  ExpectSinglePassEqualsSeparateSources(true, false, false);
+  ExpectSinglePassEqualsSeparateSources(false, true, false);
+  ExpectSinglePassEqualsSeparateSources(false, false, true);
+}
@@ -0,0 +1,130 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+// First include the header file to be tested:
+#include "itkTransformToInverseDisplacementFieldSource.h"
+#include "itkAdvancedCombinationTransform.h"
+#include "itkAdvancedMatrixOffsetTransformBase.h"
+#include "itkRecursiveBSplineTransform.h"
+#include "../Core/Main/GTesting/elxCoreMainGTestUtilities.h"
+
+#include <itkImage.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+// Using-declaration:
+using elx::CoreMainGTestUtilities::CheckNew;
+
+
+// Tests that the inverse displacement field inverts an affine transform composed with a B-spline transform, both
+// when each point starts at x0 = y, and when it starts at the interpolated coarse inverse.
+GTEST_TEST(TransformToInverseDisplacementFieldSource, InvertsAffineAndBSplineTransform)
+{
+  constexpr unsigned int Dimension = 3;
+  constexpr unsigned int GridSize = 24;
+  constexpr double       Tolerance = 0.01;
+  using CombinationType = itk::AdvancedCombinationTransform<double, Dimension>;
+  using AffineType = itk::AdvancedMatrixOffsetTransformBase<double, Dimension, Dimension>;
+  using BSplineType = itk::RecursiveBSplineTransform<double, Dimension, 3>;
+  using FieldImageType = itk::Image<itk::Vector<float, Dimension>, Dimension>;
+  using InverseType = itk::TransformToInverseDisplacementFieldSource<FieldImageType, double>;
+
+  // An affine transform with a rotation of about 10 degrees, scaling and translation.
+  const auto             affine = CheckNew<AffineType>();
+  AffineType::MatrixType matrix;
+  matrix(0, 0) = 0.98;
+  matrix(0, 1) = -0.17;
+  matrix(0, 2) = 0.02;
+  matrix(1, 0) = 0.17;
+  matrix(1, 1) = 1.03;
+  matrix(1, 2) = -0.05;
+  matrix(2, 0) = -0.01;
+  matrix(2, 1) = 0.06;
+  matrix(2, 2) = 0.95;
+  AffineType::OutputVectorType translation;
+  translation[0] = 2.5;
+  translation[1] = -1.5;
+  translation[2] = 3.0;
+  AffineType::InputPointType center;
+  center.Fill(GridSize / 2.0);
+  affine->SetCenter(center);
+  affine->SetMatrix(matrix);
+  affine->SetTranslation(translation);
+
+  // A smooth, invertible B-spline deformation with a grid spacing of 8 voxels.
+  const auto                 bspline = CheckNew<BSplineType>();
+  BSplineType::RegionType    gridRegion;
+  BSplineType::SpacingType   gridSpacing;
+  BSplineType::OriginType    gridOrigin;
+  BSplineType::DirectionType gridDirection;
+  gridRegion.SetSize(BSplineType::SizeType::Filled(GridSize / 8 + 7));
+  gridSpacing.Fill(8.0);
+  gridOrigin.Fill(-16.0);
+  gridDirection.SetIdentity();
+  bspline->SetGridRegion(gridRegion);
+  bspline->SetGridSpacing(gridSpacing);
+  bspline->SetGridOrigin(gridOrigin);
+  bspline->SetGridDirection(gridDirection);
+
+  BSplineType::ParametersType parameters(bspline->GetNumberOfParameters());
+  for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+  {
+    parameters[i] = 1.5 * std::sin(0.37 * i);
+  }
+
+  const auto initialTransform = CheckNew<CombinationType>();
+  initialTransform->SetCurrentTransform(affine);
+  const auto transform = CheckNew<CombinationType>();
+  transform->SetInitialTransform(initialTransform);
+  transform->SetCurrentTransform(bspline);
+  transform->SetParameters(parameters);
+
+  for (const unsigned int coarseGridSpacing : { 1U, 4U })
+  {
+    const auto inverse = CheckNew<InverseType>();
+    inverse->SetTransform(transform);
+    inverse->SetOutputSize(FieldImageType::SizeType::Filled(GridSize));
+    inverse->SetTolerance(Tolerance);
+    inverse->SetMaximumNumberOfIterations(50);
+    inverse->SetCoarseGridSpacing(coarseGridSpacing);
+    inverse->Update();
+
+    EXPECT_EQ(inverse->GetNumberOfNonConvergedPoints(), 0U);
+    EXPECT_LE(inverse->GetMaximumResidual(), Tolerance);
+    EXPECT_LE(inverse->GetMeanResidual(), inverse->GetMaximumResidual());
+
+    // Transforming y + v(y) should give y, up to the tolerance and the rounding of the displacements to float.
+    const FieldImageType &                                 field = *inverse->GetOutput();
+    itk::ImageRegionConstIteratorWithIndex<FieldImageType> it(&field, field.GetBufferedRegion());
+    for (; !it.IsAtEnd(); ++it)
+    {
+      CombinationType::InputPointType y;
+      field.TransformIndexToPhysicalPoint(it.GetIndex(), y);
+      CombinationType::InputPointType x = y;
+      for (unsigned int d = 0; d < Dimension; ++d)
+      {
+        x[d] += it.Get()[d];
+      }
+      EXPECT_LE((transform->TransformPoint(x) - y).GetNorm(), 1.01 * Tolerance);
+    }
+  }
+}
@@ -70,6 +70,7 @@ public:
   using typename Superclass::InputImageIndexType;
   using typename Superclass::InputImagePointType;
   using typename Superclass::InputImagePointValueType;
+  using typename Superclass::ImageSamplePointType;
   using typename Superclass::ImageSampleValueType;
 
   /** The input image dimension. */
@@ -95,7 +95,7 @@ ImageRandomCoordinateSampler<TInputImage>::GenerateData(void)
     for (iter = sampleContainer->Begin(); iter != end; ++iter)
     {
       /** Make a reference to the current sample in the container. */
-      InputImagePointType &  samplePoint = (*iter).Value().m_ImageCoordinates;
+      ImageSamplePointType & samplePoint = (*iter).Value().m_ImageCoordinates;
       ImageSampleValueType & sampleValue = (*iter).Value().m_ImageValue;
 
       /** Walk over the image until we find a valid point. */
@@ -125,7 +125,7 @@ ImageRandomCoordinateSampler<TInputImage>::GenerateData(void)
     for (iter = sampleContainer->Begin(); iter != end; ++iter)
     {
       /** Make a reference to the current sample in the container. */
-      InputImagePointType &  samplePoint = (*iter).Value().m_ImageCoordinates;
+      ImageSamplePointType & samplePoint = (*iter).Value().m_ImageCoordinates;
       ImageSampleValueType & sampleValue = (*iter).Value().m_ImageValue;
 
       /** Walk over the image until we find a valid point */
@@ -253,7 +253,7 @@ ImageRandomCoordinateSampler<TInputImage>::ThreadedGenerateData(const InputImage
     }
 
     /** Make a reference to the current sample in the container. */
-    InputImagePointType &  samplePoint = (*iter).Value().m_ImageCoordinates;
+    ImageSamplePointType & samplePoint = (*iter).Value().m_ImageCoordinates;
     ImageSampleValueType & sampleValue = (*iter).Value().m_ImageValue;
 
     /** Convert to point */
@@ -20,7 +20,7 @@
 
 #include "itkImageRandomSamplerBase.h"
 #include "itkMersenneTwisterRandomVariateGenerator.h"
-#include "itkImageFullSampler.h"
+#include <vector>
 
 namespace itk
 {
@@ -30,7 +30,11 @@ namespace itk
  *
  * This version takes into account that the mask may be very small.
  * Also, it may be more efficient when very many different sample sets
- * of the same input image are required, because it does some precomputation.
+ * of the same input image are required, because it does some precomputation:
+ * the buffer offsets of all voxels inside the mask are collected once, and
+ * are only recomputed when the input image, the mask or the input image region
+ * change (typically once per resolution). Every Update() then only draws the
+ * requested number of samples from this list, optionally multi-threaded.
  * \ingroup ImageSamplers
  */
 
@@ -68,17 +72,22 @@ public:
   itkStaticConstMacro(InputImageDimension, unsigned int, Superclass::InputImageDimension);
 
   /** Other typdefs. */
-  typedef typename InputImageType::IndexType InputImageIndexType;
-  typedef typename InputImageType::PointType InputImagePointType;
+  typedef typename InputImageType::IndexType       InputImageIndexType;
+  typedef typename InputImageType::PointType       InputImagePointType;
+  typedef typename InputImageType::OffsetValueType InputImageOffsetValueType;
 
   /** The random number generator used to generate random indices. */
   typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
   typedef typename RandomGeneratorType::Pointer                  RandomGeneratorPointer;
 
-protected:
-  typedef itk::ImageFullSampler<InputImageType>     InternalFullSamplerType;
-  typedef typename InternalFullSamplerType::Pointer InternalFullSamplerPointer;
+  /** Get the number of voxels inside the mask, as found by the last update. */
+  virtual SizeValueType
+  GetNumberOfValidVoxels(void) const
+  {
+    return this->m_ValidVoxelOffsets.size();
+  }
 
+protected:
   /** The constructor. */
   ImageRandomSamplerSparseMask();
   /** The destructor. */
@@ -99,10 +108,40 @@ protected:
   void
   ThreadedGenerateData(const InputImageRegionType & inputRegionForThread, ThreadIdType threadId) override;
 
-  RandomGeneratorPointer     m_RandomGenerator;
-  InternalFullSamplerPointer m_InternalFullSampler;
+  /** The threads write directly into the output container, so there is nothing to combine. */
+  void
+  AfterThreadedGenerateData(void) override
+  {}
+
+  /** Collect the buffer offsets of all voxels in the cropped input image
+   * region that lie inside the mask. Does nothing when the cached list
+   * is still up-to-date.
+   */
+  virtual void
+  UpdateValidVoxelOffsets(void);
+
+  /** Fill the sample container elements [begin, end) with the voxels
+   * selected by m_RandomNumberList.
+   */
+  void
+  GenerateSamplesForRange(const unsigned long begin, const unsigned long end);
+
+  RandomGeneratorPointer m_RandomGenerator;
 
 private:
+  /** The buffer offsets of the voxels inside the mask. */
+  std::vector<InputImageOffsetValueType> m_ValidVoxelOffsets;
+
+  /** The state for which m_ValidVoxelOffsets was computed. */
+  const InputImageType * m_ValidVoxelOffsetsInputImage{ nullptr };
+  const MaskType *       m_ValidVoxelOffsetsMask{ nullptr };
+  InputImageRegionType   m_ValidVoxelOffsetsRegion;
+  InputImageRegionType   m_ValidVoxelOffsetsBufferedRegion;
+  TimeStamp              m_ValidVoxelOffsetsMTime;
+
+  /** The number of pieces in which the samples are divided when threading. */
+  ThreadIdType m_NumberOfSampleChunks{ 1 };
+
   /** The deleted copy constructor. */
   ImageRandomSamplerSparseMask(const Self &) = delete;
   /** The deleted assignment operator. */
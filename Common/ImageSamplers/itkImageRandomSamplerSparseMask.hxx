@@ -20,6 +20,8 @@
 
 #include "itkImageRandomSamplerSparseMask.h"
 
+#include "itkImageRegionConstIteratorWithIndex.h"
+
 namespace itk
 {
 
@@ -33,8 +35,6 @@ ImageRandomSamplerSparseMask<TInputImage>::ImageRandomSamplerSparseMask()
   /** Setup random generator. */
   this->m_RandomGenerator = RandomGeneratorType::GetInstance();
 
-  this->m_InternalFullSampler = InternalFullSamplerType::New();
-
 } // end Constructor
 
 
@@ -55,44 +55,33 @@ ImageRandomSamplerSparseMask<TInputImage>::GenerateData(void)
     itkExceptionMacro(<< "ERROR: do not call this function when no mask is supplied.");
   }
 
-  /** Get handles to the input image and output sample container. */
-  InputImageConstPointer      inputImage = this->GetInput();
-  ImageSampleContainerPointer sampleContainer = this->GetOutput();
-
-  /** Clear the container. */
-  sampleContainer->Initialize();
-
-  /** Make sure the internal full sampler is up-to-date. */
-  this->m_InternalFullSampler->SetInput(inputImage);
-  this->m_InternalFullSampler->SetMask(mask);
-  this->m_InternalFullSampler->SetInputImageRegion(this->GetCroppedInputImageRegion());
-
-  /** Use try/catch, since the full sampler may crash, due to insufficient memory. */
-  try
+  /** Make sure the list of voxels inside the mask is up-to-date.
+   * This is only expensive when the input image, the mask or the
+   * input image region changed since the previous call.
+   */
+  this->UpdateValidVoxelOffsets();
+  const unsigned long numberOfValidVoxels = this->m_ValidVoxelOffsets.size();
+  if (numberOfValidVoxels == 0)
   {
-    this->m_InternalFullSampler->Update();
+    itkExceptionMacro(<< "ERROR: the mask does not contain any voxel of the InputImageRegion.");
   }
-  catch (ExceptionObject & err)
+
+  /** Select the random voxels. This is done sequentially for all samples,
+   * such that the selection does not depend on the number of threads.
+   */
+  this->m_RandomNumberList.resize(0);
+  this->m_RandomNumberList.reserve(this->m_NumberOfSamples);
+  for (unsigned long i = 0; i < this->GetNumberOfSamples(); ++i)
   {
-    std::string message = "ERROR: This ImageSampler internally uses the "
-                          "ImageFullSampler. Updating of this internal sampler raised the "
-                          "exception:\n";
-    message += err.GetDescription();
-
-    std::string            fullSamplerMessage = err.GetDescription();
-    std::string::size_type loc =
-      fullSamplerMessage.find("ERROR: failed to allocate memory for the sample container", 0);
-    if (loc != std::string::npos && this->GetMask() == nullptr)
-    {
-      message += "\nYou are using the ImageRandomSamplerSparseMask sampler, "
-                 "but you did not set a mask. The internal ImageFullSampler therefore "
-                 "requires a lot of memory. Consider using the ImageRandomSampler "
-                 "instead.";
-    }
-    const char * message2 = message.c_str();
-    itkExceptionMacro(<< message2);
+    unsigned long randomIndex = this->m_RandomGenerator->GetIntegerVariate(numberOfValidVoxels - 1);
+    this->m_RandomNumberList.push_back(randomIndex);
   }
 
+  /** Allocate the output sample container, which is filled in-place. */
+  ImageSampleContainerPointer sampleContainer = this->GetOutput();
+  sampleContainer->Initialize();
+  sampleContainer->Reserve(this->GetNumberOfSamples());
+
   /** If desired we exercise a multi-threaded version. */
   if (this->m_UseMultiThread)
   {
@@ -100,16 +89,7 @@ ImageRandomSamplerSparseMask<TInputImage>::GenerateData(void)
     return Superclass::GenerateData();
   }
 
-  /** Get a handle to the full sampler output. */
-  typename ImageSampleContainerType::Pointer allValidSamples = this->m_InternalFullSampler->GetOutput();
-  unsigned long                              numberOfValidSamples = allValidSamples->Size();
-
-  /** Take random samples from the allValidSamples-container. */
-  for (unsigned int i = 0; i < this->GetNumberOfSamples(); ++i)
-  {
-    unsigned long randomIndex = this->m_RandomGenerator->GetIntegerVariate(numberOfValidSamples - 1);
-    sampleContainer->push_back(allValidSamples->ElementAt(randomIndex));
-  }
+  this->GenerateSamplesForRange(0, this->GetNumberOfSamples());
 
 } // end GenerateData()
 
@@ -122,67 +102,125 @@ template <class TInputImage>
 void
 ImageRandomSamplerSparseMask<TInputImage>::BeforeThreadedGenerateData(void)
 {
-  /** Clear the random number list. */
-  this->m_RandomNumberList.resize(0);
-  this->m_RandomNumberList.reserve(this->m_NumberOfSamples);
+  /** The random numbers are already drawn in GenerateData(). Here we only
+   * determine over how many threads the samples are divided. This equals the
+   * number of pieces in which the input region can be split, since the
+   * ThreaderCallback() skips the threads that do not get a piece.
+   */
+  InputImageRegionType dummyRegion;
+  this->m_NumberOfSampleChunks = this->SplitRequestedRegion(0, this->GetNumberOfWorkUnits(), dummyRegion);
 
-  /** Get a handle to the full sampler output size. */
-  const unsigned long numberOfValidSamples = this->m_InternalFullSampler->GetOutput()->Size();
+} // end BeforeThreadedGenerateData()
 
-  /** Fill the list with random numbers. */
-  for (unsigned int i = 0; i < this->GetNumberOfSamples(); ++i)
-  {
-    unsigned long randomIndex = this->m_RandomGenerator->GetIntegerVariate(numberOfValidSamples - 1);
-    this->m_RandomNumberList.push_back(randomIndex);
-  }
 
-  /** Initialize variables needed for threads. */
-  this->m_ThreaderSampleContainer.clear();
-  this->m_ThreaderSampleContainer.resize(this->GetNumberOfWorkUnits());
-  for (std::size_t i = 0; i < this->GetNumberOfWorkUnits(); ++i)
+/**
+ * ******************* ThreadedGenerateData *******************
+ */
+
+template <class TInputImage>
+void
+ImageRandomSamplerSparseMask<TInputImage>::ThreadedGenerateData(const InputImageRegionType &, ThreadIdType threadId)
+{
+  if (threadId >= this->m_NumberOfSampleChunks)
   {
-    this->m_ThreaderSampleContainer[i] = ImageSampleContainerType::New();
+    return;
   }
 
-} // end BeforeThreadedGenerateData()
+  /** Figure out which samples to process. */
+  const unsigned long numberOfSamples = this->GetNumberOfSamples();
+  const unsigned long chunkSize = numberOfSamples / this->m_NumberOfSampleChunks;
+  const unsigned long sampleStart = threadId * chunkSize;
+  const unsigned long sampleEnd =
+    (threadId == this->m_NumberOfSampleChunks - 1) ? numberOfSamples : sampleStart + chunkSize;
+
+  this->GenerateSamplesForRange(sampleStart, sampleEnd);
+
+} // end ThreadedGenerateData()
 
 
 /**
- * ******************* ThreadedGenerateData *******************
+ * ******************* UpdateValidVoxelOffsets *******************
  */
 
 template <class TInputImage>
 void
-ImageRandomSamplerSparseMask<TInputImage>::ThreadedGenerateData(const InputImageRegionType &, ThreadIdType threadId)
+ImageRandomSamplerSparseMask<TInputImage>::UpdateValidVoxelOffsets(void)
 {
-  /** Get a handle to the full sampler output. */
-  typename ImageSampleContainerType::Pointer allValidSamples = this->m_InternalFullSampler->GetOutput();
+  /** Get handles to the input image and the mask. */
+  InputImageConstPointer          inputImage = this->GetInput();
+  typename MaskType::ConstPointer mask = this->GetMask();
+  if (mask->GetSource())
+  {
+    mask->GetSource()->Update();
+  }
 
-  /** Figure out which samples to process. */
-  unsigned long chunkSize = this->GetNumberOfSamples() / this->GetNumberOfWorkUnits();
-  unsigned long sampleStart = threadId * chunkSize;
-  if (threadId == this->GetNumberOfWorkUnits() - 1)
+  const InputImageRegionType & region = this->GetCroppedInputImageRegion();
+  const InputImageRegionType & bufferedRegion = inputImage->GetBufferedRegion();
+
+  /** Check if the cached list is still valid. */
+  const ModifiedTimeType listMTime = this->m_ValidVoxelOffsetsMTime.GetMTime();
+  if (inputImage.GetPointer() == this->m_ValidVoxelOffsetsInputImage &&
+      mask.GetPointer() == this->m_ValidVoxelOffsetsMask && region == this->m_ValidVoxelOffsetsRegion &&
+      bufferedRegion == this->m_ValidVoxelOffsetsBufferedRegion && inputImage->GetMTime() < listMTime &&
+      inputImage->GetUpdateMTime() < listMTime && mask->GetMTime() < listMTime)
+  {
+    return;
+  }
+
+  /** Loop over the image and store the offsets of the voxels inside the mask. */
+  this->m_ValidVoxelOffsets.clear();
+  typedef ImageRegionConstIteratorWithIndex<InputImageType> InputImageIterator;
+  InputImageIterator                                        iter(inputImage, region);
+  InputImagePointType                                       point;
+  for (iter.GoToBegin(); !iter.IsAtEnd(); ++iter)
   {
-    chunkSize = this->GetNumberOfSamples() - ((this->GetNumberOfWorkUnits() - 1) * chunkSize);
+    /** Get sampled index. */
+    const InputImageIndexType index = iter.GetIndex();
+
+    /** Translate index to point. */
+    inputImage->TransformIndexToPhysicalPoint(index, point);
+
+    if (mask->IsInsideInWorldSpace(point))
+    {
+      this->m_ValidVoxelOffsets.push_back(inputImage->ComputeOffset(index));
+    }
   }
 
-  /** Get a reference to the output and reserve memory for it. */
-  ImageSampleContainerPointer & sampleContainerThisThread = this->m_ThreaderSampleContainer[threadId];
-  sampleContainerThisThread->Reserve(chunkSize);
+  /** Remember for which state the list was computed. */
+  this->m_ValidVoxelOffsetsInputImage = inputImage.GetPointer();
+  this->m_ValidVoxelOffsetsMask = mask.GetPointer();
+  this->m_ValidVoxelOffsetsRegion = region;
+  this->m_ValidVoxelOffsetsBufferedRegion = bufferedRegion;
+  this->m_ValidVoxelOffsetsMTime.Modified();
+
+} // end UpdateValidVoxelOffsets()
+
+
+/**
+ * ******************* GenerateSamplesForRange *******************
+ */
 
-  /** Setup an iterator over the sampleContainerThisThread. */
-  typename ImageSampleContainerType::Iterator      iter;
-  typename ImageSampleContainerType::ConstIterator end = sampleContainerThisThread->End();
+template <class TInputImage>
+void
+ImageRandomSamplerSparseMask<TInputImage>::GenerateSamplesForRange(const unsigned long begin, const unsigned long end)
+{
+  /** Get handles to the input image buffer and the output. */
+  InputImageConstPointer      inputImage = this->GetInput();
+  const InputImagePixelType * inputBuffer = inputImage->GetBufferPointer();
+  ImageSampleContainerType &  samples = *(this->GetOutput());
 
-  /** Take random samples from the allValidSamples-container. */
-  unsigned long sampleId = sampleStart;
-  for (iter = sampleContainerThisThread->Begin(); iter != end; ++iter, sampleId++)
+  /** Convert the selected voxels to samples. */
+  for (unsigned long sampleId = begin; sampleId < end; ++sampleId)
   {
-    unsigned long randomIndex = static_cast<unsigned long>(this->m_RandomNumberList[sampleId]);
-    (*iter).Value() = allValidSamples->ElementAt(randomIndex);
+    const auto                      randomIndex = static_cast<std::size_t>(this->m_RandomNumberList[sampleId]);
+    const InputImageOffsetValueType offset = this->m_ValidVoxelOffsets[randomIndex];
+    ImageSampleType &               sample = samples[sampleId];
+
+    inputImage->TransformIndexToPhysicalPoint(inputImage->ComputeIndex(offset), sample.m_ImageCoordinates);
+    sample.m_ImageValue = inputBuffer[offset];
   }
 
-} // end ThreadedGenerateData()
+} // end GenerateSamplesForRange()
 
 
 /**
@@ -195,7 +233,7 @@ ImageRandomSamplerSparseMask<TInputImage>::PrintSelf(std::ostream & os, Indent i
 {
   Superclass::PrintSelf(os, indent);
 
-  os << indent << "InternalFullSampler: " << this->m_InternalFullSampler.GetPointer() << std::endl;
+  os << indent << "NumberOfValidVoxels: " << this->m_ValidVoxelOffsets.size() << std::endl;
   os << indent << "RandomGenerator: " << this->m_RandomGenerator.GetPointer() << std::endl;
 
 } // end PrintSelf()
@@ -19,6 +19,7 @@
 #define itkImageSample_h
 
 #include "itkNumericTraits.h"
+#include "itkPoint.h"
 
 namespace itk
 {
@@ -28,6 +29,10 @@ namespace itk
  * \brief A class that defines an image sample, which is
  * the coordinates of a point and its value.
  *
+ * When elastix is built with ELASTIX_USE_SINGLE_PRECISION, the coordinates
+ * and the value are stored in single precision. This halves the memory of
+ * the sample containers and the memory traffic of each metric evaluation.
+ * The users of the samples convert them to double when they read them.
  */
 
 template <class TImage>
@@ -39,10 +44,15 @@ public:
   ~ImageSample() = default;
 
   /** Typedef's. */
-  typedef TImage                                      ImageType;
+  typedef TImage                        ImageType;
+  typedef typename ImageType::PixelType PixelType;
+#ifdef ELASTIX_USE_SINGLE_PRECISION
+  typedef Point<float, ImageType::ImageDimension> PointType;
+  typedef float                                   RealType;
+#else
   typedef typename ImageType::PointType               PointType;
-  typedef typename ImageType::PixelType               PixelType;
   typedef typename NumericTraits<PixelType>::RealType RealType;
+#endif
 
   /** Member variables. */
   PointType m_ImageCoordinates;
@@ -77,6 +77,7 @@ public:
   typedef typename InputImageType::IndexType                InputImageIndexType;
   typedef typename InputImageType::PointType                InputImagePointType;
   typedef typename InputImagePointType::ValueType           InputImagePointValueType;
+  typedef typename ImageSampleType::PointType               ImageSamplePointType;
   typedef typename ImageSampleType::RealType                ImageSampleValueType;
   typedef SpatialObject<Self::InputImageDimension>          MaskType;
   typedef typename MaskType::Pointer                        MaskPointer;
@@ -179,6 +180,22 @@ public:
   /** \todo: Temporary, should think about interface. */
   itkSetMacro(UseMultiThread, bool);
 
+  /** Set/Get whether the samples are sorted in Morton (Z-)order of their voxel
+   * index after each update. Consecutive samples are then spatially close, so
+   * that they share B-spline coefficients and moving image cache lines, and the
+   * contiguous blocks of samples of the metric threads are spatially coherent.
+   * Default: false.
+   */
+  itkSetMacro(UseMortonOrder, bool);
+  itkGetConstMacro(UseMortonOrder, bool);
+  itkBooleanMacro(UseMortonOrder);
+
+  /** Sorts the current output samples in Morton order of their voxel index.
+   * Called automatically after each update when UseMortonOrder is set.
+   */
+  void
+  SortSamplesInMortonOrder(void);
+
 protected:
   /** The constructor. */
   ImageSamplerBase();
@@ -194,6 +211,10 @@ protected:
   void
   GenerateInputRequestedRegion(void) override;
 
+  /** Generates the samples, and sorts them when UseMortonOrder is set. */
+  void
+  UpdateOutputData(DataObject * output) override;
+
   /** IsInsideAllMasks. */
   virtual bool
   IsInsideAllMasks(const InputImagePointType & point) const;
@@ -243,6 +264,8 @@ private:
 
   InputImageRegionType m_CroppedInputImageRegion;
   InputImageRegionType m_DummyInputImageRegion;
+
+  bool m_UseMortonOrder{ false };
 };
 
 } // end namespace itk
@@ -20,6 +20,10 @@
 
 #include "itkImageSamplerBase.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
 namespace itk
 {
 
@@ -437,6 +441,89 @@ ImageSamplerBase<TInputImage>::AfterThreadedGenerateData(void)
 } // end AfterThreadedGenerateData()
 
 
+/**
+ * ******************* UpdateOutputData *******************
+ */
+
+template <class TInputImage>
+void
+ImageSamplerBase<TInputImage>::UpdateOutputData(DataObject * output)
+{
+  /** Generate the samples. */
+  Superclass::UpdateOutputData(output);
+
+  /** Sort them spatially, when requested. */
+  if (this->m_UseMortonOrder)
+  {
+    this->SortSamplesInMortonOrder();
+  }
+
+} // end UpdateOutputData()
+
+
+/**
+ * ******************* SortSamplesInMortonOrder *******************
+ */
+
+template <class TInputImage>
+void
+ImageSamplerBase<TInputImage>::SortSamplesInMortonOrder(void)
+{
+  ImageSampleContainerType & samples = *this->GetOutput();
+  const std::size_t          numberOfSamples = samples.size();
+  if (numberOfSamples < 2)
+  {
+    return;
+  }
+
+  /** The Morton code interleaves the bits of the voxel index, relative to the
+   * start of the largest possible region, into a 64 bit code.
+   */
+  const unsigned int        bitsPerDimension = 64 / InputImageDimension;
+  const std::uint64_t       maximumCoordinate = (std::uint64_t{ 1 } << bitsPerDimension) - 1;
+  const InputImageType *    inputImage = this->GetInput();
+  const InputImageIndexType startIndex = inputImage->GetLargestPossibleRegion().GetIndex();
+
+  typedef std::pair<std::uint64_t, std::size_t> CodeAndIndexType;
+  std::vector<CodeAndIndexType>                 codes(numberOfSamples);
+  for (std::size_t i = 0; i < numberOfSamples; ++i)
+  {
+    ContinuousIndex<InputImagePointValueType, InputImageDimension> cindex;
+    inputImage->TransformPhysicalPointToContinuousIndex(samples[i].m_ImageCoordinates, cindex);
+
+    std::uint64_t coordinates[InputImageDimension];
+    for (unsigned int d = 0; d < InputImageDimension; ++d)
+    {
+      const double relativeIndex = std::max(0.0, Math::Round<double>(cindex[d]) - static_cast<double>(startIndex[d]));
+      coordinates[d] = std::min(static_cast<std::uint64_t>(relativeIndex), maximumCoordinate);
+    }
+
+    std::uint64_t code = 0;
+    for (unsigned int bit = 0; bit < bitsPerDimension; ++bit)
+    {
+      for (unsigned int d = 0; d < InputImageDimension; ++d)
+      {
+        code |= ((coordinates[d] >> bit) & 1) << (bit * InputImageDimension + d);
+      }
+    }
+    codes[i] = CodeAndIndexType(code, i);
+  }
+
+  /** Sort the codes, and reorder the samples accordingly. Equal codes keep their
+   * original order, so that the result is deterministic.
+   */
+  std::sort(codes.begin(), codes.end());
+  std::vector<ImageSampleType> sortedSamples;
+  sortedSamples.reserve(numberOfSamples);
+  for (const auto & codeAndIndex : codes)
+  {
+    sortedSamples.push_back(samples[codeAndIndex.second]);
+  }
+  std::copy(sortedSamples.begin(), sortedSamples.end(), samples.begin());
+
+} // end SortSamplesInMortonOrder()
+
+
 /**
  * ******************* PrintSelf *******************
  */
@@ -463,6 +550,7 @@ ImageSamplerBase<TInputImage>::PrintSelf(std::ostream & os, Indent indent) const
     os << indent.GetNextIndent() << this->m_InputImageRegionVector[i] << std::endl;
   }
   os << indent << "CroppedInputImageRegion" << this->m_CroppedInputImageRegion << std::endl;
+  os << indent << "UseMortonOrder: " << this->m_UseMortonOrder << std::endl;
 
 } // end PrintSelf()
 
@@ -90,7 +90,7 @@ MultiInputImageRandomCoordinateSampler<TInputImage>::GenerateData(void)
     for (iter = sampleContainer->Begin(); iter != end; ++iter)
     {
       /** Make a reference to the current sample in the container. */
-      InputImagePointType &  samplePoint = (*iter).Value().m_ImageCoordinates;
+      ImageSamplePointType & samplePoint = (*iter).Value().m_ImageCoordinates;
       ImageSampleValueType & sampleValue = (*iter).Value().m_ImageValue;
 
       /** Generate a point in the input image region. */
@@ -119,7 +119,7 @@ MultiInputImageRandomCoordinateSampler<TInputImage>::GenerateData(void)
     for (iter = sampleContainer->Begin(); iter != end; ++iter)
     {
       /** Make a reference to the current sample in the container. */
-      InputImagePointType &  samplePoint = (*iter).Value().m_ImageCoordinates;
+      ImageSamplePointType & samplePoint = (*iter).Value().m_ImageCoordinates;
       ImageSampleValueType & sampleValue = (*iter).Value().m_ImageValue;
 
       /** Walk over the image until we find a valid point. */
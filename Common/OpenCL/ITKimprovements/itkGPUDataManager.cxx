@@ -245,6 +245,36 @@ GPUDataManager::UpdateGPUBuffer()
 }
 
 
+//------------------------------------------------------------------------------
+OpenCLEvent
+GPUDataManager::UpdateGPUBufferAsync(const OpenCLCommandQueue & queue)
+{
+  if (this->m_GPUBufferLock)
+  {
+    return OpenCLEvent();
+  }
+
+  MutexHolderType holder(m_Mutex);
+
+  if (m_IsGPUBufferDirty && m_CPUBuffer != nullptr && m_GPUBuffer != nullptr)
+  {
+#if (defined(_WIN32) && defined(_DEBUG)) || !defined(NDEBUG)
+    std::cout << "clEnqueueWriteBuffer, " << this << "::UpdateGPUBufferAsync CPU->GPU data copy " << m_CPUBuffer
+              << "->" << m_GPUBuffer << std::endl;
+#endif
+
+    cl_event     clEvent = nullptr;
+    const cl_int errid = clEnqueueWriteBuffer(
+      queue.GetQueueId(), m_GPUBuffer, CL_FALSE, 0, m_BufferSize, m_CPUBuffer, 0, nullptr, &clEvent);
+    m_Context->ReportError(errid, __FILE__, __LINE__, ITK_LOCATION);
+
+    m_IsGPUBufferDirty = false;
+    return OpenCLEvent(clEvent);
+  }
+  return OpenCLEvent();
+}
+
+
 //------------------------------------------------------------------------------
 cl_mem *
 GPUDataManager::GetGPUBufferPointer()
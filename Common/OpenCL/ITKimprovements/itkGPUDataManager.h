@@ -134,6 +134,12 @@ public:
   virtual void
   UpdateGPUBuffer();
 
+  /** Non-blocking version of UpdateGPUBuffer(), which enqueues the CPU->GPU memory
+   * copy on the given command queue, and returns its event. The CPU buffer must stay
+   * valid until the event has finished. Returns a null event when nothing is copied. */
+  OpenCLEvent
+  UpdateGPUBufferAsync(const OpenCLCommandQueue & queue);
+
   void
   Allocate();
 
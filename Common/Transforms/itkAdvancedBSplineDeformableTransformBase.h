@@ -22,6 +22,8 @@
 #include "itkImage.h"
 #include "itkImageRegion.h"
 
+#include <vector>
+
 namespace itk
 {
 
@@ -184,6 +186,15 @@ public:
   virtual void
   SetCoefficientImages(ImagePointer images[]);
 
+  /** Set/Get whether subclasses that support it evaluate the transform on a
+   * copy of the coefficients that is interleaved per control point. The copy
+   * takes as much memory as the coefficients themselves, so it is off by default.
+   */
+  virtual void
+  SetUseInterleavedCoefficients(bool _arg);
+  itkGetConstMacro(UseInterleavedCoefficients, bool);
+  itkBooleanMacro(UseInterleavedCoefficients);
+
   /** Typedefs for specifying the extend to the grid. */
   typedef ImageRegion<Self::SpaceDimension> RegionType;
 
@@ -306,6 +317,17 @@ protected:
   void
   WrapAsImages(void);
 
+  /** Copy the coefficients to the interleaved coefficient buffer. */
+  void
+  UpdateInterleavedCoefficients(void);
+
+  /** Check that the interleaved coefficient buffer is a copy of the current
+   * coefficient images: the grid region, the image buffers and their
+   * modification times must still be the ones it was copied from.
+   */
+  bool
+  InterleavedCoefficientsAreUpToDate(void) const;
+
   /** Convert an input point to a continuous index inside the B-spline grid. */
   void
   TransformPointToContinuousGridIndex(const InputPointType & point, ContinuousIndexType & index) const;
@@ -373,6 +395,24 @@ protected:
   /** Internal parameters buffer. */
   ParametersType m_InternalParametersBuffer;
 
+  /** The B-spline coefficients interleaved per control point, so ordered as
+   * [ c_0[0], ..., c_0[SpaceDimension-1], c_1[0], ... ], together with the grid
+   * offset table of this layout. The evaluation of a point then reads the
+   * coefficients of all dimensions of a control point from contiguous memory.
+   * The buffer is a copy, made by SetParameters(), SetParametersByValue(),
+   * SetIdentity() and SetCoefficientImages(). The grid region, buffer pointers
+   * and modification times of the coefficient images it was copied from are
+   * stored with it, so that a stale copy is never used. Coefficients that are
+   * changed in place without calling Modified() on the coefficient images, or
+   * SetParameters() again, cannot be detected.
+   */
+  bool                   m_UseInterleavedCoefficients{ false };
+  std::vector<PixelType> m_InterleavedCoefficients;
+  GridOffsetType         m_InterleavedGridOffsetTable;
+  RegionType             m_InterleavedGridRegion;
+  const PixelType *      m_InterleavedSourcePointers[NDimensions];
+  ModifiedTimeType       m_InterleavedSourceMTimes[NDimensions];
+
   void
   UpdateGridOffsetTable(void);
 
@@ -43,6 +43,12 @@ AdvancedBSplineDeformableTransformBase<TScalarType, NDimensions>::AdvancedBSplin
   this->m_GridSpacing.Fill(1.0);       // default spacing is all ones
   this->m_GridDirection.SetIdentity(); // default spacing is all ones
   this->m_GridOffsetTable.Fill(0);
+  this->m_InterleavedGridOffsetTable.Fill(0);
+  for (unsigned int j = 0; j < SpaceDimension; ++j)
+  {
+    this->m_InterleavedSourcePointers[j] = nullptr;
+    this->m_InterleavedSourceMTimes[j] = 0;
+  }
 
   this->m_InternalParametersBuffer = ParametersType(0);
   // Make sure the parameters pointer is not NULL after construction.
@@ -177,6 +183,12 @@ AdvancedBSplineDeformableTransformBase<TScalarType, NDimensions>::UpdateGridOffs
     this->m_GridOffsetTable[j] = this->m_GridOffsetTable[j - 1] * gridSize[j - 1];
   }
 
+  /** The interleaved coefficients have SpaceDimension values per control point. */
+  for (unsigned int j = 0; j < SpaceDimension; ++j)
+  {
+    this->m_InterleavedGridOffsetTable[j] = this->m_GridOffsetTable[j] * SpaceDimension;
+  }
+
 } // end UpdateGridOffsetTable()
 
 
@@ -253,6 +265,7 @@ AdvancedBSplineDeformableTransformBase<TScalarType, NDimensions>::SetIdentity()
   {
     ParametersType * parameters = const_cast<ParametersType *>(this->m_InputParametersPointer);
     parameters->Fill(0.0);
+    this->UpdateInterleavedCoefficients();
     this->Modified();
   }
   else
@@ -285,6 +298,7 @@ AdvancedBSplineDeformableTransformBase<TScalarType, NDimensions>::SetParameters(
 
   // Wrap flat array as images of coefficients
   this->WrapAsImages();
+  this->UpdateInterleavedCoefficients();
 
   // Modified is always called since we just have a pointer to the
   // parameters and cannot know if the parameters have changed.
@@ -401,6 +415,79 @@ AdvancedBSplineDeformableTransformBase<TScalarType, NDimensions>::WrapAsImages(v
 }
 
 
+// Copy the coefficients to the interleaved buffer
+template <class TScalarType, unsigned int NDimensions>
+void
+AdvancedBSplineDeformableTransformBase<TScalarType, NDimensions>::UpdateInterleavedCoefficients(void)
+{
+  /** Without coefficients, or when not used, the buffer is released. */
+  if (!this->m_UseInterleavedCoefficients || !this->m_CoefficientImages[0])
+  {
+    std::vector<PixelType>().swap(this->m_InterleavedCoefficients);
+    return;
+  }
+
+  /** Copy the SpaceDimension coefficients of each control point next to each other,
+   * and remember which coefficients were copied.
+   */
+  const std::size_t numberOfPixels = this->m_GridRegion.GetNumberOfPixels();
+  this->m_InterleavedCoefficients.resize(numberOfPixels * SpaceDimension);
+  this->m_InterleavedGridRegion = this->m_GridRegion;
+  for (unsigned int j = 0; j < SpaceDimension; ++j)
+  {
+    const PixelType * coefficients = this->m_CoefficientImages[j]->GetBufferPointer();
+    PixelType *       interleaved = this->m_InterleavedCoefficients.data() + j;
+    for (std::size_t i = 0; i < numberOfPixels; ++i)
+    {
+      interleaved[i * SpaceDimension] = coefficients[i];
+    }
+    this->m_InterleavedSourcePointers[j] = coefficients;
+    this->m_InterleavedSourceMTimes[j] = this->m_CoefficientImages[j]->GetMTime();
+  }
+
+} // end UpdateInterleavedCoefficients()
+
+
+// Check whether the interleaved buffer is a copy of the current coefficients
+template <class TScalarType, unsigned int NDimensions>
+bool
+AdvancedBSplineDeformableTransformBase<TScalarType, NDimensions>::InterleavedCoefficientsAreUpToDate(void) const
+{
+  if (!this->m_UseInterleavedCoefficients || this->m_InterleavedCoefficients.empty() ||
+      this->m_InterleavedGridRegion != this->m_GridRegion ||
+      this->m_InterleavedCoefficients.size() != this->m_GridRegion.GetNumberOfPixels() * SpaceDimension)
+  {
+    return false;
+  }
+
+  for (unsigned int j = 0; j < SpaceDimension; ++j)
+  {
+    const ImageType * image = this->m_CoefficientImages[j].GetPointer();
+    if (image == nullptr || image->GetBufferPointer() != this->m_InterleavedSourcePointers[j] ||
+        image->GetMTime() != this->m_InterleavedSourceMTimes[j])
+    {
+      return false;
+    }
+  }
+  return true;
+
+} // end InterleavedCoefficientsAreUpToDate()
+
+
+// Set whether the interleaved coefficient buffer is used
+template <class TScalarType, unsigned int NDimensions>
+void
+AdvancedBSplineDeformableTransformBase<TScalarType, NDimensions>::SetUseInterleavedCoefficients(const bool _arg)
+{
+  if (this->m_UseInterleavedCoefficients != _arg)
+  {
+    this->m_UseInterleavedCoefficients = _arg;
+    this->UpdateInterleavedCoefficients();
+    this->Modified();
+  }
+}
+
+
 // Set the parameters by value
 template <class TScalarType, unsigned int NDimensions>
 void
@@ -421,6 +508,7 @@ AdvancedBSplineDeformableTransformBase<TScalarType, NDimensions>::SetParametersB
 
   // wrap flat array as images of coefficients
   this->WrapAsImages();
+  this->UpdateInterleavedCoefficients();
 
   // Modified is always called since we just have a pointer to the
   // parameters and cannot know if the parameters have changed.
@@ -497,6 +585,8 @@ AdvancedBSplineDeformableTransformBase<TScalarType, NDimensions>::SetCoefficient
     // Clean up buffered parameters
     this->m_InternalParametersBuffer = ParametersType(0);
     this->m_InputParametersPointer = nullptr;
+
+    this->UpdateInterleavedCoefficients();
   }
 }
 
@@ -534,6 +624,10 @@ AdvancedBSplineDeformableTransformBase<TScalarType, NDimensions>::PrintSelf(std:
   os << " ]" << std::endl;
 
   os << indent << "InputParametersPointer: " << this->m_InputParametersPointer << std::endl;
+  os << indent << "UseInterleavedCoefficients: " << this->m_UseInterleavedCoefficients << std::endl;
+  os << indent << "InterleavedCoefficients: " << this->m_InterleavedCoefficients.size() << " values" << std::endl;
+  os << indent << "InterleavedGridOffsetTable: " << this->m_InterleavedGridOffsetTable << std::endl;
+  os << indent << "InterleavedGridRegion: " << this->m_InterleavedGridRegion << std::endl;
   os << indent << "ValidRegion: " << this->m_ValidRegion << std::endl;
   os << indent << "LastJacobianIndex: " << this->m_LastJacobianIndex << std::endl;
 }
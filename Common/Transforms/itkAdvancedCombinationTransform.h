@@ -49,6 +49,13 @@ namespace itk
  * Note: It is mandatory to set a current transform. An initial transform
  * is not mandatory.
  *
+ * When composition is used and the initial transform is linear, for example
+ * an affine transform, possibly itself composed of other linear transforms,
+ * the initial transform is stored as a matrix \f$A\f$ and an offset \f$b\f$,
+ * so that \f$T(x) = T_1( A x + b )\f$ is evaluated without calls to the initial
+ * transform. The matrix and offset are refreshed by UpdateCombinationMethod(),
+ * and each time the parameters are set.
+ *
  * \ingroup Transforms
  */
 
@@ -328,6 +335,10 @@ protected:
   inline OutputPointType
   TransformPointUseComposition(const InputPointType & point) const;
 
+  /** COMPOSITION with a linear initial transform: \f$T(x) = T_1( A x + b )\f$ */
+  inline OutputPointType
+  TransformPointUseLinearComposition(const InputPointType & point) const;
+
   /** CURRENT ONLY: \f$T(x) = T_1(x)\f$ */
   inline OutputPointType
   TransformPointNoInitialTransform(const InputPointType & point) const;
@@ -350,6 +361,10 @@ protected:
   inline void
   GetJacobianUseComposition(const InputPointType &, JacobianType &, NonZeroJacobianIndicesType &) const;
 
+  /** COMPOSITION with a linear initial transform: \f$J(x) = J_1( A x + b )\f$ */
+  inline void
+  GetJacobianUseLinearComposition(const InputPointType &, JacobianType &, NonZeroJacobianIndicesType &) const;
+
   /** CURRENT ONLY: \f$J(x) = J_1(x)\f$ */
   inline void
   GetJacobianNoInitialTransform(const InputPointType &, JacobianType &, NonZeroJacobianIndicesType &) const;
@@ -378,6 +393,13 @@ protected:
                                                          DerivativeType &,
                                                          NonZeroJacobianIndicesType &) const;
 
+  /** COMPOSITION with a linear initial transform: \f$J(x) = J_1( A x + b )\f$ */
+  inline void
+  EvaluateJacobianWithImageGradientProductUseLinearComposition(const InputPointType &,
+                                                               const MovingImageGradientType &,
+                                                               DerivativeType &,
+                                                               NonZeroJacobianIndicesType &) const;
+
   /** CURRENT ONLY: \f$J(x) = J_1(x)\f$ */
   inline void
   EvaluateJacobianWithImageGradientProductNoInitialTransform(const InputPointType &,
@@ -406,6 +428,10 @@ protected:
   inline void
   GetSpatialJacobianUseComposition(const InputPointType & ipp, SpatialJacobianType & sj) const;
 
+  /** COMPOSITION with a linear initial transform: \f$J(x) = J_1( A x + b ) A\f$ */
+  inline void
+  GetSpatialJacobianUseLinearComposition(const InputPointType & ipp, SpatialJacobianType & sj) const;
+
   /** CURRENT ONLY: \f$J(x) = J_1(x)\f$ */
   inline void
   GetSpatialJacobianNoInitialTransform(const InputPointType & ipp, SpatialJacobianType & sj) const;
@@ -466,6 +492,18 @@ protected:
                                              JacobianOfSpatialJacobianType & jsj,
                                              NonZeroJacobianIndicesType &    nonZeroJacobianIndices) const;
 
+  /** COMPOSITION with a linear initial transform: \f$J(x) = J_1( A x + b ) A\f$ */
+  inline void
+  GetJacobianOfSpatialJacobianUseLinearComposition(const InputPointType &          ipp,
+                                                   JacobianOfSpatialJacobianType & jsj,
+                                                   NonZeroJacobianIndicesType &    nonZeroJacobianIndices) const;
+
+  inline void
+  GetJacobianOfSpatialJacobianUseLinearComposition(const InputPointType &          ipp,
+                                                   SpatialJacobianType &           sj,
+                                                   JacobianOfSpatialJacobianType & jsj,
+                                                   NonZeroJacobianIndicesType &    nonZeroJacobianIndices) const;
+
   /** CURRENT ONLY: \f$J(x) = J_1(x)\f$ */
   inline void
   GetJacobianOfSpatialJacobianNoInitialTransform(const InputPointType &          ipp,
@@ -548,10 +586,27 @@ private:
   /** Exception text. */
   constexpr static const char * NoCurrentTransformSet = "No current transform set in the AdvancedCombinationTransform";
 
+  /** Stores a linear initial transform as m_InitialTransformMatrix and
+   * m_InitialTransformOffset. Returns false when the initial transform is not
+   * linear, or cannot be evaluated yet.
+   */
+  bool
+  UpdateLinearInitialTransform(void);
+
+  /** Computes \f$A x + b\f$, the point transformed by the linear initial transform. */
+  inline InputPointType
+  TransformPointLinearInitialTransform(const InputPointType & point) const;
+
   /** Declaration of members. */
   InitialTransformPointer m_InitialTransform{ nullptr };
   CurrentTransformPointer m_CurrentTransform{ nullptr };
 
+  /** The matrix and offset of a linear initial transform, used by the
+   * UseLinearComposition functions.
+   */
+  SpatialJacobianType m_InitialTransformMatrix;
+  OutputVectorType    m_InitialTransformOffset;
+
   /** Typedefs for function pointers. */
   typedef OutputPointType (Self::*TransformPointFunctionPointer)(const InputPointType &) const;
   typedef void (Self::*GetSparseJacobianFunctionPointer)(const InputPointType &,
@@ -581,6 +636,7 @@ private:
   /**  A pointer to one of the following functions:
    * - TransformPointUseAddition,
    * - TransformPointUseComposition,
+   * - TransformPointUseLinearComposition,
    * - TransformPointNoCurrentTransform
    * - TransformPointNoInitialTransform.
    */
@@ -261,6 +261,11 @@ AdvancedCombinationTransform<TScalarType, NDimensions>::SetParameters(const Para
   {
     this->Modified();
     this->m_CurrentTransform->SetParameters(param);
+
+    /** The initial transform is assumed constant, but refresh its matrix
+     * and offset, in case it has been changed since it was set.
+     */
+    this->UpdateCombinationMethod();
   }
   else
   {
@@ -284,6 +289,11 @@ AdvancedCombinationTransform<TScalarType, NDimensions>::SetFixedParameters(const
   {
     this->Modified();
     this->m_CurrentTransform->SetFixedParameters(param);
+
+    /** The initial transform is assumed constant, but refresh its matrix
+     * and offset, in case it has been changed since it was set.
+     */
+    this->UpdateCombinationMethod();
   }
   else
   {
@@ -307,6 +317,11 @@ AdvancedCombinationTransform<TScalarType, NDimensions>::SetParametersByValue(con
   {
     this->Modified();
     this->m_CurrentTransform->SetParametersByValue(param);
+
+    /** The initial transform is assumed constant, but refresh its matrix
+     * and offset, in case it has been changed since it was set.
+     */
+    this->UpdateCombinationMethod();
   }
   else
   {
@@ -595,6 +610,19 @@ AdvancedCombinationTransform<TScalarType, NDimensions>::UpdateCombinationMethod(
     this->m_SelectedGetJacobianOfSpatialHessianFunction = &Self::GetJacobianOfSpatialHessianUseAddition;
     this->m_SelectedGetJacobianOfSpatialHessianFunction2 = &Self::GetJacobianOfSpatialHessianUseAddition;
   }
+  else if (this->UpdateLinearInitialTransform())
+  {
+    this->m_SelectedTransformPointFunction = &Self::TransformPointUseLinearComposition;
+    this->m_SelectedGetSparseJacobianFunction = &Self::GetJacobianUseLinearComposition;
+    this->m_SelectedEvaluateJacobianWithImageGradientProductFunction =
+      &Self::EvaluateJacobianWithImageGradientProductUseLinearComposition;
+    this->m_SelectedGetSpatialJacobianFunction = &Self::GetSpatialJacobianUseLinearComposition;
+    this->m_SelectedGetSpatialHessianFunction = &Self::GetSpatialHessianUseComposition;
+    this->m_SelectedGetJacobianOfSpatialJacobianFunction = &Self::GetJacobianOfSpatialJacobianUseLinearComposition;
+    this->m_SelectedGetJacobianOfSpatialJacobianFunction2 = &Self::GetJacobianOfSpatialJacobianUseLinearComposition;
+    this->m_SelectedGetJacobianOfSpatialHessianFunction = &Self::GetJacobianOfSpatialHessianUseComposition;
+    this->m_SelectedGetJacobianOfSpatialHessianFunction2 = &Self::GetJacobianOfSpatialHessianUseComposition;
+  }
   else
   {
     this->m_SelectedTransformPointFunction = &Self::TransformPointUseComposition;
@@ -614,6 +642,64 @@ AdvancedCombinationTransform<TScalarType, NDimensions>::UpdateCombinationMethod(
 } // end UpdateCombinationMethod()
 
 
+/**
+ * ****************** UpdateLinearInitialTransform ********************
+ */
+
+template <typename TScalarType, unsigned int NDimensions>
+bool
+AdvancedCombinationTransform<TScalarType, NDimensions>::UpdateLinearInitialTransform(void)
+{
+  if (this->m_InitialTransform.IsNull() || !this->m_InitialTransform->IsLinear())
+  {
+    return false;
+  }
+
+  /** A linear transform is T0(x) = A x + b, with A its (constant) spatial
+   * Jacobian and b the transformed origin. An initial combination transform
+   * without a current transform can not be evaluated yet.
+   */
+  InputPointType origin;
+  origin.Fill(0.0);
+  try
+  {
+    this->m_InitialTransform->GetSpatialJacobian(origin, this->m_InitialTransformMatrix);
+    this->m_InitialTransformOffset = this->m_InitialTransform->TransformPoint(origin) - origin;
+  }
+  catch (const ExceptionObject &)
+  {
+    return false;
+  }
+
+  return true;
+
+} // end UpdateLinearInitialTransform()
+
+
+/**
+ * ****************** TransformPointLinearInitialTransform ********************
+ */
+
+template <typename TScalarType, unsigned int NDimensions>
+auto
+AdvancedCombinationTransform<TScalarType, NDimensions>::TransformPointLinearInitialTransform(
+  const InputPointType & point) const -> InputPointType
+{
+  /** Compute A x + b inline, instead of calling the initial transform. */
+  InputPointType initialPoint;
+  for (unsigned int i = 0; i < SpaceDimension; ++i)
+  {
+    initialPoint[i] = this->m_InitialTransformOffset[i];
+    for (unsigned int j = 0; j < SpaceDimension; ++j)
+    {
+      initialPoint[i] += this->m_InitialTransformMatrix(i, j) * point[j];
+    }
+  }
+  return initialPoint;
+
+} // end TransformPointLinearInitialTransform()
+
+
 /**
  *
  * ***********************************************************
@@ -675,6 +761,20 @@ AdvancedCombinationTransform<TScalarType, NDimensions>::TransformPointUseComposi
 } // end TransformPointUseComposition()
 
 
+/**
+ * **************** TransformPointUseLinearComposition *************
+ */
+
+template <typename TScalarType, unsigned int NDimensions>
+auto
+AdvancedCombinationTransform<TScalarType, NDimensions>::TransformPointUseLinearComposition(
+  const InputPointType & point) const -> OutputPointType
+{
+  return this->m_CurrentTransform->TransformPoint(this->TransformPointLinearInitialTransform(point));
+
+} // end TransformPointUseLinearComposition()
+
+
 /**
  * **************** TransformPointNoInitialTransform ******************
  */
@@ -736,6 +836,22 @@ AdvancedCombinationTransform<TScalarType, NDimensions>::GetJacobianUseCompositio
 } // end GetJacobianUseComposition()
 
 
+/**
+ * **************** GetJacobianUseLinearComposition *************
+ */
+
+template <typename TScalarType, unsigned int NDimensions>
+void
+AdvancedCombinationTransform<TScalarType, NDimensions>::GetJacobianUseLinearComposition(
+  const InputPointType &       ipp,
+  JacobianType &               j,
+  NonZeroJacobianIndicesType & nonZeroJacobianIndices) const
+{
+  this->m_CurrentTransform->GetJacobian(this->TransformPointLinearInitialTransform(ipp), j, nonZeroJacobianIndices);
+
+} // end GetJacobianUseLinearComposition()
+
+
 /**
  * **************** GetJacobianNoInitialTransform ******************
  */
@@ -805,6 +921,24 @@ AdvancedCombinationTransform<TScalarType, NDimensions>::EvaluateJacobianWithImag
 } // end EvaluateJacobianWithImageGradientProductUseComposition()
 
 
+/**
+ * **************** EvaluateJacobianWithImageGradientProductUseLinearComposition *************
+ */
+
+template <typename TScalarType, unsigned int NDimensions>
+void
+AdvancedCombinationTransform<TScalarType, NDimensions>::EvaluateJacobianWithImageGradientProductUseLinearComposition(
+  const InputPointType &          ipp,
+  const MovingImageGradientType & movingImageGradient,
+  DerivativeType &                imageJacobian,
+  NonZeroJacobianIndicesType &    nonZeroJacobianIndices) const
+{
+  this->m_CurrentTransform->EvaluateJacobianWithImageGradientProduct(
+    this->TransformPointLinearInitialTransform(ipp), movingImageGradient, imageJacobian, nonZeroJacobianIndices);
+
+} // end EvaluateJacobianWithImageGradientProductUseLinearComposition()
+
+
 /**
  * **************** EvaluateJacobianWithImageGradientProductNoInitialTransform ******************
  */
@@ -877,6 +1011,24 @@ AdvancedCombinationTransform<TScalarType, NDimensions>::GetSpatialJacobianUseCom
 } // end GetSpatialJacobianUseComposition()
 
 
+/**
+ * **************** GetSpatialJacobianUseLinearComposition *************
+ */
+
+template <typename TScalarType, unsigned int NDimensions>
+void
+AdvancedCombinationTransform<TScalarType, NDimensions>::GetSpatialJacobianUseLinearComposition(
+  const InputPointType & ipp,
+  SpatialJacobianType &  sj) const
+{
+  SpatialJacobianType sj1;
+  this->m_CurrentTransform->GetSpatialJacobian(this->TransformPointLinearInitialTransform(ipp), sj1);
+
+  sj = sj1 * this->m_InitialTransformMatrix;
+
+} // end GetSpatialJacobianUseLinearComposition()
+
+
 /**
  * **************** GetSpatialJacobianNoInitialTransform ******************
  */
@@ -1089,6 +1241,57 @@ AdvancedCombinationTransform<TScalarType, NDimensions>::GetJacobianOfSpatialJaco
 } // end GetJacobianOfSpatialJacobianUseComposition()
 
 
+/**
+ * ******** GetJacobianOfSpatialJacobianUseLinearComposition ******************
+ */
+
+template <typename TScalarType, unsigned int NDimensions>
+void
+AdvancedCombinationTransform<TScalarType, NDimensions>::GetJacobianOfSpatialJacobianUseLinearComposition(
+  const InputPointType &          ipp,
+  JacobianOfSpatialJacobianType & jsj,
+  NonZeroJacobianIndicesType &    nonZeroJacobianIndices) const
+{
+  JacobianOfSpatialJacobianType jsj1;
+  this->m_CurrentTransform->GetJacobianOfSpatialJacobian(
+    this->TransformPointLinearInitialTransform(ipp), jsj1, nonZeroJacobianIndices);
+
+  jsj.resize(nonZeroJacobianIndices.size());
+  for (unsigned int mu = 0; mu < nonZeroJacobianIndices.size(); ++mu)
+  {
+    jsj[mu] = jsj1[mu] * this->m_InitialTransformMatrix;
+  }
+
+} // end GetJacobianOfSpatialJacobianUseLinearComposition()
+
+
+/**
+ * ******** GetJacobianOfSpatialJacobianUseLinearComposition ******************
+ */
+
+template <typename TScalarType, unsigned int NDimensions>
+void
+AdvancedCombinationTransform<TScalarType, NDimensions>::GetJacobianOfSpatialJacobianUseLinearComposition(
+  const InputPointType &          ipp,
+  SpatialJacobianType &           sj,
+  JacobianOfSpatialJacobianType & jsj,
+  NonZeroJacobianIndicesType &    nonZeroJacobianIndices) const
+{
+  SpatialJacobianType           sj1;
+  JacobianOfSpatialJacobianType jsj1;
+  this->m_CurrentTransform->GetJacobianOfSpatialJacobian(
+    this->TransformPointLinearInitialTransform(ipp), sj1, jsj1, nonZeroJacobianIndices);
+
+  sj = sj1 * this->m_InitialTransformMatrix;
+  jsj.resize(nonZeroJacobianIndices.size());
+  for (unsigned int mu = 0; mu < nonZeroJacobianIndices.size(); ++mu)
+  {
+    jsj[mu] = jsj1[mu] * this->m_InitialTransformMatrix;
+  }
+
+} // end GetJacobianOfSpatialJacobianUseLinearComposition()
+
+
 /**
  * ******** GetJacobianOfSpatialJacobianNoInitialTransform ******************
  */
@@ -197,6 +197,14 @@ protected:
   ComputeNonZeroJacobianIndices(NonZeroJacobianIndicesType & nonZeroJacobianIndices,
                                 const RegionType &           supportRegion) const override;
 
+  /** Set mu to the coefficients of the first control point of the support region,
+   * in the interleaved coefficient buffer when UseInterleavedCoefficients is on
+   * and the buffer is up to date, and return the grid offset table that belongs
+   * to the chosen coefficient layout.
+   */
+  const OffsetValueType *
+  ComputeCoefficientPointers(const IndexType & supportIndex, ScalarType ** mu) const;
+
 private:
   RecursiveBSplineTransform(const Self &) = delete;
   void
@@ -41,6 +41,51 @@ RecursiveBSplineTransform<TScalar, NDimensions, VSplineOrder>::RecursiveBSplineT
 } // end Constructor()
 
 
+/**
+ * ********************* ComputeCoefficientPointers ****************************
+ */
+
+template <typename TScalar, unsigned int NDimensions, unsigned int VSplineOrder>
+auto
+RecursiveBSplineTransform<TScalar, NDimensions, VSplineOrder>::ComputeCoefficientPointers(
+  const IndexType & supportIndex,
+  ScalarType **     mu) const -> const OffsetValueType *
+{
+  /** Use the interleaved coefficients when they are a copy of the current coefficients. */
+  if (this->InterleavedCoefficientsAreUpToDate())
+  {
+    const OffsetValueType * offsetTable = this->m_InterleavedGridOffsetTable.GetIndex();
+    OffsetValueType         totalOffsetToSupportIndex = 0;
+    for (unsigned int j = 0; j < SpaceDimension; ++j)
+    {
+      totalOffsetToSupportIndex += supportIndex[j] * offsetTable[j];
+    }
+
+    ScalarType * basePointer = const_cast<ScalarType *>(this->m_InterleavedCoefficients.data());
+    for (unsigned int j = 0; j < SpaceDimension; ++j)
+    {
+      mu[j] = basePointer + totalOffsetToSupportIndex + j;
+    }
+    return offsetTable;
+  }
+
+  /** Otherwise use the coefficient image of each dimension. */
+  const OffsetValueType * offsetTable = this->m_CoefficientImages[0]->GetOffsetTable();
+  OffsetValueType         totalOffsetToSupportIndex = 0;
+  for (unsigned int j = 0; j < SpaceDimension; ++j)
+  {
+    totalOffsetToSupportIndex += supportIndex[j] * offsetTable[j];
+  }
+
+  for (unsigned int j = 0; j < SpaceDimension; ++j)
+  {
+    mu[j] = this->m_CoefficientImages[j]->GetBufferPointer() + totalOffsetToSupportIndex;
+  }
+  return offsetTable;
+
+} // end ComputeCoefficientPointers()
+
+
 /**
  * ********************* TransformPoint ****************************
  */
@@ -85,19 +130,9 @@ RecursiveBSplineTransform<TScalar, NDimensions, VSplineOrder>::TransformPoint(co
   IndexType supportIndex;
   this->m_RecursiveBSplineWeightFunction->Evaluate(cindex, weights1D, supportIndex);
 
-  /** Initialize (helper) variables. */
-  const OffsetValueType * bsplineOffsetTable = this->m_CoefficientImages[0]->GetOffsetTable();
-  OffsetValueType         totalOffsetToSupportIndex = 0;
-  for (unsigned int j = 0; j < SpaceDimension; ++j)
-  {
-    totalOffsetToSupportIndex += supportIndex[j] * bsplineOffsetTable[j];
-  }
-
-  ScalarType * mu[SpaceDimension];
-  for (unsigned int j = 0; j < SpaceDimension; ++j)
-  {
-    mu[j] = this->m_CoefficientImages[j]->GetBufferPointer() + totalOffsetToSupportIndex;
-  }
+  /** Get handles to the mu's and the matching offset table. */
+  ScalarType *            mu[SpaceDimension];
+  const OffsetValueType * bsplineOffsetTable = this->ComputeCoefficientPointers(supportIndex, mu);
 
   /** Call the recursive TransformPoint function. */
   ScalarType displacement[SpaceDimension];
@@ -290,20 +325,9 @@ RecursiveBSplineTransform<TScalar, NDimensions, VSplineOrder>::GetSpatialJacobia
   this->m_RecursiveBSplineWeightFunction->Evaluate(cindex, weights1D, supportIndex);
   this->m_RecursiveBSplineWeightFunction->EvaluateDerivative(cindex, derivativeWeights1D, supportIndex);
 
-  /** Compute the offset to the start index. */
-  const OffsetValueType * bsplineOffsetTable = this->m_CoefficientImages[0]->GetOffsetTable();
-  OffsetValueType         totalOffsetToSupportIndex = 0;
-  for (unsigned int j = 0; j < SpaceDimension; ++j)
-  {
-    totalOffsetToSupportIndex += supportIndex[j] * bsplineOffsetTable[j];
-  }
-
-  /** Get handles to the mu's. */
-  ScalarType * mu[SpaceDimension];
-  for (unsigned int j = 0; j < SpaceDimension; ++j)
-  {
-    mu[j] = this->m_CoefficientImages[j]->GetBufferPointer() + totalOffsetToSupportIndex;
-  }
+  /** Get handles to the mu's and the matching offset table. */
+  ScalarType *            mu[SpaceDimension];
+  const OffsetValueType * bsplineOffsetTable = this->ComputeCoefficientPointers(supportIndex, mu);
 
   /** Recursively compute the spatial Jacobian. */
   double spatialJacobian[SpaceDimension * (SpaceDimension + 1)]; // double
@@ -382,20 +406,9 @@ RecursiveBSplineTransform<TScalar, NDimensions, VSplineOrder>::GetSpatialHessian
   this->m_RecursiveBSplineWeightFunction->EvaluateDerivative(cindex, derivativeWeights1D, supportIndex);
   this->m_RecursiveBSplineWeightFunction->EvaluateSecondOrderDerivative(cindex, hessianWeights1D, supportIndex);
 
-  /** Compute the offset to the start index. */
-  const OffsetValueType * bsplineOffsetTable = this->m_CoefficientImages[0]->GetOffsetTable();
-  OffsetValueType         totalOffsetToSupportIndex = 0;
-  for (unsigned int j = 0; j < SpaceDimension; ++j)
-  {
-    totalOffsetToSupportIndex += supportIndex[j] * bsplineOffsetTable[j];
-  }
-
-  /** Get handles to the mu's. */
-  ScalarType * mu[SpaceDimension];
-  for (unsigned int j = 0; j < SpaceDimension; ++j)
-  {
-    mu[j] = this->m_CoefficientImages[j]->GetBufferPointer() + totalOffsetToSupportIndex;
-  }
+  /** Get handles to the mu's and the matching offset table. */
+  ScalarType *            mu[SpaceDimension];
+  const OffsetValueType * bsplineOffsetTable = this->ComputeCoefficientPointers(supportIndex, mu);
 
   /** Recursively compute the spatial Hessian. */
   double spatialHessian[SpaceDimension * (SpaceDimension + 1) * (SpaceDimension + 2) / 2];
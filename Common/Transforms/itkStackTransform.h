@@ -128,10 +128,19 @@ public:
   GetJacobian(const InputPointType & ipp, JacobianType & jac, NonZeroJacobianIndicesType & nzji) const override;
 
   /** Set the parameters. Checks if the number of parameters
-   * is correct and sets parameters of sub transforms. */
+   * is correct and sets parameters of sub transforms.
+   * NOTE: For efficiency, the parameters are not copied: each sub transform
+   * gets a view on its slice of param. The parameters are assumed to be
+   * maintained by the caller, as for the B-spline transform.
+   */
   void
   SetParameters(const ParametersType & param) override;
 
+  /** Set the parameters by value. The stack transform keeps a copy of the
+   * parameters, which the sub transforms refer to. */
+  void
+  SetParametersByValue(const ParametersType & param) override;
+
   /** Get the parameters. Concatenates the parameters of the
    * sub transforms. */
   const ParametersType &
@@ -297,6 +306,12 @@ private:
   // Transform container
   SubTransformContainerType m_SubTransformContainer;
 
+  // Views on the slices of the parameters of the sub transforms, see SetParameters()
+  std::vector<ParametersType> m_SubTransformParameters;
+
+  // Copy of the parameters passed to SetParametersByValue()
+  ParametersType m_InternalParametersBuffer;
+
   // Stack spacing and origin of last dimension
   TScalarType m_StackSpacing{ 1.0 };
   TScalarType m_StackOrigin{ 0.0 };
@@ -49,20 +49,38 @@ StackTransform<TScalarType, NInputDimensions, NOutputDimensions>::SetParameters(
                          "per subtransform.");
   }
 
-  // Set separate subtransform parameters
+  // Set separate subtransform parameters, as views on the slices of param,
+  // so that the parameters are not copied in every iteration of the optimizer.
   const NumberOfParametersType numSubTransformParameters = this->m_SubTransformContainer[0]->GetNumberOfParameters();
   const auto                   numberOfSubTransforms = static_cast<unsigned>(m_SubTransformContainer.size());
+  ParametersValueType *        dataPointer = const_cast<ParametersValueType *>(param.data_block());
+  this->m_SubTransformParameters.resize(numberOfSubTransforms);
   for (unsigned int t = 0; t < numberOfSubTransforms; ++t)
   {
-    // NTA, split the parameter by number of subparameters
-    const ParametersType subparams(&(param.data_block()[t * numSubTransformParameters]), numSubTransformParameters);
-    this->m_SubTransformContainer[t]->SetParametersByValue(subparams);
+    ParametersType & subparams = this->m_SubTransformParameters[t];
+    subparams.SetData(dataPointer + t * numSubTransformParameters, numSubTransformParameters, false);
+    this->m_SubTransformContainer[t]->SetParameters(subparams);
   }
 
   this->Modified();
 } // end SetParameters()
 
 
+/**
+ * ************************ SetParametersByValue ***********************
+ */
+
+template <class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
+void
+StackTransform<TScalarType, NInputDimensions, NOutputDimensions>::SetParametersByValue(const ParametersType & param)
+{
+  // Keep a copy, and let the subtransforms refer to it.
+  this->m_InternalParametersBuffer = param;
+  this->SetParameters(this->m_InternalParametersBuffer);
+
+} // end SetParametersByValue()
+
+
 /**
  * ************************ GetParameters ***********************
  */
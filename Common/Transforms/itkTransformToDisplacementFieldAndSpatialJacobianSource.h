@@ -0,0 +1,244 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkTransformToDisplacementFieldAndSpatialJacobianSource_h
+#define itkTransformToDisplacementFieldAndSpatialJacobianSource_h
+
+#include "itkAdvancedTransform.h"
+#include "itkImageSource.h"
+
+namespace itk
+{
+
+/** \class TransformToDisplacementFieldAndSpatialJacobianSource
+ * \brief Generate the displacement field, the determinant of the spatial Jacobian
+ * and the spatial Jacobian of a coordinate transform in a single pass
+ *
+ * This source combines the TransformToDisplacementFieldFilter, the
+ * TransformToDeterminantOfSpatialJacobianSource and the
+ * TransformToSpatialJacobianSource. It walks the output grid once, and
+ * evaluates the transform and its spatial Jacobian only once per voxel, to
+ * fill all requested outputs:
+ *
+ * - output 0: the displacement field \f$T(x) - x\f$;
+ * - output 1: the determinant of the spatial Jacobian \f$\det(dT/dx)\f$;
+ * - output 2: the spatial Jacobian \f$dT/dx\f$ (the full matrix).
+ *
+ * Each output is only allocated and computed when it is requested, by
+ * GenerateDisplacementField, GenerateDeterminantOfSpatialJacobian and
+ * GenerateSpatialJacobian. For linear transforms, the spatial Jacobian is
+ * computed only once.
+ *
+ * Output information (spacing, size and direction) for the output
+ * images should be set, like for the TransformToDeterminantOfSpatialJacobianSource.
+ *
+ * \ingroup GeometricTransforms
+ */
+template <class TDisplacementFieldImage,
+          class TDeterminantImage,
+          class TSpatialJacobianImage,
+          class TTransformPrecisionType = double>
+class ITK_TEMPLATE_EXPORT TransformToDisplacementFieldAndSpatialJacobianSource
+  : public ImageSource<TDisplacementFieldImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef TransformToDisplacementFieldAndSpatialJacobianSource Self;
+  typedef ImageSource<TDisplacementFieldImage>                 Superclass;
+  typedef SmartPointer<Self>                                   Pointer;
+  typedef SmartPointer<const Self>                             ConstPointer;
+
+  typedef TDisplacementFieldImage                DisplacementFieldImageType;
+  typedef TDeterminantImage                      DeterminantImageType;
+  typedef TSpatialJacobianImage                  SpatialJacobianImageType;
+  typedef typename Superclass::OutputImageType   OutputImageType;
+  typedef typename OutputImageType::Pointer      OutputImagePointer;
+  typedef typename OutputImageType::RegionType   OutputImageRegionType;
+  typedef typename Superclass::DataObjectPointer DataObjectPointer;
+
+  typedef typename Superclass::DataObjectPointerArraySizeType DataObjectPointerArraySizeType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(TransformToDisplacementFieldAndSpatialJacobianSource, ImageSource);
+
+  /** Number of dimensions. */
+  itkStaticConstMacro(ImageDimension, unsigned int, TDisplacementFieldImage::ImageDimension);
+
+  /** Typedefs for transform. */
+  typedef AdvancedTransform<TTransformPrecisionType, Self::ImageDimension, Self::ImageDimension> TransformType;
+  typedef typename TransformType::ConstPointer                                                   TransformPointerType;
+  typedef typename TransformType::SpatialJacobianType                                            SpatialJacobianType;
+  typedef typename TransformType::InputPointType                                                 InputPointType;
+  typedef typename TransformType::OutputPointType                                                OutputPointType;
+
+  /** Typedefs for the output images. */
+  typedef typename DisplacementFieldImageType::PixelType DisplacementPixelType;
+  typedef typename DisplacementPixelType::ValueType      DisplacementValueType;
+  typedef typename DeterminantImageType::PixelType       DeterminantPixelType;
+  typedef typename SpatialJacobianImageType::PixelType   SpatialJacobianPixelType;
+  typedef typename OutputImageType::RegionType           RegionType;
+  typedef typename RegionType::SizeType                  SizeType;
+  typedef typename OutputImageType::IndexType            IndexType;
+  typedef typename OutputImageType::PointType            PointType;
+  typedef typename OutputImageType::SpacingType          SpacingType;
+  typedef typename OutputImageType::PointType            OriginType;
+  typedef typename OutputImageType::DirectionType        DirectionType;
+
+  /** Typedefs for base image. */
+  typedef ImageBase<Self::ImageDimension> ImageBaseType;
+
+  /** Set the coordinate transformation. */
+  itkSetConstObjectMacro(Transform, TransformType);
+
+  /** Get a pointer to the coordinate transform. */
+  itkGetConstObjectMacro(Transform, TransformType);
+
+  /** Set the size of the output images. */
+  virtual void
+  SetOutputSize(const SizeType & size);
+
+  /** Get the size of the output images. */
+  virtual const SizeType &
+  GetOutputSize();
+
+  /** Set the start index of the output largest possible region.
+   * The default is an index of all zeros. */
+  virtual void
+  SetOutputIndex(const IndexType & index);
+
+  /** Get the start index of the output largest possible region. */
+  virtual const IndexType &
+  GetOutputIndex();
+
+  /** Set the region of the output images. */
+  itkSetMacro(OutputRegion, OutputImageRegionType);
+
+  /** Get the region of the output images. */
+  itkGetConstReferenceMacro(OutputRegion, OutputImageRegionType);
+
+  /** Set the output image spacing. */
+  itkSetMacro(OutputSpacing, SpacingType);
+  virtual void
+  SetOutputSpacing(const double * values);
+
+  /** Get the output image spacing. */
+  itkGetConstReferenceMacro(OutputSpacing, SpacingType);
+
+  /** Set the output image origin. */
+  itkSetMacro(OutputOrigin, OriginType);
+  virtual void
+  SetOutputOrigin(const double * values);
+
+  /** Get the output image origin. */
+  itkGetConstReferenceMacro(OutputOrigin, OriginType);
+
+  /** Set the output direction cosine matrix. */
+  itkSetMacro(OutputDirection, DirectionType);
+  itkGetConstReferenceMacro(OutputDirection, DirectionType);
+
+  /** Helper method to set the output parameters based on this image */
+  void
+  SetOutputParametersFromImage(const ImageBaseType * image);
+
+  /** Set/Get which outputs are generated. By default, all outputs are generated. */
+  itkSetMacro(GenerateDisplacementField, bool);
+  itkGetConstMacro(GenerateDisplacementField, bool);
+  itkBooleanMacro(GenerateDisplacementField);
+  itkSetMacro(GenerateDeterminantOfSpatialJacobian, bool);
+  itkGetConstMacro(GenerateDeterminantOfSpatialJacobian, bool);
+  itkBooleanMacro(GenerateDeterminantOfSpatialJacobian);
+  itkSetMacro(GenerateSpatialJacobian, bool);
+  itkGetConstMacro(GenerateSpatialJacobian, bool);
+  itkBooleanMacro(GenerateSpatialJacobian);
+
+  /** Get the displacement field, output 0. */
+  DisplacementFieldImageType *
+  GetDisplacementFieldOutput(void);
+
+  /** Get the determinant of the spatial Jacobian, output 1. */
+  DeterminantImageType *
+  GetDeterminantOfSpatialJacobianOutput(void);
+
+  /** Get the spatial Jacobian, output 2. */
+  SpatialJacobianImageType *
+  GetSpatialJacobianOutput(void);
+
+  /** Create the output of the right image type for each index. */
+  using Superclass::MakeOutput;
+  DataObjectPointer
+  MakeOutput(DataObjectPointerArraySizeType idx) override;
+
+  /** Sets the output information of all outputs. */
+  void
+  GenerateOutputInformation(void) override;
+
+  /** Checks if the transform is set, and computes the spatial Jacobian
+   * of a linear transform.
+   */
+  void
+  BeforeThreadedGenerateData(void) override;
+
+  /** Compute the Modified Time based on changes to the components. */
+  ModifiedTimeType
+  GetMTime(void) const override;
+
+protected:
+  TransformToDisplacementFieldAndSpatialJacobianSource();
+  ~TransformToDisplacementFieldAndSpatialJacobianSource() override = default;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** Only allocates the requested outputs. */
+  void
+  AllocateOutputs(void) override;
+
+  /** Computes all requested outputs at the points of the output region of a thread. */
+  void
+  ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId) override;
+
+private:
+  TransformToDisplacementFieldAndSpatialJacobianSource(const Self &) = delete;
+  void
+  operator=(const Self &) = delete;
+
+  /** Member variables. */
+  RegionType           m_OutputRegion;    // region of the output images
+  TransformPointerType m_Transform;       // Coordinate transform to use
+  SpacingType          m_OutputSpacing;   // output image spacing
+  OriginType           m_OutputOrigin;    // output image origin
+  DirectionType        m_OutputDirection; // output image direction cosines
+
+  bool m_GenerateDisplacementField{ true };
+  bool m_GenerateDeterminantOfSpatialJacobian{ true };
+  bool m_GenerateSpatialJacobian{ true };
+
+  /** The spatial Jacobian of a linear transform, which is the same at all points. */
+  bool                m_TransformIsLinear{ false };
+  SpatialJacobianType m_LinearSpatialJacobian;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkTransformToDisplacementFieldAndSpatialJacobianSource.hxx"
+#endif
+
+#endif // end #ifndef itkTransformToDisplacementFieldAndSpatialJacobianSource_h
@@ -0,0 +1,520 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkTransformToDisplacementFieldAndSpatialJacobianSource_hxx
+#define itkTransformToDisplacementFieldAndSpatialJacobianSource_hxx
+
+#include "itkTransformToDisplacementFieldAndSpatialJacobianSource.h"
+
+#include "itkAdvancedIdentityTransform.h"
+#include "itkProgressReporter.h"
+#include "itkIndexRange.h"
+#include "itkImageRegionIterator.h"
+#include <vnl/vnl_copy.h>
+#include <vnl/vnl_det.h>
+
+namespace itk
+{
+
+/**
+ * Constructor
+ */
+template <class TDisplacementFieldImage,
+          class TDeterminantImage,
+          class TSpatialJacobianImage,
+          class TTransformPrecisionType>
+TransformToDisplacementFieldAndSpatialJacobianSource<TDisplacementFieldImage,
+                                                     TDeterminantImage,
+                                                     TSpatialJacobianImage,
+                                                     TTransformPrecisionType>::TransformToDisplacementFieldAndSpatialJacobianSource()
+{
+  this->m_OutputSpacing.Fill(1.0);
+  this->m_OutputOrigin.Fill(0.0);
+  this->m_OutputDirection.SetIdentity();
+
+  SizeType size;
+  size.Fill(0);
+  this->m_OutputRegion.SetSize(size);
+
+  IndexType index;
+  index.Fill(0);
+  this->m_OutputRegion.SetIndex(index);
+
+  this->m_Transform = AdvancedIdentityTransform<TTransformPrecisionType, ImageDimension>::New();
+  this->m_LinearSpatialJacobian.SetIdentity();
+
+  // The superclass has created the displacement field output; add the other two.
+  this->ProcessObject::SetNumberOfRequiredOutputs(3);
+  this->ProcessObject::SetNthOutput(1, this->MakeOutput(1));
+  this->ProcessObject::SetNthOutput(2, this->MakeOutput(2));
+
+  // Use the classic (ITK4) threading model, to ensure ThreadedGenerateData is being called.
+  this->itk::ImageSource<TDisplacementFieldImage>::DynamicMultiThreadingOff();
+
+} // end Constructor
+
+
+/**
+ * Print out a description of self
+ */
+template <class TDisplacementFieldImage,
+          class TDeterminantImage,
+          class TSpatialJacobianImage,
+          class TTransformPrecisionType>
+void
+TransformToDisplacementFieldAndSpatialJacobianSource<TDisplacementFieldImage,
+                                                     TDeterminantImage,
+                                                     TSpatialJacobianImage,
+                                                     TTransformPrecisionType>::PrintSelf(std::ostream & os,
+                                                                                         Indent         indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "OutputRegion: " << this->m_OutputRegion << std::endl;
+  os << indent << "OutputSpacing: " << this->m_OutputSpacing << std::endl;
+  os << indent << "OutputOrigin: " << this->m_OutputOrigin << std::endl;
+  os << indent << "OutputDirection: " << this->m_OutputDirection << std::endl;
+  os << indent << "Transform: " << this->m_Transform.GetPointer() << std::endl;
+  os << indent << "GenerateDisplacementField: " << this->m_GenerateDisplacementField << std::endl;
+  os << indent << "GenerateDeterminantOfSpatialJacobian: " << this->m_GenerateDeterminantOfSpatialJacobian
+     << std::endl;
+  os << indent << "GenerateSpatialJacobian: " << this->m_GenerateSpatialJacobian << std::endl;
+
+} // end PrintSelf()
+
+
+/**
+ * Set the output image size.
+ */
+template <class TDisplacementFieldImage,
+          class TDeterminantImage,
+          class TSpatialJacobianImage,
+          class TTransformPrecisionType>
+void
+TransformToDisplacementFieldAndSpatialJacobianSource<TDisplacementFieldImage,
+                                                     TDeterminantImage,
+                                                     TSpatialJacobianImage,
+                                                     TTransformPrecisionType>::SetOutputSize(const SizeType & size)
+{
+  this->m_OutputRegion.SetSize(size);
+}
+
+
+/**
+ * Get the output image size.
+ */
+template <class TDisplacementFieldImage,
+          class TDeterminantImage,
+          class TSpatialJacobianImage,
+          class TTransformPrecisionType>
+auto
+TransformToDisplacementFieldAndSpatialJacobianSource<TDisplacementFieldImage,
+                                                     TDeterminantImage,
+                                                     TSpatialJacobianImage,
+                                                     TTransformPrecisionType>::GetOutputSize() -> const SizeType &
+{
+  return this->m_OutputRegion.GetSize();
+}
+
+
+/**
+ * Set the output image index.
+ */
+template <class TDisplacementFieldImage,
+          class TDeterminantImage,
+          class TSpatialJacobianImage,
+          class TTransformPrecisionType>
+void
+TransformToDisplacementFieldAndSpatialJacobianSource<TDisplacementFieldImage,
+                                                     TDeterminantImage,
+                                                     TSpatialJacobianImage,
+                                                     TTransformPrecisionType>::SetOutputIndex(const IndexType & index)
+{
+  this->m_OutputRegion.SetIndex(index);
+}
+
+
+/**
+ * Get the output image index.
+ */
+template <class TDisplacementFieldImage,
+          class TDeterminantImage,
+          class TSpatialJacobianImage,
+          class TTransformPrecisionType>
+auto
+TransformToDisplacementFieldAndSpatialJacobianSource<TDisplacementFieldImage,
+                                                     TDeterminantImage,
+                                                     TSpatialJacobianImage,
+                                                     TTransformPrecisionType>::GetOutputIndex() -> const IndexType &
+{
+  return this->m_OutputRegion.GetIndex();
+}
+
+
+/**
+ * Set the output image spacing.
+ */
+template <class TDisplacementFieldImage,
+          class TDeterminantImage,
+          class TSpatialJacobianImage,
+          class TTransformPrecisionType>
+void
+TransformToDisplacementFieldAndSpatialJacobianSource<TDisplacementFieldImage,
+                                                     TDeterminantImage,
+                                                     TSpatialJacobianImage,
+                                                     TTransformPrecisionType>::SetOutputSpacing(const double * spacing)
+{
+  SpacingType s(spacing);
+  this->SetOutputSpacing(s);
+
+} // end SetOutputSpacing()
+
+
+/**
+ * Set the output image origin.
+ */
+template <class TDisplacementFieldImage,
+          class TDeterminantImage,
+          class TSpatialJacobianImage,
+          class TTransformPrecisionType>
+void
+TransformToDisplacementFieldAndSpatialJacobianSource<TDisplacementFieldImage,
+                                                     TDeterminantImage,
+                                                     TSpatialJacobianImage,
+                                                     TTransformPrecisionType>::SetOutputOrigin(const double * origin)
+{
+  OriginType p(origin);
+  this->SetOutputOrigin(p);
+}
+
+
+/** Helper method to set the output parameters based on this image */
+template <class TDisplacementFieldImage,
+          class TDeterminantImage,
+          class TSpatialJacobianImage,
+          class TTransformPrecisionType>
+void
+TransformToDisplacementFieldAndSpatialJacobianSource<TDisplacementFieldImage,
+                                                     TDeterminantImage,
+                                                     TSpatialJacobianImage,
+                                                     TTransformPrecisionType>::SetOutputParametersFromImage(
+  const ImageBaseType * image)
+{
+  if (!image)
+  {
+    itkExceptionMacro(<< "Cannot use a null image reference");
+  }
+
+  this->SetOutputOrigin(image->GetOrigin());
+  this->SetOutputSpacing(image->GetSpacing());
+  this->SetOutputDirection(image->GetDirection());
+  this->SetOutputRegion(image->GetLargestPossibleRegion());
+
+} // end SetOutputParametersFromImage()
+
+
+/**
+ * Get the outputs.
+ */
+template <class TDisplacementFieldImage,
+          class TDeterminantImage,
+          class TSpatialJacobianImage,
+          class TTransformPrecisionType>
+auto
+TransformToDisplacementFieldAndSpatialJacobianSource<TDisplacementFieldImage,
+                                                     TDeterminantImage,
+                                                     TSpatialJacobianImage,
+                                                     TTransformPrecisionType>::GetDisplacementFieldOutput()
+  -> DisplacementFieldImageType *
+{
+  return dynamic_cast<DisplacementFieldImageType *>(this->ProcessObject::GetOutput(0));
+}
+
+
+template <class TDisplacementFieldImage,
+          class TDeterminantImage,
+          class TSpatialJacobianImage,
+          class TTransformPrecisionType>
+auto
+TransformToDisplacementFieldAndSpatialJacobianSource<TDisplacementFieldImage,
+                                                     TDeterminantImage,
+                                                     TSpatialJacobianImage,
+                                                     TTransformPrecisionType>::GetDeterminantOfSpatialJacobianOutput()
+  -> DeterminantImageType *
+{
+  return dynamic_cast<DeterminantImageType *>(this->ProcessObject::GetOutput(1));
+}
+
+
+template <class TDisplacementFieldImage,
+          class TDeterminantImage,
+          class TSpatialJacobianImage,
+          class TTransformPrecisionType>
+auto
+TransformToDisplacementFieldAndSpatialJacobianSource<TDisplacementFieldImage,
+                                                     TDeterminantImage,
+                                                     TSpatialJacobianImage,
+                                                     TTransformPrecisionType>::GetSpatialJacobianOutput()
+  -> SpatialJacobianImageType *
+{
+  return dynamic_cast<SpatialJacobianImageType *>(this->ProcessObject::GetOutput(2));
+}
+
+
+/**
+ * Create the outputs, which have a different pixel type.
+ */
+template <class TDisplacementFieldImage,
+          class TDeterminantImage,
+          class TSpatialJacobianImage,
+          class TTransformPrecisionType>
+auto
+TransformToDisplacementFieldAndSpatialJacobianSource<TDisplacementFieldImage,
+                                                     TDeterminantImage,
+                                                     TSpatialJacobianImage,
+                                                     TTransformPrecisionType>::MakeOutput(
+  DataObjectPointerArraySizeType idx) -> DataObjectPointer
+{
+  switch (idx)
+  {
+    case 1:
+      return DeterminantImageType::New().GetPointer();
+    case 2:
+      return SpatialJacobianImageType::New().GetPointer();
+    default:
+      return DisplacementFieldImageType::New().GetPointer();
+  }
+
+} // end MakeOutput()
+
+
+/**
+ * Allocate only the requested outputs.
+ */
+template <class TDisplacementFieldImage,
+          class TDeterminantImage,
+          class TSpatialJacobianImage,
+          class TTransformPrecisionType>
+void
+TransformToDisplacementFieldAndSpatialJacobianSource<TDisplacementFieldImage,
+                                                     TDeterminantImage,
+                                                     TSpatialJacobianImage,
+                                                     TTransformPrecisionType>::AllocateOutputs(void)
+{
+  const bool generateOutput[3] = { this->m_GenerateDisplacementField,
+                                   this->m_GenerateDeterminantOfSpatialJacobian,
+                                   this->m_GenerateSpatialJacobian };
+
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    ImageBaseType * outputPtr = dynamic_cast<ImageBaseType *>(this->ProcessObject::GetOutput(i));
+    if (outputPtr && generateOutput[i])
+    {
+      outputPtr->SetBufferedRegion(outputPtr->GetRequestedRegion());
+      outputPtr->Allocate();
+    }
+  }
+
+} // end AllocateOutputs()
+
+
+/**
+ * Check the transform, and compute the spatial Jacobian of a linear transform.
+ */
+template <class TDisplacementFieldImage,
+          class TDeterminantImage,
+          class TSpatialJacobianImage,
+          class TTransformPrecisionType>
+void
+TransformToDisplacementFieldAndSpatialJacobianSource<TDisplacementFieldImage,
+                                                     TDeterminantImage,
+                                                     TSpatialJacobianImage,
+                                                     TTransformPrecisionType>::BeforeThreadedGenerateData(void)
+{
+  if (!this->m_Transform)
+  {
+    itkExceptionMacro(<< "Transform not set");
+  }
+
+  this->m_TransformIsLinear = this->m_Transform->IsLinear();
+  if (this->m_TransformIsLinear)
+  {
+    InputPointType point;
+    point.Fill(0.0);
+    this->m_Transform->GetSpatialJacobian(point, this->m_LinearSpatialJacobian);
+  }
+
+} // end BeforeThreadedGenerateData()
+
+
+/**
+ * ThreadedGenerateData
+ */
+template <class TDisplacementFieldImage,
+          class TDeterminantImage,
+          class TSpatialJacobianImage,
+          class TTransformPrecisionType>
+void
+TransformToDisplacementFieldAndSpatialJacobianSource<TDisplacementFieldImage,
+                                                     TDeterminantImage,
+                                                     TSpatialJacobianImage,
+                                                     TTransformPrecisionType>::ThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType                  threadId)
+{
+  // Get the output pointers. The displacement field defines the geometry of all outputs.
+  DisplacementFieldImageType * displacementField = this->GetDisplacementFieldOutput();
+  DeterminantImageType *       determinantImage = this->GetDeterminantOfSpatialJacobianOutput();
+  SpatialJacobianImageType *   spatialJacobianImage = this->GetSpatialJacobianOutput();
+
+  // Create the iterators of the generated outputs. They walk the output region for this thread
+  // in the same order as the index range below. The index range does not need a buffered
+  // image, so it also works when the displacement field is not generated.
+  ImageRegionIterator<DisplacementFieldImageType> displacementIt;
+  ImageRegionIterator<DeterminantImageType>       determinantIt;
+  ImageRegionIterator<SpatialJacobianImageType>   spatialJacobianIt;
+  if (this->m_GenerateDisplacementField)
+  {
+    displacementIt = ImageRegionIterator<DisplacementFieldImageType>(displacementField, outputRegionForThread);
+  }
+  if (this->m_GenerateDeterminantOfSpatialJacobian)
+  {
+    determinantIt = ImageRegionIterator<DeterminantImageType>(determinantImage, outputRegionForThread);
+  }
+  if (this->m_GenerateSpatialJacobian)
+  {
+    spatialJacobianIt = ImageRegionIterator<SpatialJacobianImageType>(spatialJacobianImage, outputRegionForThread);
+  }
+
+  // The spatial Jacobian is evaluated once per point, and not at all for linear transforms.
+  const bool computeSpatialJacobian =
+    !this->m_TransformIsLinear && (this->m_GenerateDeterminantOfSpatialJacobian || this->m_GenerateSpatialJacobian);
+
+  // Support for progress methods/callbacks
+  ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  InputPointType           point;
+  DisplacementPixelType    displacement;
+  SpatialJacobianType      sj = this->m_LinearSpatialJacobian;
+  SpatialJacobianPixelType sjOut;
+  const unsigned int       nrElements = sj.GetVnlMatrix().size();
+
+  // Walk the output region
+  for (const auto & index : ImageRegionIndexRange<Self::ImageDimension>(outputRegionForThread))
+  {
+    // Determine the coordinates of the current voxel
+    displacementField->TransformIndexToPhysicalPoint(index, point);
+
+    if (this->m_GenerateDisplacementField)
+    {
+      const OutputPointType transformedPoint = this->m_Transform->TransformPoint(point);
+      for (unsigned int d = 0; d < ImageDimension; ++d)
+      {
+        displacement[d] = static_cast<DisplacementValueType>(transformedPoint[d] - point[d]);
+      }
+      displacementIt.Set(displacement);
+      ++displacementIt;
+    }
+
+    if (computeSpatialJacobian)
+    {
+      this->m_Transform->GetSpatialJacobian(point, sj);
+    }
+
+    if (this->m_GenerateDeterminantOfSpatialJacobian)
+    {
+      determinantIt.Set(static_cast<DeterminantPixelType>(vnl_det(sj.GetVnlMatrix())));
+      ++determinantIt;
+    }
+
+    if (this->m_GenerateSpatialJacobian)
+    {
+      // cast spatial jacobian to output pixel type
+      vnl_copy(sj.GetVnlMatrix().begin(), sjOut.GetVnlMatrix().begin(), nrElements);
+      spatialJacobianIt.Set(sjOut);
+      ++spatialJacobianIt;
+    }
+
+    // Update progress
+    progress.CompletedPixel();
+  }
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * Inform pipeline of required output region
+ */
+template <class TDisplacementFieldImage,
+          class TDeterminantImage,
+          class TSpatialJacobianImage,
+          class TTransformPrecisionType>
+void
+TransformToDisplacementFieldAndSpatialJacobianSource<TDisplacementFieldImage,
+                                                     TDeterminantImage,
+                                                     TSpatialJacobianImage,
+                                                     TTransformPrecisionType>::GenerateOutputInformation(void)
+{
+  // call the superclass' implementation of this method
+  Superclass::GenerateOutputInformation();
+
+  // all outputs share the same geometry
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    ImageBaseType * outputPtr = dynamic_cast<ImageBaseType *>(this->ProcessObject::GetOutput(i));
+    if (outputPtr)
+    {
+      outputPtr->SetLargestPossibleRegion(m_OutputRegion);
+      outputPtr->SetSpacing(m_OutputSpacing);
+      outputPtr->SetOrigin(m_OutputOrigin);
+      outputPtr->SetDirection(m_OutputDirection);
+    }
+  }
+
+} // end GenerateOutputInformation()
+
+
+/**
+ * Verify if any of the components has been modified.
+ */
+template <class TDisplacementFieldImage,
+          class TDeterminantImage,
+          class TSpatialJacobianImage,
+          class TTransformPrecisionType>
+ModifiedTimeType
+TransformToDisplacementFieldAndSpatialJacobianSource<TDisplacementFieldImage,
+                                                     TDeterminantImage,
+                                                     TSpatialJacobianImage,
+                                                     TTransformPrecisionType>::GetMTime(void) const
+{
+  ModifiedTimeType latestTime = Object::GetMTime();
+
+  if (this->m_Transform)
+  {
+    if (latestTime < this->m_Transform->GetMTime())
+    {
+      latestTime = this->m_Transform->GetMTime();
+    }
+  }
+
+  return latestTime;
+} // end GetMTime()
+
+
+} // end namespace itk
+
+#endif // end #ifndef itkTransformToDisplacementFieldAndSpatialJacobianSource_hxx
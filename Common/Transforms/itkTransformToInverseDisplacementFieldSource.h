@@ -0,0 +1,262 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkTransformToInverseDisplacementFieldSource_h
+#define itkTransformToInverseDisplacementFieldSource_h
+
+#include "itkAdvancedTransform.h"
+#include "itkImageSource.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class TransformToInverseDisplacementFieldSource
+ * \brief Generate the displacement field of the inverse of a coordinate transform
+ *
+ * For each point \f$y\f$ of the output grid, this source computes the point
+ * \f$x\f$ for which \f$T(x) = y\f$, and stores the displacement \f$x - y\f$.
+ * So, the output is the displacement field of the inverse transform, which
+ * can for example be used to warp an image from the moving to the fixed
+ * image domain.
+ *
+ * The inverse is computed per point with the fixed-point iteration
+ * \f$x_{k+1} = x_k - M^{-1} ( T(x_k) - y )\f$, with \f$M\f$ the spatial
+ * Jacobian of the transform at the starting point \f$x_0\f$. For a linear
+ * transform this gives the exact inverse in a single iteration. The
+ * iteration stops when the residual \f$\|T(x_k) - y\|\f$ is smaller than the
+ * Tolerance, in physical units, or after MaximumNumberOfIterations.
+ *
+ * The starting points are obtained from a coarse inverse: the inverse is
+ * first computed on a grid with a spacing of CoarseGridSpacing output
+ * voxels, starting at \f$x_0 = y\f$, after which the starting point of each
+ * output voxel is interpolated linearly from that coarse inverse. Both the
+ * coarse and the fine level are multi-threaded.
+ *
+ * After the update, the maximum and mean residual, the mean number of
+ * iterations and the number of points that did not converge are available
+ * as statistics of the inversion.
+ *
+ * Output information (spacing, size and direction) for the output
+ * image should be set, like for the TransformToDeterminantOfSpatialJacobianSource.
+ *
+ * \ingroup GeometricTransforms
+ */
+template <class TOutputImage, class TTransformPrecisionType = double>
+class ITK_TEMPLATE_EXPORT TransformToInverseDisplacementFieldSource : public ImageSource<TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef TransformToInverseDisplacementFieldSource Self;
+  typedef ImageSource<TOutputImage>                 Superclass;
+  typedef SmartPointer<Self>                        Pointer;
+  typedef SmartPointer<const Self>                  ConstPointer;
+
+  typedef TOutputImage                           OutputImageType;
+  typedef typename OutputImageType::Pointer      OutputImagePointer;
+  typedef typename OutputImageType::ConstPointer OutputImageConstPointer;
+  typedef typename OutputImageType::RegionType   OutputImageRegionType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(TransformToInverseDisplacementFieldSource, ImageSource);
+
+  /** Number of dimensions. */
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  /** Typedefs for transform. */
+  typedef AdvancedTransform<TTransformPrecisionType, Self::ImageDimension, Self::ImageDimension> TransformType;
+  typedef typename TransformType::ConstPointer                                                   TransformPointerType;
+  typedef typename TransformType::SpatialJacobianType                                            SpatialJacobianType;
+  typedef typename TransformType::InputPointType                                                 InputPointType;
+  typedef typename TransformType::OutputVectorType                                               OutputVectorType;
+
+  /** Typedefs for output image. */
+  typedef typename OutputImageType::PixelType     PixelType;
+  typedef typename PixelType::ValueType           PixelValueType;
+  typedef typename OutputImageType::RegionType    RegionType;
+  typedef typename RegionType::SizeType           SizeType;
+  typedef typename OutputImageType::IndexType     IndexType;
+  typedef typename OutputImageType::PointType     PointType;
+  typedef typename OutputImageType::SpacingType   SpacingType;
+  typedef typename OutputImageType::PointType     OriginType;
+  typedef typename OutputImageType::DirectionType DirectionType;
+
+  /** Typedefs for base image. */
+  typedef ImageBase<Self::ImageDimension> ImageBaseType;
+
+  /** Typedef for the coarse inverse, which stores the inverse displacements in double precision. */
+  typedef Image<OutputVectorType, Self::ImageDimension> CoarseInverseImageType;
+
+  /** Set the coordinate transformation that is inverted. */
+  itkSetConstObjectMacro(Transform, TransformType);
+
+  /** Get a pointer to the coordinate transform. */
+  itkGetConstObjectMacro(Transform, TransformType);
+
+  /** Set the size of the output image. */
+  virtual void
+  SetOutputSize(const SizeType & size);
+
+  /** Get the size of the output image. */
+  virtual const SizeType &
+  GetOutputSize();
+
+  /** Set the start index of the output largest possible region.
+   * The default is an index of all zeros. */
+  virtual void
+  SetOutputIndex(const IndexType & index);
+
+  /** Get the start index of the output largest possible region. */
+  virtual const IndexType &
+  GetOutputIndex();
+
+  /** Set the region of the output image. */
+  itkSetMacro(OutputRegion, OutputImageRegionType);
+
+  /** Get the region of the output image. */
+  itkGetConstReferenceMacro(OutputRegion, OutputImageRegionType);
+
+  /** Set the output image spacing. */
+  itkSetMacro(OutputSpacing, SpacingType);
+  virtual void
+  SetOutputSpacing(const double * values);
+
+  /** Get the output image spacing. */
+  itkGetConstReferenceMacro(OutputSpacing, SpacingType);
+
+  /** Set the output image origin. */
+  itkSetMacro(OutputOrigin, OriginType);
+  virtual void
+  SetOutputOrigin(const double * values);
+
+  /** Get the output image origin. */
+  itkGetConstReferenceMacro(OutputOrigin, OriginType);
+
+  /** Set the output direction cosine matrix. */
+  itkSetMacro(OutputDirection, DirectionType);
+  itkGetConstReferenceMacro(OutputDirection, DirectionType);
+
+  /** Helper method to set the output parameters based on this image */
+  void
+  SetOutputParametersFromImage(const ImageBaseType * image);
+
+  /** Set/Get the maximum residual \f$\|T(x) - y\|\f$ of a converged point, in
+   * physical units. Default 0.01.
+   */
+  itkSetMacro(Tolerance, double);
+  itkGetConstMacro(Tolerance, double);
+
+  /** Set/Get the maximum number of fixed-point iterations per point. Default 20. */
+  itkSetMacro(MaximumNumberOfIterations, unsigned int);
+  itkGetConstMacro(MaximumNumberOfIterations, unsigned int);
+
+  /** Set/Get the spacing of the coarse inverse, in output voxels. A spacing of 1
+   * disables the coarse inverse, so that each point starts at \f$x_0 = y\f$. Default 4.
+   */
+  itkSetMacro(CoarseGridSpacing, unsigned int);
+  itkGetConstMacro(CoarseGridSpacing, unsigned int);
+
+  /** Statistics of the last update. */
+  itkGetConstMacro(MaximumResidual, double);
+  itkGetConstMacro(MeanResidual, double);
+  itkGetConstMacro(MeanNumberOfIterations, double);
+  itkGetConstMacro(NumberOfNonConvergedPoints, SizeValueType);
+
+  /** TransformToInverseDisplacementFieldSource produces a vector image. */
+  void
+  GenerateOutputInformation(void) override;
+
+  /** Checks if the transform is set, computes the coarse inverse, and
+   * prepares the statistics.
+   */
+  void
+  BeforeThreadedGenerateData(void) override;
+
+  /** Combines the statistics of the threads. */
+  void
+  AfterThreadedGenerateData(void) override;
+
+  /** Compute the Modified Time based on changes to the components. */
+  ModifiedTimeType
+  GetMTime(void) const override;
+
+protected:
+  TransformToInverseDisplacementFieldSource();
+  ~TransformToInverseDisplacementFieldSource() override = default;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** Inverts the transform at the points of the output region of a thread,
+   * starting at the interpolated coarse inverse.
+   */
+  void
+  ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId) override;
+
+  /** Computes the point x for which T(x) = y, with the fixed-point iteration.
+   * On input, x is the starting point. Returns true when the residual is
+   * below the tolerance.
+   */
+  bool
+  InvertPoint(const InputPointType & y, InputPointType & x, double & residual, unsigned int & iterations) const;
+
+private:
+  TransformToInverseDisplacementFieldSource(const Self &) = delete;
+  void
+  operator=(const Self &) = delete;
+
+  /** The statistics accumulated by each thread. */
+  struct InversionStatisticsType
+  {
+    double        st_MaximumResidual;
+    double        st_SumOfResiduals;
+    SizeValueType st_SumOfIterations;
+    SizeValueType st_NumberOfNonConvergedPoints;
+    SizeValueType st_NumberOfPoints;
+  };
+
+  /** Member variables. */
+  RegionType           m_OutputRegion;    // region of the output image
+  TransformPointerType m_Transform;       // Coordinate transform to use
+  SpacingType          m_OutputSpacing;   // output image spacing
+  OriginType           m_OutputOrigin;    // output image origin
+  DirectionType        m_OutputDirection; // output image direction cosines
+
+  double       m_Tolerance{ 0.01 };
+  unsigned int m_MaximumNumberOfIterations{ 20 };
+  unsigned int m_CoarseGridSpacing{ 4 };
+
+  typename CoarseInverseImageType::Pointer m_CoarseInverse;
+  std::vector<InversionStatisticsType>     m_ThreadStatistics;
+
+  double        m_MaximumResidual{ 0.0 };
+  double        m_MeanResidual{ 0.0 };
+  double        m_MeanNumberOfIterations{ 0.0 };
+  SizeValueType m_NumberOfNonConvergedPoints{ 0 };
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkTransformToInverseDisplacementFieldSource.hxx"
+#endif
+
+#endif // end #ifndef itkTransformToInverseDisplacementFieldSource_h
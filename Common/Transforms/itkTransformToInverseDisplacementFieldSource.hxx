@@ -0,0 +1,450 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkTransformToInverseDisplacementFieldSource_hxx
+#define itkTransformToInverseDisplacementFieldSource_hxx
+
+#include "itkTransformToInverseDisplacementFieldSource.h"
+
+#include "itkAdvancedIdentityTransform.h"
+#include "itkProgressReporter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkVectorLinearInterpolateImageFunction.h"
+#include <vnl/vnl_det.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+
+/**
+ * Constructor
+ */
+template <class TOutputImage, class TTransformPrecisionType>
+TransformToInverseDisplacementFieldSource<TOutputImage,
+                                          TTransformPrecisionType>::TransformToInverseDisplacementFieldSource()
+{
+  this->m_OutputSpacing.Fill(1.0);
+  this->m_OutputOrigin.Fill(0.0);
+  this->m_OutputDirection.SetIdentity();
+
+  SizeType size;
+  size.Fill(0);
+  this->m_OutputRegion.SetSize(size);
+
+  IndexType index;
+  index.Fill(0);
+  this->m_OutputRegion.SetIndex(index);
+
+  this->m_Transform = AdvancedIdentityTransform<TTransformPrecisionType, ImageDimension>::New();
+
+  // Use the classic (ITK4) threading model, to ensure ThreadedGenerateData is being called.
+  this->itk::ImageSource<TOutputImage>::DynamicMultiThreadingOff();
+
+} // end Constructor
+
+
+/**
+ * Print out a description of self
+ */
+template <class TOutputImage, class TTransformPrecisionType>
+void
+TransformToInverseDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::PrintSelf(std::ostream & os,
+                                                                                            Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "OutputRegion: " << this->m_OutputRegion << std::endl;
+  os << indent << "OutputSpacing: " << this->m_OutputSpacing << std::endl;
+  os << indent << "OutputOrigin: " << this->m_OutputOrigin << std::endl;
+  os << indent << "OutputDirection: " << this->m_OutputDirection << std::endl;
+  os << indent << "Transform: " << this->m_Transform.GetPointer() << std::endl;
+  os << indent << "Tolerance: " << this->m_Tolerance << std::endl;
+  os << indent << "MaximumNumberOfIterations: " << this->m_MaximumNumberOfIterations << std::endl;
+  os << indent << "CoarseGridSpacing: " << this->m_CoarseGridSpacing << std::endl;
+  os << indent << "MaximumResidual: " << this->m_MaximumResidual << std::endl;
+  os << indent << "MeanResidual: " << this->m_MeanResidual << std::endl;
+  os << indent << "MeanNumberOfIterations: " << this->m_MeanNumberOfIterations << std::endl;
+  os << indent << "NumberOfNonConvergedPoints: " << this->m_NumberOfNonConvergedPoints << std::endl;
+
+} // end PrintSelf()
+
+
+/**
+ * Set the output image size.
+ */
+template <class TOutputImage, class TTransformPrecisionType>
+void
+TransformToInverseDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::SetOutputSize(const SizeType & size)
+{
+  this->m_OutputRegion.SetSize(size);
+}
+
+
+/**
+ * Get the output image size.
+ */
+template <class TOutputImage, class TTransformPrecisionType>
+auto
+TransformToInverseDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::GetOutputSize() -> const SizeType &
+{
+  return this->m_OutputRegion.GetSize();
+}
+
+
+/**
+ * Set the output image index.
+ */
+template <class TOutputImage, class TTransformPrecisionType>
+void
+TransformToInverseDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::SetOutputIndex(
+  const IndexType & index)
+{
+  this->m_OutputRegion.SetIndex(index);
+}
+
+
+/**
+ * Get the output image index.
+ */
+template <class TOutputImage, class TTransformPrecisionType>
+auto
+TransformToInverseDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::GetOutputIndex() -> const IndexType &
+{
+  return this->m_OutputRegion.GetIndex();
+}
+
+
+/**
+ * Set the output image spacing.
+ */
+template <class TOutputImage, class TTransformPrecisionType>
+void
+TransformToInverseDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::SetOutputSpacing(
+  const double * spacing)
+{
+  SpacingType s(spacing);
+  this->SetOutputSpacing(s);
+
+} // end SetOutputSpacing()
+
+
+/**
+ * Set the output image origin.
+ */
+template <class TOutputImage, class TTransformPrecisionType>
+void
+TransformToInverseDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::SetOutputOrigin(
+  const double * origin)
+{
+  OriginType p(origin);
+  this->SetOutputOrigin(p);
+}
+
+
+/** Helper method to set the output parameters based on this image */
+template <class TOutputImage, class TTransformPrecisionType>
+void
+TransformToInverseDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::SetOutputParametersFromImage(
+  const ImageBaseType * image)
+{
+  if (!image)
+  {
+    itkExceptionMacro(<< "Cannot use a null image reference");
+  }
+
+  this->SetOutputOrigin(image->GetOrigin());
+  this->SetOutputSpacing(image->GetSpacing());
+  this->SetOutputDirection(image->GetDirection());
+  this->SetOutputRegion(image->GetLargestPossibleRegion());
+
+} // end SetOutputParametersFromImage()
+
+
+/**
+ * Invert the transform at a single point.
+ */
+template <class TOutputImage, class TTransformPrecisionType>
+bool
+TransformToInverseDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::InvertPoint(
+  const InputPointType & y,
+  InputPointType &       x,
+  double &               residual,
+  unsigned int &         iterations) const
+{
+  /** The iteration matrix is the inverse of the spatial Jacobian at the
+   * starting point, or the identity when that is (nearly) singular.
+   */
+  SpatialJacobianType sj;
+  this->m_Transform->GetSpatialJacobian(x, sj);
+  SpatialJacobianType iterationMatrix;
+  iterationMatrix.SetIdentity();
+  if (std::abs(vnl_det(sj.GetVnlMatrix())) > 1e-6)
+  {
+    iterationMatrix = sj.GetInverse();
+  }
+
+  for (iterations = 0;; ++iterations)
+  {
+    const OutputVectorType difference = this->m_Transform->TransformPoint(x) - y;
+    residual = difference.GetNorm();
+    if (residual <= this->m_Tolerance)
+    {
+      return true;
+    }
+    if (iterations == this->m_MaximumNumberOfIterations)
+    {
+      return false;
+    }
+    x -= iterationMatrix * difference;
+  }
+
+} // end InvertPoint()
+
+
+/**
+ * Compute the coarse inverse before the multi-threaded inversion of all points.
+ */
+template <class TOutputImage, class TTransformPrecisionType>
+void
+TransformToInverseDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::BeforeThreadedGenerateData(void)
+{
+  if (!this->m_Transform)
+  {
+    itkExceptionMacro(<< "Transform not set");
+  }
+
+  /** Prepare the statistics of each thread. */
+  const InversionStatisticsType emptyStatistics = { 0.0, 0.0, 0, 0, 0 };
+  this->m_ThreadStatistics.assign(this->GetNumberOfWorkUnits(), emptyStatistics);
+
+  this->m_CoarseInverse = nullptr;
+  if (this->m_CoarseGridSpacing <= 1)
+  {
+    return;
+  }
+
+  /** The coarse grid starts at the first output voxel, and covers all output voxels. */
+  const unsigned int                           factor = this->m_CoarseGridSpacing;
+  const SizeType &                             outputSize = this->m_OutputRegion.GetSize();
+  OutputImagePointer                           outputPtr = this->GetOutput();
+  typename CoarseInverseImageType::SizeType    coarseSize;
+  typename CoarseInverseImageType::SpacingType coarseSpacing;
+  typename CoarseInverseImageType::PointType   coarseOrigin;
+  for (unsigned int d = 0; d < ImageDimension; ++d)
+  {
+    coarseSize[d] = (std::max<SizeValueType>(outputSize[d], 1) + factor - 2) / factor + 1;
+    coarseSpacing[d] = this->m_OutputSpacing[d] * factor;
+  }
+  outputPtr->TransformIndexToPhysicalPoint(this->m_OutputRegion.GetIndex(), coarseOrigin);
+
+  this->m_CoarseInverse = CoarseInverseImageType::New();
+  this->m_CoarseInverse->SetRegions(coarseSize);
+  this->m_CoarseInverse->SetSpacing(coarseSpacing);
+  this->m_CoarseInverse->SetOrigin(coarseOrigin);
+  this->m_CoarseInverse->SetDirection(this->m_OutputDirection);
+  this->m_CoarseInverse->Allocate();
+
+  /** Invert the transform on the coarse grid, multi-threaded, starting at x0 = y. */
+  const typename CoarseInverseImageType::Pointer coarseInverse = this->m_CoarseInverse;
+  MultiThreaderBase *                            multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  multiThreader->template ParallelizeImageRegion<ImageDimension>(
+    coarseInverse->GetBufferedRegion(),
+    [this, coarseInverse](const typename CoarseInverseImageType::RegionType & regionForThread) {
+      ImageRegionIteratorWithIndex<CoarseInverseImageType> it(coarseInverse, regionForThread);
+      InputPointType                                       y, x;
+      double                                               residual = 0.0;
+      unsigned int                                         iterations = 0;
+      for (; !it.IsAtEnd(); ++it)
+      {
+        coarseInverse->TransformIndexToPhysicalPoint(it.GetIndex(), y);
+        x = y;
+        this->InvertPoint(y, x, residual, iterations);
+        it.Set(x - y);
+      }
+    },
+    nullptr);
+
+} // end BeforeThreadedGenerateData()
+
+
+/**
+ * ThreadedGenerateData
+ */
+template <class TOutputImage, class TTransformPrecisionType>
+void
+TransformToInverseDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::ThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType                  threadId)
+{
+  typedef VectorLinearInterpolateImageFunction<CoarseInverseImageType, double> CoarseInterpolatorType;
+  typedef typename CoarseInterpolatorType::ContinuousIndexType                 ContinuousIndexType;
+
+  // Get the output pointer
+  OutputImagePointer outputPtr = this->GetOutput();
+
+  // The interpolator of the coarse inverse, which is evaluated at the
+  // position of the output voxels in the coarse grid.
+  typename CoarseInterpolatorType::Pointer coarseInterpolator;
+  if (this->m_CoarseInverse)
+  {
+    coarseInterpolator = CoarseInterpolatorType::New();
+    coarseInterpolator->SetInputImage(this->m_CoarseInverse);
+  }
+  const IndexType & startIndex = this->m_OutputRegion.GetIndex();
+  const double      factor = static_cast<double>(this->m_CoarseGridSpacing);
+
+  // Create an iterator that will walk the output region for this thread.
+  typedef ImageRegionIteratorWithIndex<TOutputImage> OutputIteratorType;
+  OutputIteratorType                                 it(outputPtr, outputRegionForThread);
+  it.GoToBegin();
+
+  // Support for progress methods/callbacks
+  ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  InversionStatisticsType statistics = this->m_ThreadStatistics[threadId];
+  InputPointType          y, x;
+  ContinuousIndexType     coarseIndex;
+  PixelType               displacement;
+  double                  residual = 0.0;
+  unsigned int            iterations = 0;
+
+  // Walk the output region
+  while (!it.IsAtEnd())
+  {
+    // Determine the coordinates of the current voxel, and the starting point.
+    const IndexType index = it.GetIndex();
+    outputPtr->TransformIndexToPhysicalPoint(index, y);
+    x = y;
+    if (coarseInterpolator)
+    {
+      for (unsigned int d = 0; d < ImageDimension; ++d)
+      {
+        coarseIndex[d] = (index[d] - startIndex[d]) / factor;
+      }
+      x += coarseInterpolator->EvaluateAtContinuousIndex(coarseIndex);
+    }
+
+    // Invert, and store the displacement to the inverse point.
+    if (!this->InvertPoint(y, x, residual, iterations))
+    {
+      ++statistics.st_NumberOfNonConvergedPoints;
+    }
+    statistics.st_MaximumResidual = std::max(statistics.st_MaximumResidual, residual);
+    statistics.st_SumOfResiduals += residual;
+    statistics.st_SumOfIterations += iterations;
+    ++statistics.st_NumberOfPoints;
+
+    for (unsigned int d = 0; d < ImageDimension; ++d)
+    {
+      displacement[d] = static_cast<PixelValueType>(x[d] - y[d]);
+    }
+    it.Set(displacement);
+
+    // Update progress and iterator
+    progress.CompletedPixel();
+    ++it;
+  }
+
+  this->m_ThreadStatistics[threadId] = statistics;
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * Combine the statistics of the threads.
+ */
+template <class TOutputImage, class TTransformPrecisionType>
+void
+TransformToInverseDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::AfterThreadedGenerateData(void)
+{
+  double        maximumResidual = 0.0;
+  double        sumOfResiduals = 0.0;
+  SizeValueType sumOfIterations = 0;
+  SizeValueType numberOfNonConvergedPoints = 0;
+  SizeValueType numberOfPoints = 0;
+  for (const auto & statistics : this->m_ThreadStatistics)
+  {
+    maximumResidual = std::max(maximumResidual, statistics.st_MaximumResidual);
+    sumOfResiduals += statistics.st_SumOfResiduals;
+    sumOfIterations += statistics.st_SumOfIterations;
+    numberOfNonConvergedPoints += statistics.st_NumberOfNonConvergedPoints;
+    numberOfPoints += statistics.st_NumberOfPoints;
+  }
+
+  this->m_MaximumResidual = maximumResidual;
+  this->m_MeanResidual = numberOfPoints > 0 ? sumOfResiduals / numberOfPoints : 0.0;
+  this->m_MeanNumberOfIterations = numberOfPoints > 0 ? static_cast<double>(sumOfIterations) / numberOfPoints : 0.0;
+  this->m_NumberOfNonConvergedPoints = numberOfNonConvergedPoints;
+
+  /** Release the coarse inverse. */
+  this->m_CoarseInverse = nullptr;
+
+} // end AfterThreadedGenerateData()
+
+
+/**
+ * Inform pipeline of required output region
+ */
+template <class TOutputImage, class TTransformPrecisionType>
+void
+TransformToInverseDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::GenerateOutputInformation(void)
+{
+  // call the superclass' implementation of this method
+  Superclass::GenerateOutputInformation();
+
+  // get pointer to the output
+  OutputImagePointer outputPtr = this->GetOutput();
+  if (!outputPtr)
+  {
+    return;
+  }
+
+  outputPtr->SetLargestPossibleRegion(m_OutputRegion);
+  outputPtr->SetSpacing(m_OutputSpacing);
+  outputPtr->SetOrigin(m_OutputOrigin);
+  outputPtr->SetDirection(m_OutputDirection);
+
+} // end GenerateOutputInformation()
+
+
+/**
+ * Verify if any of the components has been modified.
+ */
+template <class TOutputImage, class TTransformPrecisionType>
+ModifiedTimeType
+TransformToInverseDisplacementFieldSource<TOutputImage, TTransformPrecisionType>::GetMTime(void) const
+{
+  ModifiedTimeType latestTime = Object::GetMTime();
+
+  if (this->m_Transform)
+  {
+    if (latestTime < this->m_Transform->GetMTime())
+    {
+      latestTime = this->m_Transform->GetMTime();
+    }
+  }
+
+  return latestTime;
+} // end GetMTime()
+
+
+} // end namespace itk
+
+#endif // end #ifndef itkTransformToInverseDisplacementFieldSource_hxx
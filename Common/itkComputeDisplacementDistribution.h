@@ -24,7 +24,7 @@
 #include "itkImageRandomSamplerBase.h"
 #include "itkImageRandomCoordinateSampler.h"
 #include "itkImageFullSampler.h"
-#include "itkPlatformMultiThreader.h"
+#include "itkCreateMultiThreader.h"
 
 namespace itk
 {
@@ -124,6 +124,20 @@ public:
   }
 
 
+  /** Select the multi-threader: Platform (the default), Pool or TBB. See CreateMultiThreader(). */
+  void
+  SetMultiThreaderType(const MultiThreaderBase::ThreaderEnum threaderType)
+  {
+    if (this->m_MultiThreaderType != threaderType)
+    {
+      const ThreadIdType numberOfThreads = this->m_Threader->GetNumberOfWorkUnits();
+      this->m_MultiThreaderType = threaderType;
+      this->m_Threader = CreateMultiThreader(threaderType);
+      this->m_Threader->SetNumberOfWorkUnits(numberOfThreads);
+    }
+  }
+
+
   virtual void
   BeforeThreadedCompute(const ParametersType & mu);
 
@@ -135,7 +149,7 @@ protected:
   ~ComputeDisplacementDistribution() override;
 
   /** Typedefs for multi-threading. */
-  typedef itk::PlatformMultiThreader ThreaderType;
+  typedef itk::MultiThreaderBase     ThreaderType;
   typedef ThreaderType::WorkUnitInfo ThreadInfoType;
 
   typename FixedImageType::ConstPointer   m_FixedImage;
@@ -146,6 +160,7 @@ protected:
   SizeValueType                           m_NumberOfJacobianMeasurements;
   DerivativeType                          m_ExactGradient;
   SizeValueType                           m_NumberOfParameters;
+  ThreaderType::ThreaderEnum              m_MultiThreaderType;
   ThreaderType::Pointer                   m_Threader;
 
   typedef typename FixedImageType::IndexType   FixedImageIndexType;
@@ -51,7 +51,8 @@ ComputeDisplacementDistribution<TFixedImage, TTransform>::ComputeDisplacementDis
 
   /** Threading related variables. */
   this->m_UseMultiThread = true;
-  this->m_Threader = ThreaderType::New();
+  this->m_MultiThreaderType = ThreaderType::ThreaderEnum::Platform;
+  this->m_Threader = CreateMultiThreader(this->m_MultiThreaderType);
 
   /** Initialize the m_ThreaderParameters. */
   this->m_ThreaderParameters.st_Self = this;
@@ -0,0 +1,58 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkCreateMultiThreader_h
+#define itkCreateMultiThreader_h
+
+#include "itkMultiThreaderBase.h"
+#include "itkPlatformMultiThreader.h"
+#include "itkPoolMultiThreader.h"
+#ifdef ITK_USE_TBB
+#  include "itkTBBMultiThreader.h"
+#endif
+
+namespace itk
+{
+
+/** Creates a multi-threader of the specified type. In contrast to
+ * MultiThreaderBase::New(), which always creates the global default threader,
+ * this allows each object to select its own threader:
+ * \li Platform: creates and joins the threads at each SingleMethodExecute().
+ * \li Pool: keeps its threads parked in a pool between the calls.
+ * \li TBB: runs the work units on the work-stealing scheduler of TBB. When ITK
+ *     is built without TBB, a Pool threader is returned instead.
+ */
+inline MultiThreaderBase::Pointer
+CreateMultiThreader(const MultiThreaderBase::ThreaderEnum threaderType)
+{
+  switch (threaderType)
+  {
+    case MultiThreaderBase::ThreaderEnum::Platform:
+      return PlatformMultiThreader::New().GetPointer();
+#ifdef ITK_USE_TBB
+    case MultiThreaderBase::ThreaderEnum::TBB:
+      return TBBMultiThreader::New().GetPointer();
+#endif
+    default:
+      return PoolMultiThreader::New().GetPointer();
+  }
+
+} // end CreateMultiThreader()
+
+} // end namespace itk
+
+#endif // end #ifndef itkCreateMultiThreader_h
@@ -0,0 +1,193 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkGaussianShrinkImageFilter_h
+#define itkGaussianShrinkImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkContinuousIndex.h"
+#include "itkFixedArray.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class GaussianShrinkImageFilter
+ * \brief Smooth an image with a Gaussian and sample it on a coarser grid, in a single filter
+ *
+ * This filter gives the same result as smoothing the input with a Gaussian, followed
+ * by resampling the smoothed image on the output grid. It does not compute the
+ * smoothed image at full resolution, though: the Gaussian is applied separably, one
+ * dimension at a time, and in each dimension it is only evaluated at the (continuous)
+ * positions of the output samples. So, every pass reduces the image along one
+ * dimension, and the intermediate images are already smaller than the input. The
+ * lines of each pass are distributed over the threads.
+ *
+ * The Gaussian is sampled, truncated at KernelRadiusInSigmas standard deviations,
+ * and normalized over the part of the kernel that lies inside the image. Along a
+ * dimension with a sigma of zero, the input is linearly interpolated.
+ *
+ * The sigmas are given in physical units, like for the SmoothingRecursiveGaussianImageFilter.
+ * The output grid is set like for the ResampleImageFilter, but the output direction
+ * is always the direction of the input, because the filter works along the image axes.
+ *
+ * \sa GenericMultiResolutionPyramidImageFilter
+ * \ingroup ImageFilters
+ */
+template <class TInputImage, class TOutputImage, class TPrecisionType = double>
+class ITK_TEMPLATE_EXPORT GaussianShrinkImageFilter : public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef GaussianShrinkImageFilter                     Self;
+  typedef ImageToImageFilter<TInputImage, TOutputImage> Superclass;
+  typedef SmartPointer<Self>                            Pointer;
+  typedef SmartPointer<const Self>                      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(GaussianShrinkImageFilter, ImageToImageFilter);
+
+  /** Number of dimensions. */
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  /** Typedefs for the images. */
+  typedef TInputImage                                           InputImageType;
+  typedef TOutputImage                                          OutputImageType;
+  typedef typename OutputImageType::RegionType                  OutputImageRegionType;
+  typedef typename OutputImageType::PixelType                   OutputPixelType;
+  typedef typename OutputImageType::SizeType                    SizeType;
+  typedef typename OutputImageType::IndexType                   IndexType;
+  typedef typename OutputImageType::SpacingType                 SpacingType;
+  typedef typename OutputImageType::PointType                   OriginPointType;
+  typedef ImageBase<Self::ImageDimension>                       ImageBaseType;
+  typedef FixedArray<TPrecisionType, Self::ImageDimension>      SigmaArrayType;
+  typedef typename NumericTraits<OutputPixelType>::FloatType    InternalPixelType;
+  typedef Image<InternalPixelType, Self::ImageDimension>        InternalImageType;
+  typedef typename InternalImageType::Pointer                   InternalImagePointer;
+  typedef typename IndexType::IndexValueType                    IndexValueType;
+  typedef typename SizeType::SizeValueType                      SizeValueType;
+  typedef ContinuousIndex<TPrecisionType, Self::ImageDimension> ContinuousIndexType;
+
+  /** Set/Get the standard deviations of the Gaussian, in physical units. */
+  itkSetMacro(SigmaArray, SigmaArrayType);
+  itkGetConstReferenceMacro(SigmaArray, SigmaArrayType);
+
+  /** Set/Get the radius of the Gaussian kernel, in standard deviations. Default 4. */
+  itkSetMacro(KernelRadiusInSigmas, double);
+  itkGetConstMacro(KernelRadiusInSigmas, double);
+
+  /** Set/Get the size of the output image. */
+  itkSetMacro(Size, SizeType);
+  itkGetConstReferenceMacro(Size, SizeType);
+
+  /** Set/Get the start index of the output largest possible region. */
+  itkSetMacro(OutputStartIndex, IndexType);
+  itkGetConstReferenceMacro(OutputStartIndex, IndexType);
+
+  /** Set/Get the output image spacing. */
+  itkSetMacro(OutputSpacing, SpacingType);
+  itkGetConstReferenceMacro(OutputSpacing, SpacingType);
+
+  /** Set/Get the output image origin. */
+  itkSetMacro(OutputOrigin, OriginPointType);
+  itkGetConstReferenceMacro(OutputOrigin, OriginPointType);
+
+  /** Helper method to set the output parameters based on this image. */
+  void
+  SetOutputParametersFromImage(const ImageBaseType * image);
+
+  /** Sets the output grid. */
+  void
+  GenerateOutputInformation(void) override;
+
+  /** Requests the largest possible region of the input. */
+  void
+  GenerateInputRequestedRegion(void) override;
+
+  /** The passes work on complete lines, so the whole output is generated. */
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+protected:
+  GaussianShrinkImageFilter();
+  ~GaussianShrinkImageFilter() override = default;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** Smooths and shrinks the input, one dimension at a time. */
+  void
+  GenerateData(void) override;
+
+private:
+  GaussianShrinkImageFilter(const Self &) = delete;
+  void
+  operator=(const Self &) = delete;
+
+  /** The weights of the input samples for each output sample along a dimension:
+   * output sample i is the sum over k < m_NumberOfWeights[i] of
+   * m_Weights[m_WeightOffsets[i] + k] times input sample m_FirstInputIndex[i] + k.
+   */
+  struct KernelWeightsType
+  {
+    std::vector<IndexValueType> m_FirstInputIndex;
+    std::vector<unsigned int>   m_NumberOfWeights;
+    std::vector<std::size_t>    m_WeightOffsets;
+    std::vector<TPrecisionType> m_Weights;
+  };
+
+  /** Computes the kernel weights along a dimension, for output samples at the
+   * continuous input indices start + i * step.
+   */
+  KernelWeightsType
+  ComputeKernelWeights(const unsigned int   dim,
+                       const TPrecisionType start,
+                       const TPrecisionType step,
+                       const IndexValueType inputStartIndex,
+                       const SizeValueType  inputSize,
+                       const SizeValueType  outputSize) const;
+
+  /** Smooths and shrinks an image along one dimension. The region of the output
+   * image equals that of the input image, except along this dimension.
+   */
+  template <class TPassInputImage, class TPassOutputImage>
+  void
+  SmoothAndShrinkAlongDimension(const TPassInputImage *   input,
+                                TPassOutputImage *        output,
+                                const unsigned int        dim,
+                                const KernelWeightsType & kernelWeights);
+
+  /** Member variables. */
+  SigmaArrayType  m_SigmaArray;
+  double          m_KernelRadiusInSigmas{ 4.0 };
+  SizeType        m_Size;
+  IndexType       m_OutputStartIndex;
+  SpacingType     m_OutputSpacing;
+  OriginPointType m_OutputOrigin;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkGaussianShrinkImageFilter.hxx"
+#endif
+
+#endif // end #ifndef itkGaussianShrinkImageFilter_h
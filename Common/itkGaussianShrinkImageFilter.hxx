@@ -0,0 +1,358 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkGaussianShrinkImageFilter_hxx
+#define itkGaussianShrinkImageFilter_hxx
+
+#include "itkGaussianShrinkImageFilter.h"
+
+#include "itkImageRegionConstIteratorWithOnlyIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace itk
+{
+
+/**
+ * Constructor
+ */
+template <class TInputImage, class TOutputImage, class TPrecisionType>
+GaussianShrinkImageFilter<TInputImage, TOutputImage, TPrecisionType>::GaussianShrinkImageFilter()
+{
+  this->m_SigmaArray.Fill(0.0);
+  this->m_Size.Fill(0);
+  this->m_OutputStartIndex.Fill(0);
+  this->m_OutputSpacing.Fill(1.0);
+  this->m_OutputOrigin.Fill(0.0);
+
+} // end Constructor
+
+
+/**
+ * Print out a description of self
+ */
+template <class TInputImage, class TOutputImage, class TPrecisionType>
+void
+GaussianShrinkImageFilter<TInputImage, TOutputImage, TPrecisionType>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "SigmaArray: " << this->m_SigmaArray << std::endl;
+  os << indent << "KernelRadiusInSigmas: " << this->m_KernelRadiusInSigmas << std::endl;
+  os << indent << "Size: " << this->m_Size << std::endl;
+  os << indent << "OutputStartIndex: " << this->m_OutputStartIndex << std::endl;
+  os << indent << "OutputSpacing: " << this->m_OutputSpacing << std::endl;
+  os << indent << "OutputOrigin: " << this->m_OutputOrigin << std::endl;
+
+} // end PrintSelf()
+
+
+/** Helper method to set the output parameters based on this image */
+template <class TInputImage, class TOutputImage, class TPrecisionType>
+void
+GaussianShrinkImageFilter<TInputImage, TOutputImage, TPrecisionType>::SetOutputParametersFromImage(
+  const ImageBaseType * image)
+{
+  if (!image)
+  {
+    itkExceptionMacro(<< "Cannot use a null image reference");
+  }
+
+  this->SetOutputOrigin(image->GetOrigin());
+  this->SetOutputSpacing(image->GetSpacing());
+  this->SetOutputStartIndex(image->GetLargestPossibleRegion().GetIndex());
+  this->SetSize(image->GetLargestPossibleRegion().GetSize());
+
+} // end SetOutputParametersFromImage()
+
+
+/**
+ * Inform pipeline of required output region
+ */
+template <class TInputImage, class TOutputImage, class TPrecisionType>
+void
+GaussianShrinkImageFilter<TInputImage, TOutputImage, TPrecisionType>::GenerateOutputInformation(void)
+{
+  // call the superclass' implementation of this method
+  Superclass::GenerateOutputInformation();
+
+  OutputImageType *      outputPtr = this->GetOutput();
+  const InputImageType * inputPtr = this->GetInput();
+  if (!outputPtr || !inputPtr)
+  {
+    return;
+  }
+
+  OutputImageRegionType outputLargestPossibleRegion;
+  outputLargestPossibleRegion.SetSize(this->m_Size);
+  outputLargestPossibleRegion.SetIndex(this->m_OutputStartIndex);
+
+  // The filter works along the image axes, so the output has the direction of the input.
+  outputPtr->SetLargestPossibleRegion(outputLargestPossibleRegion);
+  outputPtr->SetSpacing(this->m_OutputSpacing);
+  outputPtr->SetOrigin(this->m_OutputOrigin);
+  outputPtr->SetDirection(inputPtr->GetDirection());
+
+} // end GenerateOutputInformation()
+
+
+/**
+ * Request the whole input, since the kernels may reach any part of it.
+ */
+template <class TInputImage, class TOutputImage, class TPrecisionType>
+void
+GaussianShrinkImageFilter<TInputImage, TOutputImage, TPrecisionType>::GenerateInputRequestedRegion(void)
+{
+  // call the superclass' implementation of this method
+  Superclass::GenerateInputRequestedRegion();
+
+  auto * inputPtr = const_cast<InputImageType *>(this->GetInput());
+  if (inputPtr)
+  {
+    inputPtr->SetRequestedRegionToLargestPossibleRegion();
+  }
+
+} // end GenerateInputRequestedRegion()
+
+
+/**
+ * Generate the whole output.
+ */
+template <class TInputImage, class TOutputImage, class TPrecisionType>
+void
+GaussianShrinkImageFilter<TInputImage, TOutputImage, TPrecisionType>::EnlargeOutputRequestedRegion(DataObject * output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+
+} // end EnlargeOutputRequestedRegion()
+
+
+/**
+ * Compute the kernel weights of the output samples along a dimension.
+ */
+template <class TInputImage, class TOutputImage, class TPrecisionType>
+auto
+GaussianShrinkImageFilter<TInputImage, TOutputImage, TPrecisionType>::ComputeKernelWeights(
+  const unsigned int   dim,
+  const TPrecisionType start,
+  const TPrecisionType step,
+  const IndexValueType inputStartIndex,
+  const SizeValueType  inputSize,
+  const SizeValueType  outputSize) const -> KernelWeightsType
+{
+  const IndexValueType firstIndex = inputStartIndex;
+  const IndexValueType lastIndex = inputStartIndex + static_cast<IndexValueType>(inputSize) - 1;
+
+  /** The standard deviation in voxels of the input, and the kernel radius. */
+  const TPrecisionType sigma = this->m_SigmaArray[dim] / this->GetInput()->GetSpacing()[dim];
+  const auto           radius = static_cast<IndexValueType>(std::ceil(this->m_KernelRadiusInSigmas * sigma));
+
+  KernelWeightsType kernelWeights;
+  kernelWeights.m_FirstInputIndex.resize(outputSize);
+  kernelWeights.m_NumberOfWeights.resize(outputSize);
+  kernelWeights.m_WeightOffsets.resize(outputSize);
+  kernelWeights.m_Weights.reserve(outputSize * static_cast<std::size_t>(2 * radius + 2));
+
+  for (SizeValueType i = 0; i < outputSize; ++i)
+  {
+    const TPrecisionType center = start + static_cast<TPrecisionType>(i) * step;
+    const auto           floorCenter = static_cast<IndexValueType>(std::floor(center));
+
+    IndexValueType first, last;
+    if (sigma > 0.0)
+    {
+      first = std::max(floorCenter - radius + 1, firstIndex);
+      last = std::min(floorCenter + radius, lastIndex);
+    }
+    else
+    {
+      /** Linear interpolation. */
+      first = std::max(floorCenter, firstIndex);
+      last = std::min(floorCenter + 1, lastIndex);
+    }
+
+    /** Outside the image, take the nearest border voxel. */
+    if (first > last)
+    {
+      first = last = std::min(std::max(floorCenter, firstIndex), lastIndex);
+    }
+
+    kernelWeights.m_FirstInputIndex[i] = first;
+    kernelWeights.m_NumberOfWeights[i] = static_cast<unsigned int>(last - first + 1);
+    kernelWeights.m_WeightOffsets[i] = kernelWeights.m_Weights.size();
+
+    TPrecisionType sum = 0.0;
+    for (IndexValueType j = first; j <= last; ++j)
+    {
+      const TPrecisionType distance = static_cast<TPrecisionType>(j) - center;
+      const TPrecisionType weight = sigma > 0.0 ? std::exp(-0.5 * distance * distance / (sigma * sigma))
+                                                : std::max<TPrecisionType>(1.0 - std::abs(distance), 0.0);
+      kernelWeights.m_Weights.push_back(weight);
+      sum += weight;
+    }
+
+    /** Normalize over the part of the kernel inside the image. */
+    const std::size_t offset = kernelWeights.m_WeightOffsets[i];
+    for (unsigned int k = 0; k < kernelWeights.m_NumberOfWeights[i]; ++k)
+    {
+      kernelWeights.m_Weights[offset + k] = sum > 0.0 ? kernelWeights.m_Weights[offset + k] / sum : 1.0;
+    }
+  }
+
+  return kernelWeights;
+
+} // end ComputeKernelWeights()
+
+
+/**
+ * Smooth and shrink an image along one dimension.
+ */
+template <class TInputImage, class TOutputImage, class TPrecisionType>
+template <class TPassInputImage, class TPassOutputImage>
+void
+GaussianShrinkImageFilter<TInputImage, TOutputImage, TPrecisionType>::SmoothAndShrinkAlongDimension(
+  const TPassInputImage *   input,
+  TPassOutputImage *        output,
+  const unsigned int        dim,
+  const KernelWeightsType & kernelWeights)
+{
+  typedef typename TPassOutputImage::PixelType PassOutputPixelType;
+
+  const auto &          inputRegion = input->GetBufferedRegion();
+  const auto &          outputRegion = output->GetBufferedRegion();
+  const IndexValueType  inputStart = inputRegion.GetIndex(dim);
+  const SizeValueType   outputSize = outputRegion.GetSize(dim);
+  const OffsetValueType inputStride = input->GetOffsetTable()[dim];
+  const OffsetValueType outputStride = output->GetOffsetTable()[dim];
+
+  /** The first voxel of each line of the output. */
+  OutputImageRegionType lineRegion = outputRegion;
+  lineRegion.SetSize(dim, 1);
+
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  multiThreader->template ParallelizeImageRegion<ImageDimension>(
+    lineRegion,
+    [input, output, dim, inputStart, outputSize, inputStride, outputStride, &kernelWeights](
+      const OutputImageRegionType & regionForThread) {
+      ImageRegionConstIteratorWithOnlyIndex<TPassOutputImage> it(output, regionForThread);
+      for (; !it.IsAtEnd(); ++it)
+      {
+        /** Apart from this dimension, the input and output share their indices. */
+        IndexType inputIndex = it.GetIndex();
+        inputIndex[dim] = inputStart;
+        const auto * inputLine = input->GetBufferPointer() + input->ComputeOffset(inputIndex);
+        auto *       outputLine = output->GetBufferPointer() + output->ComputeOffset(it.GetIndex());
+
+        for (SizeValueType i = 0; i < outputSize; ++i)
+        {
+          const OffsetValueType  firstOffset = (kernelWeights.m_FirstInputIndex[i] - inputStart) * inputStride;
+          const auto *           inputSample = inputLine + firstOffset;
+          const TPrecisionType * weights = kernelWeights.m_Weights.data() + kernelWeights.m_WeightOffsets[i];
+
+          TPrecisionType value = 0.0;
+          for (unsigned int k = 0; k < kernelWeights.m_NumberOfWeights[i]; ++k)
+          {
+            value += weights[k] * static_cast<TPrecisionType>(inputSample[k * inputStride]);
+          }
+          outputLine[i * outputStride] = static_cast<PassOutputPixelType>(value);
+        }
+      }
+    },
+    nullptr);
+
+} // end SmoothAndShrinkAlongDimension()
+
+
+/**
+ * GenerateData
+ */
+template <class TInputImage, class TOutputImage, class TPrecisionType>
+void
+GaussianShrinkImageFilter<TInputImage, TOutputImage, TPrecisionType>::GenerateData(void)
+{
+  const InputImageType * input = this->GetInput();
+  OutputImageType *      output = this->GetOutput();
+
+  /** The continuous input index of the first output voxel. Input and output
+   * share the direction, so the grids map onto each other per dimension.
+   */
+  typename OutputImageType::PointType startPoint;
+  ContinuousIndexType                 startIndex;
+  output->TransformIndexToPhysicalPoint(this->m_OutputStartIndex, startPoint);
+  input->TransformPhysicalPointToContinuousIndex(startPoint, startIndex);
+
+  /** Region of the image after each pass: dimensions up to and including the
+   * current one have the output size, the others still have the input size.
+   */
+  const OutputImageRegionType & outputRegion = output->GetLargestPossibleRegion();
+  OutputImageRegionType         passRegion = input->GetBufferedRegion();
+
+  this->AllocateOutputs();
+
+  InternalImagePointer intermediate;
+  for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+  {
+    const TPrecisionType    step = this->m_OutputSpacing[dim] / input->GetSpacing()[dim];
+    const KernelWeightsType kernelWeights = this->ComputeKernelWeights(dim,
+                                                                       startIndex[dim],
+                                                                       step,
+                                                                       passRegion.GetIndex(dim),
+                                                                       passRegion.GetSize(dim),
+                                                                       outputRegion.GetSize(dim));
+    passRegion.SetIndex(dim, outputRegion.GetIndex(dim));
+    passRegion.SetSize(dim, outputRegion.GetSize(dim));
+
+    /** The last pass writes into the output, the others into a smaller intermediate image. */
+    InternalImagePointer passOutput;
+    if (dim + 1 < ImageDimension)
+    {
+      passOutput = InternalImageType::New();
+      passOutput->SetRegions(passRegion);
+      passOutput->Allocate();
+    }
+
+    if (dim == 0 && passOutput)
+    {
+      this->SmoothAndShrinkAlongDimension(input, passOutput.GetPointer(), dim, kernelWeights);
+    }
+    else if (dim == 0)
+    {
+      this->SmoothAndShrinkAlongDimension(input, output, dim, kernelWeights);
+    }
+    else if (passOutput)
+    {
+      this->SmoothAndShrinkAlongDimension(intermediate.GetPointer(), passOutput.GetPointer(), dim, kernelWeights);
+    }
+    else
+    {
+      this->SmoothAndShrinkAlongDimension(intermediate.GetPointer(), output, dim, kernelWeights);
+    }
+
+    /** Release the previous intermediate image. */
+    intermediate = passOutput;
+    this->UpdateProgress(static_cast<float>(dim + 1) / static_cast<float>(ImageDimension));
+  }
+
+} // end GenerateData()
+
+
+} // end namespace itk
+
+#endif // end #ifndef itkGaussianShrinkImageFilter_hxx
@@ -20,6 +20,9 @@
 
 #include "itkMultiResolutionPyramidImageFilter.h"
 #include "itkSmoothingRecursiveGaussianImageFilter.h"
+#include "itkGaussianShrinkImageFilter.h"
+
+#include <future>
 
 namespace itk
 {
@@ -98,6 +101,16 @@ namespace itk
  * compute only single level of the pyramid via SetCurrentLevel() and
  * SetComputeOnlyForCurrentLevel() methods.
  *
+ * With SetPrefetchNextLevel(), the next level is then computed in a background
+ * thread, directly after the current level, so that it is available without
+ * delay when the current level is increased.
+ *
+ * With SetUseGaussianShrinkImageFilter(), levels that are both smoothed and
+ * rescaled are computed by the GaussianShrinkImageFilter instead, which
+ * smooths and samples the output grid in one filter, without computing the
+ * smoothed image at full resolution. Its kernel is a truncated Gaussian
+ * instead of the recursive approximation, so the images differ slightly.
+ *
  * \author Denis P. Shamonin and Marius Staring. Division of Image Processing,
  * Department of Radiology, Leiden, The Netherlands
  *
@@ -223,6 +236,26 @@ public:
   itkGetConstMacro(ComputeOnlyForCurrentLevel, bool);
   itkBooleanMacro(ComputeOnlyForCurrentLevel);
 
+  /** Set/Get whether the next level is computed in the background, while the
+   * current level is in use. Only used when ComputeOnlyForCurrentLevel is on.
+   */
+  itkSetMacro(PrefetchNextLevel, bool);
+  itkGetConstMacro(PrefetchNextLevel, bool);
+  itkBooleanMacro(PrefetchNextLevel);
+
+  /** Get the number of levels that were prefetched and then grafted onto the
+   * output, rather than computed again because the settings had changed.
+   */
+  itkGetConstMacro(NumberOfPrefetchedLevelsUsed, SizeValueType);
+
+  /** Set/Get whether levels that are smoothed and rescaled are computed by
+   * the GaussianShrinkImageFilter, instead of a smoother followed by a
+   * shrinker or resampler. Default false.
+   */
+  itkSetMacro(UseGaussianShrinkImageFilter, bool);
+  itkGetConstMacro(UseGaussianShrinkImageFilter, bool);
+  itkBooleanMacro(UseGaussianShrinkImageFilter);
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro(SameDimensionCheck, (Concept::SameDimension<ImageDimension, OutputImageDimension>));
@@ -286,11 +319,30 @@ private:
   typedef ImageToImageFilter<OutputImageType, OutputImageType> ImageToImageFilterSameTypes;
   typedef ImageToImageFilter<InputImageType, OutputImageType>  ImageToImageFilterDifferentTypes;
 
+  /** Typedef for the filter that smooths and rescales at once. */
+  typedef GaussianShrinkImageFilter<InputImageType, OutputImageType, ScalarRealType> GaussianShrinkerType;
+
+  /** The settings with which the image of a level is computed. A level that is
+   * computed in the background gets its own copy, so that the background thread
+   * does not read the schedules of this filter while they may be changed.
+   */
+  struct LevelSettingsType
+  {
+    SigmaArrayType         SigmaArray;
+    RescaleFactorArrayType ShrinkFactors;
+    bool                   UseShrinkImageFilter;
+    bool                   UseGaussianShrinkImageFilter;
+  };
+
+  /** Get the current settings for the level. */
+  LevelSettingsType
+  GetLevelSettings(const unsigned int level) const;
+
   /** Smooth image at current level. Returns true if performed.
    * This method does not perform execution.
    */
   bool
-  SetupSmoother(const unsigned int               level,
+  SetupSmoother(const SigmaArrayType &           sigmaArray,
                 typename SmootherType::Pointer & smoother,
                 const InputImageConstPointer &   input);
 
@@ -298,7 +350,7 @@ private:
    * 0 otherwise. This method does not perform execution.
    */
   int
-  SetupShrinkerOrResampler(const unsigned int                                   level,
+  SetupShrinkerOrResampler(const LevelSettingsType &                            settings,
                            typename SmootherType::Pointer &                     smoother,
                            const bool                                           sameType,
                            const InputImageConstPointer &                       input,
@@ -306,10 +358,34 @@ private:
                            typename ImageToImageFilterSameTypes::Pointer &      rescaleSameTypes,
                            typename ImageToImageFilterDifferentTypes::Pointer & rescaleDifferentTypes);
 
+  /** Computes the image of a level into outputPtr, which should be allocated.
+   * The outputs of this filter are not touched, so that this method can also
+   * compute a level in the background.
+   */
+  void
+  GenerateLevel(const LevelSettingsType &                            settings,
+                const InputImageConstPointer &                       input,
+                const OutputImagePointer &                           outputPtr,
+                typename SmootherType::Pointer &                     smoother,
+                typename ImageToImageFilterSameTypes::Pointer &      rescaleSameTypes,
+                typename ImageToImageFilterDifferentTypes::Pointer & rescaleDifferentTypes);
+
+  /** Starts computing the image of a level in a background thread. */
+  void
+  PrefetchLevel(const unsigned int level, const InputImageConstPointer & input);
+
+  /** Grafts the prefetched image of a level onto outputPtr, after waiting for it.
+   * Returns false if there is no prefetched image that is still up to date.
+   */
+  bool
+  GraftPrefetchedLevel(const unsigned int             level,
+                       const InputImageConstPointer & input,
+                       const OutputImagePointer &     outputPtr);
+
   /** Defines Shrink or Resample filters. */
   void
   DefineShrinkerOrResampler(const bool                                           sameType,
-                            const RescaleFactorArrayType &                       shrinkFactors,
+                            const LevelSettingsType &                            settings,
                             const OutputImagePointer &                           outputPtr,
                             typename ImageToImageFilterSameTypes::Pointer &      rescaleSameTypes,
                             typename ImageToImageFilterDifferentTypes::Pointer & rescaleDifferentTypes);
@@ -363,6 +439,21 @@ private:
   GenericMultiResolutionPyramidImageFilter(const Self &) = delete;
   void
   operator=(const Self &) = delete;
+
+  bool m_UseGaussianShrinkImageFilter{ false };
+
+  /** The settings with which the prefetched level was computed. */
+  bool                   m_PrefetchNextLevel{ false };
+  unsigned int           m_PrefetchedLevel{ 0 };
+  const InputImageType * m_PrefetchedInput{ nullptr };
+  LevelSettingsType      m_PrefetchedSettings{};
+  TimeStamp              m_PrefetchTimeStamp;
+  SizeValueType          m_NumberOfPrefetchedLevelsUsed{ 0 };
+
+  /** The image of the prefetched level. Declared last, so that the destructor
+   * first waits for the background thread to finish.
+   */
+  std::future<OutputImagePointer> m_PrefetchedImage;
 };
 
 } // namespace itk
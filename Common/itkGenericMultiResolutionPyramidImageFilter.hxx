@@ -30,19 +30,16 @@ namespace // anonymous namespace
  * ******************* UpdateAndGraft ***********************
  */
 
-template <class GenericMultiResolutionPyramidImageFilterType, class ImageToImageFilterType, typename OutputImageType>
+template <class ImageToImageFilterType, typename OutputImageType>
 void
-UpdateAndGraft(typename GenericMultiResolutionPyramidImageFilterType::Pointer thisFilter,
-               typename ImageToImageFilterType::Pointer &                     filter,
-               OutputImageType *                                              outImage,
-               const unsigned int                                             ilevel)
+UpdateAndGraft(typename ImageToImageFilterType::Pointer & filter, OutputImageType * outImage)
 {
   filter->GraftOutput(outImage);
 
   // force to always update in case shrink factors are the same
   filter->Modified();
   filter->UpdateLargestPossibleRegion();
-  thisFilter->GraftNthOutput(ilevel, filter->GetOutput());
+  outImage->Graft(filter->GetOutput());
 } // end UpdateAndGraft()
 
 
@@ -319,7 +316,8 @@ GenericMultiResolutionPyramidImageFilter<TInputImage, TOutputImage, TPrecisionTy
     return; // We are done, return
   }
 
-  // First check if smoothing schedule has been set
+  // First check if smoothing schedule has been set. A level that is computed in
+  // the background does not read the schedule, but a copy of its settings.
   if (!this->m_SmoothingScheduleDefined)
   {
     this->SetSmoothingScheduleToDefault();
@@ -338,45 +336,201 @@ GenericMultiResolutionPyramidImageFilter<TInputImage, TOutputImage, TPrecisionTy
 
     if (this->ComputeForCurrentLevel(level))
     {
-      // Allocate memory for each output
+      // Use the level that was computed in the background, if available
       OutputImagePointer outputPtr = this->GetOutput(level);
+      if (this->m_ComputeOnlyForCurrentLevel && this->GraftPrefetchedLevel(level, input, outputPtr))
+      {
+        continue;
+      }
+
+      // Allocate memory for each output
       outputPtr->SetBufferedRegion(outputPtr->GetRequestedRegion());
       outputPtr->Allocate();
 
-      // Setup the smoother
-      const bool smootherIsUsed = this->SetupSmoother(level, smoother, input);
-
-      // Setup the shrinker or resampler
-      const int shrinkerOrResamplerIsUsed = this->SetupShrinkerOrResampler(
-        level, smoother, smootherIsUsed, input, outputPtr, rescaleSameTypes, rescaleDifferentTypes);
-
-      // Update the pipeline and graft or copy results to this filters output
-      if (shrinkerOrResamplerIsUsed == 0 && smootherIsUsed)
-      {
-        UpdateAndGraft<Self, SmootherType, OutputImageType>(this, smoother, outputPtr, level);
-      }
-      else if (shrinkerOrResamplerIsUsed == 0)
-      {
-        ImageAlgorithm::Copy(input.GetPointer(),
-                             outputPtr.GetPointer(),
-                             input->GetLargestPossibleRegion(),
-                             outputPtr->GetLargestPossibleRegion());
-      }
-      else if (shrinkerOrResamplerIsUsed == 1)
-      {
-        UpdateAndGraft<Self, ImageToImageFilterSameTypes, OutputImageType>(this, rescaleSameTypes, outputPtr, level);
-      }
-      else if (shrinkerOrResamplerIsUsed == 2)
-      {
-        UpdateAndGraft<Self, ImageToImageFilterDifferentTypes, OutputImageType>(
-          this, rescaleDifferentTypes, outputPtr, level);
-      }
-      // no else needed
+      // Compute the level and graft or copy results to this filters output
+      this->GenerateLevel(
+        this->GetLevelSettings(level), input, outputPtr, smoother, rescaleSameTypes, rescaleDifferentTypes);
     }
   } // end for ilevel
+
+  // Start computing the next level, while the current level is in use
+  if (this->m_ComputeOnlyForCurrentLevel && this->m_PrefetchNextLevel &&
+      this->m_CurrentLevel + 1 < this->m_NumberOfLevels)
+  {
+    this->PrefetchLevel(this->m_CurrentLevel + 1, input);
+  }
 } // end GenerateData()
 
 
+/**
+ * ******************* GenerateLevel ***********************
+ */
+
+template <class TInputImage, class TOutputImage, class TPrecisionType>
+void
+GenericMultiResolutionPyramidImageFilter<TInputImage, TOutputImage, TPrecisionType>::GenerateLevel(
+  const LevelSettingsType &                            settings,
+  const InputImageConstPointer &                       input,
+  const OutputImagePointer &                           outputPtr,
+  typename SmootherType::Pointer &                     smoother,
+  typename ImageToImageFilterSameTypes::Pointer &      rescaleSameTypes,
+  typename ImageToImageFilterDifferentTypes::Pointer & rescaleDifferentTypes)
+{
+  // Smooth and rescale in a single filter, if requested and both are needed
+  if (settings.UseGaussianShrinkImageFilter)
+  {
+    if (!this->AreSigmasAllZeros(settings.SigmaArray) && !this->AreRescaleFactorsAllOnes(settings.ShrinkFactors))
+    {
+      // The filter samples the grid of outputPtr, also when UseShrinkImageFilter is on
+      typename GaussianShrinkerType::Pointer gaussianShrinker = GaussianShrinkerType::New();
+      gaussianShrinker->SetInput(input);
+      gaussianShrinker->SetSigmaArray(settings.SigmaArray);
+      gaussianShrinker->SetOutputParametersFromImage(outputPtr);
+      UpdateAndGraft<GaussianShrinkerType, OutputImageType>(gaussianShrinker, outputPtr);
+      return;
+    }
+  }
+
+  // Setup the smoother
+  const bool smootherIsUsed = this->SetupSmoother(settings.SigmaArray, smoother, input);
+
+  // Setup the shrinker or resampler
+  const int shrinkerOrResamplerIsUsed = this->SetupShrinkerOrResampler(
+    settings, smoother, smootherIsUsed, input, outputPtr, rescaleSameTypes, rescaleDifferentTypes);
+
+  // Update the pipeline and graft or copy results to the output
+  if (shrinkerOrResamplerIsUsed == 0 && smootherIsUsed)
+  {
+    UpdateAndGraft<SmootherType, OutputImageType>(smoother, outputPtr);
+  }
+  else if (shrinkerOrResamplerIsUsed == 0)
+  {
+    ImageAlgorithm::Copy(input.GetPointer(),
+                         outputPtr.GetPointer(),
+                         input->GetLargestPossibleRegion(),
+                         outputPtr->GetLargestPossibleRegion());
+  }
+  else if (shrinkerOrResamplerIsUsed == 1)
+  {
+    UpdateAndGraft<ImageToImageFilterSameTypes, OutputImageType>(rescaleSameTypes, outputPtr);
+  }
+  else if (shrinkerOrResamplerIsUsed == 2)
+  {
+    UpdateAndGraft<ImageToImageFilterDifferentTypes, OutputImageType>(rescaleDifferentTypes, outputPtr);
+  }
+  // no else needed
+} // end GenerateLevel()
+
+
+/**
+ * ******************* PrefetchLevel ***********************
+ */
+
+template <class TInputImage, class TOutputImage, class TPrecisionType>
+void
+GenericMultiResolutionPyramidImageFilter<TInputImage, TOutputImage, TPrecisionType>::PrefetchLevel(
+  const unsigned int             level,
+  const InputImageConstPointer & input)
+{
+  // Wait for a previous prefetch, which is not used anymore
+  this->m_PrefetchedImage = std::future<OutputImagePointer>();
+
+  // The level is computed on a graft of the input, so that the background
+  // thread does not update the pipeline of the input
+  InputImagePointer localInput = InputImageType::New();
+  localInput->Graft(input.GetPointer());
+
+  // The image of the level gets the output information of this filter
+  OutputImagePointer levelImage = OutputImageType::New();
+  levelImage->CopyInformation(this->GetOutput(level));
+  levelImage->SetRegions(this->GetOutput(level)->GetLargestPossibleRegion());
+
+  // Store the settings with which the level is computed
+  this->m_PrefetchedLevel = level;
+  this->m_PrefetchedInput = input.GetPointer();
+  this->m_PrefetchedSettings = this->GetLevelSettings(level);
+  this->m_PrefetchTimeStamp.Modified();
+
+  // Compute the level in a background thread, with its own filters and a copy of the settings
+  const LevelSettingsType settings = this->m_PrefetchedSettings;
+  this->m_PrefetchedImage = std::async(std::launch::async, [this, settings, localInput, levelImage]() {
+    typename SmootherType::Pointer                     smoother;
+    typename ImageToImageFilterSameTypes::Pointer      rescaleSameTypes;
+    typename ImageToImageFilterDifferentTypes::Pointer rescaleDifferentTypes;
+
+    const InputImageConstPointer levelInput = localInput.GetPointer();
+
+    levelImage->Allocate();
+    this->GenerateLevel(settings, levelInput, levelImage, smoother, rescaleSameTypes, rescaleDifferentTypes);
+    return levelImage;
+  });
+} // end PrefetchLevel()
+
+
+/**
+ * ******************* GraftPrefetchedLevel ***********************
+ */
+
+template <class TInputImage, class TOutputImage, class TPrecisionType>
+bool
+GenericMultiResolutionPyramidImageFilter<TInputImage, TOutputImage, TPrecisionType>::GraftPrefetchedLevel(
+  const unsigned int             level,
+  const InputImageConstPointer & input,
+  const OutputImagePointer &     outputPtr)
+{
+  if (!this->m_PrefetchedImage.valid())
+  {
+    return false;
+  }
+  if (level != this->m_PrefetchedLevel)
+  {
+    this->m_PrefetchedImage = std::future<OutputImagePointer>();
+    return false;
+  }
+
+  // Wait for the background thread. This rethrows its exceptions.
+  const OutputImagePointer prefetchedImage = this->m_PrefetchedImage.get();
+
+  // Check that the input and the settings did not change in the meantime
+  const LevelSettingsType settings = this->GetLevelSettings(level);
+  const ModifiedTimeType  prefetchTime = this->m_PrefetchTimeStamp.GetMTime();
+  if (input.GetPointer() != this->m_PrefetchedInput || input->GetMTime() > prefetchTime ||
+      input->GetUpdateMTime() > prefetchTime || settings.SigmaArray != this->m_PrefetchedSettings.SigmaArray ||
+      settings.ShrinkFactors != this->m_PrefetchedSettings.ShrinkFactors ||
+      settings.UseShrinkImageFilter != this->m_PrefetchedSettings.UseShrinkImageFilter ||
+      settings.UseGaussianShrinkImageFilter != this->m_PrefetchedSettings.UseGaussianShrinkImageFilter ||
+      prefetchedImage->GetLargestPossibleRegion() != outputPtr->GetLargestPossibleRegion() ||
+      prefetchedImage->GetSpacing() != outputPtr->GetSpacing() ||
+      prefetchedImage->GetOrigin() != outputPtr->GetOrigin() ||
+      prefetchedImage->GetDirection() != outputPtr->GetDirection())
+  {
+    return false;
+  }
+
+  outputPtr->Graft(prefetchedImage);
+  ++this->m_NumberOfPrefetchedLevelsUsed;
+  return true;
+} // end GraftPrefetchedLevel()
+
+
+/**
+ * ******************* GetLevelSettings ***********************
+ */
+
+template <class TInputImage, class TOutputImage, class TPrecisionType>
+auto
+GenericMultiResolutionPyramidImageFilter<TInputImage, TOutputImage, TPrecisionType>::GetLevelSettings(
+  const unsigned int level) const -> LevelSettingsType
+{
+  LevelSettingsType settings;
+  this->GetSigma(level, settings.SigmaArray);
+  this->GetShrinkFactors(level, settings.ShrinkFactors);
+  settings.UseShrinkImageFilter = this->GetUseShrinkImageFilter();
+  settings.UseGaussianShrinkImageFilter = this->m_UseGaussianShrinkImageFilter;
+  return settings;
+} // end GetLevelSettings()
+
+
 /**
  * ******************* SetupSmoother ***********************
  */
@@ -384,12 +538,10 @@ GenericMultiResolutionPyramidImageFilter<TInputImage, TOutputImage, TPrecisionTy
 template <class TInputImage, class TOutputImage, class TPrecisionType>
 bool
 GenericMultiResolutionPyramidImageFilter<TInputImage, TOutputImage, TPrecisionType>::SetupSmoother(
-  const unsigned int               level,
+  const SigmaArrayType &           sigmaArray,
   typename SmootherType::Pointer & smoother,
   const InputImageConstPointer &   input)
 {
-  SigmaArrayType sigmaArray;
-  this->GetSigma(level, sigmaArray);
   const bool sigmasAllZeros = this->AreSigmasAllZeros(sigmaArray);
   if (!sigmasAllZeros)
   {
@@ -415,7 +567,7 @@ GenericMultiResolutionPyramidImageFilter<TInputImage, TOutputImage, TPrecisionTy
 template <class TInputImage, class TOutputImage, class TPrecisionType>
 int
 GenericMultiResolutionPyramidImageFilter<TInputImage, TOutputImage, TPrecisionType>::SetupShrinkerOrResampler(
-  const unsigned int                                   level,
+  const LevelSettingsType &                            settings,
   typename SmootherType::Pointer &                     smoother,
   const bool                                           sameType,
   const InputImageConstPointer &                       inputPtr,
@@ -423,9 +575,7 @@ GenericMultiResolutionPyramidImageFilter<TInputImage, TOutputImage, TPrecisionTy
   typename ImageToImageFilterSameTypes::Pointer &      rescaleSameTypes,
   typename ImageToImageFilterDifferentTypes::Pointer & rescaleDifferentTypes)
 {
-  RescaleFactorArrayType shrinkFactors;
-  this->GetShrinkFactors(level, shrinkFactors);
-  const bool rescaleFactorsAllOnes = this->AreRescaleFactorsAllOnes(shrinkFactors);
+  const bool rescaleFactorsAllOnes = this->AreRescaleFactorsAllOnes(settings.ShrinkFactors);
 
   // No shrinking or resampling needed: return 0
   if (rescaleFactorsAllOnes)
@@ -434,7 +584,7 @@ GenericMultiResolutionPyramidImageFilter<TInputImage, TOutputImage, TPrecisionTy
   }
 
   // Choose between shrinker or resampler
-  this->DefineShrinkerOrResampler(sameType, shrinkFactors, outputPtr, rescaleSameTypes, rescaleDifferentTypes);
+  this->DefineShrinkerOrResampler(sameType, settings, outputPtr, rescaleSameTypes, rescaleDifferentTypes);
 
   // Rescaling is done with input and output type being equal: return 1
   // Input and output are equal only if the smoother was used previously.
@@ -460,7 +610,7 @@ template <class TInputImage, class TOutputImage, class TPrecisionType>
 void
 GenericMultiResolutionPyramidImageFilter<TInputImage, TOutputImage, TPrecisionType>::DefineShrinkerOrResampler(
   const bool                                           sameType,
-  const RescaleFactorArrayType &                       shrinkFactors,
+  const LevelSettingsType &                            settings,
   const OutputImagePointer &                           outputPtr,
   typename ImageToImageFilterSameTypes::Pointer &      rescaleSameTypes,
   typename ImageToImageFilterDifferentTypes::Pointer & rescaleDifferentTypes)
@@ -483,11 +633,11 @@ GenericMultiResolutionPyramidImageFilter<TInputImage, TOutputImage, TPrecisionTy
     // A pipeline version that newly constructs the required filters:
     if (rescaleSameTypes.IsNull())
     {
-      if (this->GetUseShrinkImageFilter())
+      if (settings.UseShrinkImageFilter)
       {
         // Define and setup shrinker
         auto shrinker = ShrinkerSameType::New();
-        shrinker->SetShrinkFactors(shrinkFactors);
+        shrinker->SetShrinkFactors(settings.ShrinkFactors);
 
         // Assign
         rescaleSameTypes = shrinker.GetPointer();
@@ -514,11 +664,11 @@ GenericMultiResolutionPyramidImageFilter<TInputImage, TOutputImage, TPrecisionTy
     // A pipeline version that re-uses previously constructed filters:
     else
     {
-      if (this->GetUseShrinkImageFilter())
+      if (settings.UseShrinkImageFilter)
       {
         // Setup shrinker
         typename ShrinkerSameType::Pointer shrinker = dynamic_cast<ShrinkerSameType *>(rescaleSameTypes.GetPointer());
-        shrinker->SetShrinkFactors(shrinkFactors);
+        shrinker->SetShrinkFactors(settings.ShrinkFactors);
       }
       else
       {
@@ -539,11 +689,11 @@ GenericMultiResolutionPyramidImageFilter<TInputImage, TOutputImage, TPrecisionTy
   // A pipeline version that newly constructs the required filters:
   if (rescaleDifferentTypes.IsNull())
   {
-    if (this->GetUseShrinkImageFilter())
+    if (settings.UseShrinkImageFilter)
     {
       // Define and setup shrinker
       auto shrinker = ShrinkerDifferentType::New();
-      shrinker->SetShrinkFactors(shrinkFactors);
+      shrinker->SetShrinkFactors(settings.ShrinkFactors);
 
       // Assign
       rescaleDifferentTypes = shrinker.GetPointer();
@@ -570,11 +720,11 @@ GenericMultiResolutionPyramidImageFilter<TInputImage, TOutputImage, TPrecisionTy
   // A pipeline version that re-uses previously constructed filters:
   else
   {
-    if (this->GetUseShrinkImageFilter())
+    if (settings.UseShrinkImageFilter)
     {
       typename ShrinkerDifferentType::Pointer shrinker =
         dynamic_cast<ShrinkerDifferentType *>(rescaleDifferentTypes.GetPointer());
-      shrinker->SetShrinkFactors(shrinkFactors);
+      shrinker->SetShrinkFactors(settings.ShrinkFactors);
     }
     else
     {
@@ -910,6 +1060,10 @@ GenericMultiResolutionPyramidImageFilter<TInputImage, TOutputImage, TPrecisionTy
   os << indent << "CurrentLevel: " << this->m_CurrentLevel << std::endl;
   os << indent << "ComputeOnlyForCurrentLevel: " << (this->m_ComputeOnlyForCurrentLevel ? "true" : "false")
      << std::endl;
+  os << indent << "PrefetchNextLevel: " << (this->m_PrefetchNextLevel ? "true" : "false") << std::endl;
+  os << indent << "NumberOfPrefetchedLevelsUsed: " << this->m_NumberOfPrefetchedLevelsUsed << std::endl;
+  os << indent << "UseGaussianShrinkImageFilter: " << (this->m_UseGaussianShrinkImageFilter ? "true" : "false")
+     << std::endl;
   os << indent << "SmoothingScheduleDefined: " << (this->m_SmoothingScheduleDefined ? "true" : "false") << std::endl;
   os << indent << "Smoothing Schedule: ";
   if (this->m_SmoothingSchedule.empty())
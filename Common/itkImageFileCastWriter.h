@@ -103,7 +103,14 @@ private:
 
     localInputImage->Graft(static_cast<const ScalarInputImageType *>(inputImage));
 
+    /** Only cast the region that is written, which is a slab of the image
+     * when the writing is streamed. */
+    typename DiskImageType::RegionType ioRegion;
+    ImageIORegionAdaptor<InputImageDimension>::Convert(
+      this->GetImageIO()->GetIORegion(), ioRegion, localInputImage->GetLargestPossibleRegion().GetIndex());
+
     caster->SetInput(localInputImage);
+    caster->GetOutput()->SetRequestedRegion(ioRegion);
     caster->Update();
 
     /** return the pixel buffer of the casted image */
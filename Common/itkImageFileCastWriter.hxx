@@ -160,9 +160,9 @@ ImageFileCastWriter<TInputImage>::GenerateData(void)
   }
   else
   {
-    /** No casting needed or possible, just write */
-    const void * dataPtr = input->GetBufferPointer();
-    this->GetModifiableImageIO()->Write(dataPtr);
+    /** No casting needed or possible, just write. The superclass also handles
+     * a buffered region that is larger than the streamed region. */
+    Superclass::GenerateData();
   }
 }
 
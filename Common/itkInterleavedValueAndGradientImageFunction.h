@@ -0,0 +1,142 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkInterleavedValueAndGradientImageFunction_h
+#define itkInterleavedValueAndGradientImageFunction_h
+
+#include "itkObject.h"
+#include "itkImage.h"
+#include "itkFixedArray.h"
+#include "itkContinuousIndex.h"
+#include "itkCovariantVector.h"
+#include "itkMath.h"
+
+namespace itk
+{
+/** \class InterleavedValueAndGradientImageFunction
+ * \brief Returns the nearest neighbor value and central difference gradient
+ * of an image from a single interleaved cache.
+ *
+ * The AdvancedImageToImageMetric reads the moving image value through the
+ * interpolator, and the central difference gradient from a separate gradient
+ * image, when no B-spline or linear interpolator is used. Each sample then
+ * touches two separate memory regions. This class stores the value and the
+ * ImageDimension gradient components of each voxel next to each other, in a
+ * float image, so that both are obtained with a single fetch.
+ *
+ * The cache is computed by SetInputImage(), typically once per resolution.
+ * The gradient is computed with the GradientImageFilter, taking the image
+ * spacing and direction into account, as done by the metric.
+ *
+ * \sa AdvancedImageToImageMetric, NearestNeighborInterpolateImageFunction
+ * \ingroup ImageFunctions
+ */
+template <class TInputImage, class TCoordRep = double>
+class ITK_TEMPLATE_EXPORT InterleavedValueAndGradientImageFunction : public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef InterleavedValueAndGradientImageFunction Self;
+  typedef Object                                   Superclass;
+  typedef SmartPointer<Self>                       Pointer;
+  typedef SmartPointer<const Self>                 ConstPointer;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(InterleavedValueAndGradientImageFunction, Object);
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Dimension underlying input image. */
+  itkStaticConstMacro(ImageDimension, unsigned int, TInputImage::ImageDimension);
+
+  /** Typedefs for the input image. */
+  typedef TInputImage                                      InputImageType;
+  typedef typename InputImageType::IndexType               IndexType;
+  typedef typename IndexType::IndexValueType               IndexValueType;
+  typedef ContinuousIndex<TCoordRep, Self::ImageDimension> ContinuousIndexType;
+
+  /** Output typedefs, compatible with the AdvancedImageToImageMetric. */
+  typedef double                                            OutputType;
+  typedef CovariantVector<OutputType, Self::ImageDimension> CovariantVectorType;
+
+  /** Typedefs for the interleaved cache: the value, followed by the gradient. */
+  typedef float                                                CacheValueType;
+  typedef FixedArray<CacheValueType, Self::ImageDimension + 1> CachePixelType;
+  typedef Image<CachePixelType, Self::ImageDimension>          CacheImageType;
+  typedef typename CacheImageType::Pointer                     CacheImagePointer;
+
+  /** Set the input image, and compute the interleaved cache. */
+  virtual void
+  SetInputImage(const InputImageType * inputImage);
+
+  /** Get the interleaved cache. */
+  itkGetConstObjectMacro(CacheImage, CacheImageType);
+
+  /** Release the memory of the cache. */
+  void
+  ReleaseCache(void)
+  {
+    this->m_CacheImage = nullptr;
+  }
+
+  /** Method to compute both the value and the derivative at the nearest voxel.
+   * Assumes that the nearest voxel is inside the buffer.
+   */
+  inline void
+  EvaluateValueAndDerivativeAtContinuousIndex(const ContinuousIndexType & x,
+                                              OutputType &                value,
+                                              CovariantVectorType &       deriv) const
+  {
+    IndexType index;
+    for (unsigned int j = 0; j < ImageDimension; ++j)
+    {
+      index[j] = static_cast<IndexValueType>(Math::Round<double>(x[j]));
+    }
+
+    const CachePixelType & pixel = this->m_CacheImage->GetBufferPointer()[this->m_CacheImage->ComputeOffset(index)];
+    value = static_cast<OutputType>(pixel[0]);
+    for (unsigned int j = 0; j < ImageDimension; ++j)
+    {
+      deriv[j] = static_cast<OutputType>(pixel[j + 1]);
+    }
+  }
+
+
+protected:
+  InterleavedValueAndGradientImageFunction() = default;
+  ~InterleavedValueAndGradientImageFunction() override = default;
+
+  /** Print Self information. */
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  InterleavedValueAndGradientImageFunction(const Self &) = delete;
+  void
+  operator=(const Self &) = delete;
+
+  CacheImagePointer m_CacheImage{ nullptr };
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkInterleavedValueAndGradientImageFunction.hxx"
+#endif
+
+#endif // end #ifndef itkInterleavedValueAndGradientImageFunction_h
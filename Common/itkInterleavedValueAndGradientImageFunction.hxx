@@ -0,0 +1,96 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkInterleavedValueAndGradientImageFunction_hxx
+#define itkInterleavedValueAndGradientImageFunction_hxx
+
+#include "itkInterleavedValueAndGradientImageFunction.h"
+
+#include "itkGradientImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+
+namespace itk
+{
+
+/**
+ * ***************** SetInputImage ***********************
+ */
+
+template <class TInputImage, class TCoordRep>
+void
+InterleavedValueAndGradientImageFunction<TInputImage, TCoordRep>::SetInputImage(const InputImageType * inputImage)
+{
+  if (inputImage == nullptr)
+  {
+    this->ReleaseCache();
+    return;
+  }
+
+  /** Compute the central difference gradient, as done by the metric. */
+  typedef GradientImageFilter<InputImageType, OutputType, OutputType> GradientFilterType;
+  typedef typename GradientFilterType::OutputImageType                GradientImageType;
+
+  auto gradientFilter = GradientFilterType::New();
+  gradientFilter->SetUseImageSpacing(true);
+  gradientFilter->SetInput(inputImage);
+  gradientFilter->Update();
+  const GradientImageType * gradientImage = gradientFilter->GetOutput();
+
+  /** Allocate the cache with the geometry of the input image. */
+  this->m_CacheImage = CacheImageType::New();
+  this->m_CacheImage->CopyInformation(inputImage);
+  this->m_CacheImage->SetRegions(inputImage->GetBufferedRegion());
+  this->m_CacheImage->Allocate();
+
+  /** Interleave the values and the gradients. */
+  ImageRegionConstIterator<InputImageType>    valueIt(inputImage, inputImage->GetBufferedRegion());
+  ImageRegionConstIterator<GradientImageType> gradientIt(gradientImage, inputImage->GetBufferedRegion());
+  ImageRegionIterator<CacheImageType>         cacheIt(this->m_CacheImage, inputImage->GetBufferedRegion());
+  for (; !cacheIt.IsAtEnd(); ++valueIt, ++gradientIt, ++cacheIt)
+  {
+    CachePixelType &                              pixel = cacheIt.Value();
+    const typename GradientImageType::PixelType & gradient = gradientIt.Value();
+    pixel[0] = static_cast<CacheValueType>(valueIt.Get());
+    for (unsigned int j = 0; j < ImageDimension; ++j)
+    {
+      pixel[j + 1] = static_cast<CacheValueType>(gradient[j]);
+    }
+  }
+
+  this->Modified();
+
+} // end SetInputImage()
+
+
+/**
+ * ***************** PrintSelf ***********************
+ */
+
+template <class TInputImage, class TCoordRep>
+void
+InterleavedValueAndGradientImageFunction<TInputImage, TCoordRep>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "CacheImage: " << this->m_CacheImage.GetPointer() << std::endl;
+
+} // end PrintSelf()
+
+
+} // end namespace itk
+
+#endif // end #ifndef itkInterleavedValueAndGradientImageFunction_hxx
@@ -0,0 +1,201 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkMultiImageResampleImageFilter_h
+#define itkMultiImageResampleImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkInterpolateImageFunction.h"
+#include "itkTransform.h"
+
+#include <vector>
+
+namespace itk
+{
+
+/** \class MultiImageResampleImageFilter
+ * \brief Resample several images with the same transform, in a single pass
+ *
+ * Like the ResampleImageFilter, this filter maps each output voxel through
+ * the transform, and interpolates the input image at the mapped point. It
+ * does so for a number of input images at once: the transform is evaluated
+ * only once per output voxel, after which every input image is interpolated,
+ * each with its own interpolator. Output i is the resampled input i. So,
+ * label images can use a nearest neighbor interpolator, while intensity
+ * images use a B-spline interpolator.
+ *
+ * The input images may have different grids; they all share the output grid
+ * of this filter, which is set like for the ResampleImageFilter. Output
+ * voxels that are mapped outside an input image get the DefaultPixelValue.
+ *
+ * Usage: call SetNumberOfImages() first, then SetInput(i, image) and
+ * SetInterpolator(i, interpolator) for each image.
+ *
+ * \ingroup GeometricTransforms
+ */
+template <class TInputImage, class TOutputImage, class TInterpolatorPrecisionType = double>
+class ITK_TEMPLATE_EXPORT MultiImageResampleImageFilter : public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef MultiImageResampleImageFilter                 Self;
+  typedef ImageToImageFilter<TInputImage, TOutputImage> Superclass;
+  typedef SmartPointer<Self>                            Pointer;
+  typedef SmartPointer<const Self>                      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MultiImageResampleImageFilter, ImageToImageFilter);
+
+  /** Number of dimensions. */
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  /** Typedefs for the images. */
+  typedef TInputImage                             InputImageType;
+  typedef TOutputImage                            OutputImageType;
+  typedef typename OutputImageType::Pointer       OutputImagePointer;
+  typedef typename OutputImageType::RegionType    OutputImageRegionType;
+  typedef typename OutputImageType::PixelType     PixelType;
+  typedef typename OutputImageType::SizeType      SizeType;
+  typedef typename OutputImageType::IndexType     IndexType;
+  typedef typename OutputImageType::SpacingType   SpacingType;
+  typedef typename OutputImageType::PointType     OriginPointType;
+  typedef typename OutputImageType::DirectionType DirectionType;
+  typedef ImageBase<Self::ImageDimension>         ImageBaseType;
+
+  /** Typedefs for the transform and the interpolators. */
+  typedef Transform<TInterpolatorPrecisionType, Self::ImageDimension, Self::ImageDimension> TransformType;
+  typedef typename TransformType::ConstPointer                                              TransformPointerType;
+  typedef InterpolateImageFunction<InputImageType, TInterpolatorPrecisionType>              InterpolatorType;
+  typedef typename InterpolatorType::Pointer                                                InterpolatorPointerType;
+  typedef typename InterpolatorType::OutputType                                             InterpolatorOutputType;
+  typedef typename InterpolatorType::ContinuousIndexType                                    ContinuousIndexType;
+  typedef typename TransformType::InputPointType                                            PointType;
+
+  /** Set the number of images that are resampled. This creates the outputs. */
+  virtual void
+  SetNumberOfImages(unsigned int numberOfImages);
+
+  /** Get the number of images that are resampled. */
+  virtual unsigned int
+  GetNumberOfImages(void) const;
+
+  /** Set the interpolator of input image i. */
+  virtual void
+  SetInterpolator(unsigned int i, InterpolatorType * interpolator);
+
+  /** Get the interpolator of input image i. */
+  virtual InterpolatorType *
+  GetInterpolator(unsigned int i) const;
+
+  /** Set the coordinate transformation, which maps the output grid to the input images. */
+  itkSetConstObjectMacro(Transform, TransformType);
+
+  /** Get a pointer to the coordinate transform. */
+  itkGetConstObjectMacro(Transform, TransformType);
+
+  /** Set/Get the pixel value when a transformed pixel is outside of the image. */
+  itkSetMacro(DefaultPixelValue, PixelType);
+  itkGetConstReferenceMacro(DefaultPixelValue, PixelType);
+
+  /** Set/Get the size of the output images. */
+  itkSetMacro(Size, SizeType);
+  itkGetConstReferenceMacro(Size, SizeType);
+
+  /** Set/Get the start index of the output largest possible region. */
+  itkSetMacro(OutputStartIndex, IndexType);
+  itkGetConstReferenceMacro(OutputStartIndex, IndexType);
+
+  /** Set/Get the output image spacing. */
+  itkSetMacro(OutputSpacing, SpacingType);
+  itkGetConstReferenceMacro(OutputSpacing, SpacingType);
+
+  /** Set/Get the output image origin. */
+  itkSetMacro(OutputOrigin, OriginPointType);
+  itkGetConstReferenceMacro(OutputOrigin, OriginPointType);
+
+  /** Set/Get the output direction cosine matrix. */
+  itkSetMacro(OutputDirection, DirectionType);
+  itkGetConstReferenceMacro(OutputDirection, DirectionType);
+
+  /** Helper method to set the output parameters based on this image */
+  void
+  SetOutputParametersFromImage(const ImageBaseType * image);
+
+  /** Sets the output information of all outputs. */
+  void
+  GenerateOutputInformation(void) override;
+
+  /** Requests the largest possible region of all inputs. */
+  void
+  GenerateInputRequestedRegion(void) override;
+
+  /** Checks the transform and the interpolators, and connects the
+   * interpolators to the input images.
+   */
+  void
+  BeforeThreadedGenerateData(void) override;
+
+  /** Compute the Modified Time based on changes to the components. */
+  ModifiedTimeType
+  GetMTime(void) const override;
+
+protected:
+  MultiImageResampleImageFilter();
+  ~MultiImageResampleImageFilter() override = default;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** Resamples all images at the voxels of the output region of a thread. */
+  void
+  ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId) override;
+
+  /** The input images may have different grids, so they do not have to occupy the same physical space. */
+  void
+  VerifyInputInformation(void) ITKv5_CONST override
+  {}
+
+private:
+  MultiImageResampleImageFilter(const Self &) = delete;
+  void
+  operator=(const Self &) = delete;
+
+  /** Cast the interpolated value to the output pixel type, with clamping. */
+  static PixelType
+  CastPixelWithBoundsChecking(const InterpolatorOutputType value);
+
+  /** Member variables. */
+  TransformPointerType                 m_Transform;
+  std::vector<InterpolatorPointerType> m_Interpolators;
+  PixelType                            m_DefaultPixelValue{};
+  SizeType                             m_Size;
+  IndexType                            m_OutputStartIndex;
+  SpacingType                          m_OutputSpacing;
+  OriginPointType                      m_OutputOrigin;
+  DirectionType                        m_OutputDirection;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkMultiImageResampleImageFilter.hxx"
+#endif
+
+#endif // end #ifndef itkMultiImageResampleImageFilter_h
@@ -0,0 +1,361 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkMultiImageResampleImageFilter_hxx
+#define itkMultiImageResampleImageFilter_hxx
+
+#include "itkMultiImageResampleImageFilter.h"
+
+#include "itkProgressReporter.h"
+#include "itkImageRegionConstIteratorWithOnlyIndex.h"
+#include "itkImageRegionIterator.h"
+
+#include <algorithm>
+
+namespace itk
+{
+
+/**
+ * Constructor
+ */
+template <class TInputImage, class TOutputImage, class TInterpolatorPrecisionType>
+MultiImageResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionType>::MultiImageResampleImageFilter()
+{
+  this->m_Size.Fill(0);
+  this->m_OutputStartIndex.Fill(0);
+  this->m_OutputSpacing.Fill(1.0);
+  this->m_OutputOrigin.Fill(0.0);
+  this->m_OutputDirection.SetIdentity();
+
+  // Use the classic (ITK4) threading model, to ensure ThreadedGenerateData is being called.
+  this->DynamicMultiThreadingOff();
+
+} // end Constructor
+
+
+/**
+ * Print out a description of self
+ */
+template <class TInputImage, class TOutputImage, class TInterpolatorPrecisionType>
+void
+MultiImageResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionType>::PrintSelf(std::ostream & os,
+                                                                                                Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "NumberOfImages: " << this->m_Interpolators.size() << std::endl;
+  os << indent << "DefaultPixelValue: "
+     << static_cast<typename NumericTraits<PixelType>::PrintType>(this->m_DefaultPixelValue) << std::endl;
+  os << indent << "Size: " << this->m_Size << std::endl;
+  os << indent << "OutputStartIndex: " << this->m_OutputStartIndex << std::endl;
+  os << indent << "OutputSpacing: " << this->m_OutputSpacing << std::endl;
+  os << indent << "OutputOrigin: " << this->m_OutputOrigin << std::endl;
+  os << indent << "OutputDirection: " << this->m_OutputDirection << std::endl;
+  os << indent << "Transform: " << this->m_Transform.GetPointer() << std::endl;
+
+} // end PrintSelf()
+
+
+/**
+ * Set the number of images, and create the outputs.
+ */
+template <class TInputImage, class TOutputImage, class TInterpolatorPrecisionType>
+void
+MultiImageResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionType>::SetNumberOfImages(
+  unsigned int numberOfImages)
+{
+  if (numberOfImages == this->m_Interpolators.size())
+  {
+    return;
+  }
+
+  this->m_Interpolators.resize(numberOfImages);
+  this->SetNumberOfRequiredInputs(numberOfImages);
+  this->SetNumberOfRequiredOutputs(numberOfImages);
+  for (unsigned int i = 0; i < numberOfImages; ++i)
+  {
+    if (this->ProcessObject::GetOutput(i) == nullptr)
+    {
+      this->SetNthOutput(i, this->MakeOutput(i));
+    }
+  }
+  this->Modified();
+
+} // end SetNumberOfImages()
+
+
+/**
+ * Get the number of images.
+ */
+template <class TInputImage, class TOutputImage, class TInterpolatorPrecisionType>
+unsigned int
+MultiImageResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionType>::GetNumberOfImages(void) const
+{
+  return static_cast<unsigned int>(this->m_Interpolators.size());
+}
+
+
+/**
+ * Set the interpolator of an image.
+ */
+template <class TInputImage, class TOutputImage, class TInterpolatorPrecisionType>
+void
+MultiImageResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionType>::SetInterpolator(
+  unsigned int       i,
+  InterpolatorType * interpolator)
+{
+  if (i >= this->m_Interpolators.size())
+  {
+    itkExceptionMacro(<< "Interpolator " << i << " does not exist, the number of images is "
+                      << this->m_Interpolators.size());
+  }
+
+  if (this->m_Interpolators[i] != interpolator)
+  {
+    this->m_Interpolators[i] = interpolator;
+    this->Modified();
+  }
+
+} // end SetInterpolator()
+
+
+/**
+ * Get the interpolator of an image.
+ */
+template <class TInputImage, class TOutputImage, class TInterpolatorPrecisionType>
+auto
+MultiImageResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionType>::GetInterpolator(
+  unsigned int i) const -> InterpolatorType *
+{
+  return i < this->m_Interpolators.size() ? this->m_Interpolators[i].GetPointer() : nullptr;
+}
+
+
+/** Helper method to set the output parameters based on this image */
+template <class TInputImage, class TOutputImage, class TInterpolatorPrecisionType>
+void
+MultiImageResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionType>::SetOutputParametersFromImage(
+  const ImageBaseType * image)
+{
+  if (!image)
+  {
+    itkExceptionMacro(<< "Cannot use a null image reference");
+  }
+
+  this->SetOutputOrigin(image->GetOrigin());
+  this->SetOutputSpacing(image->GetSpacing());
+  this->SetOutputDirection(image->GetDirection());
+  this->SetOutputStartIndex(image->GetLargestPossibleRegion().GetIndex());
+  this->SetSize(image->GetLargestPossibleRegion().GetSize());
+
+} // end SetOutputParametersFromImage()
+
+
+/**
+ * Cast the interpolated value to the output pixel type, with clamping.
+ */
+template <class TInputImage, class TOutputImage, class TInterpolatorPrecisionType>
+auto
+MultiImageResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionType>::CastPixelWithBoundsChecking(
+  const InterpolatorOutputType value) -> PixelType
+{
+  const InterpolatorOutputType minValue = NumericTraits<PixelType>::NonpositiveMin();
+  const InterpolatorOutputType maxValue = NumericTraits<PixelType>::max();
+
+  if (value < minValue)
+  {
+    return NumericTraits<PixelType>::NonpositiveMin();
+  }
+  if (value > maxValue)
+  {
+    return NumericTraits<PixelType>::max();
+  }
+  return static_cast<PixelType>(value);
+
+} // end CastPixelWithBoundsChecking()
+
+
+/**
+ * Connect the interpolators to the input images.
+ */
+template <class TInputImage, class TOutputImage, class TInterpolatorPrecisionType>
+void
+MultiImageResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionType>::BeforeThreadedGenerateData(
+  void)
+{
+  if (!this->m_Transform)
+  {
+    itkExceptionMacro(<< "Transform not set");
+  }
+
+  for (unsigned int i = 0; i < this->m_Interpolators.size(); ++i)
+  {
+    if (!this->m_Interpolators[i])
+    {
+      itkExceptionMacro(<< "Interpolator " << i << " not set");
+    }
+    this->m_Interpolators[i]->SetInputImage(this->GetInput(i));
+  }
+
+} // end BeforeThreadedGenerateData()
+
+
+/**
+ * ThreadedGenerateData
+ */
+template <class TInputImage, class TOutputImage, class TInterpolatorPrecisionType>
+void
+MultiImageResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionType>::ThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType                  threadId)
+{
+  const unsigned int numberOfImages = this->m_Interpolators.size();
+  if (numberOfImages == 0)
+  {
+    return;
+  }
+
+  // Get the inputs, the interpolators and the iterators over the outputs, which
+  // all walk the output region for this thread in the same order.
+  std::vector<const InputImageType *>            inputs(numberOfImages);
+  std::vector<const InterpolatorType *>          interpolators(numberOfImages);
+  std::vector<ImageRegionIterator<TOutputImage>> outputIterators;
+  outputIterators.reserve(numberOfImages);
+  for (unsigned int i = 0; i < numberOfImages; ++i)
+  {
+    inputs[i] = this->GetInput(i);
+    interpolators[i] = this->m_Interpolators[i].GetPointer();
+    outputIterators.emplace_back(this->GetOutput(i), outputRegionForThread);
+  }
+
+  const OutputImageType *                                outputPtr = this->GetOutput(0);
+  ImageRegionConstIteratorWithOnlyIndex<OutputImageType> it(outputPtr, outputRegionForThread);
+
+  // Support for progress methods/callbacks
+  ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  PointType           outputPoint;
+  ContinuousIndexType inputIndex;
+
+  // Walk the output region
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    // Map the output voxel to the inputs, only once.
+    outputPtr->TransformIndexToPhysicalPoint(it.GetIndex(), outputPoint);
+    const PointType inputPoint = this->m_Transform->TransformPoint(outputPoint);
+
+    // Interpolate all inputs at the mapped point.
+    for (unsigned int i = 0; i < numberOfImages; ++i)
+    {
+      PixelType  value = this->m_DefaultPixelValue;
+      const bool isInside = inputs[i]->TransformPhysicalPointToContinuousIndex(inputPoint, inputIndex);
+      if (isInside && interpolators[i]->IsInsideBuffer(inputIndex))
+      {
+        value = CastPixelWithBoundsChecking(interpolators[i]->EvaluateAtContinuousIndex(inputIndex));
+      }
+      outputIterators[i].Set(value);
+      ++outputIterators[i];
+    }
+
+    // Update progress
+    progress.CompletedPixel();
+  }
+
+} // end ThreadedGenerateData()
+
+
+/**
+ * Inform pipeline of required output region
+ */
+template <class TInputImage, class TOutputImage, class TInterpolatorPrecisionType>
+void
+MultiImageResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionType>::GenerateOutputInformation(void)
+{
+  // call the superclass' implementation of this method
+  Superclass::GenerateOutputInformation();
+
+  // all outputs share the output grid
+  OutputImageRegionType outputLargestPossibleRegion;
+  outputLargestPossibleRegion.SetSize(this->m_Size);
+  outputLargestPossibleRegion.SetIndex(this->m_OutputStartIndex);
+
+  for (unsigned int i = 0; i < this->GetNumberOfIndexedOutputs(); ++i)
+  {
+    OutputImageType * outputPtr = this->GetOutput(i);
+    if (outputPtr)
+    {
+      outputPtr->SetLargestPossibleRegion(outputLargestPossibleRegion);
+      outputPtr->SetSpacing(this->m_OutputSpacing);
+      outputPtr->SetOrigin(this->m_OutputOrigin);
+      outputPtr->SetDirection(this->m_OutputDirection);
+    }
+  }
+
+} // end GenerateOutputInformation()
+
+
+/**
+ * Request the whole inputs, since any part of them may be needed.
+ */
+template <class TInputImage, class TOutputImage, class TInterpolatorPrecisionType>
+void
+MultiImageResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionType>::GenerateInputRequestedRegion(
+  void)
+{
+  // call the superclass' implementation of this method
+  Superclass::GenerateInputRequestedRegion();
+
+  for (unsigned int i = 0; i < this->GetNumberOfIndexedInputs(); ++i)
+  {
+    auto * inputPtr = const_cast<InputImageType *>(this->GetInput(i));
+    if (inputPtr)
+    {
+      inputPtr->SetRequestedRegionToLargestPossibleRegion();
+    }
+  }
+
+} // end GenerateInputRequestedRegion()
+
+
+/**
+ * Verify if any of the components has been modified.
+ */
+template <class TInputImage, class TOutputImage, class TInterpolatorPrecisionType>
+ModifiedTimeType
+MultiImageResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionType>::GetMTime(void) const
+{
+  ModifiedTimeType latestTime = Object::GetMTime();
+
+  if (this->m_Transform)
+  {
+    latestTime = std::max(latestTime, this->m_Transform->GetMTime());
+  }
+  for (const auto & interpolator : this->m_Interpolators)
+  {
+    if (interpolator)
+    {
+      latestTime = std::max(latestTime, interpolator->GetMTime());
+    }
+  }
+
+  return latestTime;
+} // end GetMTime()
+
+
+} // end namespace itk
+
+#endif // end #ifndef itkMultiImageResampleImageFilter_hxx
@@ -0,0 +1,169 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkRecursiveBSplineInterpolateImageFunction_h
+#define itkRecursiveBSplineInterpolateImageFunction_h
+
+#include "itkBSplineInterpolateImageFunction.h"
+#include "itkRecursiveBSplineInterpolationWeightFunction.h"
+
+#include <tuple>
+
+namespace itk
+{
+/** \class RecursiveBSplineInterpolateImageFunction
+ * \brief B-spline image interpolator with a compile-time specialized
+ * implementation of the value and gradient.
+ *
+ * The BSplineInterpolateImageFunction evaluates the B-spline weights and
+ * the coefficients with run-time loops over the spline order and the image
+ * dimension, and stores the support indices and weights in matrices. This
+ * class uses the same template-recursive implementation as the
+ * RecursiveBSplineTransform instead: the weights are computed per dimension
+ * with the RecursiveBSplineInterpolationWeightFunction, after which the
+ * RecursiveBSplineTransformImplementation computes the value and all
+ * derivatives in a single pass over the coefficients, with loops that are
+ * unrolled at compile-time.
+ *
+ * The specialized implementation is used for spline order 1 to 3, when the
+ * support region of the point is inside the coefficient image. Otherwise, so
+ * for the other spline orders, and near the border where mirror boundary
+ * conditions are needed, the implementation of the superclass is used.
+ *
+ * \sa BSplineInterpolateImageFunction, RecursiveBSplineTransform
+ * \ingroup ImageFunctions ImageInterpolators
+ */
+template <class TImageType, class TCoordRep = double, class TCoefficientType = double>
+class ITK_TEMPLATE_EXPORT RecursiveBSplineInterpolateImageFunction
+  : public BSplineInterpolateImageFunction<TImageType, TCoordRep, TCoefficientType>
+{
+public:
+  /** Standard class typedefs. */
+  typedef RecursiveBSplineInterpolateImageFunction                                  Self;
+  typedef BSplineInterpolateImageFunction<TImageType, TCoordRep, TCoefficientType> Superclass;
+  typedef SmartPointer<Self>                                                        Pointer;
+  typedef SmartPointer<const Self>                                                  ConstPointer;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(RecursiveBSplineInterpolateImageFunction, BSplineInterpolateImageFunction);
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Dimension underlying input image. */
+  itkStaticConstMacro(ImageDimension, unsigned int, Superclass::ImageDimension);
+
+  /** Typedefs inherited from the superclass. */
+  using typename Superclass::OutputType;
+  using typename Superclass::InputImageType;
+  using typename Superclass::IndexType;
+  using typename Superclass::ContinuousIndexType;
+  using typename Superclass::CovariantVectorType;
+  using typename Superclass::CoefficientImageType;
+  typedef typename IndexType::IndexValueType IndexValueType;
+
+  /** The superclass overloads that are not specialized. */
+  using Superclass::EvaluateAtContinuousIndex;
+  using Superclass::EvaluateValueAndDerivativeAtContinuousIndex;
+
+  /** Evaluate the function at a ContinuousIndex position. */
+  OutputType
+  EvaluateAtContinuousIndex(const ContinuousIndexType & x) const override;
+
+  /** Method to compute both the value and the derivative at a ContinuousIndex position. */
+  void
+  EvaluateValueAndDerivativeAtContinuousIndex(const ContinuousIndexType & x,
+                                              OutputType &                value,
+                                              CovariantVectorType &       deriv) const
+  {
+    this->EvaluateValueAndDerivativeWithOptionalThreadId(x, value, deriv);
+  }
+
+
+  /** Method to compute both the value and the derivative at a ContinuousIndex position.
+   * The threadId is only used by the implementation of the superclass.
+   */
+  void
+  EvaluateValueAndDerivativeAtContinuousIndex(const ContinuousIndexType & x,
+                                              OutputType &                value,
+                                              CovariantVectorType &       deriv,
+                                              ThreadIdType                threadId) const
+  {
+    this->EvaluateValueAndDerivativeWithOptionalThreadId(x, value, deriv, threadId);
+  }
+
+
+protected:
+  RecursiveBSplineInterpolateImageFunction();
+  ~RecursiveBSplineInterpolateImageFunction() override = default;
+
+  /** Print Self information. */
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  RecursiveBSplineInterpolateImageFunction(const Self &) = delete;
+  void
+  operator=(const Self &) = delete;
+
+  /** Typedefs for the weight functions of the specialized spline orders. */
+  template <unsigned int VSplineOrder>
+  using WeightFunctionType = RecursiveBSplineInterpolationWeightFunction<TCoordRep, ImageDimension, VSplineOrder>;
+  typedef std::tuple<typename WeightFunctionType<1>::Pointer,
+                     typename WeightFunctionType<2>::Pointer,
+                     typename WeightFunctionType<3>::Pointer>
+    WeightFunctionsType;
+
+  /** Dispatches the run-time spline order to the specialized implementation,
+   * and falls back to the superclass when that is not possible.
+   */
+  template <typename... TOptionalThreadId>
+  void
+  EvaluateValueAndDerivativeWithOptionalThreadId(const ContinuousIndexType & x,
+                                                 OutputType &                value,
+                                                 CovariantVectorType &       deriv,
+                                                 const TOptionalThreadId... optionalThreadId) const;
+
+  /** Computes the 1D weights of the support region of x. Returns false when
+   * the support region is not entirely inside the coefficient image.
+   */
+  template <unsigned int VSplineOrder>
+  bool
+  ComputeSupport(const ContinuousIndexType & x, double * weights1D, IndexType & supportIndex) const;
+
+  /** The specialized implementations. They return false when the superclass should be used. */
+  template <unsigned int VSplineOrder>
+  bool
+  EvaluateRecursive(const ContinuousIndexType & x, OutputType & value) const;
+
+  template <unsigned int VSplineOrder>
+  bool
+  EvaluateValueAndDerivativeRecursive(const ContinuousIndexType & x,
+                                      OutputType &                value,
+                                      CovariantVectorType &       deriv) const;
+
+  /** The weight functions for spline order 1, 2 and 3. */
+  WeightFunctionsType m_WeightFunctions;
+};
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkRecursiveBSplineInterpolateImageFunction.hxx"
+#endif
+
+#endif // end #ifndef itkRecursiveBSplineInterpolateImageFunction_h
@@ -0,0 +1,264 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkRecursiveBSplineInterpolateImageFunction_hxx
+#define itkRecursiveBSplineInterpolateImageFunction_hxx
+
+#include "itkRecursiveBSplineInterpolateImageFunction.h"
+#include "itkRecursiveBSplineTransformImplementation.h"
+
+namespace itk
+{
+
+/**
+ * ***************** Constructor ***********************
+ */
+
+template <class TImageType, class TCoordRep, class TCoefficientType>
+RecursiveBSplineInterpolateImageFunction<TImageType, TCoordRep, TCoefficientType>::
+  RecursiveBSplineInterpolateImageFunction()
+{
+  this->m_WeightFunctions = WeightFunctionsType(
+    WeightFunctionType<1>::New(), WeightFunctionType<2>::New(), WeightFunctionType<3>::New());
+
+} // end Constructor
+
+
+/**
+ * ***************** EvaluateAtContinuousIndex ***********************
+ */
+
+template <class TImageType, class TCoordRep, class TCoefficientType>
+auto
+RecursiveBSplineInterpolateImageFunction<TImageType, TCoordRep, TCoefficientType>::EvaluateAtContinuousIndex(
+  const ContinuousIndexType & x) const -> OutputType
+{
+  OutputType value{};
+  bool       done = false;
+  switch (this->GetSplineOrder())
+  {
+    case 1:
+      done = this->template EvaluateRecursive<1>(x, value);
+      break;
+    case 2:
+      done = this->template EvaluateRecursive<2>(x, value);
+      break;
+    case 3:
+      done = this->template EvaluateRecursive<3>(x, value);
+      break;
+    default:
+      break;
+  }
+
+  if (!done)
+  {
+    value = Superclass::EvaluateAtContinuousIndex(x);
+  }
+  return value;
+
+} // end EvaluateAtContinuousIndex()
+
+
+/**
+ * ***************** EvaluateValueAndDerivativeWithOptionalThreadId ***********************
+ */
+
+template <class TImageType, class TCoordRep, class TCoefficientType>
+template <typename... TOptionalThreadId>
+void
+RecursiveBSplineInterpolateImageFunction<TImageType, TCoordRep, TCoefficientType>::
+  EvaluateValueAndDerivativeWithOptionalThreadId(const ContinuousIndexType & x,
+                                                 OutputType &                value,
+                                                 CovariantVectorType &       deriv,
+                                                 const TOptionalThreadId... optionalThreadId) const
+{
+  bool done = false;
+  switch (this->GetSplineOrder())
+  {
+    case 1:
+      done = this->template EvaluateValueAndDerivativeRecursive<1>(x, value, deriv);
+      break;
+    case 2:
+      done = this->template EvaluateValueAndDerivativeRecursive<2>(x, value, deriv);
+      break;
+    case 3:
+      done = this->template EvaluateValueAndDerivativeRecursive<3>(x, value, deriv);
+      break;
+    default:
+      break;
+  }
+
+  if (!done)
+  {
+    Superclass::EvaluateValueAndDerivativeAtContinuousIndex(x, value, deriv, optionalThreadId...);
+  }
+
+} // end EvaluateValueAndDerivativeWithOptionalThreadId()
+
+
+/**
+ * ***************** ComputeSupport ***********************
+ */
+
+template <class TImageType, class TCoordRep, class TCoefficientType>
+template <unsigned int VSplineOrder>
+bool
+RecursiveBSplineInterpolateImageFunction<TImageType, TCoordRep, TCoefficientType>::ComputeSupport(
+  const ContinuousIndexType & x,
+  double *                    weights1D,
+  IndexType &                 supportIndex) const
+{
+  typedef typename WeightFunctionType<VSplineOrder>::WeightsType WeightsType;
+  const unsigned int numberOfWeights = WeightFunctionType<VSplineOrder>::NumberOfWeights;
+
+  /** Compute the weights of each dimension, and the start of the support region. */
+  WeightsType weights(weights1D, numberOfWeights, false);
+  std::get<VSplineOrder - 1>(this->m_WeightFunctions)->Evaluate(x, weights, supportIndex);
+
+  /** The coefficients are addressed directly, so the support region must be
+   * inside the buffer. Near the border the superclass mirrors the indices.
+   */
+  const typename CoefficientImageType::RegionType & bufferedRegion = this->m_Coefficients->GetBufferedRegion();
+  for (unsigned int j = 0; j < ImageDimension; ++j)
+  {
+    const IndexValueType start = bufferedRegion.GetIndex()[j];
+    const IndexValueType end = start + static_cast<IndexValueType>(bufferedRegion.GetSize()[j]);
+    if (supportIndex[j] < start || supportIndex[j] + static_cast<IndexValueType>(VSplineOrder) >= end)
+    {
+      return false;
+    }
+  }
+  return true;
+
+} // end ComputeSupport()
+
+
+/**
+ * ***************** EvaluateRecursive ***********************
+ */
+
+template <class TImageType, class TCoordRep, class TCoefficientType>
+template <unsigned int VSplineOrder>
+bool
+RecursiveBSplineInterpolateImageFunction<TImageType, TCoordRep, TCoefficientType>::EvaluateRecursive(
+  const ContinuousIndexType & x,
+  OutputType &                value) const
+{
+  /** Compute the weights and the support region. */
+  double    weights1D[WeightFunctionType<VSplineOrder>::NumberOfWeights];
+  IndexType supportIndex;
+  if (!this->template ComputeSupport<VSplineOrder>(x, weights1D, supportIndex))
+  {
+    return false;
+  }
+
+  /** Get a pointer to the first coefficient of the support region. */
+  const CoefficientImageType * coefficients = this->m_Coefficients.GetPointer();
+  TCoefficientType *           mu[1] = { const_cast<TCoefficientType *>(coefficients->GetBufferPointer()) +
+                               coefficients->ComputeOffset(supportIndex) };
+
+  /** Recursively compute the interpolated value. */
+  TCoefficientType interpolated[1];
+  RecursiveBSplineTransformImplementation<1, ImageDimension, VSplineOrder, TCoefficientType>::TransformPoint(
+    interpolated, mu, coefficients->GetOffsetTable(), weights1D);
+
+  value = static_cast<OutputType>(interpolated[0]);
+  return true;
+
+} // end EvaluateRecursive()
+
+
+/**
+ * ***************** EvaluateValueAndDerivativeRecursive ***********************
+ */
+
+template <class TImageType, class TCoordRep, class TCoefficientType>
+template <unsigned int VSplineOrder>
+bool
+RecursiveBSplineInterpolateImageFunction<TImageType, TCoordRep, TCoefficientType>::EvaluateValueAndDerivativeRecursive(
+  const ContinuousIndexType & x,
+  OutputType &                value,
+  CovariantVectorType &       deriv) const
+{
+  typedef typename WeightFunctionType<VSplineOrder>::WeightsType WeightsType;
+  const unsigned int numberOfWeights = WeightFunctionType<VSplineOrder>::NumberOfWeights;
+
+  /** Compute the weights and the support region. */
+  double    weights1D[numberOfWeights];
+  IndexType supportIndex;
+  if (!this->template ComputeSupport<VSplineOrder>(x, weights1D, supportIndex))
+  {
+    return false;
+  }
+
+  /** Compute the derivative weights. */
+  double      derivativeWeights1D[numberOfWeights];
+  WeightsType derivativeWeights(derivativeWeights1D, numberOfWeights, false);
+  std::get<VSplineOrder - 1>(this->m_WeightFunctions)->EvaluateDerivative(x, derivativeWeights, supportIndex);
+
+  /** Get a pointer to the first coefficient of the support region. */
+  const CoefficientImageType * coefficients = this->m_Coefficients.GetPointer();
+  TCoefficientType *           mu[1] = { const_cast<TCoefficientType *>(coefficients->GetBufferPointer()) +
+                               coefficients->ComputeOffset(supportIndex) };
+
+  /** Recursively compute the value and the derivatives with respect to the
+   * continuous index, in one pass. The result is ordered as:
+   * [ value, d/dx_0, ..., d/dx_{ImageDimension-1} ].
+   */
+  double valueAndDerivative[ImageDimension + 1];
+  RecursiveBSplineTransformImplementation<1, ImageDimension, VSplineOrder, TCoefficientType>::GetSpatialJacobian(
+    valueAndDerivative, mu, coefficients->GetOffsetTable(), weights1D, derivativeWeights1D);
+
+  /** Convert to a physical derivative, as done by the superclass. */
+  const typename InputImageType::SpacingType & spacing = this->GetInputImage()->GetSpacing();
+  value = static_cast<OutputType>(valueAndDerivative[0]);
+  for (unsigned int j = 0; j < ImageDimension; ++j)
+  {
+    deriv[j] = valueAndDerivative[j + 1] / spacing[j];
+  }
+
+  if (this->GetUseImageDirection())
+  {
+    CovariantVectorType orientedDerivative;
+    this->GetInputImage()->TransformLocalVectorToPhysicalVector(deriv, orientedDerivative);
+    deriv = orientedDerivative;
+  }
+  return true;
+
+} // end EvaluateValueAndDerivativeRecursive()
+
+
+/**
+ * ***************** PrintSelf ***********************
+ */
+
+template <class TImageType, class TCoordRep, class TCoefficientType>
+void
+RecursiveBSplineInterpolateImageFunction<TImageType, TCoordRep, TCoefficientType>::PrintSelf(std::ostream & os,
+                                                                                              Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "WeightFunctions: " << std::get<0>(this->m_WeightFunctions).GetPointer() << " "
+     << std::get<1>(this->m_WeightFunctions).GetPointer() << " " << std::get<2>(this->m_WeightFunctions).GetPointer()
+     << std::endl;
+
+} // end PrintSelf()
+
+
+} // end namespace itk
+
+#endif // end #ifndef itkRecursiveBSplineInterpolateImageFunction_hxx
@@ -56,10 +56,23 @@ namespace elastix
  *    at once, or per resolution. Latter saves memory.\n
  *    example: <tt>(ComputePyramidImagesPerResolution "true")</tt>\n
  *    Default false.
+ * \parameter ComputePyramidImagesInBackground: Flag to specify if the images of the next
+ *    resolution are computed in the background, while the current resolution is registered.
+ *    Only used when ComputePyramidImagesPerResolution is true.\n
+ *    example: <tt>(ComputePyramidImagesInBackground "true")</tt>\n
+ *    Default false.
  * \parameter ImagePyramidUseShrinkImageFilter: Flag to specify if the ShrinkingImageFilter is used
  *    for rescaling the image, or the ResampleImageFilter. Skrinker is faster.\n
  *    example: <tt>(ImagePyramidUseShrinkImageFilter "true")</tt>\n
  *    Default false, so by default the resampler is used.
+ * \parameter ImagePyramidUseGaussianShrinkImageFilter: Flag to specify if the images that are
+ *    both smoothed and rescaled are computed in one pass, which is faster and needs less memory.
+ *    Its Gaussian kernel is truncated, so the images differ slightly from the default ones.\n
+ *    example: <tt>(ImagePyramidUseGaussianShrinkImageFilter "true")</tt>\n
+ *    Default false.
+ *
+ * When elastix registers several moving images to the same fixed image, with a
+ * FixedPreprocessingCache, the images of the pyramid are computed only once.
  *
  * \ingroup ImagePyramids
  */
@@ -130,9 +143,20 @@ protected:
   /** The destructor. */
   ~FixedGenericPyramid() override = default;
 
+  /** Grafts the images from the fixed preprocessing cache onto the outputs, if
+   * they were computed before with the same input and settings. Otherwise, it
+   * computes the images, and stores them in the cache.
+   */
+  void
+  GenerateData(void) override;
+
 private:
   elxOverrideGetSelfMacro;
 
+  /** The key of the images in the fixed preprocessing cache, without the level. */
+  std::string
+  GetPreprocessingCacheKey(void) const;
+
   /** The deleted copy constructor. */
   FixedGenericPyramid(const Self &) = delete;
   /** The deleted assignment operator. */
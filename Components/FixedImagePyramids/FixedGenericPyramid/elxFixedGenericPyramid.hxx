@@ -20,6 +20,10 @@
 
 #include "elxFixedGenericPyramid.h"
 
+#include <sstream>
+#include <typeinfo>
+#include <vector>
+
 namespace elastix
 {
 
@@ -143,6 +147,14 @@ FixedGenericPyramid<TElastix>::SetFixedSchedule(void)
   this->m_Configuration->ReadParameter(useShrinkImageFilter, "ImagePyramidUseShrinkImageFilter", 0, false);
   this->SetUseShrinkImageFilter(useShrinkImageFilter);
 
+  /** Use or skip the filter that smooths and rescales at once, without
+   * computing the smoothed image at full resolution.
+   */
+  bool useGaussianShrinkImageFilter = false;
+  this->m_Configuration->ReadParameter(
+    useGaussianShrinkImageFilter, "ImagePyramidUseGaussianShrinkImageFilter", 0, false);
+  this->SetUseGaussianShrinkImageFilter(useGaussianShrinkImageFilter);
+
   /** Decide whether or not to compute the pyramid images only for the current
    * resolution. Setting the option to true saves memory, since only one level
    * of the pyramid gets allocated per resolution.
@@ -151,6 +163,14 @@ FixedGenericPyramid<TElastix>::SetFixedSchedule(void)
   this->m_Configuration->ReadParameter(computeThisResolution, "ComputePyramidImagesPerResolution", 0, false);
   this->SetComputeOnlyForCurrentLevel(computeThisResolution);
 
+  /** Decide whether or not to compute the pyramid images of the next resolution
+   * in the background, while the current resolution is registered. This is only
+   * used when the pyramid images are computed per resolution.
+   */
+  bool computeInBackground = false;
+  this->m_Configuration->ReadParameter(computeInBackground, "ComputePyramidImagesInBackground", 0, false);
+  this->SetPrefetchNextLevel(computeInBackground);
+
 } // end SetFixedSchedule()
 
 
@@ -174,6 +194,88 @@ FixedGenericPyramid<TElastix>::BeforeEachResolution(void)
 } // end BeforeEachResolution()
 
 
+/**
+ * ******************* GenerateData ***********************
+ */
+
+template <class TElastix>
+void
+FixedGenericPyramid<TElastix>::GenerateData(void)
+{
+  /** Without a cache, just compute the images. */
+  FixedPreprocessingCache * cache = this->GetElastix()->GetFixedPreprocessingCache();
+  if (!cache)
+  {
+    this->Superclass1::GenerateData();
+    return;
+  }
+
+  /** The levels that are computed by this update. */
+  std::vector<unsigned int> levels;
+  for (unsigned int level = 0; level < this->GetNumberOfLevels(); ++level)
+  {
+    if (!this->GetComputeOnlyForCurrentLevel() || level == this->GetCurrentLevel())
+    {
+      levels.push_back(level);
+    }
+  }
+
+  /** Use the cached images, if all of these levels are there. */
+  const std::string               key = this->GetPreprocessingCacheKey();
+  std::vector<OutputImagePointer> cachedImages;
+  for (const unsigned int level : levels)
+  {
+    const auto cachedData = cache->Find(key + std::to_string(level));
+    auto *     cachedImage = dynamic_cast<OutputImageType *>(cachedData.GetPointer());
+    if (!cachedImage)
+    {
+      break;
+    }
+    cachedImages.push_back(cachedImage);
+  }
+
+  if (cachedImages.size() == levels.size())
+  {
+    for (unsigned int i = 0; i < levels.size(); ++i)
+    {
+      this->GetOutput(levels[i])->Graft(cachedImages[i]);
+    }
+    return;
+  }
+
+  /** Compute the images, and store a graft of them, which keeps their buffers
+   * alive when the outputs are released.
+   */
+  this->Superclass1::GenerateData();
+  for (const unsigned int level : levels)
+  {
+    const OutputImagePointer image = OutputImageType::New();
+    image->Graft(this->GetOutput(level));
+    cache->Store(key + std::to_string(level), image);
+  }
+
+} // end GenerateData()
+
+
+/**
+ * ******************* GetPreprocessingCacheKey ***********************
+ */
+
+template <class TElastix>
+std::string
+FixedGenericPyramid<TElastix>::GetPreprocessingCacheKey(void) const
+{
+  std::ostringstream key;
+  key << "FixedGenericPyramid " << FixedPreprocessingCache::GetImageKey(this->GetInput()) << ' '
+      << typeid(OutputImageType).name() << "\nSchedule:\n"
+      << this->GetSchedule() << "SmoothingSchedule:\n"
+      << this->GetSmoothingSchedule() << "UseShrinkImageFilter: " << this->GetUseShrinkImageFilter()
+      << "\nUseGaussianShrinkImageFilter: " << this->GetUseGaussianShrinkImageFilter() << "\nLevel: ";
+  return key.str();
+
+} // end GetPreprocessingCacheKey()
+
+
 } // end namespace elastix
 
 #endif // end #ifndef elxFixedGenericPyramid_hxx
@@ -19,7 +19,7 @@
 #define elxBSplineInterpolator_h
 
 #include "elxIncludes.h" // include first to avoid MSVS warning
-#include "itkBSplineInterpolateImageFunction.h"
+#include "itkRecursiveBSplineInterpolateImageFunction.h"
 
 namespace elastix
 {
@@ -29,7 +29,12 @@ namespace elastix
  * \brief An interpolator based on the itkBSplineInterpolateImageFunction.
  *
  * This interpolator interpolates images with an underlying B-spline
- * polynomial.
+ * polynomial. For order 1 to 3 the value and derivative are computed with
+ * the compile-time specialized itk::RecursiveBSplineInterpolateImageFunction.
+ * The coefficients are stored in double precision, or in single precision
+ * when elastix is built with ELASTIX_USE_SINGLE_PRECISION. The
+ * BSplineInterpolatorFloat always stores them in single precision, which
+ * halves their memory.
  *
  * NB: BSplineInterpolation with order 1 is slower than using a LinearInterpolator,
  * but it determines the derivative slightly more accurate at grid points. That's
@@ -48,18 +53,18 @@ namespace elastix
 
 template <class TElastix>
 class ITK_TEMPLATE_EXPORT BSplineInterpolator
-  : public itk::BSplineInterpolateImageFunction<typename InterpolatorBase<TElastix>::InputImageType,
-                                                typename InterpolatorBase<TElastix>::CoordRepType,
-                                                double>
-  , // CoefficientType
+  : public itk::RecursiveBSplineInterpolateImageFunction<typename InterpolatorBase<TElastix>::InputImageType,
+                                                         typename InterpolatorBase<TElastix>::CoordRepType,
+                                                         typename InterpolatorBase<TElastix>::CoefficientType>
+  ,
     public InterpolatorBase<TElastix>
 {
 public:
   /** Standard ITK-stuff. */
   typedef BSplineInterpolator Self;
-  typedef itk::BSplineInterpolateImageFunction<typename InterpolatorBase<TElastix>::InputImageType,
-                                               typename InterpolatorBase<TElastix>::CoordRepType,
-                                               double>
+  typedef itk::RecursiveBSplineInterpolateImageFunction<typename InterpolatorBase<TElastix>::InputImageType,
+                                                        typename InterpolatorBase<TElastix>::CoordRepType,
+                                                        typename InterpolatorBase<TElastix>::CoefficientType>
                                         Superclass1;
   typedef InterpolatorBase<TElastix>    Superclass2;
   typedef itk::SmartPointer<Self>       Pointer;
@@ -69,7 +74,7 @@ public:
   itkNewMacro(Self);
 
   /** Run-time type information (and related methods). */
-  itkTypeMacro(BSplineInterpolator, itk::BSplineInterpolateImageFunction);
+  itkTypeMacro(BSplineInterpolator, itk::RecursiveBSplineInterpolateImageFunction);
 
   /** Name of this class.
    * Use this name in the parameter file to select this specific interpolator. \n
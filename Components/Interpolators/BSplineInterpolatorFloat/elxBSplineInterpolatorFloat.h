@@ -19,7 +19,7 @@
 #define elxBSplineInterpolatorFloat_h
 
 #include "elxIncludes.h" // include first to avoid MSVS warning
-#include "itkBSplineInterpolateImageFunction.h"
+#include "itkRecursiveBSplineInterpolateImageFunction.h"
 
 namespace elastix
 {
@@ -29,7 +29,13 @@ namespace elastix
  * \brief An interpolator based on the itk::BSplineInterpolateImageFunction.
  *
  * This interpolator interpolates images with an underlying B-spline
- * polynomial.
+ * polynomial. The coefficients are stored in single precision, instead of
+ * double as in the BSplineInterpolator. This halves the memory of the
+ * coefficients of the moving image and the memory traffic of each sample,
+ * at the cost of rounding the coefficients. The coordinates, the transform
+ * and the metric sums remain double. For order 1 to 3 the value and derivative
+ * are computed with the compile-time specialized
+ * itk::RecursiveBSplineInterpolateImageFunction.
  *
  * NB: BSplineInterpolation with order 1 is slower than using a LinearInterpolator,
  * but it determines the derivative slightly more accurate at grid points. That's
@@ -48,18 +54,18 @@ namespace elastix
 
 template <class TElastix>
 class ITK_TEMPLATE_EXPORT BSplineInterpolatorFloat
-  : public itk::BSplineInterpolateImageFunction<typename InterpolatorBase<TElastix>::InputImageType,
-                                                typename InterpolatorBase<TElastix>::CoordRepType,
-                                                float>
+  : public itk::RecursiveBSplineInterpolateImageFunction<typename InterpolatorBase<TElastix>::InputImageType,
+                                                         typename InterpolatorBase<TElastix>::CoordRepType,
+                                                         float>
   , // CoefficientType
     public InterpolatorBase<TElastix>
 {
 public:
   /** Standard ITK-stuff. */
   typedef BSplineInterpolatorFloat Self;
-  typedef itk::BSplineInterpolateImageFunction<typename InterpolatorBase<TElastix>::InputImageType,
-                                               typename InterpolatorBase<TElastix>::CoordRepType,
-                                               float>
+  typedef itk::RecursiveBSplineInterpolateImageFunction<typename InterpolatorBase<TElastix>::InputImageType,
+                                                        typename InterpolatorBase<TElastix>::CoordRepType,
+                                                        float>
                                         Superclass1;
   typedef InterpolatorBase<TElastix>    Superclass2;
   typedef itk::SmartPointer<Self>       Pointer;
@@ -69,7 +75,7 @@ public:
   itkNewMacro(Self);
 
   /** Run-time type information (and related methods). */
-  itkTypeMacro(BSplineInterpolatorFloat, BSplineInterpolateImageFunction);
+  itkTypeMacro(BSplineInterpolatorFloat, RecursiveBSplineInterpolateImageFunction);
 
   /** Name of this class.
    * Use this name in the parameter file to select this specific interpolator. \n
@@ -674,8 +674,8 @@ AdvancedKappaStatisticImageToImageMetric<TFixedImage, TMovingImage>::AfterThread
     temp->st_Coefficient2 = tmp2;
     temp->st_DerivativePointer = derivative.begin();
 
-    this->m_Threader->SetSingleMethod(AccumulateDerivativesThreaderCallback, temp);
-    this->m_Threader->SingleMethodExecute();
+    this->m_MetricThreader->SetSingleMethod(AccumulateDerivativesThreaderCallback, temp);
+    this->m_MetricThreader->SingleMethodExecute();
 
     delete temp;
   }
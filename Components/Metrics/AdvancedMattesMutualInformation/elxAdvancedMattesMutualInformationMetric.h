@@ -91,6 +91,13 @@ namespace elastix
  *    B-spline grids.
  *    example: <tt>(UseFastAndLowMemoryVersion "false")</tt> \n
  *    The default is "true".
+ * \parameter MaximumJointPDFDerivativesMemorySize: The maximum size in megabytes of
+ *    the 3D matrix that is used when UseFastAndLowMemoryVersion is "false". For more
+ *    parameters, the matrix is computed per block of parameters, each block within
+ *    this size for all threads together, at the cost of a loop over the samples per
+ *    block. Can be given for each resolution, or for all resolutions at once. \n
+ *    example: <tt>(MaximumJointPDFDerivativesMemorySize 512)</tt> \n
+ *    The default is 1024.
  *
  * \sa ParzenWindowMutualInformationImageToImageMetric
  * \ingroup Metrics
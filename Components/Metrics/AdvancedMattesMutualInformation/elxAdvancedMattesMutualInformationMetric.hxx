@@ -121,6 +121,15 @@ AdvancedMattesMutualInformationMetric<TElastix>::BeforeEachResolution(void)
     useFastAndLowMemoryVersion, "UseFastAndLowMemoryVersion", this->GetComponentLabel(), level, 0);
   this->SetUseExplicitPDFDerivatives(!useFastAndLowMemoryVersion);
 
+  /** Set the maximum memory size of the explicit joint histogram derivatives. */
+  double maximumJointPDFDerivativesMemorySize = 1024.0;
+  this->GetConfiguration()->ReadParameter(maximumJointPDFDerivativesMemorySize,
+                                          "MaximumJointPDFDerivativesMemorySize",
+                                          this->GetComponentLabel(),
+                                          level,
+                                          0);
+  this->SetMaximumJointPDFDerivativesMemorySize(maximumJointPDFDerivativesMemorySize);
+
   /** Set whether to use Nick Tustison's preconditioning technique. */
   bool useJacobianPreconditioning = false;
   this->GetConfiguration()->ReadParameter(
@@ -170,6 +170,7 @@ protected:
   using typename Superclass::PDFDerivativeValueType;
   using typename Superclass::MarginalPDFType;
   using typename Superclass::JointPDFType;
+  using typename Superclass::JointPDFPointer;
   using typename Superclass::JointPDFDerivativesType;
   using typename Superclass::IncrementalMarginalPDFType;
   using typename Superclass::JointPDFIndexType;
@@ -188,6 +189,8 @@ protected:
    * Implements a version that only loops once over the samples, but uses
    * a large block of memory to explicitly store the joint histogram derivative.
    * It's size is \#FixedHistogramBins * \#MovingHistogramBins * \#parameters * float.
+   * When that exceeds the MaximumJointPDFDerivativesMemorySize, the joint histogram
+   * derivative is computed per block of parameters instead.
    */
   void
   GetValueAndAnalyticDerivative(const ParametersType & parameters,
@@ -21,6 +21,7 @@
 #include "itkParzenWindowMutualInformationImageToImageMetric.h"
 
 #include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkImageLinearIteratorWithIndex.h"
 #include "itkImageScanlineConstIterator.h"
 #include <vnl/vnl_math.h>
 #include "itkMatrix.h"
@@ -166,28 +167,28 @@ ParzenWindowMutualInformationImageToImageMetric<TFixedImage, TMovingImage>::GetV
   this->ComputeMarginalPDF(this->m_JointPDF, this->m_FixedImageMarginalPDF, 0);
   this->ComputeMarginalPDF(this->m_JointPDF, this->m_MovingImageMarginalPDF, 1);
 
-  /** Compute the metric and derivatives by double summation over histogram. */
+  /** Compute the metric by double summation over histogram, and the weight of
+   * each bin in the derivative.
+   */
 
   /** Setup iterators .*/
-  typedef ImageLinearConstIteratorWithIndex<JointPDFType>            JointPDFIteratorType;
-  typedef ImageLinearConstIteratorWithIndex<JointPDFDerivativesType> JointPDFDerivativesIteratorType;
-  typedef typename MarginalPDFType::const_iterator                   MarginalPDFIteratorType;
-  typedef typename DerivativeType::iterator                          DerivativeIteratorType;
+  typedef ImageLinearConstIteratorWithIndex<JointPDFType> JointPDFIteratorType;
+  typedef ImageLinearIteratorWithIndex<JointPDFType>      BinWeightsIteratorType;
+  typedef typename MarginalPDFType::const_iterator        MarginalPDFIteratorType;
 
   JointPDFIteratorType jointPDFit(this->m_JointPDF, this->m_JointPDF->GetLargestPossibleRegion());
   jointPDFit.SetDirection(0);
   jointPDFit.GoToBegin();
-  JointPDFDerivativesIteratorType jointPDFDerivativesit(this->m_JointPDFDerivatives,
-                                                        this->m_JointPDFDerivatives->GetLargestPossibleRegion());
-  jointPDFDerivativesit.SetDirection(0);
-  jointPDFDerivativesit.GoToBegin();
+  JointPDFPointer binWeights = JointPDFType::New();
+  binWeights->SetRegions(this->m_JointPDF->GetLargestPossibleRegion());
+  binWeights->Allocate(true);
+  BinWeightsIteratorType binWeightsit(binWeights, binWeights->GetLargestPossibleRegion());
+  binWeightsit.SetDirection(0);
+  binWeightsit.GoToBegin();
   MarginalPDFIteratorType       fixedPDFit = this->m_FixedImageMarginalPDF.begin();
   const MarginalPDFIteratorType fixedPDFend = this->m_FixedImageMarginalPDF.end();
   MarginalPDFIteratorType       movingPDFit = this->m_MovingImageMarginalPDF.begin();
   const MarginalPDFIteratorType movingPDFend = this->m_MovingImageMarginalPDF.end();
-  DerivativeIteratorType        derivit = derivative.begin();
-  const DerivativeIteratorType  derivbegin = derivative.begin();
-  const DerivativeIteratorType  derivend = derivative.end();
 
   /** Loop over the joint histogram. */
   double MI = 0.0;
@@ -204,28 +205,26 @@ ParzenWindowMutualInformationImageToImageMetric<TFixedImage, TMovingImage>::GetV
       /** Check for non-zero bin contribution. */
       if (jointPDFValue > 1e-16 && fixPDFmovPDF > 1e-16)
       {
-        derivit = derivbegin;
         const double pRatio = std::log(jointPDFValue / fixPDFmovPDF);
-        const double pRatioAlpha = this->m_Alpha * pRatio;
         MI += jointPDFValue * pRatio;
-        while (derivit != derivend)
-        {
-          /**  Ref: eq 23 of Thevenaz & Unser paper [3]. */
-          (*derivit) -= jointPDFDerivativesit.Get() * pRatioAlpha;
-          ++derivit;
-          ++jointPDFDerivativesit;
-        } // end while-loop over parameters
-      }   // end if-block to check non-zero bin contribution
+
+        /**  Ref: eq 23 of Thevenaz & Unser paper [3]. */
+        binWeightsit.Set(this->m_Alpha * pRatio);
+      } // end if-block to check non-zero bin contribution
 
       ++movingPDFit;
       ++jointPDFit;
-      jointPDFDerivativesit.NextLine();
+      ++binWeightsit;
 
     } // end while-loop over moving index
     ++fixedPDFit;
     jointPDFit.NextLine();
+    binWeightsit.NextLine();
   } // end while-loop over fixed index
 
+  /** Compute the derivative from the pdf derivatives and the bin weights. */
+  this->ComputeDerivativeFromJointPDFDerivatives(*binWeights, derivative);
+
   value = static_cast<MeasureType>(-1.0 * MI);
 
 } // end GetValueAndAnalyticDerivative()
@@ -609,9 +608,10 @@ ParzenWindowMutualInformationImageToImageMetric<TFixedImage, TMovingImage>::Afte
     this->m_ThreaderMetricParameters.st_DerivativePointer = derivative.begin();
     this->m_ThreaderMetricParameters.st_NormalizationFactor = 1.0;
 
-    this->m_Threader->SetSingleMethod(this->AccumulateDerivativesThreaderCallback,
-                                      const_cast<void *>(static_cast<const void *>(&this->m_ThreaderMetricParameters)));
-    this->m_Threader->SingleMethodExecute();
+    this->m_MetricThreader->SetSingleMethod(
+      this->AccumulateDerivativesThreaderCallback,
+      const_cast<void *>(static_cast<const void *>(&this->m_ThreaderMetricParameters)));
+    this->m_MetricThreader->SingleMethodExecute();
   }
 
 } // end AfterThreadedComputeDerivativeLowMemory()
@@ -650,12 +650,12 @@ ParzenWindowMutualInformationImageToImageMetric<TFixedImage,
   const
 {
   /** Setup threader. */
-  this->m_Threader->SetSingleMethod(
+  this->m_MetricThreader->SetSingleMethod(
     this->ComputeDerivativeLowMemoryThreaderCallback,
     const_cast<void *>(static_cast<const void *>(&this->m_ParzenWindowMutualInformationThreaderParameters)));
 
   /** Launch. */
-  this->m_Threader->SingleMethodExecute();
+  this->m_MetricThreader->SingleMethodExecute();
 
 } // end LaunchComputeDerivativeLowMemoryThreaderCallback()
 
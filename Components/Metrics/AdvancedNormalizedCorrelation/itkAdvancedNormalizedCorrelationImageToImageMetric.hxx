@@ -761,8 +761,8 @@ AdvancedNormalizedCorrelationImageToImageMetric<TFixedImage, TMovingImage>::Afte
     temp->st_InvertedDenominator = 1.0 / denom;
     temp->st_DerivativePointer = derivative.begin();
 
-    this->m_Threader->SetSingleMethod(AccumulateDerivativesThreaderCallback, temp);
-    this->m_Threader->SingleMethodExecute();
+    this->m_MetricThreader->SetSingleMethod(AccumulateDerivativesThreaderCallback, temp);
+    this->m_MetricThreader->SingleMethodExecute();
 
     delete temp;
   }
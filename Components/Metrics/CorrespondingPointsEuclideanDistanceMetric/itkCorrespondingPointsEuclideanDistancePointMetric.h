@@ -75,6 +75,7 @@ public:
   typedef vnl_vector<CoordRepType>               VnlVectorType;
 
   using typename Superclass::NonZeroJacobianIndicesType;
+  using typename Superclass::ThreadInfoType;
 
   /**  Get the value for single valued optimizers. */
   MeasureType
@@ -94,6 +95,20 @@ protected:
   CorrespondingPointsEuclideanDistancePointMetric();
   ~CorrespondingPointsEuclideanDistancePointMetric() override = default;
 
+  /** Compute the contribution of the points of one thread to the value and derivative. */
+  void
+  ThreadedGetValueAndDerivative(ThreadIdType threadID) const override;
+
+  /** Loop over the points in [ pointBegin, pointEnd [, accumulating the sum of the
+   * distances and their derivatives, and the number of points counted.
+   */
+  void
+  ComputeValueAndDerivativeForPointRange(const SizeValueType pointBegin,
+                                         const SizeValueType pointEnd,
+                                         SizeValueType &     numberOfPointsCounted,
+                                         MeasureType &       measure,
+                                         DerivativeType &    derivative) const;
+
 private:
   CorrespondingPointsEuclideanDistancePointMetric(const Self &) = delete;
   void
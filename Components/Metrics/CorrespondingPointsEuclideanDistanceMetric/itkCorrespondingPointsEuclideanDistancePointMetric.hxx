@@ -159,11 +159,6 @@ CorrespondingPointsEuclideanDistancePointMetric<TFixedPointSet, TMovingPointSet>
   MeasureType measure = NumericTraits<MeasureType>::Zero;
   derivative = DerivativeType(this->GetNumberOfParameters());
   derivative.Fill(NumericTraits<DerivativeValueType>::ZeroValue());
-  NonZeroJacobianIndicesType nzji(this->m_Transform->GetNumberOfNonZeroJacobianIndices());
-  TransformJacobianType      jacobian;
-
-  InputPointType  movingPoint;
-  OutputPointType fixedPoint, mappedPoint;
 
   /** Call non-thread-safe stuff, such as:
    *   this->SetTransformParameters( parameters );
@@ -180,17 +175,93 @@ CorrespondingPointsEuclideanDistancePointMetric<TFixedPointSet, TMovingPointSet>
    */
   this->BeforeThreadedGetValueAndDerivative(parameters);
 
-  /** Create iterators. */
-  PointIterator pointItFixed = fixedPointSet->GetPoints()->Begin();
-  PointIterator pointItMoving = movingPointSet->GetPoints()->Begin();
-  PointIterator pointEnd = fixedPointSet->GetPoints()->End();
+  /** Option for multi-threaded computation of the value and derivative. */
+  if (this->m_UseMultiThread)
+  {
+    /** Launch multi-threading metric. */
+    this->LaunchGetValueAndDerivativeThreaderCallback();
+
+    /** Gather the metric values and derivatives from all threads. */
+    this->AfterThreadedGetValueAndDerivative(value, derivative);
+    return;
+  }
+
+  /** Single-threaded: loop over all points. */
+  SizeValueType numberOfPointsCounted = 0;
+  this->ComputeValueAndDerivativeForPointRange(
+    0, fixedPointSet->GetNumberOfPoints(), numberOfPointsCounted, measure, derivative);
+  this->m_NumberOfPointsCounted = numberOfPointsCounted;
+
+  /** Check if enough samples were valid. */
+  //   this->CheckNumberOfSamples(
+  //     fixedPointSet->GetNumberOfPoints(), this->m_NumberOfPointsCounted );
+
+  /** Copy the measure to value. */
+  value = measure;
+  if (this->m_NumberOfPointsCounted > 0)
+  {
+    derivative /= this->m_NumberOfPointsCounted;
+    value = measure / this->m_NumberOfPointsCounted;
+  }
+
+} // end GetValueAndDerivative()
+
+
+/**
+ * ******************* ThreadedGetValueAndDerivative *******************
+ */
+
+template <class TFixedPointSet, class TMovingPointSet>
+void
+CorrespondingPointsEuclideanDistancePointMetric<TFixedPointSet, TMovingPointSet>::ThreadedGetValueAndDerivative(
+  ThreadIdType threadID) const
+{
+  /** Get the range of points this thread is responsible for. */
+  SizeValueType pointBegin = 0;
+  SizeValueType pointEnd = 0;
+  this->GetPointRangeForThread(threadID, pointBegin, pointEnd);
+
+  /** Accumulate into the variables of this thread; they are reset
+   * in AfterThreadedGetValueAndDerivative().
+   */
+  this->ComputeValueAndDerivativeForPointRange(
+    pointBegin,
+    pointEnd,
+    this->m_GetValueAndDerivativePerThreadVariables[threadID].st_NumberOfPointsCounted,
+    this->m_GetValueAndDerivativePerThreadVariables[threadID].st_Value,
+    this->m_GetValueAndDerivativePerThreadVariables[threadID].st_Derivative);
+
+} // end ThreadedGetValueAndDerivative()
+
+
+/**
+ * ******************* ComputeValueAndDerivativeForPointRange *******************
+ */
+
+template <class TFixedPointSet, class TMovingPointSet>
+void
+CorrespondingPointsEuclideanDistancePointMetric<TFixedPointSet, TMovingPointSet>::
+  ComputeValueAndDerivativeForPointRange(const SizeValueType pointBegin,
+                                         const SizeValueType pointEnd,
+                                         SizeValueType &     numberOfPointsCounted,
+                                         MeasureType &       measure,
+                                         DerivativeType &    derivative) const
+{
+  NonZeroJacobianIndicesType nzji(this->m_Transform->GetNumberOfNonZeroJacobianIndices());
+  TransformJacobianType      jacobian;
+
+  InputPointType  movingPoint;
+  OutputPointType fixedPoint, mappedPoint;
+
+  const auto fixedPoints = this->GetFixedPointSet()->GetPoints();
+  const auto movingPoints = this->GetMovingPointSet()->GetPoints();
 
   /** Loop over the corresponding points. */
-  while (pointItFixed != pointEnd)
+  for (SizeValueType pointId = pointBegin; pointId < pointEnd; ++pointId)
   {
     /** Get the current corresponding points. */
-    fixedPoint = pointItFixed.Value();
-    movingPoint = pointItMoving.Value();
+    fixedPoint = fixedPoints->ElementAt(pointId);
+    movingPoint = movingPoints->ElementAt(pointId);
 
     /** Transform point and check if it is inside the B-spline support region. */
     // bool sampleOk = this->TransformPoint( fixedPoint, mappedPoint );
@@ -209,7 +280,7 @@ CorrespondingPointsEuclideanDistancePointMetric<TFixedPointSet, TMovingPointSet>
 
     if (sampleOk)
     {
-      this->m_NumberOfPointsCounted++;
+      ++numberOfPointsCounted;
 
       /** Get the TransformJacobian dT/dmu. */
       // this->EvaluateTransformJacobian( fixedPoint, jacobian, nzji );
@@ -242,24 +313,9 @@ CorrespondingPointsEuclideanDistancePointMetric<TFixedPointSet, TMovingPointSet>
 
     } // end if sampleOk
 
-    ++pointItFixed;
-    ++pointItMoving;
-
   } // end loop over all corresponding points
 
-  /** Check if enough samples were valid. */
-  //   this->CheckNumberOfSamples(
-  //     fixedPointSet->GetNumberOfPoints(), this->m_NumberOfPointsCounted );
-
-  /** Copy the measure to value. */
-  value = measure;
-  if (this->m_NumberOfPointsCounted > 0)
-  {
-    derivative /= this->m_NumberOfPointsCounted;
-    value = measure / this->m_NumberOfPointsCounted;
-  }
-
-} // end GetValueAndDerivative()
+} // end ComputeValueAndDerivativeForPointRange()
 
 
 } // end namespace itk
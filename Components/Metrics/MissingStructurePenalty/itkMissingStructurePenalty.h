@@ -26,6 +26,9 @@
 #include "itkVectorContainer.h"
 #include "vnl_adjugate_fixed.h"
 
+#include <memory> // For unique_ptr.
+#include <vector>
+
 namespace itk
 {
 
@@ -75,6 +78,7 @@ public:
   typedef vnl_vector<CoordRepType>               VnlVectorType;
 
   using typename Superclass::NonZeroJacobianIndicesType;
+  using typename Superclass::ThreadInfoType;
 
   /** Constants for the pointset dimensions. */
   itkStaticConstMacro(FixedPointSetDimension, unsigned int, Superclass::FixedPointSetDimension);
@@ -161,6 +165,10 @@ protected:
   /** PrintSelf. */
   // void PrintSelf(std::ostream& os, Indent indent) const;
 
+  /** Initialize the per-thread variables. */
+  void
+  InitializeThreadingParameters(void) const override;
+
   /** Member variables. */
   FixedMeshConstPointer m_FixedMesh;
 
@@ -168,6 +176,63 @@ protected:
   mutable MappedMeshContainerPointer     m_MappedMeshContainer;
 
 private:
+  /** The three steps of GetValueAndDerivative(), each for a range of the
+   * points or cells of all meshes, numbered consecutively:
+   * - map the fixed points, and sum them per mesh for the centroids;
+   * - compute the signed volume of the cells and their derivative to the points;
+   * - multiply the point derivatives with the transform Jacobian.
+   */
+  void
+  TransformPointsForRange(ThreadIdType threadID, SizeValueType pointBegin, SizeValueType pointEnd) const;
+
+  void
+  ComputeVolumesForRange(ThreadIdType threadID, SizeValueType cellBegin, SizeValueType cellEnd) const;
+
+  void
+  ComputeDerivativeForRange(SizeValueType    pointBegin,
+                            SizeValueType    pointEnd,
+                            ThreadIdType     numberOfThreads,
+                            DerivativeType & derivative) const;
+
+  /** Threader callbacks for the three steps. */
+  static ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION
+  TransformPointsThreaderCallback(void * arg);
+
+  static ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION
+  ComputeVolumesThreaderCallback(void * arg);
+
+  static ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION
+  ComputeDerivativeThreaderCallback(void * arg);
+
+  /** Launch one of the threader callbacks. */
+  void
+  LaunchThreaderCallback(ThreadFunctionType callback) const;
+
+  /** Flattened view of the meshes, built in Initialize(). The points and the cells of all
+   * meshes are numbered consecutively; the points of mesh i have the indices in
+   * [ m_PointOffsets[ i ], m_PointOffsets[ i + 1 ] [, and likewise for the cells.
+   * m_CellPointIds holds FixedPointSetDimension point ids per cell, relative to its mesh.
+   * The mapped points are written directly into the preallocated points of the mapped meshes.
+   */
+  std::vector<SizeValueType>            m_PointOffsets;
+  std::vector<SizeValueType>            m_CellOffsets;
+  std::vector<FixedMeshPointIdentifier> m_CellPointIds;
+  std::vector<const MeshPointType *>    m_FixedPointsData;
+  std::vector<MeshPointType *>          m_MappedPointsData;
+  mutable std::vector<MeshPointType>    m_Centroids;
+
+  /** Per-thread struct with padding and alignment, to prevent false sharing. */
+  struct MeshPerThreadStruct
+  {
+    MeasureType             st_Value;
+    std::vector<VectorType> st_CentroidSums;
+    std::vector<VectorType> st_PointsDerivative;
+  };
+  itkPadStruct(ITK_CACHE_LINE_ALIGNMENT, MeshPerThreadStruct, PaddedMeshPerThreadStruct);
+  itkAlignedTypedef(ITK_CACHE_LINE_ALIGNMENT, PaddedMeshPerThreadStruct, AlignedMeshPerThreadStruct);
+  mutable std::unique_ptr<AlignedMeshPerThreadStruct[]> m_MeshPerThreadVariables{ nullptr };
+  mutable ThreadIdType                                  m_MeshPerThreadVariablesSize{ 0 };
+
   void
   SubVector(const VectorType & fullVector, SubVectorType & subVector, const unsigned int leaveOutIndex) const;
 
@@ -19,6 +19,7 @@
 #define itkMissingStructurePenalty_hxx
 
 #include "itkMissingStructurePenalty.h"
+#include <algorithm> // For upper_bound.
 #include <cmath>
 
 namespace itk
@@ -59,6 +60,13 @@ MissingVolumeMeshPenalty<TFixedPointSet, TMovingPointSet>::Initialize(void)
   const FixedMeshContainerElementIdentifier numberOfMeshes = this->m_FixedMeshContainer->Size();
   this->m_MappedMeshContainer->Reserve(numberOfMeshes);
 
+  this->m_PointOffsets.assign(1, 0);
+  this->m_CellOffsets.assign(1, 0);
+  this->m_CellPointIds.clear();
+  this->m_FixedPointsData.resize(numberOfMeshes);
+  this->m_MappedPointsData.resize(numberOfMeshes);
+  this->m_Centroids.resize(numberOfMeshes);
+
   for (FixedMeshContainerElementIdentifier meshId = 0; meshId < numberOfMeshes; ++meshId)
   {
     FixedMeshConstPointer           fixedMesh = this->m_FixedMeshContainer->ElementAt(meshId);
@@ -80,10 +88,74 @@ MissingVolumeMeshPenalty<TFixedPointSet, TMovingPointSet>::Initialize(void)
     mappedMesh->SetCellData(nullptr);
 
     this->m_MappedMeshContainer->SetElement(meshId, mappedMesh);
+
+    /** Keep raw pointers to the contiguous point storage of the fixed and the
+     * (preallocated) mapped mesh, so that the threads can index them directly.
+     */
+    this->m_FixedPointsData[meshId] = fixedPoints->CastToSTLConstContainer().data();
+    this->m_MappedPointsData[meshId] = mappedPoints->CastToSTLContainer().data();
+    this->m_PointOffsets.push_back(this->m_PointOffsets.back() + numberOfPoints);
+
+    /** Flatten the point ids of the cells. */
+    typename FixedMeshType::CellsContainerConstIterator cellIt = fixedMesh->GetCells()->Begin();
+    typename FixedMeshType::CellsContainerConstIterator cellEnd = fixedMesh->GetCells()->End();
+    for (; cellIt != cellEnd; ++cellIt)
+    {
+      if (cellIt->Value()->GetNumberOfPoints() < FixedPointSetDimension)
+      {
+        itkExceptionMacro(<< "Mesh " << meshId << " contains a cell with less than " << FixedPointSetDimension
+                          << " points");
+      }
+      typename CellInterfaceType::PointIdConstIterator pointIdIt = cellIt->Value()->PointIdsBegin();
+      for (unsigned int d = 0; d < FixedPointSetDimension; ++d, ++pointIdIt)
+      {
+        this->m_CellPointIds.push_back(*pointIdIt);
+      }
+    }
+    this->m_CellOffsets.push_back(this->m_CellOffsets.back() + fixedMesh->GetNumberOfCells());
   }
+
+  /** Initialize some threading related parameters. */
+  this->InitializeThreadingParameters();
+
 } // end Initialize()
 
 
+/**
+ * ********************* InitializeThreadingParameters ****************************
+ */
+
+template <class TFixedPointSet, class TMovingPointSet>
+void
+MissingVolumeMeshPenalty<TFixedPointSet, TMovingPointSet>::InitializeThreadingParameters(void) const
+{
+  const ThreadIdType numberOfThreads = this->m_UseMultiThread ? this->GetNumberOfWorkUnits() : 1;
+
+  /** The accumulation of the parameter derivatives uses the variables of the superclass. */
+  if (this->m_UseMultiThread)
+  {
+    this->Superclass::InitializeThreadingParameters();
+  }
+
+  /** Only resize the array of structs when needed. */
+  if (this->m_MeshPerThreadVariablesSize != numberOfThreads)
+  {
+    this->m_MeshPerThreadVariables.reset(new AlignedMeshPerThreadStruct[numberOfThreads]);
+    this->m_MeshPerThreadVariablesSize = numberOfThreads;
+  }
+
+  /** Some initialization. These variables are reset after each use in GetValueAndDerivative. */
+  const VectorType zeroVector(NumericTraits<typename VectorType::ValueType>::ZeroValue());
+  for (ThreadIdType i = 0; i < numberOfThreads; ++i)
+  {
+    this->m_MeshPerThreadVariables[i].st_Value = NumericTraits<MeasureType>::Zero;
+    this->m_MeshPerThreadVariables[i].st_CentroidSums.assign(this->m_Centroids.size(), zeroVector);
+    this->m_MeshPerThreadVariables[i].st_PointsDerivative.assign(this->m_PointOffsets.back(), zeroVector);
+  }
+
+} // end InitializeThreadingParameters()
+
+
 /**
  * ******************* GetValue *******************
  */
@@ -164,163 +236,394 @@ MissingVolumeMeshPenalty<TFixedPointSet, TMovingPointSet>::GetValueAndDerivative
   derivative = DerivativeType(this->GetNumberOfParameters());
   derivative.Fill(NumericTraits<DerivativeValueType>::ZeroValue());
 
-  NonZeroJacobianIndicesType nzji(this->m_Transform->GetNumberOfNonZeroJacobianIndices());
-  TransformJacobianType      jacobian;
+  /** The number of threads or parameters may have changed since Initialize(). */
+  const ThreadIdType numberOfThreads = this->m_UseMultiThread ? this->GetNumberOfWorkUnits() : 1;
+  if (this->m_MeshPerThreadVariablesSize != numberOfThreads ||
+      (this->m_UseMultiThread && (this->m_GetValueAndDerivativePerThreadVariablesSize != numberOfThreads ||
+                                  this->m_GetValueAndDerivativePerThreadVariables[0].st_Derivative.GetSize() !=
+                                    this->GetNumberOfParameters())))
+  {
+    this->InitializeThreadingParameters();
+  }
 
-  const FixedMeshContainerElementIdentifier numberOfMeshes = this->m_FixedMeshContainer->Size();
+  const SizeValueType                       numberOfPoints = this->m_PointOffsets.back();
+  const SizeValueType                       numberOfCells = this->m_CellOffsets.back();
+  const FixedMeshContainerElementIdentifier numberOfMeshes = this->m_Centroids.size();
 
-  typename MeshPointsContainerType::Pointer pointCentroids = FixedMeshType::PointsContainer::New();
-  pointCentroids->resize(numberOfMeshes);
+  /** Step 1: map the points of all meshes. */
+  if (this->m_UseMultiThread)
+  {
+    this->LaunchThreaderCallback(this->TransformPointsThreaderCallback);
+  }
+  else
+  {
+    this->TransformPointsForRange(0, 0, numberOfPoints);
+  }
 
-  for (FixedMeshContainerElementIdentifier meshId = 0; meshId < numberOfMeshes;
-       ++meshId) // loop over all meshes in container
+  /** Gather the centroids of the mapped meshes. */
+  for (FixedMeshContainerElementIdentifier meshId = 0; meshId < numberOfMeshes; ++meshId)
   {
-    const FixedMeshConstPointer           fixedMesh = fixedMeshContainer->ElementAt(meshId);
-    const MeshPointsContainerConstPointer fixedPoints = fixedMesh->GetPoints();
-    const unsigned int                    numberOfPoints = fixedPoints->Size();
+    VectorType centroidSum(NumericTraits<typename VectorType::ValueType>::ZeroValue());
+    for (ThreadIdType i = 0; i < numberOfThreads; ++i)
+    {
+      VectorType & threadCentroidSum = this->m_MeshPerThreadVariables[i].st_CentroidSums[meshId];
+      centroidSum += threadCentroidSum;
+      threadCentroidSum.Fill(NumericTraits<typename VectorType::ValueType>::ZeroValue());
+    }
+    const SizeValueType numberOfMeshPoints = this->m_PointOffsets[meshId + 1] - this->m_PointOffsets[meshId];
+    if (numberOfMeshPoints > 0)
+    {
+      centroidSum /= static_cast<typename VectorType::ValueType>(numberOfMeshPoints);
+    }
+    for (unsigned int d = 0; d < FixedPointSetDimension; ++d)
+    {
+      this->m_Centroids[meshId][d] = centroidSum[d];
+    }
+  }
 
-    const FixedMeshPointer           mappedMesh = this->m_MappedMeshContainer->ElementAt(meshId);
-    const MeshPointsContainerPointer mappedPoints = mappedMesh->GetPoints();
+  /** Step 2: compute the volumes of the cells of all meshes, and their derivatives
+   * with respect to the mapped points.
+   */
+  if (this->m_UseMultiThread)
+  {
+    this->LaunchThreaderCallback(this->ComputeVolumesThreaderCallback);
+  }
+  else
+  {
+    this->ComputeVolumesForRange(0, 0, numberOfCells);
+  }
 
-    typename FixedMeshType::PointType &              pointCentroid = pointCentroids->ElementAt(meshId);
-    typedef typename FixedMeshType::PointsContainer  FixedMeshPointsContainerType;
-    typename FixedMeshType::PointsContainer::Pointer derivPoints = FixedMeshPointsContainerType::New();
+  for (ThreadIdType i = 0; i < numberOfThreads; ++i)
+  {
+    value += this->m_MeshPerThreadVariables[i].st_Value;
+    this->m_MeshPerThreadVariables[i].st_Value = NumericTraits<MeasureType>::Zero;
+  }
 
-    derivPoints->resize(numberOfPoints);
+  /** Step 3: chain the point derivatives with the transform Jacobian. */
+  if (this->m_UseMultiThread)
+  {
+    this->LaunchThreaderCallback(this->ComputeDerivativeThreaderCallback);
+    this->AccumulateDerivatives(derivative, 1.0);
+  }
+  else
+  {
+    this->ComputeDerivativeForRange(0, numberOfPoints, 1, derivative);
+  }
 
-    MeshPointsContainerConstIteratorType fixedPointIt = fixedPoints->Begin();
-    MeshPointsContainerIteratorType      mappedPointIt = mappedPoints->Begin();
-    MeshPointsContainerConstIteratorType fixedPointEnd = fixedPoints->End();
+} // end GetValueAndDerivative()
+
+
+/**
+ * ******************* TransformPointsForRange *******************
+ */
+
+template <class TFixedPointSet, class TMovingPointSet>
+void
+MissingVolumeMeshPenalty<TFixedPointSet, TMovingPointSet>::TransformPointsForRange(ThreadIdType  threadID,
+                                                                                   SizeValueType pointBegin,
+                                                                                   SizeValueType pointEnd) const
+{
+  if (pointBegin >= pointEnd)
+  {
+    return;
+  }
 
-    for (; fixedPointIt != fixedPointEnd; ++fixedPointIt, ++mappedPointIt)
+  std::vector<VectorType> & centroidSums = this->m_MeshPerThreadVariables[threadID].st_CentroidSums;
+
+  /** Find the mesh of the first point; the offsets are sorted. */
+  std::size_t meshId = std::upper_bound(this->m_PointOffsets.begin(), this->m_PointOffsets.end(), pointBegin) -
+                       this->m_PointOffsets.begin() - 1;
+
+  for (SizeValueType pointId = pointBegin; pointId < pointEnd; ++pointId)
+  {
+    while (pointId >= this->m_PointOffsets[meshId + 1])
     {
-      const OutputPointType mappedPoint = this->m_Transform->TransformPoint(fixedPointIt->Value());
-      mappedPointIt.Value() = mappedPoint;
-      pointCentroid.GetVnlVector() += mappedPoint.GetVnlVector();
+      ++meshId;
     }
-    pointCentroid.GetVnlVector() /= numberOfPoints;
+    const SizeValueType localId = pointId - this->m_PointOffsets[meshId];
 
-    typename FixedMeshType::CellsContainerConstIterator cellBegin = fixedMesh->GetCells()->Begin();
-    typename FixedMeshType::CellsContainerConstIterator cellEnd = fixedMesh->GetCells()->End();
+    const OutputPointType mappedPoint = this->m_Transform->TransformPoint(this->m_FixedPointsData[meshId][localId]);
+    this->m_MappedPointsData[meshId][localId] = mappedPoint;
+    for (unsigned int d = 0; d < FixedPointSetDimension; ++d)
+    {
+      centroidSums[meshId][d] += mappedPoint[d];
+    }
+  }
+
+} // end TransformPointsForRange()
+
+
+/**
+ * ******************* ComputeVolumesForRange *******************
+ */
 
-    typename CellInterfaceType::PointIdIterator beginpointer;
-    float                                       sumSignedVolume = 0.0;
-    float                                       sumAbsVolume = 0.0;
+template <class TFixedPointSet, class TMovingPointSet>
+void
+MissingVolumeMeshPenalty<TFixedPointSet, TMovingPointSet>::ComputeVolumesForRange(ThreadIdType  threadID,
+                                                                                  SizeValueType cellBegin,
+                                                                                  SizeValueType cellEnd) const
+{
+  if (cellBegin >= cellEnd)
+  {
+    return;
+  }
 
-    const float eps = 0.00001;
+  std::vector<VectorType> & derivPoints = this->m_MeshPerThreadVariables[threadID].st_PointsDerivative;
+  MeasureType               sumAbsVolume = NumericTraits<MeasureType>::Zero;
 
-    for (; cellBegin != cellEnd; ++cellBegin)
+  const MeasureType eps = 0.00001;
+
+  /** Find the mesh of the first cell; the offsets are sorted. */
+  std::size_t meshId = std::upper_bound(this->m_CellOffsets.begin(), this->m_CellOffsets.end(), cellBegin) -
+                       this->m_CellOffsets.begin() - 1;
+
+  for (SizeValueType cellId = cellBegin; cellId < cellEnd; ++cellId)
+  {
+    while (cellId >= this->m_CellOffsets[meshId + 1])
     {
-      beginpointer = cellBegin->Value()->PointIdsBegin();
-      float signedVolume; // = vnl_determinant(fullMatrix.GetVnlMatrix());
+      ++meshId;
+    }
+    const MeshPointType *                  mappedPoints = this->m_MappedPointsData[meshId];
+    const MeshPointType &                  pointCentroid = this->m_Centroids[meshId];
+    const SizeValueType                    pointOffset = this->m_PointOffsets[meshId];
+    const FixedMeshPointIdentifier * const pointIds = &this->m_CellPointIds[cellId * FixedPointSetDimension];
+
+    MeasureType signedVolume = NumericTraits<MeasureType>::Zero;
 
-      // const VectorType::const_pointer p1,p2,p3,p4;
-      switch (static_cast<unsigned int>(FixedPointSetDimension))
+    switch (static_cast<unsigned int>(FixedPointSetDimension))
+    {
+      case 2:
       {
-        case 2:
-        {
-          const FixedMeshPointIdentifier p1Id = *beginpointer;
-          ++beginpointer;
-          const VectorType               p1 = mappedPoints->GetElement(p1Id) - pointCentroid;
-          const FixedMeshPointIdentifier p2Id = *beginpointer;
-          ++beginpointer;
-          const VectorType p2 = mappedPoints->GetElement(p2Id) - pointCentroid;
-
-          signedVolume = vnl_determinant(p1.GetDataPointer(), p2.GetDataPointer());
-
-          const int sign = (signedVolume > eps) - (signedVolume < -eps);
-          if (sign != 0)
-          {
-            derivPoints->at(p1Id)[0] += sign * p2[1];
-            derivPoints->at(p1Id)[1] -= sign * p2[0];
-            derivPoints->at(p2Id)[0] -= sign * p1[1];
-            derivPoints->at(p2Id)[1] += sign * p1[0];
-          }
-        }
-        break;
-        case 3:
+        const VectorType p1 = mappedPoints[pointIds[0]] - pointCentroid;
+        const VectorType p2 = mappedPoints[pointIds[1]] - pointCentroid;
+
+        signedVolume = vnl_determinant(p1.GetDataPointer(), p2.GetDataPointer());
+
+        const int sign = (signedVolume > eps) - (signedVolume < -eps);
+        if (sign != 0)
         {
-          const FixedMeshPointIdentifier p1Id = *beginpointer;
-          ++beginpointer;
-          const VectorType               p1 = mappedPoints->GetElement(p1Id) - pointCentroid;
-          const FixedMeshPointIdentifier p2Id = *beginpointer;
-          ++beginpointer;
-          const VectorType               p2 = mappedPoints->GetElement(p2Id) - pointCentroid;
-          const FixedMeshPointIdentifier p3Id = *beginpointer;
-          ++beginpointer;
-          const VectorType p3 = mappedPoints->GetElement(p3Id) - pointCentroid;
-
-          signedVolume = vnl_determinant(p1.GetDataPointer(), p2.GetDataPointer(), p3.GetDataPointer());
-
-          const int sign = ((signedVolume > eps) - (signedVolume < -eps));
-
-          if (sign != 0)
-          {
-            derivPoints->at(p1Id)[0] += sign * (p2[1] * p3[2] - p2[2] * p3[1]);
-            derivPoints->at(p1Id)[1] += sign * (p2[2] * p3[0] - p2[0] * p3[2]);
-            derivPoints->at(p1Id)[2] += sign * (p2[0] * p3[1] - p2[1] * p3[0]);
-
-            derivPoints->at(p2Id)[0] += sign * (p1[2] * p3[1] - p1[1] * p3[2]);
-            derivPoints->at(p2Id)[1] += sign * (p1[0] * p3[2] - p1[2] * p3[0]);
-            derivPoints->at(p2Id)[2] += sign * (p1[1] * p3[0] - p1[0] * p3[1]);
-
-            derivPoints->at(p3Id)[0] += sign * (p1[1] * p2[2] - p1[2] * p2[1]);
-            derivPoints->at(p3Id)[1] += sign * (p1[2] * p2[0] - p1[0] * p2[2]);
-            derivPoints->at(p3Id)[2] += sign * (p1[0] * p2[1] - p1[1] * p2[0]);
-          }
+          VectorType & d1 = derivPoints[pointOffset + pointIds[0]];
+          VectorType & d2 = derivPoints[pointOffset + pointIds[1]];
+          d1[0] += sign * p2[1];
+          d1[1] -= sign * p2[0];
+          d2[0] -= sign * p1[1];
+          d2[1] += sign * p1[0];
         }
+      }
+      break;
+      case 3:
+      {
+        const VectorType p1 = mappedPoints[pointIds[0]] - pointCentroid;
+        const VectorType p2 = mappedPoints[pointIds[1]] - pointCentroid;
+        const VectorType p3 = mappedPoints[pointIds[2]] - pointCentroid;
+
+        signedVolume = vnl_determinant(p1.GetDataPointer(), p2.GetDataPointer(), p3.GetDataPointer());
 
-        break;
-        case 4:
+        const int sign = ((signedVolume > eps) - (signedVolume < -eps));
+        if (sign != 0)
         {
-          const VectorConstPointer p1 = mappedPoints->GetElement(*beginpointer++).GetDataPointer();
-          const VectorConstPointer p2 = mappedPoints->GetElement(*beginpointer++).GetDataPointer();
-          const VectorConstPointer p3 = mappedPoints->GetElement(*beginpointer++).GetDataPointer();
-          const VectorConstPointer p4 = mappedPoints->GetElement(*beginpointer++).GetDataPointer();
-          signedVolume = vnl_determinant(p1, p2, p3, p4);
+          VectorType & d1 = derivPoints[pointOffset + pointIds[0]];
+          VectorType & d2 = derivPoints[pointOffset + pointIds[1]];
+          VectorType & d3 = derivPoints[pointOffset + pointIds[2]];
+
+          d1[0] += sign * (p2[1] * p3[2] - p2[2] * p3[1]);
+          d1[1] += sign * (p2[2] * p3[0] - p2[0] * p3[2]);
+          d1[2] += sign * (p2[0] * p3[1] - p2[1] * p3[0]);
+
+          d2[0] += sign * (p1[2] * p3[1] - p1[1] * p3[2]);
+          d2[1] += sign * (p1[0] * p3[2] - p1[2] * p3[0]);
+          d2[2] += sign * (p1[1] * p3[0] - p1[0] * p3[1]);
+
+          d3[0] += sign * (p1[1] * p2[2] - p1[2] * p2[1]);
+          d3[1] += sign * (p1[2] * p2[0] - p1[0] * p2[2]);
+          d3[2] += sign * (p1[0] * p2[1] - p1[1] * p2[0]);
         }
-        break;
-        default:
-          std::cout << "no dimensions higher than 4" << std::endl;
       }
+      break;
+      case 4:
+      {
+        const VectorConstPointer p1 = mappedPoints[pointIds[0]].GetDataPointer();
+        const VectorConstPointer p2 = mappedPoints[pointIds[1]].GetDataPointer();
+        const VectorConstPointer p3 = mappedPoints[pointIds[2]].GetDataPointer();
+        const VectorConstPointer p4 = mappedPoints[pointIds[3]].GetDataPointer();
+        signedVolume = vnl_determinant(p1, p2, p3, p4);
+      }
+      break;
+      default:
+        std::cout << "no dimensions higher than 4" << std::endl;
+    }
+
+    sumAbsVolume += std::abs(signedVolume);
+  }
+
+  this->m_MeshPerThreadVariables[threadID].st_Value += sumAbsVolume;
+
+} // end ComputeVolumesForRange()
 
-      sumSignedVolume += signedVolume;
-      sumAbsVolume += std::abs(signedVolume);
+
+/**
+ * ******************* ComputeDerivativeForRange *******************
+ */
+
+template <class TFixedPointSet, class TMovingPointSet>
+void
+MissingVolumeMeshPenalty<TFixedPointSet, TMovingPointSet>::ComputeDerivativeForRange(SizeValueType    pointBegin,
+                                                                                     SizeValueType    pointEnd,
+                                                                                     ThreadIdType     numberOfThreads,
+                                                                                     DerivativeType & derivative) const
+{
+  if (pointBegin >= pointEnd)
+  {
+    return;
+  }
+
+  NonZeroJacobianIndicesType nzji(this->m_Transform->GetNumberOfNonZeroJacobianIndices());
+  TransformJacobianType      jacobian;
+
+  const typename VectorType::ValueType zero = NumericTraits<typename VectorType::ValueType>::ZeroValue();
+
+  /** Find the mesh of the first point; the offsets are sorted. */
+  std::size_t meshId = std::upper_bound(this->m_PointOffsets.begin(), this->m_PointOffsets.end(), pointBegin) -
+                       this->m_PointOffsets.begin() - 1;
+
+  for (SizeValueType pointId = pointBegin; pointId < pointEnd; ++pointId)
+  {
+    while (pointId >= this->m_PointOffsets[meshId + 1])
+    {
+      ++meshId;
     }
 
-    /** Create iterators. */
-    fixedPointIt = fixedPoints->Begin();
-    unsigned int pointIndex;
-    /** Loop over points. */
-    for (pointIndex = 0; fixedPointIt != fixedPointEnd; ++fixedPointIt, ++pointIndex)
+    /** Sum the derivatives of this point of all threads, and reset them for the next call. */
+    VectorType derivPoint(zero);
+    for (ThreadIdType i = 0; i < numberOfThreads; ++i)
     {
-      /** Get the TransformJacobian dT/dmu. */
-      this->m_Transform->GetJacobian(fixedPointIt.Value(), jacobian, nzji);
-      if (nzji.size() == this->GetNumberOfParameters())
-      {
-        /** Loop over all Jacobians. */
-        derivative += derivPoints->at(pointIndex).GetVnlVector() * jacobian; //* sumAbsVolumeEps;
-      }
-      else
+      VectorType & threadDerivPoint = this->m_MeshPerThreadVariables[i].st_PointsDerivative[pointId];
+      derivPoint += threadDerivPoint;
+      threadDerivPoint.Fill(zero);
+    }
+
+    /** Points that are not part of a cell with a non-zero volume do not contribute. */
+    if (derivPoint.GetSquaredNorm() == zero)
+    {
+      continue;
+    }
+
+    /** Get the TransformJacobian dT/dmu. */
+    const MeshPointType & fixedPoint = this->m_FixedPointsData[meshId][pointId - this->m_PointOffsets[meshId]];
+    this->m_Transform->GetJacobian(fixedPoint, jacobian, nzji);
+    if (nzji.size() == this->GetNumberOfParameters())
+    {
+      /** Loop over all Jacobians. */
+      derivative += derivPoint.GetVnlVector() * jacobian;
+    }
+    else
+    {
+      /** Only pick the nonzero Jacobians. */
+      for (unsigned int i = 0; i < nzji.size(); ++i)
       {
-        /** Only pick the nonzero Jacobians. */
-        for (unsigned int i = 0; i < nzji.size(); ++i)
-        {
-          const unsigned int index = nzji[i];
-          VnlVectorType      column = jacobian.get_column(i);
-          derivative[index] += dot_product(derivPoints->at(pointIndex).GetVnlVector(), column); // *sumAbsVolumeEps;
-        }
+        const unsigned int index = nzji[i];
+        VnlVectorType      column = jacobian.get_column(i);
+        derivative[index] += dot_product(derivPoint.GetVnlVector(), column);
       }
+    }
+  }
+
+} // end ComputeDerivativeForRange()
+
 
-    } // end loop over all corresponding points
+/**
+ * ******************* TransformPointsThreaderCallback *******************
+ */
+
+template <class TFixedPointSet, class TMovingPointSet>
+ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION
+MissingVolumeMeshPenalty<TFixedPointSet, TMovingPointSet>::TransformPointsThreaderCallback(void * arg)
+{
+  ThreadInfoType * infoStruct = static_cast<ThreadInfoType *>(arg);
+  ThreadIdType     threadID = infoStruct->WorkUnitID;
 
-    /** Check if enough samples were valid. */
+  typedef typename Superclass::MultiThreaderParameterType MultiThreaderParameterType;
+  MultiThreaderParameterType * temp = static_cast<MultiThreaderParameterType *>(infoStruct->UserData);
+  const Self *                 metric = static_cast<const Self *>(temp->st_Metric);
 
-    /** Copy the measure to value. */
-    value += sumAbsVolume;
+  SizeValueType pointBegin = 0;
+  SizeValueType pointEnd = 0;
+  metric->GetRangeForThread(threadID, metric->m_PointOffsets.back(), pointBegin, pointEnd);
+  metric->TransformPointsForRange(threadID, pointBegin, pointEnd);
 
-  } // end loop over all meshes in container
-} // end GetValueAndDerivative()
+  return itk::ITK_THREAD_RETURN_DEFAULT_VALUE;
+
+} // end TransformPointsThreaderCallback()
+
+
+/**
+ * ******************* ComputeVolumesThreaderCallback *******************
+ */
+
+template <class TFixedPointSet, class TMovingPointSet>
+ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION
+MissingVolumeMeshPenalty<TFixedPointSet, TMovingPointSet>::ComputeVolumesThreaderCallback(void * arg)
+{
+  ThreadInfoType * infoStruct = static_cast<ThreadInfoType *>(arg);
+  ThreadIdType     threadID = infoStruct->WorkUnitID;
+
+  typedef typename Superclass::MultiThreaderParameterType MultiThreaderParameterType;
+  MultiThreaderParameterType * temp = static_cast<MultiThreaderParameterType *>(infoStruct->UserData);
+  const Self *                 metric = static_cast<const Self *>(temp->st_Metric);
+
+  SizeValueType cellBegin = 0;
+  SizeValueType cellEnd = 0;
+  metric->GetRangeForThread(threadID, metric->m_CellOffsets.back(), cellBegin, cellEnd);
+  metric->ComputeVolumesForRange(threadID, cellBegin, cellEnd);
+
+  return itk::ITK_THREAD_RETURN_DEFAULT_VALUE;
+
+} // end ComputeVolumesThreaderCallback()
+
+
+/**
+ * ******************* ComputeDerivativeThreaderCallback *******************
+ */
+
+template <class TFixedPointSet, class TMovingPointSet>
+ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION
+MissingVolumeMeshPenalty<TFixedPointSet, TMovingPointSet>::ComputeDerivativeThreaderCallback(void * arg)
+{
+  ThreadInfoType * infoStruct = static_cast<ThreadInfoType *>(arg);
+  ThreadIdType     threadID = infoStruct->WorkUnitID;
+  ThreadIdType     nrOfThreads = infoStruct->NumberOfWorkUnits;
+
+  typedef typename Superclass::MultiThreaderParameterType MultiThreaderParameterType;
+  MultiThreaderParameterType * temp = static_cast<MultiThreaderParameterType *>(infoStruct->UserData);
+  const Self *                 metric = static_cast<const Self *>(temp->st_Metric);
+
+  SizeValueType pointBegin = 0;
+  SizeValueType pointEnd = 0;
+  metric->GetRangeForThread(threadID, metric->m_PointOffsets.back(), pointBegin, pointEnd);
+  metric->ComputeDerivativeForRange(
+    pointBegin, pointEnd, nrOfThreads, metric->m_GetValueAndDerivativePerThreadVariables[threadID].st_Derivative);
+
+  return itk::ITK_THREAD_RETURN_DEFAULT_VALUE;
+
+} // end ComputeDerivativeThreaderCallback()
+
+
+/**
+ * ******************* LaunchThreaderCallback *******************
+ */
+
+template <class TFixedPointSet, class TMovingPointSet>
+void
+MissingVolumeMeshPenalty<TFixedPointSet, TMovingPointSet>::LaunchThreaderCallback(ThreadFunctionType callback) const
+{
+  /** Setup threader. */
+  this->m_Threader->SetSingleMethod(callback,
+                                    const_cast<void *>(static_cast<const void *>(&this->m_ThreaderMetricParameters)));
+
+  /** Launch. */
+  this->m_Threader->SingleMethodExecute();
+
+} // end LaunchThreaderCallback()
 
 
 /**
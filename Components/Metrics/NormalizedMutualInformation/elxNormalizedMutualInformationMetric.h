@@ -64,6 +64,21 @@ namespace elastix
  *    useful if you use high order B-spline interpolator for the moving image.\n
  *    example: <tt>(MovingLimitRangeRatio 0.001 0.01 0.01)</tt> \n
  *    The default value is 0.01. Can be given for each resolution, or for all resolutions at once.
+ * \parameter UseFastAndLowMemoryVersion: Switch between a version of normalized mutual
+ *    information that explicitly computes the derivatives of the joint histogram to each
+ *    transformation parameter (false) and a version that loops twice over the samples,
+ *    but avoids the large 3D matrix of size NumberOfFixedHistogramBins *
+ *    NumberOfMovingHistogramBins * number of parameters (true). Like for the
+ *    AdvancedMattesMutualInformation metric, the second version is multi-threaded.\n
+ *    example: <tt>(UseFastAndLowMemoryVersion "true")</tt> \n
+ *    The default is "false". Can be given for each resolution, or for all resolutions at once.
+ * \parameter MaximumJointPDFDerivativesMemorySize: The maximum size in megabytes of
+ *    the 3D matrix that is used when UseFastAndLowMemoryVersion is "false". For more
+ *    parameters, the matrix is computed per block of parameters, each block within
+ *    this size for all threads together, at the cost of a loop over the samples per
+ *    block. Can be given for each resolution, or for all resolutions at once. \n
+ *    example: <tt>(MaximumJointPDFDerivativesMemorySize 512)</tt> \n
+ *    The default is 1024.
  *
  * \sa ParzenWindowNormalizedMutualInformationImageToImageMetric
  * \ingroup Metrics
@@ -99,6 +99,21 @@ NormalizedMutualInformationMetric<TElastix>::BeforeEachResolution(void)
   this->SetFixedKernelBSplineOrder(fixedKernelBSplineOrder);
   this->SetMovingKernelBSplineOrder(movingKernelBSplineOrder);
 
+  /** Set whether a low memory consumption should be used. */
+  bool useFastAndLowMemoryVersion = false;
+  this->GetConfiguration()->ReadParameter(
+    useFastAndLowMemoryVersion, "UseFastAndLowMemoryVersion", this->GetComponentLabel(), level, 0);
+  this->SetUseExplicitPDFDerivatives(!useFastAndLowMemoryVersion);
+
+  /** Set the maximum memory size of the explicit joint histogram derivatives. */
+  double maximumJointPDFDerivativesMemorySize = 1024.0;
+  this->GetConfiguration()->ReadParameter(maximumJointPDFDerivativesMemorySize,
+                                          "MaximumJointPDFDerivativesMemorySize",
+                                          this->GetComponentLabel(),
+                                          level,
+                                          0);
+  this->SetMaximumJointPDFDerivativesMemorySize(maximumJointPDFDerivativesMemorySize);
+
 } // end BeforeEachResolution()
 
 
@@ -21,6 +21,8 @@
 
 #include "itkParzenWindowHistogramImageToImageMetric.h"
 
+#include "itkArray2D.h"
+
 namespace itk
 {
 
@@ -39,6 +41,13 @@ namespace itk
  * Construction of the PDFs is implemented in the superclass
  * ParzenWindowHistogramImageToImageMetric.
  *
+ * Like the ParzenWindowMutualInformationImageToImageMetric, the derivative
+ * is computed either with the explicit joint histogram derivatives
+ * (UseExplicitPDFDerivatives == true), or in a low memory fashion, which
+ * loops twice over the samples: first to compute the PDFs, and then to
+ * accumulate the derivative from the precomputed ratio of each histogram bin.
+ * Both loops are multi-threaded when UseMultiThread == true.
+ *
  * This implementation of the NormalizedMutualInformation is based on the
  * AdvancedImageToImageMetric, which means that:
  * \li It uses the ImageSampler-framework
@@ -99,6 +108,7 @@ public:
   using typename Superclass::OutputPointType;
   using typename Superclass::TransformParametersType;
   using typename Superclass::TransformJacobianType;
+  using typename Superclass::NumberOfParametersType;
   using typename Superclass::InterpolatorType;
   using typename Superclass::InterpolatorPointer;
   using typename Superclass::RealType;
@@ -113,6 +123,7 @@ public:
   using typename Superclass::MovingImageMaskPointer;
   using typename Superclass::MeasureType;
   using typename Superclass::DerivativeType;
+  using typename Superclass::DerivativeValueType;
   using typename Superclass::ParametersType;
   using typename Superclass::FixedImagePixelType;
   using typename Superclass::MovingImageRegionType;
@@ -125,6 +136,8 @@ public:
   using typename Superclass::FixedImageLimiterOutputType;
   using typename Superclass::MovingImageLimiterOutputType;
   using typename Superclass::MovingImageDerivativeScalesType;
+  using typename Superclass::ThreaderType;
+  using typename Superclass::ThreadInfoType;
 
   /** The fixed image dimension. */
   itkStaticConstMacro(FixedImageDimension, unsigned int, FixedImageType::ImageDimension);
@@ -144,7 +157,7 @@ public:
 
 protected:
   /** The constructor. */
-  ParzenWindowNormalizedMutualInformationImageToImageMetric() = default;
+  ParzenWindowNormalizedMutualInformationImageToImageMetric();
 
   /** The destructor. */
   ~ParzenWindowNormalizedMutualInformationImageToImageMetric() override = default;
@@ -168,6 +181,7 @@ protected:
   using typename Superclass::PDFValueType;
   using typename Superclass::MarginalPDFType;
   using typename Superclass::JointPDFType;
+  using typename Superclass::JointPDFPointer;
   using typename Superclass::JointPDFDerivativesType;
   using typename Superclass::IncrementalMarginalPDFType;
   using typename Superclass::JointPDFIndexType;
@@ -194,12 +208,68 @@ protected:
   virtual MeasureType
   ComputeNormalizedMutualInformation(MeasureType & jointEntropy) const;
 
+  /** Some initialization functions, called by Initialize. */
+  void
+  InitializeHistograms(void) override;
+
+  /** Get the value and derivative, without the explicit joint histogram
+   * derivatives. Called by GetValueAndDerivative if UseExplicitPDFDerivatives == false.
+   *
+   * This avoids the large memory allocation of the explicit joint histogram
+   * derivative, at the cost of looping over the samples twice. The first time
+   * does not require the transform Jacobian and moving image derivatives.
+   */
+  virtual void
+  GetValueAndAnalyticDerivativeLowMemory(const ParametersType & parameters,
+                                         MeasureType &          value,
+                                         DerivativeType &       derivative) const;
+
+  /** Threading related parameters. */
+  struct ParzenWindowNormalizedMutualInformationMultiThreaderParameterType
+  {
+    Self * m_Metric;
+  };
+  ParzenWindowNormalizedMutualInformationMultiThreaderParameterType
+    m_ParzenWindowNormalizedMutualInformationThreaderParameters;
+
+  /** Multi-threaded version of the derivative computation of the low memory variant. */
+  inline void
+  ThreadedComputeDerivativeLowMemory(ThreadIdType threadId);
+
+  /** Helper function to launch the threads. */
+  static ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION
+  ComputeDerivativeLowMemoryThreaderCallback(void * arg);
+
 private:
   /** The deleted copy constructor. */
   ParzenWindowNormalizedMutualInformationImageToImageMetric(const Self &) = delete;
   /** The deleted assignment operator. */
   void
   operator=(const Self &) = delete;
+
+  /** Helper array for storing the weights of the joint PDF bins. */
+  typedef double              PRatioType;
+  typedef Array2D<PRatioType> PRatioArrayType;
+  mutable PRatioArrayType     m_PRatioArray;
+
+  /** Helper function to compute m_PRatioArray from the joint PDF and the log marginal PDFs. */
+  void
+  ComputePRatioArray(const MeasureType nMI, const MeasureType jointEntropy) const;
+
+  /** Helper functions to compute the derivative for the low memory variant. */
+  void
+  ComputeDerivativeLowMemorySingleThreaded(DerivativeType & derivative) const;
+
+  void
+  ComputeDerivativeLowMemory(DerivativeType & derivative) const;
+
+  /** Helper function to update the derivative for the low memory variant. */
+  void
+  UpdateDerivativeLowMemory(const RealType &                   fixedImageValue,
+                            const RealType &                   movingImageValue,
+                            const DerivativeType &             imageJacobian,
+                            const NonZeroJacobianIndicesType & nzji,
+                            DerivativeType &                   derivative) const;
 };
 
 } // end namespace itk
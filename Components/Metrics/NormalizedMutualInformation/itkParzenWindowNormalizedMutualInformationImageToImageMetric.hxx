@@ -22,11 +22,28 @@
 #include "itkParzenWindowNormalizedMutualInformationImageToImageMetric.h"
 
 #include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkImageLinearIteratorWithIndex.h"
+#include "itkImageScanlineConstIterator.h"
 #include <vnl/vnl_math.h>
 
 namespace itk
 {
 
+/**
+ * ********************* Constructor ******************************
+ */
+
+template <class TFixedImage, class TMovingImage>
+ParzenWindowNormalizedMutualInformationImageToImageMetric<
+  TFixedImage,
+  TMovingImage>::ParzenWindowNormalizedMutualInformationImageToImageMetric()
+{
+  /** Initialize the m_ParzenWindowNormalizedMutualInformationThreaderParameters. */
+  this->m_ParzenWindowNormalizedMutualInformationThreaderParameters.m_Metric = this;
+
+} // end constructor
+
+
 /**
  * ********************* PrintSelf ******************************
  *
@@ -46,6 +63,26 @@ ParzenWindowNormalizedMutualInformationImageToImageMetric<TFixedImage, TMovingIm
 } // end PrintSelf()
 
 
+/**
+ * ********************* InitializeHistograms ******************************
+ */
+
+template <class TFixedImage, class TMovingImage>
+void
+ParzenWindowNormalizedMutualInformationImageToImageMetric<TFixedImage, TMovingImage>::InitializeHistograms(void)
+{
+  /** Call Superclass implementation. */
+  this->Superclass::InitializeHistograms();
+
+  /** Allocate small amount of memory for the m_PRatioArray. */
+  if (!this->GetUseExplicitPDFDerivatives())
+  {
+    this->m_PRatioArray.SetSize(this->GetNumberOfFixedHistogramBins(), this->GetNumberOfMovingHistogramBins());
+  }
+
+} // end InitializeHistograms()
+
+
 /**
  * ********************** ComputeLogMarginalPDF***********************
  */
@@ -182,6 +219,12 @@ ParzenWindowNormalizedMutualInformationImageToImageMetric<TFixedImage, TMovingIm
   derivative = DerivativeType(this->GetNumberOfParameters());
   derivative.Fill(NumericTraits<double>::ZeroValue());
 
+  /** Avoid the explicit joint histogram derivatives, if desired. */
+  if (!this->GetUseExplicitPDFDerivatives())
+  {
+    return this->GetValueAndAnalyticDerivativeLowMemory(parameters, value, derivative);
+  }
+
   /** Construct the JointPDF, JointPDFDerivatives, and Alpha. */
   this->ComputePDFsAndPDFDerivatives(parameters);
 
@@ -208,39 +251,38 @@ ParzenWindowNormalizedMutualInformationImageToImageMetric<TFixedImage, TMovingIm
    * where:
    * dpdmu(i,k) = alpha dhdmu(i,k)
    *
-   * m_JointPDFDerivatives reflects dhdmu(i,k) at this point in the code.
+   * dhdmu(i,k) is computed by ComputePDFsAndPDFDerivatives() or, for many
+   * parameters, per block in ComputeDerivativeFromJointPDFDerivatives().
    * p = m_JointPDF reflects [alpha h(i,k)]
    *
    * So, we can write, following more or less the source code below:
    * -dNMI/dmu = - sum_k sum_i dhdmu(i,k) alpha*pRatio/Ej
+   * where alpha*pRatio/Ej is the weight of bin (i,k).
    **/
 
   /** Typedefs for iterators */
-  typedef ImageLinearConstIteratorWithIndex<JointPDFDerivativesType> JointPDFDerivativesConstIteratorType;
-  typedef typename DerivativeType::iterator                          DerivativeIteratorType;
-  typedef typename DerivativeType::const_iterator                    DerivativeConstIteratorType;
-  typedef ImageLinearConstIteratorWithIndex<JointPDFType>            JointPDFConstIteratorType;
-  typedef typename MarginalPDFType::const_iterator                   MarginalPDFConstIteratorType;
+  typedef ImageLinearConstIteratorWithIndex<JointPDFType> JointPDFConstIteratorType;
+  typedef ImageLinearIteratorWithIndex<JointPDFType>      BinWeightsIteratorType;
+  typedef typename MarginalPDFType::const_iterator        MarginalPDFConstIteratorType;
 
   /** Setup iterators */
-  JointPDFDerivativesConstIteratorType jointPDFDerivativesConstit(
-    this->m_JointPDFDerivatives, this->m_JointPDFDerivatives->GetLargestPossibleRegion());
-  jointPDFDerivativesConstit.SetDirection(0);
-  jointPDFDerivativesConstit.GoToBegin();
-
   JointPDFConstIteratorType jointPDFconstit(this->m_JointPDF, this->m_JointPDF->GetLargestPossibleRegion());
   jointPDFconstit.SetDirection(0);
   jointPDFconstit.GoToBegin();
 
-  DerivativeIteratorType            derivit = derivative.begin();
-  const DerivativeConstIteratorType derivend = derivative.end();
+  JointPDFPointer binWeights = JointPDFType::New();
+  binWeights->SetRegions(this->m_JointPDF->GetLargestPossibleRegion());
+  binWeights->Allocate(true);
+  BinWeightsIteratorType binWeightsit(binWeights, binWeights->GetLargestPossibleRegion());
+  binWeightsit.SetDirection(0);
+  binWeightsit.GoToBegin();
 
   MarginalPDFConstIteratorType       fixedPDFconstit = this->m_FixedImageMarginalPDF.begin();
   MarginalPDFConstIteratorType       movingPDFconstit = this->m_MovingImageMarginalPDF.begin();
   const MarginalPDFConstIteratorType fixedPDFend = this->m_FixedImageMarginalPDF.end();
   const MarginalPDFConstIteratorType movingPDFend = this->m_MovingImageMarginalPDF.end();
 
-  /** Compute the derivatives */
+  /** Compute the bin weights */
   while (fixedPDFconstit != fixedPDFend)
   {
     const double logFixedImagePDFValue = *fixedPDFconstit;
@@ -249,31 +291,444 @@ ParzenWindowNormalizedMutualInformationImageToImageMetric<TFixedImage, TMovingIm
     {
       const double logMovingImagePDFValue = *movingPDFconstit;
       const double jointPDFValue = jointPDFconstit.Get();
+      /** check for non-zero bin contribution */
       if (jointPDFValue > 1e-16)
       {
         const double pRatio =
           (nMI * std::log(jointPDFValue) - logFixedImagePDFValue - logMovingImagePDFValue) / jointEntropy;
-        const double pRatioAlpha = this->m_Alpha * pRatio;
-        /** check for non-zero bin contribution */
-        derivit = derivative.begin();
-        while (derivit != derivend)
-        {
-          (*derivit) -= jointPDFDerivativesConstit.Get() * pRatioAlpha;
-          ++derivit;
-          ++jointPDFDerivativesConstit;
-        } // end while-loop over parameters
-      }   // end if-block to check non-zero bin contribution
+        binWeightsit.Set(this->m_Alpha * pRatio);
+      } // end if-block to check non-zero bin contribution
       ++movingPDFconstit;
       ++jointPDFconstit;
-      jointPDFDerivativesConstit.NextLine();
+      ++binWeightsit;
     } // end while-loop over moving index
     ++fixedPDFconstit;
     jointPDFconstit.NextLine();
+    binWeightsit.NextLine();
   } // end while-loop over fixed index
 
+  /** Compute the derivatives */
+  this->ComputeDerivativeFromJointPDFDerivatives(*binWeights, derivative);
+
 } // end GetValueAndDerivative
 
 
+/**
+ * ******************** GetValueAndAnalyticDerivativeLowMemory *******************
+ */
+
+template <class TFixedImage, class TMovingImage>
+void
+ParzenWindowNormalizedMutualInformationImageToImageMetric<TFixedImage, TMovingImage>::
+  GetValueAndAnalyticDerivativeLowMemory(const ParametersType & parameters,
+                                         MeasureType &          value,
+                                         DerivativeType &       derivative) const
+{
+  /** Construct the JointPDF and Alpha.
+   * This function contains a loop over the samples.
+   * It executes multi-threadedly when m_UseMultiThread == true.
+   */
+  this->ComputePDFs(parameters);
+
+  /** Normalize the pdfs: p = alpha h */
+  this->NormalizeJointPDF(this->m_JointPDF, this->m_Alpha);
+
+  /** Compute the fixed and moving marginal pdf by summing over the histogram */
+  this->ComputeMarginalPDF(this->m_JointPDF, this->m_FixedImageMarginalPDF, 0);
+  this->ComputeMarginalPDF(this->m_JointPDF, this->m_MovingImageMarginalPDF, 1);
+
+  /** Replace the probabilities by log(probabilities) */
+  this->ComputeLogMarginalPDF(this->m_FixedImageMarginalPDF);
+  this->ComputeLogMarginalPDF(this->m_MovingImageMarginalPDF);
+
+  /** Compute the measure and joint entropy (which we both need to compute the derivative) */
+  MeasureType       jointEntropy = 0.0;
+  const MeasureType nMI = this->ComputeNormalizedMutualInformation(jointEntropy);
+  value = static_cast<MeasureType>(-1.0 * nMI);
+
+  /** Compute the intermediate m_PRatioArray by summation over the joint histogram. */
+  this->ComputePRatioArray(nMI, jointEntropy);
+
+  /* Compute the derivative.
+   * This function contains a second loop over the samples.
+   * It executes multi-threadedly when m_UseMultiThread == true.
+   */
+  this->ComputeDerivativeLowMemory(derivative);
+
+} // end GetValueAndAnalyticDerivativeLowMemory()
+
+
+/**
+ * ******************* ComputePRatioArray *******************
+ */
+
+template <class TFixedImage, class TMovingImage>
+void
+ParzenWindowNormalizedMutualInformationImageToImageMetric<TFixedImage, TMovingImage>::ComputePRatioArray(
+  const MeasureType nMI,
+  const MeasureType jointEntropy) const
+{
+  /** The weight of each bin in the derivative, see GetValueAndDerivative():
+   * alpha * pRatio / Ej = alpha ( NMI log(p(i,k)) - log(pf(k)) - log(pm(i)) ) / Ej
+   * Assumes the marginal pdfs are already log'ed.
+   */
+  typedef ImageScanlineConstIterator<JointPDFType> JointPDFIteratorType;
+  typedef typename MarginalPDFType::const_iterator MarginalPDFIteratorType;
+
+  JointPDFIteratorType          jointPDFit(this->m_JointPDF, this->m_JointPDF->GetLargestPossibleRegion());
+  MarginalPDFIteratorType       fixedPDFit = this->m_FixedImageMarginalPDF.begin();
+  const MarginalPDFIteratorType fixedPDFend = this->m_FixedImageMarginalPDF.end();
+  MarginalPDFIteratorType       movingPDFit;
+  const MarginalPDFIteratorType movingPDFbegin = this->m_MovingImageMarginalPDF.begin();
+  const MarginalPDFIteratorType movingPDFend = this->m_MovingImageMarginalPDF.end();
+
+  /** Initialize */
+  this->m_PRatioArray.Fill(itk::NumericTraits<PRatioType>::ZeroValue());
+
+  /** Loop over the joint histogram. */
+  unsigned int fixedIndex = 0;
+  while (fixedPDFit != fixedPDFend)
+  {
+    const double logFixedImagePDFValue = *fixedPDFit;
+    movingPDFit = movingPDFbegin;
+    unsigned int movingIndex = 0;
+
+    while (movingPDFit != movingPDFend)
+    {
+      const double logMovingImagePDFValue = *movingPDFit;
+      const double jointPDFValue = jointPDFit.Value();
+
+      /** Check for non-zero bin contribution. */
+      if (jointPDFValue > 1e-16)
+      {
+        const double pRatio =
+          (nMI * std::log(jointPDFValue) - logFixedImagePDFValue - logMovingImagePDFValue) / jointEntropy;
+        this->m_PRatioArray[fixedIndex][movingIndex] = static_cast<PRatioType>(this->m_Alpha * pRatio);
+      }
+
+      /** Update iterators. */
+      ++movingPDFit;
+      ++jointPDFit;
+      ++movingIndex;
+
+    } // end while-loop over moving index
+
+    /** Update iterators. */
+    ++fixedPDFit;
+    jointPDFit.NextLine();
+    ++fixedIndex;
+
+  } // end while-loop over fixed index
+
+} // end ComputePRatioArray()
+
+
+/**
+ * ******************** ComputeDerivativeLowMemorySingleThreaded *******************
+ */
+
+template <class TFixedImage, class TMovingImage>
+void
+ParzenWindowNormalizedMutualInformationImageToImageMetric<TFixedImage, TMovingImage>::
+  ComputeDerivativeLowMemorySingleThreaded(DerivativeType & derivative) const
+{
+  /** Initialize array that stores dM(x)/dmu, and the sparse Jacobian + indices. */
+  const NumberOfParametersType nnzji = this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices();
+  NonZeroJacobianIndicesType   nzji = NonZeroJacobianIndicesType(nnzji);
+  DerivativeType               imageJacobian(nzji.size());
+  TransformJacobianType        jacobian;
+  derivative.Fill(NumericTraits<double>::ZeroValue());
+
+  /** Get a handle to the sample container. */
+  ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
+
+  /** Create iterator over the sample container. */
+  typename ImageSampleContainerType::ConstIterator fiter;
+  typename ImageSampleContainerType::ConstIterator fbegin = sampleContainer->Begin();
+  typename ImageSampleContainerType::ConstIterator fend = sampleContainer->End();
+
+  /** Loop over sample container and compute contribution of each sample to the derivative. */
+  for (fiter = fbegin; fiter != fend; ++fiter)
+  {
+    /** Read fixed coordinates and create some variables. */
+    const FixedImagePointType & fixedPoint = (*fiter).Value().m_ImageCoordinates;
+    RealType                    movingImageValue;
+    MovingImageDerivativeType   movingImageDerivative;
+    MovingImagePointType        mappedPoint;
+
+    /** Transform point and check if it is inside the B-spline support region. */
+    bool sampleOk = this->TransformPoint(fixedPoint, mappedPoint);
+
+    /** Check if the point is inside the moving mask. */
+    if (sampleOk)
+    {
+      sampleOk = this->IsInsideMovingMask(mappedPoint);
+    }
+
+    /** Compute the moving image value, its derivative, and check
+     * if the point is inside the moving image buffer.
+     */
+    if (sampleOk)
+    {
+      sampleOk =
+        this->Superclass::EvaluateMovingImageValueAndDerivative(mappedPoint, movingImageValue, &movingImageDerivative);
+    }
+
+    if (sampleOk)
+    {
+      /** Get the fixed image value. */
+      RealType fixedImageValue = static_cast<RealType>((*fiter).Value().m_ImageValue);
+
+      /** Make sure the values fall within the histogram range. */
+      fixedImageValue = this->GetFixedImageLimiter()->Evaluate(fixedImageValue);
+      movingImageValue = this->GetMovingImageLimiter()->Evaluate(movingImageValue, movingImageDerivative);
+
+      /** Get the transform Jacobian dT/dmu. */
+      this->EvaluateTransformJacobian(fixedPoint, jacobian, nzji);
+
+      /** Compute the inner product (dM/dx)^T (dT/dmu). */
+      this->EvaluateTransformJacobianInnerProduct(jacobian, movingImageDerivative, imageJacobian);
+
+      /** Compute this sample's contribution to the derivative. */
+      this->UpdateDerivativeLowMemory(fixedImageValue, movingImageValue, imageJacobian, nzji, derivative);
+
+    } // end sampleOk
+  }   // end loop over sample container
+
+} // end ComputeDerivativeLowMemorySingleThreaded()
+
+
+/**
+ * ******************** ComputeDerivativeLowMemory *******************
+ */
+
+template <class TFixedImage, class TMovingImage>
+void
+ParzenWindowNormalizedMutualInformationImageToImageMetric<TFixedImage, TMovingImage>::ComputeDerivativeLowMemory(
+  DerivativeType & derivative) const
+{
+  /** Option for now to still use the single threaded code. */
+  if (!this->m_UseMultiThread)
+  {
+    return this->ComputeDerivativeLowMemorySingleThreaded(derivative);
+  }
+
+  /** Launch multi-threading derivative computation. */
+  this->m_MetricThreader->SetSingleMethod(
+    this->ComputeDerivativeLowMemoryThreaderCallback,
+    const_cast<void *>(static_cast<const void *>(&this->m_ParzenWindowNormalizedMutualInformationThreaderParameters)));
+  this->m_MetricThreader->SingleMethodExecute();
+
+  /** Gather the results from all threads, which also resets the per-thread derivatives. */
+  this->m_ThreaderMetricParameters.st_DerivativePointer = derivative.begin();
+  this->m_ThreaderMetricParameters.st_NormalizationFactor = 1.0;
+
+  this->m_MetricThreader->SetSingleMethod(
+    this->AccumulateDerivativesThreaderCallback,
+    const_cast<void *>(static_cast<const void *>(&this->m_ThreaderMetricParameters)));
+  this->m_MetricThreader->SingleMethodExecute();
+
+} // end ComputeDerivativeLowMemory()
+
+
+/**
+ * ******************* ThreadedComputeDerivativeLowMemory *******************
+ */
+
+template <class TFixedImage, class TMovingImage>
+void
+ParzenWindowNormalizedMutualInformationImageToImageMetric<TFixedImage, TMovingImage>::
+  ThreadedComputeDerivativeLowMemory(ThreadIdType threadId)
+{
+  /** Initialize array that stores dM(x)/dmu, and the sparse Jacobian + indices. */
+  const NumberOfParametersType nnzji = this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices();
+  NonZeroJacobianIndicesType   nzji = NonZeroJacobianIndicesType(nnzji);
+  DerivativeType               imageJacobian(nzji.size());
+
+  /** Get a handle to the pre-allocated derivative for the current thread.
+   * The initialization is performed at the beginning of each resolution in
+   * InitializeThreadingParameters(), and at the end of each iteration in
+   * AccumulateDerivativesThreaderCallback().
+   */
+  DerivativeType & derivative = this->m_GetValueAndDerivativePerThreadVariables[threadId].st_Derivative;
+
+  /** Get a handle to the sample container. */
+  ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
+  const unsigned long         sampleContainerSize = sampleContainer->Size();
+
+  /** Get the samples for this thread. */
+  const unsigned long nrOfSamplesPerThreads = static_cast<unsigned long>(
+    std::ceil(static_cast<double>(sampleContainerSize) / static_cast<double>(Self::GetNumberOfWorkUnits())));
+
+  unsigned long pos_begin = nrOfSamplesPerThreads * threadId;
+  unsigned long pos_end = nrOfSamplesPerThreads * (threadId + 1);
+  pos_begin = (pos_begin > sampleContainerSize) ? sampleContainerSize : pos_begin;
+  pos_end = (pos_end > sampleContainerSize) ? sampleContainerSize : pos_end;
+
+  /** Create iterator over the sample container. */
+  typename ImageSampleContainerType::ConstIterator fiter;
+  typename ImageSampleContainerType::ConstIterator fbegin = sampleContainer->Begin();
+  typename ImageSampleContainerType::ConstIterator fend = sampleContainer->Begin();
+  fbegin += (int)pos_begin;
+  fend += (int)pos_end;
+
+  /** Loop over sample container and compute contribution of each sample to the derivative. */
+  for (fiter = fbegin; fiter != fend; ++fiter)
+  {
+    /** Read fixed coordinates and create some variables. */
+    const FixedImagePointType & fixedPoint = (*fiter).Value().m_ImageCoordinates;
+    RealType                    movingImageValue;
+    MovingImageDerivativeType   movingImageDerivative;
+    MovingImagePointType        mappedPoint;
+
+    /** Transform point and check if it is inside the B-spline support region. */
+    bool sampleOk = this->TransformPoint(fixedPoint, mappedPoint);
+
+    /** Check if the point is inside the moving mask. */
+    if (sampleOk)
+    {
+      sampleOk = this->IsInsideMovingMask(mappedPoint);
+    }
+
+    /** Compute the moving image value, its derivative, and check
+     * if the point is inside the moving image buffer.
+     */
+    if (sampleOk)
+    {
+      sampleOk = this->FastEvaluateMovingImageValueAndDerivative(
+        mappedPoint, movingImageValue, &movingImageDerivative, threadId);
+    }
+
+    if (sampleOk)
+    {
+      /** Get the fixed image value. */
+      RealType fixedImageValue = static_cast<RealType>((*fiter).Value().m_ImageValue);
+
+      /** Make sure the values fall within the histogram range. */
+      fixedImageValue = this->GetFixedImageLimiter()->Evaluate(fixedImageValue);
+      movingImageValue = this->GetMovingImageLimiter()->Evaluate(movingImageValue, movingImageDerivative);
+
+      /** Compute the inner product of the transform Jacobian dT/dmu and the moving image gradient dM/dx. */
+      this->m_AdvancedTransform->EvaluateJacobianWithImageGradientProduct(
+        fixedPoint, movingImageDerivative, imageJacobian, nzji);
+
+      /** Compute this sample's contribution to the derivative. */
+      this->UpdateDerivativeLowMemory(fixedImageValue, movingImageValue, imageJacobian, nzji, derivative);
+
+    } // end sampleOk
+  }   // end loop over sample container
+
+} // end ThreadedComputeDerivativeLowMemory()
+
+
+/**
+ * **************** ComputeDerivativeLowMemoryThreaderCallback *******
+ */
+
+template <class TFixedImage, class TMovingImage>
+ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION
+ParzenWindowNormalizedMutualInformationImageToImageMetric<TFixedImage, TMovingImage>::
+  ComputeDerivativeLowMemoryThreaderCallback(void * arg)
+{
+  ThreadInfoType * infoStruct = static_cast<ThreadInfoType *>(arg);
+  ThreadIdType     threadId = infoStruct->WorkUnitID;
+
+  ParzenWindowNormalizedMutualInformationMultiThreaderParameterType * temp =
+    static_cast<ParzenWindowNormalizedMutualInformationMultiThreaderParameterType *>(infoStruct->UserData);
+
+  temp->m_Metric->ThreadedComputeDerivativeLowMemory(threadId);
+
+  return itk::ITK_THREAD_RETURN_DEFAULT_VALUE;
+
+} // end ComputeDerivativeLowMemoryThreaderCallback()
+
+
+/**
+ * ******************* UpdateDerivativeLowMemory *******************
+ */
+
+template <class TFixedImage, class TMovingImage>
+void
+ParzenWindowNormalizedMutualInformationImageToImageMetric<TFixedImage, TMovingImage>::UpdateDerivativeLowMemory(
+  const RealType &                   fixedImageValue,
+  const RealType &                   movingImageValue,
+  const DerivativeType &             imageJacobian,
+  const NonZeroJacobianIndicesType & nzji,
+  DerivativeType &                   derivative) const
+{
+  /** In this function we need to do:
+   *      derivative += imageJacobian *
+   *          \sum_i \sum_k PRatio(i,k) * dB/dxi(xi,i,k),
+   * with i, k, the fixed and moving histogram bins,
+   * PRatio the precomputed alpha * pRatio / Ej, and
+   * dB/dxi the B-spline derivative. This equals the explicit version
+   * -dNMI/dmu = - sum_k sum_i dhdmu(i,k) PRatio(i,k), since this sample's
+   * contribution to dhdmu(i,k) is -imageJacobian * dB/dxi(xi,i,k).
+   *
+   * Note (1) that we only have to loop over i,k within the support
+   * of the B-spline Parzen-window.
+   * Note (2) that imageJacobian may be sparse.
+   */
+
+  /** Determine Parzen window arguments (see eq. 6 of Mattes paper [2]). */
+  const double fixedImageParzenWindowTerm =
+    fixedImageValue / this->m_FixedImageBinSize - this->m_FixedImageNormalizedMin;
+  const double movingImageParzenWindowTerm =
+    movingImageValue / this->m_MovingImageBinSize - this->m_MovingImageNormalizedMin;
+
+  /** The lowest bin numbers affected by this pixel: */
+  const int fixedParzenWindowIndex =
+    static_cast<int>(std::floor(fixedImageParzenWindowTerm + this->m_FixedParzenTermToIndexOffset));
+  const int movingParzenWindowIndex =
+    static_cast<int>(std::floor(movingImageParzenWindowTerm + this->m_MovingParzenTermToIndexOffset));
+
+  /** Compute the fixed Parzen values. */
+  ParzenValueContainerType fixedParzenValues(this->m_JointPDFWindow.GetSize()[1]);
+  this->EvaluateParzenValues(
+    fixedImageParzenWindowTerm, fixedParzenWindowIndex, this->m_FixedKernel, fixedParzenValues);
+
+  /** Compute the derivatives of the moving Parzen window. */
+  ParzenValueContainerType derivativeMovingParzenValues(this->m_JointPDFWindow.GetSize()[0]);
+  this->EvaluateParzenValues(
+    movingImageParzenWindowTerm, movingParzenWindowIndex, this->m_DerivativeMovingKernel, derivativeMovingParzenValues);
+
+  /** Get the moving image bin size. */
+  const double et = static_cast<double>(this->m_MovingImageBinSize);
+
+  /** Loop over the Parzen window region and increment sum. */
+  PDFValueType sum = 0.0;
+  for (unsigned int f = 0; f < fixedParzenValues.GetSize(); ++f)
+  {
+    const double fv_et = fixedParzenValues[f] / et;
+    for (unsigned int m = 0; m < derivativeMovingParzenValues.GetSize(); ++m)
+    {
+      sum += this->m_PRatioArray[f + fixedParzenWindowIndex][m + movingParzenWindowIndex] * fv_et *
+             derivativeMovingParzenValues[m];
+    }
+  }
+
+  /** Now compute derivative += sum * imageJacobian. */
+  if (nzji.size() == this->GetNumberOfParameters())
+  {
+    /** Loop over all Jacobians. */
+    for (unsigned int mu = 0; mu < this->GetNumberOfParameters(); ++mu)
+    {
+      derivative[mu] += static_cast<DerivativeValueType>(imageJacobian[mu] * sum);
+    }
+  }
+  else
+  {
+    /** Loop only over the non-zero Jacobians. */
+    for (unsigned int i = 0; i < imageJacobian.GetSize(); ++i)
+    {
+      const unsigned int mu = nzji[i];
+      derivative[mu] += static_cast<DerivativeValueType>(imageJacobian[i] * sum);
+    }
+  }
+
+} // end UpdateDerivativeLowMemory()
+
+
 } // end namespace itk
 
 #endif // end #ifndef itkParzenWindowNormalizedMutualInformationImageToImageMetric_hxx
@@ -933,15 +933,14 @@ template <class TFixedImage, class TMovingImage>
 void
 PCAMetric<TFixedImage, TMovingImage>::LaunchGetSamplesThreaderCallback(void) const
 {
-  /** Setup local threader. */
-  // \todo: is a global threader better performance-wise? check
-  auto local_threader = ThreaderType::New();
-  local_threader->SetNumberOfWorkUnits(Self::GetNumberOfWorkUnits());
-  local_threader->SetSingleMethod(this->GetSamplesThreaderCallback,
-                                  const_cast<void *>(static_cast<const void *>(&this->m_PCAMetricThreaderParameters)));
+  /** Setup threader. */
+  this->m_MetricThreader->SetNumberOfWorkUnits(Self::GetNumberOfWorkUnits());
+  this->m_MetricThreader->SetSingleMethod(
+    this->GetSamplesThreaderCallback,
+    const_cast<void *>(static_cast<const void *>(&this->m_PCAMetricThreaderParameters)));
 
   /** Launch. */
-  local_threader->SingleMethodExecute();
+  this->m_MetricThreader->SingleMethodExecute();
 
 } // end LaunchGetSamplesThreaderCallback()
 
@@ -1136,15 +1135,14 @@ template <class TFixedImage, class TMovingImage>
 void
 PCAMetric<TFixedImage, TMovingImage>::LaunchComputeDerivativeThreaderCallback(void) const
 {
-  /** Setup local threader. */
-  // \todo: is a global threader better performance-wise? check
-  auto local_threader = ThreaderType::New();
-  local_threader->SetNumberOfWorkUnits(Self::GetNumberOfWorkUnits());
-  local_threader->SetSingleMethod(this->ComputeDerivativeThreaderCallback,
-                                  const_cast<void *>(static_cast<const void *>(&this->m_PCAMetricThreaderParameters)));
+  /** Setup threader. */
+  this->m_MetricThreader->SetNumberOfWorkUnits(Self::GetNumberOfWorkUnits());
+  this->m_MetricThreader->SetSingleMethod(
+    this->ComputeDerivativeThreaderCallback,
+    const_cast<void *>(static_cast<const void *>(&this->m_PCAMetricThreaderParameters)));
 
   /** Launch. */
-  local_threader->SingleMethodExecute();
+  this->m_MetricThreader->SingleMethodExecute();
 
 } // end LaunchComputeDerivativeThreaderCallback()
 
@@ -89,14 +89,12 @@ public:
 
   using typename Superclass::InputPointType;
   using typename Superclass::OutputPointType;
+  using typename Superclass::ThreadInfoType;
 
   typedef typename OutputPointType::CoordRepType CoordRepType;
   typedef vnl_vector<CoordRepType>               VnlVectorType;
   typedef vnl_matrix<CoordRepType>               VnlMatrixType;
-  // typedef itk::Array<VnlVectorType *> ProposalDerivativeType;
-  typedef typename std::vector<VnlVectorType *> ProposalDerivativeType;
-  // typedef typename vnl_vector<VnlVectorType *> ProposalDerivativeType; //Cannot be linked
-  typedef vnl_svd_economy<CoordRepType> PCACovarianceType;
+  typedef vnl_svd_economy<CoordRepType>          PCACovarianceType;
 
   /** Initialization. */
   void
@@ -175,6 +173,10 @@ protected:
   void
   PrintSelf(std::ostream & os, Indent indent) const override;
 
+  /** Accumulate the derivative of the points of one thread. */
+  void
+  ThreadedGetValueAndDerivative(ThreadIdType threadID) const override;
+
 private:
   StatisticalShapePointPenalty(const Self &) = delete;
   void
@@ -183,14 +185,20 @@ private:
   void
   FillProposalVector(const OutputPointType & fixedPoint, const unsigned int vertexindex) const;
 
+  /** Fill the proposal vector for the points in [ pointBegin, pointEnd [. */
   void
-  FillProposalDerivative(const OutputPointType & fixedPoint, const unsigned int vertexindex) const;
+  FillProposalVectorForPointRange(const SizeValueType pointBegin, const SizeValueType pointEnd) const;
 
+  /** Fill, align and normalize the proposal vector of the transformed shape. */
   void
-  UpdateCentroidAndAlignProposalVector(const unsigned int shapeLength) const;
+  ComputeProposalVector(const unsigned int shapeLength) const;
+
+  /** FillProposalVector threader callback function. */
+  static ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION
+  FillProposalVectorThreaderCallback(void * arg);
 
   void
-  UpdateCentroidAndAlignProposalDerivative(const unsigned int shapeLength) const;
+  UpdateCentroidAndAlignProposalVector(const unsigned int shapeLength) const;
 
   void
   UpdateL2(const unsigned int shapeLength) const;
@@ -198,22 +206,28 @@ private:
   void
   NormalizeProposalVector(const unsigned int shapeLength) const;
 
-  void
-  UpdateL2AndNormalizeProposalDerivative(const unsigned int shapeLength) const;
-
   void
   CalculateValue(MeasureType &   value,
                  VnlVectorType & differenceVector,
                  VnlVectorType & centerrotated,
                  VnlVectorType & eigrot) const;
 
+  /** Compute the gradient of the value with respect to the point coordinates,
+   * and store it in m_PointsGradient.
+   */
+  void
+  CalculatePointsGradient(const MeasureType &   value,
+                          const VnlVectorType & differenceVector,
+                          const VnlVectorType & eigrot,
+                          const unsigned int    shapeLength) const;
+
+  /** Add the derivative of the points in [ pointBegin, pointEnd [ to derivative,
+   * by multiplying the points gradient with the transform Jacobian of each point.
+   */
   void
-  CalculateDerivative(DerivativeType &      derivative,
-                      const MeasureType &   value,
-                      const VnlVectorType & differenceVector,
-                      const VnlVectorType & centerrotated,
-                      const VnlVectorType & eigrot,
-                      const unsigned int    shapeLength) const;
+  CalculateDerivativeForPointRange(const SizeValueType pointBegin,
+                                   const SizeValueType pointEnd,
+                                   DerivativeType &    derivative) const;
 
   void
   CalculateCutOffValue(MeasureType & value) const;
@@ -243,15 +257,15 @@ private:
 
   VnlVectorType * m_EigenValuesRegularized;
 
-  mutable ProposalDerivativeType * m_ProposalDerivative;
-  unsigned int                     m_ProposalLength;
-  bool                             m_NormalizedShapeModel;
-  int                              m_ShapeModelCalculation;
-  double                           m_ShrinkageIntensity;
-  double                           m_BaseVariance;
-  double                           m_BaseStd;
-  mutable VnlVectorType            m_ProposalVector;
-  mutable VnlVectorType            m_MeanValues;
+  unsigned int          m_ProposalLength;
+  bool                  m_NormalizedShapeModel;
+  int                   m_ShapeModelCalculation;
+  double                m_ShrinkageIntensity;
+  double                m_BaseVariance;
+  double                m_BaseStd;
+  mutable VnlVectorType m_ProposalVector;
+  mutable VnlVectorType m_PointsGradient;
+  mutable VnlVectorType m_MeanValues;
 
   double m_CutOffValue;
   double m_CutOffSharpness;
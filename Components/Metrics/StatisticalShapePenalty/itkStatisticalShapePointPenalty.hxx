@@ -34,7 +34,6 @@ StatisticalShapePointPenalty<TFixedPointSet, TMovingPointSet>::StatisticalShapeP
   this->m_EigenVectors = nullptr;
   this->m_EigenValues = nullptr;
   this->m_EigenValuesRegularized = nullptr;
-  this->m_ProposalDerivative = nullptr;
   this->m_InverseCovarianceMatrix = nullptr;
 
   this->m_ShrinkageIntensityNeedsUpdate = true;
@@ -76,11 +75,6 @@ StatisticalShapePointPenalty<TFixedPointSet, TMovingPointSet>::~StatisticalShape
     delete this->m_EigenValuesRegularized;
     this->m_EigenValuesRegularized = nullptr;
   }
-  if (this->m_ProposalDerivative != nullptr)
-  {
-    delete this->m_ProposalDerivative;
-    this->m_ProposalDerivative = nullptr;
-  }
   if (this->m_InverseCovarianceMatrix != nullptr)
   {
     delete this->m_InverseCovarianceMatrix;
@@ -354,55 +348,15 @@ StatisticalShapePointPenalty<TFixedPointSet, TMovingPointSet>::GetValue(
   }
 
   /** Initialize some variables */
-  // this->m_NumberOfPointsCounted = 0;
   MeasureType value = NumericTraits<MeasureType>::Zero;
 
-  // InputPointType movingPoint;
-  OutputPointType fixedPoint;
-
   /** Make sure the transform parameters are up to date. */
   this->SetTransformParameters(parameters);
 
   const unsigned int shapeLength = Self::FixedPointSetDimension * (fixedPointSet->GetNumberOfPoints());
-  this->m_ProposalVector.set_size(this->m_ProposalLength);
-
-  /** Part 1:
-   * - Copy point positions in proposal vector
-   */
 
-  /** Create iterators. */
-  PointIterator pointItFixed = fixedPointSet->GetPoints()->Begin();
-  PointIterator pointEnd = fixedPointSet->GetPoints()->End();
-
-  unsigned int vertexindex = 0;
-  /** Loop over the corresponding points. */
-  while (pointItFixed != pointEnd)
-  {
-    fixedPoint = pointItFixed.Value();
-    this->FillProposalVector(fixedPoint, vertexindex);
-
-    this->m_NumberOfPointsCounted++;
-    ++pointItFixed;
-    vertexindex += Self::FixedPointSetDimension;
-  } // end loop over all corresponding points
-
-  if (this->m_NormalizedShapeModel)
-  {
-    /** Part 2:
-     * - Calculate shape centroid
-     * - put centroid values in proposal
-     * - update proposal vector with aligned shape
-     */
-    this->UpdateCentroidAndAlignProposalVector(shapeLength);
-
-    /** Part 3:
-     * - Calculate l2-norm from aligned shapes
-     * - put l2-norm value in proposal vector
-     * - update proposal vector with size normalized shape
-     */
-    this->UpdateL2(shapeLength);
-    this->NormalizeProposalVector(shapeLength);
-  }
+  /** Fill, align and normalize the proposal vector. */
+  this->ComputeProposalVector(shapeLength);
 
   VnlVectorType differenceVector;
   VnlVectorType centerrotated;
@@ -454,43 +408,97 @@ StatisticalShapePointPenalty<TFixedPointSet, TMovingPointSet>::GetValueAndDeriva
   }
 
   /** Initialize some variables */
-  // this->m_NumberOfPointsCounted = 0;
   value = NumericTraits<MeasureType>::Zero;
   derivative = DerivativeType(this->GetNumberOfParameters());
   derivative.Fill(NumericTraits<DerivativeValueType>::ZeroValue());
 
-  // InputPointType movingPoint;
-  OutputPointType fixedPoint;
-
   /** Make sure the transform parameters are up to date. */
   this->SetTransformParameters(parameters);
 
   const unsigned int shapeLength = Self::FixedPointSetDimension * fixedPointSet->GetNumberOfPoints();
 
+  /** Fill, align and normalize the proposal vector. */
+  this->ComputeProposalVector(shapeLength);
+
+  // TODO this declaration instantiates a zero sized vector, but it will be reassigned anyways.
+  VnlVectorType differenceVector;
+  VnlVectorType centerrotated;
+  VnlVectorType eigrot;
+
+  this->CalculateValue(value, differenceVector, centerrotated, eigrot);
+
+  if (value != 0.0)
+  {
+    /** The derivative is the gradient of the value with respect to the point
+     * coordinates, multiplied by the (sparse) transform Jacobian of each point.
+     * The gradient is computed once, so that the costs of the shape model are
+     * not repeated for each transform parameter.
+     */
+    this->CalculatePointsGradient(value, differenceVector, eigrot, shapeLength);
+
+    if (this->m_UseMultiThread)
+    {
+      this->LaunchGetValueAndDerivativeThreaderCallback();
+      this->AccumulateDerivatives(derivative, 1.0);
+    }
+    else
+    {
+      this->CalculateDerivativeForPointRange(0, fixedPointSet->GetNumberOfPoints(), derivative);
+    }
+  }
+
+  this->CalculateCutOffValue(value);
+
+} // end GetValueAndDerivative()
+
+
+/**
+ * ******************* ThreadedGetValueAndDerivative *******************
+ */
+
+template <class TFixedPointSet, class TMovingPointSet>
+void
+StatisticalShapePointPenalty<TFixedPointSet, TMovingPointSet>::ThreadedGetValueAndDerivative(
+  ThreadIdType threadID) const
+{
+  /** Get the range of points this thread is responsible for. */
+  SizeValueType pointBegin = 0;
+  SizeValueType pointEnd = 0;
+  this->GetPointRangeForThread(threadID, pointBegin, pointEnd);
+
+  this->CalculateDerivativeForPointRange(
+    pointBegin, pointEnd, this->m_GetValueAndDerivativePerThreadVariables[threadID].st_Derivative);
+
+} // end ThreadedGetValueAndDerivative()
+
+
+/**
+ * ******************* ComputeProposalVector *******************
+ */
+
+template <class TFixedPointSet, class TMovingPointSet>
+void
+StatisticalShapePointPenalty<TFixedPointSet, TMovingPointSet>::ComputeProposalVector(
+  const unsigned int shapeLength) const
+{
+  const SizeValueType numberOfPoints = this->GetFixedPointSet()->GetNumberOfPoints();
   this->m_ProposalVector.set_size(this->m_ProposalLength);
-  this->m_ProposalDerivative = new ProposalDerivativeType(this->GetNumberOfParameters(), nullptr);
+  this->m_NumberOfPointsCounted = numberOfPoints;
 
   /** Part 1:
    * - Copy point positions in proposal vector
-   * - Copy point derivatives in proposal derivative vector
+   * Each point writes its own elements, so the points can be handled in parallel.
    */
-
-  /** Create iterators. */
-  PointIterator pointItFixed = fixedPointSet->GetPoints()->Begin();
-  PointIterator pointEnd = fixedPointSet->GetPoints()->End();
-
-  unsigned int vertexindex = 0;
-  /** Loop over the corresponding points. */
-  while (pointItFixed != pointEnd)
+  if (this->m_UseMultiThread)
   {
-    fixedPoint = pointItFixed.Value();
-    this->FillProposalVector(fixedPoint, vertexindex);
-    this->FillProposalDerivative(fixedPoint, vertexindex);
-
-    this->m_NumberOfPointsCounted++;
-    ++pointItFixed;
-    vertexindex += Self::FixedPointSetDimension;
-  } // end loop over all corresponding points
+    this->m_Threader->SetSingleMethod(this->FillProposalVectorThreaderCallback,
+                                      const_cast<void *>(static_cast<const void *>(&this->m_ThreaderMetricParameters)));
+    this->m_Threader->SingleMethodExecute();
+  }
+  else
+  {
+    this->FillProposalVectorForPointRange(0, numberOfPoints);
+  }
 
   if (this->m_NormalizedShapeModel)
   {
@@ -498,56 +506,63 @@ StatisticalShapePointPenalty<TFixedPointSet, TMovingPointSet>::GetValueAndDeriva
      * - Calculate shape centroid
      * - put centroid values in proposal
      * - update proposal vector with aligned shape
-     * - Calculate centroid derivatives and update proposal derivative vectors
-     * - put centroid derivatives values in proposal derivatives
-     * - update proposal derivatives
      */
     this->UpdateCentroidAndAlignProposalVector(shapeLength);
-    this->UpdateCentroidAndAlignProposalDerivative(shapeLength);
 
     /** Part 3:
      * - Calculate l2-norm from aligned shapes
      * - put l2-norm value in proposal vector
      * - update proposal vector with size normalized shape
-     * - Calculate l2-norm derivatice from updated proposal vector
-     * - put l2-norm derivative value in proposal derivative vectors
-     * - update proposal derivatives
      */
     this->UpdateL2(shapeLength);
-    this->UpdateL2AndNormalizeProposalDerivative(shapeLength);
     this->NormalizeProposalVector(shapeLength);
+  }
 
-  } // end if(m_NormalizedShapeModel)
+} // end ComputeProposalVector()
 
-  // TODO this declaration instantiates a zero sized vector, but it will be reassigned anyways.
-  VnlVectorType differenceVector;
-  VnlVectorType centerrotated;
-  VnlVectorType eigrot;
 
-  this->CalculateValue(value, differenceVector, centerrotated, eigrot);
+/**
+ * **************** FillProposalVectorThreaderCallback *******
+ */
 
-  if (value != 0.0)
-  {
-    this->CalculateDerivative(derivative, value, differenceVector, centerrotated, eigrot, shapeLength);
-  }
-  else
+template <class TFixedPointSet, class TMovingPointSet>
+ITK_THREAD_RETURN_FUNCTION_CALL_CONVENTION
+StatisticalShapePointPenalty<TFixedPointSet, TMovingPointSet>::FillProposalVectorThreaderCallback(void * arg)
+{
+  ThreadInfoType * infoStruct = static_cast<ThreadInfoType *>(arg);
+  ThreadIdType     threadID = infoStruct->WorkUnitID;
+
+  typedef typename Superclass::MultiThreaderParameterType MultiThreaderParameterType;
+  MultiThreaderParameterType * temp = static_cast<MultiThreaderParameterType *>(infoStruct->UserData);
+  const Self *                 metric = static_cast<const Self *>(temp->st_Metric);
+
+  SizeValueType pointBegin = 0;
+  SizeValueType pointEnd = 0;
+  metric->GetPointRangeForThread(threadID, pointBegin, pointEnd);
+  metric->FillProposalVectorForPointRange(pointBegin, pointEnd);
+
+  return itk::ITK_THREAD_RETURN_DEFAULT_VALUE;
+
+} // end FillProposalVectorThreaderCallback()
+
+
+/**
+ * ******************* FillProposalVectorForPointRange *******************
+ */
+
+template <class TFixedPointSet, class TMovingPointSet>
+void
+StatisticalShapePointPenalty<TFixedPointSet, TMovingPointSet>::FillProposalVectorForPointRange(
+  const SizeValueType pointBegin,
+  const SizeValueType pointEnd) const
+{
+  const auto fixedPoints = this->GetFixedPointSet()->GetPoints();
+  for (SizeValueType pointId = pointBegin; pointId < pointEnd; ++pointId)
   {
-    typename ProposalDerivativeType::iterator proposalDerivativeIt = this->m_ProposalDerivative->begin();
-    typename ProposalDerivativeType::iterator proposalDerivativeEnd = this->m_ProposalDerivative->end();
-    for (; proposalDerivativeIt != proposalDerivativeEnd; ++proposalDerivativeIt)
-    {
-      if (*proposalDerivativeIt != nullptr)
-      {
-        delete (*proposalDerivativeIt);
-      }
-    }
+    this->FillProposalVector(fixedPoints->ElementAt(pointId), pointId * Self::FixedPointSetDimension);
   }
-  delete this->m_ProposalDerivative;
-  this->m_ProposalDerivative = nullptr;
 
-  this->CalculateCutOffValue(value);
-
-} // end GetValueAndDerivative()
+} // end FillProposalVectorForPointRange()
 
 
 /**
@@ -572,52 +587,39 @@ StatisticalShapePointPenalty<TFixedPointSet, TMovingPointSet>::FillProposalVecto
 
 
 /**
- * ******************* FillProposalDerivative *******************
+ * ******************* CalculateDerivativeForPointRange *******************
  */
 
 template <class TFixedPointSet, class TMovingPointSet>
 void
-StatisticalShapePointPenalty<TFixedPointSet, TMovingPointSet>::FillProposalDerivative(
-  const OutputPointType & fixedPoint,
-  const unsigned int      vertexindex) const
+StatisticalShapePointPenalty<TFixedPointSet, TMovingPointSet>::CalculateDerivativeForPointRange(
+  const SizeValueType pointBegin,
+  const SizeValueType pointEnd,
+  DerivativeType &    derivative) const
 {
-  /**
-   * A (column) vector is constructed for each mu, only if that mu affects the shape penalty.
-   * I.e. if there is at least one point of the mesh with non-zero derivatives,
-   * a full column vector is instantiated (which can contain zeros for many other points)
-   *
-   * m_ProposalDerivative is a container with either full shape-vector-sized derivative vectors or NULL-s. Example:
-   *
-   * mu1: [ [ dx1/dmu1 , dy1/dmu1 , dz1/dmu1 ] , [ 0 , 0 , 0 ] , [ dx3/dmu1 , dy3/dmu1 , dz3/dmu1 ] , [...] ]^T
-   * mu2: Null
-   * mu3: [ [ 0 , 0 , 0 ] , [ dx2/dmu3 , dy2/dmu3 , dz2/dmu3 ] , [ dx3/dmu3 , dy3/dmu3 , dz3/dmu3 ] , [...] ]^T
-   *
-   */
-
   NonZeroJacobianIndicesType nzji(this->m_Transform->GetNumberOfNonZeroJacobianIndices());
+  TransformJacobianType      jacobian;
 
-  /** Get the TransformJacobian dT/dmu. */
-  TransformJacobianType jacobian;
-  this->m_Transform->GetJacobian(fixedPoint, jacobian, nzji);
-
-  for (unsigned int i = 0; i < nzji.size(); ++i)
+  const auto fixedPoints = this->GetFixedPointSet()->GetPoints();
+  for (SizeValueType pointId = pointBegin; pointId < pointEnd; ++pointId)
   {
-    const unsigned int mu = nzji[i];
-    if ((*this->m_ProposalDerivative)[mu] == nullptr)
-    {
-      /** Create the big column vector if it does not yet exist for this mu*/
-      (*this->m_ProposalDerivative)[mu] = new VnlVectorType(this->m_ProposalLength, 0.0);
-      // memory will be freed in CalculateDerivative()
-    }
+    /** Get the TransformJacobian dT/dmu. */
+    this->m_Transform->GetJacobian(fixedPoints->ElementAt(pointId), jacobian, nzji);
 
-    /** The column vector exists for this mu, so copy the jacobians for this point into the big vector. */
-    for (unsigned int d = 0; d < Self::FixedPointSetDimension; ++d)
+    /** d value / d mu = sum_d ( d value / d x_d ) * ( d x_d / d mu ). */
+    const unsigned int vertexindex = pointId * Self::FixedPointSetDimension;
+    for (unsigned int i = 0; i < nzji.size(); ++i)
     {
-      (*(*this->m_ProposalDerivative)[mu])[vertexindex + d] = jacobian.get_column(i)[d];
+      DerivativeValueType sum = NumericTraits<DerivativeValueType>::ZeroValue();
+      for (unsigned int d = 0; d < Self::FixedPointSetDimension; ++d)
+      {
+        sum += this->m_PointsGradient[vertexindex + d] * jacobian(d, i);
+      }
+      derivative[nzji[i]] += sum;
     }
   }
 
-} // end FillProposalVector()
+} // end CalculateDerivativeForPointRange()
 
 
 /**
@@ -656,44 +658,6 @@ StatisticalShapePointPenalty<TFixedPointSet, TMovingPointSet>::UpdateCentroidAnd
 } // end UpdateCentroidAndAlignProposalVector()
 
 
-/**
- * ******************* UpdateCentroidAndAlignProposalDerivative *******************
- */
-
-template <class TFixedPointSet, class TMovingPointSet>
-void
-StatisticalShapePointPenalty<TFixedPointSet, TMovingPointSet>::UpdateCentroidAndAlignProposalDerivative(
-  const unsigned int shapeLength) const
-{
-  typename ProposalDerivativeType::iterator proposalDerivativeIt = m_ProposalDerivative->begin();
-  typename ProposalDerivativeType::iterator proposalDerivativeEnd = m_ProposalDerivative->end();
-  while (proposalDerivativeIt != proposalDerivativeEnd)
-  {
-    if (*proposalDerivativeIt != nullptr)
-    {
-      for (unsigned int d = 0; d < Self::FixedPointSetDimension; ++d)
-      {
-        double & centroid_dDerivative = (**proposalDerivativeIt)[shapeLength + d];
-        centroid_dDerivative = 0; // initialize accumulators to zero
-
-        for (unsigned int index = 0; index < shapeLength; index += Self::FixedPointSetDimension)
-        {
-          centroid_dDerivative += (**proposalDerivativeIt)[index + d]; // sum all x derivatives
-        }
-
-        centroid_dDerivative /= this->GetFixedPointSet()->GetNumberOfPoints(); // divide sum to get average
-
-        for (unsigned int index = 0; index < shapeLength; index += Self::FixedPointSetDimension)
-        {
-          (**proposalDerivativeIt)[index + d] -= centroid_dDerivative; // subtract average
-        }
-      }
-    }
-    ++proposalDerivativeIt;
-  }
-} // end UpdateCentroidAndAlignProposalDerivative()
-
-
 /**
  * ******************* UpdateL2 *******************
  */
@@ -737,47 +701,6 @@ StatisticalShapePointPenalty<TFixedPointSet, TMovingPointSet>::NormalizeProposal
 } // end NormalizeProposalVector()
 
 
-/**
- * ******************* UpdateL2AndNormalizeProposalDerivative *******************
- */
-
-template <class TFixedPointSet, class TMovingPointSet>
-void
-StatisticalShapePointPenalty<TFixedPointSet, TMovingPointSet>::UpdateL2AndNormalizeProposalDerivative(
-  const unsigned int shapeLength) const
-{
-  double & l2norm = this->m_ProposalVector[shapeLength + Self::FixedPointSetDimension];
-
-  typename ProposalDerivativeType::iterator proposalDerivativeIt = this->m_ProposalDerivative->begin();
-  typename ProposalDerivativeType::iterator proposalDerivativeEnd = this->m_ProposalDerivative->end();
-
-  while (proposalDerivativeIt != proposalDerivativeEnd)
-  {
-    if (*proposalDerivativeIt != nullptr)
-    {
-      double & l2normDerivative = (**proposalDerivativeIt)[shapeLength + Self::FixedPointSetDimension];
-      l2normDerivative = 0; // initialize to zero
-      // loop over all shape coordinates of the aligned shape
-      for (unsigned int index = 0; index < shapeLength; ++index)
-      {
-        l2normDerivative += this->m_ProposalVector[index] * (**proposalDerivativeIt)[index];
-      }
-      l2normDerivative /= (l2norm * sqrt((double)(this->GetFixedPointSet()->GetNumberOfPoints())));
-
-      // loop over all shape coordinates of the aligned shape
-      for (unsigned int index = 0; index < shapeLength; ++index)
-      {
-        // update normalized shape derivatives
-        (**proposalDerivativeIt)[index] = (**proposalDerivativeIt)[index] / l2norm -
-                                          this->m_ProposalVector[index] * l2normDerivative / (l2norm * l2norm);
-      }
-    }
-    ++proposalDerivativeIt;
-  }
-
-} // end UpdateL2AndNormalizeProposalDerivative()
-
-
 /**
  * ******************* CalculateValue *******************
  */
@@ -852,101 +775,116 @@ StatisticalShapePointPenalty<TFixedPointSet, TMovingPointSet>::CalculateValue(Me
 
 
 /**
- * ******************* CalculateDerivative *******************
+ * ******************* CalculatePointsGradient *******************
  */
 
 template <class TFixedPointSet, class TMovingPointSet>
 void
-StatisticalShapePointPenalty<TFixedPointSet, TMovingPointSet>::CalculateDerivative(
-  DerivativeType &      derivative,
+StatisticalShapePointPenalty<TFixedPointSet, TMovingPointSet>::CalculatePointsGradient(
   const MeasureType &   value,
   const VnlVectorType & differenceVector,
-  const VnlVectorType & centerrotated,
   const VnlVectorType & eigrot,
   const unsigned int    shapeLength) const
 {
-  typename ProposalDerivativeType::iterator proposalDerivativeIt = this->m_ProposalDerivative->begin();
-  typename ProposalDerivativeType::iterator proposalDerivativeEnd = this->m_ProposalDerivative->end();
-
-  typename DerivativeType::iterator derivativeIt = derivative.begin();
-
-  for (; proposalDerivativeIt != proposalDerivativeEnd; ++proposalDerivativeIt, ++derivativeIt)
+  /** Gradient of the squared distance (divided by 2) with respect to the proposal vector.
+   * For the decomposed models this costs O( proposalLength * numberOfModes ).
+   */
+  VnlVectorType gradient;
+  switch (this->m_ShapeModelCalculation)
   {
-    if (*proposalDerivativeIt != nullptr)
+    case 0: // full covariance
     {
-      switch (this->m_ShapeModelCalculation)
+      /** diff^T * Sigma^-1 */
+      gradient = differenceVector * (*this->m_InverseCovarianceMatrix);
+      break;
+    }
+    case 1: // decomposed covariance (uniform regularization)
+    {
+      /** V * Lambda^-1 * V^T * diff + 1/(Beta*sigma_0^2) * diff */
+      gradient = (*this->m_EigenVectors) * eigrot;
+      if (this->m_ShrinkageIntensity != 0)
       {
-        case 0: // full covariance
-        {
-          /**innerproduct diff^T * Sigma^-1 * d/dmu (diff), where iterated over mu-s*/
-          *derivativeIt = bracket(differenceVector, *m_InverseCovarianceMatrix, (**proposalDerivativeIt)) / value;
-          this->CalculateCutOffDerivative(*derivativeIt, value);
-          break;
-        }
-        case 1: // decomposed covariance (uniform regularization)
-        {
-          if (this->m_ShrinkageIntensity != 0)
-          {
-            /** Innerproduct diff^T * V * Lambda^-1 * V^T * d/dmu(diff)
-             * + 1/(Beta*sigma_0^2)*diff^T* d/dmu(diff), where iterated over mu-s
-             */
-            *derivativeIt = (dot_product(eigrot, this->m_EigenVectors->transpose() * (**proposalDerivativeIt)) +
-                             dot_product(differenceVector, **proposalDerivativeIt) /
-                               (this->m_ShrinkageIntensity * this->m_BaseVariance)) /
-                            value;
-            this->CalculateCutOffDerivative(*derivativeIt, value);
-          }
-          else // m_ShrinkageIntensity==0
-          {
-            /**innerproduct diff^T * V * Lambda^-1 * V^T * d/dmu (diff), where iterated over mu-s*/
-            *derivativeIt = (dot_product(eigrot, this->m_EigenVectors->transpose() * (**proposalDerivativeIt))) / value;
-            this->CalculateCutOffDerivative(*derivativeIt, value);
-          }
-          break;
-        }
-        case 2: // decomposed scaled covariance (element specific regularization)
-        {
-          // first scale proposalDerivatives with their sigma's in order to evaluate
-          // with the EigenValues and EigenVectors of the scaled CovarianceMatrix
-          typename VnlVectorType::iterator propDerivElementIt = (*proposalDerivativeIt)->begin();
-          for (unsigned int propDerivElementIndex = 0; propDerivElementIndex < shapeLength;
-               ++propDerivElementIndex, ++propDerivElementIt)
-          {
-            (*propDerivElementIt) /= this->m_BaseStd;
-          }
-          (**proposalDerivativeIt)[shapeLength] /= this->m_CentroidXStd;
-          (**proposalDerivativeIt)[shapeLength + 1] /= this->m_CentroidYStd;
-          (**proposalDerivativeIt)[shapeLength + 2] /= this->m_CentroidZStd;
-          (**proposalDerivativeIt)[shapeLength + 3] /= this->m_SizeStd;
-          if (this->m_ShrinkageIntensity != 0)
-          {
-            /** innerproduct diff^T * V * Lambda^-1 * V^T * d/dmu(diff)
-             * + 1/(Beta*sigma_0^2)*diff^T* d/dmu(diff), where iterated over mu-s
-             */
-            *derivativeIt = (dot_product(eigrot, this->m_EigenVectors->transpose() * (**proposalDerivativeIt)) +
-                             dot_product(differenceVector, **proposalDerivativeIt) / this->m_ShrinkageIntensity) /
-                            value;
-            this->CalculateCutOffDerivative(*derivativeIt, value);
-          }
-          else // m_ShrinkageIntensity==0
-          {
-            /**innerproduct diff^T * V * Lambda^-1 * V^T * d/dmu (diff), where iterated over mu-s*/
-            *derivativeIt = (dot_product(eigrot, this->m_EigenVectors->transpose() * (**proposalDerivativeIt))) / value;
-            this->CalculateCutOffDerivative(*derivativeIt, value);
-          }
-          break;
-        }
-        default:
-        {
-        }
+        gradient += differenceVector / (this->m_ShrinkageIntensity * this->m_BaseVariance);
+      }
+      break;
+    }
+    case 2: // decomposed scaled covariance (element specific regularization)
+    {
+      /** V * Lambda^-1 * V^T * diff + 1/Beta * diff, with diff scaled by the sigma's. */
+      gradient = (*this->m_EigenVectors) * eigrot;
+      if (this->m_ShrinkageIntensity != 0)
+      {
+        gradient += differenceVector / this->m_ShrinkageIntensity;
+      }
 
-          delete (*proposalDerivativeIt);
-          // nzjacs++;
+      /** Chain rule for the scaling of the proposal by its sigma's. */
+      for (unsigned int index = 0; index < shapeLength; ++index)
+      {
+        gradient[index] /= this->m_BaseStd;
       }
+      gradient[shapeLength] /= this->m_CentroidXStd;
+      gradient[shapeLength + 1] /= this->m_CentroidYStd;
+      gradient[shapeLength + 2] /= this->m_CentroidZStd;
+      gradient[shapeLength + 3] /= this->m_SizeStd;
+      break;
+    }
+    default:
+    {
+      gradient.set_size(this->m_ProposalLength);
+      gradient.fill(0.0);
+    }
+  }
+
+  /** Chain rule for the square root and the cut-off function. */
+  DerivativeValueType factor = 1.0 / value;
+  this->CalculateCutOffDerivative(factor, value);
+  gradient *= factor;
+
+  if (!this->m_NormalizedShapeModel)
+  {
+    this->m_PointsGradient = gradient;
+    return;
+  }
+
+  /** Pull the gradient back through the normalization of the shape. The proposal
+   * vector contains the normalized shape n = a / l, the centroid c and the l2-norm l,
+   * with a = p - c the aligned points. Its derivative with respect to the points p is
+   *   dc_d = 1/N sum_p dp_d,
+   *   dl   = sum a * da / ( l * sqrt(N) ),
+   *   dn   = da / l - a * dl / l^2.
+   */
+  const double numberOfPoints = static_cast<double>(this->GetFixedPointSet()->GetNumberOfPoints());
+  const double l2norm = this->m_ProposalVector[shapeLength + Self::FixedPointSetDimension];
+
+  double gradientDotNormalized = 0.0;
+  for (unsigned int index = 0; index < shapeLength; ++index)
+  {
+    gradientDotNormalized += gradient[index] * this->m_ProposalVector[index];
+  }
+  const double l2normFactor =
+    (gradient[shapeLength + Self::FixedPointSetDimension] - gradientDotNormalized / l2norm) / std::sqrt(numberOfPoints);
+
+  /** Gradient with respect to the aligned points a = n * l. */
+  this->m_PointsGradient.set_size(shapeLength);
+  VnlVectorType alignedGradientSum(Self::FixedPointSetDimension, 0.0);
+  for (unsigned int index = 0; index < shapeLength; ++index)
+  {
+    const double alignedGradient = gradient[index] / l2norm + l2normFactor * this->m_ProposalVector[index];
+    this->m_PointsGradient[index] = alignedGradient;
+    alignedGradientSum[index % Self::FixedPointSetDimension] += alignedGradient;
+  }
+
+  /** Gradient with respect to the points p, through a = p - c. */
+  for (unsigned int d = 0; d < Self::FixedPointSetDimension; ++d)
+  {
+    const double centroidCorrection = (gradient[shapeLength + d] - alignedGradientSum[d]) / numberOfPoints;
+    for (unsigned int index = d; index < shapeLength; index += Self::FixedPointSetDimension)
+    {
+      this->m_PointsGradient[index] += centroidCorrection;
     }
   }
 
-} // end CalculateDerivative()
+} // end CalculatePointsGradient()
 
 
 /**
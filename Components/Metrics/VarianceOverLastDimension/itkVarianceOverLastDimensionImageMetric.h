@@ -135,6 +135,12 @@ public:
   void
   GetDerivative(const TransformParametersType & parameters, DerivativeType & derivative) const override;
 
+  /** Get value and derivatives, single-threaded. */
+  void
+  GetValueAndDerivativeSingleThreaded(const TransformParametersType & parameters,
+                                      MeasureType &                   Value,
+                                      DerivativeType &                Derivative) const;
+
   /** Get value and derivatives for multiple valued optimizers. */
   void
   GetValueAndDerivative(const TransformParametersType & parameters,
@@ -177,6 +183,15 @@ protected:
                                         const MovingImageDerivativeType & movingImageDerivative,
                                         DerivativeType &                  imageJacobian) const override;
 
+  /** Get value and derivatives for each thread. Each thread processes all
+   * last dimension positions of its part of the samples. */
+  inline void
+  ThreadedGetValueAndDerivative(ThreadIdType threadID) override;
+
+  /** Gather the values and derivatives from all threads. */
+  inline void
+  AfterThreadedGetValueAndDerivative(MeasureType & value, DerivativeType & derivative) const override;
+
 private:
   VarianceOverLastDimensionImageMetric(const Self &) = delete;
   void
@@ -186,6 +201,10 @@ private:
   void
   SampleRandom(const int n, const int m, std::vector<int> & numbers) const;
 
+  /** Subtract the mean over the last dimension from the derivative, when m_SubtractMean is set. */
+  void
+  SubtractMeanDerivative(DerivativeType & derivative) const;
+
   /** Variables to control random sampling in last dimension. */
   bool         m_SampleLastDimensionRandomly{ false };
   unsigned int m_NumSamplesLastDimension{ 10 };
@@ -21,6 +21,7 @@
 #include "itkVarianceOverLastDimensionImageMetric.h"
 #include "itkMersenneTwisterRandomVariateGenerator.h"
 #include <vnl/algo/vnl_matrix_update.h>
+#include <cmath>
 #include <numeric>
 
 namespace itk
@@ -345,12 +346,12 @@ VarianceOverLastDimensionImageMetric<TFixedImage, TMovingImage>::GetDerivative(
 
 
 /**
- * ******************* GetValueAndDerivative *******************
+ * ******************* GetValueAndDerivativeSingleThreaded *******************
  */
 
 template <class TFixedImage, class TMovingImage>
 void
-VarianceOverLastDimensionImageMetric<TFixedImage, TMovingImage>::GetValueAndDerivative(
+VarianceOverLastDimensionImageMetric<TFixedImage, TMovingImage>::GetValueAndDerivativeSingleThreaded(
   const TransformParametersType & parameters,
   MeasureType &                   value,
   DerivativeType &                derivative) const
@@ -527,78 +528,318 @@ VarianceOverLastDimensionImageMetric<TFixedImage, TMovingImage>::GetValueAndDeri
   derivative /= static_cast<float>(this->m_NumberOfPixelsCounted * this->m_InitialVariance);
 
   /** Subtract mean from derivative elements. */
-  if (this->m_SubtractMean)
+  this->SubtractMeanDerivative(derivative);
+
+  /** Return the measure value. */
+  value = measure;
+
+} // end GetValueAndDerivativeSingleThreaded()
+
+
+/**
+ * ******************* GetValueAndDerivative *******************
+ */
+
+template <class TFixedImage, class TMovingImage>
+void
+VarianceOverLastDimensionImageMetric<TFixedImage, TMovingImage>::GetValueAndDerivative(
+  const TransformParametersType & parameters,
+  MeasureType &                   value,
+  DerivativeType &                derivative) const
+{
+  /** Use the single-threaded code when multi-threading is off. The random
+   * sampling of the last dimension positions is also single-threaded, because
+   * it shares the random generator between the samples.
+   */
+  if (!this->m_UseMultiThread || this->m_SampleLastDimensionRandomly)
+  {
+    return this->GetValueAndDerivativeSingleThreaded(parameters, value, derivative);
+  }
+
+  /** Call non-thread-safe stuff, such as:
+   *   this->SetTransformParameters( parameters );
+   *   this->GetImageSampler()->Update();
+   * See GetValueAndDerivativeSingleThreaded().
+   */
+  this->BeforeThreadedGetValueAndDerivative(parameters);
+
+  /** Launch multi-threading metric */
+  this->LaunchGetValueAndDerivativeThreaderCallback();
+
+  /** Gather the metric values and derivatives from all threads. */
+  this->AfterThreadedGetValueAndDerivative(value, derivative);
+
+} // end GetValueAndDerivative()
+
+
+/**
+ * ******************* ThreadedGetValueAndDerivative *******************
+ */
+
+template <class TFixedImage, class TMovingImage>
+void
+VarianceOverLastDimensionImageMetric<TFixedImage, TMovingImage>::ThreadedGetValueAndDerivative(ThreadIdType threadId)
+{
+  /** Get a handle to the pre-allocated derivative for the current thread. */
+  DerivativeType & derivative = this->m_GetValueAndDerivativePerThreadVariables[threadId].st_Derivative;
+
+  /** Get a handle to the sample container. */
+  ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
+  const unsigned long         sampleContainerSize = sampleContainer->Size();
+
+  /** Get the samples for this thread. */
+  const unsigned long nrOfSamplesPerThreads = static_cast<unsigned long>(
+    std::ceil(static_cast<double>(sampleContainerSize) / static_cast<double>(Self::GetNumberOfWorkUnits())));
+
+  unsigned long pos_begin = nrOfSamplesPerThreads * threadId;
+  unsigned long pos_end = nrOfSamplesPerThreads * (threadId + 1);
+  pos_begin = (pos_begin > sampleContainerSize) ? sampleContainerSize : pos_begin;
+  pos_end = (pos_end > sampleContainerSize) ? sampleContainerSize : pos_end;
+
+  /** Create iterator over the sample container. */
+  typename ImageSampleContainerType::ConstIterator threader_fiter;
+  typename ImageSampleContainerType::ConstIterator threader_fbegin = sampleContainer->Begin();
+  typename ImageSampleContainerType::ConstIterator threader_fend = sampleContainer->Begin();
+
+  threader_fbegin += (int)pos_begin;
+  threader_fend += (int)pos_end;
+
+  /** Retrieve slowest varying dimension and its size. All positions are used. */
+  const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
+  const unsigned int lastDimSize = this->GetFixedImage()->GetLargestPossibleRegion().GetSize(lastDim);
+
+  /** Create variables to store intermediate results in. */
+  TransformJacobianType                   jacobian;
+  DerivativeType                          imageJacobian(this->m_AdvancedTransform->GetNumberOfNonZeroJacobianIndices());
+  std::vector<NonZeroJacobianIndicesType> nzjis(lastDimSize, NonZeroJacobianIndicesType());
+  std::vector<RealType>                   MT(lastDimSize);
+  std::vector<DerivativeType>             dMTdmu(lastDimSize);
+  std::vector<bool>                       MTOk(lastDimSize);
+
+  unsigned long numberOfPixelsCounted = 0;
+  MeasureType   measure = NumericTraits<MeasureType>::Zero;
+
+  /** Loop over the fixed image samples to calculate the variance over time for every sample position. */
+  for (threader_fiter = threader_fbegin; threader_fiter != threader_fend; ++threader_fiter)
   {
-    if (!this->m_TransformIsStackTransform)
+    /** Read fixed coordinates. */
+    FixedImagePointType fixedPoint = (*threader_fiter).Value().m_ImageCoordinates;
+
+    /** Transform sampled point to voxel coordinates. */
+    FixedImageContinuousIndexType voxelCoord;
+    this->GetFixedImage()->TransformPhysicalPointToContinuousIndex(fixedPoint, voxelCoord);
+
+    float        sumValues = 0.0;
+    float        sumValuesSquared = 0.0;
+    unsigned int numSamplesOk = 0;
+
+    /** First loop over t: compute M(T(x,t)), dM(T(x,t))/dmu, nzji and store. */
+    for (unsigned int d = 0; d < lastDimSize; ++d)
     {
-      /** Update derivative per dimension.
-       * Parameters are ordered xxxxxxx yyyyyyy zzzzzzz ttttttt and
-       * per dimension xyz.
-       */
-      const unsigned int lastDimGridSize = this->m_GridSize[lastDim];
-      const unsigned int numParametersPerDimension =
-        this->GetNumberOfParameters() / this->GetMovingImage()->GetImageDimension();
-      const unsigned int numControlPointsPerDimension = numParametersPerDimension / lastDimGridSize;
-      DerivativeType     mean(numControlPointsPerDimension);
-      for (unsigned int d = 0; d < this->GetMovingImage()->GetImageDimension(); ++d)
+      RealType                  movingImageValue;
+      MovingImagePointType      mappedPoint;
+      MovingImageDerivativeType movingImageDerivative;
+
+      /** Set fixed point's last dimension to the last dimension position. */
+      voxelCoord[lastDim] = d;
+      this->GetFixedImage()->TransformContinuousIndexToPhysicalPoint(voxelCoord, fixedPoint);
+
+      /** Transform point and check if it is inside the B-spline support region. */
+      bool sampleOk = this->TransformPoint(fixedPoint, mappedPoint);
+
+      /** Check if point is inside mask. */
+      if (sampleOk)
       {
-        /** Compute mean per dimension. */
-        mean.Fill(0.0);
-        const unsigned int starti = numParametersPerDimension * d;
-        for (unsigned int i = starti; i < starti + numParametersPerDimension; ++i)
-        {
-          const unsigned int index = i % numControlPointsPerDimension;
-          mean[index] += derivative[i];
-        }
-        mean /= static_cast<double>(lastDimGridSize);
+        sampleOk = this->IsInsideMovingMask(mappedPoint);
+      }
 
-        /** Update derivative for every control point per dimension. */
-        for (unsigned int i = starti; i < starti + numParametersPerDimension; ++i)
-        {
-          const unsigned int index = i % numControlPointsPerDimension;
-          derivative[i] -= mean[index];
-        }
+      /** Compute the moving image value and check if the point is
+       * inside the moving image buffer. */
+      if (sampleOk)
+      {
+        sampleOk = this->Superclass::EvaluateMovingImageValueAndDerivative(
+          mappedPoint, movingImageValue, &movingImageDerivative, threadId);
+      }
+
+      MTOk[d] = sampleOk;
+      if (sampleOk)
+      {
+        ++numSamplesOk;
+        sumValues += movingImageValue;
+        sumValuesSquared += movingImageValue * movingImageValue;
+
+        /** Get the TransformJacobian dT/dmu, and compute the innerproduct (dM/dx)^T (dT/dmu). */
+        this->EvaluateTransformJacobian(fixedPoint, jacobian, nzjis[d]);
+        this->EvaluateTransformJacobianInnerProduct(jacobian, movingImageDerivative, imageJacobian);
+
+        MT[d] = movingImageValue;
+        dMTdmu[d] = imageJacobian;
       }
     }
-    else
+
+    if (numSamplesOk > 0)
     {
-      /** Update derivative per dimension.
-       * Parameters are ordered x0x0x0y0y0y0z0z0z0x1x1x1y1y1y1z1z1z1 with
-       * the number the time point index.
-       */
-      const unsigned int numParametersPerLastDimension = this->GetNumberOfParameters() / lastDimSize;
-      DerivativeType     mean(numParametersPerLastDimension);
-      mean.Fill(0.0);
+      ++numberOfPixelsCounted;
+
+      /** Compute the variance over the last dimension. */
+      const float expectedValue = sumValues / static_cast<float>(numSamplesOk);
+      const float expectedSquaredValue = sumValuesSquared / static_cast<float>(numSamplesOk);
+      measure += expectedSquaredValue - expectedValue * expectedValue;
 
-      /** Compute mean per control point. */
-      for (unsigned int t = 0; t < lastDimSize; ++t)
+      /** Second loop over t: update derivative. */
+      for (unsigned int d = 0; d < lastDimSize; ++d)
       {
-        const unsigned int startc = numParametersPerLastDimension * t;
-        for (unsigned int c = startc; c < startc + numParametersPerLastDimension; ++c)
+        if (MTOk[d])
         {
-          const unsigned int index = c % numParametersPerLastDimension;
-          mean[index] += derivative[c];
+          for (unsigned int j = 0; j < nzjis[d].size(); ++j)
+          {
+            derivative[nzjis[d][j]] +=
+              (2.0 * (MT[d] - expectedValue) * dMTdmu[d][j]) / static_cast<float>(numSamplesOk);
+          }
         }
       }
-      mean /= static_cast<double>(lastDimSize);
+    }
+  } // end for loop over the image sample container
+
+  /** Only update these variables at the end to prevent unnecessary "false sharing". */
+  this->m_GetValueAndDerivativePerThreadVariables[threadId].st_NumberOfPixelsCounted = numberOfPixelsCounted;
+  this->m_GetValueAndDerivativePerThreadVariables[threadId].st_Value = measure;
+
+} // end ThreadedGetValueAndDerivative()
+
+
+/**
+ * ******************* AfterThreadedGetValueAndDerivative *******************
+ */
+
+template <class TFixedImage, class TMovingImage>
+void
+VarianceOverLastDimensionImageMetric<TFixedImage, TMovingImage>::AfterThreadedGetValueAndDerivative(
+  MeasureType &    value,
+  DerivativeType & derivative) const
+{
+  const ThreadIdType numberOfThreads = Self::GetNumberOfWorkUnits();
+
+  /** Accumulate the number of pixels and the values, and reset them for the next iteration. */
+  this->m_NumberOfPixelsCounted = 0;
+  value = NumericTraits<MeasureType>::Zero;
+  for (ThreadIdType i = 0; i < numberOfThreads; ++i)
+  {
+    this->m_NumberOfPixelsCounted += this->m_GetValueAndDerivativePerThreadVariables[i].st_NumberOfPixelsCounted;
+    value += this->m_GetValueAndDerivativePerThreadVariables[i].st_Value;
+
+    this->m_GetValueAndDerivativePerThreadVariables[i].st_NumberOfPixelsCounted = 0;
+    this->m_GetValueAndDerivativePerThreadVariables[i].st_Value = NumericTraits<MeasureType>::Zero;
+  }
+
+  /** Check if enough samples were valid. */
+  ImageSampleContainerPointer sampleContainer = this->GetImageSampler()->GetOutput();
+  this->CheckNumberOfSamples(sampleContainer->Size(), this->m_NumberOfPixelsCounted);
+
+  /** Compute average over variances and normalize with initial variance. */
+  const float normalization = static_cast<float>(this->m_NumberOfPixelsCounted * this->m_InitialVariance);
+  value /= normalization;
+
+  /** Accumulate the derivatives multi-threaded, which also resets them. */
+  derivative = DerivativeType(this->GetNumberOfParameters());
+  this->m_ThreaderMetricParameters.st_DerivativePointer = derivative.begin();
+  this->m_ThreaderMetricParameters.st_NormalizationFactor = normalization;
+
+  this->m_MetricThreader->SetSingleMethod(
+    this->AccumulateDerivativesThreaderCallback,
+    const_cast<void *>(static_cast<const void *>(&this->m_ThreaderMetricParameters)));
+  this->m_MetricThreader->SingleMethodExecute();
+
+  /** Subtract mean from derivative elements. */
+  this->SubtractMeanDerivative(derivative);
+
+} // end AfterThreadedGetValueAndDerivative()
+
+
+/**
+ * ******************* SubtractMeanDerivative *******************
+ */
+
+template <class TFixedImage, class TMovingImage>
+void
+VarianceOverLastDimensionImageMetric<TFixedImage, TMovingImage>::SubtractMeanDerivative(
+  DerivativeType & derivative) const
+{
+  if (!this->m_SubtractMean)
+  {
+    return;
+  }
+
+  /** Retrieve slowest varying dimension and its size. */
+  const unsigned int lastDim = this->GetFixedImage()->GetImageDimension() - 1;
+  const unsigned int lastDimSize = this->GetFixedImage()->GetLargestPossibleRegion().GetSize(lastDim);
+
+  if (!this->m_TransformIsStackTransform)
+  {
+    /** Update derivative per dimension.
+     * Parameters are ordered xxxxxxx yyyyyyy zzzzzzz ttttttt and
+     * per dimension xyz.
+     */
+    const unsigned int lastDimGridSize = this->m_GridSize[lastDim];
+    const unsigned int numParametersPerDimension =
+      this->GetNumberOfParameters() / this->GetMovingImage()->GetImageDimension();
+    const unsigned int numControlPointsPerDimension = numParametersPerDimension / lastDimGridSize;
+    DerivativeType     mean(numControlPointsPerDimension);
+    for (unsigned int d = 0; d < this->GetMovingImage()->GetImageDimension(); ++d)
+    {
+      /** Compute mean per dimension. */
+      mean.Fill(0.0);
+      const unsigned int starti = numParametersPerDimension * d;
+      for (unsigned int i = starti; i < starti + numParametersPerDimension; ++i)
+      {
+        const unsigned int index = i % numControlPointsPerDimension;
+        mean[index] += derivative[i];
+      }
+      mean /= static_cast<double>(lastDimGridSize);
 
-      /** Update derivative per control point. */
-      for (unsigned int t = 0; t < lastDimSize; ++t)
+      /** Update derivative for every control point per dimension. */
+      for (unsigned int i = starti; i < starti + numParametersPerDimension; ++i)
       {
-        const unsigned int startc = numParametersPerLastDimension * t;
-        for (unsigned int c = startc; c < startc + numParametersPerLastDimension; ++c)
-        {
-          const unsigned int index = c % numParametersPerLastDimension;
-          derivative[c] -= mean[index];
-        }
+        const unsigned int index = i % numControlPointsPerDimension;
+        derivative[i] -= mean[index];
       }
     }
   }
+  else
+  {
+    /** Update derivative per dimension.
+     * Parameters are ordered x0x0x0y0y0y0z0z0z0x1x1x1y1y1y1z1z1z1 with
+     * the number the time point index.
+     */
+    const unsigned int numParametersPerLastDimension = this->GetNumberOfParameters() / lastDimSize;
+    DerivativeType     mean(numParametersPerLastDimension);
+    mean.Fill(0.0);
+
+    /** Compute mean per control point. */
+    for (unsigned int t = 0; t < lastDimSize; ++t)
+    {
+      const unsigned int startc = numParametersPerLastDimension * t;
+      for (unsigned int c = startc; c < startc + numParametersPerLastDimension; ++c)
+      {
+        const unsigned int index = c % numParametersPerLastDimension;
+        mean[index] += derivative[c];
+      }
+    }
+    mean /= static_cast<double>(lastDimSize);
 
-  /** Return the measure value. */
-  value = measure;
+    /** Update derivative per control point. */
+    for (unsigned int t = 0; t < lastDimSize; ++t)
+    {
+      const unsigned int startc = numParametersPerLastDimension * t;
+      for (unsigned int c = startc; c < startc + numParametersPerLastDimension; ++c)
+      {
+        const unsigned int index = c % numParametersPerLastDimension;
+        derivative[c] -= mean[index];
+      }
+    }
+  }
 
-} // end GetValueAndDerivative()
+} // end SubtractMeanDerivative()
 
 
 } // end namespace itk
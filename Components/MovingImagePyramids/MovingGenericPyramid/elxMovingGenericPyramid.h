@@ -60,6 +60,16 @@ namespace elastix
  * ImagePyramidUseShrinkImageFilter: Flag to specify if the ShrinkingImageFilter is used for rescaling the image, or the
  * ResampleImageFilter. Shrinker is faster.\n example: <tt>(ImagePyramidUseShrinkImageFilter "true")</tt>\n Default
  * false, so by default the resampler is used.
+ * \parameter ComputePyramidImagesInBackground: Flag to specify if the images of the next
+ *    resolution are computed in the background, while the current resolution is registered.
+ *    Only used when ComputePyramidImagesPerResolution is true.\n
+ *    example: <tt>(ComputePyramidImagesInBackground "true")</tt>\n
+ *    Default false.
+ * \parameter ImagePyramidUseGaussianShrinkImageFilter: Flag to specify if the images that are
+ *    both smoothed and rescaled are computed in one pass, which is faster and needs less memory.
+ *    Its Gaussian kernel is truncated, so the images differ slightly from the default ones.\n
+ *    example: <tt>(ImagePyramidUseGaussianShrinkImageFilter "true")</tt>\n
+ *    Default false.
  *
  * \ingroup ImagePyramids
  */
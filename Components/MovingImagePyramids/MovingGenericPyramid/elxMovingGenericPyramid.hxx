@@ -143,6 +143,14 @@ MovingGenericPyramid<TElastix>::SetMovingSchedule(void)
   this->m_Configuration->ReadParameter(useShrinkImageFilter, "ImagePyramidUseShrinkImageFilter", 0, false);
   this->SetUseShrinkImageFilter(useShrinkImageFilter);
 
+  /** Use or skip the filter that smooths and rescales at once, without
+   * computing the smoothed image at full resolution.
+   */
+  bool useGaussianShrinkImageFilter = false;
+  this->m_Configuration->ReadParameter(
+    useGaussianShrinkImageFilter, "ImagePyramidUseGaussianShrinkImageFilter", 0, false);
+  this->SetUseGaussianShrinkImageFilter(useGaussianShrinkImageFilter);
+
   /** Decide whether or not to compute the pyramid images only for the current
    * resolution. Setting the option to true saves memory, since only one level
    * of the pyramid gets allocated per resolution.
@@ -151,6 +159,14 @@ MovingGenericPyramid<TElastix>::SetMovingSchedule(void)
   this->m_Configuration->ReadParameter(computeThisResolution, "ComputePyramidImagesPerResolution", 0, false);
   this->SetComputeOnlyForCurrentLevel(computeThisResolution);
 
+  /** Decide whether or not to compute the pyramid images of the next resolution
+   * in the background, while the current resolution is registered. This is only
+   * used when the pyramid images are computed per resolution.
+   */
+  bool computeInBackground = false;
+  this->m_Configuration->ReadParameter(computeInBackground, "ComputePyramidImagesInBackground", 0, false);
+  this->SetPrefetchNextLevel(computeInBackground);
+
 } // end SetMovingSchedule()
 
 
@@ -632,6 +632,7 @@ AdaGrad<TElastix>::AutomaticPreconditionerEstimation(void)
   computeDisplacementDistribution->SetTransform(this->GetRegistration()->GetAsITKBaseType()->GetModifiableTransform());
   computeDisplacementDistribution->SetCostFunction(this->m_CostFunction);
   computeDisplacementDistribution->SetNumberOfJacobianMeasurements(this->m_NumberOfJacobianMeasurements);
+  computeDisplacementDistribution->SetMultiThreaderType(testPtr->GetMultiThreaderType());
 
 
   std::string maximumDisplacementEstimationMethod = "2sigma";
@@ -675,6 +675,7 @@ AdaptiveStochasticGradientDescent<TElastix>::AutomaticParameterEstimationUsingDi
   computeDisplacementDistribution->SetTransform(this->GetRegistration()->GetAsITKBaseType()->GetModifiableTransform());
   computeDisplacementDistribution->SetCostFunction(this->m_CostFunction);
   computeDisplacementDistribution->SetNumberOfJacobianMeasurements(this->m_NumberOfJacobianMeasurements);
+  computeDisplacementDistribution->SetMultiThreaderType(testPtr->GetMultiThreaderType());
 
   /** Check if use scales. */
   if (this->GetUseScales())
@@ -1080,6 +1080,7 @@ AdaptiveStochasticLBFGS<TElastix>::AutomaticParameterEstimationUsingDisplacement
   computeDisplacementDistribution->SetTransform(this->GetRegistration()->GetAsITKBaseType()->GetModifiableTransform());
   computeDisplacementDistribution->SetCostFunction(this->m_CostFunction);
   computeDisplacementDistribution->SetNumberOfJacobianMeasurements(this->m_NumberOfJacobianMeasurements);
+  computeDisplacementDistribution->SetMultiThreaderType(testPtr->GetMultiThreaderType());
 
   /** Check if use scales. */
   if (this->GetUseScales())
@@ -1190,6 +1191,7 @@ AdaptiveStochasticLBFGS<TElastix>::AutomaticLBFGSStepsizeEstimation(void)
   computeDisplacementDistribution->SetTransform(this->GetRegistration()->GetAsITKBaseType()->GetModifiableTransform());
   computeDisplacementDistribution->SetCostFunction(this->m_CostFunction);
   computeDisplacementDistribution->SetNumberOfJacobianMeasurements(this->m_NumberOfJacobianMeasurements);
+  computeDisplacementDistribution->SetMultiThreaderType(testPtr->GetMultiThreaderType());
 
   /** Check if use scales. */
   if (this->GetUseScales())
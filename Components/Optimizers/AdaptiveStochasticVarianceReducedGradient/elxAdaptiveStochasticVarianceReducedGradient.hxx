@@ -938,6 +938,7 @@ AdaptiveStochasticVarianceReducedGradient<TElastix>::AutomaticParameterEstimatio
   computeDisplacementDistribution->SetTransform(this->GetRegistration()->GetAsITKBaseType()->GetModifiableTransform());
   computeDisplacementDistribution->SetCostFunction(this->m_CostFunction);
   computeDisplacementDistribution->SetNumberOfJacobianMeasurements(this->m_NumberOfJacobianMeasurements);
+  computeDisplacementDistribution->SetMultiThreaderType(testPtr->GetMultiThreaderType());
 
   /** Check if use scales. */
   if (this->GetUseScales())
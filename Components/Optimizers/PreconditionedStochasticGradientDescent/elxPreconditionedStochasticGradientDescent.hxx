@@ -631,6 +631,7 @@ PreconditionedStochasticGradientDescent<TElastix>::AutomaticPreconditionerEstima
       this->GetRegistration()->GetAsITKBaseType()->GetModifiableTransform());
     computeDisplacementDistribution->SetCostFunction(this->m_CostFunction);
     computeDisplacementDistribution->SetNumberOfJacobianMeasurements(this->m_NumberOfJacobianMeasurements);
+    computeDisplacementDistribution->SetMultiThreaderType(testPtr->GetMultiThreaderType());
 
     std::string maximumDisplacementEstimationMethod = "2sigma";
     this->GetConfiguration()->ReadParameter(
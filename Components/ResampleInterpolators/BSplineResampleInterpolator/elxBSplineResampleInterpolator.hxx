@@ -70,6 +70,32 @@ BSplineResampleInterpolator<TElastix>::ReadFromFile(void)
 } // end ReadFromFile()
 
 
+/**
+ * ******************* SetInputImage ****************************
+ */
+
+template <class TElastix>
+void
+BSplineResampleInterpolator<TElastix>::SetInputImage(const InputImageType * inputData)
+{
+  /** The resampler sets its input image at each update, which is once per slab
+   * when the result image is streamed. Keep the coefficients if they are still valid.
+   */
+  if ((inputData != nullptr) && (inputData == this->GetInputImage()) &&
+      (this->GetSplineOrder() == this->m_CoefficientsSplineOrder) &&
+      (inputData->GetMTime() < this->m_CoefficientsTimeStamp.GetMTime()))
+  {
+    return;
+  }
+
+  /** Compute the coefficients in the superclass. */
+  this->Superclass1::SetInputImage(inputData);
+  this->m_CoefficientsSplineOrder = this->GetSplineOrder();
+  this->m_CoefficientsTimeStamp.Modified();
+
+} // end SetInputImage()
+
+
 /**
  * ******************* CreateDerivedTransformParametersMap ******************************
  */
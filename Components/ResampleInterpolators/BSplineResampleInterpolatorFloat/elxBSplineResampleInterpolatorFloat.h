@@ -117,6 +117,13 @@ public:
   void
   ReadFromFile(void) override;
 
+  /** Set the input image, and compute its B-spline coefficients. The coefficients
+   * are only recomputed when the image or the spline order has changed, and not
+   * for each slab of a streamed result image.
+   */
+  void
+  SetInputImage(const InputImageType * inputData) override;
+
 protected:
   /** The constructor. */
   BSplineResampleInterpolatorFloat() = default;
@@ -135,6 +142,10 @@ private:
   /** The deleted assignment operator. */
   void
   operator=(const Self &) = delete;
+
+  /** The spline order of the current coefficients, and when they were computed. */
+  unsigned int   m_CoefficientsSplineOrder{ 0 };
+  itk::TimeStamp m_CoefficientsTimeStamp;
 };
 
 } // end namespace elastix
@@ -36,6 +36,16 @@ namespace elastix
  *    <tt>(Resampler "OpenCLResampler")</tt>
  * \parameter Resampler: Enable the OpenCL resampler as follows:\n
  *    <tt>(OpenCLResamplerUseOpenCL "true")</tt>
+ * \parameter OpenCLResamplerNumberOfTiles: Resample the output in this number of tiles,
+ *    so that volumes larger than the device memory can be resampled on the GPU. For each
+ *    tile only the part of the input image that the transform maps it onto is uploaded,
+ *    padded by the support of the interpolator. For the B-spline interpolator the padding
+ *    also covers the decomposition into coefficients, within single precision. While a
+ *    tile is resampled on the device, the input of the next tile is uploaded on another
+ *    command queue. For other interpolators the complete input image is uploaded once,
+ *    and only the output is tiled.
+ *    The default value is 1, which resamples the whole image at once.\n
+ *    example: <tt>(OpenCLResamplerNumberOfTiles 8)</tt>
  *
  * \author Denis P. Shamonin and Marius Staring. Division of Image Processing,
  * Department of Radiology, Leiden, The Netherlands
@@ -82,7 +92,8 @@ public:
   using typename Superclass1::TransformType;
 
   using typename Superclass1::InputImageType;
-  typedef typename InputImageType::PixelType InputImagePixelType;
+  typedef typename InputImageType::PixelType  InputImagePixelType;
+  typedef typename InputImageType::RegionType InputImageRegionType;
 
   using typename Superclass1::OutputImageType;
   typedef typename OutputImageType::PixelType  OutputImagePixelType;
@@ -92,6 +103,7 @@ public:
   typedef itk::GPUImage<InputImagePixelType, InputImageType::ImageDimension>   GPUInputImageType;
   typedef typename GPUInputImageType::Pointer                                  GPUInputImagePointer;
   typedef itk::GPUImage<OutputImagePixelType, OutputImageType::ImageDimension> GPUOutputImageType;
+  typedef typename GPUOutputImageType::Pointer                                 GPUOutputImagePointer;
   typedef float                                                                GPUInterpolatorPrecisionType;
 
   typedef itk::GPUResampleImageFilter<GPUInputImageType, GPUOutputImageType, GPUInterpolatorPrecisionType>
@@ -130,6 +142,10 @@ protected:
   void
   GenerateData(void) override;
 
+  /** Executes GPU resampler tile by tile, see OpenCLResamplerNumberOfTiles. */
+  void
+  GenerateDataStreamed(void);
+
   /** Transform copier */
   typedef typename ResamplerBase<TElastix>::CoordRepType InterpolatorPrecisionType;
   typedef typename itk::AdvancedCombinationTransform<InterpolatorPrecisionType, OutputImageType::ImageDimension>
@@ -174,6 +190,42 @@ private:
   void
   ReportToLog(void);
 
+  /** Helper method to create a GPU image from a CPU image and upload it to the device. */
+  GPUInputImagePointer
+  CreateGPUInputImage(const InputImageType * image) const;
+
+  /** Helper method to compute the margin (in voxels) around a mapped tile that the
+   * interpolator needs. Returns false for an interpolator whose input cannot be cropped.
+   */
+  bool
+  ComputeInterpolatorMarginForTiles(double & margin) const;
+
+  /** Helper method to compute the region of the input image that is needed
+   * to resample the given output region, padded by the interpolator margin.
+   * Returns false when the output region is mapped completely outside the input image.
+   */
+  bool
+  ComputeInputRegionForTile(const OutputImageRegionType & tileRegion,
+                            const double                  interpolatorMargin,
+                            InputImageRegionType &        inputRegion) const;
+
+  /** Data of a single tile, on the host and on the device. */
+  struct TileType
+  {
+    OutputImageRegionType            m_OutputRegion;
+    typename InputImageType::Pointer m_Input;
+    GPUInputImagePointer             m_GPUInput;
+    itk::OpenCLEvent                 m_UploadEvent;
+  };
+
+  /** Helper method to prepare the input of a single tile on the host. */
+  TileType
+  PrepareTile(const OutputImageRegionType & tileRegion, const double interpolatorMargin) const;
+
+  /** Helper method to start uploading the input of a single tile on the given command queue. */
+  void
+  UploadTile(TileType & tile, const itk::OpenCLCommandQueue & queue) const;
+
   TransformCopierPointer   m_TransformCopier;
   InterpolateCopierPointer m_InterpolatorCopier;
   GPUResamplerPointer      m_GPUResampler;
@@ -181,6 +233,7 @@ private:
   bool                     m_GPUResamplerCreated;
   bool                     m_ContextCreated;
   bool                     m_UseOpenCL;
+  unsigned int             m_NumberOfTiles;
 };
 
 // end class OpenCLResampler
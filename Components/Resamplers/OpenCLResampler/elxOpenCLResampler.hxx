@@ -21,6 +21,19 @@
 #include "elxOpenCLResampler.h"
 #include "itkOpenCLLogger.h"
 
+#include "itkBSplineDecompositionImageFilter.h"
+#include "itkBSplineInterpolateImageFunction.h"
+#include "itkImageAlgorithm.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionSplitterSlowDimension.h"
+#include "itkLinearInterpolateImageFunction.h"
+#include "itkNearestNeighborInterpolateImageFunction.h"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <vector>
+
 namespace elastix
 {
 
@@ -69,6 +82,7 @@ elastix::OpenCLResampler<TElastix>::OpenCLResampler()
   }
 
   this->m_UseOpenCL = true;
+  this->m_NumberOfTiles = 1;
   this->m_ShowProgress = false;
 
 } // end Constructor
@@ -157,17 +171,14 @@ OpenCLResampler<TElastix>::BeforeGenerateData(void)
     }
   }
 
-  if (this->m_GPUResamplerReady)
+  // When streaming, the input image is uploaded tile by tile in GenerateDataStreamed()
+  const bool streaming = this->m_NumberOfTiles > 1;
+  if (this->m_GPUResamplerReady && !streaming)
   {
     // Create GPU input image
     try
     {
-      gpuInputImage = GPUInputImageType::New();
-      gpuInputImage->GraftITKImage(this->GetInput());
-      gpuInputImage->AllocateGPU();
-      gpuInputImage->GetGPUDataManager()->SetCPUBufferLock(true);
-      gpuInputImage->GetGPUDataManager()->SetGPUDirtyFlag(true);
-      gpuInputImage->GetGPUDataManager()->UpdateGPUBuffer();
+      gpuInputImage = this->CreateGPUInputImage(this->GetInput());
     }
     catch (itk::ExceptionObject & e)
     {
@@ -191,7 +202,10 @@ OpenCLResampler<TElastix>::BeforeGenerateData(void)
   {
     try
     {
-      this->m_GPUResampler->SetInput(gpuInputImage);
+      if (!streaming)
+      {
+        this->m_GPUResampler->SetInput(gpuInputImage);
+      }
       this->m_GPUResampler->SetTransform(gpuTransform);
       this->m_GPUResampler->SetInterpolator(gpuInterpolator);
     }
@@ -238,6 +252,14 @@ OpenCLResampler<TElastix>::GenerateData(void)
     return;
   }
 
+  // Resample the image tile by tile
+  if (this->m_NumberOfTiles > 1)
+  {
+    this->GenerateDataStreamed();
+    this->ReportToLog();
+    return;
+  }
+
   // Allocate memory
   this->AllocateOutputs();
 
@@ -253,6 +275,117 @@ OpenCLResampler<TElastix>::GenerateData(void)
 } // end GenerateData()
 
 
+/**
+ * ******************* GenerateDataStreamed ***********************
+ */
+
+template <class TElastix>
+void
+OpenCLResampler<TElastix>::GenerateDataStreamed(void)
+{
+  // Allocate memory for the complete output on the host only
+  this->AllocateOutputs();
+  OutputImageType * outputPtr = this->GetOutput();
+
+  // Split the output in tiles along the slowest dimension
+  const OutputImageRegionType outputRegion = outputPtr->GetRequestedRegion();
+  auto                        splitter = itk::ImageRegionSplitterSlowDimension::New();
+  const unsigned int          numberOfTiles = splitter->GetNumberOfSplits(outputRegion, this->m_NumberOfTiles);
+
+  const auto getTileRegion = [&splitter, &outputRegion, numberOfTiles](const unsigned int tile) {
+    OutputImageRegionType tileRegion = outputRegion;
+    splitter->GetSplit(tile, numberOfTiles, tileRegion);
+    return tileRegion;
+  };
+
+  // Resamples a tile from the current input of the GPU resampler, and stitches it into the output on the host
+  const auto resampleTile = [this, outputPtr](const OutputImageRegionType & tileRegion) {
+    // The OpenCL kernels assume a zero start index, so shift the origin instead
+    typename OutputImageType::PointType tileOrigin;
+    outputPtr->TransformIndexToPhysicalPoint(tileRegion.GetIndex(), tileOrigin);
+    typename OutputImageType::IndexType startIndex;
+    startIndex.Fill(0);
+
+    this->m_GPUResampler->SetSize(tileRegion.GetSize());
+    this->m_GPUResampler->SetOutputOrigin(tileOrigin);
+    this->m_GPUResampler->SetOutputStartIndex(startIndex);
+    this->m_GPUResampler->Update();
+
+    const GPUOutputImageType * gpuOutput = this->m_GPUResampler->GetOutput();
+    itk::ImageAlgorithm::Copy(gpuOutput, outputPtr, gpuOutput->GetLargestPossibleRegion(), tileRegion);
+  };
+
+  // When the input cannot be cropped, the complete input is uploaded once, and
+  // only the output is resampled tile by tile.
+  double     interpolatorMargin = 0.0;
+  const bool cropInput = this->ComputeInterpolatorMarginForTiles(interpolatorMargin);
+  if (!cropInput)
+  {
+    this->m_GPUResampler->SetInput(this->CreateGPUInputImage(this->GetInput()));
+    for (unsigned int tile = 0; tile < numberOfTiles; ++tile)
+    {
+      resampleTile(getTileRegion(tile));
+    }
+    this->m_GPUResampler->SetInput(nullptr);
+    return;
+  }
+
+  // The cropped inputs are double buffered on the device: while a tile is resampled,
+  // the input of the next tile is uploaded on a separate command queue, and the input
+  // of the tile after that is prepared on the host. The upload event of a tile makes
+  // sure that it is only resampled after its input has arrived on the device.
+  itk::OpenCLContext::Pointer   context = itk::OpenCLContext::GetInstance();
+  const itk::OpenCLCommandQueue transferQueue = context->CreateCommandQueue(0);
+
+  TileType currentTile = this->PrepareTile(getTileRegion(0), interpolatorMargin);
+  this->UploadTile(currentTile, transferQueue);
+
+  std::future<TileType> preparedTile;
+  if (numberOfTiles > 1)
+  {
+    preparedTile = std::async(std::launch::async, &Self::PrepareTile, this, getTileRegion(1), interpolatorMargin);
+  }
+
+  for (unsigned int tile = 0; tile < numberOfTiles; ++tile)
+  {
+    // Start uploading the next tile, and preparing the tile after it
+    TileType nextTile;
+    if (tile + 1 < numberOfTiles)
+    {
+      nextTile = preparedTile.get();
+      this->UploadTile(nextTile, transferQueue);
+      if (tile + 2 < numberOfTiles)
+      {
+        preparedTile =
+          std::async(std::launch::async, &Self::PrepareTile, this, getTileRegion(tile + 2), interpolatorMargin);
+      }
+    }
+
+    if (currentTile.m_Input.IsNull())
+    {
+      // The tile is mapped completely outside the input image
+      for (itk::ImageRegionIterator<OutputImageType> it(outputPtr, currentTile.m_OutputRegion); !it.IsAtEnd(); ++it)
+      {
+        it.Set(this->GetDefaultPixelValue());
+      }
+    }
+    else
+    {
+      currentTile.m_UploadEvent.WaitForFinished();
+      this->m_GPUResampler->SetInput(currentTile.m_GPUInput);
+      resampleTile(currentTile.m_OutputRegion);
+      this->m_GPUResampler->SetInput(nullptr);
+    }
+
+    // Release the device memory of this tile
+    currentTile = nextTile;
+  }
+
+  clFinish(transferQueue.GetQueueId());
+
+} // end GenerateDataStreamed()
+
+
 /**
  * ******************* BeforeRegistration ***********************
  */
@@ -265,6 +398,10 @@ OpenCLResampler<TElastix>::BeforeRegistration(void)
   this->m_UseOpenCL = true;
   this->m_Configuration->ReadParameter(this->m_UseOpenCL, "OpenCLResamplerUseOpenCL", 0, false);
 
+  // Split the output in tiles to limit the device memory usage?
+  this->m_NumberOfTiles = 1;
+  this->m_Configuration->ReadParameter(this->m_NumberOfTiles, "OpenCLResamplerNumberOfTiles", 0, false);
+
 } // end BeforeRegistration()
 
 
@@ -283,6 +420,9 @@ OpenCLResampler<TElastix>::ReadFromFile(void)
   this->m_UseOpenCL = true;
   this->m_Configuration->ReadParameter(this->m_UseOpenCL, "OpenCLResamplerUseOpenCL", 0);
 
+  this->m_NumberOfTiles = 1;
+  this->m_Configuration->ReadParameter(this->m_NumberOfTiles, "OpenCLResamplerNumberOfTiles", 0, false);
+
 } // end ReadFromFile()
 
 
@@ -334,9 +474,256 @@ OpenCLResampler<TElastix>::ReportToLog(void)
   itk::OpenCLDevice           device = context->GetDefaultDevice();
   elxout << "  Applying final transform was performed by " << device.GetName() << " from " << device.GetVendor() << "."
          << std::endl;
+  if (this->m_NumberOfTiles > 1)
+  {
+    elxout << "  The output was resampled in " << this->m_NumberOfTiles << " tiles." << std::endl;
+  }
 } // end ReportToLog()
 
 
+/**
+ * ************************* CreateGPUInputImage ************************************
+ */
+
+template <class TElastix>
+auto
+OpenCLResampler<TElastix>::CreateGPUInputImage(const InputImageType * image) const -> GPUInputImagePointer
+{
+  GPUInputImagePointer gpuInputImage = GPUInputImageType::New();
+  gpuInputImage->GraftITKImage(image);
+  gpuInputImage->AllocateGPU();
+  gpuInputImage->GetGPUDataManager()->SetCPUBufferLock(true);
+  gpuInputImage->GetGPUDataManager()->SetGPUDirtyFlag(true);
+  gpuInputImage->GetGPUDataManager()->UpdateGPUBuffer();
+  return gpuInputImage;
+
+} // end CreateGPUInputImage()
+
+
+/**
+ * ************************* ComputeInterpolatorMarginForTiles ************************************
+ */
+
+template <class TElastix>
+bool
+OpenCLResampler<TElastix>::ComputeInterpolatorMarginForTiles(double & margin) const
+{
+  typedef itk::NearestNeighborInterpolateImageFunction<InputImageType, InterpolatorCoordRepType> NearestNeighborType;
+  typedef itk::LinearInterpolateImageFunction<InputImageType, InterpolatorCoordRepType>          LinearType;
+  typedef itk::BSplineInterpolateImageFunction<InputImageType, InterpolatorCoordRepType, InterpolatorCoordRepType>
+    BSplineType;
+  typedef itk::Image<InterpolatorCoordRepType, InputImageType::ImageDimension>                   CoefficientImageType;
+  typedef itk::BSplineDecompositionImageFilter<InputImageType, CoefficientImageType>             DecompositionType;
+
+  const InterpolatorType * interpolator = this->GetInterpolator();
+
+  // Nearest neighbor and linear interpolation only use the voxels next to a point
+  if (dynamic_cast<const NearestNeighborType *>(interpolator) != nullptr ||
+      dynamic_cast<const LinearType *>(interpolator) != nullptr)
+  {
+    margin = 1.0;
+    return true;
+  }
+
+  // The B-spline interpolator decomposes its input into coefficients with a recursive
+  // filter over the complete image. On a cropped input the coefficients differ near the
+  // crop border, by a factor that decreases with the largest spline pole per voxel. The
+  // margin beyond the support of the B-spline makes that difference smaller than the
+  // single precision on the device.
+  const BSplineType * bspline = dynamic_cast<const BSplineType *>(interpolator);
+  if (bspline != nullptr)
+  {
+    auto decomposition = DecompositionType::New();
+    decomposition->SetSplineOrder(bspline->GetSplineOrder());
+
+    double largestPole = 0.0;
+    for (const double pole : decomposition->GetSplinePoles())
+    {
+      largestPole = std::max(largestPole, std::abs(pole));
+    }
+
+    margin = 0.5 * (bspline->GetSplineOrder() + 1);
+    if (largestPole > 0.0)
+    {
+      margin += std::ceil(std::log(itk::NumericTraits<float>::epsilon()) / std::log(largestPole));
+    }
+    return true;
+  }
+
+  // Other interpolators are not cropped
+  return false;
+
+} // end ComputeInterpolatorMarginForTiles()
+
+
+/**
+ * ************************* ComputeInputRegionForTile ************************************
+ */
+
+template <class TElastix>
+bool
+OpenCLResampler<TElastix>::ComputeInputRegionForTile(const OutputImageRegionType & tileRegion,
+                                                     const double                  interpolatorMargin,
+                                                     InputImageRegionType &        inputRegion) const
+{
+  const unsigned int Dimension = OutputImageType::ImageDimension;
+  typedef itk::ContinuousIndex<double, Dimension> ContinuousIndexType;
+
+  const InputImageType *  inputPtr = this->GetInput();
+  const OutputImageType * outputPtr = this->GetOutput();
+  const TransformType *   transform = this->GetTransform();
+  const bool              isLinear = transform->IsLinear();
+
+  // Map a grid of points over the tile to the input image. For a linear transform
+  // the corners suffice, as their bounding box contains the whole mapped tile. For
+  // a nonlinear transform the grid has a point every few voxels.
+  const itk::SizeValueType gridStep = 8;
+
+  itk::Size<Dimension> gridSize;
+  itk::Size<Dimension> step;
+  itk::SizeValueType   numberOfGridPoints = 1;
+  for (unsigned int d = 0; d < Dimension; ++d)
+  {
+    const itk::SizeValueType tileSize = tileRegion.GetSize(d);
+    step[d] = isLinear ? std::max<itk::SizeValueType>(tileSize - 1, 1) : gridStep;
+    gridSize[d] = (tileSize - 1 + step[d] - 1) / step[d] + 1;
+    numberOfGridPoints *= gridSize[d];
+  }
+
+  std::vector<ContinuousIndexType>   mappedPoints(numberOfGridPoints);
+  itk::FixedArray<double, Dimension> minimum;
+  itk::FixedArray<double, Dimension> maximum;
+  minimum.Fill(itk::NumericTraits<double>::max());
+  maximum.Fill(itk::NumericTraits<double>::NonpositiveMin());
+
+  for (itk::SizeValueType n = 0; n < numberOfGridPoints; ++n)
+  {
+    typename OutputImageType::IndexType outputIndex;
+    itk::SizeValueType                  remainder = n;
+    for (unsigned int d = 0; d < Dimension; ++d)
+    {
+      const itk::SizeValueType gridIndex = remainder % gridSize[d];
+      remainder /= gridSize[d];
+      const itk::SizeValueType offset = std::min(gridIndex * step[d], tileRegion.GetSize(d) - 1);
+      outputIndex[d] = tileRegion.GetIndex(d) + static_cast<itk::IndexValueType>(offset);
+    }
+
+    typename TransformType::InputPointType outputPoint;
+    outputPtr->TransformIndexToPhysicalPoint(outputIndex, outputPoint);
+    const typename TransformType::OutputPointType inputPoint = transform->TransformPoint(outputPoint);
+
+    inputPtr->TransformPhysicalPointToContinuousIndex(inputPoint, mappedPoints[n]);
+    for (unsigned int d = 0; d < Dimension; ++d)
+    {
+      minimum[d] = std::min(minimum[d], mappedPoints[n][d]);
+      maximum[d] = std::max(maximum[d], mappedPoints[n][d]);
+    }
+  }
+
+  // A nonlinear transform may map the voxels between neighboring grid points outside
+  // the bounding box of the mapped grid points. For a transform that is smooth on the
+  // scale of the grid, they stay within the largest distance between mapped
+  // neighboring grid points, so the bounding box is padded by that distance.
+  double transformMargin = 0.0;
+  if (!isLinear)
+  {
+    itk::SizeValueType stride = 1;
+    for (unsigned int d = 0; d < Dimension; ++d)
+    {
+      for (itk::SizeValueType n = 0; n < numberOfGridPoints; ++n)
+      {
+        if ((n / stride) % gridSize[d] + 1 < gridSize[d])
+        {
+          for (unsigned int e = 0; e < Dimension; ++e)
+          {
+            transformMargin = std::max(transformMargin, std::abs(mappedPoints[n + stride][e] - mappedPoints[n][e]));
+          }
+        }
+      }
+      stride *= gridSize[d];
+    }
+  }
+
+  // Convert the padded bounding box to a region and crop it by the input image.
+  // One more voxel is added for rounding errors.
+  const double padding = interpolatorMargin + transformMargin + 1.0;
+
+  typename InputImageType::IndexType index;
+  typename InputImageType::SizeType  size;
+  for (unsigned int d = 0; d < Dimension; ++d)
+  {
+    index[d] = static_cast<itk::IndexValueType>(std::floor(minimum[d] - padding));
+    size[d] = static_cast<itk::SizeValueType>(std::ceil(maximum[d] + padding) - index[d] + 1);
+  }
+  inputRegion.SetIndex(index);
+  inputRegion.SetSize(size);
+
+  return inputRegion.Crop(inputPtr->GetLargestPossibleRegion());
+
+} // end ComputeInputRegionForTile()
+
+
+/**
+ * ************************* PrepareTile ************************************
+ */
+
+template <class TElastix>
+auto
+OpenCLResampler<TElastix>::PrepareTile(const OutputImageRegionType & tileRegion, const double interpolatorMargin) const
+  -> TileType
+{
+  TileType tile;
+  tile.m_OutputRegion = tileRegion;
+
+  InputImageRegionType inputRegion;
+  if (this->ComputeInputRegionForTile(tileRegion, interpolatorMargin, inputRegion))
+  {
+    // Copy the needed input region into a new image. The copy has a zero
+    // start index, so its origin is shifted accordingly.
+    const InputImageType * inputPtr = this->GetInput();
+
+    typename InputImageType::PointType origin;
+    inputPtr->TransformIndexToPhysicalPoint(inputRegion.GetIndex(), origin);
+
+    tile.m_Input = InputImageType::New();
+    tile.m_Input->SetRegions(inputRegion.GetSize());
+    tile.m_Input->SetOrigin(origin);
+    tile.m_Input->SetSpacing(inputPtr->GetSpacing());
+    tile.m_Input->SetDirection(inputPtr->GetDirection());
+    tile.m_Input->Allocate();
+    itk::ImageAlgorithm::Copy(inputPtr, tile.m_Input.GetPointer(), inputRegion, tile.m_Input->GetBufferedRegion());
+  }
+  return tile;
+
+} // end PrepareTile()
+
+
+/**
+ * ************************* UploadTile ************************************
+ */
+
+template <class TElastix>
+void
+OpenCLResampler<TElastix>::UploadTile(TileType & tile, const itk::OpenCLCommandQueue & queue) const
+{
+  if (tile.m_Input.IsNull())
+  {
+    return;
+  }
+
+  // Enqueue the copy to the device without waiting for it. The host image of the
+  // tile is kept alive until the copy has finished.
+  tile.m_GPUInput = GPUInputImageType::New();
+  tile.m_GPUInput->GraftITKImage(tile.m_Input);
+  tile.m_GPUInput->AllocateGPU();
+  tile.m_GPUInput->GetGPUDataManager()->SetCPUBufferLock(true);
+  tile.m_GPUInput->GetGPUDataManager()->SetGPUDirtyFlag(true);
+  tile.m_UploadEvent = tile.m_GPUInput->GetGPUDataManager()->UpdateGPUBufferAsync(queue);
+  clFlush(queue.GetQueueId());
+
+} // end UploadTile()
+
+
 } // end namespace elastix
 
 #endif // end #ifndef elxOpenCLResampler_hxx
@@ -23,6 +23,7 @@
 
 #include "itkBSplineResampleImageFunction.h"
 #include "itkBSplineDecompositionImageFilter.h"
+#include "itkMultiThreaderBase.h"
 
 #include <cmath>
 
@@ -1059,35 +1060,36 @@ BSplineTransformWithDiffusion<TElastix>::DiffuseDeformationField(void)
   dummyImage->SetOrigin(this->m_DeformationOrigin);
   dummyImage->SetSpacing(this->m_DeformationSpacing);
 
-  /** Setup an iterator over dummyImage and outputImage. */
-  DummyIteratorType       iter(dummyImage, this->m_DeformationRegion);
-  VectorImageIteratorType iterout(this->m_DeformationField, this->m_DeformationRegion);
+  /** Calculate the TransformPoint of all voxels of the image, multi-threaded. */
+  const auto multiThreader = itk::MultiThreaderBase::New();
+  multiThreader->ParallelizeImageRegion<SpaceDimension>(
+    this->m_DeformationRegion,
+    [this, &dummyImage](const RegionType & regionForThread) {
+      /** Setup an iterator over dummyImage and outputImage. */
+      DummyIteratorType       iter(dummyImage, regionForThread);
+      VectorImageIteratorType iterout(this->m_DeformationField, regionForThread);
 
-  /** Declare stuff. */
-  InputPointType  inputPoint;
-  OutputPointType outputPoint;
-  VectorType      diff_point;
-  IndexType       inputIndex;
+      /** Declare stuff. */
+      InputPointType inputPoint;
+      VectorType     diff_point;
 
-  /** Calculate the TransformPoint of all voxels of the image. */
-  iter.GoToBegin();
-  iterout.GoToBegin();
-  while (!iter.IsAtEnd())
-  {
-    inputIndex = iter.GetIndex();
-    /** Transform the points to physical space. */
-    dummyImage->TransformIndexToPhysicalPoint(inputIndex, inputPoint);
-    /** Call TransformPoint. */
-    outputPoint = this->TransformPoint(inputPoint);
-    /** Calculate the difference. */
-    for (unsigned int i = 0; i < this->FixedImageDimension; ++i)
-    {
-      diff_point[i] = outputPoint[i] - inputPoint[i];
-    }
-    iterout.Set(diff_point);
-    ++iter;
-    ++iterout;
-  }
+      while (!iter.IsAtEnd())
+      {
+        /** Transform the points to physical space. */
+        dummyImage->TransformIndexToPhysicalPoint(iter.GetIndex(), inputPoint);
+        /** Call TransformPoint. */
+        const OutputPointType outputPoint = this->TransformPoint(inputPoint);
+        /** Calculate the difference. */
+        for (unsigned int i = 0; i < this->FixedImageDimension; ++i)
+        {
+          diff_point[i] = outputPoint[i] - inputPoint[i];
+        }
+        iterout.Set(diff_point);
+        ++iter;
+        ++iterout;
+      }
+    },
+    nullptr);
 
   /** ------------- 2: Update the intermediary deformationFieldTransform. ------------- */
 
@@ -75,11 +75,15 @@ DeformationVectorFieldTransform<TScalarType, NDimensions>::SetCoefficientVectorI
   typedef ImageRegionIterator<CoefficientImageType>            IteratorType;
 
   /** Create array of images representing the B-spline
-   * coefficients in each dimension.
+   * coefficients in each dimension. The images of a previous call are
+   * reused, Allocate() only reallocates when the size has changed.
    */
   for (unsigned int i = 0; i < SpaceDimension; ++i)
   {
-    this->m_Images[i] = CoefficientImageType::New();
+    if (this->m_Images[i].IsNull())
+    {
+      this->m_Images[i] = CoefficientImageType::New();
+    }
     this->m_Images[i]->SetRegions(vecImage->GetLargestPossibleRegion());
     this->m_Images[i]->SetOrigin(vecImage->GetOrigin());
     this->m_Images[i]->SetSpacing(vecImage->GetSpacing());
@@ -123,20 +123,25 @@ protected:
   void
   PrintSelf(std::ostream & os, Indent indent) const override;
 
-  /** MeanImageFilter can be implemented as a multithreaded filter.
-   * Therefore, this implementation provides a ThreadedGenerateData()
-   * routine which is called for each processing thread. The output
-   * image data is allocated automatically by the superclass prior to
-   * calling ThreadedGenerateData().  ThreadedGenerateData can only
-   * write to the portion of the output image specified by the
-   * parameter "outputRegionForThread"
+  /** The diffusion iterations depend on each other, so GenerateData()
+   * runs them one after the other. Each single iteration is multi-threaded
+   * over the image region, see ThreadedDiffusionIteration(). The iterations
+   * alternate between the output and a temporary image, which is kept in
+   * memory so that subsequent calls reuse its buffer.
    *
-   * \sa ImageToImageFilter::ThreadedGenerateData(),
-   *     ImageToImageFilter::GenerateData().
+   * \sa ImageToImageFilter::GenerateData().
    */
   void
   GenerateData(void) override;
 
+  /** Perform one diffusion iteration from the source to the destination image,
+   * restricted to the given region. Called for each work unit.
+   */
+  void
+  ThreadedDiffusionIteration(const InputImageType *       source,
+                             InputImageType *             destination,
+                             const InputImageRegionType & regionForThread) const;
+
 private:
   VectorMeanDiffusionImageFilter(const Self &) = delete;
   void
@@ -147,8 +152,9 @@ private:
   unsigned int  m_NumberOfIterations;
 
   /** Declare member images. */
-  GrayValueImagePointer m_GrayValueImage;
-  DoubleImagePointer    m_Cx;
+  GrayValueImagePointer            m_GrayValueImage;
+  DoubleImagePointer               m_Cx;
+  typename InputImageType::Pointer m_TemporaryImage;
 
   RescaleImageFilterPointer m_RescaleFilter;
 
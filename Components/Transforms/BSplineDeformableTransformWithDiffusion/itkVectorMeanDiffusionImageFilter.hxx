@@ -21,11 +21,10 @@
 
 #include "itkVectorMeanDiffusionImageFilter.h"
 
-#include "itkNeighborhoodIterator.h"
+#include "itkConstNeighborhoodIterator.h"
+#include "itkImageAlgorithm.h"
 #include "itkImageRegionIterator.h"
-#include "itkImageRegionConstIterator.h"
 #include "itkZeroFluxNeumannBoundaryCondition.h"
-#include "itkProgressReporter.h"
 
 namespace itk
 {
@@ -43,6 +42,7 @@ VectorMeanDiffusionImageFilter<TInputImage, TGrayValueImage>::VectorMeanDiffusio
   this->m_RescaleFilter = nullptr;
   this->m_GrayValueImage = nullptr;
   this->m_Cx = nullptr;
+  this->m_TemporaryImage = nullptr;
 
 } // end Constructor
 
@@ -110,31 +110,14 @@ template <class TInputImage, class TGrayValueImage>
 void
 VectorMeanDiffusionImageFilter<TInputImage, TGrayValueImage>::GenerateData(void)
 {
-  // \todo to avoid all the copying we can create a vector of
-  // outputs of size this->GetNumberOfIterations(). The last
-  // output should point to this->GetOutput(). In order to avoid
-  // a big memory footprint, at some iteration k, memory of the
-  // former iteration should be released: output[ k - 1 ] = 0,
-  // and memory of the current iteration should only now be created:
-  // output[ k ] = InputImageType::New(); ...; output[ k ]->Allocate().
-  // Only for the last iteration: output[ k ]( this->GetOutput() ).
-
   /** Create feature image. */
   this->FilterGrayValueImage();
 
-  /** Declare things. */
-  unsigned int                                      i, j;
-  ZeroFluxNeumannBoundaryCondition<InputImageType>  nbc;
-  ZeroFluxNeumannBoundaryCondition<DoubleImageType> nbc2;
-  NeighborhoodIterator<InputImageType>              nit;
-  NeighborhoodIterator<DoubleImageType>             nit2;
-  VectorRealType                                    sum;
-
   /** Allocate output. */
   typename InputImageType::ConstPointer input(this->GetInput());
   typename InputImageType::Pointer      output(this->GetOutput());
-  auto                                  outputtmp = InputImageType::New();
-  output->SetRegions(input->GetLargestPossibleRegion());
+  const InputImageRegionType            region = input->GetLargestPossibleRegion();
+  output->SetRegions(region);
 
   try
   {
@@ -150,152 +133,154 @@ VectorMeanDiffusionImageFilter<TInputImage, TGrayValueImage>::GenerateData(void)
     throw excp;
   }
 
-  /** Allocate a temporary output image. */
-  outputtmp->SetSpacing(input->GetSpacing());
-  outputtmp->SetOrigin(input->GetOrigin());
-  outputtmp->SetRegions(input->GetLargestPossibleRegion());
-
-  try
+  const unsigned int numberOfIterations = this->GetNumberOfIterations();
+  if (numberOfIterations == 0)
   {
-    outputtmp->Allocate();
+    ImageAlgorithm::Copy(input.GetPointer(), output.GetPointer(), region, region);
+    return;
   }
-  catch (itk::ExceptionObject & excp)
+
+  /** Allocate a temporary output image. Allocate() reuses the existing
+   * buffer when the size did not change since the previous call.
+   */
+  if (numberOfIterations > 1)
   {
-    /** Add information to the exception and throw again. */
-    excp.SetLocation("VectorMeanDiffusionImageFilter - GenerateData()");
-    std::string err_str = excp.GetDescription();
-    err_str += "\nError occurred while allocating a temporary copy.\n";
-    excp.SetDescription(err_str);
-    throw excp;
+    if (this->m_TemporaryImage.IsNull())
+    {
+      this->m_TemporaryImage = InputImageType::New();
+    }
+    this->m_TemporaryImage->SetSpacing(input->GetSpacing());
+    this->m_TemporaryImage->SetOrigin(input->GetOrigin());
+    this->m_TemporaryImage->SetRegions(region);
+
+    try
+    {
+      this->m_TemporaryImage->Allocate();
+    }
+    catch (itk::ExceptionObject & excp)
+    {
+      /** Add information to the exception and throw again. */
+      excp.SetLocation("VectorMeanDiffusionImageFilter - GenerateData()");
+      std::string err_str = excp.GetDescription();
+      err_str += "\nError occurred while allocating a temporary copy.\n";
+      excp.SetDescription(err_str);
+      throw excp;
+    }
   }
 
-  // support progress methods/callbacks
-  // ProgressReporter progress( this, threadId, outputRegionForThread.GetNumberOfPixels() );
+  /** Loop over the number of iterations. The first iteration reads the input,
+   * the others read the result of the previous iteration. The destinations
+   * alternate such that the last iteration writes into the output.
+   */
+  MultiThreaderBase * multiThreader = this->GetMultiThreader();
+  multiThreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
 
-  /** Copy input to output. */
-  ImageRegionConstIterator<InputImageType> in_it(input, input->GetLargestPossibleRegion());
-  ImageRegionIterator<InputImageType>      out_it(output, input->GetLargestPossibleRegion());
-  in_it.GoToBegin();
-  out_it.GoToBegin();
-  while (!in_it.IsAtEnd())
+  const InputImageType * source = input;
+  for (unsigned int k = 0; k < numberOfIterations; ++k)
   {
-    out_it.Set(in_it.Get());
-    ++in_it;
-    ++out_it;
-  }
+    InputImageType * destination =
+      ((numberOfIterations - 1 - k) % 2 == 0) ? output.GetPointer() : this->m_TemporaryImage.GetPointer();
+
+    multiThreader->template ParallelizeImageRegion<InputImageDimension>(
+      region,
+      [this, source, destination](const InputImageRegionType & regionForThread) {
+        this->ThreadedDiffusionIteration(source, destination, regionForThread);
+      },
+      nullptr);
 
-  /** Setup neighborhood iterator for the output deformation image. */
-  nit = NeighborhoodIterator<InputImageType>(this->m_Radius, output, output->GetLargestPossibleRegion());
-  unsigned int neighborhoodSize = nit.Size();
+    source = destination;
+
+  } // end for NumberOfIterations
+
+} // end GenerateData()
+
+
+/**
+ * ****************** ThreadedDiffusionIteration ****************
+ */
+
+template <class TInputImage, class TGrayValueImage>
+void
+VectorMeanDiffusionImageFilter<TInputImage, TGrayValueImage>::ThreadedDiffusionIteration(
+  const InputImageType *       source,
+  InputImageType *             destination,
+  const InputImageRegionType & regionForThread) const
+{
+  /** Setup neighborhood iterator for the source deformation image. */
+  ZeroFluxNeumannBoundaryCondition<InputImageType> nbc;
+  ConstNeighborhoodIterator<InputImageType>        nit(this->m_Radius, source, regionForThread);
+  const unsigned int                               neighborhoodSize = nit.Size();
   nit.OverrideBoundaryCondition(&nbc);
 
   /** Setup neighborhood iterator for the "stiffness coefficient" image. */
-  nit2 = NeighborhoodIterator<DoubleImageType>(this->m_Radius, this->m_Cx, this->m_Cx->GetLargestPossibleRegion());
+  ZeroFluxNeumannBoundaryCondition<DoubleImageType> nbc2;
+  ConstNeighborhoodIterator<DoubleImageType>        nit2(this->m_Radius, this->m_Cx, regionForThread);
   nit2.OverrideBoundaryCondition(&nbc2);
 
-  /** Setup iterator over outputtmp. */
-  ImageRegionIterator<InputImageType> oit(outputtmp, input->GetLargestPossibleRegion());
-
-  /** Initialize c and ci. */
-  double c = 0.0;
-  double ci = 0.0;
+  /** Setup iterator over the destination. */
+  ImageRegionIterator<InputImageType> oit(destination, regionForThread);
 
-  /** Loop over the number of iterations. */
-  for (unsigned int k = 0; k < this->GetNumberOfIterations(); ++k)
+  /** The actual work. */
+  VectorRealType sum;
+  while (!nit.IsAtEnd())
   {
-    /** Reset the iterators. */
-    nit.GoToBegin();
-    nit2.GoToBegin();
-    oit.GoToBegin();
-
-    /** The actual work. */
-    while (!nit.IsAtEnd())
+    /** Speed up: do not filter locations where c(x) = 0. */
+    const double c = nit2.GetCenterPixel();
+    if (c < 0.000001)
     {
-      /** Speed up: do not filter locations where c(x) = 0. */
-      if (nit2.GetCenterPixel() < 0.000001)
-      {
-        /** Just copy input to output. */
-        oit.Set(nit.GetCenterPixel());
-      }
-      else
+      /** Just copy input to output. */
+      oit.Set(nit.GetCenterPixel());
+    }
+    else
+    {
+      /** Calculate the weighted mean over the neighborhood.
+       * mean = SUM_i{ ci * x_i } / SUM_i{ ci }
+       */
+      sum.Fill(NumericTraits<double>::Zero);
+      double sumc = 0.0;
+      for (unsigned int i = 0; i < neighborhoodSize; ++i)
       {
-        /** Initialize the sum to 0. */
-        for (j = 0; j < InputImageDimension; ++j)
-        {
-          sum[j] = NumericTraits<double>::Zero;
-        }
+        /** Get current pixel in this neighborhood. */
+        const InputPixelType pix = nit.GetPixel(i);
 
-        /** Initialize sumc. */
-        double sumc = 0.0;
+        /** Get ci-value on current index. */
+        const double ci = nit2.GetPixel(i);
 
-        /** Calculate the weighted mean over the neighborhood.
-         * mean = SUthis->m_i{ ci * x_i } / SUthis->m_i{ ci }
-         */
-        for (i = 0; i < neighborhoodSize; ++i)
+        /** Calculate SUM_i{ ci } and SUM_i{ ci * x_i }. */
+        sumc += ci;
+        for (unsigned int j = 0; j < InputImageDimension; ++j)
         {
-          /** Get current pixel in this neighborhood. */
-          InputPixelType pix = nit.GetPixel(i);
-
-          /** Get ci-value on current index. */
-          ci = nit2.GetPixel(i);
-
-          /** Calculate SUthis->m_i{ ci } and SUthis->m_i{ ci * x_i }. */
-          sumc += ci;
-          for (j = 0; j < InputImageDimension; ++j)
-          {
-            sum[j] += ci * static_cast<double>(pix[j]);
-          }
+          sum[j] += ci * static_cast<double>(pix[j]);
         }
+      }
 
-        /** Get the mean value by dividing by sumc. */
-        InputPixelType mean;
-        for (j = 0; j < InputImageDimension; ++j)
+      /** Get the mean value by dividing by sumc. */
+      InputPixelType mean;
+      for (unsigned int j = 0; j < InputImageDimension; ++j)
+      {
+        if (sumc < 0.00001)
         {
-          if (sumc < 0.00001)
-          {
-            mean[j] = 0.0;
-          }
-          else
-          {
-            mean[j] = static_cast<ValueType>(sum[j] / sumc);
-          }
+          mean[j] = 0.0;
         }
+        else
+        {
+          mean[j] = static_cast<ValueType>(sum[j] / sumc);
+        }
+      }
 
-        /** Get c. */
-        c = nit2.GetCenterPixel();
-
-        /** Set 'y = (1 - c) * x + c * mean' to the temporary output. */
-        InputPixelType value = nit.GetCenterPixel() * (1.0 - c) + mean * c;
-
-        /** Set it. */
-        oit.Set(value);
-
-      } // end if c < 0.000001
-
-      /** Increase all iterators. */
-      ++nit;
-      ++nit2;
-      ++oit;
-      // progress.CompletedPixel();
+      /** Set 'y = (1 - c) * x + c * mean' to the destination. */
+      oit.Set(nit.GetCenterPixel() * (1.0 - c) + mean * c);
 
-    } // end while
+    } // end if c < 0.000001
 
-    /** Copy outputtmp to output. */
-    if (this->GetNumberOfIterations() > 0)
-    {
-      out_it.GoToBegin();
-      oit.GoToBegin();
-      while (!out_it.IsAtEnd())
-      {
-        out_it.Set(oit.Get());
-        ++out_it;
-        ++oit;
-      }
-    } // end if GetNumberOfIterations() > 0
+    /** Increase all iterators. */
+    ++nit;
+    ++nit2;
+    ++oit;
 
-  } // end for NumberOfIterations
+  } // end while
 
-} // end GenerateData()
+} // end ThreadedDiffusionIteration()
 
 
 /**
@@ -76,6 +76,11 @@ namespace elastix
  *   <em>Nonrigid registration of dynamic medical imaging data using nD+t B-splines and a
  *   groupwise optimization approach</em>, C.T. Metz, S. Klein, M. Schaap, T. van Walsum and
  *   W.J. Niessen, Medical Image Analysis, in press.
+ * \parameter UseInterleavedCoefficients: evaluate the (non-cyclic) transform on a copy of the
+ *   B-spline coefficients that stores the coefficients of each control point next to each other.
+ *   This speeds up the evaluation, at the cost of keeping the coefficients in memory twice. \n
+ *   example: <tt>(UseInterleavedCoefficients "true")</tt> \n
+ *   Default value: false.
  *
  *
  * The transform parameters necessary for transformix, additionally defined by this class, are:
@@ -296,6 +301,7 @@ private:
   /** Variables to remember order and periodicity of B-spline transform. */
   unsigned int m_SplineOrder;
   bool         m_Cyclic;
+  bool         m_UseInterleavedCoefficients{ false };
 
   /** Initialize the right B-spline transform based on the spline order and periodicity. */
   unsigned int
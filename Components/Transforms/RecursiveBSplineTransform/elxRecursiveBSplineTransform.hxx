@@ -82,6 +82,7 @@ RecursiveBSplineTransform<TElastix>::InitializeBSplineTransform(void)
     }
   }
 
+  this->m_BSplineTransform->SetUseInterleavedCoefficients(!this->m_Cyclic && this->m_UseInterleavedCoefficients);
   this->SetCurrentTransform(this->m_BSplineTransform);
   this->m_GridUpsampler = GridUpsamplerType::New();
   this->m_GridUpsampler->SetBSplineOrder(this->m_SplineOrder);
@@ -104,6 +105,9 @@ RecursiveBSplineTransform<TElastix>::BeforeAll(void)
     this->m_SplineOrder, "BSplineTransformSplineOrder", this->GetComponentLabel(), 0, 0, true);
   this->m_Cyclic = false;
   this->GetConfiguration()->ReadParameter(this->m_Cyclic, "UseCyclicTransform", this->GetComponentLabel(), 0, 0, true);
+  this->m_UseInterleavedCoefficients = false;
+  this->GetConfiguration()->ReadParameter(
+    this->m_UseInterleavedCoefficients, "UseInterleavedCoefficients", this->GetComponentLabel(), 0, 0, true);
 
   return this->InitializeBSplineTransform();
 } // end BeforeAll()
@@ -450,6 +454,9 @@ RecursiveBSplineTransform<TElastix>::ReadFromFile(void)
     m_SplineOrder, "BSplineTransformSplineOrder", this->GetComponentLabel(), 0, 0);
   m_Cyclic = false;
   this->GetConfiguration()->ReadParameter(m_Cyclic, "UseCyclicTransform", this->GetComponentLabel(), 0, 0);
+  m_UseInterleavedCoefficients = false;
+  this->GetConfiguration()->ReadParameter(
+    m_UseInterleavedCoefficients, "UseInterleavedCoefficients", this->GetComponentLabel(), 0, 0);
   InitializeBSplineTransform();
 
   /** Read and Set the Grid: this is a BSplineTransform specific task. */
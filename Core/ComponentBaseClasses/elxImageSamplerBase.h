@@ -36,6 +36,13 @@ namespace elastix
  *
  * This class contains all the common functionality for ImageSamplers.
  *
+ * The parameters used in this class are:
+ * \parameter UseMortonOrder: Whether the samples are sorted in Morton (Z-)order
+ *    of their voxel index after each update, which improves the cache locality of
+ *    the metric computation, especially for random samplers. \n
+ *    example: <tt>(UseMortonOrder "true")</tt> \n
+ *    Can be given for each resolution. The default is false.
+ *
  * \ingroup ImageSamplers
  * \ingroup ComponentBaseClasses
  */
@@ -51,6 +51,11 @@ ImageSamplerBase<TElastix>::BeforeEachResolutionBase(void)
     }
   }
 
+  /** Sort the samples spatially or not. */
+  bool useMortonOrder = false;
+  this->m_Configuration->ReadParameter(useMortonOrder, "UseMortonOrder", this->GetComponentLabel(), level, 0);
+  this->GetAsITKBaseType()->SetUseMortonOrder(useMortonOrder);
+
   /** Temporary?: Use the multi-threaded version or not. */
   std::string useMultiThread = this->m_Configuration->GetCommandLineArgument("-mts"); // mts: multi-threaded samplers
   if (useMultiThread == "true")
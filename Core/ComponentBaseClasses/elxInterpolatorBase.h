@@ -62,6 +62,7 @@ public:
   /** Other typedef's. */
   typedef typename ElastixType::MovingImageType InputImageType;
   typedef ElastixBase::CoordRepType             CoordRepType;
+  typedef ElastixBase::CoefficientType          CoefficientType;
 
   /** ITKBaseType. */
   typedef itk::InterpolateImageFunction<InputImageType, CoordRepType> ITKBaseType;
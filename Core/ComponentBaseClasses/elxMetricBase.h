@@ -23,6 +23,7 @@
 
 #include "elxBaseComponentSE.h"
 #include "itkAdvancedImageToImageMetric.h"
+#include "itkSingleValuedPointSetToPointSetMetric.h"
 #include "itkImageGridSampler.h"
 #include "itkPointSet.h"
 
@@ -63,6 +64,22 @@ namespace elastix
  *    CheckNumberOfSamples. \n
  *    example: <tt>(RequiredRatioOfValidSamples 0.1)</tt> \n
  *    The default is 0.25.
+ * \parameter MultiThreader: The multi-threader that runs the threaded computations
+ *    of the metric and of the displacement distribution estimation of the optimizers.
+ *    Choose one of {Platform, Pool, TBB}. "Platform" creates and joins the threads
+ *    in every iteration, "Pool" keeps its threads alive between iterations, which
+ *    reduces the overhead of iterations that use only few samples, and "TBB" uses a
+ *    work-stealing scheduler (only when ITK is built with TBB, otherwise "Pool" is used).
+ *    Can be given for each resolution. \n
+ *    example: <tt>(MultiThreader "Pool")</tt> \n
+ *    The default is "Platform".
+ * \parameter UseInterleavedMovingImageCache: Whether the moving image values and central
+ *    difference gradients are stored together in a single float image, so that each
+ *    sample reads them with one memory access. Only used with the NearestNeighborInterpolator,
+ *    for which the gradient is otherwise read from a separate gradient image.
+ *    Can be given for each resolution. \n
+ *    example: <tt>(UseInterleavedMovingImageCache "true")</tt> \n
+ *    The default is "false".
  *
  * \ingroup Metrics
  * \ingroup ComponentBaseClasses
@@ -125,6 +142,7 @@ public:
                                                      CoordinateRepresentationType,
                                                      CoordinateRepresentationType>>
     MovingPointSetType;
+  typedef itk::SingleValuedPointSetToPointSetMetric<FixedPointSetType, MovingPointSetType> PointSetMetricType;
 
   /** Typedefs for sampler support. */
   typedef typename AdvancedMetricType::ImageSamplerType ImageSamplerBaseType;
@@ -168,8 +168,49 @@ MetricBase<TElastix>::BeforeEachResolutionBase(void)
       }
     }
 
+    /** Which multi-threader should the metric use? */
+    std::string multiThreader = "Platform";
+    this->GetConfiguration()->ReadParameter(multiThreader, "MultiThreader", this->GetComponentLabel(), level, 0);
+    const auto threaderType = itk::MultiThreaderBase::ThreaderTypeFromString(multiThreader);
+    if (threaderType == itk::MultiThreaderBase::ThreaderEnum::Unknown)
+    {
+      itkExceptionMacro(<< "ERROR: unknown MultiThreader \"" << multiThreader
+                        << "\". Choose one of \"Platform\", \"Pool\" or \"TBB\".");
+    }
+    thisAsAdvanced->SetMultiThreaderType(threaderType);
+
+    /** Should the moving image values and gradients be cached interleaved? */
+    bool useInterleavedMovingImageCache = false;
+    this->GetConfiguration()->ReadParameter(
+      useInterleavedMovingImageCache, "UseInterleavedMovingImageCache", this->GetComponentLabel(), level, 0);
+    thisAsAdvanced->SetUseInterleavedMovingImageCache(useInterleavedMovingImageCache);
+
   } // end advanced metric
 
+  /** Cast this to PointSetMetricType. */
+  PointSetMetricType * thisAsPointSetMetric = dynamic_cast<PointSetMetricType *>(this);
+
+  /** Point set metrics may multi-thread the loop over the points. */
+  if (thisAsPointSetMetric != nullptr)
+  {
+    /** Should the metric use multi-threading? */
+    bool useMultiThreading = true;
+    this->GetConfiguration()->ReadParameter(
+      useMultiThreading, "UseMultiThreadingForMetrics", this->GetComponentLabel(), level, 0);
+
+    thisAsPointSetMetric->SetUseMultiThread(useMultiThreading);
+    if (useMultiThreading)
+    {
+      std::string tmp = this->m_Configuration->GetCommandLineArgument("-threads");
+      if (!tmp.empty())
+      {
+        const unsigned int nrOfThreads = atoi(tmp.c_str());
+        thisAsPointSetMetric->SetNumberOfWorkUnits(nrOfThreads);
+      }
+    }
+
+  } // end point set metric
+
 } // end BeforeEachResolutionBase()
 
 
@@ -20,6 +20,9 @@
 
 #include "elxRegistrationBase.h"
 
+#include <sstream>
+#include <typeinfo>
+
 namespace elastix
 {
 
@@ -116,6 +119,23 @@ RegistrationBase<TElastix>::GenerateFixedMaskSpatialObject(const FixedMaskImageT
     return fixedMaskSpatialObject;
   }
 
+  /** Use the eroded mask from the fixed preprocessing cache, if it was computed before. */
+  FixedPreprocessingCache * cache = this->GetElastix()->GetFixedPreprocessingCache();
+  std::ostringstream        cacheKey;
+  if (cache)
+  {
+    cacheKey << "ErodedFixedMask " << FixedPreprocessingCache::GetImageKey(maskImage) << ' '
+             << typeid(FixedMaskImageType).name() << "\nSchedule:\n"
+             << pyramid->GetSchedule() << "Level: " << level;
+    const auto cachedData = cache->Find(cacheKey.str());
+    if (const auto * cachedMask = dynamic_cast<const FixedMaskImageType *>(cachedData.GetPointer()))
+    {
+      fixedMaskSpatialObject->SetImage(cachedMask);
+      fixedMaskSpatialObject->Update();
+      return fixedMaskSpatialObject;
+    }
+  }
+
   /** Erode, and convert to spatial object. */
   FixedMaskErodeFilterPointer erosion = FixedMaskErodeFilterType::New();
   erosion->SetInput(maskImage);
@@ -145,6 +165,12 @@ RegistrationBase<TElastix>::GenerateFixedMaskSpatialObject(const FixedMaskImageT
   /** Release some memory. */
   erodedFixedMaskAsImage->DisconnectPipeline();
 
+  /** Store the eroded mask, for the next registration to the same fixed image. */
+  if (cache)
+  {
+    cache->Store(cacheKey.str(), erodedFixedMaskAsImage);
+  }
+
   fixedMaskSpatialObject->SetImage(erodedFixedMaskAsImage);
   fixedMaskSpatialObject->Update();
   return fixedMaskSpatialObject;
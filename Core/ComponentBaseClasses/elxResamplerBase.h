@@ -25,6 +25,9 @@
 #include "itkResampleImageFilter.h"
 #include "elxProgressCommand.h"
 
+#include <string>
+#include <vector>
+
 namespace elastix
 {
 /**
@@ -67,6 +70,23 @@ namespace elastix
  *    of the written image is desired.\n
  *    example: <tt>(CompressResultImage "true")</tt> \n
  *    The default is "false".
+ * \parameter ResultImageNumberOfSlabs: the number of slabs in which the result image
+ *    is resampled and written. With more than one slab, the result image is computed
+ *    slab by slab, and each slab is written to disk directly, so only one slab is held
+ *    in memory at a time. This requires a file format that supports streamed writing,
+ *    such as uncompressed mha or mhd; other formats are written at once. To also
+ *    halve the memory of the B-spline coefficients of the moving image, select the
+ *    FinalBSplineInterpolatorFloat resample interpolator.\n
+ *    example: <tt>(ResultImageNumberOfSlabs 16)</tt> \n
+ *    The default is 1.
+ * \parameter ResultImageIsLabelImage: for each input image of transformix,
+ *    whether it is a label image. When transformix is given more than one input
+ *    image (-in0, -in1, ...), they are resampled together, evaluating the transform
+ *    only once per voxel. Label images are then interpolated with nearest neighbor
+ *    interpolation, the other images with the ResampleInterpolator, like a single
+ *    input image. The RayCastResampleInterpolator is not supported then.\n
+ *    example: <tt>(ResultImageIsLabelImage "false" "true" "true")</tt> \n
+ *    The default is "false" for each image.
  *
  * \ingroup Resamplers
  * \ingroup ComponentBaseClasses
@@ -104,6 +124,7 @@ public:
   /** Typedef's from ResampleImageFiler. */
   typedef typename ITKBaseType::TransformType    TransformType;
   typedef typename ITKBaseType::InterpolatorType InterpolatorType;
+  typedef typename InterpolatorType::Pointer     InterpolatorPointer;
   typedef typename ITKBaseType::SizeType         SizeType;
   typedef typename ITKBaseType::IndexType        IndexType;
   typedef typename ITKBaseType::SpacingType      SpacingType;
@@ -188,6 +209,12 @@ public:
   virtual void
   ResampleAndWriteResultImage(const char * filename, const bool & showProgress = true);
 
+  /** Function to resample all input images in a single pass, and write the
+   * result images to the given files, one for each input image.
+   */
+  virtual void
+  ResampleAndWriteResultImages(const std::vector<std::string> & filenames, const bool & showProgress = true);
+
   /** Function to write the result output image to a file. */
   virtual void
   WriteResultImage(OutputImageType * imageimage, const char * filename, const bool & showProgress = true);
@@ -206,6 +233,10 @@ protected:
   virtual void
   SetComponents(void);
 
+  /** Creates a new instance of the ResampleInterpolator, with the same settings. */
+  InterpolatorPointer
+  CreateResultImageInterpolator(void) const;
+
   /** Variable that defines to print the progress or not. */
   bool m_ShowProgress;
 
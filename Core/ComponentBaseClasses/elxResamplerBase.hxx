@@ -24,6 +24,10 @@
 #include "itkImageFileCastWriter.h"
 #include "itkChangeInformationImageFilter.h"
 #include "itkAdvancedRayCastInterpolateImageFunction.h"
+#include "itkMultiImageResampleImageFilter.h"
+#include "itkBSplineInterpolateImageFunction.h"
+#include "itkReducedDimensionBSplineInterpolateImageFunction.h"
+#include "itkNearestNeighborInterpolateImageFunction.h"
 #include "itkTimeProbe.h"
 
 namespace elastix
@@ -308,17 +312,118 @@ ResamplerBase<TElastix>::ResampleAndWriteResultImage(const char * filename, cons
     progressObserver->SetEndString("%");
   }
 
-  /** Do the resampling. */
+  /** Read the number of slabs in which the result image is resampled and written. */
+  unsigned int numberOfSlabs = 1;
+  this->m_Configuration->ReadParameter(numberOfSlabs, "ResultImageNumberOfSlabs", 0, false);
+
+  /** Do the resampling. When the result image is streamed, the writer
+   * drives the resampling instead, slab by slab.
+   */
+  if (numberOfSlabs <= 1)
+  {
+    try
+    {
+      this->GetAsITKBaseType()->Update();
+    }
+    catch (itk::ExceptionObject & excp)
+    {
+      /** Add information to the exception. */
+      excp.SetLocation("ResamplerBase - WriteResultImage()");
+      std::string err_str = excp.GetDescription();
+      err_str += "\nError occurred while resampling the image.\n";
+      excp.SetDescription(err_str);
+
+      /** Pass the exception to an higher level. */
+      throw excp;
+    }
+  }
+
+  /** Perform the writing. */
+  this->WriteResultImage(this->GetAsITKBaseType()->GetOutput(), filename, showProgress);
+
+  /** Disconnect from the resampler. */
+  if (showProgress && (progressObserver != nullptr))
+  {
+    progressObserver->DisconnectObserver(this->GetAsITKBaseType());
+  }
+
+} // end ResampleAndWriteResultImage()
+
+
+/**
+ * ******************* ResampleAndWriteResultImages ********************
+ *
+ * Resamples all input images with a single evaluation of the transform
+ * per voxel, and writes them like ResampleAndWriteResultImage() does.
+ */
+
+template <class TElastix>
+void
+ResamplerBase<TElastix>::ResampleAndWriteResultImages(const std::vector<std::string> & filenames,
+                                                      const bool &                     showProgress)
+{
+  /** Typedef's. */
+  typedef itk::MultiImageResampleImageFilter<InputImageType, OutputImageType, CoordRepType> MultiImageResamplerType;
+  typedef itk::NearestNeighborInterpolateImageFunction<InputImageType, CoordRepType>
+    NearestNeighborInterpolatorType;
+
+  const unsigned int numberOfImages = filenames.size();
+  if (numberOfImages > this->m_Elastix->GetNumberOfMovingImages())
+  {
+    itkExceptionMacro(<< "ERROR: " << numberOfImages << " result images are requested, but only "
+                      << this->m_Elastix->GetNumberOfMovingImages() << " input images are given.");
+  }
+
+  /** Create the resampler, with the transform and output grid of this resampler. */
+  const ITKBaseType * resampler = this->GetAsITKBaseType();
+  const auto          multiImageResampler = MultiImageResamplerType::New();
+  multiImageResampler->SetNumberOfImages(numberOfImages);
+  multiImageResampler->SetTransform(resampler->GetTransform());
+  multiImageResampler->SetSize(resampler->GetSize());
+  multiImageResampler->SetOutputStartIndex(resampler->GetOutputStartIndex());
+  multiImageResampler->SetOutputSpacing(resampler->GetOutputSpacing());
+  multiImageResampler->SetOutputOrigin(resampler->GetOutputOrigin());
+  multiImageResampler->SetOutputDirection(resampler->GetOutputDirection());
+  multiImageResampler->SetDefaultPixelValue(resampler->GetDefaultPixelValue());
+
+  /** Set the input images, with nearest neighbor interpolation for the label images. */
+  for (unsigned int i = 0; i < numberOfImages; ++i)
+  {
+    bool isLabelImage = false;
+    this->m_Configuration->ReadParameter(isLabelImage, "ResultImageIsLabelImage", i, false);
+
+    multiImageResampler->SetInput(i, this->m_Elastix->GetMovingImage(i));
+    if (isLabelImage)
+    {
+      multiImageResampler->SetInterpolator(i, NearestNeighborInterpolatorType::New());
+      elxout << "  Input image " << i << " is a label image, resampled with nearest neighbor interpolation."
+             << std::endl;
+    }
+    else
+    {
+      const auto interpolator = this->CreateResultImageInterpolator();
+      multiImageResampler->SetInterpolator(i, interpolator);
+      elxout << "  Input image " << i << " is resampled with the " << interpolator->GetNameOfClass() << "."
+             << std::endl;
+    }
+  }
+
+  /** Add a progress observer to the resampler. */
+  const auto progressObserver =
+    (showProgress && !BaseComponent::IsElastixLibrary()) ? ProgressCommandType::CreateAndConnect(*multiImageResampler)
+                                                         : nullptr;
+
+  /** Do the resampling of all images at once. */
   try
   {
-    this->GetAsITKBaseType()->Update();
+    multiImageResampler->Update();
   }
   catch (itk::ExceptionObject & excp)
   {
     /** Add information to the exception. */
-    excp.SetLocation("ResamplerBase - WriteResultImage()");
+    excp.SetLocation("ResamplerBase - ResampleAndWriteResultImages()");
     std::string err_str = excp.GetDescription();
-    err_str += "\nError occurred while resampling the image.\n";
+    err_str += "\nError occurred while resampling the images.\n";
     excp.SetDescription(err_str);
 
     /** Pass the exception to an higher level. */
@@ -326,15 +431,70 @@ ResamplerBase<TElastix>::ResampleAndWriteResultImage(const char * filename, cons
   }
 
   /** Perform the writing. */
-  this->WriteResultImage(this->GetAsITKBaseType()->GetOutput(), filename, showProgress);
+  for (unsigned int i = 0; i < numberOfImages; ++i)
+  {
+    this->WriteResultImage(multiImageResampler->GetOutput(i), filenames[i].c_str(), showProgress);
+  }
 
-  /** Disconnect from the resampler. */
-  if (showProgress && (progressObserver != nullptr))
+} // end ResampleAndWriteResultImages()
+
+
+/**
+ * ******************* CreateResultImageInterpolator ********************
+ *
+ * Creates a new instance of the ResampleInterpolator of this resampler, with
+ * the same settings, so that each input image gets its own interpolator.
+ */
+
+template <class TElastix>
+typename ResamplerBase<TElastix>::InterpolatorPointer
+ResamplerBase<TElastix>::CreateResultImageInterpolator(void) const
+{
+  /** Typedef's of the interpolators that have settings of their own. */
+  typedef itk::BSplineInterpolateImageFunction<InputImageType, CoordRepType, double>                BSplineType;
+  typedef itk::BSplineInterpolateImageFunction<InputImageType, CoordRepType, float>                 BSplineFloatType;
+  typedef itk::ReducedDimensionBSplineInterpolateImageFunction<InputImageType, CoordRepType, double> RDBSplineType;
+  typedef itk::AdvancedRayCastInterpolateImageFunction<InputImageType, CoordRepType>                RayCastType;
+
+  const InterpolatorType * configuredInterpolator = this->GetAsITKBaseType()->GetInterpolator();
+  if (configuredInterpolator == nullptr)
   {
-    progressObserver->DisconnectObserver(this->GetAsITKBaseType());
+    itkExceptionMacro(<< "ERROR: No ResampleInterpolator is set.");
   }
 
-} // end ResampleAndWriteResultImage()
+  /** The ray cast interpolator projects along the rays of its own transform,
+   * which the resampler of multiple images does not support.
+   */
+  if (dynamic_cast<const RayCastType *>(configuredInterpolator) != nullptr)
+  {
+    itkExceptionMacro(<< "ERROR: The " << configuredInterpolator->GetNameOfClass()
+                      << " does not support resampling multiple input images.");
+  }
+
+  const itk::LightObject::Pointer anotherObject = configuredInterpolator->CreateAnother();
+  const InterpolatorPointer       interpolator = dynamic_cast<InterpolatorType *>(anotherObject.GetPointer());
+  if (interpolator.IsNull())
+  {
+    itkExceptionMacro(<< "ERROR: Could not create another " << configuredInterpolator->GetNameOfClass() << ".");
+  }
+
+  /** Copy the spline order, the only setting of the B-spline interpolators. */
+  if (const auto configuredBSpline = dynamic_cast<const BSplineType *>(configuredInterpolator))
+  {
+    dynamic_cast<BSplineType &>(*interpolator).SetSplineOrder(configuredBSpline->GetSplineOrder());
+  }
+  else if (const auto configuredBSpline = dynamic_cast<const BSplineFloatType *>(configuredInterpolator))
+  {
+    dynamic_cast<BSplineFloatType &>(*interpolator).SetSplineOrder(configuredBSpline->GetSplineOrder());
+  }
+  else if (const auto configuredBSpline = dynamic_cast<const RDBSplineType *>(configuredInterpolator))
+  {
+    dynamic_cast<RDBSplineType &>(*interpolator).SetSplineOrder(configuredBSpline->GetSplineOrder());
+  }
+
+  return interpolator;
+
+} // end CreateResultImageInterpolator()
 
 
 /**
@@ -371,6 +531,12 @@ ResamplerBase<TElastix>::WriteResultImage(OutputImageType * image, const char *
   bool doCompression = false;
   this->m_Configuration->ReadParameter(doCompression, "CompressResultImage", 0, false);
 
+  /** Read the number of slabs in which the image is written. The writer
+   * falls back to a single slab for formats that cannot be streamed.
+   */
+  unsigned int numberOfSlabs = 1;
+  this->m_Configuration->ReadParameter(numberOfSlabs, "ResultImageNumberOfSlabs", 0, false);
+
   /** Typedef's for writing the output image. */
   typedef itk::ImageFileCastWriter<OutputImageType>          WriterType;
   typedef typename WriterType::Pointer                       WriterPointer;
@@ -395,6 +561,7 @@ ResamplerBase<TElastix>::WriteResultImage(OutputImageType * image, const char *
   writer->SetFileName(filename);
   writer->SetOutputComponentType(resultImagePixelType.c_str());
   writer->SetUseCompression(doCompression);
+  writer->SetNumberOfStreamDivisions(numberOfSlabs);
 
   /** Do the writing. */
   if (showProgress)
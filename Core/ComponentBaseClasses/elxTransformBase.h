@@ -183,6 +183,11 @@ public:
   typedef itk::Vector<float, FixedImageDimension>          VectorPixelType;
   typedef itk::Image<VectorPixelType, FixedImageDimension> DeformationFieldImageType;
 
+  /** Typedef's for ComputeDeterminantOfSpatialJacobian and ComputeSpatialJacobian. */
+  typedef itk::Image<float, FixedImageDimension>                        DeterminantOfSpatialJacobianImageType;
+  typedef itk::Matrix<float, MovingImageDimension, FixedImageDimension> SpatialJacobianPixelType;
+  typedef itk::Image<SpatialJacobianPixelType, FixedImageDimension>     SpatialJacobianImageType;
+
   /** Typedefs needed for AutomaticScalesEstimation function */
   typedef typename RegistrationType::ITKBaseType      ITKRegistrationType;
   typedef typename ITKRegistrationType::OptimizerType OptimizerType;
@@ -254,6 +259,19 @@ public:
   void
   ComputeSpatialJacobian(void) const;
 
+  /** Function to compute the displacement field of the inverse transform. */
+  void
+  ComputeInverseDeformationField(void) const;
+
+  /** Function to compute the deformation field, the determinant of the spatial
+   * Jacobian and the spatial Jacobian in a single pass over the voxels, when
+   * more than one of them is requested. When it succeeds, TransformPoints(),
+   * ComputeDeterminantOfSpatialJacobian() and ComputeSpatialJacobian() skip
+   * these outputs; otherwise they compute them separately.
+   */
+  void
+  ComputeSinglePassOutputs(void) const;
+
   /** Makes sure that the final parameters from the registration components
    * are copied, set, and stored.
    */
@@ -350,6 +368,20 @@ private:
   void
   TransformPointsAllPoints(void) const;
 
+  void
+  WriteDeterminantOfSpatialJacobianImage(const DeterminantOfSpatialJacobianImageType * image) const;
+
+  void
+  WriteSpatialJacobianImage(const SpatialJacobianImageType * image) const;
+
+  /** Reads which of "-def all", "-jac all" and "-jacmat all" are given. */
+  void
+  GetRequestedAllPointsOutputs(bool & deformationField, bool & determinant, bool & spatialJacobian) const;
+
+  /** Returns true when more than one of the outputs of ComputeSinglePassOutputs is requested. */
+  bool
+  UseSinglePassOutputs(void) const;
+
   std::string
   GetInitialTransformParametersFileName(void) const
   {
@@ -377,6 +409,9 @@ private:
 
   /** Boolean to decide whether or not the transform parameters are written. */
   bool m_ReadWriteTransformParameters{ true };
+
+  /** Whether ComputeSinglePassOutputs() has successfully computed the requested outputs. */
+  mutable bool m_SinglePassOutputsComputed{ false };
 };
 
 } // end namespace elastix
@@ -32,6 +32,8 @@
 #include "itkTransformToDisplacementFieldFilter.h"
 #include "itkTransformToDeterminantOfSpatialJacobianSource.h"
 #include "itkTransformToSpatialJacobianSource.h"
+#include "itkTransformToDisplacementFieldAndSpatialJacobianSource.h"
+#include "itkTransformToInverseDisplacementFieldSource.h"
 #include "itkImageFileWriter.h"
 #include "itkImageGridSampler.h"
 #include "itkContinuousIndex.h"
@@ -136,6 +138,17 @@ TransformBase<TElastix>::BeforeAllTransformix(void)
     elxout << "-jacmat   " << check << std::endl;
   }
 
+  /** Check for appearance of "-inv". */
+  check = this->m_Configuration->GetCommandLineArgument("-inv");
+  if (check.empty())
+  {
+    elxout << "-inv      unspecified, so no inverse deformation field computed" << std::endl;
+  }
+  else
+  {
+    elxout << "-inv      " << check << std::endl;
+  }
+
   /** Return a value. */
   return returndummy;
 
@@ -635,6 +648,10 @@ TransformBase<TElastix>::TransformPoints(void) const
       this->TransformPointsSomePoints(def);
     }
   }
+  else if (def == "all" && this->m_SinglePassOutputsComputed)
+  {
+    elxout << "  The deformation field is computed in a single pass, together with the spatial Jacobian." << std::endl;
+  }
   else if (def == "all")
   {
     elxout << "  The transform is evaluated on all points. The result is a deformation field." << std::endl;
@@ -1105,11 +1122,15 @@ TransformBase<TElastix>::ComputeDeterminantOfSpatialJacobian(void) const
            << "    Therefore det(dT/dx) is not computed." << std::endl;
     return;
   }
+  else if (this->m_SinglePassOutputsComputed)
+  {
+    elxout << "  det(dT/dx) is computed in a single pass, together with the deformation field or dT/dx." << std::endl;
+    return;
+  }
 
   /** Typedef's. */
-  typedef itk::Image<float, FixedImageDimension>                                              JacobianImageType;
+  typedef DeterminantOfSpatialJacobianImageType                                               JacobianImageType;
   typedef itk::TransformToDeterminantOfSpatialJacobianSource<JacobianImageType, CoordRepType> JacobianGeneratorType;
-  typedef itk::ImageFileWriter<JacobianImageType>                                             JacobianWriterType;
   typedef itk::ChangeInformationImageFilter<JacobianImageType>                                ChangeInfoFilterType;
   typedef typename FixedImageType::DirectionType                                              FixedImageDirectionType;
 
@@ -1138,6 +1159,25 @@ TransformBase<TElastix>::ComputeDeterminantOfSpatialJacobian(void) const
   /** Track the progress of the generation of the deformation field. */
   const auto progressObserver =
     BaseComponent::IsElastixLibrary() ? nullptr : ProgressCommandType::CreateAndConnect(*jacGenerator);
+
+  /** Write outputImage to disk, which computes it. */
+  elxout << "  Computing and writing the spatial Jacobian determinant..." << std::endl;
+  this->WriteDeterminantOfSpatialJacobianImage(infoChanger->GetOutput());
+
+} // end ComputeDeterminantOfSpatialJacobian()
+
+
+/**
+ * ************** WriteDeterminantOfSpatialJacobianImage **********************
+ */
+
+template <class TElastix>
+void
+TransformBase<TElastix>::WriteDeterminantOfSpatialJacobianImage(
+  const DeterminantOfSpatialJacobianImageType * image) const
+{
+  typedef itk::ImageFileWriter<DeterminantOfSpatialJacobianImageType> JacobianWriterType;
+
   /** Create a name for the deformation field file. */
   std::string resultImageFormat = "mhd";
   this->m_Configuration->ReadParameter(resultImageFormat, "ResultImageFormat", 0, false);
@@ -1146,11 +1186,10 @@ TransformBase<TElastix>::ComputeDeterminantOfSpatialJacobian(void) const
 
   /** Write outputImage to disk. */
   const auto jacWriter = JacobianWriterType::New();
-  jacWriter->SetInput(infoChanger->GetOutput());
+  jacWriter->SetInput(image);
   jacWriter->SetFileName(makeFileName.str().c_str());
 
   /** Do the writing. */
-  elxout << "  Computing and writing the spatial Jacobian determinant..." << std::endl;
   try
   {
     jacWriter->Update();
@@ -1158,7 +1197,7 @@ TransformBase<TElastix>::ComputeDeterminantOfSpatialJacobian(void) const
   catch (itk::ExceptionObject & excp)
   {
     /** Add information to the exception. */
-    excp.SetLocation("TransformBase - ComputeDeterminantOfSpatialJacobian()");
+    excp.SetLocation("TransformBase - WriteDeterminantOfSpatialJacobianImage()");
     std::string err_str = excp.GetDescription();
     err_str += "\nError occurred while writing spatial Jacobian determinant image.\n";
     excp.SetDescription(err_str);
@@ -1167,7 +1206,7 @@ TransformBase<TElastix>::ComputeDeterminantOfSpatialJacobian(void) const
     throw excp;
   }
 
-} // end ComputeDeterminantOfSpatialJacobian()
+} // end WriteDeterminantOfSpatialJacobianImage()
 
 
 /**
@@ -1187,14 +1226,15 @@ TransformBase<TElastix>::ComputeSpatialJacobian(void) const
     elxout << "  The command-line option \"-jacmat\" is not used, so no dT/dx computed." << std::endl;
     return;
   }
+  else if (this->m_SinglePassOutputsComputed)
+  {
+    elxout << "  dT/dx is computed in a single pass, together with the deformation field or det(dT/dx)." << std::endl;
+    return;
+  }
 
   /** Typedef's. */
-  typedef float SpatialJacobianComponentType;
-  typedef itk::Matrix<SpatialJacobianComponentType, MovingImageDimension, FixedImageDimension>
-                                                                                 OutputSpatialJacobianType;
-  typedef itk::Image<OutputSpatialJacobianType, FixedImageDimension>             JacobianImageType;
+  typedef SpatialJacobianImageType                                               JacobianImageType;
   typedef itk::TransformToSpatialJacobianSource<JacobianImageType, CoordRepType> JacobianGeneratorType;
-  typedef itk::ImageFileWriter<JacobianImageType>                                JacobianWriterType;
   typedef itk::ChangeInformationImageFilter<JacobianImageType>                   ChangeInfoFilterType;
   typedef typename FixedImageType::DirectionType                                 FixedImageDirectionType;
 
@@ -1223,6 +1263,24 @@ TransformBase<TElastix>::ComputeSpatialJacobian(void) const
 
   const auto progressObserver =
     BaseComponent::IsElastixLibrary() ? nullptr : ProgressCommandType::CreateAndConnect(*jacGenerator);
+
+  /** Write outputImage to disk, which computes it. */
+  elxout << "  Computing and writing the spatial Jacobian..." << std::endl;
+  this->WriteSpatialJacobianImage(infoChanger->GetOutput());
+
+} // end ComputeSpatialJacobian()
+
+
+/**
+ * ************** WriteSpatialJacobianImage **********************
+ */
+
+template <class TElastix>
+void
+TransformBase<TElastix>::WriteSpatialJacobianImage(const SpatialJacobianImageType * image) const
+{
+  typedef itk::ImageFileWriter<SpatialJacobianImageType> JacobianWriterType;
+
   /** Create a name for the deformation field file. */
   std::string resultImageFormat = "mhd";
   this->m_Configuration->ReadParameter(resultImageFormat, "ResultImageFormat", 0, false);
@@ -1231,7 +1289,7 @@ TransformBase<TElastix>::ComputeSpatialJacobian(void) const
 
   /** Write outputImage to disk. */
   const auto jacWriter = JacobianWriterType::New();
-  jacWriter->SetInput(infoChanger->GetOutput());
+  jacWriter->SetInput(image);
   jacWriter->SetFileName(makeFileName.str().c_str());
 
   // This class is used for writing the fullSpatialJacobian image. It is a hack to ensure that a matrix image is seen as
@@ -1279,7 +1337,6 @@ TransformBase<TElastix>::ComputeSpatialJacobian(void) const
   }
 
   /** Do the writing. */
-  elxout << "  Computing and writing the spatial Jacobian..." << std::endl;
   try
   {
     jacWriter->Update();
@@ -1287,7 +1344,7 @@ TransformBase<TElastix>::ComputeSpatialJacobian(void) const
   catch (itk::ExceptionObject & excp)
   {
     /** Add information to the exception. */
-    excp.SetLocation("TransformBase - ComputeSpatialJacobian()");
+    excp.SetLocation("TransformBase - WriteSpatialJacobianImage()");
     std::string err_str = excp.GetDescription();
     err_str += "\nError occurred while writing spatial Jacobian image.\n";
     excp.SetDescription(err_str);
@@ -1296,7 +1353,291 @@ TransformBase<TElastix>::ComputeSpatialJacobian(void) const
     throw excp;
   }
 
-} // end ComputeSpatialJacobian()
+} // end WriteSpatialJacobianImage()
+
+
+/**
+ * ************** GetRequestedAllPointsOutputs **********************
+ */
+
+template <class TElastix>
+void
+TransformBase<TElastix>::GetRequestedAllPointsOutputs(bool & deformationField,
+                                                      bool & determinant,
+                                                      bool & spatialJacobian) const
+{
+  /** For backwards compatibility "-ipp" is used when "-def" is not given. */
+  std::string def = this->GetConfiguration()->GetCommandLineArgument("-def");
+  if (def.empty())
+  {
+    def = this->GetConfiguration()->GetCommandLineArgument("-ipp");
+  }
+
+  deformationField = (def == "all");
+  determinant = (this->GetConfiguration()->GetCommandLineArgument("-jac") == "all");
+  spatialJacobian = (this->GetConfiguration()->GetCommandLineArgument("-jacmat") == "all");
+
+} // end GetRequestedAllPointsOutputs()
+
+
+/**
+ * ************** UseSinglePassOutputs **********************
+ */
+
+template <class TElastix>
+bool
+TransformBase<TElastix>::UseSinglePassOutputs(void) const
+{
+  bool deformationField = false;
+  bool determinant = false;
+  bool spatialJacobian = false;
+  this->GetRequestedAllPointsOutputs(deformationField, determinant, spatialJacobian);
+
+  return (deformationField + determinant + spatialJacobian) > 1;
+
+} // end UseSinglePassOutputs()
+
+
+/**
+ * ************** ComputeSinglePassOutputs **********************
+ *
+ * This function computes the deformation field, det(dT/dx) and dT/dx,
+ * as far as requested, while evaluating the transform and its spatial
+ * Jacobian only once per voxel.
+ */
+
+template <class TElastix>
+void
+TransformBase<TElastix>::ComputeSinglePassOutputs(void) const
+{
+  bool generateDeformationField = false;
+  bool generateDeterminant = false;
+  bool generateSpatialJacobian = false;
+  this->GetRequestedAllPointsOutputs(generateDeformationField, generateDeterminant, generateSpatialJacobian);
+  this->m_SinglePassOutputsComputed = false;
+  if (!this->UseSinglePassOutputs())
+  {
+    elxout << "  Not more than one of \"-def all\", \"-jac all\" and \"-jacmat all\" is given,\n"
+           << "    so no outputs are computed in a single pass." << std::endl;
+    return;
+  }
+
+  /** Typedef's. */
+  typedef itk::TransformToDisplacementFieldAndSpatialJacobianSource<DeformationFieldImageType,
+                                                                    DeterminantOfSpatialJacobianImageType,
+                                                                    SpatialJacobianImageType,
+                                                                    CoordRepType>
+                                                                                   GeneratorType;
+  typedef itk::ChangeInformationImageFilter<DeformationFieldImageType>             DeformationFieldChangeInfoFilterType;
+  typedef itk::ChangeInformationImageFilter<DeterminantOfSpatialJacobianImageType> DeterminantChangeInfoFilterType;
+  typedef itk::ChangeInformationImageFilter<SpatialJacobianImageType>              SpatialJacobianChangeInfoFilterType;
+  typedef typename FixedImageType::DirectionType                                   FixedImageDirectionType;
+
+  /** Create an setup the generator of all outputs. */
+  const auto generator = GeneratorType::New();
+  generator->SetTransform(const_cast<const ITKBaseType *>(this->GetAsITKBaseType()));
+  generator->SetOutputSize(this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetSize());
+  generator->SetOutputSpacing(this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetOutputSpacing());
+  generator->SetOutputOrigin(this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetOutputOrigin());
+  generator->SetOutputIndex(this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetOutputStartIndex());
+  generator->SetOutputDirection(this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetOutputDirection());
+  generator->SetGenerateDisplacementField(generateDeformationField);
+  generator->SetGenerateDeterminantOfSpatialJacobian(generateDeterminant);
+  generator->SetGenerateSpatialJacobian(generateSpatialJacobian);
+
+  /** Possibly change direction cosines to their original value, as specified
+   * in the tp-file, or by the fixed image. This is only necessary when
+   * the UseDirectionCosines flag was set to false.
+   */
+  FixedImageDirectionType originalDirection;
+  const bool              retdc = this->GetElastix()->GetOriginalFixedImageDirection(originalDirection);
+  const bool              changeDirection = retdc & !this->GetElastix()->GetUseDirectionCosines();
+
+  const auto defInfoChanger = DeformationFieldChangeInfoFilterType::New();
+  defInfoChanger->SetOutputDirection(originalDirection);
+  defInfoChanger->SetChangeDirection(changeDirection);
+  defInfoChanger->SetInput(generator->GetDisplacementFieldOutput());
+
+  const auto jacInfoChanger = DeterminantChangeInfoFilterType::New();
+  jacInfoChanger->SetOutputDirection(originalDirection);
+  jacInfoChanger->SetChangeDirection(changeDirection);
+  jacInfoChanger->SetInput(generator->GetDeterminantOfSpatialJacobianOutput());
+
+  const auto jacmatInfoChanger = SpatialJacobianChangeInfoFilterType::New();
+  jacmatInfoChanger->SetOutputDirection(originalDirection);
+  jacmatInfoChanger->SetChangeDirection(changeDirection);
+  jacmatInfoChanger->SetInput(generator->GetSpatialJacobianOutput());
+
+  /** Track the progress of the generation of the outputs. */
+  const auto progressObserver =
+    BaseComponent::IsElastixLibrary() ? nullptr : ProgressCommandType::CreateAndConnect(*generator);
+
+  /** Compute all requested outputs at once. */
+  elxout << "  Computing the requested outputs in a single pass ..." << std::endl;
+  try
+  {
+    generator->Update();
+    if (generateDeformationField)
+    {
+      defInfoChanger->Update();
+    }
+    if (generateDeterminant)
+    {
+      jacInfoChanger->Update();
+    }
+    if (generateSpatialJacobian)
+    {
+      jacmatInfoChanger->Update();
+    }
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    /** Add information to the exception. */
+    excp.SetLocation("TransformBase - ComputeSinglePassOutputs()");
+    std::string err_str = excp.GetDescription();
+    err_str += "\nError occurred while generating the deformation field and spatial Jacobian images.\n";
+    excp.SetDescription(err_str);
+
+    /** Pass the exception to an higher level. */
+    throw excp;
+  }
+
+  /** Store and write the outputs, like TransformPointsAllPoints(),
+   * ComputeDeterminantOfSpatialJacobian() and ComputeSpatialJacobian() do.
+   */
+  if (generateDeformationField)
+  {
+    typename DeformationFieldImageType::Pointer deformationfield = defInfoChanger->GetOutput();
+    this->m_Elastix->SetResultDeformationField(deformationfield.GetPointer());
+
+    if (!BaseComponent::IsElastixLibrary())
+    {
+      this->WriteDeformationFieldImage(deformationfield);
+    }
+  }
+  if (generateDeterminant)
+  {
+    elxout << "  Writing the spatial Jacobian determinant..." << std::endl;
+    this->WriteDeterminantOfSpatialJacobianImage(jacInfoChanger->GetOutput());
+  }
+  if (generateSpatialJacobian)
+  {
+    elxout << "  Writing the spatial Jacobian..." << std::endl;
+    this->WriteSpatialJacobianImage(jacmatInfoChanger->GetOutput());
+  }
+
+  /** Only now the separate passes can be skipped. When an exception is thrown
+   * above, they compute the requested outputs instead.
+   */
+  this->m_SinglePassOutputsComputed = true;
+
+} // end ComputeSinglePassOutputs()
+
+
+/**
+ * ************** ComputeInverseDeformationField **********************
+ */
+
+template <class TElastix>
+void
+TransformBase<TElastix>::ComputeInverseDeformationField(void) const
+{
+  /** If the optional command "-inv" is given in the command line arguments,
+   * then and only then we continue.
+   */
+  std::string inv = this->GetConfiguration()->GetCommandLineArgument("-inv");
+  if (inv != "all")
+  {
+    elxout << "  The command-line option \"-inv\" is not used, so no inverse deformation field computed." << std::endl;
+    return;
+  }
+
+  /** Typedef's. */
+  typedef itk::TransformToInverseDisplacementFieldSource<DeformationFieldImageType, CoordRepType> InverseGeneratorType;
+  typedef itk::ImageFileWriter<DeformationFieldImageType>                                         InverseWriterType;
+  typedef itk::ChangeInformationImageFilter<DeformationFieldImageType>                            ChangeInfoFilterType;
+
+  typedef typename FixedImageType::DirectionType FixedImageDirectionType;
+
+  /** Read the settings of the inversion from the transform parameter file. */
+  double       tolerance = 0.01;
+  unsigned int maximumNumberOfIterations = 20;
+  unsigned int coarseGridSpacing = 4;
+  this->m_Configuration->ReadParameter(tolerance, "InverseDeformationFieldTolerance", 0, false);
+  this->m_Configuration->ReadParameter(
+    maximumNumberOfIterations, "InverseDeformationFieldMaximumNumberOfIterations", 0, false);
+  this->m_Configuration->ReadParameter(coarseGridSpacing, "InverseDeformationFieldCoarseGridSpacing", 0, false);
+
+  /** Create an setup inverse generator. The inverse displacements are
+   * computed on the grid of the output image, which is the fixed image grid.
+   */
+  const auto invGenerator = InverseGeneratorType::New();
+  invGenerator->SetTransform(const_cast<const ITKBaseType *>(this->GetAsITKBaseType()));
+  invGenerator->SetOutputSize(this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetSize());
+  invGenerator->SetOutputSpacing(this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetOutputSpacing());
+  invGenerator->SetOutputOrigin(this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetOutputOrigin());
+  invGenerator->SetOutputIndex(this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetOutputStartIndex());
+  invGenerator->SetOutputDirection(this->m_Elastix->GetElxResamplerBase()->GetAsITKBaseType()->GetOutputDirection());
+  invGenerator->SetTolerance(tolerance);
+  invGenerator->SetMaximumNumberOfIterations(maximumNumberOfIterations);
+  invGenerator->SetCoarseGridSpacing(coarseGridSpacing);
+
+  /** Possibly change direction cosines to their original value, as specified
+   * in the tp-file, or by the fixed image. This is only necessary when
+   * the UseDirectionCosines flag was set to false.
+   */
+  const auto              infoChanger = ChangeInfoFilterType::New();
+  FixedImageDirectionType originalDirection;
+  bool                    retdc = this->GetElastix()->GetOriginalFixedImageDirection(originalDirection);
+  infoChanger->SetOutputDirection(originalDirection);
+  infoChanger->SetChangeDirection(retdc & !this->GetElastix()->GetUseDirectionCosines());
+  infoChanger->SetInput(invGenerator->GetOutput());
+
+  const auto progressObserver =
+    BaseComponent::IsElastixLibrary() ? nullptr : ProgressCommandType::CreateAndConnect(*invGenerator);
+  /** Create a name for the inverse deformation field file. */
+  std::string resultImageFormat = "mhd";
+  this->m_Configuration->ReadParameter(resultImageFormat, "ResultImageFormat", 0, false);
+  std::ostringstream makeFileName("");
+  makeFileName << this->m_Configuration->GetCommandLineArgument("-out") << "inverseDeformationField."
+               << resultImageFormat;
+
+  /** Write outputImage to disk. */
+  const auto invWriter = InverseWriterType::New();
+  invWriter->SetInput(infoChanger->GetOutput());
+  invWriter->SetFileName(makeFileName.str().c_str());
+
+  /** Do the writing. */
+  elxout << "  Computing and writing the inverse deformation field..." << std::endl;
+  try
+  {
+    invWriter->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    /** Add information to the exception. */
+    excp.SetLocation("TransformBase - ComputeInverseDeformationField()");
+    std::string err_str = excp.GetDescription();
+    err_str += "\nError occurred while writing inverse deformation field image.\n";
+    excp.SetDescription(err_str);
+
+    /** Pass the exception to an higher level. */
+    throw excp;
+  }
+
+  /** Report the accuracy of the inversion. */
+  elxout << "  Inverse residual |T(x) - y|: mean " << invGenerator->GetMeanResidual() << ", maximum "
+         << invGenerator->GetMaximumResidual() << "\n"
+         << "  Mean number of iterations: " << invGenerator->GetMeanNumberOfIterations() << "\n"
+         << "  Number of points that did not converge: " << invGenerator->GetNumberOfNonConvergedPoints()
+         << std::endl;
+  if (invGenerator->GetNumberOfNonConvergedPoints() > 0)
+  {
+    xl::xout["warning"] << "WARNING: The inverse did not converge to the tolerance of " << tolerance << " at "
+                        << invGenerator->GetNumberOfNonConvergedPoints() << " points." << std::endl;
+  }
+
+} // end ComputeInverseDeformationField()
 
 
 /**
@@ -31,6 +31,7 @@
 #include "elxBaseComponent.h"
 #include "elxComponentDatabase.h"
 #include "elxConfiguration.h"
+#include "elxFixedPreprocessingCache.h"
 #include "elxMacro.h"
 #include "xoutmain.h"
 
@@ -178,6 +179,15 @@ public:
   /** Type for representation of the transform coordinates. */
   typedef double CoordRepType; // itk::CostFunction::ParametersValueType
 
+  /** Type for the B-spline coefficients of the moving image interpolator.
+   * Single precision when built with ELASTIX_USE_SINGLE_PRECISION.
+   */
+#ifdef ELASTIX_USE_SINGLE_PRECISION
+  typedef float CoefficientType;
+#else
+  typedef double CoefficientType;
+#endif
+
   /** Typedef that is used in the elastix dll version. */
   typedef itk::ParameterMapInterface::ParameterMapType ParameterMapType;
 
@@ -248,6 +258,12 @@ public:
   elxGetObjectMacro(ResultDeformationFieldContainer, DataObjectContainerType);
   elxSetObjectMacro(ResultDeformationFieldContainer, DataObjectContainerType);
 
+  /** Set/Get the cache of the fixed image preprocessing. May be null, in
+   * which case the components do not cache anything.
+   */
+  elxGetObjectMacro(FixedPreprocessingCache, FixedPreprocessingCache);
+  elxSetObjectMacro(FixedPreprocessingCache, FixedPreprocessingCache);
+
   /** Set/Get The Image FileName containers.
    * Normally, these are filled in the BeforeAllBase function.
    */
@@ -543,6 +559,9 @@ private:
   /** The result deformation field container. These are stored as pointers to itk::DataObject. */
   DataObjectContainerPointer m_ResultDeformationFieldContainer;
 
+  /** The cache of the fixed image preprocessing, shared by runs to the same fixed image. */
+  FixedPreprocessingCache::Pointer m_FixedPreprocessingCache;
+
   /** The image and mask FileNameContainers. */
   FileNameContainerPointer m_FixedImageFileNameContainer;
   FileNameContainerPointer m_MovingImageFileNameContainer;
@@ -397,6 +397,9 @@ ElastixMain::Run(void)
   elastixBase.SetMovingMaskContainer(this->GetModifiableMovingMaskContainer());
   elastixBase.SetResultImageContainer(this->GetModifiableResultImageContainer());
 
+  /** Set the cache of the fixed image preprocessing, if any. */
+  elastixBase.SetFixedPreprocessingCache(this->GetModifiableFixedPreprocessingCache());
+
   /** Set the initial transform, if it happens to be there. */
   elastixBase.SetInitialTransform(this->GetModifiableInitialTransform());
 
@@ -209,6 +209,14 @@ public:
   itkSetObjectMacro(ResultDeformationFieldContainer, DataObjectContainerType);
   itkGetModifiableObjectMacro(ResultDeformationFieldContainer, DataObjectContainerType);
 
+  /** Set/Get the cache of the fixed image preprocessing. Pass the same cache
+   * to runs that register different moving images to the same fixed images
+   * (set by SetFixedImageContainer()), to compute the fixed image pyramids
+   * and eroded fixed masks only once. Default null: nothing is cached.
+   */
+  itkSetObjectMacro(FixedPreprocessingCache, FixedPreprocessingCache);
+  itkGetModifiableObjectMacro(FixedPreprocessingCache, FixedPreprocessingCache);
+
   /** Set/Get the configuration object. */
   itkSetObjectMacro(Configuration, ConfigurationType);
   itkGetModifiableObjectMacro(Configuration, ConfigurationType);
@@ -349,6 +357,9 @@ protected:
   DataObjectContainerPointer m_ResultImageContainer;
   DataObjectContainerPointer m_ResultDeformationFieldContainer;
 
+  /** The cache of the fixed image preprocessing. */
+  FixedPreprocessingCache::Pointer m_FixedPreprocessingCache;
+
   /** A transform that is the result of registration. */
   ObjectPointer m_FinalTransform;
 
@@ -308,6 +308,26 @@ ElastixTemplate<TFixedImage, TMovingImage>::ApplyTransform(void)
   timer.Stop();
   elxout << "  Calling all ReadFromFile()'s took " << timer.GetMean() << " s" << std::endl;
 
+  /** Call ComputeSinglePassOutputs. When more than one of the deformation field,
+   * det(dT/dx) and dT/dx is requested, they are all computed here, in a single
+   * pass over the voxels, and skipped by the functions below. When this fails,
+   * the functions below compute them separately.
+   */
+  timer.Reset();
+  timer.Start();
+  elxout << "Compute deformation field and spatial Jacobian in a single pass ..." << std::endl;
+  try
+  {
+    this->GetElxTransformBase()->ComputeSinglePassOutputs();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    xl::xout["error"] << excp << std::endl;
+    xl::xout["error"] << "However, transformix continues anyway." << std::endl;
+  }
+  timer.Stop();
+  elxout << "  Computing in a single pass done, it took " << Conversion::SecondsToDHMS(timer.GetMean(), 2) << std::endl;
+
   /** Call TransformPoints.
    * Actually we could loop over all transforms.
    * But for now, there seems to be no use yet for that.
@@ -366,6 +386,23 @@ ElastixTemplate<TFixedImage, TMovingImage>::ApplyTransform(void)
   timer.Stop();
   elxout << "  Computing spatial Jacobian done, it took " << Conversion::SecondsToDHMS(timer.GetMean(), 2) << std::endl;
 
+  /** Call ComputeInverseDeformationField. */
+  timer.Reset();
+  timer.Start();
+  elxout << "Compute inverse deformation field ..." << std::endl;
+  try
+  {
+    this->GetElxTransformBase()->ComputeInverseDeformationField();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    xl::xout["error"] << excp << std::endl;
+    xl::xout["error"] << "However, transformix continues anyway." << std::endl;
+  }
+  timer.Stop();
+  elxout << "  Computing inverse deformation field done, it took " << Conversion::SecondsToDHMS(timer.GetMean(), 2)
+         << std::endl;
+
   /** Resample the image. */
   if (this->GetMovingImage() != nullptr)
   {
@@ -383,7 +420,21 @@ ElastixTemplate<TFixedImage, TMovingImage>::ApplyTransform(void)
      * Actually we could loop over all resamplers.
      * But for now, there seems to be no use yet for that.
      */
-    if (!BaseComponent::IsElastixLibrary())
+    const unsigned int numberOfInputImages = this->GetNumberOfMovingImages();
+    if (!BaseComponent::IsElastixLibrary() && numberOfInputImages > 1)
+    {
+      /** Resample all input images in a single pass, to result.<n>.<format>. */
+      std::vector<std::string> fileNames;
+      for (unsigned int i = 0; i < numberOfInputImages; ++i)
+      {
+        std::ostringstream makeFileNameOfImage("");
+        makeFileNameOfImage << this->GetConfiguration()->GetCommandLineArgument("-out") << "result." << i << "."
+                            << resultImageFormat;
+        fileNames.push_back(makeFileNameOfImage.str());
+      }
+      this->GetElxResamplerBase()->ResampleAndWriteResultImages(fileNames);
+    }
+    else if (!BaseComponent::IsElastixLibrary())
     {
       this->GetElxResamplerBase()->ResampleAndWriteResultImage(makeFileName.str().c_str());
     }
@@ -0,0 +1,119 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "elxFixedPreprocessingCache.h"
+
+#include <sstream>
+
+namespace elastix
+{
+
+/**
+ * ********************* Find ****************************
+ */
+
+auto
+FixedPreprocessingCache::Find(const std::string & key) const -> DataObjectPointer
+{
+  const std::lock_guard<std::mutex> lock(this->m_Mutex);
+
+  const auto found = this->m_Entries.find(key);
+  if (found == this->m_Entries.end())
+  {
+    return nullptr;
+  }
+  ++this->m_NumberOfHits;
+  return found->second;
+
+} // end Find()
+
+
+/**
+ * ********************* Store ****************************
+ */
+
+void
+FixedPreprocessingCache::Store(const std::string & key, DataObjectType * data)
+{
+  const std::lock_guard<std::mutex> lock(this->m_Mutex);
+
+  this->m_Entries[key] = data;
+
+} // end Store()
+
+
+/**
+ * ********************* Clear ****************************
+ */
+
+void
+FixedPreprocessingCache::Clear(void)
+{
+  const std::lock_guard<std::mutex> lock(this->m_Mutex);
+
+  this->m_Entries.clear();
+  this->m_NumberOfHits = 0;
+
+} // end Clear()
+
+
+/**
+ * ********************* GetNumberOfEntries ****************************
+ */
+
+std::size_t
+FixedPreprocessingCache::GetNumberOfEntries(void) const
+{
+  const std::lock_guard<std::mutex> lock(this->m_Mutex);
+
+  return this->m_Entries.size();
+
+} // end GetNumberOfEntries()
+
+
+/**
+ * ********************* GetNumberOfHits ****************************
+ */
+
+std::size_t
+FixedPreprocessingCache::GetNumberOfHits(void) const
+{
+  const std::lock_guard<std::mutex> lock(this->m_Mutex);
+
+  return this->m_NumberOfHits;
+
+} // end GetNumberOfHits()
+
+
+/**
+ * ********************* GetImageKey ****************************
+ */
+
+std::string
+FixedPreprocessingCache::GetImageKey(const DataObjectType * image)
+{
+  std::ostringstream key;
+  key << static_cast<const void *>(image);
+  if (image)
+  {
+    key << '@' << image->GetMTime();
+  }
+  return key.str();
+
+} // end GetImageKey()
+
+} // end namespace elastix
@@ -0,0 +1,115 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef elxFixedPreprocessingCache_h
+#define elxFixedPreprocessingCache_h
+
+// ITK header files:
+#include <itkDataObject.h>
+#include <itkObject.h>
+
+// Standard C++ header files:
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace elastix
+{
+
+/**
+ * \class FixedPreprocessingCache
+ * \brief Stores the results of the preprocessing of the fixed images,
+ * so that they can be reused by registrations to the same fixed images.
+ *
+ * When one fixed image is registered to many moving images, the fixed
+ * image pyramid and the eroded fixed masks are the same for each run.
+ * Components that compute such data look it up in this cache first, and
+ * store what they computed. The entries are identified by a key, which
+ * starts with the key of the input image (see GetImageKey()), followed
+ * by the settings that were used to compute the data.
+ *
+ * The cache is passed from run to run like the image containers, via
+ * ElastixMain::SetFixedPreprocessingCache(). Its methods are thread-safe.
+ *
+ * \ingroup Kernel
+ */
+
+class FixedPreprocessingCache : public itk::Object
+{
+public:
+  /** Standard itk. */
+  typedef FixedPreprocessingCache       Self;
+  typedef itk::Object                   Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(FixedPreprocessingCache, Object);
+
+  /** Typedef's. */
+  typedef itk::DataObject         DataObjectType;
+  typedef DataObjectType::Pointer DataObjectPointer;
+
+  /** Returns the data stored under the key, or null if there is none. */
+  DataObjectPointer
+  Find(const std::string & key) const;
+
+  /** Stores the data under the key, replacing any previous data. */
+  void
+  Store(const std::string & key, DataObjectType * data);
+
+  /** Removes all entries. */
+  void
+  Clear(void);
+
+  /** Returns the number of entries. */
+  std::size_t
+  GetNumberOfEntries(void) const;
+
+  /** Returns the number of calls to Find() that found data, since the
+   * construction of the cache or the last call to Clear().
+   */
+  std::size_t
+  GetNumberOfHits(void) const;
+
+  /** Returns a key that identifies an image: its address and modified time.
+   * A different image, or the same image after it was modified, gets a
+   * different key, so that its old data is not reused.
+   */
+  static std::string
+  GetImageKey(const DataObjectType * image);
+
+protected:
+  FixedPreprocessingCache() = default;
+  ~FixedPreprocessingCache() override = default;
+
+private:
+  FixedPreprocessingCache(const Self &) = delete;
+  void
+  operator=(const Self &) = delete;
+
+  mutable std::mutex                       m_Mutex;
+  std::map<std::string, DataObjectPointer> m_Entries;
+  mutable std::size_t                      m_NumberOfHits{ 0 };
+};
+
+} // end namespace elastix
+
+#endif // end #ifndef elxFixedPreprocessingCache_h
@@ -693,3 +693,75 @@ GTEST_TEST(itkElastixRegistrationMethod, EulerDiscRotation2D)
     EXPECT_EQ(std::round(transformParameters[2]), 0.0);                        // translation Y
   }
 }
+
+
+// Tests registering one fixed image to two moving images, with a FixedPreprocessingCache that is shared by both
+// registrations. The second registration should reuse the fixed pyramid of the first one, instead of computing and
+// storing it again, and the results should be the same as without the cache.
+GTEST_TEST(itkElastixRegistrationMethod, FixedPreprocessingCache)
+{
+  constexpr auto ImageDimension = 2U;
+  using PixelType = float;
+  using ImageType = itk::Image<PixelType, ImageDimension>;
+  using SizeType = itk::Size<ImageDimension>;
+  using IndexType = itk::Index<ImageDimension>;
+  using OffsetType = itk::Offset<ImageDimension>;
+  using FilterType = itk::ElastixRegistrationMethod<ImageType, ImageType>;
+
+  const auto      regionSize = SizeType::Filled(2);
+  const SizeType  imageSize{ { 5, 6 } };
+  const IndexType fixedImageRegionIndex{ { 1, 3 } };
+
+  const auto fixedImage = CreateImage<PixelType>(imageSize);
+  FillImageRegion(*fixedImage, fixedImageRegionIndex, regionSize);
+
+  const auto parameterObject = CreateParameterObject({ // Parameters in alphabetic order:
+                                                       { "FixedImagePyramid", "FixedGenericImagePyramid" },
+                                                       { "ImageSampler", "Full" },
+                                                       { "MaximumNumberOfIterations", "2" },
+                                                       { "Metric", "AdvancedNormalizedCorrelation" },
+                                                       { "NumberOfResolutions", "1" },
+                                                       { "Optimizer", "AdaptiveStochasticGradientDescent" },
+                                                       { "Transform", "TranslationTransform" } });
+
+  const auto cache = CheckNew<FilterType::FixedPreprocessingCacheType>();
+
+  bool        isFirstRegistration = true;
+  std::size_t numberOfEntriesAfterFirstRegistration = 0;
+  std::size_t numberOfHitsAfterFirstRegistration = 0;
+
+  for (const auto & translationOffset : { OffsetType{ { 1, -2 } }, OffsetType{ { -1, -1 } } })
+  {
+    const auto movingImage = CreateImage<PixelType>(imageSize);
+    FillImageRegion(*movingImage, fixedImageRegionIndex + translationOffset, regionSize);
+
+    const auto filter = CheckNew<FilterType>();
+    filter->SetFixedImage(fixedImage);
+    filter->SetMovingImage(movingImage);
+    filter->SetParameterObject(parameterObject);
+    filter->Update();
+
+    const auto filterWithCache = CheckNew<FilterType>();
+    filterWithCache->SetFixedImage(fixedImage);
+    filterWithCache->SetMovingImage(movingImage);
+    filterWithCache->SetParameterObject(parameterObject);
+    filterWithCache->SetFixedPreprocessingCache(cache);
+    filterWithCache->Update();
+
+    if (isFirstRegistration)
+    {
+      // The first registration stores its fixed pyramid.
+      numberOfEntriesAfterFirstRegistration = cache->GetNumberOfEntries();
+      numberOfHitsAfterFirstRegistration = cache->GetNumberOfHits();
+      EXPECT_GT(numberOfEntriesAfterFirstRegistration, 0);
+      isFirstRegistration = false;
+    }
+    else
+    {
+      // The second registration finds the fixed pyramid, instead of computing and storing it again.
+      EXPECT_GT(cache->GetNumberOfHits(), numberOfHitsAfterFirstRegistration);
+      EXPECT_EQ(cache->GetNumberOfEntries(), numberOfEntriesAfterFirstRegistration);
+    }
+    EXPECT_EQ(GetTransformParametersFromFilter(*filterWithCache), GetTransformParametersFromFilter(*filter));
+  }
+}
@@ -689,3 +689,68 @@ GTEST_TEST(itkTransformixFilter, CombineTranslationAndScale)
   EXPECT_EQ(DerefSmartPointer(transformixOutput),
             *(CreateResampleImageFilter(*inputImage, scaleAndTranslationTransform)->GetOutput()));
 }
+
+
+#ifdef ELASTIX_USE_OPENCL
+// Tests that the OpenCLResampler gives the same output when it resamples the image in tiles, for a B-spline transform
+// and a B-spline interpolator, for which each tile needs the complete input image. Without an OpenCL device, the
+// resampler falls back to the CPU, and the test is trivial.
+GTEST_TEST(itkTransformixFilter, OpenCLResamplerTilesBSplineTransform)
+{
+  constexpr auto ImageDimension = 3U;
+  using ImageType = itk::Image<float, ImageDimension>;
+
+  const auto imageSize = ImageType::SizeType::Filled(16);
+  const auto inputImage = CreateImageFilledWithSequenceOfNaturalNumbers<float>(imageSize);
+
+  // A grid spacing of 4 voxels, with a grid of 7 nodes along each dimension, covering the image.
+  constexpr unsigned int gridSize = 7;
+  const unsigned int     numberOfParameters = ImageDimension * gridSize * gridSize * gridSize;
+  const auto             transformParameters = GeneratePseudoRandomParameters(numberOfParameters, -2.0, 2.0);
+
+  const auto resample = [&inputImage, &imageSize, &transformParameters](const unsigned int numberOfTiles) {
+    const auto filter = CheckNew<itk::TransformixFilter<ImageType>>();
+    filter->SetMovingImage(inputImage);
+    filter->SetTransformParameterObject(
+      CreateParameterObject({ // Parameters in alphabetic order:
+                              { "BSplineTransformSplineOrder", { "3" } },
+                              { "Direction", CreateDefaultDirectionParameterValues<ImageDimension>() },
+                              { "FinalBSplineInterpolationOrder", { "3" } },
+                              { "GridDirection", CreateDefaultDirectionParameterValues<ImageDimension>() },
+                              { "GridIndex", ParameterValuesType(ImageDimension, "0") },
+                              { "GridOrigin", ParameterValuesType(ImageDimension, "-4") },
+                              { "GridSize", ParameterValuesType(ImageDimension, std::to_string(gridSize)) },
+                              { "GridSpacing", ParameterValuesType(ImageDimension, "4") },
+                              { "Index", ParameterValuesType(ImageDimension, "0") },
+                              { "NumberOfParameters", { std::to_string(transformParameters.size()) } },
+                              { "OpenCLResamplerNumberOfTiles", { std::to_string(numberOfTiles) } },
+                              { "OpenCLResamplerUseOpenCL", { "true" } },
+                              { "Origin", ParameterValuesType(ImageDimension, "0") },
+                              { "ResampleInterpolator", { "FinalBSplineInterpolator" } },
+                              { "Resampler", { "OpenCLResampler" } },
+                              { "Size", ConvertToParameterValues(imageSize) },
+                              { "Spacing", ParameterValuesType(ImageDimension, "1") },
+                              { "Transform", { "BSplineTransform" } },
+                              { "TransformParameters", ConvertToParameterValues(transformParameters) },
+                              { "UseCyclicTransform", { "false" } } }));
+    filter->Update();
+    return itk::SmartPointer<ImageType>(filter->GetOutput());
+  };
+
+  const auto untiledOutput = resample(1);
+  const auto tiledOutput = resample(4);
+
+  EXPECT_TRUE(ImageBuffer_has_nonzero_pixel_values(*untiledOutput));
+
+  // The tiles have their own origin, so the mapped points may differ by rounding errors.
+  const itk::ImageBufferRange<const ImageType> untiledRange(*untiledOutput);
+  const itk::ImageBufferRange<const ImageType> tiledRange(*tiledOutput);
+  ASSERT_EQ(tiledRange.size(), untiledRange.size());
+  EXPECT_TRUE(std::equal(tiledRange.cbegin(),
+                         tiledRange.cend(),
+                         untiledRange.cbegin(),
+                         [](const float tiledValue, const float untiledValue) {
+                           return std::abs(tiledValue - untiledValue) <= 1e-2f;
+                         }));
+}
+#endif
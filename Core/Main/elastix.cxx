@@ -25,16 +25,22 @@
 
 // ITK header files:
 #include <itkTimeProbe.h>
+#include <itksys/Process.h>
 #include <itksys/SystemInformation.hxx>
 #include <itksys/SystemTools.hxx>
 
 // Standard C++ header files:
+#include <algorithm> // For max.
 #include <cassert>
 #include <climits> // For UINT_MAX.
 #include <cstddef> // For size_t.
+#include <fstream>
 #include <iostream>
 #include <limits>
 #include <queue>
+#include <sstream>
+#include <string>
+#include <thread>
 #include <vector>
 
 int
@@ -94,6 +100,7 @@ main(int argc, char ** argv)
 
   /** Some typedef's. */
   typedef elx::ElastixMain                            ElastixMainType;
+  typedef elx::FixedPreprocessingCache                FixedPreprocessingCacheType;
   typedef ElastixMainType::ObjectPointer              ObjectPointer;
   typedef ElastixMainType::DataObjectContainerPointer DataObjectContainerPointer;
   typedef ElastixMainType::FlatDirectionCosinesType   FlatDirectionCosinesType;
@@ -164,6 +171,68 @@ main(int argc, char ** argv)
 
   int returndummy{};
 
+  /** In batch mode, the moving images and their optional masks are read from the
+   * list file given by "-mlist", one moving image per line. Otherwise, there is a
+   * single entry, and the moving images and masks are given by "-m" and "-mMask".
+   */
+  MovingImageListType movingImageFileNames(1);
+  const auto          movingImageListEntry = argMap.find("-mlist");
+  const bool          batchMode = movingImageListEntry != argMap.end();
+  if (batchMode)
+  {
+    if (argMap.count("-m") > 0)
+    {
+      std::cerr << "ERROR: the CommandLine options \"-m\" and \"-mlist\" cannot be combined!" << std::endl;
+      returndummy |= -1;
+    }
+    if (argMap.count("-mMask") > 0)
+    {
+      std::cerr << "ERROR: the CommandLine options \"-mMask\" and \"-mlist\" cannot be combined!\n"
+                << "Specify the mask of each moving image in the list file instead." << std::endl;
+      returndummy |= -1;
+    }
+    movingImageFileNames = ReadMovingImageList(movingImageListEntry->second);
+    if (movingImageFileNames.empty())
+    {
+      std::cerr << "ERROR: no moving images found in \"" << movingImageListEntry->second << "\"!" << std::endl;
+      returndummy |= -1;
+    }
+    argMap.erase(movingImageListEntry);
+  }
+
+  /** In batch mode, "-mworkers" gives the number of worker processes that register
+   * the moving images concurrently. Each worker is started with "-mworker", the index
+   * of its share of the moving images.
+   */
+  unsigned int numberOfWorkers{ 1 };
+  unsigned int workerIndex{ 0 };
+  const bool   isWorker = argMap.count("-mworker") > 0;
+  for (const char * const key : { "-mworkers", "-mworker" })
+  {
+    const auto entry = argMap.find(key);
+    if (entry != argMap.end())
+    {
+      unsigned int       value{};
+      std::istringstream valueStream(entry->second);
+      if (!batchMode || !(valueStream >> value) || !valueStream.eof())
+      {
+        std::cerr << "ERROR: the CommandLine option \"" << key << "\" requires \"-mlist\" and a number!" << std::endl;
+        returndummy |= -1;
+      }
+      else
+      {
+        (entry->first == "-mworkers" ? numberOfWorkers : workerIndex) = value;
+      }
+      argMap.erase(entry);
+    }
+  }
+  if (numberOfWorkers == 0 || workerIndex >= numberOfWorkers)
+  {
+    std::cerr << "ERROR: invalid number of workers (" << numberOfWorkers << ") or worker index (" << workerIndex
+              << ")!" << std::endl;
+    returndummy |= -1;
+  }
+
   /** Check if at least once the option "-p" is given. */
   if (parameterFileList.empty())
   {
@@ -183,8 +252,9 @@ main(int argc, char ** argv)
     }
     else
     {
-      /** Setup xout. */
-      const std::string logFileName = outFolder + "elastix.log";
+      /** Setup xout. Each worker process has its own log file. */
+      const std::string logFileName =
+        outFolder + (isWorker ? "elastix.worker" + std::to_string(workerIndex) + ".log" : "elastix.log");
       const int         returndummy2{ elx::xoutSetup(logFileName.c_str(), true, true) };
       if (returndummy2 != 0)
       {
@@ -224,6 +294,35 @@ main(int argc, char ** argv)
   elxout << "  with " << info.GetTotalPhysicalMemory() << " MB memory, and " << info.GetNumberOfPhysicalCPU()
          << " cores @ " << static_cast<unsigned int>(info.GetProcessorClockFrequency()) << " MHz." << std::endl;
 
+  /** Distribute the moving images over the worker processes, and wait for them to finish.
+   * The workers are started with the same command line arguments, so that they read the
+   * same moving image list. When "-threads" is not given, they share the cores.
+   */
+  if (numberOfWorkers > 1 && !isWorker)
+  {
+    std::vector<std::string> workerArguments(argv, argv + argc);
+    if (argMap.count("-threads") == 0)
+    {
+      const unsigned int numberOfThreads = std::max(std::thread::hardware_concurrency() / numberOfWorkers, 1U);
+      workerArguments.push_back("-threads");
+      workerArguments.push_back(std::to_string(numberOfThreads));
+    }
+
+    elxout << "\nRegistering " << movingImageFileNames.size() << " moving images in " << numberOfWorkers
+           << " worker processes, with log files \"" << outFolder << "elastix.worker<index>.log\".\n"
+           << std::endl;
+
+    const int workerResult = RunBatchWorkers(workerArguments, numberOfWorkers);
+
+    totaltimer.Stop();
+    elxout << "Total time elapsed: " << ConvertSecondsToDHMS(totaltimer.GetMean(), 1) << ".\n" << std::endl;
+    if (workerResult != 0)
+    {
+      xl::xout["error"] << "Errors occurred in a worker process!" << std::endl;
+    }
+    return workerResult;
+  }
+
 
   ObjectPointer              transform = nullptr;
   DataObjectContainerPointer fixedImageContainer = nullptr;
@@ -232,79 +331,130 @@ main(int argc, char ** argv)
   DataObjectContainerPointer movingMaskContainer = nullptr;
   FlatDirectionCosinesType   fixedImageOriginalDirection;
 
-  /**
-   * ********************* START REGISTRATION *********************
-   *
-   * Do the (possibly multiple) registration(s).
+  /** In batch mode, the fixed images and masks are read once, and the results
+   * of their preprocessing are cached, for the registrations of all moving images.
    */
+  FixedPreprocessingCacheType::Pointer fixedPreprocessingCache;
+  if (batchMode)
+  {
+    fixedPreprocessingCache = FixedPreprocessingCacheType::New();
+  }
 
   const auto nrOfParameterFiles = parameterFileList.size();
   assert(nrOfParameterFiles <= UINT_MAX);
 
-  for (unsigned i{}; i < static_cast<unsigned>(nrOfParameterFiles); ++i)
+  /** A worker only registers its share of the moving images. */
+  for (std::size_t movingIndex{ workerIndex }; movingIndex < movingImageFileNames.size();
+       movingIndex += numberOfWorkers)
   {
-    /** Create another instance of ElastixMain. */
-    const auto elastixMain = ElastixMainType::New();
-
-    /** Set stuff we get from a former registration. */
-    elastixMain->SetInitialTransform(transform);
-    elastixMain->SetFixedImageContainer(fixedImageContainer);
-    elastixMain->SetMovingImageContainer(movingImageContainer);
-    elastixMain->SetFixedMaskContainer(fixedMaskContainer);
-    elastixMain->SetMovingMaskContainer(movingMaskContainer);
-    elastixMain->SetOriginalFixedImageDirectionFlat(fixedImageOriginalDirection);
-
-    /** Set the current elastix-level. */
-    elastixMain->SetElastixLevel(i);
-    elastixMain->SetTotalNumberOfElastixLevels(nrOfParameterFiles);
-
-    /** Get the argMap entry for the parameter file, and exchange its file name
-     * with the first file name in the list.
-     */
-    std::string & parameterFileName = argMap["-p"];
-    parameterFileName.swap(parameterFileList.front());
-    parameterFileList.pop();
-
-    /** Print a start message. */
-    elxout << "-------------------------------------------------------------------------\n" << std::endl;
-    elxout << "Running elastix with parameter file " << i << ": \"" << parameterFileName << "\".\n" << std::endl;
+    std::queue<std::string> parameterFileQueue = parameterFileList;
 
-    /** Declare a timer, start it and print the start time. */
-    itk::TimeProbe timer;
-    timer.Start();
-    elxout << "Current time: " << GetCurrentDateAndTime() << "." << std::endl;
+    /** In batch mode, the results of each moving image go to a subdirectory of the output directory. */
+    if (batchMode)
+    {
+      const std::string movingOutFolder =
+        elx::Conversion::ToNativePathNameSeparators(outFolder + std::to_string(movingIndex) + "/");
+      if (!itksys::SystemTools::MakeDirectory(movingOutFolder))
+      {
+        xl::xout["error"] << "ERROR: the output directory \"" << movingOutFolder << "\" could not be created."
+                          << std::endl;
+        return -2;
+      }
+      argMap["-out"] = movingOutFolder;
+      argMap["-m"] = movingImageFileNames[movingIndex].first;
+      if (movingImageFileNames[movingIndex].second.empty())
+      {
+        argMap.erase("-mMask");
+      }
+      else
+      {
+        argMap["-mMask"] = movingImageFileNames[movingIndex].second;
+      }
 
-    /** Start registration. */
-    returndummy = elastixMain->Run(argMap);
+      /** Each moving image starts without a transform, and is read from disk. */
+      transform = nullptr;
+      movingImageContainer = nullptr;
+      movingMaskContainer = nullptr;
 
-    /** Check for errors. */
-    if (returndummy != 0)
-    {
-      xl::xout["error"] << "Errors occurred!" << std::endl;
-      return returndummy;
+      elxout << "=========================================================================\n" << std::endl;
+      elxout << "Registering moving image " << movingIndex << ": \"" << movingImageFileNames[movingIndex].first
+             << "\", output directory: \"" << movingOutFolder << "\".\n"
+             << std::endl;
     }
 
-    /** Get the transform, the fixedImage and the movingImage
-     * in order to put it in the (possibly) next registration.
+    /**
+     * ********************* START REGISTRATION *********************
+     *
+     * Do the (possibly multiple) registration(s).
      */
-    transform = elastixMain->GetModifiableFinalTransform();
-    fixedImageContainer = elastixMain->GetModifiableFixedImageContainer();
-    movingImageContainer = elastixMain->GetModifiableMovingImageContainer();
-    fixedMaskContainer = elastixMain->GetModifiableFixedMaskContainer();
-    movingMaskContainer = elastixMain->GetModifiableMovingMaskContainer();
-    fixedImageOriginalDirection = elastixMain->GetOriginalFixedImageDirectionFlat();
-
-    /** Print a finish message. */
-    elxout << "Running elastix with parameter file " << i << ": \"" << parameterFileName << "\", has finished.\n"
-           << std::endl;
 
-    /** Stop timer and print it. */
-    timer.Stop();
-    elxout << "\nCurrent time: " << GetCurrentDateAndTime() << "." << std::endl;
-    elxout << "Time used for running elastix with this parameter file:\n  " << ConvertSecondsToDHMS(timer.GetMean(), 1)
-           << ".\n"
-           << std::endl;
-  } // end loop over registrations
+    for (unsigned i{}; i < static_cast<unsigned>(nrOfParameterFiles); ++i)
+    {
+      /** Create another instance of ElastixMain. */
+      const auto elastixMain = ElastixMainType::New();
+
+      /** Set stuff we get from a former registration. */
+      elastixMain->SetInitialTransform(transform);
+      elastixMain->SetFixedImageContainer(fixedImageContainer);
+      elastixMain->SetMovingImageContainer(movingImageContainer);
+      elastixMain->SetFixedMaskContainer(fixedMaskContainer);
+      elastixMain->SetMovingMaskContainer(movingMaskContainer);
+      elastixMain->SetOriginalFixedImageDirectionFlat(fixedImageOriginalDirection);
+      elastixMain->SetFixedPreprocessingCache(fixedPreprocessingCache);
+
+      /** Set the current elastix-level. */
+      elastixMain->SetElastixLevel(i);
+      elastixMain->SetTotalNumberOfElastixLevels(nrOfParameterFiles);
+
+      /** Get the argMap entry for the parameter file, and exchange its file name
+       * with the first file name in the list.
+       */
+      std::string & parameterFileName = argMap["-p"];
+      parameterFileName.swap(parameterFileQueue.front());
+      parameterFileQueue.pop();
+
+      /** Print a start message. */
+      elxout << "-------------------------------------------------------------------------\n" << std::endl;
+      elxout << "Running elastix with parameter file " << i << ": \"" << parameterFileName << "\".\n" << std::endl;
+
+      /** Declare a timer, start it and print the start time. */
+      itk::TimeProbe timer;
+      timer.Start();
+      elxout << "Current time: " << GetCurrentDateAndTime() << "." << std::endl;
+
+      /** Start registration. */
+      returndummy = elastixMain->Run(argMap);
+
+      /** Check for errors. */
+      if (returndummy != 0)
+      {
+        xl::xout["error"] << "Errors occurred!" << std::endl;
+        return returndummy;
+      }
+
+      /** Get the transform, the fixedImage and the movingImage
+       * in order to put it in the (possibly) next registration.
+       */
+      transform = elastixMain->GetModifiableFinalTransform();
+      fixedImageContainer = elastixMain->GetModifiableFixedImageContainer();
+      movingImageContainer = elastixMain->GetModifiableMovingImageContainer();
+      fixedMaskContainer = elastixMain->GetModifiableFixedMaskContainer();
+      movingMaskContainer = elastixMain->GetModifiableMovingMaskContainer();
+      fixedImageOriginalDirection = elastixMain->GetOriginalFixedImageDirectionFlat();
+
+      /** Print a finish message. */
+      elxout << "Running elastix with parameter file " << i << ": \"" << parameterFileName << "\", has finished.\n"
+             << std::endl;
+
+      /** Stop timer and print it. */
+      timer.Stop();
+      elxout << "\nCurrent time: " << GetCurrentDateAndTime() << "." << std::endl;
+      elxout << "Time used for running elastix with this parameter file:\n  "
+             << ConvertSecondsToDHMS(timer.GetMean(), 1) << ".\n"
+             << std::endl;
+    } // end loop over registrations
+
+  } // end loop over moving images
 
   elxout << "-------------------------------------------------------------------------\n" << std::endl;
 
@@ -355,6 +505,12 @@ PrintHelp(void)
 
   /** Optional arguments.*/
   std::cout << "Optional extra commands:\n"
+            << "  -mlist    text file with a moving image per line, instead of \"-m\": registers\n"
+            << "            each of them to the fixed image, with results in <out>/0/, <out>/1/, etc.\n"
+            << "            The fixed image is read and preprocessed only once. A line may give\n"
+            << "            the mask of its moving image after a tab, instead of \"-mMask\".\n"
+            << "  -mworkers with \"-mlist\": the number of processes that register the moving images\n"
+            << "            concurrently, each with a log file <out>/elastix.worker<index>.log.\n"
             << "  -fMask    mask for fixed image\n"
             << "  -mMask    mask for moving image\n"
             << "  -fp       point set for fixed image\n"
@@ -378,3 +534,97 @@ PrintHelp(void)
             << std::endl;
 
 } // end PrintHelp()
+
+
+/**
+ * *********************** ReadMovingImageList ****************************
+ */
+
+MovingImageListType
+ReadMovingImageList(const std::string & fileName)
+{
+  MovingImageListType fileNames;
+  std::ifstream       listFile(fileName);
+  std::string         line;
+  while (std::getline(listFile, line))
+  {
+    /** Skip empty lines, and strip trailing white space, like a Windows line end. */
+    line.erase(line.find_last_not_of(" \t\r") + 1);
+    if (!line.empty())
+    {
+      /** An optional mask file name follows the image file name after a tab. */
+      const auto tabPosition = line.find('\t');
+      if (tabPosition == std::string::npos)
+      {
+        fileNames.emplace_back(line, std::string());
+      }
+      else
+      {
+        std::string maskFileName = line.substr(tabPosition + 1);
+        maskFileName.erase(0, maskFileName.find_first_not_of(" \t"));
+        line.erase(tabPosition);
+        fileNames.emplace_back(line, maskFileName);
+      }
+    }
+  }
+  return fileNames;
+
+} // end ReadMovingImageList()
+
+
+/**
+ * *********************** RunBatchWorkers ****************************
+ */
+
+int
+RunBatchWorkers(const std::vector<std::string> & arguments, const unsigned int numberOfWorkers)
+{
+  std::vector<itksysProcess *> workers;
+  for (unsigned int workerIndex{}; workerIndex < numberOfWorkers; ++workerIndex)
+  {
+    std::vector<std::string> workerArguments = arguments;
+    workerArguments.push_back("-mworker");
+    workerArguments.push_back(std::to_string(workerIndex));
+
+    std::vector<const char *> command;
+    for (const auto & argument : workerArguments)
+    {
+      command.push_back(argument.c_str());
+    }
+    command.push_back(nullptr);
+
+    /** The workers write to the console of this process, and run concurrently. */
+    itksysProcess * const worker = itksysProcess_New();
+    itksysProcess_SetCommand(worker, command.data());
+    itksysProcess_SetPipeShared(worker, itksysProcess_Pipe_STDOUT, 1);
+    itksysProcess_SetPipeShared(worker, itksysProcess_Pipe_STDERR, 1);
+    itksysProcess_Execute(worker);
+    workers.push_back(worker);
+  }
+
+  int result{ 0 };
+  for (unsigned int workerIndex{}; workerIndex < numberOfWorkers; ++workerIndex)
+  {
+    itksysProcess * const worker = workers[workerIndex];
+    itksysProcess_WaitForExit(worker, nullptr);
+
+    const int state = itksysProcess_GetState(worker);
+    if (state != itksysProcess_State_Exited || itksysProcess_GetExitValue(worker) != 0)
+    {
+      xl::xout["error"] << "ERROR: worker process " << workerIndex << " failed";
+      if (state == itksysProcess_State_Error)
+      {
+        xl::xout["error"] << ": " << itksysProcess_GetErrorString(worker);
+      }
+      else if (state == itksysProcess_State_Exception)
+      {
+        xl::xout["error"] << ": " << itksysProcess_GetExceptionString(worker);
+      }
+      xl::xout["error"] << '.' << std::endl;
+      result = -1;
+    }
+    itksysProcess_Delete(worker);
+  }
+  return result;
+
+} // end RunBatchWorkers()
@@ -24,6 +24,8 @@
 #include <iomanip> // std::setprecision
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 /** Declare PrintHelp function.
  *
@@ -34,10 +36,43 @@
  *    version information. \n
  *    example: <tt>elastix --version</tt> \n
  *    example: <tt>transformix --version</tt> \n
+ * \commandlinearg -daemon: optional argument for transformix to keep running, and
+ *    read the arguments of the jobs from the standard input, one job per line. \n
+ *    example: <tt>transformix -daemon < jobs.txt</tt> \n
  */
 void
 PrintHelp(void);
 
+/** The file names of the moving images, each with the file name of its mask,
+ * which is empty when the image has no mask.
+ */
+typedef std::vector<std::pair<std::string, std::string>> MovingImageListType;
+
+/** Reads the file names of the moving images from a text file, one per line,
+ * for the batch mode of elastix. A line may give the file name of the mask of
+ * its moving image after a tab.
+ *
+ * \commandlinearg -mlist: optional argument for elastix, instead of -m and -mMask,
+ *    to register each of the listed moving images to the fixed image. \n
+ *    example: <tt>elastix -f fixed.mhd -mlist moving.txt -out outDir -p parameters.txt</tt> \n
+ */
+MovingImageListType
+ReadMovingImageList(const std::string & fileName);
+
+/** Runs the batch mode of elastix in a number of concurrent worker processes.
+ * Each worker is another elastix process, with the given command line arguments
+ * followed by "-mworker <index>". It registers the moving images of which the
+ * index in the list, modulo the number of workers, equals its worker index, and
+ * reuses the fixed image preprocessing across them. Returns zero when all
+ * workers succeeded.
+ *
+ * \commandlinearg -mworkers: optional argument for elastix in batch mode, to
+ *    register the listed moving images in this number of concurrent processes. \n
+ *    example: <tt>elastix -f fixed.mhd -mlist moving.txt -mworkers 4 -out outDir -p parameters.txt</tt> \n
+ */
+int
+RunBatchWorkers(const std::vector<std::string> & arguments, const unsigned int numberOfWorkers);
+
 /** ConvertSecondsToDHMS
  *
  */
@@ -74,6 +74,7 @@ public:
   typedef ElastixMainType::ArgumentMapType          ArgumentMapType;
   typedef ArgumentMapType::value_type               ArgumentMapEntryType;
   typedef ElastixMainType::FlatDirectionCosinesType FlatDirectionCosinesType;
+  typedef elastix::FixedPreprocessingCache          FixedPreprocessingCacheType;
 
   typedef ElastixMainType::DataObjectContainerType      DataObjectContainerType;
   typedef ElastixMainType::DataObjectContainerPointer   DataObjectContainerPointer;
@@ -243,6 +244,14 @@ public:
   itkSetMacro(NumberOfThreads, int);
   itkGetConstMacro(NumberOfThreads, int);
 
+  /** Set/Get the cache of the fixed image preprocessing. When the same fixed image
+   * (and mask) is registered to many moving images, pass the same cache to each
+   * registration, so that the fixed image pyramid and the eroded fixed mask are
+   * computed only once.
+   */
+  itkSetObjectMacro(FixedPreprocessingCache, FixedPreprocessingCacheType);
+  itkGetModifiableObjectMacro(FixedPreprocessingCache, FixedPreprocessingCacheType);
+
 protected:
   ElastixRegistrationMethod();
 
@@ -287,6 +296,8 @@ private:
 
   int m_NumberOfThreads;
 
+  FixedPreprocessingCacheType::Pointer m_FixedPreprocessingCache;
+
   unsigned int m_InputUID;
 };
 
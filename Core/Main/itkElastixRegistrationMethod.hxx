@@ -250,6 +250,7 @@ ElastixRegistrationMethod<TFixedImage, TMovingImage>::GenerateData()
     elastix->SetMovingMaskContainer(movingMaskContainer);
     elastix->SetResultImageContainer(resultImageContainer);
     elastix->SetOriginalFixedImageDirectionFlat(fixedImageOriginalDirection);
+    elastix->SetFixedPreprocessingCache(this->m_FixedPreprocessingCache);
 
     // Start registration
     unsigned int isError = 0;
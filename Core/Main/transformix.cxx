@@ -24,10 +24,30 @@
 #include "itkUseMevisDicomTiff.h"
 
 // ITK header files:
+#include <itkMultiThreaderBase.h>
 #include <itkTimeProbe.h>
 
 // Standard C++ header files:
+#include <cctype>
 #include <iostream>
+#include <ostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+int
+RunTransformix(const std::vector<std::string> & arguments, const std::string & argv0, const bool daemonMode);
+
+int
+RunTransformixDaemon(const std::string & argv0);
+
+std::vector<std::string>
+SplitJobArguments(const std::string & line);
+
+} // end unnamed namespace
 
 
 int
@@ -55,6 +75,10 @@ main(int argc, char ** argv)
       std::cout << "transformix version: " ELASTIX_VERSION_STRING << std::endl;
       return 0;
     }
+    else if (argument == "-daemon")
+    {
+      return RunTransformixDaemon(argv[0]);
+    }
     else
     {
       std::cout << "Use \"transformix --help\" for information about transformix-usage." << std::endl;
@@ -62,15 +86,34 @@ main(int argc, char ** argv)
     }
   }
 
+  /** Support Mevis Dicom Tiff (if selected in cmake) */
+  RegisterMevisDicomTiff();
+
+  return RunTransformix(std::vector<std::string>(argv + 1, argv + argc), argv[0], false);
+
+} // end main
+
+
+namespace
+{
+
+/**
+ * *********************** RunTransformix ****************************
+ *
+ * Runs one transformation, with the command line arguments (without argv[0]).
+ * In daemon mode, the messages are only written to the log file, because
+ * std::cout is used for the replies to the jobs.
+ */
+
+int
+RunTransformix(const std::vector<std::string> & arguments, const std::string & argv0, const bool daemonMode)
+{
   /** Some typedef's.*/
   typedef elx::TransformixMain                 TransformixMainType;
   typedef TransformixMainType::Pointer         TransformixMainPointer;
   typedef TransformixMainType::ArgumentMapType ArgumentMapType;
   typedef ArgumentMapType::value_type          ArgumentMapEntryType;
 
-  /** Support Mevis Dicom Tiff (if selected in cmake) */
-  RegisterMevisDicomTiff();
-
   /** Declare an instance of the Transformix class. */
   TransformixMainPointer transformix;
 
@@ -82,10 +125,18 @@ main(int argc, char ** argv)
   std::string     logFileName = "";
 
   /** Put command line parameters into parameterFileList. */
-  for (unsigned int i = 1; static_cast<long>(i) < argc - 1; i += 2)
+  for (std::size_t i = 0; i + 1 < arguments.size(); i += 2)
   {
-    std::string key(argv[i]);
-    std::string value(argv[i + 1]);
+    const std::string & key = arguments[i];
+    std::string         value = arguments[i + 1];
+
+    /** Reject empty values, like -out "", which would otherwise be used as a path. */
+    if (value.empty())
+    {
+      std::cerr << "ERROR: No value given for CommandLine option \"" << key << "\"!" << std::endl;
+      returndummy |= -1;
+      continue;
+    }
 
     if (key == "-out")
     {
@@ -119,7 +170,7 @@ main(int argc, char ** argv)
   } // end for loop
 
   /** The argv0 argument, required for finding the component.dll/so's. */
-  argMap.insert(ArgumentMapEntryType("-argv0", argv[0]));
+  argMap.insert(ArgumentMapEntryType("-argv0", argv0));
 
   /** Check that the option "-tp" is given. */
   if (argMap.count("-tp") == 0)
@@ -129,16 +180,19 @@ main(int argc, char ** argv)
   }
 
   /** Check that at least one of the following options is given. */
-  if (argMap.count("-in") == 0 && argMap.count("-ipp") == 0 && argMap.count("-def") == 0 && argMap.count("-jac") == 0 &&
-      argMap.count("-jacmat") == 0)
+  if (argMap.count("-in") == 0 && argMap.count("-in0") == 0 && argMap.count("-ipp") == 0 && argMap.count("-def") == 0 &&
+      argMap.count("-jac") == 0 && argMap.count("-jacmat") == 0 && argMap.count("-inv") == 0)
   {
-    std::cerr
-      << "ERROR: At least one of the CommandLine options \"-in\", \"-def\", \"-jac\", or \"-jacmat\" should be given!"
-      << std::endl;
+    std::cerr << "ERROR: At least one of the CommandLine options \"-in\", \"-def\", \"-jac\", \"-jacmat\", or \"-inv\" "
+                 "should be given!"
+              << std::endl;
     returndummy |= -1;
   }
 
-  /** Check if the -out option is given and setup xout. */
+  /** Check if the -out option is given and setup xout. In daemon mode, the xout
+   * manager closes the log file after the job, and resets xout for the next job.
+   */
+  std::unique_ptr<const elx::xoutManager> manager;
   if (outFolderPresent)
   {
     /** Check if the output directory exists. */
@@ -153,12 +207,35 @@ main(int argc, char ** argv)
     {
       /** Setup xout. */
       logFileName = argMap["-out"] + "transformix.log";
-      int returndummy2 = elx::xoutSetup(logFileName.c_str(), true, true);
-      if (returndummy2)
+      if (daemonMode)
+      {
+        try
+        {
+          manager = std::make_unique<const elx::xoutManager>(logFileName, true, false);
+
+          /** The "coutonly" messages, like the progress, are always written to std::cout,
+           * which carries the replies to the jobs in daemon mode. Discard them instead.
+           */
+          static std::ostream nullStream(nullptr);
+          xl::xout["coutonly"].RemoveOutput("cout");
+          xl::xout["coutonly"].AddOutput("cout", &nullStream);
+        }
+        catch (const itk::ExceptionObject & excp)
+        {
+          std::cerr << "ERROR while setting up xout." << std::endl;
+          std::cerr << excp << std::endl;
+          returndummy |= 1;
+        }
+      }
+      else
       {
-        std::cerr << "ERROR while setting up xout." << std::endl;
+        int returndummy2 = elx::xoutSetup(logFileName.c_str(), true, true);
+        if (returndummy2)
+        {
+          std::cerr << "ERROR while setting up xout." << std::endl;
+        }
+        returndummy |= returndummy2;
       }
-      returndummy |= returndummy2;
     }
   }
   else
@@ -181,7 +258,7 @@ main(int argc, char ** argv)
   elxout << "transformix is started at " << GetCurrentDateAndTime() << ".\n" << std::endl;
 
   /** Print where transformix was run. */
-  elxout << "which transformix:   " << argv[0] << std::endl;
+  elxout << "which transformix:   " << argv0 << std::endl;
   itksys::SystemInformation info;
   info.RunCPUCheck();
   info.RunOSCheck();
@@ -223,7 +300,113 @@ main(int argc, char ** argv)
   /** Exit and return the error code. */
   return returndummy;
 
-} // end main
+} // end RunTransformix()
+
+
+/**
+ * *********************** RunTransformixDaemon ****************************
+ *
+ * Reads jobs from std::cin, one per line, until the end of the input or a
+ * line "quit". Replies to each job with a line "done <exit code>".
+ */
+
+int
+RunTransformixDaemon(const std::string & argv0)
+{
+  /** Support Mevis Dicom Tiff (if selected in cmake) */
+  RegisterMevisDicomTiff();
+
+  /** A job with "-threads" sets the global maximum number of threads of ITK, which would
+   * otherwise also apply to all later jobs. Save the settings, to restore them after each job.
+   */
+  const auto globalMaximumNumberOfThreads = itk::MultiThreaderBase::GetGlobalMaximumNumberOfThreads();
+  const auto globalDefaultNumberOfThreads = itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads();
+
+  std::string line;
+  while (std::getline(std::cin, line))
+  {
+    const std::vector<std::string> arguments = SplitJobArguments(line);
+
+    /** Skip empty lines and comments. */
+    if (arguments.empty() || (!arguments.front().empty() && arguments.front().front() == '#'))
+    {
+      continue;
+    }
+    if (arguments.size() == 1 && arguments.front() == "quit")
+    {
+      break;
+    }
+
+    int returndummy = 0;
+    try
+    {
+      returndummy = RunTransformix(arguments, argv0, true);
+    }
+    catch (const std::exception & excp)
+    {
+      std::cerr << "ERROR: " << excp.what() << std::endl;
+      returndummy = 1;
+    }
+
+    /** Restore the maximum first, as it also limits the default number of threads. */
+    itk::MultiThreaderBase::SetGlobalMaximumNumberOfThreads(globalMaximumNumberOfThreads);
+    itk::MultiThreaderBase::SetGlobalDefaultNumberOfThreads(globalDefaultNumberOfThreads);
+
+    /** Flush, so that the client does not wait for the reply. */
+    std::cout << "done " << returndummy << std::endl;
+  }
+
+  return 0;
+
+} // end RunTransformixDaemon()
+
+
+/**
+ * *********************** SplitJobArguments ****************************
+ *
+ * Splits a job line into arguments, separated by white space. Double quotes
+ * group an argument that contains white space, like a path.
+ */
+
+std::vector<std::string>
+SplitJobArguments(const std::string & line)
+{
+  std::vector<std::string> arguments;
+  std::string              argument;
+  bool                     inArgument = false;
+  bool                     inQuotes = false;
+
+  for (const char c : line)
+  {
+    if (c == '"')
+    {
+      inQuotes = !inQuotes;
+      inArgument = true;
+    }
+    else if (!inQuotes && std::isspace(static_cast<unsigned char>(c)))
+    {
+      if (inArgument)
+      {
+        arguments.push_back(argument);
+        argument.clear();
+        inArgument = false;
+      }
+    }
+    else
+    {
+      argument += c;
+      inArgument = true;
+    }
+  }
+  if (inArgument)
+  {
+    arguments.push_back(argument);
+  }
+  return arguments;
+
+} // end SplitJobArguments()
+
+} // end unnamed namespace
 
 
 /**
@@ -241,7 +424,8 @@ PrintHelp(void)
                "generates a deformation field.\n"
             << "The transform is specified in the transform-parameter file.\n"
             << "  --help, -h displays this message and exit\n"
-            << "  --version  output version information and exit\n\n";
+            << "  --version  output version information and exit\n"
+            << "  -daemon    keep running, and read jobs from the standard input, one per line\n\n";
 
   /** Mandatory arguments. */
   std::cout << "Call transformix from the command line with mandatory arguments:\n"
@@ -251,6 +435,8 @@ PrintHelp(void)
   /** Optional arguments. */
   std::cout << "Optional extra commands:\n"
             << "  -in       input image to deform\n"
+            << "            use \"-in0\", \"-in1\", ... to deform several images in a single pass;\n"
+            << "            these are written to result.0, result.1, ...\n"
             << "  -def      file containing input-image points; the point are transformed\n"
             << "            according to the specified transform-parameter file\n"
             << "            use \"-def all\" to transform all points from the input-image, which\n"
@@ -259,10 +445,21 @@ PrintHelp(void)
             << "            spatial Jacobian\n"
             << "  -jacmat   use \"-jacmat all\" to generate an image with the spatial Jacobian\n"
             << "            matrix at each voxel\n"
+            << "  -inv      use \"-inv all\" to generate the deformation field of the inverse\n"
+            << "            transform, on the grid of the fixed image\n"
             << "  -priority set the process priority to high, abovenormal, normal (default),\n"
             << "            belownormal, or idle (Windows only option)\n"
             << "  -threads  set the maximum number of threads of transformix\n"
-            << "\nAt least one of the options \"-in\", \"-def\", \"-jac\", or \"-jacmat\" should be given.\n\n";
+            << "\nAt least one of the options \"-in\", \"-def\", \"-jac\", \"-jacmat\", or \"-inv\" should be "
+               "given.\n\n";
+
+  /** The daemon mode. */
+  std::cout << "In daemon mode, transformix stays resident, so that the components are only loaded once. "
+               "Each line of the standard input is a job, with the arguments of a transformix call, "
+               "like \"-in image.mhd -out outDir -tp TransformParameters.0.txt\". Arguments with spaces "
+               "can be put between double quotes. For each job, transformix writes a line \"done <exit code>\" "
+               "to the standard output, and the messages of the job to the log file in its output directory. "
+               "The line \"quit\" or the end of the input stops transformix.\n\n";
 
   /** The parameter file. */
   std::cout << "The transform-parameter file must contain all the information "
@@ -0,0 +1,82 @@
+import sys, subprocess
+import os
+import os.path
+import re
+from optparse import OptionParser
+
+#-------------------------------------------------------------------------------
+# the main function
+# Below we run transformix in daemon mode with a few jobs on its standard input,
+# and check that its standard output only contains the replies "done <exit code>",
+# one for each job, so that a client can rely on the protocol.
+
+def main():
+  # usage, parse parameters
+  usage = "usage: %prog [options] arg";
+  parser = OptionParser( usage );
+
+  # options to control files
+  parser.add_option( "-d", "--directory", dest="directory", help="output directory" );
+  parser.add_option( "-i", "--input", dest="input", help="input image" );
+  parser.add_option( "-t", "--tp", dest="tp", help="transform parameter file" );
+  parser.add_option( "-p", "--path", dest="path", help="the transformix executable" );
+
+  (options, args) = parser.parse_args();
+
+  # Check if the options are given
+  if options.directory == None :
+    parser.error( "The option directory (-d) should be given" );
+  if options.input == None :
+    parser.error( "The option input (-i) should be given" );
+  if options.tp == None :
+    parser.error( "The option tp (-t) should be given" );
+  if options.path == None :
+    parser.error( "The option path (-p) should be given" );
+
+  # Two valid jobs, a comment, a job with an empty quoted argument, which fails,
+  # and the quit command. The output directories must exist.
+  outputDirs = [ os.path.join( options.directory, str( i ) ) for i in range( 2 ) ];
+  for outputDir in outputDirs :
+    if not os.path.exists( outputDir ) : os.makedirs( outputDir );
+
+  jobs = "";
+  for outputDir in outputDirs :
+    jobs += "-in \"" + options.input + "\" -out \"" + outputDir + "\" -tp \"" + options.tp + "\"\n";
+  jobs += "# a comment\n";
+  jobs += "\"\" -out \"" + outputDirs[ 0 ] + "\"\n";
+  jobs += "quit\n";
+  expectedSuccess = [ True, True, False ];
+
+  process = subprocess.Popen( [ options.path, "-daemon" ],
+    stdin=subprocess.PIPE, stdout=subprocess.PIPE, stderr=subprocess.PIPE );
+  (stdoutData, stderrData) = process.communicate( jobs.encode( "utf-8" ) );
+  lines = stdoutData.decode( "utf-8" ).split( "\n" );
+  if lines and lines[ -1 ] == "" : lines.pop();
+
+  # Check the standard output, line by line
+  if process.returncode != 0 :
+    print( "FAILURE: transformix -daemon returned " + str( process.returncode ) );
+    return 1;
+  if len( lines ) != len( expectedSuccess ) :
+    print( "FAILURE: expected " + str( len( expectedSuccess ) ) + " replies, got:" );
+    print( repr( lines ) );
+    return 1;
+  for line, success in zip( lines, expectedSuccess ) :
+    match = re.match( r"^done (-?\d+)$", line );
+    if match == None :
+      print( "FAILURE: the standard output contains " + repr( line ) );
+      return 1;
+    if ( int( match.group( 1 ) ) == 0 ) != success :
+      print( "FAILURE: unexpected reply " + repr( line ) );
+      return 1;
+  for outputDir in outputDirs :
+    if not os.path.exists( os.path.join( outputDir, "transformix.log" ) ) :
+      print( "FAILURE: no log file in " + outputDir );
+      return 1;
+
+  print( "SUCCESS: the standard output only contains the replies" );
+  return 0;
+
+#-------------------------------------------------------------------------------
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,184 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "AdvancedMeanSquares/itkAdvancedMeanSquaresImageToImageMetric.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkBSplineInterpolateImageFunction.h"
+#include "itkImageRandomSampler.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <cmath>
+#include <iomanip>
+#include <vector>
+
+//-------------------------------------------------------------------------------------
+// This test measures the time per iteration of the multi-threaded AdvancedMeanSquares
+// metric for a small number of samples, as used by stochastic optimizers, for each
+// multi-threader and an increasing number of threads. With few samples the time
+// per iteration is dominated by the overhead of launching the threads. That the
+// results do not depend on the threader is tested by the CommonGTest.
+
+int
+main()
+{
+  const unsigned int Dimension = 3;
+  const unsigned int SplineOrder = 3;
+
+  /** The number of evaluations of GetValueAndDerivative(). Distinguish between
+   * Debug and Release mode.
+   */
+#ifndef NDEBUG
+  const unsigned int N = 20;
+#else
+  const unsigned int N = 500;
+#endif
+  const unsigned long numberOfSamples = 2000;
+  std::cerr << "N = " << N << ", number of samples = " << numberOfSamples << std::endl;
+
+  /** Typedefs. */
+  typedef itk::Image<float, Dimension>                                            ImageType;
+  typedef itk::AdvancedMeanSquaresImageToImageMetric<ImageType, ImageType>        MetricType;
+  typedef MetricType::MeasureType                                                 MeasureType;
+  typedef MetricType::DerivativeType                                              DerivativeType;
+  typedef MetricType::ThreaderType                                                ThreaderType;
+  typedef MetricType::ThreaderEnum                                                ThreaderEnum;
+  typedef itk::BSplineInterpolateImageFunction<ImageType, double>                 InterpolatorType;
+  typedef itk::ImageRandomSampler<ImageType>                                      SamplerType;
+  typedef itk::AdvancedBSplineDeformableTransform<double, Dimension, SplineOrder> TransformType;
+  typedef TransformType::ParametersType                                           ParametersType;
+  typedef TransformType::ImageType                                                GridImageType;
+
+  /** Create smooth fixed and moving images of 64^3 voxels. */
+  ImageType::SizeType imageSize;
+  imageSize.Fill(64);
+  const auto createImage = [&imageSize](const double shift) {
+    auto image = ImageType::New();
+    image->SetRegions(imageSize);
+    image->Allocate();
+    itk::ImageRegionIteratorWithIndex<ImageType> it(image, image->GetBufferedRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      const ImageType::IndexType index = it.GetIndex();
+      double                     value = 100.0;
+      for (unsigned int d = 0; d < Dimension; ++d)
+      {
+        value *= std::cos((index[d] - shift) / 10.0);
+      }
+      it.Set(static_cast<float>(value));
+    }
+    return image;
+  };
+  const auto fixedImage = createImage(0.0);
+  const auto movingImage = createImage(1.5);
+
+  /** Create a B-spline transform covering the image with smoothly varying coefficients. */
+  auto                         transform = TransformType::New();
+  GridImageType::RegionType    gridRegion;
+  GridImageType::SizeType      gridSize;
+  GridImageType::SpacingType   gridSpacing;
+  GridImageType::PointType     gridOrigin;
+  GridImageType::DirectionType gridDirection;
+  gridSize.Fill(11);
+  gridRegion.SetSize(gridSize);
+  gridSpacing.Fill(8.0);
+  gridOrigin.Fill(-8.0);
+  gridDirection.SetIdentity();
+  transform->SetGridRegion(gridRegion);
+  transform->SetGridSpacing(gridSpacing);
+  transform->SetGridOrigin(gridOrigin);
+  transform->SetGridDirection(gridDirection);
+
+  ParametersType parameters(transform->GetNumberOfParameters());
+  for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+  {
+    parameters[i] = std::sin(0.37 * i);
+  }
+  transform->SetParameters(parameters);
+
+  /** Create and initialize the metric. */
+  auto interpolator = InterpolatorType::New();
+  interpolator->SetSplineOrder(1);
+  auto sampler = SamplerType::New();
+  sampler->SetNumberOfSamples(numberOfSamples);
+  auto metric = MetricType::New();
+  metric->SetFixedImage(fixedImage);
+  metric->SetMovingImage(movingImage);
+  metric->SetFixedImageRegion(fixedImage->GetBufferedRegion());
+  metric->SetTransform(transform);
+  metric->SetInterpolator(interpolator);
+  metric->SetImageSampler(sampler);
+  metric->SetUseMultiThread(true);
+
+  /** The threaders to compare. */
+  std::vector<ThreaderEnum> threaderTypes{ ThreaderEnum::Platform, ThreaderEnum::Pool };
+#ifdef ITK_USE_TBB
+  threaderTypes.push_back(ThreaderEnum::TBB);
+#endif
+
+  /** The numbers of threads to compare. */
+  const itk::ThreadIdType maximumNumberOfThreads = ThreaderType::GetGlobalDefaultNumberOfThreads();
+  std::vector<itk::ThreadIdType> numbersOfThreads;
+  for (itk::ThreadIdType numberOfThreads = 1; numberOfThreads < maximumNumberOfThreads; numberOfThreads *= 2)
+  {
+    numbersOfThreads.push_back(numberOfThreads);
+  }
+  numbersOfThreads.push_back(maximumNumberOfThreads);
+
+  /** Time the evaluations for all combinations. */
+  std::cerr << std::setprecision(4) << std::fixed;
+  std::cerr << "threader  threads  time/iteration (ms)" << std::endl;
+  for (const auto threaderType : threaderTypes)
+  {
+    for (const auto numberOfThreads : numbersOfThreads)
+    {
+      metric->SetMultiThreaderType(threaderType);
+      metric->SetNumberOfWorkUnits(numberOfThreads);
+      try
+      {
+        metric->Initialize();
+      }
+      catch (const itk::ExceptionObject & excp)
+      {
+        std::cerr << excp << std::endl;
+        return 1;
+      }
+
+      /** Warm up, which also lets the pool threaders start their threads. */
+      MeasureType    value = 0.0;
+      DerivativeType derivative;
+      metric->GetValueAndDerivative(parameters, value, derivative);
+
+      itk::TimeProbe timeProbe;
+      timeProbe.Start();
+      for (unsigned int i = 0; i < N; ++i)
+      {
+        metric->GetValueAndDerivative(parameters, value, derivative);
+      }
+      timeProbe.Stop();
+
+      std::cerr << std::setw(8) << ThreaderType::ThreaderTypeToString(threaderType) << std::setw(9)
+                << metric->GetNumberOfWorkUnits() << std::setw(21) << 1000.0 * timeProbe.GetTotal() / N << std::endl;
+    }
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main
@@ -16,14 +16,18 @@
  *
  *=========================================================================*/
 #include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkRecursiveBSplineTransform.h"
 
 #include "itkImageRegionIterator.h"
 
 // Report timings
 #include "itkTimeProbe.h"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <iomanip>
+#include <vector>
 
 //-------------------------------------------------------------------------------------
 // Create a class that inherits from the B-spline transform,
@@ -156,6 +160,7 @@ public:
 };
 
 // end class BSplineTransform_TEST
+
 } // end namespace itk
 
 //-------------------------------------------------------------------------------------
@@ -190,6 +195,7 @@ main(int argc, char * argv[])
 
   /** Typedefs. */
   typedef itk::BSplineTransform_TEST<CoordinateRepresentationType, Dimension, SplineOrder> TransformType;
+  typedef itk::RecursiveBSplineTransform<CoordinateRepresentationType, Dimension, SplineOrder> RecursiveTransformType;
 
   typedef TransformType::InputPointType  InputPointType;
   typedef TransformType::OutputPointType OutputPointType;
@@ -297,6 +303,61 @@ main(int argc, char * argv[])
   std::cerr << "Time NEW = " << newTime << " " << timeProbeNEW.GetUnit() << std::endl;
   std::cerr << "Speedup factor = " << oldTime / newTime << std::endl;
 
+  /** Time the recursive TransformPoint with the interleaved coefficients and with the
+   * coefficient image of each dimension. The points are spread over the grid, so that
+   * the coefficients are not all in the cache, as during a registration.
+   */
+  auto recursiveTransform = RecursiveTransformType::New();
+  recursiveTransform->SetGridOrigin(gridOrigin);
+  recursiveTransform->SetGridSpacing(gridSpacing);
+  recursiveTransform->SetGridRegion(gridRegion);
+  recursiveTransform->SetGridDirection(gridDirection);
+  recursiveTransform->SetParameters(parameters);
+  recursiveTransform->UseInterleavedCoefficientsOn();
+
+  std::vector<InputPointType> inputPoints(10000);
+  for (unsigned int i = 0; i < inputPoints.size(); ++i)
+  {
+    for (unsigned int d = 0; d < Dimension; ++d)
+    {
+      const double extent = gridSpacing[d] * (gridSize[d] - 1);
+      inputPoints[i][d] = gridOrigin[d] + extent * std::fmod(0.6180339887 * (i + 1) * (d + 2), 1.0);
+    }
+  }
+
+  OutputPointType    outputPoint;
+  const unsigned int numberOfPasses = std::max(N / static_cast<unsigned int>(inputPoints.size()), 1u);
+  itk::TimeProbe     timeProbeInterleaved, timeProbeImages;
+
+  timeProbeInterleaved.Start();
+  for (unsigned int k = 0; k < numberOfPasses; ++k)
+  {
+    for (unsigned int i = 0; i < inputPoints.size(); ++i)
+    {
+      outputPoint = recursiveTransform->TransformPoint(inputPoints[i]);
+    }
+  }
+  timeProbeInterleaved.Stop();
+
+  recursiveTransform->SetUseInterleavedCoefficients(false);
+  timeProbeImages.Start();
+  for (unsigned int k = 0; k < numberOfPasses; ++k)
+  {
+    for (unsigned int i = 0; i < inputPoints.size(); ++i)
+    {
+      outputPoint = recursiveTransform->TransformPoint(inputPoints[i]);
+    }
+  }
+  timeProbeImages.Stop();
+
+  const double interleavedTime = timeProbeInterleaved.GetMean();
+  const double imagesTime = timeProbeImages.GetMean();
+  std::cerr << "Time recursive, coefficient images = " << imagesTime << " " << timeProbeImages.GetUnit() << std::endl;
+  std::cerr << "Time recursive, interleaved coefficients = " << interleavedTime << " "
+            << timeProbeInterleaved.GetUnit() << std::endl;
+  std::cerr << "Speedup factor = " << imagesTime / interleavedTime << std::endl;
+  std::cerr << "Last output point = " << outputPoint << std::endl;
+
   /** Return a value. */
   return 0;
 
@@ -0,0 +1,133 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkGaussianShrinkImageFilter.h"
+#include "itkSmoothingRecursiveGaussianImageFilter.h"
+#include "itkResampleImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <cmath>
+#include <iomanip>
+
+//-------------------------------------------------------------------------------------
+// This test computes a pyramid level of a 3D image of 160^3 voxels, rescaled by a factor
+// of 4 with the default sigma of 0.5 * factor * spacing, as the generic pyramid does.
+// It compares the time of a SmoothingRecursiveGaussianImageFilter followed by a
+// ResampleImageFilter, which smooths the image at full resolution, with the
+// GaussianShrinkImageFilter, which smooths and rescales in one filter. That both give
+// nearly the same images away from the border is tested by the CommonGTest.
+
+int
+main()
+{
+  const unsigned int Dimension = 3;
+  const unsigned int Factor = 4;
+
+  /** The image size. Distinguish between Debug and Release mode. */
+#ifndef NDEBUG
+  const unsigned int imageSize = 48;
+#else
+  const unsigned int imageSize = 160;
+#endif
+  std::cerr << "Image size = " << imageSize << ", rescale factor = " << Factor << std::endl;
+
+  /** Typedefs. */
+  typedef itk::Image<float, Dimension>                                     ImageType;
+  typedef itk::SmoothingRecursiveGaussianImageFilter<ImageType, ImageType> SmootherType;
+  typedef itk::ResampleImageFilter<ImageType, ImageType>                   ResamplerType;
+  typedef itk::GaussianShrinkImageFilter<ImageType, ImageType>             GaussianShrinkerType;
+
+  /** Create a smooth input image with a high frequency pattern on top. */
+  ImageType::SizeType size;
+  size.Fill(imageSize);
+  auto image = ImageType::New();
+  image->SetRegions(size);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, image->GetLargestPossibleRegion());
+  for (; !it.IsAtEnd(); ++it)
+  {
+    const ImageType::IndexType index = it.GetIndex();
+    const double               wave = std::sin(index[0] / 7.0) * std::cos(index[1] / 11.0);
+    const double               value = 500.0 + 200.0 * wave + 2.0 * index[2];
+    it.Set(static_cast<float>(value + 50.0 * std::sin(2.3 * index[0] + 1.1 * index[1] + 0.7 * index[2])));
+  }
+
+  /** The output grid of the level. */
+  ImageType::SizeType                  outputSize;
+  ImageType::SpacingType               outputSpacing;
+  ImageType::PointType                 outputOrigin;
+  GaussianShrinkerType::SigmaArrayType sigmaArray;
+  for (unsigned int d = 0; d < Dimension; ++d)
+  {
+    outputSize[d] = imageSize / Factor;
+    outputSpacing[d] = Factor;
+    outputOrigin[d] = 0.5 * (Factor - 1.0);
+    sigmaArray[d] = 0.5 * Factor;
+  }
+
+  /** Smooth at full resolution, then resample. */
+  auto smoother = SmootherType::New();
+  smoother->SetInput(image);
+  smoother->SetSigmaArray(sigmaArray);
+  auto resampler = ResamplerType::New();
+  resampler->SetInput(smoother->GetOutput());
+  resampler->SetSize(outputSize);
+  resampler->SetOutputSpacing(outputSpacing);
+  resampler->SetOutputOrigin(outputOrigin);
+
+  /** Smooth and rescale in one filter. */
+  auto gaussianShrinker = GaussianShrinkerType::New();
+  gaussianShrinker->SetInput(image);
+  gaussianShrinker->SetSigmaArray(sigmaArray);
+  gaussianShrinker->SetSize(outputSize);
+  gaussianShrinker->SetOutputSpacing(outputSpacing);
+  gaussianShrinker->SetOutputOrigin(outputOrigin);
+
+  itk::TimeProbe timeProbeSeparate, timeProbeFused;
+  try
+  {
+    timeProbeSeparate.Start();
+    resampler->Update();
+    timeProbeSeparate.Stop();
+
+    timeProbeFused.Start();
+    gaussianShrinker->Update();
+    timeProbeFused.Stop();
+  }
+  catch (const itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return 1;
+  }
+
+  /** Report. The separate filters also store the smoothed image at full resolution. */
+  std::cerr << std::fixed << std::setprecision(3);
+  std::cerr << "Time (s):" << std::endl;
+  std::cerr << "  Smooth and resample: " << timeProbeSeparate.GetTotal() << std::endl;
+  std::cerr << "  Gaussian shrink:     " << timeProbeFused.GetTotal() << std::endl;
+  std::cerr << "Speedup factor = " << timeProbeSeparate.GetTotal() / timeProbeFused.GetTotal() << std::endl;
+  std::cerr << "Full resolution intermediate image (MB): "
+            << image->GetLargestPossibleRegion().GetNumberOfPixels() * sizeof(float) / 1048576.0 << std::endl;
+
+  /** Return a value. */
+  return 0;
+
+} // end main
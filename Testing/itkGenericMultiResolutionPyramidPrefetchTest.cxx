@@ -0,0 +1,121 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkGenericMultiResolutionPyramidImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <iomanip>
+
+//-------------------------------------------------------------------------------------
+// This test computes a 4-level pyramid of a 3D image of 160^3 voxels, level by level, as
+// elastix does with (ComputePyramidImagesPerResolution "true"). It compares the pyramid
+// that computes each level when the level is increased, with the pyramid that
+// prefetches the next level in the background. The work of a resolution is simulated
+// by computing the level of the other pyramid, during which the prefetch can run.
+// The time spent in switching levels is reported. The prefetched levels must have been
+// used, otherwise the comparison is meaningless. The equality of the images is tested
+// by itkGenericMultiResolutionPyramidImageFilterGTest.
+
+int
+main()
+{
+  const unsigned int Dimension = 3;
+  const unsigned int NumberOfLevels = 4;
+
+  /** The image size. Distinguish between Debug and Release mode. */
+#ifndef NDEBUG
+  const unsigned int imageSize = 48;
+#else
+  const unsigned int imageSize = 160;
+#endif
+  std::cerr << "Image size = " << imageSize << ", number of levels = " << NumberOfLevels << std::endl;
+
+  /** Typedefs. */
+  typedef itk::Image<short, Dimension>                                                   InputImageType;
+  typedef itk::Image<float, Dimension>                                                   OutputImageType;
+  typedef itk::GenericMultiResolutionPyramidImageFilter<InputImageType, OutputImageType> PyramidType;
+
+  /** Create an input image with a varying pattern. */
+  InputImageType::SizeType size;
+  size.Fill(imageSize);
+  auto image = InputImageType::New();
+  image->SetRegions(size);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<InputImageType> it(image, image->GetLargestPossibleRegion());
+  for (; !it.IsAtEnd(); ++it)
+  {
+    const InputImageType::IndexType & index = it.GetIndex();
+    it.Set(static_cast<short>((7 * index[0] * index[0] + 13 * index[1] + 29 * index[2]) % 1000));
+  }
+
+  /** Two pyramids computing a level per resolution, one of which prefetches. */
+  auto pyramid = PyramidType::New();
+  auto prefetchingPyramid = PyramidType::New();
+  for (const auto & filter : { pyramid, prefetchingPyramid })
+  {
+    filter->SetInput(image);
+    filter->SetNumberOfLevels(NumberOfLevels);
+    filter->SetComputeOnlyForCurrentLevel(true);
+  }
+  prefetchingPyramid->SetPrefetchNextLevel(true);
+
+  itk::TimeProbe timeProbe, timeProbePrefetch;
+  try
+  {
+    for (unsigned int level = 0; level < NumberOfLevels; ++level)
+    {
+      /** Switch the prefetching pyramid to the next level. */
+      timeProbePrefetch.Start();
+      prefetchingPyramid->SetCurrentLevel(level);
+      prefetchingPyramid->Update();
+      timeProbePrefetch.Stop();
+
+      /** Switch the other pyramid, while the next level is prefetched. */
+      timeProbe.Start();
+      pyramid->SetCurrentLevel(level);
+      pyramid->Update();
+      timeProbe.Stop();
+    }
+  }
+  catch (const itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return 1;
+  }
+
+  /** Report. */
+  std::cerr << std::fixed << std::setprecision(3);
+  std::cerr << "Time spent in switching levels (s):" << std::endl;
+  std::cerr << "  Per resolution: " << timeProbe.GetTotal() << std::endl;
+  std::cerr << "  Prefetched:     " << timeProbePrefetch.GetTotal() << std::endl;
+  std::cerr << "Prefetched levels used: " << prefetchingPyramid->GetNumberOfPrefetchedLevelsUsed() << std::endl;
+
+  /** All levels but the first should have been grafted from the prefetch. */
+  if (prefetchingPyramid->GetNumberOfPrefetchedLevelsUsed() != NumberOfLevels - 1)
+  {
+    std::cerr << "ERROR: the prefetched levels were not used." << std::endl;
+    return 1;
+  }
+
+  /** Return a value. */
+  return 0;
+
+} // end main
@@ -0,0 +1,175 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkInterleavedValueAndGradientImageFunction.h"
+#include "itkAdvancedLinearInterpolateImageFunction.h"
+#include "itkNearestNeighborInterpolateImageFunction.h"
+#include "itkGradientImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <cmath>
+#include <iomanip>
+#include <vector>
+
+//-------------------------------------------------------------------------------------
+// This test compares the time to evaluate the moving image value and gradient at scattered
+// positions of a 3D image, as done by the AdvancedImageToImageMetric for each sample:
+// \li with the AdvancedLinearInterpolateImageFunction, which computes both from the
+//     8 neighboring voxels, as reference;
+// \li with a nearest neighbor interpolator and a separate central difference gradient
+//     image, which is what the metric does for other interpolators;
+// \li with the InterleavedValueAndGradientImageFunction, which reads both from a single
+//     interleaved cache.
+// That the last two give the same results is tested by the CommonGTest.
+
+int
+main()
+{
+  const unsigned int Dimension = 3;
+  typedef float      PixelType;
+  typedef double     CoordinateRepresentationType;
+
+  /** The number of repetitions. Distinguish between Debug and Release mode. */
+#ifndef NDEBUG
+  const unsigned int N = 2;
+#else
+  const unsigned int N = 20;
+#endif
+  const unsigned int numberOfPoints = 1000000;
+  std::cerr << "N = " << N << ", number of points = " << numberOfPoints << std::endl;
+
+  /** Typedefs. */
+  typedef itk::Image<PixelType, Dimension>                                                       ImageType;
+  typedef itk::AdvancedLinearInterpolateImageFunction<ImageType, CoordinateRepresentationType>   LinearType;
+  typedef itk::NearestNeighborInterpolateImageFunction<ImageType, CoordinateRepresentationType>  NearestType;
+  typedef itk::InterleavedValueAndGradientImageFunction<ImageType, CoordinateRepresentationType> InterleavedType;
+  typedef itk::GradientImageFilter<ImageType, double, double>                                    GradientFilterType;
+  typedef GradientFilterType::OutputImageType                                                    GradientImageType;
+  typedef LinearType::ContinuousIndexType                                                        ContinuousIndexType;
+  typedef InterleavedType::CovariantVectorType                                                   CovariantVectorType;
+
+  /** Create a smooth image of 128^3 voxels, with a non-unit spacing. */
+  ImageType::SizeType imageSize;
+  imageSize.Fill(128);
+  ImageType::SpacingType spacing;
+  spacing[0] = 0.8;
+  spacing[1] = 0.9;
+  spacing[2] = 1.5;
+  auto image = ImageType::New();
+  image->SetRegions(imageSize);
+  image->SetSpacing(spacing);
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, image->GetBufferedRegion());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    const ImageType::IndexType index = it.GetIndex();
+    double                     value = 100.0;
+    for (unsigned int d = 0; d < Dimension; ++d)
+    {
+      value *= std::cos(index[d] / 10.0);
+    }
+    it.Set(static_cast<PixelType>(value));
+  }
+
+  /** Set up the three alternatives. */
+  auto linear = LinearType::New();
+  linear->SetInputImage(image);
+  auto nearest = NearestType::New();
+  nearest->SetInputImage(image);
+  auto gradientFilter = GradientFilterType::New();
+  gradientFilter->SetUseImageSpacing(true);
+  gradientFilter->SetInput(image);
+  gradientFilter->Update();
+  const GradientImageType * gradientImage = gradientFilter->GetOutput();
+
+  itk::TimeProbe timeProbeBuild;
+  timeProbeBuild.Start();
+  auto interleaved = InterleavedType::New();
+  interleaved->SetInputImage(image);
+  timeProbeBuild.Stop();
+
+  /** Create scattered points inside the image, in an order that does not follow the memory layout. */
+  const double                     steps[Dimension] = { 0.6180339887, 0.7548776662, 0.5698402910 };
+  std::vector<ContinuousIndexType> points(numberOfPoints);
+  for (unsigned int i = 0; i < numberOfPoints; ++i)
+  {
+    for (unsigned int d = 0; d < Dimension; ++d)
+    {
+      points[i][d] = (imageSize[d] - 1.0) * std::fmod(steps[d] * i, 1.0);
+    }
+  }
+
+  /** Time the evaluations. Accumulate the results, so that they are not optimized away. */
+  double              sumLinear = 0.0, sumSeparate = 0.0, sumInterleaved = 0.0;
+  itk::TimeProbe      timeProbeLinear, timeProbeSeparate, timeProbeInterleaved;
+  CovariantVectorType gradient;
+  double              value = 0.0;
+  for (unsigned int i = 0; i < N; ++i)
+  {
+    timeProbeLinear.Start();
+    for (const auto & point : points)
+    {
+      linear->EvaluateValueAndDerivativeAtContinuousIndex(point, value, gradient);
+      sumLinear += value + gradient[0];
+    }
+    timeProbeLinear.Stop();
+
+    timeProbeSeparate.Start();
+    for (const auto & point : points)
+    {
+      value = nearest->EvaluateAtContinuousIndex(point);
+      ImageType::IndexType index;
+      for (unsigned int d = 0; d < Dimension; ++d)
+      {
+        index[d] = static_cast<long>(itk::Math::Round<double>(point[d]));
+      }
+      gradient = gradientImage->GetPixel(index);
+      sumSeparate += value + gradient[0];
+    }
+    timeProbeSeparate.Stop();
+
+    timeProbeInterleaved.Start();
+    for (const auto & point : points)
+    {
+      interleaved->EvaluateValueAndDerivativeAtContinuousIndex(point, value, gradient);
+      sumInterleaved += value + gradient[0];
+    }
+    timeProbeInterleaved.Stop();
+  }
+
+  /** Report. */
+  const double numberOfEvaluations = static_cast<double>(N) * static_cast<double>(numberOfPoints);
+  std::cerr << std::fixed << std::setprecision(2);
+  std::cerr << "Building the interleaved cache took " << 1000.0 * timeProbeBuild.GetTotal() << " ms" << std::endl;
+  std::cerr << "Linear interpolator:          " << 1e-6 * numberOfEvaluations / timeProbeLinear.GetTotal()
+            << " Mevaluations/s" << std::endl;
+  std::cerr << "Nearest and gradient image:   " << 1e-6 * numberOfEvaluations / timeProbeSeparate.GetTotal()
+            << " Mevaluations/s" << std::endl;
+  std::cerr << "Interleaved cache:            " << 1e-6 * numberOfEvaluations / timeProbeInterleaved.GetTotal()
+            << " Mevaluations/s" << std::endl;
+  std::cerr << "Speedup factor (separate / interleaved) = "
+            << timeProbeSeparate.GetTotal() / timeProbeInterleaved.GetTotal() << std::endl;
+  std::cerr << std::scientific << "Checksums: " << sumLinear << " " << sumSeparate << " " << sumInterleaved
+            << std::endl;
+
+  /** Return a value. */
+  return 0;
+
+} // end main
@@ -0,0 +1,155 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkTransformToInverseDisplacementFieldSource.h"
+#include "itkAdvancedCombinationTransform.h"
+#include "itkAdvancedMatrixOffsetTransformBase.h"
+#include "itkRecursiveBSplineTransform.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <cmath>
+#include <iomanip>
+
+//-------------------------------------------------------------------------------------
+// This test computes the displacement field of the inverse of an affine transform
+// composed with a B-spline transform, on a 3D grid of 96^3 voxels. It compares the
+// inversion in which each point starts at x0 = y, with the inversion that starts at
+// the interpolated coarse inverse, and reports the time, the mean number of
+// iterations and the residuals. That the field inverts the transform is tested by
+// the CommonGTest.
+
+int
+main()
+{
+  const unsigned int Dimension = 3;
+  const unsigned int SplineOrder = 3;
+  typedef double     CoordinateRepresentationType;
+
+  /** The grid size. Distinguish between Debug and Release mode. */
+#ifndef NDEBUG
+  const unsigned int gridSize = 32;
+#else
+  const unsigned int gridSize = 96;
+#endif
+  const double tolerance = 0.01;
+  std::cerr << "Grid size = " << gridSize << ", tolerance = " << tolerance << std::endl;
+
+  /** Typedefs. */
+  typedef itk::AdvancedCombinationTransform<CoordinateRepresentationType, Dimension>                 CombinationType;
+  typedef itk::AdvancedMatrixOffsetTransformBase<CoordinateRepresentationType, Dimension, Dimension> AffineType;
+  typedef itk::RecursiveBSplineTransform<CoordinateRepresentationType, Dimension, SplineOrder>       BSplineType;
+  typedef BSplineType::ParametersType                                                                ParametersType;
+  typedef BSplineType::ImageType                                                                     GridImageType;
+  typedef itk::Image<itk::Vector<float, Dimension>, Dimension>                                       FieldImageType;
+
+  typedef itk::TransformToInverseDisplacementFieldSource<FieldImageType, CoordinateRepresentationType> InverseType;
+
+  /** Create an affine transform with a rotation of about 10 degrees, scaling and translation. */
+  auto                   affine = AffineType::New();
+  AffineType::MatrixType matrix;
+  matrix(0, 0) = 0.98;
+  matrix(0, 1) = -0.17;
+  matrix(0, 2) = 0.02;
+  matrix(1, 0) = 0.17;
+  matrix(1, 1) = 1.03;
+  matrix(1, 2) = -0.05;
+  matrix(2, 0) = -0.01;
+  matrix(2, 1) = 0.06;
+  matrix(2, 2) = 0.95;
+  AffineType::OutputVectorType translation;
+  translation[0] = 2.5;
+  translation[1] = -1.5;
+  translation[2] = 3.0;
+  AffineType::InputPointType center;
+  center.Fill(gridSize / 2.0);
+  affine->SetCenter(center);
+  affine->SetMatrix(matrix);
+  affine->SetTranslation(translation);
+
+  /** Create a smooth, invertible B-spline deformation with a grid spacing of 16 voxels. */
+  auto                         bspline = BSplineType::New();
+  GridImageType::RegionType    gridRegion;
+  GridImageType::SizeType      bsplineGridSize;
+  GridImageType::SpacingType   gridSpacing;
+  GridImageType::PointType     gridOrigin;
+  GridImageType::DirectionType gridDirection;
+  bsplineGridSize.Fill(gridSize / 16 + 7);
+  gridRegion.SetSize(bsplineGridSize);
+  gridSpacing.Fill(16.0);
+  gridOrigin.Fill(-32.0);
+  gridDirection.SetIdentity();
+  bspline->SetGridRegion(gridRegion);
+  bspline->SetGridSpacing(gridSpacing);
+  bspline->SetGridOrigin(gridOrigin);
+  bspline->SetGridDirection(gridDirection);
+
+  ParametersType parameters(bspline->GetNumberOfParameters());
+  for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+  {
+    parameters[i] = 3.0 * std::sin(0.37 * i);
+  }
+
+  auto initialTransform = CombinationType::New();
+  initialTransform->SetCurrentTransform(affine);
+  auto transform = CombinationType::New();
+  transform->SetInitialTransform(initialTransform);
+  transform->SetCurrentTransform(bspline);
+  transform->SetParameters(parameters);
+
+  /** Invert without and with the coarse inverse. */
+  FieldImageType::SizeType outputSize;
+  double                   timeInMs[2] = { 0.0, 0.0 };
+  outputSize.Fill(gridSize);
+  for (unsigned int useCoarseInverse = 0; useCoarseInverse < 2; ++useCoarseInverse)
+  {
+    auto inverse = InverseType::New();
+    inverse->SetTransform(transform);
+    inverse->SetOutputSize(outputSize);
+    inverse->SetTolerance(tolerance);
+    inverse->SetMaximumNumberOfIterations(50);
+    inverse->SetCoarseGridSpacing(useCoarseInverse == 1 ? 4 : 1);
+
+    itk::TimeProbe timeProbe;
+    timeProbe.Start();
+    try
+    {
+      inverse->Update();
+    }
+    catch (const itk::ExceptionObject & excp)
+    {
+      std::cerr << excp << std::endl;
+      return 1;
+    }
+    timeProbe.Stop();
+    timeInMs[useCoarseInverse] = 1000.0 * timeProbe.GetTotal();
+
+    std::cerr << std::fixed << std::setprecision(3);
+    std::cerr << (useCoarseInverse == 1 ? "Starting at the coarse inverse:" : "Starting at x0 = y:") << std::endl;
+    std::cerr << "  Time (ms): " << timeInMs[useCoarseInverse] << std::endl;
+    std::cerr << "  Mean number of iterations: " << inverse->GetMeanNumberOfIterations() << std::endl;
+    std::cerr << std::scientific << "  Residual: mean " << inverse->GetMeanResidual() << ", maximum "
+              << inverse->GetMaximumResidual() << std::endl;
+    std::cerr << "  Number of non-converged points: " << inverse->GetNumberOfNonConvergedPoints() << std::endl;
+  }
+  std::cerr << std::fixed << "Speedup factor = " << timeInMs[0] / timeInMs[1] << std::endl;
+
+  /** Return a value. */
+  return 0;
+
+} // end main
@@ -0,0 +1,176 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkAdvancedCombinationTransform.h"
+#include "itkAdvancedMatrixOffsetTransformBase.h"
+#include "itkRecursiveBSplineTransform.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <cmath>
+#include <iomanip>
+#include <vector>
+
+//-------------------------------------------------------------------------------------
+// This test measures the most common elastix transform chain: an affine initial
+// transform composed with a B-spline transform. As in elastix, the affine transform
+// is itself the current transform of a combination transform. The composition
+// stores the linear initial transform as a matrix and an offset, so that the
+// TransformPoint() and EvaluateJacobianWithImageGradientProduct() calls of the
+// metric do not call the initial transform. This is compared to evaluating the
+// initial transform and the B-spline transform one after the other. That both give
+// the same results is tested by the CommonGTest.
+
+int
+main()
+{
+  const unsigned int Dimension = 3;
+  const unsigned int SplineOrder = 3;
+  typedef double     CoordinateRepresentationType;
+
+  /** The number of repetitions. Distinguish between Debug and Release mode. */
+#ifndef NDEBUG
+  const unsigned int N = 2;
+#else
+  const unsigned int N = 20;
+#endif
+  const unsigned int numberOfPoints = 100000;
+  std::cerr << "N = " << N << ", number of points = " << numberOfPoints << std::endl;
+
+  /** Typedefs. */
+  typedef itk::AdvancedCombinationTransform<CoordinateRepresentationType, Dimension>                 CombinationType;
+  typedef itk::AdvancedMatrixOffsetTransformBase<CoordinateRepresentationType, Dimension, Dimension> AffineType;
+  typedef itk::RecursiveBSplineTransform<CoordinateRepresentationType, Dimension, SplineOrder>       BSplineType;
+  typedef BSplineType::ParametersType                                                                ParametersType;
+  typedef BSplineType::ImageType                                                                     GridImageType;
+  typedef CombinationType::InputPointType                                                            InputPointType;
+  typedef CombinationType::OutputPointType                                                           OutputPointType;
+  typedef CombinationType::MovingImageGradientType                                                   GradientType;
+  typedef CombinationType::DerivativeType                                                            DerivativeType;
+
+  typedef CombinationType::NonZeroJacobianIndicesType NonZeroJacobianIndicesType;
+
+  /** Create an affine transform with a rotation, scaling and translation. */
+  auto                   affine = AffineType::New();
+  AffineType::MatrixType matrix;
+  matrix(0, 0) = 0.98;
+  matrix(0, 1) = -0.17;
+  matrix(0, 2) = 0.02;
+  matrix(1, 0) = 0.17;
+  matrix(1, 1) = 1.03;
+  matrix(1, 2) = -0.05;
+  matrix(2, 0) = -0.01;
+  matrix(2, 1) = 0.06;
+  matrix(2, 2) = 0.95;
+  AffineType::OutputVectorType translation;
+  translation[0] = 2.5;
+  translation[1] = -1.5;
+  translation[2] = 3.0;
+  AffineType::InputPointType center;
+  center.Fill(50.0);
+  affine->SetCenter(center);
+  affine->SetMatrix(matrix);
+  affine->SetTranslation(translation);
+
+  /** As in elastix, the affine transform is the current transform of the initial combination. */
+  auto initialTransform = CombinationType::New();
+  initialTransform->SetCurrentTransform(affine);
+
+  /** Create a B-spline transform with a grid spacing of 10 and smoothly varying coefficients. */
+  auto                         bspline = BSplineType::New();
+  GridImageType::RegionType    gridRegion;
+  GridImageType::SizeType      gridSize;
+  GridImageType::SpacingType   gridSpacing;
+  GridImageType::PointType     gridOrigin;
+  GridImageType::DirectionType gridDirection;
+  gridSize.Fill(16);
+  gridRegion.SetSize(gridSize);
+  gridSpacing.Fill(10.0);
+  gridOrigin.Fill(-25.0);
+  gridDirection.SetIdentity();
+  bspline->SetGridRegion(gridRegion);
+  bspline->SetGridSpacing(gridSpacing);
+  bspline->SetGridOrigin(gridOrigin);
+  bspline->SetGridDirection(gridDirection);
+
+  ParametersType parameters(bspline->GetNumberOfParameters());
+  for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+  {
+    parameters[i] = 2.0 * std::sin(0.37 * i);
+  }
+
+  auto transform = CombinationType::New();
+  transform->SetInitialTransform(initialTransform);
+  transform->SetCurrentTransform(bspline);
+  transform->SetUseComposition(true);
+  transform->SetParameters(parameters);
+
+  /** Create scattered points and image gradients. */
+  const double                steps[Dimension] = { 0.6180339887, 0.7548776662, 0.5698402910 };
+  std::vector<InputPointType> points(numberOfPoints);
+  std::vector<GradientType>   gradients(numberOfPoints);
+  for (unsigned int i = 0; i < numberOfPoints; ++i)
+  {
+    for (unsigned int d = 0; d < Dimension; ++d)
+    {
+      points[i][d] = 100.0 * std::fmod(steps[d] * i, 1.0);
+      gradients[i][d] = std::cos(0.9 * i + d);
+    }
+  }
+
+  /** Time the calls of the metric, through the combination and one after the other. */
+  const unsigned int         nnzji = transform->GetNumberOfNonZeroJacobianIndices();
+  DerivativeType             imageJacobian(nnzji);
+  NonZeroJacobianIndicesType nzji(nnzji);
+  double                     sumCombined = 0.0, sumSeparate = 0.0;
+  itk::TimeProbe             timeProbeCombined, timeProbeSeparate;
+  for (unsigned int n = 0; n < N; ++n)
+  {
+    timeProbeCombined.Start();
+    for (unsigned int i = 0; i < numberOfPoints; ++i)
+    {
+      const OutputPointType outputPoint = transform->TransformPoint(points[i]);
+      transform->EvaluateJacobianWithImageGradientProduct(points[i], gradients[i], imageJacobian, nzji);
+      sumCombined += outputPoint[0] + imageJacobian[0];
+    }
+    timeProbeCombined.Stop();
+
+    timeProbeSeparate.Start();
+    for (unsigned int i = 0; i < numberOfPoints; ++i)
+    {
+      const OutputPointType initialPoint = initialTransform->TransformPoint(points[i]);
+      const OutputPointType outputPoint = bspline->TransformPoint(initialPoint);
+      bspline->EvaluateJacobianWithImageGradientProduct(initialPoint, gradients[i], imageJacobian, nzji);
+      sumSeparate += outputPoint[0] + imageJacobian[0];
+    }
+    timeProbeSeparate.Stop();
+  }
+
+  /** Report. */
+  const double numberOfEvaluations = static_cast<double>(N) * static_cast<double>(numberOfPoints);
+  std::cerr << std::fixed << std::setprecision(2);
+  std::cerr << "Time per point (ns), TransformPoint and EvaluateJacobianWithImageGradientProduct:" << std::endl;
+  std::cerr << "  Combination:      " << 1e9 * timeProbeCombined.GetTotal() / numberOfEvaluations << std::endl;
+  std::cerr << "  One by the other: " << 1e9 * timeProbeSeparate.GetTotal() / numberOfEvaluations << std::endl;
+  std::cerr << "Speedup factor = " << timeProbeSeparate.GetTotal() / timeProbeCombined.GetTotal() << std::endl;
+  std::cerr << std::scientific << "Checksums: " << sumCombined << " " << sumSeparate << std::endl;
+
+  /** Return a value. */
+  return 0;
+
+} // end main
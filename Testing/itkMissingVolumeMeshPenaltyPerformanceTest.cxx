@@ -0,0 +1,213 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "MissingStructurePenalty/itkMissingStructurePenalty.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkTriangleCell.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <cmath>
+#include <iomanip>
+
+//-------------------------------------------------------------------------------------
+// This test compares the single-threaded and the multi-threaded evaluation
+// of the MissingVolumeMeshPenalty on a closed triangulated sphere of about
+// 100k triangles, deformed by a B-spline transformation. Only the timings are
+// reported; the equality of the results is tested by itkMissingVolumeMeshPenaltyGTest.
+
+int
+main()
+{
+  const unsigned int Dimension = 3;
+  const unsigned int SplineOrder = 3;
+  typedef double     CoordinateRepresentationType;
+
+  /** The number of evaluations of GetValueAndDerivative(). Distinguish between
+   * Debug and Release mode.
+   */
+#ifndef NDEBUG
+  const unsigned int N = 2;
+#else
+  const unsigned int N = 20;
+#endif
+  std::cerr << "N = " << N << std::endl;
+
+  /** Typedefs. */
+  typedef itk::PointSet<CoordinateRepresentationType,
+                        Dimension,
+                        itk::DefaultStaticMeshTraits<CoordinateRepresentationType,
+                                                     Dimension,
+                                                     Dimension,
+                                                     CoordinateRepresentationType,
+                                                     CoordinateRepresentationType,
+                                                     CoordinateRepresentationType>>
+                                                                    PointSetType;
+  typedef itk::MissingVolumeMeshPenalty<PointSetType, PointSetType> MetricType;
+  typedef MetricType::FixedMeshType                                 MeshType;
+  typedef MetricType::CellInterfaceType                             CellInterfaceType;
+  typedef itk::TriangleCell<CellInterfaceType>                      TriangleCellType;
+  typedef MetricType::FixedMeshContainerType                        MeshContainerType;
+  typedef MetricType::MeasureType                                   MeasureType;
+  typedef MetricType::DerivativeType                                DerivativeType;
+
+  typedef itk::AdvancedBSplineDeformableTransform<CoordinateRepresentationType, Dimension, SplineOrder> TransformType;
+  typedef TransformType::ParametersType                                                                  ParametersType;
+  typedef TransformType::ImageType                                                                       GridImageType;
+
+  /** Create a triangulated sphere with radius 100 mm. Latitude rings are connected
+   * to the two poles, which gives 2 * nLon * ( nLat - 1 ) triangles.
+   */
+  const unsigned int nLat = 225;
+  const unsigned int nLon = 224;
+  const double       radius = 100.0;
+  const double       pi = 3.14159265358979323846;
+
+  auto mesh = MeshType::New();
+
+  MeshType::PointIdentifier pointId = 0;
+  MeshType::PointType       point;
+  point[0] = 0.0;
+  point[1] = 0.0;
+  point[2] = radius;
+  mesh->SetPoint(pointId++, point); // north pole
+  for (unsigned int i = 1; i < nLat; ++i)
+  {
+    const double theta = pi * i / nLat;
+    for (unsigned int j = 0; j < nLon; ++j)
+    {
+      const double phi = 2.0 * pi * j / nLon;
+      point[0] = radius * std::sin(theta) * std::cos(phi);
+      point[1] = radius * std::sin(theta) * std::sin(phi);
+      point[2] = radius * std::cos(theta);
+      mesh->SetPoint(pointId++, point);
+    }
+  }
+  point[0] = 0.0;
+  point[1] = 0.0;
+  point[2] = -radius;
+  const MeshType::PointIdentifier southPole = pointId;
+  mesh->SetPoint(pointId++, point);
+
+  const auto ringPoint = [nLon](unsigned int ring, unsigned int j) {
+    return static_cast<MeshType::PointIdentifier>(1 + (ring - 1) * nLon + (j % nLon));
+  };
+
+  MeshType::CellIdentifier cellId = 0;
+  const auto addTriangle = [&mesh, &cellId](const MeshType::PointIdentifier p1,
+                                            const MeshType::PointIdentifier p2,
+                                            const MeshType::PointIdentifier p3) {
+    CellInterfaceType::CellAutoPointer cell;
+    cell.TakeOwnership(new TriangleCellType);
+    cell->SetPointId(0, p1);
+    cell->SetPointId(1, p2);
+    cell->SetPointId(2, p3);
+    mesh->SetCell(cellId++, cell);
+  };
+
+  for (unsigned int j = 0; j < nLon; ++j)
+  {
+    addTriangle(0, ringPoint(1, j), ringPoint(1, j + 1));
+    for (unsigned int i = 1; i < nLat - 1; ++i)
+    {
+      addTriangle(ringPoint(i, j), ringPoint(i + 1, j), ringPoint(i + 1, j + 1));
+      addTriangle(ringPoint(i, j), ringPoint(i + 1, j + 1), ringPoint(i, j + 1));
+    }
+    addTriangle(southPole, ringPoint(nLat - 1, j + 1), ringPoint(nLat - 1, j));
+  }
+  std::cerr << "Number of points = " << mesh->GetNumberOfPoints() << std::endl;
+  std::cerr << "Number of triangles = " << mesh->GetNumberOfCells() << std::endl;
+
+  auto meshContainer = MeshContainerType::New();
+  meshContainer->Reserve(1);
+  meshContainer->SetElement(0, MeshType::ConstPointer(mesh.GetPointer()));
+
+  /** Create a B-spline transform with a grid spacing of 25 mm around the sphere,
+   * and set smoothly varying coefficients.
+   */
+  auto                         transform = TransformType::New();
+  GridImageType::RegionType    gridRegion;
+  GridImageType::SizeType      gridSize;
+  GridImageType::SpacingType   gridSpacing;
+  GridImageType::PointType     gridOrigin;
+  GridImageType::DirectionType gridDirection;
+  gridSize.Fill(14);
+  gridRegion.SetSize(gridSize);
+  gridSpacing.Fill(25.0);
+  gridOrigin.Fill(-1.5 * radius - 25.0);
+  gridDirection.SetIdentity();
+  transform->SetGridRegion(gridRegion);
+  transform->SetGridSpacing(gridSpacing);
+  transform->SetGridOrigin(gridOrigin);
+  transform->SetGridDirection(gridDirection);
+
+  ParametersType parameters(transform->GetNumberOfParameters());
+  for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+  {
+    parameters[i] = 2.0 * std::sin(0.37 * i);
+  }
+  transform->SetParameters(parameters);
+
+  /** Create and initialize the metric. */
+  auto metric = MetricType::New();
+  metric->SetTransform(transform);
+  metric->SetFixedMeshContainer(meshContainer);
+  try
+  {
+    metric->Initialize();
+  }
+  catch (const itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return 1;
+  }
+
+  /** Time the single-threaded and the multi-threaded evaluation. */
+  MeasureType    valueST = 0.0, valueMT = 0.0;
+  DerivativeType derivativeST, derivativeMT;
+  itk::TimeProbe timeProbeST, timeProbeMT;
+
+  metric->SetUseMultiThread(false);
+  timeProbeST.Start();
+  for (unsigned int i = 0; i < N; ++i)
+  {
+    metric->GetValueAndDerivative(parameters, valueST, derivativeST);
+  }
+  timeProbeST.Stop();
+
+  metric->SetUseMultiThread(true);
+  timeProbeMT.Start();
+  for (unsigned int i = 0; i < N; ++i)
+  {
+    metric->GetValueAndDerivative(parameters, valueMT, derivativeMT);
+  }
+  timeProbeMT.Stop();
+
+  /** Report timings. */
+  std::cerr << std::setprecision(4);
+  std::cerr << "Number of threads = " << metric->GetNumberOfWorkUnits() << std::endl;
+  std::cerr << "Time single-threaded = " << timeProbeST.GetTotal() / N << " " << timeProbeST.GetUnit() << std::endl;
+  std::cerr << "Time multi-threaded  = " << timeProbeMT.GetTotal() / N << " " << timeProbeMT.GetUnit() << std::endl;
+  std::cerr << "Speedup factor = " << timeProbeST.GetTotal() / timeProbeMT.GetTotal() << std::endl;
+  std::cerr << std::setprecision(10);
+  std::cerr << "Value single-threaded = " << valueST << ", multi-threaded = " << valueMT << std::endl;
+
+  /** Return a value. */
+  return 0;
+
+} // end main
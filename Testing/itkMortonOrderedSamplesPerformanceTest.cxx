@@ -0,0 +1,167 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "AdvancedMattesMutualInformation/itkParzenWindowMutualInformationImageToImageMetric.h"
+#include "itkRecursiveBSplineTransform.h"
+#include "itkRecursiveBSplineInterpolateImageFunction.h"
+#include "itkImageRandomSampler.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <cmath>
+#include <iomanip>
+
+//-------------------------------------------------------------------------------------
+// This test measures the time per iteration of the mutual information metric with a
+// RecursiveBSplineTransform in 3D, with new random samples in each iteration, as with
+// a stochastic optimizer. The samples are processed in random order, or sorted in
+// Morton order by the sampler, so that consecutive samples, and the blocks of samples
+// of each thread, share B-spline coefficients and moving image cache lines.
+// That sorting does not change the metric, apart from the order of the summation,
+// is tested by the CommonGTest.
+
+int
+main()
+{
+  const unsigned int Dimension = 3;
+  const unsigned int SplineOrder = 3;
+  typedef double     CoordinateRepresentationType;
+
+  /** The number of iterations. Distinguish between Debug and Release mode. */
+#ifndef NDEBUG
+  const unsigned int N = 5;
+#else
+  const unsigned int N = 100;
+#endif
+  const unsigned long numberOfSamples = 20000;
+  std::cerr << "N = " << N << ", number of samples = " << numberOfSamples << std::endl;
+
+  /** Typedefs. */
+  typedef itk::Image<float, Dimension>                                                         ImageType;
+  typedef itk::ParzenWindowMutualInformationImageToImageMetric<ImageType, ImageType>           MetricType;
+  typedef MetricType::MeasureType                                                              MeasureType;
+  typedef MetricType::DerivativeType                                                           DerivativeType;
+  typedef itk::RecursiveBSplineInterpolateImageFunction<ImageType, double, double>             InterpolatorType;
+  typedef itk::ImageRandomSampler<ImageType>                                                   SamplerType;
+  typedef itk::RecursiveBSplineTransform<CoordinateRepresentationType, Dimension, SplineOrder> TransformType;
+  typedef TransformType::ParametersType                                                        ParametersType;
+  typedef TransformType::ImageType                                                             GridImageType;
+
+  /** Create smooth fixed and moving images of 160^3 voxels, which do not fit in the cache. */
+  ImageType::SizeType imageSize;
+  imageSize.Fill(160);
+  const auto createImage = [&imageSize](const double shift) {
+    auto image = ImageType::New();
+    image->SetRegions(imageSize);
+    image->Allocate();
+    itk::ImageRegionIteratorWithIndex<ImageType> it(image, image->GetBufferedRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      const ImageType::IndexType index = it.GetIndex();
+      double                     value = 100.0;
+      for (unsigned int d = 0; d < Dimension; ++d)
+      {
+        value *= std::cos((index[d] - shift) / 15.0);
+      }
+      it.Set(static_cast<float>(value));
+    }
+    return image;
+  };
+  const auto fixedImage = createImage(0.0);
+  const auto movingImage = createImage(2.5);
+
+  /** Create a B-spline transform with a grid spacing of 10 voxels and smoothly varying coefficients. */
+  auto                         transform = TransformType::New();
+  GridImageType::RegionType    gridRegion;
+  GridImageType::SizeType      gridSize;
+  GridImageType::SpacingType   gridSpacing;
+  GridImageType::PointType     gridOrigin;
+  GridImageType::DirectionType gridDirection;
+  gridSize.Fill(20);
+  gridRegion.SetSize(gridSize);
+  gridSpacing.Fill(10.0);
+  gridOrigin.Fill(-10.0);
+  gridDirection.SetIdentity();
+  transform->SetGridRegion(gridRegion);
+  transform->SetGridSpacing(gridSpacing);
+  transform->SetGridOrigin(gridOrigin);
+  transform->SetGridDirection(gridDirection);
+
+  ParametersType parameters(transform->GetNumberOfParameters());
+  for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+  {
+    parameters[i] = 2.0 * std::sin(0.37 * i);
+  }
+  transform->SetParameters(parameters);
+
+  /** Create and initialize the metric. */
+  auto interpolator = InterpolatorType::New();
+  interpolator->SetSplineOrder(SplineOrder);
+  auto sampler = SamplerType::New();
+  sampler->SetNumberOfSamples(numberOfSamples);
+  auto metric = MetricType::New();
+  metric->SetFixedImage(fixedImage);
+  metric->SetMovingImage(movingImage);
+  metric->SetFixedImageRegion(fixedImage->GetBufferedRegion());
+  metric->SetTransform(transform);
+  metric->SetInterpolator(interpolator);
+  metric->SetImageSampler(sampler);
+  metric->SetNumberOfFixedHistogramBins(32);
+  metric->SetNumberOfMovingHistogramBins(32);
+  metric->SetUseMultiThread(true);
+  try
+  {
+    metric->Initialize();
+  }
+  catch (const itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return 1;
+  }
+
+  /** Time the iterations with new samples, in random and in Morton order. */
+  double timeInMs[2] = { 0.0, 0.0 };
+  for (unsigned int useMortonOrder = 0; useMortonOrder < 2; ++useMortonOrder)
+  {
+    sampler->SetUseMortonOrder(useMortonOrder == 1);
+
+    MeasureType    value = 0.0;
+    DerivativeType derivative;
+    itk::TimeProbe timeProbe;
+    timeProbe.Start();
+    for (unsigned int i = 0; i < N; ++i)
+    {
+      sampler->SelectNewSamplesOnUpdate();
+      metric->GetValueAndDerivative(parameters, value, derivative);
+    }
+    timeProbe.Stop();
+    timeInMs[useMortonOrder] = 1000.0 * timeProbe.GetTotal() / N;
+  }
+
+  /** Report. */
+  std::cerr << std::fixed << std::setprecision(3);
+  std::cerr << "Time per iteration (ms), including sampling:" << std::endl;
+  std::cerr << "  Random order: " << timeInMs[0] << std::endl;
+  std::cerr << "  Morton order: " << timeInMs[1] << std::endl;
+  std::cerr << "Speedup factor = " << timeInMs[0] / timeInMs[1] << std::endl;
+
+  /** Return a value. */
+  return 0;
+
+} // end main
@@ -0,0 +1,183 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkMultiImageResampleImageFilter.h"
+#include "itkResampleImageFilter.h"
+#include "itkRecursiveBSplineTransform.h"
+#include "itkBSplineInterpolateImageFunction.h"
+#include "itkNearestNeighborInterpolateImageFunction.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <cmath>
+#include <iomanip>
+#include <vector>
+
+//-------------------------------------------------------------------------------------
+// This test resamples three 3D images of 128^3 voxels with the same B-spline transform,
+// as transformix does for "-in0 -in1 -in2". Two images are interpolated with a cubic
+// B-spline, and one, a label image, with nearest neighbor interpolation. It compares
+// the time of three ResampleImageFilters, which each evaluate the transform at all
+// voxels, with the MultiImageResampleImageFilter, which evaluates the transform once
+// per voxel. That both give the same results is tested by the CommonGTest.
+
+int
+main()
+{
+  const unsigned int Dimension = 3;
+  const unsigned int SplineOrder = 3;
+  const unsigned int NumberOfImages = 3;
+  typedef double     CoordinateRepresentationType;
+
+  /** The image size. Distinguish between Debug and Release mode. */
+#ifndef NDEBUG
+  const unsigned int imageSize = 32;
+#else
+  const unsigned int imageSize = 128;
+#endif
+  std::cerr << "Image size = " << imageSize << ", number of images = " << NumberOfImages << std::endl;
+
+  /** Typedefs. */
+  typedef itk::RecursiveBSplineTransform<CoordinateRepresentationType, Dimension, SplineOrder> TransformType;
+  typedef TransformType::ParametersType                                                        ParametersType;
+  typedef TransformType::ImageType                                                             GridImageType;
+  typedef itk::Image<float, Dimension>                                                         ImageType;
+
+  typedef itk::MultiImageResampleImageFilter<ImageType, ImageType, CoordinateRepresentationType> MultiResamplerType;
+  typedef itk::ResampleImageFilter<ImageType, ImageType, CoordinateRepresentationType>           ResamplerType;
+  typedef itk::InterpolateImageFunction<ImageType, CoordinateRepresentationType>                 InterpolatorType;
+
+  typedef itk::BSplineInterpolateImageFunction<ImageType, CoordinateRepresentationType, double> BSplineInterpolatorType;
+  typedef itk::NearestNeighborInterpolateImageFunction<ImageType, CoordinateRepresentationType>
+    NearestNeighborInterpolatorType;
+
+  /** Create a B-spline transform with a grid spacing of 16 voxels and smoothly varying coefficients. */
+  auto                         transform = TransformType::New();
+  GridImageType::RegionType    gridRegion;
+  GridImageType::SizeType      bsplineGridSize;
+  GridImageType::SpacingType   gridSpacing;
+  GridImageType::PointType     gridOrigin;
+  GridImageType::DirectionType gridDirection;
+  bsplineGridSize.Fill(imageSize / 16 + 3);
+  gridRegion.SetSize(bsplineGridSize);
+  gridSpacing.Fill(16.0);
+  gridOrigin.Fill(-16.0);
+  gridDirection.SetIdentity();
+  transform->SetGridRegion(gridRegion);
+  transform->SetGridSpacing(gridSpacing);
+  transform->SetGridOrigin(gridOrigin);
+  transform->SetGridDirection(gridDirection);
+
+  ParametersType parameters(transform->GetNumberOfParameters());
+  for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+  {
+    parameters[i] = 3.0 * std::sin(0.37 * i);
+  }
+  transform->SetParameters(parameters);
+
+  /** Create the input images: two with rapidly varying intensities, and a label image. */
+  ImageType::SizeType size;
+  size.Fill(imageSize);
+  std::vector<ImageType::Pointer> images(NumberOfImages);
+  for (unsigned int i = 0; i < NumberOfImages; ++i)
+  {
+    images[i] = ImageType::New();
+    images[i]->SetRegions(size);
+    images[i]->Allocate();
+    itk::ImageRegionIteratorWithIndex<ImageType> it(images[i], images[i]->GetLargestPossibleRegion());
+    for (; !it.IsAtEnd(); ++it)
+    {
+      const ImageType::IndexType index = it.GetIndex();
+      const double               value = 50.0 + 50.0 * std::sin(0.9 * index[0] + 1.7 * index[1] + 2.3 * index[2] + i);
+      it.Set(i == NumberOfImages - 1 ? std::floor(value / 20.0) : value);
+    }
+  }
+
+  /** The interpolators: the last image is a label image. */
+  std::vector<InterpolatorType::Pointer> interpolators(NumberOfImages);
+  std::vector<InterpolatorType::Pointer> multiInterpolators(NumberOfImages);
+  for (unsigned int i = 0; i < NumberOfImages; ++i)
+  {
+    if (i == NumberOfImages - 1)
+    {
+      interpolators[i] = NearestNeighborInterpolatorType::New();
+      multiInterpolators[i] = NearestNeighborInterpolatorType::New();
+    }
+    else
+    {
+      interpolators[i] = BSplineInterpolatorType::New();
+      multiInterpolators[i] = BSplineInterpolatorType::New();
+    }
+  }
+
+  /** Resample the images separately. */
+  std::vector<ResamplerType::Pointer> resamplers(NumberOfImages);
+  for (unsigned int i = 0; i < NumberOfImages; ++i)
+  {
+    resamplers[i] = ResamplerType::New();
+    resamplers[i]->SetInput(images[i]);
+    resamplers[i]->SetTransform(transform);
+    resamplers[i]->SetInterpolator(interpolators[i]);
+    resamplers[i]->SetSize(size);
+    resamplers[i]->SetDefaultPixelValue(-1.0);
+  }
+
+  /** Resample the images in a single pass. */
+  auto multiResampler = MultiResamplerType::New();
+  multiResampler->SetNumberOfImages(NumberOfImages);
+  for (unsigned int i = 0; i < NumberOfImages; ++i)
+  {
+    multiResampler->SetInput(i, images[i]);
+    multiResampler->SetInterpolator(i, multiInterpolators[i]);
+  }
+  multiResampler->SetTransform(transform);
+  multiResampler->SetSize(size);
+  multiResampler->SetDefaultPixelValue(-1.0);
+
+  itk::TimeProbe timeProbeSeparate, timeProbeSinglePass;
+  try
+  {
+    timeProbeSeparate.Start();
+    for (unsigned int i = 0; i < NumberOfImages; ++i)
+    {
+      resamplers[i]->Update();
+    }
+    timeProbeSeparate.Stop();
+
+    timeProbeSinglePass.Start();
+    multiResampler->Update();
+    timeProbeSinglePass.Stop();
+  }
+  catch (const itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return 1;
+  }
+
+  /** Report. */
+  std::cerr << std::fixed << std::setprecision(3);
+  std::cerr << "Time (s):" << std::endl;
+  std::cerr << "  Separate:    " << timeProbeSeparate.GetTotal() << std::endl;
+  std::cerr << "  Single pass: " << timeProbeSinglePass.GetTotal() << std::endl;
+  std::cerr << "Speedup factor = " << timeProbeSeparate.GetTotal() / timeProbeSinglePass.GetTotal() << std::endl;
+
+  /** Return a value. */
+  return 0;
+
+} // end main
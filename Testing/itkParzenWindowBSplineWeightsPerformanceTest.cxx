@@ -0,0 +1,212 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkParzenWindowBSplineWeights.h"
+#include "itkBSplineKernelFunction2.h"
+#include "itkImage.h"
+#include "itkImageScanlineIterator.h"
+#include "itkArray.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <cmath>
+#include <iomanip>
+#include <vector>
+
+//-------------------------------------------------------------------------------------
+// This test compares the throughput of the Parzen window joint histogram update of the
+// ParzenWindowHistogramImageToImageMetric before and after specializing it for the
+// kernel orders. The previous implementation evaluated the kernels through the virtual
+// KernelFunctionBase2 interface into heap-allocated arrays, and scattered the values
+// into the joint histogram with an image iterator. The specialized implementation
+// evaluates all weights with ParzenWindowBSplineWeights, and adds them directly into
+// the histogram buffer. That the weights equal those of BSplineKernelFunction2 is
+// tested by the CommonGTest.
+
+namespace
+{
+typedef itk::Image<double, 2>            JointPDFType;
+typedef itk::Array<double>               ParzenValueContainerType;
+typedef itk::KernelFunctionBase2<double> KernelFunctionType;
+
+const unsigned int numberOfBins = 32;
+
+/** Computes the lowest affected bin of a Parzen window term, as in the metric. */
+template <unsigned int VSplineOrder>
+itk::OffsetValueType
+ParzenWindowIndex(const double parzenWindowTerm)
+{
+  return static_cast<itk::OffsetValueType>(
+    std::floor(parzenWindowTerm + 0.5 - static_cast<double>(VSplineOrder) / 2.0));
+}
+
+
+/** The previous implementation. */
+template <unsigned int VFixedOrder, unsigned int VMovingOrder>
+void
+UpdateJointPDFGeneric(const std::vector<double> & fixedTerms,
+                      const std::vector<double> & movingTerms,
+                      JointPDFType *              jointPDF)
+{
+  const KernelFunctionType::Pointer fixedKernel = itk::BSplineKernelFunction2<VFixedOrder>::New().GetPointer();
+  const KernelFunctionType::Pointer movingKernel = itk::BSplineKernelFunction2<VMovingOrder>::New().GetPointer();
+
+  JointPDFType::RegionType window;
+  JointPDFType::SizeType   windowSize;
+  windowSize[0] = VMovingOrder + 1;
+  windowSize[1] = VFixedOrder + 1;
+  window.SetSize(windowSize);
+
+  for (std::size_t i = 0; i < fixedTerms.size(); ++i)
+  {
+    const itk::OffsetValueType fixedIndex = ParzenWindowIndex<VFixedOrder>(fixedTerms[i]);
+    const itk::OffsetValueType movingIndex = ParzenWindowIndex<VMovingOrder>(movingTerms[i]);
+
+    ParzenValueContainerType fixedParzenValues(VFixedOrder + 1);
+    ParzenValueContainerType movingParzenValues(VMovingOrder + 1);
+    fixedKernel->Evaluate(static_cast<double>(fixedIndex) - fixedTerms[i], fixedParzenValues.data_block());
+    movingKernel->Evaluate(static_cast<double>(movingIndex) - movingTerms[i], movingParzenValues.data_block());
+
+    JointPDFType::IndexType windowIndex;
+    windowIndex[0] = movingIndex;
+    windowIndex[1] = fixedIndex;
+    JointPDFType::RegionType jointPDFWindow = window;
+    jointPDFWindow.SetIndex(windowIndex);
+    itk::ImageScanlineIterator<JointPDFType> it(jointPDF, jointPDFWindow);
+
+    for (unsigned int f = 0; f < fixedParzenValues.GetSize(); ++f)
+    {
+      const double fv = fixedParzenValues[f];
+      for (unsigned int m = 0; m < movingParzenValues.GetSize(); ++m)
+      {
+        it.Value() += fv * movingParzenValues[m];
+        ++it;
+      }
+      it.NextLine();
+    }
+  }
+}
+
+
+/** The specialized implementation. */
+template <unsigned int VFixedOrder, unsigned int VMovingOrder>
+void
+UpdateJointPDFSpecialized(const std::vector<double> & fixedTerms,
+                          const std::vector<double> & movingTerms,
+                          JointPDFType *              jointPDF)
+{
+  const itk::OffsetValueType lineOffset = jointPDF->GetOffsetTable()[1];
+  double * const             buffer = jointPDF->GetBufferPointer();
+
+  for (std::size_t i = 0; i < fixedTerms.size(); ++i)
+  {
+    const itk::OffsetValueType fixedIndex = ParzenWindowIndex<VFixedOrder>(fixedTerms[i]);
+    const itk::OffsetValueType movingIndex = ParzenWindowIndex<VMovingOrder>(movingTerms[i]);
+
+    double fixedParzenValues[VFixedOrder + 1];
+    double movingParzenValues[VMovingOrder + 1];
+    itk::ParzenWindowBSplineWeights<VFixedOrder>::Evaluate(static_cast<double>(fixedIndex) - fixedTerms[i],
+                                                           fixedParzenValues);
+    itk::ParzenWindowBSplineWeights<VMovingOrder>::Evaluate(static_cast<double>(movingIndex) - movingTerms[i],
+                                                            movingParzenValues);
+
+    double * pdfPtr = buffer + fixedIndex * lineOffset + movingIndex;
+    for (unsigned int f = 0; f < VFixedOrder + 1; ++f)
+    {
+      const double fv = fixedParzenValues[f];
+      for (unsigned int m = 0; m < VMovingOrder + 1; ++m)
+      {
+        pdfPtr[m] += fv * movingParzenValues[m];
+      }
+      pdfPtr += lineOffset;
+    }
+  }
+}
+
+
+/** Times both implementations. */
+template <unsigned int VFixedOrder, unsigned int VMovingOrder>
+void
+TimeImplementations(const std::vector<double> & fixedTerms,
+                    const std::vector<double> & movingTerms,
+                    const unsigned int          N)
+{
+  JointPDFType::SizeType size;
+  size.Fill(numberOfBins);
+  auto jointPDFGeneric = JointPDFType::New();
+  jointPDFGeneric->SetRegions(size);
+  jointPDFGeneric->Allocate(true);
+  auto jointPDFSpecialized = JointPDFType::New();
+  jointPDFSpecialized->SetRegions(size);
+  jointPDFSpecialized->Allocate(true);
+
+  itk::TimeProbe timeProbeGeneric, timeProbeSpecialized;
+  for (unsigned int i = 0; i < N; ++i)
+  {
+    timeProbeGeneric.Start();
+    UpdateJointPDFGeneric<VFixedOrder, VMovingOrder>(fixedTerms, movingTerms, jointPDFGeneric);
+    timeProbeGeneric.Stop();
+
+    timeProbeSpecialized.Start();
+    UpdateJointPDFSpecialized<VFixedOrder, VMovingOrder>(fixedTerms, movingTerms, jointPDFSpecialized);
+    timeProbeSpecialized.Stop();
+  }
+
+  /** Report the throughput in millions of samples per second. */
+  const double numberOfSamples = static_cast<double>(N) * static_cast<double>(fixedTerms.size());
+  std::cerr << std::fixed << std::setprecision(2);
+  std::cerr << "Kernel orders (fixed, moving) = (" << VFixedOrder << ", " << VMovingOrder << ")" << std::endl;
+  std::cerr << "  Generic:     " << 1e-6 * numberOfSamples / timeProbeGeneric.GetTotal() << " Msamples/s" << std::endl;
+  std::cerr << "  Specialized: " << 1e-6 * numberOfSamples / timeProbeSpecialized.GetTotal() << " Msamples/s"
+            << std::endl;
+  std::cerr << "  Speedup factor = " << timeProbeGeneric.GetTotal() / timeProbeSpecialized.GetTotal() << std::endl;
+}
+
+} // namespace
+
+
+int
+main()
+{
+  /** The number of repetitions. Distinguish between Debug and Release mode. */
+#ifndef NDEBUG
+  const unsigned int N = 2;
+#else
+  const unsigned int N = 20;
+#endif
+  const unsigned int numberOfSamples = 1000000;
+  std::cerr << "N = " << N << ", number of samples = " << numberOfSamples << std::endl;
+
+  /** Create scattered Parzen window terms, which stay within the padded histogram, as in the metric. */
+  const double        range = numberOfBins - 5.0;
+  std::vector<double> fixedTerms(numberOfSamples);
+  std::vector<double> movingTerms(numberOfSamples);
+  for (unsigned int i = 0; i < numberOfSamples; ++i)
+  {
+    fixedTerms[i] = 2.0 + range * std::fmod(0.6180339887 * i, 1.0);
+    movingTerms[i] = 2.0 + range * std::fmod(0.7548776662 * i, 1.0);
+  }
+
+  /** Time the default kernel orders of the metric, and the cubic kernels for both images. */
+  TimeImplementations<0, 3>(fixedTerms, movingTerms, N);
+  TimeImplementations<3, 3>(fixedTerms, movingTerms, N);
+
+  /** Return a value. */
+  return 0;
+
+} // end main
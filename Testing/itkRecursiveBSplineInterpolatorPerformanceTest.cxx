@@ -0,0 +1,167 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkRecursiveBSplineInterpolateImageFunction.h"
+#include "itkBSplineInterpolateImageFunction.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <cmath>
+#include <iomanip>
+#include <vector>
+
+//-------------------------------------------------------------------------------------
+// This test compares the time to evaluate the moving image value and gradient at scattered
+// positions, as done by the AdvancedImageToImageMetric for each sample, with the ITK
+// BSplineInterpolateImageFunction and with the RecursiveBSplineInterpolateImageFunction,
+// for spline order 1 to 3 and image dimension 2 to 4. That both give the same results is
+// tested by the CommonGTest.
+
+namespace
+{
+
+/** Times both interpolators. */
+template <unsigned int VDimension>
+void
+TimeInterpolators(const unsigned int splineOrder,
+                  const unsigned int imageSize,
+                  const unsigned int numberOfPoints,
+                  const unsigned int N)
+{
+  typedef itk::Image<float, VDimension>                                            ImageType;
+  typedef itk::BSplineInterpolateImageFunction<ImageType, double, double>          ITKInterpolatorType;
+  typedef itk::RecursiveBSplineInterpolateImageFunction<ImageType, double, double> RecursiveInterpolatorType;
+  typedef typename ITKInterpolatorType::ContinuousIndexType                        ContinuousIndexType;
+  typedef typename ITKInterpolatorType::CovariantVectorType                        CovariantVectorType;
+  typedef typename ITKInterpolatorType::OutputType                                 OutputType;
+
+  /** Create a smooth image, with a non-unit spacing. */
+  typename ImageType::SizeType    size;
+  typename ImageType::SpacingType spacing;
+  for (unsigned int d = 0; d < VDimension; ++d)
+  {
+    size[d] = imageSize;
+    spacing[d] = 0.8 + 0.2 * d;
+  }
+  auto image = ImageType::New();
+  image->SetRegions(size);
+  image->SetSpacing(spacing);
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, image->GetBufferedRegion());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    const typename ImageType::IndexType index = it.GetIndex();
+    double                              value = 100.0;
+    for (unsigned int d = 0; d < VDimension; ++d)
+    {
+      value *= std::cos(index[d] / 5.0);
+    }
+    it.Set(static_cast<float>(value));
+  }
+
+  /** Set up both interpolators. */
+  auto itkInterpolator = ITKInterpolatorType::New();
+  itkInterpolator->SetSplineOrder(splineOrder);
+  itkInterpolator->SetInputImage(image);
+  auto recursiveInterpolator = RecursiveInterpolatorType::New();
+  recursiveInterpolator->SetSplineOrder(splineOrder);
+  recursiveInterpolator->SetInputImage(image);
+
+  /** Create scattered points inside the image, also near the border. */
+  std::vector<ContinuousIndexType> points(numberOfPoints);
+  for (unsigned int i = 0; i < numberOfPoints; ++i)
+  {
+    for (unsigned int d = 0; d < VDimension; ++d)
+    {
+      points[i][d] = (imageSize - 1.0) * std::fmod((0.5698402910 + 0.1 * d) * i, 1.0);
+    }
+  }
+
+  /** Time the evaluations. Accumulate the results, so that they are not optimized away. */
+  double              sumITK = 0.0, sumRecursive = 0.0;
+  itk::TimeProbe      timeProbeITK, timeProbeRecursive;
+  OutputType          value = 0.0;
+  CovariantVectorType gradient;
+  for (unsigned int i = 0; i < N; ++i)
+  {
+    timeProbeITK.Start();
+    for (const auto & point : points)
+    {
+      itkInterpolator->EvaluateValueAndDerivativeAtContinuousIndex(point, value, gradient);
+      sumITK += value + gradient[0];
+    }
+    timeProbeITK.Stop();
+
+    timeProbeRecursive.Start();
+    for (const auto & point : points)
+    {
+      recursiveInterpolator->EvaluateValueAndDerivativeAtContinuousIndex(point, value, gradient);
+      sumRecursive += value + gradient[0];
+    }
+    timeProbeRecursive.Stop();
+  }
+
+  /** Report. */
+  const double numberOfEvaluations = static_cast<double>(N) * static_cast<double>(numberOfPoints);
+  std::cerr << std::fixed << std::setprecision(2);
+  std::cerr << "Dimension = " << VDimension << ", spline order = " << splineOrder << std::endl;
+  std::cerr << "  ITK:       " << 1e-6 * numberOfEvaluations / timeProbeITK.GetTotal() << " Mevaluations/s"
+            << std::endl;
+  std::cerr << "  Recursive: " << 1e-6 * numberOfEvaluations / timeProbeRecursive.GetTotal() << " Mevaluations/s"
+            << std::endl;
+  std::cerr << "  Speedup factor = " << timeProbeITK.GetTotal() / timeProbeRecursive.GetTotal() << std::endl;
+  std::cerr << std::scientific << "  Checksums: " << sumITK << " " << sumRecursive << std::endl;
+}
+
+
+/** Times the interpolators for spline order 1 to 3. */
+template <unsigned int VDimension>
+void
+TimeSplineOrders(const unsigned int imageSize, const unsigned int numberOfPoints, const unsigned int N)
+{
+  for (unsigned int splineOrder = 1; splineOrder <= 3; ++splineOrder)
+  {
+    TimeInterpolators<VDimension>(splineOrder, imageSize, numberOfPoints, N);
+  }
+}
+
+} // namespace
+
+
+int
+main()
+{
+  /** The number of repetitions. Distinguish between Debug and Release mode. */
+#ifndef NDEBUG
+  const unsigned int N = 2;
+#else
+  const unsigned int N = 10;
+#endif
+  const unsigned int numberOfPoints = 200000;
+  std::cerr << "N = " << N << ", number of points = " << numberOfPoints << std::endl;
+
+  /** Time 2D, 3D and 4D images of roughly similar numbers of voxels. */
+  TimeSplineOrders<2>(512, numberOfPoints, N);
+  TimeSplineOrders<3>(64, numberOfPoints, N);
+  TimeSplineOrders<4>(24, numberOfPoints, N);
+
+  /** Return a value. */
+  return 0;
+
+} // end main
@@ -0,0 +1,145 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkTransformToDisplacementFieldAndSpatialJacobianSource.h"
+#include "itkTransformToDisplacementFieldFilter.h"
+#include "itkTransformToDeterminantOfSpatialJacobianSource.h"
+#include "itkTransformToSpatialJacobianSource.h"
+#include "itkRecursiveBSplineTransform.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <cmath>
+#include <iomanip>
+
+//-------------------------------------------------------------------------------------
+// This test computes the deformation field, the determinant of the spatial Jacobian and
+// the spatial Jacobian of a B-spline transform, on a 3D grid of 128^3 voxels, as
+// transformix does for "-def all -jac all -jacmat all". It compares the time of the
+// three separate sources, which each evaluate the transform at all voxels, with the
+// single-pass source, which evaluates the transform and its spatial Jacobian once per
+// voxel. That both give the same results is tested by the CommonGTest.
+
+int
+main()
+{
+  const unsigned int Dimension = 3;
+  const unsigned int SplineOrder = 3;
+  typedef double     CoordinateRepresentationType;
+
+  /** The grid size. Distinguish between Debug and Release mode. */
+#ifndef NDEBUG
+  const unsigned int gridSize = 32;
+#else
+  const unsigned int gridSize = 128;
+#endif
+  std::cerr << "Grid size = " << gridSize << std::endl;
+
+  /** Typedefs. */
+  typedef itk::RecursiveBSplineTransform<CoordinateRepresentationType, Dimension, SplineOrder> TransformType;
+  typedef TransformType::ParametersType                                                        ParametersType;
+  typedef TransformType::ImageType                                                             GridImageType;
+  typedef itk::Image<itk::Vector<float, Dimension>, Dimension>                                 FieldImageType;
+  typedef itk::Image<float, Dimension>                                                         DeterminantImageType;
+
+  typedef itk::Image<itk::Matrix<float, Dimension, Dimension>, Dimension> SpatialJacobianImageType;
+
+  typedef itk::TransformToDisplacementFieldAndSpatialJacobianSource<FieldImageType,
+                                                                    DeterminantImageType,
+                                                                    SpatialJacobianImageType,
+                                                                    CoordinateRepresentationType>
+    SinglePassType;
+  typedef itk::TransformToDisplacementFieldFilter<FieldImageType, CoordinateRepresentationType> FieldSourceType;
+  typedef itk::TransformToDeterminantOfSpatialJacobianSource<DeterminantImageType, CoordinateRepresentationType>
+    DeterminantSourceType;
+  typedef itk::TransformToSpatialJacobianSource<SpatialJacobianImageType, CoordinateRepresentationType>
+    SpatialJacobianSourceType;
+
+  /** Create a B-spline transform with a grid spacing of 16 voxels and smoothly varying coefficients. */
+  auto                         transform = TransformType::New();
+  GridImageType::RegionType    gridRegion;
+  GridImageType::SizeType      bsplineGridSize;
+  GridImageType::SpacingType   gridSpacing;
+  GridImageType::PointType     gridOrigin;
+  GridImageType::DirectionType gridDirection;
+  bsplineGridSize.Fill(gridSize / 16 + 3);
+  gridRegion.SetSize(bsplineGridSize);
+  gridSpacing.Fill(16.0);
+  gridOrigin.Fill(-16.0);
+  gridDirection.SetIdentity();
+  transform->SetGridRegion(gridRegion);
+  transform->SetGridSpacing(gridSpacing);
+  transform->SetGridOrigin(gridOrigin);
+  transform->SetGridDirection(gridDirection);
+
+  ParametersType parameters(transform->GetNumberOfParameters());
+  for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+  {
+    parameters[i] = 3.0 * std::sin(0.37 * i);
+  }
+  transform->SetParameters(parameters);
+
+  FieldImageType::SizeType outputSize;
+  outputSize.Fill(gridSize);
+
+  /** Compute the three outputs separately. */
+  auto fieldSource = FieldSourceType::New();
+  fieldSource->SetTransform(transform);
+  fieldSource->SetSize(outputSize);
+  auto determinantSource = DeterminantSourceType::New();
+  determinantSource->SetTransform(transform);
+  determinantSource->SetOutputSize(outputSize);
+  auto spatialJacobianSource = SpatialJacobianSourceType::New();
+  spatialJacobianSource->SetTransform(transform);
+  spatialJacobianSource->SetOutputSize(outputSize);
+
+  /** Compute the three outputs in a single pass. */
+  auto singlePass = SinglePassType::New();
+  singlePass->SetTransform(transform);
+  singlePass->SetOutputSize(outputSize);
+
+  itk::TimeProbe timeProbeSeparate, timeProbeSinglePass;
+  try
+  {
+    timeProbeSeparate.Start();
+    fieldSource->Update();
+    determinantSource->Update();
+    spatialJacobianSource->Update();
+    timeProbeSeparate.Stop();
+
+    timeProbeSinglePass.Start();
+    singlePass->Update();
+    timeProbeSinglePass.Stop();
+  }
+  catch (const itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return 1;
+  }
+
+  /** Report. */
+  std::cerr << std::fixed << std::setprecision(3);
+  std::cerr << "Time (s):" << std::endl;
+  std::cerr << "  Separate:    " << timeProbeSeparate.GetTotal() << std::endl;
+  std::cerr << "  Single pass: " << timeProbeSinglePass.GetTotal() << std::endl;
+  std::cerr << "Speedup factor = " << timeProbeSeparate.GetTotal() / timeProbeSinglePass.GetTotal() << std::endl;
+
+  /** Return a value. */
+  return 0;
+
+} // end main
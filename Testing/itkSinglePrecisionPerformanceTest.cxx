@@ -0,0 +1,245 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "AdvancedMeanSquares/itkAdvancedMeanSquaresImageToImageMetric.h"
+#include "itkAdvancedBSplineDeformableTransform.h"
+#include "itkRecursiveBSplineInterpolateImageFunction.h"
+#include "itkImageGridSampler.h"
+#include "itkImageFileReader.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+//-------------------------------------------------------------------------------------
+// This test compares the AdvancedMeanSquares metric on the 3D lung CT test image,
+// with the moving image B-spline coefficients stored in double precision, and in
+// single precision as by the BSplineInterpolatorFloat component, or by the
+// BSplineInterpolator when built with ELASTIX_USE_SINGLE_PRECISION.
+// It reports the coefficient and sample memory, the rounding of the sample
+// coordinates, the time per GetValueAndDerivative() and the relative differences
+// in value and derivative. That the float coefficients only change the interpolation
+// by their rounding is tested by the CommonGTest.
+
+namespace
+{
+const unsigned int Dimension = 3;
+const unsigned int SplineOrder = 3;
+typedef double     CoordinateRepresentationType;
+
+typedef itk::Image<float, Dimension>                                                                  ImageType;
+typedef itk::AdvancedMeanSquaresImageToImageMetric<ImageType, ImageType>                              MetricType;
+typedef MetricType::MeasureType                                                                       MeasureType;
+typedef MetricType::DerivativeType                                                                    DerivativeType;
+typedef itk::ImageGridSampler<ImageType>                                                              SamplerType;
+typedef SamplerType::ImageSampleType                                                                  ImageSampleType;
+typedef itk::AdvancedBSplineDeformableTransform<CoordinateRepresentationType, Dimension, SplineOrder> TransformType;
+typedef TransformType::ParametersType                                                                 ParametersType;
+
+/** Times GetValueAndDerivative() with the given interpolator. Returns the time per iteration in ms. */
+template <class TInterpolator>
+double
+TimeMetric(const ImageType *      image,
+           TransformType *        transform,
+           const ParametersType & parameters,
+           const unsigned int     N,
+           MeasureType &          value,
+           DerivativeType &       derivative)
+{
+  auto interpolator = TInterpolator::New();
+  interpolator->SetSplineOrder(SplineOrder);
+
+  SamplerType::SampleGridSpacingType gridSpacing;
+  gridSpacing.Fill(2);
+  auto sampler = SamplerType::New();
+  sampler->SetSampleGridSpacing(gridSpacing);
+
+  auto metric = MetricType::New();
+  metric->SetFixedImage(image);
+  metric->SetMovingImage(image);
+  metric->SetFixedImageRegion(image->GetBufferedRegion());
+  metric->SetTransform(transform);
+  metric->SetInterpolator(interpolator);
+  metric->SetImageSampler(sampler);
+  metric->Initialize();
+
+  /** Warm up, which also computes the samples. */
+  metric->GetValueAndDerivative(parameters, value, derivative);
+
+  itk::TimeProbe timeProbe;
+  timeProbe.Start();
+  for (unsigned int i = 0; i < N; ++i)
+  {
+    metric->GetValueAndDerivative(parameters, value, derivative);
+  }
+  timeProbe.Stop();
+
+  return 1000.0 * timeProbe.GetTotal() / N;
+}
+
+
+/** Returns the largest distance between the sample coordinates of a grid sampler and
+ * the voxel positions in double precision. Zero, unless the samples are stored in
+ * single precision.
+ */
+double
+MaximumSampleCoordinateRounding(const ImageType * image, std::size_t & numberOfSamples)
+{
+  SamplerType::SampleGridSpacingType gridSpacing;
+  gridSpacing.Fill(2);
+  auto sampler = SamplerType::New();
+  sampler->SetSampleGridSpacing(gridSpacing);
+  sampler->SetInput(image);
+  sampler->SetInputImageRegion(image->GetBufferedRegion());
+  sampler->Update();
+
+  const auto & samples = *sampler->GetOutput();
+  numberOfSamples = samples.Size();
+
+  double maximumRounding = 0.0;
+  for (const auto & sample : samples)
+  {
+    const ImageType::PointType sampledPoint = sample.m_ImageCoordinates;
+    ImageType::IndexType       index;
+    image->TransformPhysicalPointToIndex(sampledPoint, index);
+    ImageType::PointType voxelPoint;
+    image->TransformIndexToPhysicalPoint(index, voxelPoint);
+    maximumRounding = std::max(maximumRounding, sampledPoint.EuclideanDistanceTo(voxelPoint));
+  }
+  return maximumRounding;
+}
+
+} // namespace
+
+
+int
+main(int argc, char * argv[])
+{
+  /** The number of evaluations of GetValueAndDerivative(). Distinguish between
+   * Debug and Release mode.
+   */
+#ifndef NDEBUG
+  const unsigned int N = 2;
+#else
+  const unsigned int N = 20;
+#endif
+  std::cerr << "N = " << N << std::endl;
+
+  /** Check. */
+  if (argc != 2)
+  {
+    std::cerr << "ERROR: You should specify an input image." << std::endl;
+    return 1;
+  }
+
+  /** Read the test image, which is used as fixed and moving image. */
+  typedef itk::ImageFileReader<ImageType> ReaderType;
+  auto                                    reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  try
+  {
+    reader->Update();
+  }
+  catch (const itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return 1;
+  }
+  const ImageType * image = reader->GetOutput();
+
+  /** Create a B-spline transform covering the image with smoothly varying coefficients.
+   * The grid assumes an image with an identity direction.
+   */
+  typedef TransformType::ImageType GridImageType;
+  auto                             transform = TransformType::New();
+  GridImageType::RegionType        gridRegion;
+  GridImageType::SizeType          gridSize;
+  GridImageType::SpacingType       gridSpacing;
+  GridImageType::PointType         gridOrigin;
+  GridImageType::DirectionType     gridDirection;
+  gridSize.Fill(11);
+  gridRegion.SetSize(gridSize);
+  for (unsigned int d = 0; d < Dimension; ++d)
+  {
+    const double extent = image->GetSpacing()[d] * (image->GetBufferedRegion().GetSize()[d] - 1);
+    gridSpacing[d] = extent / 8.0;
+    gridOrigin[d] = image->GetOrigin()[d] - gridSpacing[d];
+  }
+  gridDirection.SetIdentity();
+  transform->SetGridRegion(gridRegion);
+  transform->SetGridSpacing(gridSpacing);
+  transform->SetGridOrigin(gridOrigin);
+  transform->SetGridDirection(gridDirection);
+
+  ParametersType parameters(transform->GetNumberOfParameters());
+  for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+  {
+    parameters[i] = 2.0 * std::sin(0.37 * i);
+  }
+  transform->SetParameters(parameters);
+
+  /** Time the metric with double and float coefficients. */
+  typedef itk::RecursiveBSplineInterpolateImageFunction<ImageType, CoordinateRepresentationType, double>
+    DoubleInterpolatorType;
+  typedef itk::RecursiveBSplineInterpolateImageFunction<ImageType, CoordinateRepresentationType, float>
+    FloatInterpolatorType;
+
+  MeasureType    valueDouble = 0.0, valueFloat = 0.0;
+  DerivativeType derivativeDouble, derivativeFloat;
+  double         timeDouble = 0.0, timeFloat = 0.0;
+  double         sampleRounding = 0.0;
+  std::size_t    numberOfSamples = 0;
+  try
+  {
+    timeDouble = TimeMetric<DoubleInterpolatorType>(image, transform, parameters, N, valueDouble, derivativeDouble);
+    timeFloat = TimeMetric<FloatInterpolatorType>(image, transform, parameters, N, valueFloat, derivativeFloat);
+    sampleRounding = MaximumSampleCoordinateRounding(image, numberOfSamples);
+  }
+  catch (const itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return 1;
+  }
+
+  /** Report. */
+  const double numberOfPixels = static_cast<double>(image->GetBufferedRegion().GetNumberOfPixels());
+
+  const double sampleSizeDouble = sizeof(ImageType::PointType) + sizeof(double);
+
+#ifdef ELASTIX_USE_SINGLE_PRECISION
+  std::cerr << "Built with ELASTIX_USE_SINGLE_PRECISION" << std::endl;
+#endif
+  std::cerr << std::fixed << std::setprecision(3);
+  std::cerr << "Coefficient memory (MB): double " << numberOfPixels * sizeof(double) / 1048576.0 << ", float "
+            << numberOfPixels * sizeof(float) / 1048576.0 << std::endl;
+  std::cerr << "Sample memory (MB): double " << numberOfSamples * sampleSizeDouble / 1048576.0 << ", this build "
+            << numberOfSamples * sizeof(ImageSampleType) / 1048576.0 << std::endl;
+  std::cerr << "Time per GetValueAndDerivative (ms): double " << timeDouble << ", float " << timeFloat << std::endl;
+  std::cerr << std::scientific << "Metric value: double " << valueDouble << ", float " << valueFloat << std::endl;
+  std::cerr << "Relative difference of the value: " << std::abs(valueFloat - valueDouble) / std::abs(valueDouble)
+            << std::endl;
+  std::cerr << "Relative difference of the derivative: "
+            << (derivativeFloat - derivativeDouble).magnitude() / derivativeDouble.magnitude() << std::endl;
+  std::cerr << "Maximum rounding of the sample coordinates (mm): " << sampleRounding << std::endl;
+
+  /** Return a value. */
+  return 0;
+
+} // end main
@@ -0,0 +1,206 @@
+/*=========================================================================
+ *
+ *  Copyright UMC Utrecht and contributors
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "VarianceOverLastDimension/itkVarianceOverLastDimensionImageMetric.h"
+#include "itkStackTransform.h"
+#include "itkRecursiveBSplineTransform.h"
+#include "itkBSplineInterpolateImageFunction.h"
+#include "itkImageRandomSampler.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+// Report timings
+#include "itkTimeProbe.h"
+
+#include <cmath>
+#include <iomanip>
+
+//-------------------------------------------------------------------------------------
+// This test measures a 4D stack registration iteration: a StackTransform of 3D
+// RecursiveBSplineTransforms, one for each of the 50 frames, with the
+// VarianceOverLastDimension metric. It reports the time to set the parameters, with
+// SetParametersByValue(), which copies them once, and with SetParameters(), which
+// only gives the sub transforms views on their slices. It also compares the time
+// per GetValueAndDerivative() single-threaded, and multi-threaded, where each thread
+// evaluates all time points of its part of the samples. That both give the same results
+// is tested by the CommonGTest.
+
+int
+main()
+{
+  const unsigned int Dimension = 4;
+  const unsigned int SplineOrder = 3;
+  typedef double     CoordinateRepresentationType;
+
+  /** The number of iterations. Distinguish between Debug and Release mode. */
+#ifndef NDEBUG
+  const unsigned int N = 2;
+#else
+  const unsigned int N = 20;
+#endif
+  const unsigned int  numberOfFrames = 50;
+  const unsigned long numberOfSamples = 2000;
+  std::cerr << "N = " << N << ", number of frames = " << numberOfFrames << std::endl;
+
+  /** Typedefs. */
+  typedef itk::Image<float, Dimension>                                                             ImageType;
+  typedef itk::VarianceOverLastDimensionImageMetric<ImageType, ImageType>                          MetricType;
+  typedef MetricType::MeasureType                                                                  MeasureType;
+  typedef MetricType::DerivativeType                                                               DerivativeType;
+  typedef itk::BSplineInterpolateImageFunction<ImageType, double, double>                          InterpolatorType;
+  typedef itk::ImageRandomSampler<ImageType>                                                       SamplerType;
+  typedef itk::StackTransform<CoordinateRepresentationType, Dimension, Dimension>                  TransformType;
+  typedef TransformType::ParametersType                                                            ParametersType;
+  typedef itk::RecursiveBSplineTransform<CoordinateRepresentationType, Dimension - 1, SplineOrder> SubTransformType;
+  typedef SubTransformType::ImageType                                                              GridImageType;
+
+  /** Create a smooth 4D image of 48^3 voxels and 50 frames, with a moving structure. */
+  ImageType::SizeType imageSize;
+  imageSize.Fill(48);
+  imageSize[Dimension - 1] = numberOfFrames;
+  auto image = ImageType::New();
+  image->SetRegions(imageSize);
+  image->Allocate();
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, image->GetBufferedRegion());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    const ImageType::IndexType index = it.GetIndex();
+    const double               shift = 3.0 * std::sin(index[Dimension - 1] / 5.0);
+    double                     value = 100.0;
+    for (unsigned int d = 0; d < Dimension - 1; ++d)
+    {
+      value *= std::cos((index[d] - shift) / 10.0);
+    }
+    it.Set(static_cast<float>(value));
+  }
+
+  /** Create a B-spline sub transform with a grid spacing of 8 voxels, and a stack of them. */
+  auto                         subTransform = SubTransformType::New();
+  GridImageType::RegionType    gridRegion;
+  GridImageType::SizeType      gridSize;
+  GridImageType::SpacingType   gridSpacing;
+  GridImageType::PointType     gridOrigin;
+  GridImageType::DirectionType gridDirection;
+  gridSize.Fill(9);
+  gridRegion.SetSize(gridSize);
+  gridSpacing.Fill(8.0);
+  gridOrigin.Fill(-8.0);
+  gridDirection.SetIdentity();
+  subTransform->SetGridRegion(gridRegion);
+  subTransform->SetGridSpacing(gridSpacing);
+  subTransform->SetGridOrigin(gridOrigin);
+  subTransform->SetGridDirection(gridDirection);
+  ParametersType subParameters(subTransform->GetNumberOfParameters());
+  subParameters.Fill(0.0);
+  subTransform->SetParameters(subParameters);
+
+  auto transform = TransformType::New();
+  transform->SetNumberOfSubTransforms(numberOfFrames);
+  transform->SetStackOrigin(0.0);
+  transform->SetStackSpacing(1.0);
+  transform->SetAllSubTransforms(subTransform);
+
+  ParametersType parameters(transform->GetNumberOfParameters());
+  for (unsigned int i = 0; i < parameters.GetSize(); ++i)
+  {
+    parameters[i] = std::sin(0.37 * i);
+  }
+  std::cerr << "Number of parameters = " << parameters.GetSize() << std::endl;
+
+  /** Time setting the parameters, as done by the metric in each iteration. */
+  const unsigned int numberOfSetParameters = 100 * N;
+  itk::TimeProbe     timeProbeByValue, timeProbeView;
+  timeProbeByValue.Start();
+  for (unsigned int i = 0; i < numberOfSetParameters; ++i)
+  {
+    transform->SetParametersByValue(parameters);
+  }
+  timeProbeByValue.Stop();
+  timeProbeView.Start();
+  for (unsigned int i = 0; i < numberOfSetParameters; ++i)
+  {
+    transform->SetParameters(parameters);
+  }
+  timeProbeView.Stop();
+
+  /** Create the metric. The samples are taken in the first frame, the metric
+   * evaluates them at all frames.
+   */
+  ImageType::RegionType sampleRegion = image->GetBufferedRegion();
+  ImageType::SizeType   sampleSize = sampleRegion.GetSize();
+  sampleSize[Dimension - 1] = 1;
+  sampleRegion.SetSize(sampleSize);
+
+  auto interpolator = InterpolatorType::New();
+  interpolator->SetSplineOrder(1);
+  auto sampler = SamplerType::New();
+  sampler->SetNumberOfSamples(numberOfSamples);
+  auto metric = MetricType::New();
+  metric->SetFixedImage(image);
+  metric->SetMovingImage(image);
+  metric->SetFixedImageRegion(sampleRegion);
+  metric->SetTransform(transform);
+  metric->SetInterpolator(interpolator);
+  metric->SetImageSampler(sampler);
+  metric->SetTransformIsStackTransform(true);
+  metric->SetSubtractMean(true);
+  metric->SetUseMultiThread(true);
+  try
+  {
+    metric->Initialize();
+  }
+  catch (const itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return 1;
+  }
+
+  /** Time the metric multi-threaded and single-threaded, on the same samples. */
+  MeasureType    value = 0.0;
+  DerivativeType derivative;
+  itk::TimeProbe timeProbeMultiThreaded, timeProbeSingleThreaded;
+  metric->GetValueAndDerivative(parameters, value, derivative);
+
+  timeProbeMultiThreaded.Start();
+  for (unsigned int i = 0; i < N; ++i)
+  {
+    metric->GetValueAndDerivative(parameters, value, derivative);
+  }
+  timeProbeMultiThreaded.Stop();
+
+  metric->SetUseMultiThread(false);
+  timeProbeSingleThreaded.Start();
+  for (unsigned int i = 0; i < N; ++i)
+  {
+    metric->GetValueAndDerivative(parameters, value, derivative);
+  }
+  timeProbeSingleThreaded.Stop();
+
+  /** Report. */
+  std::cerr << std::fixed << std::setprecision(3);
+  std::cerr << "Time per SetParameters (ms):" << std::endl;
+  std::cerr << "  By value: " << 1000.0 * timeProbeByValue.GetTotal() / numberOfSetParameters << std::endl;
+  std::cerr << "  Views:    " << 1000.0 * timeProbeView.GetTotal() / numberOfSetParameters << std::endl;
+  std::cerr << "Time per GetValueAndDerivative (ms):" << std::endl;
+  std::cerr << "  Single-threaded: " << 1000.0 * timeProbeSingleThreaded.GetTotal() / N << std::endl;
+  std::cerr << "  Multi-threaded:  " << 1000.0 * timeProbeMultiThreaded.GetTotal() / N << std::endl;
+  std::cerr << "Speedup factor = " << timeProbeSingleThreaded.GetTotal() / timeProbeMultiThreaded.GetTotal()
+            << std::endl;
+
+  /** Return a value. */
+  return 0;
+
+} // end main